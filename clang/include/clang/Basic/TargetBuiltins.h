@@ -452,6 +452,16 @@ namespace clang {
     };
   }
 
+  /// M65832 builtins
+  namespace M65832 {
+    enum {
+        LastTIBuiltin = clang::Builtin::FirstTSBuiltin-1,
+#define BUILTIN(ID, TYPE, ATTRS) BI##ID,
+#include "clang/Basic/BuiltinsM65832.def"
+        LastTSBuiltin
+    };
+  }
+
   /// SystemZ builtins
   namespace SystemZ {
     enum {
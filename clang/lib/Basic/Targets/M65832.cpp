@@ -11,11 +11,27 @@
 //===----------------------------------------------------------------------===//
 
 #include "M65832.h"
+#include "clang/Basic/Builtins.h"
 #include "clang/Basic/MacroBuilder.h"
+#include "clang/Basic/TargetBuiltins.h"
 
 using namespace clang;
 using namespace clang::targets;
 
+static constexpr int NumBuiltins =
+    M65832::LastTSBuiltin - Builtin::FirstTSBuiltin;
+
+static constexpr llvm::StringTable BuiltinStrings =
+    CLANG_BUILTIN_STR_TABLE_START
+#define BUILTIN CLANG_BUILTIN_STR_TABLE
+#include "clang/Basic/BuiltinsM65832.def"
+    ;
+
+static constexpr auto BuiltinInfos = Builtin::MakeInfos<NumBuiltins>({
+#define BUILTIN CLANG_BUILTIN_ENTRY
+#include "clang/Basic/BuiltinsM65832.def"
+});
+
 const char *const M65832TargetInfo::GCCRegNames[] = {
     // General purpose registers R0-R63
     "r0",  "r1",  "r2",  "r3",  "r4",  "r5",  "r6",  "r7",
@@ -89,6 +105,34 @@ ArrayRef<TargetInfo::GCCRegAlias> M65832TargetInfo::getGCCRegAliases() const {
   return llvm::ArrayRef(GCCRegAliases);
 }
 
+// The processors in M65832.td; m65832-fpu adds the FPU
+static constexpr llvm::StringLiteral ValidCPUNames[] = {"generic", "m65832",
+                                                        "m65832-fpu"};
+
+bool M65832TargetInfo::isValidCPUName(StringRef Name) const {
+  return llvm::is_contained(ValidCPUNames, Name);
+}
+
+void M65832TargetInfo::fillValidCPUList(
+    SmallVectorImpl<StringRef> &Values) const {
+  Values.append(std::begin(ValidCPUNames), std::end(ValidCPUNames));
+}
+
+// -mtune also takes the silicon revisions, which only select a scheduling
+// model and tuning features
+static constexpr llvm::StringLiteral ValidTuneCPUNames[] = {"m65832-r1",
+                                                            "m65832-r2"};
+
+bool M65832TargetInfo::isValidTuneCPUName(StringRef Name) const {
+  return isValidCPUName(Name) || llvm::is_contained(ValidTuneCPUNames, Name);
+}
+
+void M65832TargetInfo::fillValidTuneCPUList(
+    SmallVectorImpl<StringRef> &Values) const {
+  fillValidCPUList(Values);
+  Values.append(std::begin(ValidTuneCPUNames), std::end(ValidTuneCPUNames));
+}
+
 void M65832TargetInfo::getTargetDefines(const LangOptions &Opts,
                                         MacroBuilder &Builder) const {
   // Standard M65832 defines
@@ -106,4 +150,31 @@ void M65832TargetInfo::getTargetDefines(const LangOptions &Opts,
   Builder.defineMacro("__LITTLE_ENDIAN__");
   Builder.defineMacro("__ORDER_LITTLE_ENDIAN__", "1234");
   Builder.defineMacro("__BYTE_ORDER__", "__ORDER_LITTLE_ENDIAN__");
+
+  if (CPU == "m65832-fpu")
+    Builder.defineMacro("__m65832_fpu__");
+
+  // The __GCC_ATOMIC_*_LOCK_FREE macros follow MaxAtomicInlineWidth
+  Builder.defineMacro("__GCC_HAVE_SYNC_COMPARE_AND_SWAP_1");
+  Builder.defineMacro("__GCC_HAVE_SYNC_COMPARE_AND_SWAP_2");
+  Builder.defineMacro("__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4");
+}
+
+bool M65832TargetInfo::handleTargetFeatures(std::vector<std::string> &Features,
+                                            DiagnosticsEngine &Diags) {
+  // Without CAS/LLI/SCI (-target-feature -atomics) the backend still
+  // inlines 32-bit atomics with interrupts masked, so MaxAtomicInlineWidth
+  // does not depend on the feature
+  for (const std::string &Feature : Features) {
+    if (Feature == "+atomics")
+      HasAtomics = true;
+    else if (Feature == "-atomics")
+      HasAtomics = false;
+  }
+  return true;
+}
+
+llvm::SmallVector<Builtin::InfosShard>
+M65832TargetInfo::getTargetBuiltins() const {
+  return {{&BuiltinStrings, BuiltinInfos}};
 }
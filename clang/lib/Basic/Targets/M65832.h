@@ -25,6 +25,8 @@ namespace targets {
 class LLVM_LIBRARY_VISIBILITY M65832TargetInfo : public TargetInfo {
   static const char *const GCCRegNames[];
   static const TargetInfo::GCCRegAlias GCCRegAliases[];
+  std::string CPU;
+  bool HasAtomics = true;
 
 public:
   M65832TargetInfo(const llvm::Triple &Triple, const TargetOptions &)
@@ -49,6 +51,8 @@ public:
     // Floating point
     HalfWidth = 16;
     HalfAlign = 16;
+    // _Float16 is storage only; arithmetic is done in float
+    HasFloat16 = true;
     FloatWidth = 32;
     FloatAlign = 32;
     DoubleWidth = 64;
@@ -67,6 +71,10 @@ public:
     IntMaxType = SignedLongLong;
     Int64Type = SignedLongLong;
     SigAtomicType = SignedInt;
+    // CAS and LLI/SCI on one 32-bit word; AtomicExpand widens 8/16-bit
+    // operations to them, so all three sizes are lock-free. Wider objects
+    // go to the __atomic_* libcalls in m65832-stdlib.
+    MaxAtomicPromoteWidth = MaxAtomicInlineWidth = 32;
     
     // M65832 is little-endian
     BigEndian = false;
@@ -77,9 +85,7 @@ public:
   void getTargetDefines(const LangOptions &Opts,
                         MacroBuilder &Builder) const override;
 
-  llvm::SmallVector<Builtin::InfosShard> getTargetBuiltins() const override {
-    return {};
-  }
+  llvm::SmallVector<Builtin::InfosShard> getTargetBuiltins() const override;
 
   bool allowsLargerPreferedTypeAlignment() const override { return false; }
 
@@ -89,9 +95,28 @@ public:
 
   std::string_view getClobbers() const override { return ""; }
 
+  // The landing pad gets the exception object in R0 and the selector in R1
+  int getEHDataRegisterNumber(unsigned RegNo) const override {
+    return RegNo < 2 ? RegNo : -1;
+  }
+
   bool hasFeature(StringRef Feature) const override {
-    return Feature == "m65832";
+    return Feature == "m65832" || (Feature == "atomics" && HasAtomics);
+  }
+
+  bool handleTargetFeatures(std::vector<std::string> &Features,
+                            DiagnosticsEngine &Diags) override;
+
+  bool isValidCPUName(StringRef Name) const override;
+  void fillValidCPUList(SmallVectorImpl<StringRef> &Values) const override;
+  bool setCPU(const std::string &Name) override {
+    if (!isValidCPUName(Name))
+      return false;
+    CPU = Name;
+    return true;
   }
+  bool isValidTuneCPUName(StringRef Name) const override;
+  void fillValidTuneCPUList(SmallVectorImpl<StringRef> &Values) const override;
 
   ArrayRef<const char *> getGCCRegNames() const override;
 
@@ -115,6 +140,11 @@ public:
     case 'J': // 16-bit immediate
       Info.setRequiresImmediate(0, 0xffff);
       return true;
+    case 'Q': // Direct-page global
+    case 'S': // B-relative frame slot
+    case 'A': // Absolute global
+      Info.setAllowsMemory();
+      return true;
     }
     return false;
   }
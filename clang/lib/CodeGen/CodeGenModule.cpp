@@ -119,6 +119,8 @@ createTargetCodeGenInfo(CodeGenModule &CGM) {
 
   case llvm::Triple::m68k:
     return createM68kTargetCodeGenInfo(CGM);
+  case llvm::Triple::m65832:
+    return createM65832TargetCodeGenInfo(CGM);
   case llvm::Triple::mips:
   case llvm::Triple::mipsel:
     if (Triple.getOS() == llvm::Triple::Win32)
@@ -1634,7 +1636,7 @@ void CodeGenModule::EmitOpenCLMetadata() {
 
 void CodeGenModule::EmitBackendOptionsMetadata(
     const CodeGenOptions &CodeGenOpts) {
-  if (getTriple().isRISCV()) {
+  if (getTriple().isRISCV() || getTriple().getArch() == llvm::Triple::m65832) {
     getModule().addModuleFlag(llvm::Module::Min, "SmallDataLimit",
                               CodeGenOpts.SmallDataLimit);
   }
@@ -0,0 +1,54 @@
+//===------ M65832.cpp - Emit LLVM Code for builtins ----------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This contains code to emit Builtin calls as LLVM code.
+//
+//===----------------------------------------------------------------------===//
+
+#include "CodeGenFunction.h"
+#include "clang/Basic/TargetBuiltins.h"
+
+using namespace clang;
+using namespace CodeGen;
+using namespace llvm;
+
+Value *CodeGenFunction::EmitM65832BuiltinExpr(unsigned BuiltinID,
+                                              const CallExpr *E) {
+  switch (BuiltinID) {
+  case M65832::BI__m65832_cycles:
+    return Builder.CreateCall(CGM.getIntrinsic(Intrinsic::readcyclecounter));
+  case M65832::BI__builtin_m65832_fence:
+    return Builder.CreateFence(AtomicOrdering::SequentiallyConsistent);
+  case M65832::BI__builtin_m65832_fencer:
+    return Builder.CreateFence(AtomicOrdering::Acquire);
+  case M65832::BI__builtin_m65832_fencew:
+    return Builder.CreateFence(AtomicOrdering::Release);
+  case M65832::BI__builtin_m65832_mulhi:
+  case M65832::BI__builtin_m65832_mulhiu: {
+    // Plain IR so it folds and schedules freely; mulhs/mulhu select to
+    // MUL + TTA without touching memory.
+    bool Signed = BuiltinID == M65832::BI__builtin_m65832_mulhi;
+    Value *LHS = EmitScalarExpr(E->getArg(0));
+    Value *RHS = EmitScalarExpr(E->getArg(1));
+    llvm::Type *Ty = LHS->getType();
+    llvm::Type *WideTy = Builder.getInt64Ty();
+    LHS = Builder.CreateIntCast(LHS, WideTy, Signed);
+    RHS = Builder.CreateIntCast(RHS, WideTy, Signed);
+    Value *Prod = Builder.CreateMul(LHS, RHS);
+    return Builder.CreateTrunc(Builder.CreateLShr(Prod, 32), Ty);
+  }
+  case M65832::BI__builtin_m65832_clz: {
+    // CLZ returns 32 for zero, so the result is defined for every input
+    Value *Arg = EmitScalarExpr(E->getArg(0));
+    Function *F = CGM.getIntrinsic(Intrinsic::ctlz, Arg->getType());
+    return Builder.CreateCall(F, {Arg, Builder.getFalse()});
+  }
+  default:
+    return nullptr;
+  }
+}
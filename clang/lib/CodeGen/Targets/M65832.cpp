@@ -0,0 +1,200 @@
+//===- M65832.cpp ---------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "ABIInfoImpl.h"
+#include "TargetInfo.h"
+
+using namespace clang;
+using namespace clang::CodeGen;
+
+//===----------------------------------------------------------------------===//
+// M65832 ABI Implementation
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+class M65832ABIInfo : public DefaultABIInfo {
+public:
+  M65832ABIInfo(CodeGenTypes &CGT) : DefaultABIInfo(CGT) {}
+
+  void computeInfo(CGFunctionInfo &FI) const override;
+  RValue EmitVAArg(CodeGenFunction &CGF, Address VAListAddr, QualType Ty,
+                   AggValueSlot Slot) const override;
+
+private:
+  ABIArgInfo classifyReturnType(QualType RetTy) const;
+  ABIArgInfo classifyArgumentType(QualType Ty) const;
+
+  /// Whether Ty is an aggregate small enough to go in registers, rather
+  /// than through sret or byval memory. Sets the FP element type and count
+  /// for a homogeneous float aggregate.
+  bool isSmallAggregate(QualType Ty, uint64_t MaxBits, const Type *&Base,
+                        uint64_t &Members) const;
+  llvm::Type *getFPAggregateType(const Type *Base, uint64_t Members) const;
+
+  bool isHomogeneousAggregateBaseType(QualType Ty) const override;
+  bool isHomogeneousAggregateSmallEnough(const Type *Base,
+                                         uint64_t Members) const override;
+};
+
+class M65832TargetCodeGenInfo : public TargetCodeGenInfo {
+public:
+  M65832TargetCodeGenInfo(CodeGenTypes &CGT)
+      : TargetCodeGenInfo(std::make_unique<M65832ABIInfo>(CGT)) {}
+  void setTargetAttributes(const Decl *D, llvm::GlobalValue *GV,
+                           CodeGen::CodeGenModule &M) const override;
+};
+
+} // namespace
+
+void M65832ABIInfo::computeInfo(CGFunctionInfo &FI) const {
+  if (!getCXXABI().classifyReturnType(FI))
+    FI.getReturnInfo() = classifyReturnType(FI.getReturnType());
+  for (auto &I : FI.arguments())
+    I.info = classifyArgumentType(I.type);
+}
+
+bool M65832ABIInfo::isSmallAggregate(QualType Ty, uint64_t MaxBits,
+                                     const Type *&Base,
+                                     uint64_t &Members) const {
+  const RecordDecl *RD = Ty->getAsRecordDecl();
+  if (RD && RD->hasFlexibleArrayMember())
+    return false;
+  Base = nullptr;
+  Members = 0;
+  if (isHomogeneousAggregate(Ty, Base, Members))
+    return true;
+  Base = nullptr;
+  return getContext().getTypeSize(Ty) <= MaxBits;
+}
+
+llvm::Type *M65832ABIInfo::getFPAggregateType(const Type *Base,
+                                              uint64_t Members) const {
+  SmallVector<llvm::Type *, 4> Elts(Members,
+                                    CGT.ConvertType(QualType(Base, 0)));
+  return llvm::StructType::get(getVMContext(), Elts);
+}
+
+// Aggregates of up to 16 bytes come back in R0-R3 (RetCC_M65832) rather
+// than through a hidden sret pointer. One or two floats or doubles are
+// returned as such, so they land in F0-F1 with the FPU and in GPRs
+// without it, the same as a scalar.
+ABIArgInfo M65832ABIInfo::classifyReturnType(QualType RetTy) const {
+  if (!isAggregateTypeForABI(RetTy))
+    return DefaultABIInfo::classifyReturnType(RetTy);
+
+  if (isEmptyRecord(getContext(), RetTy, /*AllowArrays=*/true))
+    return ABIArgInfo::getIgnore();
+
+  const Type *Base;
+  uint64_t Members;
+  if (!isSmallAggregate(RetTy, 128, Base, Members))
+    return DefaultABIInfo::classifyReturnType(RetTy);
+
+  if (Base && Members <= 2)
+    return ABIArgInfo::getDirect(getFPAggregateType(Base, Members));
+
+  uint64_t Size = getContext().getTypeSize(RetTy);
+  if (Size > 128)
+    return DefaultABIInfo::classifyReturnType(RetTy);
+  return ABIArgInfo::getDirect(llvm::ArrayType::get(
+      llvm::Type::getInt32Ty(getVMContext()), llvm::divideCeil(Size, 32)));
+}
+
+// Aggregates of up to 8 bytes travel in one or two GPRs (as an i64 if
+// 8-byte aligned), and up to four floats or doubles in consecutive F
+// registers, instead of as a byval copy. Both follow
+// CC_M65832 onto the stack once the registers run out.
+ABIArgInfo M65832ABIInfo::classifyArgumentType(QualType Ty) const {
+  Ty = useFirstFieldIfTransparentUnion(Ty);
+  if (!isAggregateTypeForABI(Ty) || getRecordArgABI(Ty, getCXXABI()))
+    return DefaultABIInfo::classifyArgumentType(Ty);
+
+  if (isEmptyRecord(getContext(), Ty, /*AllowArrays=*/true))
+    return ABIArgInfo::getIgnore();
+
+  const Type *Base;
+  uint64_t Members;
+  if (!isSmallAggregate(Ty, 64, Base, Members))
+    return DefaultABIInfo::classifyArgumentType(Ty);
+
+  if (Base)
+    return ABIArgInfo::getDirect(getFPAggregateType(Base, Members));
+
+  llvm::LLVMContext &Ctx = getVMContext();
+  uint64_t Size = getContext().getTypeSize(Ty);
+  if (Size <= 32)
+    return ABIArgInfo::getDirect(llvm::Type::getInt32Ty(Ctx));
+  if (getContext().getTypeAlign(Ty) == 64)
+    return ABIArgInfo::getDirect(llvm::Type::getInt64Ty(Ctx));
+  return ABIArgInfo::getDirect(
+      llvm::ArrayType::get(llvm::Type::getInt32Ty(Ctx), 2));
+}
+
+// CC_M65832 puts every variadic argument on the stack in 4-byte aligned
+// slots, so a small aggregate passed directly lies in memory just as it
+// would in the caller, and an empty one takes no slot. Anything else is
+// read the default way.
+RValue M65832ABIInfo::EmitVAArg(CodeGenFunction &CGF, Address VAListAddr,
+                                QualType Ty, AggValueSlot Slot) const {
+  ABIArgInfo AI = classifyArgumentType(Ty);
+  if (AI.isIgnore())
+    return Slot.asRValue();
+  if (!isAggregateTypeForABI(Ty) || !AI.isDirect())
+    return DefaultABIInfo::EmitVAArg(CGF, VAListAddr, Ty, Slot);
+  return emitVoidPtrVAArg(CGF, VAListAddr, Ty, /*IsIndirect=*/false,
+                          getContext().getTypeInfoInChars(Ty),
+                          CharUnits::fromQuantity(4),
+                          /*AllowHigherAlign=*/false, Slot);
+}
+
+bool M65832ABIInfo::isHomogeneousAggregateBaseType(QualType Ty) const {
+  if (const auto *BT = Ty->getAs<BuiltinType>())
+    return BT->getKind() == BuiltinType::Float ||
+           BT->getKind() == BuiltinType::Double;
+  return false;
+}
+
+bool M65832ABIInfo::isHomogeneousAggregateSmallEnough(
+    const Type *Base, uint64_t Members) const {
+  return Members <= 4;
+}
+
+void M65832TargetCodeGenInfo::setTargetAttributes(
+    const Decl *D, llvm::GlobalValue *GV, CodeGen::CodeGenModule &M) const {
+  // Declarations need .dpdata too, so accesses from other files also use
+  // direct-page addressing
+  if (const auto *VD = dyn_cast_or_null<VarDecl>(D)) {
+    auto *Var = dyn_cast<llvm::GlobalVariable>(GV);
+    if (Var && VD->hasAttr<M65832DirectPageAttr>() &&
+        !VD->hasAttr<SectionAttr>())
+      Var->setSection(".dpdata");
+    return;
+  }
+
+  if (GV->isDeclaration())
+    return;
+  const auto *FD = dyn_cast_or_null<FunctionDecl>(D);
+  if (!FD)
+    return;
+  auto *F = cast<llvm::Function>(GV);
+
+  // The backend keys the interrupt save set and RTI off this attribute
+  if (FD->hasAttr<M65832InterruptAttr>()) {
+    F->addFnAttr("interrupt");
+    F->addFnAttr(llvm::Attribute::NoInline);
+  }
+
+  if (FD->hasAttr<M65832WindowAttr>())
+    F->addFnAttr("m65832-window");
+}
+
+std::unique_ptr<TargetCodeGenInfo>
+CodeGen::createM65832TargetCodeGenInfo(CodeGenModule &CGM) {
+  return std::make_unique<M65832TargetCodeGenInfo>(CGM.getTypes());
+}
@@ -51,6 +51,32 @@ static bool isPPCBareMetal(const llvm::Triple &Triple) {
          Triple.getEnvironment() == llvm::Triple::EABI;
 }
 
+/// Is the triple m65832[-unknown]-elf?
+static bool isM65832BareMetal(const llvm::Triple &Triple) {
+  return Triple.getArch() == llvm::Triple::m65832 &&
+         Triple.getOS() == llvm::Triple::UnknownOS;
+}
+
+// Soft-float libraries sit at the top of the sysroot and the FPU build in
+// m65832-fpu/. The two are not interchangeable: f32 and f64 arguments
+// travel in GPRs in one and F registers in the other.
+static bool findM65832Multilibs(const Driver &D, const ArgList &Args,
+                                DetectedMultilibs &Result) {
+  StringRef CPU = "m65832";
+  if (const Arg *A = Args.getLastArg(options::OPT_mcpu_EQ))
+    CPU = A->getValue();
+
+  Multilib::flags_list Flags;
+  addMultilibFlag(CPU != "m65832-fpu", "-mcpu=m65832", Flags);
+  addMultilibFlag(CPU == "m65832-fpu", "-mcpu=m65832-fpu", Flags);
+
+  MultilibBuilder Soft = MultilibBuilder().flag("-mcpu=m65832");
+  MultilibBuilder FPU =
+      MultilibBuilder("/m65832-fpu").flag("-mcpu=m65832-fpu");
+  Result.Multilibs = MultilibSetBuilder().Either(Soft, FPU).makeMultilibSet();
+  return Result.Multilibs.select(D, Flags, Result.SelectedMultilibs);
+}
+
 static bool findRISCVMultilibs(const Driver &D,
                                const llvm::Triple &TargetTriple,
                                const ArgList &Args, DetectedMultilibs &Result) {
@@ -345,13 +371,25 @@ void BareMetal::findMultilibs(const Driver &D, const llvm::Triple &Triple,
       SelectedMultilibs = Result.SelectedMultilibs;
       Multilibs = Result.Multilibs;
     }
+  } else if (isM65832BareMetal(Triple)) {
+    if (findM65832Multilibs(D, Args, Result)) {
+      SelectedMultilibs = Result.SelectedMultilibs;
+      Multilibs = Result.Multilibs;
+    }
   }
 }
 
 bool BareMetal::handlesTarget(const llvm::Triple &Triple) {
   return arm::isARMEABIBareMetal(Triple) ||
          aarch64::isAArch64BareMetal(Triple) || isRISCVBareMetal(Triple) ||
-         isPPCBareMetal(Triple);
+         isPPCBareMetal(Triple) || isM65832BareMetal(Triple);
+}
+
+const char *BareMetal::getDefaultLinker() const {
+  // There is no GNU ld for M65832
+  if (isM65832BareMetal(getTriple()))
+    return "ld.lld";
+  return Generic_ELF::getDefaultLinker();
 }
 
 Tool *BareMetal::buildLinker() const {
@@ -676,6 +714,17 @@ void baremetal::Linker::ConstructJob(Compilation &C, const JobAction &JA,
                   {options::OPT_L, options::OPT_u, options::OPT_T_Group,
                    options::OPT_s, options::OPT_t, options::OPT_r});
 
+  // The sysroot's m65832.ld places the memory map, crt0 and the vector
+  // table; use it unless the command line gives a script
+  if (isM65832BareMetal(Triple) &&
+      !Args.hasArg(options::OPT_T_Group, options::OPT_r)) {
+    std::string Script = TC.GetFilePath("m65832.ld");
+    if (llvm::sys::fs::exists(Script)) {
+      CmdArgs.push_back("-T");
+      CmdArgs.push_back(Args.MakeArgString(Script));
+    }
+  }
+
   TC.AddFilePathLibArgs(Args, CmdArgs);
 
   for (const auto &LibPath : TC.getLibraryPaths())
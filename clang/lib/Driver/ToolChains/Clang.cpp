@@ -1586,6 +1586,10 @@ void Clang::RenderTargetOptions(const llvm::Triple &EffectiveTriple,
     AddLanaiTargetArgs(Args, CmdArgs);
     break;
 
+  case llvm::Triple::m65832:
+    AddM65832TargetArgs(Args, CmdArgs);
+    break;
+
   case llvm::Triple::hexagon:
     AddHexagonTargetArgs(Args, CmdArgs);
     break;
@@ -2261,6 +2265,20 @@ void Clang::AddLanaiTargetArgs(const ArgList &Args,
   }
 }
 
+void Clang::AddM65832TargetArgs(const ArgList &Args,
+                                ArgStringList &CmdArgs) const {
+  // -msmall-data-limit= is an alias of -G
+  if (Arg *A = Args.getLastArg(options::OPT_G)) {
+    CmdArgs.push_back("-msmall-data-limit");
+    CmdArgs.push_back(A->getValue());
+  }
+
+  if (const Arg *A = Args.getLastArg(options::OPT_mtune_EQ)) {
+    CmdArgs.push_back("-tune-cpu");
+    CmdArgs.push_back(A->getValue());
+  }
+}
+
 void Clang::AddWebAssemblyTargetArgs(const ArgList &Args,
                                      ArgStringList &CmdArgs) const {
   // Default to "hidden" visibility.
@@ -4468,6 +4486,21 @@ renderDebugOptions(const ToolChain &TC, const Driver &D, const llvm::Triple &T,
     Args.ClaimAllArgs(options::OPT_fdebug_default_version);
   }
 
+  // Under M65832 linker relaxation, code label differences are ADD/SUB
+  // relocation pairs, and a .dwo may not contain relocations. DWARF v5 moves
+  // such ranges into the skeleton's .debug_addr; DWARF v4 location lists
+  // would keep them in the .dwo.
+  if (T.getArch() == llvm::Triple::m65832 &&
+      DwarfFission != DwarfFissionKind::None && EmitDwarf &&
+      EffectiveDWARFVersion < 5 &&
+      Args.hasFlag(options::OPT_mrelax, options::OPT_mno_relax, false)) {
+    const Arg *A = Args.getLastArg(options::OPT_gsplit_dwarf,
+                                   options::OPT_gsplit_dwarf_EQ);
+    D.Diag(diag::err_drv_argument_not_allowed_with)
+        << A->getAsString(Args) << "-mrelax";
+    DwarfFission = DwarfFissionKind::None;
+  }
+
   // -gline-directives-only supported only for the DWARF debug info.
   if (RequestedDWARFVersion == 0 &&
       DebugInfoKind == llvm::codegenoptions::DebugDirectivesOnly)
@@ -6237,8 +6270,11 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   if (Arg *A = Args.getLastArg(options::OPT_fsplit_machine_functions,
                                options::OPT_fno_split_machine_functions)) {
     if (!A->getOption().matches(options::OPT_fno_split_machine_functions)) {
-      // This codegen pass is only available on x86 and AArch64 ELF targets.
-      if ((Triple.isX86() || Triple.isAArch64()) && Triple.isOSBinFormatELF())
+      // This codegen pass is only available on x86, AArch64 and M65832 ELF
+      // targets.
+      if ((Triple.isX86() || Triple.isAArch64() ||
+           Triple.getArch() == llvm::Triple::m65832) &&
+          Triple.isOSBinFormatELF())
         A->render(Args, CmdArgs);
       else
         D.Diag(diag::err_drv_unsupported_opt_for_target)
@@ -6777,7 +6813,7 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     StringRef S0 = A->getValue(), S = S0;
     unsigned Size, Offset = 0;
     if (!Triple.isAArch64() && !Triple.isLoongArch() && !Triple.isRISCV() &&
-        !Triple.isX86() &&
+        !Triple.isX86() && Triple.getArch() != llvm::Triple::m65832 &&
         !(!Triple.isOSAIX() && (Triple.getArch() == llvm::Triple::ppc ||
                                 Triple.getArch() == llvm::Triple::ppc64 ||
                                 Triple.getArch() == llvm::Triple::ppc64le)))
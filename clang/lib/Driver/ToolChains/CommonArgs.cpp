@@ -590,6 +590,8 @@ const char *tools::getLDMOption(const llvm::Triple &T, const ArgList &Args) {
       return IsBigEndian ? "armelfb" : "armelf";
     return IsBigEndian ? "armelfb_linux_eabi" : "armelf_linux_eabi";
   }
+  case llvm::Triple::m65832:
+    return "m65832elf";
   case llvm::Triple::m68k:
     return "m68kelf";
   case llvm::Triple::ppc:
@@ -751,6 +753,11 @@ std::string tools::getCPUName(const Driver &D, const ArgList &Args,
   case llvm::Triple::m68k:
     return m68k::getM68kTargetCPU(Args);
 
+  case llvm::Triple::m65832:
+    if (const Arg *A = Args.getLastArg(options::OPT_mcpu_EQ))
+      return A->getValue();
+    return "";
+
   case llvm::Triple::mips:
   case llvm::Triple::mipsel:
   case llvm::Triple::mips64:
@@ -916,6 +923,11 @@ void tools::getTargetFeatures(const Driver &D, const llvm::Triple &Triple,
   case llvm::Triple::loongarch64:
     loongarch::getLoongArchTargetFeatures(D, Triple, Args, Features);
     break;
+  case llvm::Triple::m65832:
+    // Linker relaxation is off unless -mrelax is given
+    if (Args.hasFlag(options::OPT_mrelax, options::OPT_mno_relax, false))
+      Features.push_back("+relax");
+    break;
   }
 
   for (auto Feature : unifyTargetFeatures(Features)) {
@@ -1096,6 +1108,13 @@ void tools::addLTOOptions(const ToolChain &ToolChain, const ArgList &Args,
     CmdArgs.push_back(
         Args.MakeArgString(Twine(PluginOptPrefix) + ExtraDash + "mcpu=" + CPU));
 
+  // LTO objects are emitted with the link's subtarget rather than a
+  // function's, so relaxable M65832 relocations need the feature here too
+  if (Triple.getArch() == llvm::Triple::m65832 &&
+      Args.hasFlag(options::OPT_mrelax, options::OPT_mno_relax, false))
+    CmdArgs.push_back(
+        Args.MakeArgString(Twine(PluginOptPrefix) + "-mattr=+relax"));
+
   if (Args.getLastArg(options::OPT_O_Group)) {
     unsigned OptimizationLevel =
         getOptimizationLevel(Args, InputKind(), D.getDiags());
@@ -2939,10 +2958,11 @@ void tools::addMachineOutlinerArgs(const Driver &D,
   if (Arg *A = Args.getLastArg(options::OPT_moutline,
                                options::OPT_mno_outline)) {
     if (A->getOption().matches(options::OPT_moutline)) {
-      // We only support -moutline in AArch64 and ARM targets right now. If
-      // we're not compiling for these, emit a warning and ignore the flag.
-      // Otherwise, add the proper mllvm flags.
-      if (!(Triple.isARM() || Triple.isThumb() || Triple.isAArch64())) {
+      // We only support -moutline in AArch64, ARM and M65832 targets right
+      // now. If we're not compiling for these, emit a warning and ignore the
+      // flag. Otherwise, add the proper mllvm flags.
+      if (!(Triple.isARM() || Triple.isThumb() || Triple.isAArch64() ||
+            Triple.getArch() == llvm::Triple::m65832)) {
         D.Diag(diag::warn_drv_moutline_unsupported_opt) << Triple.getArchName();
       } else {
         addArg(Twine("-enable-machine-outliner"));
@@ -3176,6 +3196,11 @@ void tools::addMCModel(const Driver &D, const llvm::opt::ArgList &Args,
       Ok = CM == "small" || CM == "medium" || CM == "large";
     } else if (Triple.getArch() == llvm::Triple::lanai) {
       Ok = llvm::is_contained({"small", "medium", "large"}, CM);
+    } else if (Triple.getArch() == llvm::Triple::m65832) {
+      // The bank model keeps .data/.bss in one 64K bank; LLVM calls it tiny.
+      if (CM == "bank")
+        CM = "tiny";
+      Ok = CM == "small" || CM == "tiny";
     }
     if (Ok) {
       CmdArgs.push_back(Args.MakeArgString("-mcmodel=" + CM));
@@ -2122,6 +2122,11 @@ bool Sema::CheckTSBuiltinFunctionCall(const TargetInfo &TI, unsigned BuiltinID,
   case llvm::Triple::loongarch64:
     return LoongArch().CheckLoongArchBuiltinFunctionCall(TI, BuiltinID,
                                                          TheCall);
+  case llvm::Triple::m65832:
+    // TRAP encodes its code in one byte
+    if (BuiltinID == M65832::BI__builtin_m65832_trap)
+      return BuiltinConstantArgRange(TheCall, 0, 0, 255);
+    return false;
   case llvm::Triple::wasm32:
   case llvm::Triple::wasm64:
     return Wasm().CheckWebAssemblyBuiltinFunctionCall(TI, BuiltinID, TheCall);
@@ -6365,6 +6365,32 @@ BTFDeclTagAttr *Sema::mergeBTFDeclTagAttr(Decl *D, const BTFDeclTagAttr &AL) {
   return ::new (Context) BTFDeclTagAttr(Context, AL, AL.getBTFDeclTag());
 }
 
+static void handleM65832InterruptAttr(Sema &S, Decl *D, const ParsedAttr &AL) {
+  if (!isFuncOrMethodForAttrSubject(D)) {
+    S.Diag(D->getLocation(), diag::warn_attribute_wrong_decl_type)
+        << AL << AL.isRegularKeywordAttribute() << ExpectedFunction;
+    return;
+  }
+
+  if (!AL.checkExactlyNumArgs(S, 0))
+    return;
+
+  // The handler is entered from the vector, so it has nothing to receive
+  // arguments from and nowhere to return a value to.
+  if (hasFunctionProto(D) && getFunctionOrMethodNumParams(D) != 0) {
+    S.Diag(D->getLocation(), diag::warn_interrupt_signal_attribute_invalid)
+        << /*M65832*/ 4 << /*interrupt*/ 0 << 0;
+    return;
+  }
+  if (!getFunctionOrMethodResultType(D)->isVoidType()) {
+    S.Diag(D->getLocation(), diag::warn_interrupt_signal_attribute_invalid)
+        << /*M65832*/ 4 << /*interrupt*/ 0 << 1;
+    return;
+  }
+
+  handleSimpleAttribute<M65832InterruptAttr>(S, D, AL);
+}
+
 static void handleInterruptAttr(Sema &S, Decl *D, const ParsedAttr &AL) {
   // Dispatch the interrupt attribute based on the current target.
   switch (S.Context.getTargetInfo().getTriple().getArch()) {
@@ -6378,6 +6404,9 @@ static void handleInterruptAttr(Sema &S, Decl *D, const ParsedAttr &AL) {
   case llvm::Triple::m68k:
     S.M68k().handleInterruptAttr(D, AL);
     break;
+  case llvm::Triple::m65832:
+    handleM65832InterruptAttr(S, D, AL);
+    break;
   case llvm::Triple::x86:
   case llvm::Triple::x86_64:
     S.X86().handleAnyInterruptAttr(D, AL);
@@ -0,0 +1,110 @@
+//===-- udivmoddi4.c - Implement __udivmoddi4 for M65832 ------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements __udivmoddi4 for M65832 with the 32-bit DIVU
+// instruction. The generic version loops once per quotient bit; here a
+// 64 / 64 divide is at most four 32 / 32 divides plus corrections.
+//
+//===----------------------------------------------------------------------===//
+
+#include "../int_lib.h"
+
+// Divides u1:u0 by v, which must be greater than u1, with 32-bit operations
+// only: after normalizing v, each 16-bit quotient digit is estimated with
+// one DIVU and corrected at most twice. (Hacker's Delight, divlu.)
+static __inline su_int divlu(su_int u1, su_int u0, su_int v, su_int *r) {
+  const su_int b = 0x10000;
+  unsigned s = __builtin_clz(v);
+  v <<= s;
+  su_int vn1 = v >> 16;
+  su_int vn0 = v & 0xFFFF;
+
+  su_int un32 = s ? (u1 << s) | (u0 >> (32 - s)) : u1;
+  su_int un10 = u0 << s;
+  su_int un1 = un10 >> 16;
+  su_int un0 = un10 & 0xFFFF;
+
+  su_int q1 = un32 / vn1;
+  su_int rhat = un32 - q1 * vn1;
+  while (q1 >= b || q1 * vn0 > b * rhat + un1) {
+    q1--;
+    rhat += vn1;
+    if (rhat >= b)
+      break;
+  }
+
+  // Wraps, but the true value is below v
+  su_int un21 = un32 * b + un1 - q1 * v;
+
+  su_int q0 = un21 / vn1;
+  rhat = un21 - q0 * vn1;
+  while (q0 >= b || q0 * vn0 > b * rhat + un0) {
+    q0--;
+    rhat += vn1;
+    if (rhat >= b)
+      break;
+  }
+
+  if (r)
+    *r = (un21 * b + un0 - q0 * v) >> s;
+  return q1 * b + q0;
+}
+
+// Effects: if rem != 0, *rem = a % b
+// Returns: a / b
+
+COMPILER_RT_ABI du_int __udivmoddi4(du_int a, du_int b, du_int *rem) {
+  udwords n;
+  n.all = a;
+  udwords d;
+  d.all = b;
+
+  if (d.s.high == 0) {
+    udwords q;
+    su_int r;
+    if (n.s.high == 0) {
+      q.s.high = 0;
+      q.s.low = n.s.low / d.s.low;
+      r = n.s.low - q.s.low * d.s.low;
+    } else {
+      // The high quotient word first, then its remainder and the low
+      // word together
+      q.s.high = n.s.high / d.s.low;
+      n.s.high -= q.s.high * d.s.low;
+      q.s.low = divlu(n.s.high, n.s.low, d.s.low, &r);
+    }
+    if (rem)
+      *rem = r;
+    return q.all;
+  }
+
+  if (a < b) {
+    if (rem)
+      *rem = a;
+    return 0;
+  }
+
+  // The quotient fits in 32 bits. Dividing a / 2 by the top 32 bits of the
+  // normalized divisor gives it to within one. (Hacker's Delight, divDu.)
+  unsigned s = __builtin_clz(d.s.high);
+  su_int v1 = (su_int)((b << s) >> 32);
+  udwords n1;
+  n1.all = a >> 1;
+  su_int q1 = divlu(n1.s.high, n1.s.low, v1, 0);
+  su_int q0 = q1 >> (31 - s);
+  if (q0 != 0)
+    q0--;
+  du_int r = a - (du_int)q0 * b;
+  if (r >= b) {
+    q0++;
+    r -= b;
+  }
+  if (rem)
+    *rem = r;
+  return q0;
+}
@@ -113,6 +113,21 @@ uint64_t __llvm_profile_get_size_for_buffer(void);
  */
 int __llvm_profile_write_buffer(char *Buffer);
 
+/* Marker lines around __llvm_profile_write_hex output. */
+#define INSTR_PROF_HEX_BEGIN "--- llvm-profraw begin ---"
+#define INSTR_PROF_HEX_END "--- llvm-profraw end ---"
+
+/*!
+ * \brief Stream instrumentation data as hex text, one character at a time.
+ *
+ * For targets with no file system and no room for a profile-sized buffer:
+ * the raw profile is passed to \c PutChar as lowercase hex, 32 bytes per
+ * line, between \c INSTR_PROF_HEX_BEGIN and \c INSTR_PROF_HEX_END lines,
+ * so that it can be picked out of console output and turned back into a
+ * .profraw file on the host.
+ */
+int __llvm_profile_write_hex(void (*PutChar)(int));
+
 const __llvm_profile_data *__llvm_profile_begin_data(void);
 const __llvm_profile_data *__llvm_profile_end_data(void);
 const char *__llvm_profile_begin_names(void);
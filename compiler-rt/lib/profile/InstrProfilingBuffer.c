@@ -240,6 +240,59 @@ COMPILER_RT_VISIBILITY int __llvm_profile_write_buffer(char *Buffer) {
   return lprofWriteData(&BufferWriter, 0, 0);
 }
 
+/* Bytes of raw profile per line of __llvm_profile_write_hex output. */
+#define HEX_BYTES_PER_LINE 32
+
+typedef struct HexWriterCtx {
+  void (*PutChar)(int);
+  unsigned Column;
+} HexWriterCtx;
+
+static void hexPutString(HexWriterCtx *Ctx, const char *S) {
+  while (*S)
+    Ctx->PutChar(*S++);
+}
+
+static void hexPutByte(HexWriterCtx *Ctx, uint8_t Byte) {
+  static const char Digits[] = "0123456789abcdef";
+  Ctx->PutChar(Digits[Byte >> 4]);
+  Ctx->PutChar(Digits[Byte & 0xf]);
+  if (++Ctx->Column == HEX_BYTES_PER_LINE) {
+    Ctx->PutChar('\n');
+    Ctx->Column = 0;
+  }
+}
+
+static uint32_t lprofHexWriter(ProfDataWriter *This, ProfDataIOVec *IOVecs,
+                               uint32_t NumIOVecs) {
+  HexWriterCtx *Ctx = (HexWriterCtx *)This->WriterCtx;
+  uint32_t I;
+  for (I = 0; I < NumIOVecs; I++) {
+    const uint8_t *Data = (const uint8_t *)IOVecs[I].Data;
+    size_t Length = IOVecs[I].ElmSize * IOVecs[I].NumElm;
+    size_t J;
+    /* There is no zero-filled buffer behind a stream, so padding is
+     * always written out. */
+    for (J = 0; J < Length; J++)
+      hexPutByte(Ctx, Data ? Data[J] : 0);
+  }
+  return 0;
+}
+
+COMPILER_RT_VISIBILITY int __llvm_profile_write_hex(void (*PutChar)(int)) {
+  HexWriterCtx Ctx = {PutChar, 0};
+  ProfDataWriter HexWriter;
+  int Ret;
+  HexWriter.Write = lprofHexWriter;
+  HexWriter.WriterCtx = &Ctx;
+  hexPutString(&Ctx, "\n" INSTR_PROF_HEX_BEGIN "\n");
+  Ret = lprofWriteData(&HexWriter, 0, 0);
+  if (Ctx.Column)
+    PutChar('\n');
+  hexPutString(&Ctx, INSTR_PROF_HEX_END "\n");
+  return Ret;
+}
+
 COMPILER_RT_VISIBILITY int __llvm_profile_write_buffer_internal(
     char *Buffer, const __llvm_profile_data *DataBegin,
     const __llvm_profile_data *DataEnd, const char *CountersBegin,
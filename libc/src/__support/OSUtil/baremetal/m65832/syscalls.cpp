@@ -33,6 +33,11 @@ void _exit(int status) {
     sys_exit(status);
 }
 
+// LLVM libc's baremetal exit() ends here, after the atexit handlers
+[[noreturn]] void __llvm_libc_exit(int status) {
+    sys_exit(status);
+}
+
 // LLVM libc calls abort() 
 void abort(void) {
     sys_abort();
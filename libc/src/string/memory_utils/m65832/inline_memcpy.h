@@ -0,0 +1,52 @@
+//===-- Memcpy implementation for m65832 ------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#ifndef LIBC_SRC_STRING_MEMORY_UTILS_M65832_INLINE_MEMCPY_H
+#define LIBC_SRC_STRING_MEMORY_UTILS_M65832_INLINE_MEMCPY_H
+
+#include "src/__support/macros/attributes.h" // LIBC_INLINE
+#include "src/__support/macros/config.h"     // LIBC_NAMESPACE_DECL
+#include "src/string/memory_utils/generic/byte_per_byte.h"
+#include "src/string/memory_utils/utils.h" // Ptr, CPtr
+
+#include <stddef.h> // size_t
+
+namespace LIBC_NAMESPACE_DECL {
+
+// Misaligned copies shorter than this are not worth setting up MVN for.
+LIBC_INLINE_VAR constexpr size_t kM65832BlockMoveThreshold = 32;
+
+// With src and dst equally aligned, dst is aligned and the body is copied
+// with 32-bit loads and stores, 16 bytes per iteration. Without it there is
+// no aligned word to load, so long copies use the block move instruction
+// (MVN) that the backend emits for a variable-length __builtin_memcpy.
+[[maybe_unused]] LIBC_INLINE void
+inline_memcpy_m65832(Ptr __restrict dst, CPtr __restrict src, size_t count) {
+  constexpr size_t kAlign = sizeof(uint32_t);
+  if (count < 2 * kAlign)
+    return inline_memcpy_byte_per_byte(dst, src, count);
+  if (distance_to_align_down<kAlign>(dst) !=
+      distance_to_align_down<kAlign>(src)) {
+    if (count >= kM65832BlockMoveThreshold)
+      return static_cast<void>(__builtin_memcpy(dst, src, count));
+    return inline_memcpy_byte_per_byte(dst, src, count);
+  }
+
+  size_t offset = distance_to_align_up<kAlign>(dst);
+  inline_memcpy_byte_per_byte(dst, src, offset);
+  for (; offset + 4 * kAlign <= count; offset += 4 * kAlign)
+    memcpy_inline<4 * kAlign>(assume_aligned<kAlign>(dst + offset),
+                              assume_aligned<kAlign>(src + offset));
+  for (; offset + kAlign <= count; offset += kAlign)
+    memcpy_inline<kAlign>(assume_aligned<kAlign>(dst + offset),
+                          assume_aligned<kAlign>(src + offset));
+  inline_memcpy_byte_per_byte(dst, src, count, offset);
+}
+
+} // namespace LIBC_NAMESPACE_DECL
+
+#endif // LIBC_SRC_STRING_MEMORY_UTILS_M65832_INLINE_MEMCPY_H
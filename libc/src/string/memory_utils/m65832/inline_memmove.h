@@ -0,0 +1,32 @@
+//===-- Memmove implementation for m65832 -----------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#ifndef LIBC_SRC_STRING_MEMORY_UTILS_M65832_INLINE_MEMMOVE_H
+#define LIBC_SRC_STRING_MEMORY_UTILS_M65832_INLINE_MEMMOVE_H
+
+#include "src/__support/macros/attributes.h" // LIBC_INLINE
+#include "src/__support/macros/config.h"     // LIBC_NAMESPACE_DECL
+#include "src/string/memory_utils/generic/byte_per_byte.h"
+#include "src/string/memory_utils/m65832/inline_memcpy.h" // kM65832BlockMoveThreshold
+#include "src/string/memory_utils/utils.h" // Ptr, CPtr
+
+#include <stddef.h> // size_t
+
+namespace LIBC_NAMESPACE_DECL {
+
+// The backend lowers a variable-length __builtin_memmove to MVN or MVP
+// depending on which way the buffers overlap.
+[[maybe_unused]] LIBC_INLINE void
+inline_memmove_m65832(Ptr dst, CPtr src, size_t count) {
+  if (count >= kM65832BlockMoveThreshold)
+    return static_cast<void>(__builtin_memmove(dst, src, count));
+  inline_memmove_byte_per_byte(dst, src, count);
+}
+
+} // namespace LIBC_NAMESPACE_DECL
+
+#endif // LIBC_SRC_STRING_MEMORY_UTILS_M65832_INLINE_MEMMOVE_H
@@ -0,0 +1,46 @@
+//===-- Memset implementation for m65832 ------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#ifndef LIBC_SRC_STRING_MEMORY_UTILS_M65832_INLINE_MEMSET_H
+#define LIBC_SRC_STRING_MEMORY_UTILS_M65832_INLINE_MEMSET_H
+
+#include "src/__support/macros/attributes.h" // LIBC_INLINE
+#include "src/__support/macros/config.h"     // LIBC_NAMESPACE_DECL
+#include "src/string/memory_utils/generic/byte_per_byte.h"
+#include "src/string/memory_utils/op_generic.h" // generic::splat
+#include "src/string/memory_utils/utils.h"      // Ptr, store_aligned
+
+#include <stddef.h> // size_t
+
+namespace LIBC_NAMESPACE_DECL {
+
+// Aligns dst, then stores the splatted byte 32 bits at a time, four words
+// per iteration. A variable-length __builtin_memset would come back here as
+// a call, so the loop is explicit.
+LIBC_INLINE static void inline_memset_m65832(Ptr dst, uint8_t value,
+                                             size_t count) {
+  constexpr size_t kAlign = sizeof(uint32_t);
+  if (count < 2 * kAlign)
+    return inline_memset_byte_per_byte(dst, value, count);
+
+  const uint32_t word = generic::splat<uint32_t>(value);
+  size_t offset = distance_to_align_up<kAlign>(dst);
+  inline_memset_byte_per_byte(dst, value, offset);
+  for (; offset + 4 * kAlign <= count; offset += 4 * kAlign) {
+    store<uint32_t>(assume_aligned<kAlign>(dst + offset), word);
+    store<uint32_t>(assume_aligned<kAlign>(dst + offset + kAlign), word);
+    store<uint32_t>(assume_aligned<kAlign>(dst + offset + 2 * kAlign), word);
+    store<uint32_t>(assume_aligned<kAlign>(dst + offset + 3 * kAlign), word);
+  }
+  for (; offset + kAlign <= count; offset += kAlign)
+    store<uint32_t>(assume_aligned<kAlign>(dst + offset), word);
+  inline_memset_byte_per_byte(dst, value, count, offset);
+}
+
+} // namespace LIBC_NAMESPACE_DECL
+
+#endif // LIBC_SRC_STRING_MEMORY_UTILS_M65832_INLINE_MEMSET_H
@@ -31,6 +31,7 @@
 #define _LIBUNWIND_HIGHEST_DWARF_REGISTER_VE        143
 #define _LIBUNWIND_HIGHEST_DWARF_REGISTER_S390X     83
 #define _LIBUNWIND_HIGHEST_DWARF_REGISTER_LOONGARCH 64
+#define _LIBUNWIND_HIGHEST_DWARF_REGISTER_M65832    96
 
 #if defined(_LIBUNWIND_IS_NATIVE_ONLY)
 # if defined(__linux__)
@@ -183,6 +184,12 @@
 #endif
 #define _LIBUNWIND_HIGHEST_DWARF_REGISTER                                      \
   _LIBUNWIND_HIGHEST_DWARF_REGISTER_LOONGARCH
+# elif defined(__m65832__)
+#  define _LIBUNWIND_TARGET_M65832 1
+// Values here change when : Registers.hpp - m65832_thread_state_t change
+#  define _LIBUNWIND_CONTEXT_SIZE 52
+#  define _LIBUNWIND_CURSOR_SIZE 59
+#  define _LIBUNWIND_HIGHEST_DWARF_REGISTER _LIBUNWIND_HIGHEST_DWARF_REGISTER_M65832
 #elif defined(__wasm__)
 // Unused
 #define _LIBUNWIND_CONTEXT_SIZE 0
@@ -207,6 +214,7 @@
 # define _LIBUNWIND_TARGET_VE 1
 # define _LIBUNWIND_TARGET_S390X 1
 # define _LIBUNWIND_TARGET_LOONGARCH 1
+# define _LIBUNWIND_TARGET_M65832 1
 # define _LIBUNWIND_CONTEXT_SIZE 167
 # define _LIBUNWIND_CURSOR_SIZE 204
 # define _LIBUNWIND_HIGHEST_DWARF_REGISTER 287
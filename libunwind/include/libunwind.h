@@ -1406,4 +1406,97 @@ enum {
   UNW_LOONGARCH_F31 = 63,
 };
 
+// M65832 register numbers
+enum {
+  UNW_M65832_R0 = 0,
+  UNW_M65832_R1 = 1,
+  UNW_M65832_R2 = 2,
+  UNW_M65832_R3 = 3,
+  UNW_M65832_R4 = 4,
+  UNW_M65832_R5 = 5,
+  UNW_M65832_R6 = 6,
+  UNW_M65832_R7 = 7,
+  UNW_M65832_R8 = 8,
+  UNW_M65832_R9 = 9,
+  UNW_M65832_R10 = 10,
+  UNW_M65832_R11 = 11,
+  UNW_M65832_R12 = 12,
+  UNW_M65832_R13 = 13,
+  UNW_M65832_R14 = 14,
+  UNW_M65832_R15 = 15,
+  UNW_M65832_R16 = 16,
+  UNW_M65832_R17 = 17,
+  UNW_M65832_R18 = 18,
+  UNW_M65832_R19 = 19,
+  UNW_M65832_R20 = 20,
+  UNW_M65832_R21 = 21,
+  UNW_M65832_R22 = 22,
+  UNW_M65832_R23 = 23,
+  UNW_M65832_R24 = 24,
+  UNW_M65832_R25 = 25,
+  UNW_M65832_R26 = 26,
+  UNW_M65832_R27 = 27,
+  UNW_M65832_R28 = 28,
+  UNW_M65832_R29 = 29,
+  UNW_M65832_R30 = 30,
+  UNW_M65832_R31 = 31,
+  UNW_M65832_R32 = 32,
+  UNW_M65832_R33 = 33,
+  UNW_M65832_R34 = 34,
+  UNW_M65832_R35 = 35,
+  UNW_M65832_R36 = 36,
+  UNW_M65832_R37 = 37,
+  UNW_M65832_R38 = 38,
+  UNW_M65832_R39 = 39,
+  UNW_M65832_R40 = 40,
+  UNW_M65832_R41 = 41,
+  UNW_M65832_R42 = 42,
+  UNW_M65832_R43 = 43,
+  UNW_M65832_R44 = 44,
+  UNW_M65832_R45 = 45,
+  UNW_M65832_R46 = 46,
+  UNW_M65832_R47 = 47,
+  UNW_M65832_R48 = 48,
+  UNW_M65832_R49 = 49,
+  UNW_M65832_R50 = 50,
+  UNW_M65832_R51 = 51,
+  UNW_M65832_R52 = 52,
+  UNW_M65832_R53 = 53,
+  UNW_M65832_R54 = 54,
+  UNW_M65832_R55 = 55,
+  UNW_M65832_R56 = 56,
+  UNW_M65832_R57 = 57,
+  UNW_M65832_R58 = 58,
+  UNW_M65832_R59 = 59,
+  UNW_M65832_R60 = 60,
+  UNW_M65832_R61 = 61,
+  UNW_M65832_R62 = 62,
+  UNW_M65832_R63 = 63,
+  UNW_M65832_A = 64,
+  UNW_M65832_X = 65,
+  UNW_M65832_Y = 66,
+  UNW_M65832_SP = 67,
+  UNW_M65832_D = 68,
+  UNW_M65832_B = 69,
+  UNW_M65832_VBR = 70,
+  UNW_M65832_T = 71,
+  UNW_M65832_SR = 72,
+  UNW_M65832_F0 = 80,
+  UNW_M65832_F1 = 81,
+  UNW_M65832_F2 = 82,
+  UNW_M65832_F3 = 83,
+  UNW_M65832_F4 = 84,
+  UNW_M65832_F5 = 85,
+  UNW_M65832_F6 = 86,
+  UNW_M65832_F7 = 87,
+  UNW_M65832_F8 = 88,
+  UNW_M65832_F9 = 89,
+  UNW_M65832_F10 = 90,
+  UNW_M65832_F11 = 91,
+  UNW_M65832_F12 = 92,
+  UNW_M65832_F13 = 93,
+  UNW_M65832_F14 = 94,
+  UNW_M65832_F15 = 95,
+};
+
 #endif
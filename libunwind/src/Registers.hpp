@@ -47,6 +47,7 @@ enum {
   REGISTERS_VE,
   REGISTERS_S390X,
   REGISTERS_LOONGARCH,
+  REGISTERS_M65832,
 };
 
 #if defined(_LIBUNWIND_TARGET_I386)
@@ -5525,6 +5526,194 @@ inline void Registers_loongarch::setVectorRegister(int, v128) {
 }
 #endif //_LIBUNWIND_TARGET_LOONGARCH
 
+#if defined(_LIBUNWIND_TARGET_M65832)
+/// Registers_m65832 holds the register state of a thread in an M65832
+/// process. R0-R63 are the memory-mapped registers at D.
+class _LIBUNWIND_HIDDEN Registers_m65832 {
+public:
+  Registers_m65832();
+  Registers_m65832(const void *registers);
+
+  typedef uint32_t reg_t;
+  typedef uint32_t link_reg_t;
+  typedef const link_reg_t &link_hardened_reg_arg_t;
+
+  bool        validRegister(int num) const;
+  uint32_t    getRegister(int num) const;
+  void        setRegister(int num, uint32_t value);
+  bool        validFloatRegister(int num) const;
+  double      getFloatRegister(int num) const;
+  void        setFloatRegister(int num, double value);
+  bool        validVectorRegister(int num) const;
+  v128        getVectorRegister(int num) const;
+  void        setVectorRegister(int num, v128 value);
+  static const char *getRegisterName(int num);
+  void        jumpto();
+  static constexpr int lastDwarfRegNum() {
+    return _LIBUNWIND_HIGHEST_DWARF_REGISTER_M65832;
+  }
+  static int  getArch() { return REGISTERS_M65832; }
+
+  uint64_t  getSP() const         { return _registers.__sp; }
+  void      setSP(uint32_t value) { _registers.__sp = value; }
+  uint64_t  getIP() const         { return _registers.__pc; }
+  void      setIP(uint32_t value) { _registers.__pc = value; }
+
+private:
+  // Offsets are known to UnwindRegistersSave.S and UnwindRegistersRestore.S
+  struct m65832_thread_state_t {
+    uint32_t __r[64]; // R0-R63
+    uint32_t __a;
+    uint32_t __x;
+    uint32_t __y;
+    uint32_t __sp;
+    uint32_t __d;     // Direct page (register file) base
+    uint32_t __b;     // Frame base
+    uint32_t __pc;
+    uint32_t __pad;
+    double   __f[16]; // F0-F15, saved only with the FPU
+  };
+
+  m65832_thread_state_t _registers;
+};
+
+inline Registers_m65832::Registers_m65832(const void *registers) {
+  static_assert((check_fit<Registers_m65832, unw_context_t>::does_fit),
+                "m65832 registers do not fit into unw_context_t");
+  memcpy(&_registers, static_cast<const uint8_t *>(registers),
+         sizeof(_registers));
+}
+
+inline Registers_m65832::Registers_m65832() {
+  memset(&_registers, 0, sizeof(_registers));
+}
+
+inline bool Registers_m65832::validRegister(int regNum) const {
+  if (regNum == UNW_REG_IP)
+    return true;
+  if (regNum == UNW_REG_SP)
+    return true;
+  if (regNum < 0)
+    return false;
+  if (regNum <= UNW_M65832_B)
+    return true;
+  return false;
+}
+
+inline uint32_t Registers_m65832::getRegister(int regNum) const {
+  if (regNum >= UNW_M65832_R0 && regNum <= UNW_M65832_R63)
+    return _registers.__r[regNum - UNW_M65832_R0];
+
+  switch (regNum) {
+  case UNW_REG_IP:
+    return _registers.__pc;
+  case UNW_REG_SP:
+  case UNW_M65832_SP:
+    return _registers.__sp;
+  case UNW_M65832_A:
+    return _registers.__a;
+  case UNW_M65832_X:
+    return _registers.__x;
+  case UNW_M65832_Y:
+    return _registers.__y;
+  case UNW_M65832_D:
+    return _registers.__d;
+  case UNW_M65832_B:
+    return _registers.__b;
+  }
+  _LIBUNWIND_ABORT("unsupported m65832 register");
+}
+
+inline void Registers_m65832::setRegister(int regNum, uint32_t value) {
+  if (regNum >= UNW_M65832_R0 && regNum <= UNW_M65832_R63) {
+    _registers.__r[regNum - UNW_M65832_R0] = value;
+    return;
+  }
+
+  switch (regNum) {
+  case UNW_REG_IP:
+    _registers.__pc = value;
+    return;
+  case UNW_REG_SP:
+  case UNW_M65832_SP:
+    _registers.__sp = value;
+    return;
+  case UNW_M65832_A:
+    _registers.__a = value;
+    return;
+  case UNW_M65832_X:
+    _registers.__x = value;
+    return;
+  case UNW_M65832_Y:
+    _registers.__y = value;
+    return;
+  case UNW_M65832_D:
+    _registers.__d = value;
+    return;
+  case UNW_M65832_B:
+    _registers.__b = value;
+    return;
+  }
+  _LIBUNWIND_ABORT("unsupported m65832 register");
+}
+
+inline bool Registers_m65832::validFloatRegister(int regNum) const {
+#if defined(__m65832_fpu__)
+  return regNum >= UNW_M65832_F0 && regNum <= UNW_M65832_F15;
+#else
+  (void)regNum;
+  return false;
+#endif
+}
+
+inline double Registers_m65832::getFloatRegister(int regNum) const {
+  assert(validFloatRegister(regNum));
+  return _registers.__f[regNum - UNW_M65832_F0];
+}
+
+inline void Registers_m65832::setFloatRegister(int regNum, double value) {
+  assert(validFloatRegister(regNum));
+  _registers.__f[regNum - UNW_M65832_F0] = value;
+}
+
+inline bool Registers_m65832::validVectorRegister(int /* regNum */) const {
+  return false;
+}
+
+inline v128 Registers_m65832::getVectorRegister(int /* regNum */) const {
+  _LIBUNWIND_ABORT("m65832 vector support not implemented");
+}
+
+inline void Registers_m65832::setVectorRegister(int /* regNum */,
+                                                v128 /* value */) {
+  _LIBUNWIND_ABORT("m65832 vector support not implemented");
+}
+
+inline const char *Registers_m65832::getRegisterName(int regNum) {
+  static const char *const names[] = {
+      "r0",  "r1",  "r2",  "r3",  "r4",  "r5",  "r6",  "r7",  "r8",  "r9",
+      "r10", "r11", "r12", "r13", "r14", "r15", "r16", "r17", "r18", "r19",
+      "r20", "r21", "r22", "r23", "r24", "r25", "r26", "r27", "r28", "r29",
+      "r30", "r31", "r32", "r33", "r34", "r35", "r36", "r37", "r38", "r39",
+      "r40", "r41", "r42", "r43", "r44", "r45", "r46", "r47", "r48", "r49",
+      "r50", "r51", "r52", "r53", "r54", "r55", "r56", "r57", "r58", "r59",
+      "r60", "r61", "r62", "r63", "a",   "x",   "y",   "sp",  "d",   "b",
+      "vbr", "t",   "sr"};
+  static const char *const fnames[] = {
+      "f0", "f1", "f2",  "f3",  "f4",  "f5",  "f6",  "f7",
+      "f8", "f9", "f10", "f11", "f12", "f13", "f14", "f15"};
+  if (regNum == UNW_REG_IP)
+    return "pc";
+  if (regNum == UNW_REG_SP)
+    return "sp";
+  if (regNum >= UNW_M65832_R0 && regNum <= UNW_M65832_SR)
+    return names[regNum - UNW_M65832_R0];
+  if (regNum >= UNW_M65832_F0 && regNum <= UNW_M65832_F15)
+    return fnames[regNum - UNW_M65832_F0];
+  return "unknown register";
+}
+#endif // _LIBUNWIND_TARGET_M65832
+
 } // namespace libunwind
 
 #endif // __REGISTERS_HPP__
@@ -11,17 +11,40 @@
 // 32-bit operations, extended addressing modes, and floating-point support.
 //
 // Since it is a baremetal architecture, programs are typically linked against
-// address 0 and the .text section is extracted using objcopy:
+// address 0 and written out directly as a ROM image, either raw or as Intel
+// HEX records at the sections' load addresses:
 //
-//   ld.lld -Ttext=0 -o foo foo.o
-//   objcopy -O binary --only-section=.text foo output.bin
+//   ld.lld -Ttext=0 --oformat=binary -o foo.bin foo.o
+//   ld.lld -Ttext=0 --oformat=ihex -o foo.hex foo.o
+//
+// Objects built with -mrelax mark 32-bit absolute global accesses made with
+// B at __data_bank_base with R_M65832_RELAX. When the global lands within
+// 64K of __data_bank_base the access is shortened to its B-relative form,
+// and the two bytes it no longer needs are deleted from the section.
+//
+// Direct tail calls, LD.L R31,#target; JMP (R31), are marked the same way
+// and become a 3-byte BRA when the target is within 32K.
+//
+// -fPIC code reaches symbols through R_M65832_PCREL_32, the distance from
+// the instruction to its target, so a linked image runs unchanged at any
+// load address as long as code and data move together.
+//
+// Thread-local variables are reached as R56 + R_M65832_TPREL_32. R56 holds
+// the start of the running thread's copy of the TLS segment (for the main
+// thread, the segment itself, which crt0 loads as __tls_base), so the
+// relocation is the symbol's offset within PT_TLS. There is no dynamic
+// loader, so local-exec is the only model.
 //
 //===----------------------------------------------------------------------===//
 
+#include "InputFiles.h"
+#include "OutputSections.h"
 #include "Symbols.h"
 #include "Target.h"
 #include "llvm/BinaryFormat/ELF.h"
 #include "llvm/Support/Endian.h"
+#include "llvm/Support/LEB128.h"
+#include "llvm/Support/MathExtras.h"
 
 using namespace llvm;
 using namespace llvm::object;
@@ -39,28 +62,60 @@ public:
                      const uint8_t *loc) const override;
   void relocate(uint8_t *loc, const Relocation &rel,
                 uint64_t val) const override;
+  void relocateAlloc(InputSection &sec, uint8_t *buf) const override;
+  bool needsThunk(RelExpr expr, RelType type, const InputFile *file,
+                  uint64_t branchAddr, const Symbol &s,
+                  int64_t a) const override;
+  uint32_t getThunkSectionSpacing() const override;
+  bool inBranchRange(RelType type, uint64_t src,
+                     uint64_t dst) const override;
+  bool relaxOnce(int pass) const override;
+  void finalizeRelax(int passes) const override;
 };
 } // namespace
 
 M65832::M65832(Ctx &ctx) : TargetInfo(ctx) {
-  // NOP opcode is $EA (same as 6502)
-  trapInstr = {0xEA, 0xEA, 0xEA, 0xEA};
+  // STP ($DB) halts the processor, so a wild jump into the padding between
+  // sections stops there instead of sliding into the next function
+  trapInstr = {0xDB, 0xDB, 0xDB, 0xDB};
   // Default page size for M65832 (64KB bank)
   defaultMaxPageSize = 0x10000;
   defaultImageBase = 0;
+  needsThunks = true;
 }
 
 RelExpr M65832::getRelExpr(RelType type, const Symbol &s,
                            const uint8_t *loc) const {
   switch (type) {
+  case R_M65832_NONE:
+    return R_NONE;
   case R_M65832_PCREL_8:
   case R_M65832_PCREL_16:
+  case R_M65832_PCREL_32:
     return R_PC;
   case R_M65832_8:
   case R_M65832_16:
   case R_M65832_24:
   case R_M65832_32:
+  case R_M65832_GPREL_32:
+  case R_M65832_BANKREL_16:
+  case R_M65832_DP_8:
     return R_ABS;
+  case R_M65832_ADD8:
+  case R_M65832_ADD16:
+  case R_M65832_ADD32:
+  case R_M65832_ADD_ULEB128:
+  case R_M65832_SUB8:
+  case R_M65832_SUB16:
+  case R_M65832_SUB32:
+  case R_M65832_SUB_ULEB128:
+    // Same semantics as the RISC-V add/sub relocations
+    return RE_RISCV_ADD;
+  case R_M65832_TPREL_32:
+    return R_TPREL;
+  case R_M65832_RELAX:
+  case R_M65832_ALIGN:
+    return ctx.arg.relax ? R_RELAX_HINT : R_NONE;
   default:
     Err(ctx) << getErrorLoc(ctx, loc) << "unknown relocation (" << type.v
              << ") against symbol " << &s;
@@ -68,8 +123,44 @@ RelExpr M65832::getRelExpr(RelType type, const Symbol &s,
   }
 }
 
+// Add \p val to the ULEB128 at \p loc, keeping its encoded length
+static void addToUleb128(Ctx &ctx, uint8_t *loc, uint64_t val) {
+  const uint32_t maxcount = 1 + 64 / 7;
+  uint32_t count;
+  const char *error = nullptr;
+  uint64_t orig = decodeULEB128(loc, &count, nullptr, &error);
+  if (count > maxcount || (count == maxcount && error))
+    Err(ctx) << getErrorLoc(ctx, loc) << "extra space for uleb128";
+  uint64_t mask = count < maxcount ? (1ULL << 7 * count) - 1 : -1ULL;
+  encodeULEB128((orig + val) & mask, loc, count);
+}
+
 void M65832::relocate(uint8_t *loc, const Relocation &rel, uint64_t val) const {
   switch (rel.type) {
+  case R_M65832_ADD8:
+    *loc += val;
+    break;
+  case R_M65832_ADD16:
+    write16le(loc, read16le(loc) + val);
+    break;
+  case R_M65832_ADD32:
+    write32le(loc, read32le(loc) + val);
+    break;
+  case R_M65832_ADD_ULEB128:
+    addToUleb128(ctx, loc, val);
+    break;
+  case R_M65832_SUB8:
+    *loc -= val;
+    break;
+  case R_M65832_SUB16:
+    write16le(loc, read16le(loc) - val);
+    break;
+  case R_M65832_SUB32:
+    write32le(loc, read32le(loc) - val);
+    break;
+  case R_M65832_SUB_ULEB128:
+    addToUleb128(ctx, loc, -val);
+    break;
   case R_M65832_8:
     checkIntUInt(ctx, loc, val, 8, rel);
     *loc = val;
@@ -87,6 +178,43 @@ void M65832::relocate(uint8_t *loc, const Relocation &rel, uint64_t val) const {
     checkIntUInt(ctx, loc, val, 32, rel);
     write32le(loc, val);
     break;
+  case R_M65832_GPREL_32: {
+    const Defined *gp = ctx.sym.m65832GlobalPointer;
+    if (!gp) {
+      Err(ctx) << getErrorLoc(ctx, loc) << rel.type
+               << " requires __global_pointer$ to be defined";
+      return;
+    }
+    write32le(loc, val - gp->getVA(ctx));
+    break;
+  }
+  case R_M65832_BANKREL_16: {
+    const Defined *bank = ctx.sym.m65832DataBank;
+    if (!bank) {
+      Err(ctx) << getErrorLoc(ctx, loc) << rel.type
+               << " requires __data_bank_base to be defined";
+      return;
+    }
+    // Out of range means .data/.bss do not fit in the 64K data bank. Report
+    // a target below __data_bank_base as a negative offset.
+    int64_t offset = val - bank->getVA(ctx);
+    if (!isUInt<16>(offset))
+      reportRangeError(ctx, loc, rel, Twine(offset), 0, maxUIntN(16));
+    write16le(loc, offset);
+    break;
+  }
+  case R_M65832_DP_8: {
+    const Defined *dp = ctx.sym.m65832DirectPage;
+    if (!dp) {
+      Err(ctx) << getErrorLoc(ctx, loc) << rel.type
+               << " requires __direct_page to be defined";
+      return;
+    }
+    uint64_t offset = val - dp->getVA(ctx);
+    checkUInt(ctx, loc, offset, 8, rel);
+    *loc = offset;
+    break;
+  }
   case R_M65832_PCREL_8: {
     int64_t offset = val;
     checkInt(ctx, loc, offset, 8, rel);
@@ -99,9 +227,280 @@ void M65832::relocate(uint8_t *loc, const Relocation &rel, uint64_t val) const {
     write16le(loc, offset);
     break;
   }
+  case R_M65832_PCREL_32:
+  case R_M65832_TPREL_32:
+    write32le(loc, val);
+    break;
   default:
     Err(ctx) << getErrorLoc(ctx, loc) << "unrecognized relocation " << rel.type;
   }
 }
 
+// relocate() writes only the bytes of its own relocation and reads nothing
+// but symbol values, so sections may be relocated concurrently. An LTO
+// build puts most code in one .text section, which a single task has to
+// get through, so keep the common case cheap: a 32-bit absolute address
+// (JSR, LD.L #sym, %bankabs) needs no getRelocTargetVA dispatch, and no
+// range check, since a sign-extended 32-bit value always fits.
+void M65832::relocateAlloc(InputSection &sec, uint8_t *buf) const {
+  uint64_t secAddr = sec.getOutputSection()->addr + sec.outSecOff;
+  for (const Relocation &rel : sec.relocs()) {
+    uint8_t *loc = buf + rel.offset;
+    if (rel.expr == R_ABS && rel.type == R_M65832_32) {
+      write32le(loc, rel.sym->getVA(ctx, rel.addend));
+      continue;
+    }
+    if (rel.expr == R_RELAX_HINT)
+      continue;
+    uint64_t val = SignExtend64<32>(
+        sec.getRelocTargetVA(ctx, rel, secAddr + rel.offset));
+    relocate(loc, rel, val);
+  }
+}
+
+// Bcc/BRA/BRL reach +-32KB. An out-of-range branch goes through a
+// LD.L R31,#dest; JMP (R31) thunk instead.
+bool M65832::needsThunk(RelExpr expr, RelType type, const InputFile *file,
+                        uint64_t branchAddr, const Symbol &s,
+                        int64_t a) const {
+  if (type != R_M65832_PCREL_16)
+    return false;
+  return !inBranchRange(type, branchAddr, s.getVA(ctx, a));
+}
+
+// Leave room below the 32KB reach for the thunks themselves.
+uint32_t M65832::getThunkSectionSpacing() const { return 0x8000 - 0x1000; }
+
+bool M65832::inBranchRange(RelType type, uint64_t src, uint64_t dst) const {
+  if (type != R_M65832_PCREL_16)
+    return true;
+  return isInt<16>(dst - src);
+}
+
+static bool relaxable(ArrayRef<Relocation> relocs, size_t i) {
+  return i + 1 != relocs.size() && relocs[i + 1].type == R_M65832_RELAX;
+}
+
+// Shorten a relaxable extended-ALU access, $02 op mode dest abs32, to
+// $02 op mode' dest abs16 (B+addr) when its target is in reach of B.
+static void relaxBankAbs(Ctx &ctx, const InputSection &sec, size_t i,
+                         const Relocation &r, uint32_t &remove) {
+  const Defined *bank = ctx.sym.m65832DataBank;
+  if (!bank)
+    return;
+  uint64_t offset = r.sym->getVA(ctx, r.addend) - bank->getVA(ctx);
+  if (!isUInt<16>(offset))
+    return;
+  sec.relaxAux->relocTypes[i] = R_M65832_BANKREL_16;
+  remove = 2;
+}
+
+// Whether the relaxable R_M65832_32 at \p offset is the immediate of
+// LD.L Rn,#target; JMP (Rn), $02 $80 $B8 Rn imm32 $02 $A5 Rn.
+static bool isLongJump(ArrayRef<uint8_t> content, uint64_t offset) {
+  if (offset < 4 || offset + 7 > content.size())
+    return false;
+  const uint8_t *p = content.data() + offset;
+  return (p[-2] & 0x1F) == 0x18 && p[4] == 0x02 && p[5] == 0xA5 &&
+         p[6] == p[-1];
+}
+
+// Replace a long jump with BRA rel16, measured from the end of the BRA,
+// which starts 4 bytes before the immediate at \p loc.
+static void relaxLongJump(Ctx &ctx, const InputSection &sec, size_t i,
+                          uint64_t loc, const Relocation &r,
+                          uint32_t &remove) {
+  int64_t displace = r.sym->getVA(ctx, r.addend) - (loc - 4 + 3);
+  if (!isInt<16>(displace))
+    return;
+  sec.relaxAux->relocTypes[i] = R_M65832_PCREL_16;
+  remove = 8;
+}
+
+static bool relax(Ctx &ctx, int pass, InputSection &sec) {
+  const uint64_t secAddr = sec.getVA();
+  const MutableArrayRef<Relocation> relocs = sec.relocs();
+  // Thunk sections added after the first pass have nothing to relax.
+  if (!sec.relaxAux)
+    return false;
+  auto &aux = *sec.relaxAux;
+  bool changed = false;
+  ArrayRef<SymbolAnchor> sa = ArrayRef(aux.anchors);
+  uint64_t delta = 0;
+
+  std::fill_n(aux.relocTypes.get(), relocs.size(), R_M65832_NONE);
+  for (auto [i, r] : llvm::enumerate(relocs)) {
+    const uint64_t loc = secAddr + r.offset - delta;
+    uint32_t &cur = aux.relocDeltas[i], remove = 0;
+    switch (r.type) {
+    case R_M65832_ALIGN: {
+      // The assembler padded with align-1 NOPs; keep only those needed
+      const uint64_t nextLoc = loc + r.addend;
+      const uint64_t align = PowerOf2Ceil(r.addend + 1);
+      remove = nextLoc - ((loc + align - 1) & -align);
+      break;
+    }
+    case R_M65832_32: {
+      if (!relaxable(relocs, i))
+        break;
+      // Shrinking code can move __data_bank_base or the target and undo
+      // an earlier decision; after a few passes keep the previous one,
+      // and let the new relocation report a target that fell out of reach
+      bool jump = isLongJump(sec.content(), r.offset);
+      if (pass < 4) {
+        if (jump)
+          relaxLongJump(ctx, sec, i, loc, r, remove);
+        else
+          relaxBankAbs(ctx, sec, i, r, remove);
+      } else if (cur - delta == (jump ? 8 : 2)) {
+        aux.relocTypes[i] = jump ? R_M65832_PCREL_16 : R_M65832_BANKREL_16;
+        remove = cur - delta;
+      }
+      break;
+    }
+    }
+
+    // For all anchors whose offsets are <= r.offset, they are preceded by
+    // the previous relocation whose `relocDeltas` value equals `delta`.
+    // Decrease their st_value and update their st_size.
+    for (; sa.size() && sa[0].offset <= r.offset; sa = sa.slice(1)) {
+      if (sa[0].end)
+        sa[0].d->size = sa[0].offset - delta - sa[0].d->value;
+      else
+        sa[0].d->value = sa[0].offset - delta;
+    }
+    delta += remove;
+    if (delta != cur) {
+      cur = delta;
+      changed = true;
+    }
+  }
+
+  for (const SymbolAnchor &a : sa) {
+    if (a.end)
+      a.d->size = a.offset - delta - a.d->value;
+    else
+      a.d->value = a.offset - delta;
+  }
+  // Inform assignAddresses that the size has changed.
+  if (!isUInt<32>(delta))
+    Err(ctx) << "section size decrease is too large: " << delta;
+  sec.bytesDropped = delta;
+  return changed;
+}
+
+// Section shrinkage can bring further globals into reach of B, so iterate
+// until nothing changes.
+bool M65832::relaxOnce(int pass) const {
+  if (pass == 0)
+    initSymbolAnchors(ctx);
+
+  SmallVector<InputSection *, 0> storage;
+  bool changed = false;
+  for (OutputSection *osec : ctx.outputSections) {
+    if (!(osec->flags & SHF_EXECINSTR))
+      continue;
+    for (InputSection *sec : getInputSections(*osec, storage))
+      changed |= relax(ctx, pass, *sec);
+  }
+  return changed;
+}
+
+// Alignment padding, as the assembler writes it: NOPs, with a BRA over
+// them once there are more than three.
+static void writeNops(uint8_t *p, uint64_t n) {
+  while (n > 3) {
+    uint64_t skip = std::min<uint64_t>(n - 3, INT16_MAX);
+    *p++ = 0x80; // BRA rel16
+    write16le(p, skip);
+    p += 2;
+    memset(p, 0xEA, skip);
+    p += skip;
+    n -= 3 + skip;
+  }
+  memset(p, 0xEA, n);
+}
+
+void M65832::finalizeRelax(int passes) const {
+  Log(ctx) << "relaxation passes: " << passes;
+  SmallVector<InputSection *, 0> storage;
+  for (OutputSection *osec : ctx.outputSections) {
+    if (!(osec->flags & SHF_EXECINSTR))
+      continue;
+    for (InputSection *sec : getInputSections(*osec, storage)) {
+      if (!sec->relaxAux || !sec->relaxAux->relocDeltas)
+        continue;
+      RelaxAux &aux = *sec->relaxAux;
+
+      MutableArrayRef<Relocation> rels = sec->relocs();
+      ArrayRef<uint8_t> old = sec->content();
+      size_t newSize = old.size() - aux.relocDeltas[rels.size() - 1];
+      uint8_t *p = ctx.bAlloc.Allocate<uint8_t>(newSize);
+      uint64_t offset = 0;
+      int64_t delta = 0;
+      sec->content_ = p;
+      sec->size = newSize;
+      sec->bytesDropped = 0;
+
+      // Update section content: drop surplus alignment NOPs, rewrite the
+      // mode byte of each shortened access and turn relaxed long jumps
+      // into BRA.
+      for (size_t i = 0, e = rels.size(); i != e; ++i) {
+        uint32_t remove = aux.relocDeltas[i] - delta;
+        delta = aux.relocDeltas[i];
+        if (remove == 0 && aux.relocTypes[i] == R_M65832_NONE)
+          continue;
+
+        // Copy from last location to the current relocated location.
+        const Relocation &r = rels[i];
+        uint64_t size = r.offset - offset;
+        memcpy(p, old.data() + offset, size);
+        p += size;
+
+        int64_t skip = 0;
+        if (r.type == R_M65832_ALIGN) {
+          skip = r.addend - remove;
+          writeNops(p, skip);
+        } else if (aux.relocTypes[i] == R_M65832_BANKREL_16) {
+          // The mode byte precedes the destination register byte; its
+          // addressing-mode field goes from abs32 ($10) to abs16 ($08)
+          p[-2] = (p[-2] & ~0x1F) | 0x08;
+          skip = 2;
+        } else if (aux.relocTypes[i] == R_M65832_PCREL_16) {
+          // BRA rel16 replaces $02 $80 $B8 Rn, and ends 1 byte early;
+          // the immediate and the JMP (Rn) that follows are deleted
+          p[-4] = 0x80;
+          skip = -1;
+        }
+
+        p += skip;
+        offset = r.offset + skip + remove;
+      }
+      memcpy(p, old.data() + offset, old.size() - offset);
+
+      // Subtract the previous relocDeltas value from the relocation offset.
+      // For a pair of R_M65832_32/R_M65832_RELAX with the same offset,
+      // decrease their r_offset by the same delta.
+      delta = 0;
+      for (size_t i = 0, e = rels.size(); i != e;) {
+        uint64_t cur = rels[i].offset;
+        do {
+          rels[i].offset -= delta;
+          if (aux.relocTypes[i] == R_M65832_PCREL_16) {
+            // The BRA operand sits 3 bytes before the old immediate, and
+            // like the assembler's, its addend makes it relative to the
+            // end of the BRA
+            rels[i].offset -= 3;
+            rels[i].addend -= 2;
+            rels[i].expr = R_PC;
+          }
+          if (aux.relocTypes[i] != R_M65832_NONE)
+            rels[i].type = aux.relocTypes[i];
+        } while (++i != e && rels[i].offset == cur);
+        delta = aux.relocDeltas[i - 1];
+      }
+    }
+  }
+}
+
 void elf::setM65832TargetInfo(Ctx &ctx) { ctx.target.reset(new M65832(ctx)); }
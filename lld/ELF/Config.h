@@ -234,6 +234,7 @@ struct Config {
   llvm::StringRef ltoNewPmPasses;
   llvm::StringRef ltoObjPath;
   llvm::StringRef ltoSampleProfile;
+  llvm::StringRef m65832JsonMap;
   llvm::StringRef mapFile;
   llvm::StringRef outputFile;
   llvm::StringRef optRemarksFilename;
@@ -345,6 +346,7 @@ struct Config {
   bool ltoUniqueBasicBlockSectionNames;
   bool ltoValidateAllVtablesHaveTypeInfos;
   bool ltoWholeProgramVisibility;
+  bool m65832BankPack;
   bool mergeArmExidx;
   bool mipsN32Abi = false;
   bool mmapOutputFile;
@@ -352,6 +354,7 @@ struct Config {
   bool noinhibitExec;
   bool nostdlib;
   bool oFormatBinary;
+  bool oFormatIHex;
   bool omagic;
   bool optEB = false;
   bool optEL = false;
@@ -582,6 +585,7 @@ struct InStruct {
   std::unique_ptr<RelroPaddingSection> relroPadding;
   std::unique_ptr<SyntheticSection> armCmseSGSection;
   std::unique_ptr<PPC64LongBranchTargetSection> ppc64LongBranchTarget;
+  std::unique_ptr<SyntheticSection> m65832CopyTable;
   std::unique_ptr<SyntheticSection> mipsAbiFlags;
   std::unique_ptr<MipsGotSection> mipsGot;
   std::unique_ptr<SyntheticSection> mipsOptions;
@@ -658,6 +662,15 @@ struct Ctx : CommonLinkerContext {
     // __global_pointer$ for RISC-V.
     Defined *riscvGlobalPointer;
 
+    // __global_pointer$ for M65832, the base of R_M65832_GPREL_32.
+    Defined *m65832GlobalPointer;
+
+    // __data_bank_base for M65832, the base of R_M65832_BANKREL_16.
+    Defined *m65832DataBank;
+
+    // __direct_page for M65832, the base of R_M65832_DP_8.
+    Defined *m65832DirectPage;
+
     // __rel{,a}_iplt_{start,end} symbols.
     Defined *relaIpltStart;
     Defined *relaIpltEnd;
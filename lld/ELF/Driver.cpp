@@ -176,6 +176,7 @@ static std::tuple<ELFKind, uint16_t, uint8_t> parseEmulation(Ctx &ctx,
           .Case("elf_i386", {ELF32LEKind, EM_386})
           .Case("elf_iamcu", {ELF32LEKind, EM_IAMCU})
           .Case("elf64_sparc", {ELF64BEKind, EM_SPARCV9})
+          .Case("m65832elf", {ELF32LEKind, EM_M65832})
           .Case("msp430elf", {ELF32LEKind, EM_MSP430})
           .Case("elf64_amdgpu", {ELF64LEKind, EM_AMDGPU})
           .Case("elf64loongarch", {ELF64LEKind, EM_LOONGARCH})
@@ -385,6 +386,11 @@ static void checkOptions(Ctx &ctx) {
       ErrAlways(ctx) << "--be8 is only supported on ARM targets";
   }
 
+  if (ctx.arg.emachine != EM_M65832 && ctx.arg.m65832BankPack)
+    ErrAlways(ctx) << "--m65832-bank-pack is only supported on M65832";
+  if (ctx.arg.emachine != EM_M65832 && !ctx.arg.m65832JsonMap.empty())
+    ErrAlways(ctx) << "--m65832-json-map is only supported on M65832";
+
   if (ctx.arg.emachine != EM_AARCH64) {
     if (ctx.arg.executeOnly)
       ErrAlways(ctx) << "--execute-only is only supported on AArch64 targets";
@@ -815,7 +821,7 @@ static Target2Policy getTarget2(Ctx &ctx, opt::InputArgList &args) {
 
 static bool isOutputFormatBinary(Ctx &ctx, opt::InputArgList &args) {
   StringRef s = args.getLastArgValue(OPT_oformat, "elf");
-  if (s == "binary")
+  if (s == "binary" || s == "ihex")
     return true;
   if (!s.starts_with("elf"))
     ErrAlways(ctx) << "unknown --oformat value: " << s;
@@ -1479,6 +1485,8 @@ static void readConfigs(Ctx &ctx, opt::InputArgList &args) {
                    OPT_no_lto_unique_basic_block_section_names, false);
   ctx.arg.mapFile = args.getLastArgValue(OPT_Map);
   ctx.arg.mipsGotSize = args::getInteger(args, OPT_mips_got_size, 0xfff0);
+  ctx.arg.m65832BankPack = args.hasArg(OPT_m65832_bank_pack);
+  ctx.arg.m65832JsonMap = args.getLastArgValue(OPT_m65832_json_map);
   ctx.arg.mergeArmExidx =
       args.hasFlag(OPT_merge_exidx_entries, OPT_no_merge_exidx_entries, true);
   ctx.arg.mmapOutputFile =
@@ -1487,6 +1495,7 @@ static void readConfigs(Ctx &ctx, opt::InputArgList &args) {
   ctx.arg.noinhibitExec = args.hasArg(OPT_noinhibit_exec);
   ctx.arg.nostdlib = args.hasArg(OPT_nostdlib);
   ctx.arg.oFormatBinary = isOutputFormatBinary(ctx, args);
+  ctx.arg.oFormatIHex = args.getLastArgValue(OPT_oformat) == "ihex";
   ctx.arg.omagic = args.hasFlag(OPT_omagic, OPT_no_omagic, false);
   ctx.arg.optRemarksFilename = args.getLastArgValue(OPT_opt_remarks_filename);
   ctx.arg.optStatsFilename = args.getLastArgValue(OPT_plugin_opt_stats_file);
@@ -2064,6 +2073,9 @@ static void setConfigs(Ctx &ctx, opt::InputArgList &args) {
     if (auto e = tryCreateFile(ctx.arg.mapFile))
       ErrAlways(ctx) << "cannot open map file " << ctx.arg.mapFile << ": "
                      << e.message();
+    if (auto e = tryCreateFile(ctx.arg.m65832JsonMap))
+      ErrAlways(ctx) << "cannot open --m65832-json-map= file "
+                     << ctx.arg.m65832JsonMap << ": " << e.message();
     if (auto e = tryCreateFile(ctx.arg.whyExtract))
       ErrAlways(ctx) << "cannot open --why-extract= file " << ctx.arg.whyExtract
                      << ": " << e.message();
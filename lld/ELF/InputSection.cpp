@@ -432,10 +432,11 @@ InputSectionBase *InputSection::getRelocatedSection() const {
 template <class ELFT, class RelTy>
 void InputSection::copyRelocations(Ctx &ctx, uint8_t *buf) {
   bool linkerRelax =
-      ctx.arg.relax && is_contained({EM_RISCV, EM_LOONGARCH}, ctx.arg.emachine);
+      ctx.arg.relax &&
+      is_contained({EM_RISCV, EM_LOONGARCH, EM_M65832}, ctx.arg.emachine);
   if (!ctx.arg.relocatable && (linkerRelax || ctx.arg.branchToBranch)) {
-    // On LoongArch and RISC-V, relaxation might change relocations: copy
-    // from internal ones that are updated by relaxation.
+    // On LoongArch, M65832 and RISC-V, relaxation might change relocations:
+    // copy from internal ones that are updated by relaxation.
     InputSectionBase *sec = getRelocatedSection();
     copyRelocations<ELFT, RelTy>(
         ctx, buf,
@@ -778,6 +779,9 @@ static int64_t getTlsTpOffset(Ctx &ctx, const Symbol &s) {
     // to allow a signed 16-bit offset to reach 0x1000 of TCB/thread-library
     // data and 0xf000 of the program's TLS segment.
     return s.getVA(ctx, 0) + (tls->p_vaddr & (tls->p_align - 1)) - 0x7000;
+  case EM_M65832:
+    // Variant 1 without a TCB: TP (R56) is the start of the TLS block
+    return s.getVA(ctx, 0) + (tls->p_vaddr & (tls->p_align - 1));
   case EM_LOONGARCH:
   case EM_RISCV:
     // See the comment in handleTlsRelocation. For TLSDESC=>IE,
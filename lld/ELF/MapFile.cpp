@@ -16,6 +16,8 @@
 //   0020100e 00000000     0                 local
 //   00201005 00000000     0                 f(int)
 //
+// It also implements --m65832-json-map=, a per-function listing for tools.
+//
 //===----------------------------------------------------------------------===//
 
 #include "MapFile.h"
@@ -27,6 +29,8 @@
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/JSON.h"
 #include "llvm/Support/Parallel.h"
 #include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/raw_ostream.h"
@@ -278,3 +282,86 @@ void elf::writeMapAndCref(Ctx &ctx) {
   if (ctx.arg.cref)
     writeCref(ctx, os);
 }
+
+// Reads the .m65832.cycles sections that llc -m65832-cycle-info emits: one
+// (function address, estimated cycles) pair of 32-bit words per function,
+// with an R_M65832_32 relocation naming the function.
+static DenseMap<const Symbol *, uint32_t> readM65832Cycles(Ctx &ctx) {
+  DenseMap<const Symbol *, uint32_t> ret;
+  for (ELFFileBase *file : ctx.objectFiles) {
+    for (InputSectionBase *sec : file->getSections()) {
+      if (!sec || sec == &InputSection::discarded || !sec->isLive() ||
+          sec->name != ".m65832.cycles")
+        continue;
+      ArrayRef<uint8_t> data = sec->content();
+      auto read = [&](const auto &rels) {
+        for (const auto &rel : rels)
+          if (rel.r_offset + 8 <= data.size())
+            ret[&file->getRelocTargetSym(rel)] =
+                support::endian::read32le(data.data() + rel.r_offset + 4);
+      };
+      const RelsOrRelas<ELF32LE> rels = sec->relsOrRelas<ELF32LE>();
+      if (rels.areRelocsCrel())
+        read(rels.crels);
+      else if (rels.areRelocsRel())
+        read(rels.rels);
+      else
+        read(rels.relas);
+    }
+  }
+  return ret;
+}
+
+// --m65832-json-map= lists every function in the image by address, for
+// tools that track size and cycle counts per symbol from build to build:
+//
+//   {"output": "a.out", "functions": [{"name": "main", "address": 4096,
+//    "bank": 0, "size": 52, "section": ".text", "file": "main.o",
+//    "cycles": 61}, ...]}
+//
+// "cycles" is present only for functions compiled with -m65832-cycle-info.
+void elf::writeM65832JsonMap(Ctx &ctx) {
+  if (ctx.arg.m65832JsonMap.empty())
+    return;
+
+  llvm::TimeTraceScope timeScope("Write JSON map file");
+
+  std::error_code ec;
+  raw_fd_ostream os = ctx.openAuxiliaryFile(ctx.arg.m65832JsonMap, ec);
+  if (ec) {
+    ErrAlways(ctx) << "cannot open " << ctx.arg.m65832JsonMap << ": "
+                   << ec.message();
+    return;
+  }
+
+  DenseMap<const Symbol *, uint32_t> cycles = readM65832Cycles(ctx);
+  std::vector<std::pair<uint64_t, Defined *>> funcs;
+  for (Defined *dr : getSymbols(ctx))
+    if (dr->isFunc())
+      funcs.emplace_back(dr->getVA(ctx), dr);
+  llvm::stable_sort(funcs, [](const auto &a, const auto &b) {
+    return a.first < b.first;
+  });
+
+  json::OStream j(os, 2);
+  j.object([&] {
+    j.attribute("output", ctx.arg.outputFile);
+    j.attributeArray("functions", [&] {
+      for (auto [va, sym] : funcs) {
+        j.object([&] {
+          j.attribute("name", sym->getName());
+          j.attribute("address", va);
+          j.attribute("bank", va >> 16);
+          j.attribute("size", sym->size);
+          if (OutputSection *osec = sym->getOutputSection())
+            j.attribute("section", osec->name);
+          j.attribute("file", toStr(ctx, sym->file));
+          auto it = cycles.find(sym);
+          if (it != cycles.end())
+            j.attribute("cycles", it->second);
+        });
+      }
+    });
+  });
+  os << '\n';
+}
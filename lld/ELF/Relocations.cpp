@@ -90,6 +90,9 @@ void elf::reportRangeError(Ctx &ctx, uint8_t *loc, const Relocation &rel,
       diag << "; R_X86_64_PC32 should not reference a section marked "
               "SHF_X86_64_LARGE";
     }
+    if (ctx.arg.emachine == EM_M65832 && rel.type == R_M65832_BANKREL_16)
+      diag << "; the target is outside the 64K data bank at __data_bank_base"
+           << (ctx.arg.m65832BankPack ? "" : " (see --m65832-bank-pack)");
   }
   if (!errPlace.srcLoc.empty())
     diag << "\n>>> referenced by " << errPlace.srcLoc;
@@ -1350,9 +1353,9 @@ void TargetInfo::scanSectionImpl(InputSectionBase &sec, Relocs<RelTy> rels) {
   }
 
   // Sort relocations by offset for more efficient searching for
-  // R_RISCV_PCREL_HI20, ALIGN relocations, R_PPC64_ADDR64 and the
+  // R_RISCV_PCREL_HI20, ALIGN and RELAX relocations, R_PPC64_ADDR64 and the
   // branch-to-branch optimization.
-  if (is_contained({EM_RISCV, EM_LOONGARCH}, ctx.arg.emachine) ||
+  if (is_contained({EM_RISCV, EM_LOONGARCH, EM_M65832}, ctx.arg.emachine) ||
       (ctx.arg.emachine == EM_PPC64 && sec.name == ".toc") ||
       ctx.arg.branchToBranch)
     llvm::stable_sort(sec.relocs(),
@@ -1870,6 +1873,9 @@ static int64_t getPCBias(Ctx &ctx, const InputSection &isec,
   }
   if (ctx.arg.emachine == EM_HEXAGON)
     return -getHexagonPacketOffset(isec, rel);
+  // A rel16 branch counts from the end of the instruction
+  if (ctx.arg.emachine == EM_M65832 && rel.type == R_M65832_PCREL_16)
+    return 2;
   return 0;
 }
 
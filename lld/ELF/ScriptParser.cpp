@@ -493,8 +493,9 @@ void ScriptParser::readOutputFormat() {
     return;
   ctx.arg.bfdname = s;
 
-  if (s == "binary") {
+  if (s == "binary" || s == "ihex") {
     ctx.arg.oFormatBinary = true;
+    ctx.arg.oFormatIHex = s == "ihex";
     return;
   }
 
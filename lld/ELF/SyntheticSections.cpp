@@ -4509,6 +4509,53 @@ void PartitionIndexSection::writeTo(uint8_t *buf) {
   }
 }
 
+M65832CopyTableSection::M65832CopyTableSection(Ctx &ctx)
+    : SyntheticSection(ctx, ".copy_table", SHT_PROGBITS, SHF_ALLOC, 4) {}
+
+void M65832CopyTableSection::finalizeContents() {
+  // The LMA of a section without AT may still differ from its VMA (it keeps
+  // the offset of the section before it in the region), which is not known
+  // until addresses are assigned. Every loaded writable section gets an
+  // entry and the startup code skips those that are already in place.
+  // (NOLOAD) sections such as a heap are neither copied nor cleared.
+  // Read-only sections are copied only when the script gives them a load
+  // address of their own, e.g. .ramfunc code placed > RAM AT > ROM.
+  for (OutputSection *os : ctx.outputSections) {
+    if (!(os->flags & SHF_ALLOC) || (os->flags & SHF_TLS))
+      continue;
+    if (!(os->flags & SHF_WRITE) && !os->lmaExpr && !os->lmaRegion)
+      continue;
+    if (os->type != SHT_NOBITS)
+      copies.push_back(os);
+    else if (!os->typeIsSet)
+      zeros.push_back(os);
+  }
+
+  // The symbols were defined at offset 0 before the size was known
+  auto setValue = [&](StringRef name, uint64_t value) {
+    if (auto *d = dyn_cast_or_null<Defined>(ctx.symtab->find(name)))
+      if (d->section == this)
+        d->value = value;
+  };
+  setValue("__copy_table_end", 12 * copies.size());
+  setValue("__zero_table_start", 12 * copies.size());
+  setValue("__zero_table_end", getSize());
+}
+
+void M65832CopyTableSection::writeTo(uint8_t *buf) {
+  for (OutputSection *os : copies) {
+    write32(ctx, buf, os->getLMA());
+    write32(ctx, buf + 4, os->addr);
+    write32(ctx, buf + 8, os->size);
+    buf += 12;
+  }
+  for (OutputSection *os : zeros) {
+    write32(ctx, buf, os->addr);
+    write32(ctx, buf + 4, os->size);
+    buf += 8;
+  }
+}
+
 static bool needsInterpSection(Ctx &ctx) {
   return !ctx.arg.relocatable && !ctx.arg.shared &&
          !ctx.arg.dynamicLinker.empty() && ctx.script->needsInterpSection();
@@ -4854,6 +4901,21 @@ template <class ELFT> void elf::createSyntheticSections(Ctx &ctx) {
     add(*ctx.in.got);
   }
 
+  if (ctx.arg.emachine == EM_M65832 && !ctx.arg.relocatable) {
+    static constexpr const char *names[] = {
+        "__copy_table_start", "__copy_table_end", "__zero_table_start",
+        "__zero_table_end"};
+    if (llvm::any_of(names, [&](const char *name) {
+          Symbol *s = ctx.symtab->find(name);
+          return s && s->isUndefined();
+        })) {
+      ctx.in.m65832CopyTable = std::make_unique<M65832CopyTableSection>(ctx);
+      for (const char *name : names)
+        addOptionalRegular(ctx, name, ctx.in.m65832CopyTable.get(), 0);
+      add(*ctx.in.m65832CopyTable);
+    }
+  }
+
   if (ctx.arg.emachine == EM_PPC) {
     ctx.in.ppc32Got2 = std::make_unique<PPC32Got2Section>(ctx);
     add(*ctx.in.ppc32Got2);
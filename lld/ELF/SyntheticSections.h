@@ -1394,6 +1394,26 @@ public:
   void writeTo(uint8_t *buf) override;
 };
 
+// The RAM initialization table for M65832 ROM images. Startup code walks
+// __copy_table_start..__copy_table_end, {LMA, VMA, size} per writable
+// section (and per read-only one with an AT load address, such as
+// .ramfunc), copying each one whose LMA differs from its VMA, and then
+// __zero_table_start..__zero_table_end, {VMA, size} per .bss-like section.
+// Created only when startup code refers to one of those symbols.
+class M65832CopyTableSection final : public SyntheticSection {
+public:
+  M65832CopyTableSection(Ctx &);
+  size_t getSize() const override {
+    return 12 * copies.size() + 8 * zeros.size();
+  }
+  void finalizeContents() override;
+  void writeTo(uint8_t *buf) override;
+
+private:
+  SmallVector<OutputSection *, 0> copies;
+  SmallVector<OutputSection *, 0> zeros;
+};
+
 // See the following link for the Android-specific loader code that operates on
 // this section:
 // https://cs.android.com/android/platform/superproject/+/master:bionic/libc/bionic/libc_init_static.cpp;drc=9425b16978f9c5aa8f2c50c873db470819480d1d;l=192
@@ -431,6 +431,18 @@ public:
   void addSymbols(ThunkSection &isec) override;
 };
 
+// M65832 R_M65832_PCREL_16 branches reach +-32KB. Further targets go
+// through LD.L R31,#dest; JMP (R31), the same sequence the compiler uses
+// for branches it has to relax; R31 is reserved for it.
+class M65832Thunk final : public Thunk {
+public:
+  M65832Thunk(Ctx &ctx, Symbol &dest, int64_t addend)
+      : Thunk(ctx, dest, addend) {}
+  uint32_t size() override { return 11; }
+  void writeTo(uint8_t *buf) override;
+  void addSymbols(ThunkSection &isec) override;
+};
+
 // MIPS LA25 thunk
 class MipsThunk final : public Thunk {
 public:
@@ -1245,6 +1257,23 @@ void AVRThunk::addSymbols(ThunkSection &isec) {
             isec);
 }
 
+void M65832Thunk::writeTo(uint8_t *buf) {
+  static const uint8_t inst[] = {
+      0x02, 0x80, 0xB8, 0x7C, 0, 0, 0, 0, // LD.L R31,#dest
+      0x02, 0xA5, 0x7C,                   // JMP (R31)
+  };
+  memcpy(buf, inst, sizeof(inst));
+  // The branch addend is relative to the end of the branch, two bytes past
+  // its relocation; the thunk jumps to the branch target itself.
+  ctx.target->relocateNoSym(buf + 4, R_M65832_32,
+                            destination.getVA(ctx, addend + 2));
+}
+
+void M65832Thunk::addSymbols(ThunkSection &isec) {
+  addSymbol(ctx.saver.save("__M65832LongThunk_" + destination.getName()),
+            STT_FUNC, 0, isec);
+}
+
 // Write MIPS LA25 thunk code to call PIC function from the non-PIC one.
 void MipsThunk::writeTo(uint8_t *buf) {
   uint64_t s = destination.getVA(ctx);
@@ -1759,6 +1788,14 @@ static std::unique_ptr<Thunk> addThunkHexagon(Ctx &ctx,
   }
 }
 
+static std::unique_ptr<Thunk> addThunkM65832(Ctx &ctx, RelType type,
+                                             Symbol &s, int64_t a) {
+  if (type != R_M65832_PCREL_16)
+    Fatal(ctx) << "unrecognized relocation " << type << " to " << &s
+               << " for M65832 target";
+  return std::make_unique<M65832Thunk>(ctx, s, a);
+}
+
 static std::unique_ptr<Thunk> addThunkMips(Ctx &ctx, RelType type, Symbol &s) {
   if ((s.stOther & STO_MIPS_MICROMIPS) && isMipsR6(ctx))
     return std::make_unique<MicroMipsR6Thunk>(ctx, s);
@@ -1830,9 +1867,11 @@ std::unique_ptr<Thunk> elf::addThunk(Ctx &ctx, const InputSection &isec,
     return addThunkPPC64(ctx, rel.type, s, a);
   case EM_HEXAGON:
     return addThunkHexagon(ctx, isec, rel, s);
+  case EM_M65832:
+    return addThunkM65832(ctx, rel.type, s, a);
   default:
-    llvm_unreachable(
-        "add Thunk only supported for ARM, AVR, Hexagon, Mips and PowerPC");
+    llvm_unreachable("add Thunk only supported for ARM, AVR, Hexagon, M65832, "
+                     "Mips and PowerPC");
   }
 }
 
@@ -80,6 +80,7 @@ private:
   void writeHeader();
   void writeSections();
   void writeSectionsBinary();
+  uint64_t writeIHex(uint8_t *out);
   void writeBuildId();
 
   Ctx &ctx;
@@ -93,6 +94,8 @@ private:
 
   uint64_t fileSize;
   uint64_t sectionHeaderOff;
+  // For --oformat=ihex, the binary image the records are encoded from.
+  std::unique_ptr<uint8_t[]> ihexImage;
 };
 } // anonymous namespace
 
@@ -350,6 +353,7 @@ template <class ELFT> void Writer<ELFT>::run() {
   // because the files may be useful in case checkSections() or openFile()
   // fails, for example, due to an erroneous file size.
   writeMapAndCref(ctx);
+  writeM65832JsonMap(ctx);
 
   // Handle --print-memory-usage option.
   if (ctx.arg.printMemoryUsage)
@@ -384,6 +388,9 @@ template <class ELFT> void Writer<ELFT>::run() {
     if (errCount(ctx))
       return;
 
+    if (ctx.arg.oFormatIHex)
+      writeIHex(buffer->getBufferStart());
+
     if (!ctx.e.disableOutput) {
       if (auto e = buffer->commit())
         Err(ctx) << "failed to write output '" << buffer->getPath()
@@ -1284,6 +1291,65 @@ static void sortSection(Ctx &ctx, OutputSection &osec,
   }
 }
 
+// --m65832-bank-pack: M65832 code reaches data B-relative with 16-bit
+// offsets from __data_bank_base. Move the data sections it reaches that way
+// to the front of each writable output section, so that they stay within
+// 64K even when .data and .bss as a whole do not. Sections that must be in
+// reach (R_M65832_BANKREL_16) go before those that -mrelax could shorten
+// accesses to (R_M65832_32 with R_M65832_RELAX); within each group, the
+// most references per byte go first. This also applies with a linker
+// script, as long as the script does not pin the order itself.
+static void packM65832DataBank(Ctx &ctx) {
+  struct BankRefs {
+    uint32_t required = 0;
+    uint32_t relaxable = 0;
+  };
+  DenseMap<const InputSectionBase *, BankRefs> refs;
+  for (InputSectionBase *sec : ctx.inputSections) {
+    if (!sec->isLive() || !(sec->flags & SHF_EXECINSTR))
+      continue;
+    ArrayRef<Relocation> rels = sec->relocs();
+    for (size_t i = 0, e = rels.size(); i != e; ++i) {
+      auto *d = dyn_cast<Defined>(rels[i].sym);
+      auto *target = d ? dyn_cast_or_null<InputSectionBase>(d->section)
+                       : nullptr;
+      if (!target)
+        continue;
+      if (rels[i].type == R_M65832_BANKREL_16)
+        ++refs[target].required;
+      else if (rels[i].type == R_M65832_32 && i + 1 != e &&
+               rels[i + 1].type == R_M65832_RELAX)
+        ++refs[target].relaxable;
+    }
+  }
+  if (refs.empty())
+    return;
+
+  auto rank = [&](const InputSection *s) {
+    BankRefs r = refs.lookup(s);
+    uint64_t size = std::max<uint64_t>(s->getSize(), 1);
+    return std::make_tuple(r.required != 0, r.relaxable != 0,
+                           double(r.required + r.relaxable) / size);
+  };
+  for (SectionCommand *cmd : ctx.script->sectionCommands) {
+    auto *osd = dyn_cast<OutputDesc>(cmd);
+    if (!osd || !(osd->osec.flags & SHF_WRITE) ||
+        (osd->osec.flags & SHF_EXECINSTR))
+      continue;
+    for (SectionCommand *b : osd->osec.commands) {
+      auto *isd = dyn_cast<InputSectionDescription>(b);
+      if (!isd || llvm::any_of(isd->sectionPatterns, [](auto &pat) {
+            return pat.sortOuter != SortSectionPolicy::Default;
+          }))
+        continue;
+      llvm::stable_sort(isd->sections,
+                        [&](const InputSection *a, const InputSection *b) {
+                          return rank(a) > rank(b);
+                        });
+    }
+  }
+}
+
 // Sort sections within each InputSectionDescription.
 template <class ELFT> void Writer<ELFT>::sortInputSections() {
   // Assign negative priorities.
@@ -1293,6 +1359,8 @@ template <class ELFT> void Writer<ELFT>::sortInputSections() {
   for (SectionCommand *cmd : ctx.script->sectionCommands)
     if (auto *osd = dyn_cast<OutputDesc>(cmd))
       sortSection(ctx, osd->osec, order);
+  if (ctx.arg.m65832BankPack)
+    packM65832DataBank(ctx);
 }
 
 template <class ELFT> void Writer<ELFT>::sortSections() {
@@ -1544,9 +1612,11 @@ template <class ELFT> void Writer<ELFT>::finalizeAddressDependentContent() {
   // the final addresses are unavailable.
   uint32_t pass = 0, assignPasses = 0;
   while (!ctx.arg.relocatable) {
-    bool changed = ctx.target->needsThunks
-                       ? tc.createThunks(pass, ctx.outputSections)
-                       : ctx.target->relaxOnce(pass);
+    // Only M65832 both relaxes and needs thunks; relaxOnce is a no-op for
+    // the other thunk targets.
+    bool changed = ctx.target->needsThunks &&
+                   tc.createThunks(pass, ctx.outputSections);
+    changed |= ctx.target->relaxOnce(pass);
     bool spilled = ctx.script->spillSections();
     changed |= spilled;
     ++pass;
@@ -1855,6 +1925,39 @@ template <class ELFT> void Writer<ELFT>::finalizeSections() {
       }
     }
 
+    // M65832 small data is addressed with 32-bit offsets from R28, so the
+    // exact value of __global_pointer$ only has to agree with crt0. Default
+    // it to the start of .sdata unless the linker script sets it.
+    if (ctx.arg.emachine == EM_M65832 && !ctx.arg.shared) {
+      OutputSection *sec = findSection(ctx, ".sdata");
+      addOptionalRegular(ctx, "__global_pointer$",
+                         sec ? sec : ctx.out.elfHeader.get(), 0, STV_DEFAULT);
+      Symbol *s = ctx.symtab->find("__global_pointer$");
+      if (s && s->isDefined())
+        ctx.sym.m65832GlobalPointer = cast<Defined>(s);
+
+      // -mcmodel=bank addresses .data and .bss with 16-bit offsets from B,
+      // which the code points at __data_bank_base. Default it to the first
+      // writable data section; R_M65832_BANKREL_16 checks the 64K range.
+      OutputSection *bank = findSection(ctx, ".data");
+      if (!bank)
+        bank = findSection(ctx, ".sdata");
+      if (!bank)
+        bank = findSection(ctx, ".bss");
+      addOptionalRegular(ctx, "__data_bank_base",
+                         bank ? bank : ctx.out.elfHeader.get(), 0,
+                         STV_DEFAULT);
+      s = ctx.symtab->find("__data_bank_base");
+      if (s && s->isDefined())
+        ctx.sym.m65832DataBank = cast<Defined>(s);
+
+      // __direct_page is the address crt0 loads into D. It has no sensible
+      // default, so only the linker script defines it.
+      s = ctx.symtab->find("__direct_page");
+      if (s && s->isDefined())
+        ctx.sym.m65832DirectPage = cast<Defined>(s);
+    }
+
     if (ctx.arg.emachine == EM_386 || ctx.arg.emachine == EM_X86_64) {
       // On targets that support TLSDESC, _TLS_MODULE_BASE_ is defined in such a
       // way that:
@@ -2107,6 +2210,7 @@ template <class ELFT> void Writer<ELFT>::finalizeSections() {
     finalizeSynthetic(ctx, ctx.in.iplt.get());
     finalizeSynthetic(ctx, ctx.in.ppc32Got2.get());
     finalizeSynthetic(ctx, ctx.in.partIndex.get());
+    finalizeSynthetic(ctx, ctx.in.m65832CopyTable.get());
 
     // Dynamic section must be the last one in this list and dynamic
     // symbol table section (dynSymTab) must be the first one.
@@ -2915,6 +3019,73 @@ template <class ELFT> void Writer<ELFT>::writeHeader() {
     sec->writeHeaderTo<ELFT>(++sHdrs);
 }
 
+// Encode the --oformat=binary layout in ihexImage as Intel HEX records at
+// the sections' load addresses. Gaps between sections take no space, unlike
+// in a binary image. Returns the size of the encoding, and only computes
+// it when \p out is null.
+template <class ELFT> uint64_t Writer<ELFT>::writeIHex(uint8_t *out) {
+  uint64_t size = 0;
+  auto record = [&](uint8_t type, uint16_t addr, const uint8_t *data,
+                    uint8_t len) {
+    if (out) {
+      uint8_t *p = out + size;
+      uint8_t sum = 0;
+      auto hex = [&](uint8_t b) {
+        *p++ = hexdigit(b >> 4);
+        *p++ = hexdigit(b & 0xF);
+        sum += b;
+      };
+      *p++ = ':';
+      hex(len);
+      hex(addr >> 8);
+      hex(addr);
+      hex(type);
+      for (uint8_t i = 0; i != len; ++i)
+        hex(data[i]);
+      hex(-sum);
+      *p = '\n';
+    }
+    // :LLAAAATT<data>CC and a newline
+    size += 12 + 2 * len;
+  };
+
+  uint32_t upper = 0;
+  for (OutputSection *sec : ctx.outputSections) {
+    if (sec->type == SHT_NOBITS || !(sec->flags & SHF_ALLOC) || sec->size == 0)
+      continue;
+    uint64_t addr = sec->getLMA();
+    if (addr + sec->size > (uint64_t(1) << 32)) {
+      if (!out)
+        Err(ctx) << "section '" << sec->name
+                 << "' does not fit in the 32-bit Intel HEX address space";
+      continue;
+    }
+    for (uint64_t off = 0; off != sec->size;) {
+      if ((addr >> 16) != upper) {
+        upper = addr >> 16;
+        const uint8_t ela[] = {uint8_t(upper >> 8), uint8_t(upper)};
+        record(4, 0, ela, sizeof(ela));
+      }
+      uint64_t n = std::min<uint64_t>(
+          {sec->size - off, 16, 0x10000 - (addr & 0xFFFF)});
+      record(0, addr, out ? ihexImage.get() + sec->offset + off : nullptr, n);
+      off += n;
+      addr += n;
+    }
+  }
+
+  // Start linear address, if there is an entry symbol
+  Symbol *b = ctx.symtab->find(ctx.arg.entry);
+  if (b && b->isDefined()) {
+    uint32_t entry = b->getVA(ctx);
+    const uint8_t sla[] = {uint8_t(entry >> 24), uint8_t(entry >> 16),
+                           uint8_t(entry >> 8), uint8_t(entry)};
+    record(5, 0, sla, sizeof(sla));
+  }
+  record(1, 0, nullptr, 0);
+  return size;
+}
+
 // Open a result file.
 template <class ELFT> void Writer<ELFT>::openFile() {
   uint64_t maxSize = ctx.arg.is64 ? INT64_MAX : UINT32_MAX;
@@ -2935,8 +3106,10 @@ template <class ELFT> void Writer<ELFT>::openFile() {
     flags |= FileOutputBuffer::F_executable;
   if (ctx.arg.mmapOutputFile)
     flags |= FileOutputBuffer::F_mmap;
+  uint64_t outputSize =
+      ctx.arg.oFormatIHex ? writeIHex(nullptr) : fileSize;
   Expected<std::unique_ptr<FileOutputBuffer>> bufferOrErr =
-      FileOutputBuffer::create(ctx.arg.outputFile, fileSize, flags);
+      FileOutputBuffer::create(ctx.arg.outputFile, outputSize, flags);
 
   if (!bufferOrErr) {
     ErrAlways(ctx) << "failed to open " << ctx.arg.outputFile << ": "
@@ -2945,6 +3118,12 @@ template <class ELFT> void Writer<ELFT>::openFile() {
   }
   buffer = std::move(*bufferOrErr);
   ctx.bufferStart = buffer->getBufferStart();
+
+  // Sections are written to a binary image first and encoded at the end.
+  if (ctx.arg.oFormatIHex) {
+    ihexImage = std::make_unique<uint8_t[]>(fileSize);
+    ctx.bufferStart = ihexImage.get();
+  }
 }
 
 template <class ELFT> void Writer<ELFT>::writeSectionsBinary() {
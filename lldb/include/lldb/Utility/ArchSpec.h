@@ -184,6 +184,8 @@ public:
 
     eCore_msp430,
 
+    eCore_m65832,
+
     eCore_ppc_generic,
     eCore_ppc_ppc601,
     eCore_ppc_ppc602,
@@ -0,0 +1,405 @@
+//===-- ABISysV_m65832.cpp ------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "ABISysV_m65832.h"
+
+#include "lldb/Core/PluginManager.h"
+#include "lldb/Core/Value.h"
+#include "lldb/Symbol/UnwindPlan.h"
+#include "lldb/Target/Process.h"
+#include "lldb/Target/RegisterContext.h"
+#include "lldb/Target/StackFrame.h"
+#include "lldb/Target/Thread.h"
+#include "lldb/Utility/ConstString.h"
+#include "lldb/Utility/RegisterValue.h"
+#include "lldb/ValueObject/ValueObjectConstResult.h"
+
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/TargetParser/Triple.h"
+
+using namespace lldb;
+using namespace lldb_private;
+
+LLDB_PLUGIN_DEFINE_ADV(ABISysV_m65832, ABIM65832)
+
+// DWARF numbers from M65832RegisterInfo.td
+enum dwarf_regnums {
+  dwarf_r0 = 0,
+  dwarf_r1,
+  dwarf_r2,
+  dwarf_r3,
+  dwarf_r4,
+  dwarf_r5,
+  dwarf_r6,
+  dwarf_r7,
+  dwarf_r8,
+  dwarf_r9,
+  dwarf_r10,
+  dwarf_r11,
+  dwarf_r12,
+  dwarf_r13,
+  dwarf_r14,
+  dwarf_r15,
+  dwarf_r16,
+  dwarf_r17,
+  dwarf_r18,
+  dwarf_r19,
+  dwarf_r20,
+  dwarf_r21,
+  dwarf_r22,
+  dwarf_r23,
+  dwarf_r24,
+  dwarf_r25,
+  dwarf_r26,
+  dwarf_r27,
+  dwarf_r28,
+  dwarf_r29,
+  dwarf_r30,
+  dwarf_r31,
+  dwarf_r32,
+  dwarf_r33,
+  dwarf_r34,
+  dwarf_r35,
+  dwarf_r36,
+  dwarf_r37,
+  dwarf_r38,
+  dwarf_r39,
+  dwarf_r40,
+  dwarf_r41,
+  dwarf_r42,
+  dwarf_r43,
+  dwarf_r44,
+  dwarf_r45,
+  dwarf_r46,
+  dwarf_r47,
+  dwarf_r48,
+  dwarf_r49,
+  dwarf_r50,
+  dwarf_r51,
+  dwarf_r52,
+  dwarf_r53,
+  dwarf_r54,
+  dwarf_r55,
+  dwarf_r56,
+  dwarf_r57,
+  dwarf_r58,
+  dwarf_r59,
+  dwarf_r60,
+  dwarf_r61,
+  dwarf_r62,
+  dwarf_r63,
+  dwarf_a = 64,
+  dwarf_x,
+  dwarf_y,
+  dwarf_sp,
+  dwarf_d,
+  dwarf_b,
+  dwarf_vbr,
+  dwarf_t,
+  dwarf_sr,
+  // Codegen gives the PC no DWARF number; this one only names it in the
+  // unwind plans below
+  dwarf_pc,
+  dwarf_f0 = 80,
+  dwarf_f1,
+  dwarf_f2,
+  dwarf_f3,
+  dwarf_f4,
+  dwarf_f5,
+  dwarf_f6,
+  dwarf_f7,
+  dwarf_f8,
+  dwarf_f9,
+  dwarf_f10,
+  dwarf_f11,
+  dwarf_f12,
+  dwarf_f13,
+  dwarf_f14,
+  dwarf_f15,
+};
+
+#define DEFINE_REG(name, alt, size, encoding, format, generic)                 \
+  {                                                                            \
+    #name, alt, size, 0, encoding, format,                                     \
+        {dwarf_##name, dwarf_##name, generic, LLDB_INVALID_REGNUM,             \
+         LLDB_INVALID_REGNUM},                                                 \
+        nullptr, nullptr, nullptr,                                             \
+  }
+#define DEFINE_GPR(name, alt, generic)                                         \
+  DEFINE_REG(name, alt, 4, eEncodingUint, eFormatHex, generic)
+#define DEFINE_FPR(name)                                                       \
+  DEFINE_REG(name, nullptr, 8, eEncodingIEEE754, eFormatFloat,                 \
+             LLDB_INVALID_REGNUM)
+
+// The CPU registers, the register window R0-R63 and the FPU, in the order
+// of the gdb-remote fallback register list
+static const RegisterInfo g_register_infos[] = {
+    DEFINE_GPR(a, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(x, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(y, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(sp, nullptr, LLDB_REGNUM_GENERIC_SP),
+    DEFINE_GPR(pc, nullptr, LLDB_REGNUM_GENERIC_PC),
+    DEFINE_GPR(sr, nullptr, LLDB_REGNUM_GENERIC_FLAGS),
+    DEFINE_GPR(d, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(b, nullptr, LLDB_REGNUM_GENERIC_FP),
+    DEFINE_GPR(vbr, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(t, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r0, nullptr, LLDB_REGNUM_GENERIC_ARG1),
+    DEFINE_GPR(r1, nullptr, LLDB_REGNUM_GENERIC_ARG2),
+    DEFINE_GPR(r2, nullptr, LLDB_REGNUM_GENERIC_ARG3),
+    DEFINE_GPR(r3, nullptr, LLDB_REGNUM_GENERIC_ARG4),
+    DEFINE_GPR(r4, nullptr, LLDB_REGNUM_GENERIC_ARG5),
+    DEFINE_GPR(r5, nullptr, LLDB_REGNUM_GENERIC_ARG6),
+    DEFINE_GPR(r6, nullptr, LLDB_REGNUM_GENERIC_ARG7),
+    DEFINE_GPR(r7, nullptr, LLDB_REGNUM_GENERIC_ARG8),
+    DEFINE_GPR(r8, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r9, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r10, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r11, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r12, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r13, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r14, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r15, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r16, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r17, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r18, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r19, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r20, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r21, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r22, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r23, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r24, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r25, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r26, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r27, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r28, "gp", LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r29, "fp", LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r30, "lr", LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r31, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r32, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r33, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r34, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r35, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r36, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r37, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r38, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r39, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r40, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r41, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r42, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r43, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r44, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r45, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r46, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r47, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r48, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r49, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r50, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r51, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r52, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r53, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r54, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r55, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r56, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r57, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r58, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r59, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r60, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r61, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r62, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_GPR(r63, nullptr, LLDB_INVALID_REGNUM),
+    DEFINE_FPR(f0),
+    DEFINE_FPR(f1),
+    DEFINE_FPR(f2),
+    DEFINE_FPR(f3),
+    DEFINE_FPR(f4),
+    DEFINE_FPR(f5),
+    DEFINE_FPR(f6),
+    DEFINE_FPR(f7),
+    DEFINE_FPR(f8),
+    DEFINE_FPR(f9),
+    DEFINE_FPR(f10),
+    DEFINE_FPR(f11),
+    DEFINE_FPR(f12),
+    DEFINE_FPR(f13),
+    DEFINE_FPR(f14),
+    DEFINE_FPR(f15),
+};
+
+static const uint32_t k_num_register_infos = std::size(g_register_infos);
+
+const lldb_private::RegisterInfo *
+ABISysV_m65832::GetRegisterInfoArray(uint32_t &count) {
+  count = k_num_register_infos;
+  return g_register_infos;
+}
+
+size_t ABISysV_m65832::GetRedZoneSize() const { return 0; }
+
+// Static Functions
+
+ABISP
+ABISysV_m65832::CreateInstance(lldb::ProcessSP process_sp,
+                               const ArchSpec &arch) {
+  if (arch.GetTriple().getArch() == llvm::Triple::m65832) {
+    return ABISP(
+        new ABISysV_m65832(std::move(process_sp), MakeMCRegisterInfo(arch)));
+  }
+  return ABISP();
+}
+
+bool ABISysV_m65832::PrepareTrivialCall(Thread &thread, lldb::addr_t sp,
+                                        lldb::addr_t pc, lldb::addr_t ra,
+                                        llvm::ArrayRef<addr_t> args) const {
+  // we don't use the traditional trivial call specialized for jit
+  return false;
+}
+
+bool ABISysV_m65832::GetArgumentValues(Thread &thread,
+                                       ValueList &values) const {
+  return false;
+}
+
+Status ABISysV_m65832::SetReturnValueObject(lldb::StackFrameSP &frame_sp,
+                                            lldb::ValueObjectSP &new_value_sp) {
+  return Status::FromErrorString(
+      "setting return values is not supported for m65832");
+}
+
+// Integers and pointers come back in R0, 64-bit integers in R0:R1 (low word
+// in R0)
+ValueObjectSP ABISysV_m65832::GetReturnValueObjectSimple(
+    Thread &thread, CompilerType &return_compiler_type) const {
+  if (!return_compiler_type)
+    return ValueObjectSP();
+
+  RegisterContextSP reg_ctx = thread.GetRegisterContext();
+  if (!reg_ctx)
+    return ValueObjectSP();
+
+  const uint32_t type_flags = return_compiler_type.GetTypeInfo();
+  if (!(type_flags & (eTypeIsInteger | eTypeIsPointer | eTypeIsEnumeration)))
+    return ValueObjectSP();
+
+  const size_t byte_size =
+      llvm::expectedToOptional(return_compiler_type.GetByteSize(&thread))
+          .value_or(0);
+  if (byte_size == 0 || byte_size > 8)
+    return ValueObjectSP();
+
+  const RegisterInfo *r0_info =
+      reg_ctx->GetRegisterInfo(eRegisterKindGeneric, LLDB_REGNUM_GENERIC_ARG1);
+  const RegisterInfo *r1_info =
+      reg_ctx->GetRegisterInfo(eRegisterKindGeneric, LLDB_REGNUM_GENERIC_ARG2);
+  uint64_t raw_value = reg_ctx->ReadRegisterAsUnsigned(r0_info, 0) & UINT32_MAX;
+  if (byte_size > 4)
+    raw_value |= (reg_ctx->ReadRegisterAsUnsigned(r1_info, 0) & UINT32_MAX)
+                 << 32;
+
+  const bool is_signed = (type_flags & eTypeIsSigned) != 0;
+  Value value;
+  value.SetCompilerType(return_compiler_type);
+  value.SetValueType(Value::ValueType::Scalar);
+  switch (byte_size) {
+  case 1:
+    value.GetScalar() = is_signed ? Scalar(int8_t(raw_value))
+                                  : Scalar(uint8_t(raw_value));
+    break;
+  case 2:
+    value.GetScalar() = is_signed ? Scalar(int16_t(raw_value))
+                                  : Scalar(uint16_t(raw_value));
+    break;
+  case 4:
+    value.GetScalar() = is_signed ? Scalar(int32_t(raw_value))
+                                  : Scalar(uint32_t(raw_value));
+    break;
+  case 8:
+    value.GetScalar() = is_signed ? Scalar(int64_t(raw_value))
+                                  : Scalar(uint64_t(raw_value));
+    break;
+  default:
+    return ValueObjectSP();
+  }
+
+  return ValueObjectConstResult::Create(thread.GetStackFrameAtIndex(0).get(),
+                                        value, ConstString(""));
+}
+
+ValueObjectSP ABISysV_m65832::GetReturnValueObjectImpl(
+    Thread &thread, CompilerType &return_compiler_type) const {
+  return GetReturnValueObjectSimple(thread, return_compiler_type);
+}
+
+// called when we are on the first instruction of a new function; JSR has
+// pushed the 4-byte return address and SP points at it
+UnwindPlanSP ABISysV_m65832::CreateFunctionEntryUnwindPlan() {
+  uint32_t sp_reg_num = dwarf_sp;
+  uint32_t pc_reg_num = dwarf_pc;
+
+  UnwindPlan::Row row;
+  row.GetCFAValue().SetIsRegisterPlusOffset(sp_reg_num, 4);
+  row.SetRegisterLocationToAtCFAPlusOffset(pc_reg_num, -4, true);
+  row.SetRegisterLocationToIsCFAPlusOffset(sp_reg_num, 0, true);
+
+  auto plan_sp = std::make_shared<UnwindPlan>(eRegisterKindDWARF);
+  plan_sp->AppendRow(std::move(row));
+  plan_sp->SetSourceName("m65832 at-func-entry default");
+  plan_sp->SetSourcedFromCompiler(eLazyBoolNo);
+  return plan_sp;
+}
+
+// A framed function saves the caller's B with PHB and then points B at its
+// locals (PHB; ADJSP -N; TSPB), so the caller's B is at B+N and the return
+// address above it. N is not known here, so the default plan only covers
+// frames with nothing below the return address; everything else needs the
+// compiler's CFI.
+UnwindPlanSP ABISysV_m65832::CreateDefaultUnwindPlan() {
+  uint32_t b_reg_num = dwarf_b;
+  uint32_t sp_reg_num = dwarf_sp;
+  uint32_t pc_reg_num = dwarf_pc;
+
+  UnwindPlan::Row row;
+  row.GetCFAValue().SetIsRegisterPlusOffset(sp_reg_num, 4);
+  row.SetRegisterLocationToAtCFAPlusOffset(pc_reg_num, -4, true);
+  row.SetRegisterLocationToIsCFAPlusOffset(sp_reg_num, 0, true);
+  row.SetRegisterLocationToUnspecified(b_reg_num, true);
+
+  auto plan_sp = std::make_shared<UnwindPlan>(eRegisterKindDWARF);
+  plan_sp->AppendRow(std::move(row));
+  plan_sp->SetSourceName("m65832 default unwind plan");
+  plan_sp->SetSourcedFromCompiler(eLazyBoolNo);
+  plan_sp->SetUnwindPlanValidAtAllInstructions(eLazyBoolNo);
+  return plan_sp;
+}
+
+bool ABISysV_m65832::RegisterIsVolatile(const RegisterInfo *reg_info) {
+  return !RegisterIsCalleeSaved(reg_info);
+}
+
+// R16-R23, R48-R55, R29 (fp), F14 and F15, plus the frame and stack state
+bool ABISysV_m65832::RegisterIsCalleeSaved(const RegisterInfo *reg_info) {
+  if (!reg_info)
+    return false;
+
+  llvm::StringRef name(reg_info->name);
+  unsigned num;
+  if (name.consume_front("r") && !name.getAsInteger(10, num))
+    return (num >= 16 && num <= 23) || (num >= 48 && num <= 55) || num == 29;
+  return llvm::StringSwitch<bool>(reg_info->name)
+      .Cases({"f14", "f15", "sp", "b", "d"}, true)
+      .Default(false);
+}
+
+void ABISysV_m65832::Initialize(void) {
+  PluginManager::RegisterPlugin(
+      GetPluginNameStatic(), "System V ABI for m65832 targets", CreateInstance);
+}
+
+void ABISysV_m65832::Terminate(void) {
+  PluginManager::UnregisterPlugin(CreateInstance);
+}
@@ -36,6 +36,30 @@ static std::vector<DynamicRegisterInfo::Register> GetRegisters_aarch64() {
   return registers;
 }
 
+static std::vector<DynamicRegisterInfo::Register> GetRegisters_m65832() {
+  ConstString empty_alt_name;
+  ConstString reg_set{"general purpose registers"};
+
+  // The CPU registers, then the register window R0-R63 and the FPU
+  std::vector<DynamicRegisterInfo::Register> registers{
+      R32(a),   R32(x),   R32(y),   R32(sp),  R32(pc),  R32(sr),  R32(d),
+      R32(b),   R32(vbr), R32(t),   R32(r0),  R32(r1),  R32(r2),  R32(r3),
+      R32(r4),  R32(r5),  R32(r6),  R32(r7),  R32(r8),  R32(r9),  R32(r10),
+      R32(r11), R32(r12), R32(r13), R32(r14), R32(r15), R32(r16), R32(r17),
+      R32(r18), R32(r19), R32(r20), R32(r21), R32(r22), R32(r23), R32(r24),
+      R32(r25), R32(r26), R32(r27), R32(r28), R32(r29), R32(r30), R32(r31),
+      R32(r32), R32(r33), R32(r34), R32(r35), R32(r36), R32(r37), R32(r38),
+      R32(r39), R32(r40), R32(r41), R32(r42), R32(r43), R32(r44), R32(r45),
+      R32(r46), R32(r47), R32(r48), R32(r49), R32(r50), R32(r51), R32(r52),
+      R32(r53), R32(r54), R32(r55), R32(r56), R32(r57), R32(r58), R32(r59),
+      R32(r60), R32(r61), R32(r62), R32(r63), R64(f0),  R64(f1),  R64(f2),
+      R64(f3),  R64(f4),  R64(f5),  R64(f6),  R64(f7),  R64(f8),  R64(f9),
+      R64(f10), R64(f11), R64(f12), R64(f13), R64(f14), R64(f15),
+  };
+
+  return registers;
+}
+
 static std::vector<DynamicRegisterInfo::Register> GetRegisters_msp430() {
   ConstString empty_alt_name;
   ConstString reg_set{"general purpose registers"};
@@ -84,6 +108,8 @@ GetFallbackRegisters(const ArchSpec &arch_to_use) {
   switch (arch_to_use.GetMachine()) {
   case llvm::Triple::aarch64:
     return GetRegisters_aarch64();
+  case llvm::Triple::m65832:
+    return GetRegisters_m65832();
   case llvm::Triple::msp430:
     return GetRegisters_msp430();
   case llvm::Triple::x86:
@@ -2019,6 +2019,12 @@ size_t Platform::GetSoftwareBreakpointTrapOpcode(Target &target,
     trap_opcode_size = sizeof(g_msp430_opcode);
   } break;
 
+  case llvm::Triple::m65832: {
+    static const uint8_t g_m65832_opcode[] = {0x00}; // BRK
+    trap_opcode = g_m65832_opcode;
+    trap_opcode_size = sizeof(g_m65832_opcode);
+  } break;
+
   case llvm::Triple::systemz: {
     static const uint8_t g_hex_opcode[] = {0x00, 0x01};
     trap_opcode = g_hex_opcode;
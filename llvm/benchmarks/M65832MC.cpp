@@ -0,0 +1,316 @@
+//===- M65832MC.cpp - M65832 MC layer and code generation benchmarks ------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Encode, asm parse and -O2 code generation throughput for M65832 on a
+// synthetic corpus. The corpus is a generated IR module; its assembly is
+// what llc prints for it, so the parse and encode benchmarks see the syntax
+// and instruction mix the compiler actually produces.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/MC/MCAsmInfo.h"
+#include "llvm/MC/MCCodeEmitter.h"
+#include "llvm/MC/MCContext.h"
+#include "llvm/MC/MCFixup.h"
+#include "llvm/MC/MCInst.h"
+#include "llvm/MC/MCInstrInfo.h"
+#include "llvm/MC/MCObjectFileInfo.h"
+#include "llvm/MC/MCParser/MCAsmParser.h"
+#include "llvm/MC/MCParser/MCTargetAsmParser.h"
+#include "llvm/MC/MCRegisterInfo.h"
+#include "llvm/MC/MCStreamer.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/MC/MCTargetOptions.h"
+#include "llvm/MC/TargetRegistry.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Target/TargetOptions.h"
+#include <memory>
+#include <string>
+#include <vector>
+using namespace llvm;
+
+extern "C" void LLVMInitializeM65832TargetInfo();
+extern "C" void LLVMInitializeM65832Target();
+extern "C" void LLVMInitializeM65832TargetMC();
+extern "C" void LLVMInitializeM65832AsmParser();
+extern "C" void LLVMInitializeM65832AsmPrinter();
+
+static constexpr const char *TripleName = "m65832-unknown-elf";
+static constexpr unsigned NumCorpusFunctions = 256;
+
+static const Target *getM65832Target() {
+  static const Target *TheTarget = [] {
+    LLVMInitializeM65832TargetInfo();
+    LLVMInitializeM65832Target();
+    LLVMInitializeM65832TargetMC();
+    LLVMInitializeM65832AsmParser();
+    LLVMInitializeM65832AsmPrinter();
+    std::string Error;
+    return TargetRegistry::lookupTarget(TripleName, Error);
+  }();
+  return TheTarget;
+}
+
+// A chain of functions, each a counted loop over an array with loads,
+// stores, shifts, logic and a compare, followed by a division (a runtime
+// call) and a call to the previous function. The constants vary so no two
+// functions fold the same way.
+static std::string getCorpusIR(unsigned NumFunctions) {
+  std::string IR;
+  raw_string_ostream OS(IR);
+  for (unsigned N = 0; N != NumFunctions; ++N) {
+    OS << "define i32 @f" << N << "(ptr %p, i32 %n, i32 %k) {\n"
+       << "entry:\n"
+       << "  %c = icmp sgt i32 %n, 0\n"
+       << "  br i1 %c, label %loop, label %exit\n"
+       << "loop:\n"
+       << "  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]\n"
+       << "  %acc = phi i32 [ " << N << ", %entry ], [ %acc.next, %loop ]\n"
+       << "  %a = getelementptr inbounds i32, ptr %p, i32 %i\n"
+       << "  %v = load i32, ptr %a\n"
+       << "  %x = xor i32 %v, %k\n"
+       << "  %s = shl i32 %x, " << (N % 5 + 1) << "\n"
+       << "  %y = add i32 %acc, %s\n"
+       << "  %m = and i32 %y, " << (0xFFFF ^ (N * 37)) << "\n"
+       << "  store i32 %m, ptr %a\n"
+       << "  %lt = icmp ult i32 %m, %k\n"
+       << "  %sel = select i1 %lt, i32 %m, i32 %v\n"
+       << "  %acc.next = sub i32 %y, %sel\n"
+       << "  %i.next = add nuw i32 %i, 1\n"
+       << "  %done = icmp eq i32 %i.next, %n\n"
+       << "  br i1 %done, label %exit, label %loop\n"
+       << "exit:\n"
+       << "  %r = phi i32 [ " << N << ", %entry ], [ %acc.next, %loop ]\n"
+       << "  %q = udiv i32 %r, " << (N % 13 + 3) << "\n";
+    if (N == 0) {
+      OS << "  ret i32 %q\n";
+    } else {
+      OS << "  %t = call i32 @f" << (N - 1) << "(ptr %p, i32 %q, i32 %k)\n"
+         << "  ret i32 %t\n";
+    }
+    OS << "}\n\n";
+  }
+  return IR;
+}
+
+static std::unique_ptr<TargetMachine> createTargetMachine() {
+  const Target *TheTarget = getM65832Target();
+  if (!TheTarget)
+    return nullptr;
+  return std::unique_ptr<TargetMachine>(TheTarget->createTargetMachine(
+      Triple(TripleName), "m65832", "", TargetOptions(), std::nullopt,
+      std::nullopt, CodeGenOptLevel::Default));
+}
+
+static std::unique_ptr<Module> parseCorpus(StringRef IR, LLVMContext &Ctx,
+                                           const TargetMachine &TM) {
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString(IR, Err, Ctx);
+  if (!M)
+    return nullptr;
+  M->setTargetTriple(TM.getTargetTriple());
+  M->setDataLayout(TM.createDataLayout());
+  return M;
+}
+
+/// Run the -O2 code generator on \p M, writing a file of type \p FileType to
+/// \p OS. Returns false if the target cannot emit that file type.
+static bool compile(TargetMachine &TM, Module &M, raw_pwrite_stream &OS,
+                    CodeGenFileType FileType) {
+  legacy::PassManager PM;
+  if (TM.addPassesToEmitFile(PM, OS, nullptr, FileType))
+    return false;
+  PM.run(M);
+  return true;
+}
+
+// The assembly llc prints for the corpus, produced once.
+static const std::string &getCorpusAsm() {
+  static const std::string Asm = [] {
+    std::string Result;
+    std::unique_ptr<TargetMachine> TM = createTargetMachine();
+    if (!TM)
+      return Result;
+    LLVMContext Ctx;
+    std::unique_ptr<Module> M =
+        parseCorpus(getCorpusIR(NumCorpusFunctions), Ctx, *TM);
+    if (!M)
+      return Result;
+    SmallString<0> Buf;
+    raw_svector_ostream OS(Buf);
+    if (compile(*TM, *M, OS, CodeGenFileType::AssemblyFile))
+      Result = Buf.str().str();
+    return Result;
+  }();
+  return Asm;
+}
+
+namespace {
+
+/// The MC objects the asm parser and code emitter need for one triple.
+struct MCEnv {
+  const Target *TheTarget;
+  std::unique_ptr<MCRegisterInfo> MRI;
+  std::unique_ptr<MCAsmInfo> MAI;
+  std::unique_ptr<MCSubtargetInfo> STI;
+  std::unique_ptr<MCInstrInfo> MCII;
+  MCTargetOptions Options;
+  SourceMgr SrcMgr;
+  std::unique_ptr<MCContext> Ctx;
+  std::unique_ptr<MCObjectFileInfo> MOFI;
+
+  explicit MCEnv(const Target *T) : TheTarget(T) {
+    Triple TT(TripleName);
+    MRI.reset(T->createMCRegInfo(TT));
+    MAI.reset(T->createMCAsmInfo(*MRI, TT, Options));
+    STI.reset(T->createMCSubtargetInfo(TT, "m65832", ""));
+    MCII.reset(T->createMCInstrInfo());
+    Ctx = std::make_unique<MCContext>(TT, MAI.get(), MRI.get(), STI.get(),
+                                      &SrcMgr, &Options);
+    MOFI.reset(T->createMCObjectFileInfo(*Ctx, /*PIC=*/false));
+    Ctx->setObjectFileInfo(MOFI.get());
+  }
+
+  /// Parse \p Asm into \p Str. Returns false on a parse error.
+  bool parse(StringRef Asm, MCStreamer &Str) {
+    SrcMgr.AddNewSourceBuffer(
+        MemoryBuffer::getMemBuffer(Asm, "corpus.s",
+                                   /*RequiresNullTerminator=*/false),
+        SMLoc());
+    std::unique_ptr<MCAsmParser> Parser(
+        createMCAsmParser(SrcMgr, *Ctx, Str, *MAI));
+    std::unique_ptr<MCTargetAsmParser> TAP(
+        TheTarget->createMCAsmParser(*STI, *Parser, *MCII, Options));
+    if (!TAP)
+      return false;
+    Parser->setTargetParser(*TAP);
+    return !Parser->Run(/*NoInitialTextSection=*/false);
+  }
+};
+
+/// A streamer that keeps the parsed instructions and drops everything else.
+class InstCollector : public MCStreamer {
+  std::vector<MCInst> &Insts;
+
+public:
+  InstCollector(MCContext &Ctx, std::vector<MCInst> &Insts)
+      : MCStreamer(Ctx), Insts(Insts) {}
+
+  void emitInstruction(const MCInst &Inst, const MCSubtargetInfo &) override {
+    Insts.push_back(Inst);
+  }
+  bool emitSymbolAttribute(MCSymbol *, MCSymbolAttr) override { return true; }
+  void emitCommonSymbol(MCSymbol *, uint64_t, Align) override {}
+  void emitZerofill(MCSection *, MCSymbol *, uint64_t, Align,
+                    SMLoc) override {}
+};
+
+} // end anonymous namespace
+
+static void BM_M65832Encode(benchmark::State &State) {
+  const Target *TheTarget = getM65832Target();
+  const std::string &Asm = getCorpusAsm();
+  if (!TheTarget || Asm.empty()) {
+    State.SkipWithError("cannot produce the M65832 corpus");
+    return;
+  }
+  // The instructions reference symbols owned by Env's context, so it lives
+  // for the whole benchmark.
+  MCEnv Env(TheTarget);
+  std::vector<MCInst> Insts;
+  InstCollector Collector(*Env.Ctx, Insts);
+  if (!Env.parse(Asm, Collector) || Insts.empty()) {
+    State.SkipWithError("cannot parse the M65832 corpus");
+    return;
+  }
+  std::unique_ptr<MCCodeEmitter> CE(
+      TheTarget->createMCCodeEmitter(*Env.MCII, *Env.Ctx));
+
+  SmallVector<char, 16> Code;
+  SmallVector<MCFixup, 4> Fixups;
+  size_t Bytes = 0;
+  for (auto _ : State) {
+    Bytes = 0;
+    for (const MCInst &Inst : Insts) {
+      Code.clear();
+      Fixups.clear();
+      CE->encodeInstruction(Inst, Code, Fixups, *Env.STI);
+      Bytes += Code.size();
+    }
+    benchmark::DoNotOptimize(Bytes);
+  }
+  State.SetItemsProcessed(State.iterations() * Insts.size());
+  State.SetBytesProcessed(State.iterations() * Bytes);
+}
+BENCHMARK(BM_M65832Encode);
+
+static void BM_M65832AsmParse(benchmark::State &State) {
+  const Target *TheTarget = getM65832Target();
+  const std::string &Asm = getCorpusAsm();
+  if (!TheTarget || Asm.empty()) {
+    State.SkipWithError("cannot produce the M65832 corpus");
+    return;
+  }
+  size_t NumInsts = 0;
+  for (auto _ : State) {
+    MCEnv Env(TheTarget);
+    std::vector<MCInst> Insts;
+    InstCollector Collector(*Env.Ctx, Insts);
+    if (!Env.parse(Asm, Collector)) {
+      State.SkipWithError("cannot parse the M65832 corpus");
+      return;
+    }
+    NumInsts = Insts.size();
+  }
+  State.SetItemsProcessed(State.iterations() * NumInsts);
+  State.SetBytesProcessed(State.iterations() * Asm.size());
+}
+BENCHMARK(BM_M65832AsmParse)->Unit(benchmark::kMillisecond);
+
+// Items are functions, so the reported rate is the inverse of the -O2 time
+// per function.
+static void BM_M65832CodeGenO2(benchmark::State &State) {
+  std::unique_ptr<TargetMachine> TM = createTargetMachine();
+  if (!TM) {
+    State.SkipWithError("M65832 target not available");
+    return;
+  }
+  unsigned NumFunctions = State.range(0);
+  std::string IR = getCorpusIR(NumFunctions);
+  for (auto _ : State) {
+    State.PauseTiming();
+    LLVMContext Ctx;
+    std::unique_ptr<Module> M = parseCorpus(IR, Ctx, *TM);
+    if (!M) {
+      State.SkipWithError("cannot parse the corpus IR");
+      return;
+    }
+    State.ResumeTiming();
+    raw_null_ostream OS;
+    if (!compile(*TM, *M, OS, CodeGenFileType::ObjectFile)) {
+      State.SkipWithError("cannot emit an object file");
+      return;
+    }
+  }
+  State.SetItemsProcessed(State.iterations() * NumFunctions);
+}
+BENCHMARK(BM_M65832CodeGenO2)
+    ->Arg(16)
+    ->Arg(NumCorpusFunctions)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -483,6 +483,12 @@ public:
   /// function (before any stack operations).
   virtual int getInitialCFAOffset(const MachineFunction &MF) const;
 
+  /// Return the stack usage reported for MF by -fstack-usage and the
+  /// .stack_sizes section. The default is the frame MachineFrameInfo
+  /// describes; targets that also push registers or a return address
+  /// outside it can count those as well.
+  virtual uint64_t getStackUsage(const MachineFunction &MF) const;
+
   /// Return initial CFA register value i.e. the one valid at the beginning of
   /// the function (before any stack operations).
   virtual Register getInitialCFARegister(const MachineFunction &MF) const;
@@ -0,0 +1,320 @@
+//===-- m65832.h - Generic JITLink M65832 edge kinds, utilities -*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Generic utilities for graphs representing M65832 objects.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_JITLINK_M65832_H
+#define LLVM_EXECUTIONENGINE_JITLINK_M65832_H
+
+#include "llvm/ExecutionEngine/JITLink/JITLink.h"
+#include "llvm/ExecutionEngine/JITLink/TableManager.h"
+#include "llvm/Support/Compiler.h"
+
+namespace llvm::jitlink::m65832 {
+
+/// Represents M65832 fixups
+enum EdgeKind_m65832 : Edge::Kind {
+
+  /// A plain 32-bit pointer value relocation.
+  ///
+  /// Fixup expression:
+  ///   Fixup <- Target + Addend : uint32
+  ///
+  Pointer32 = Edge::FirstRelocation,
+
+  /// A 24-bit pointer value relocation, written as a 16-bit little-endian
+  /// word followed by the bank byte.
+  ///
+  /// Fixup expression:
+  ///   Fixup <- Target + Addend : uint24
+  ///
+  /// Errors:
+  ///   - The target must reside in the low 24-bits of the address space,
+  ///     otherwise an out-of-range error will be returned.
+  ///
+  Pointer24,
+
+  /// A 16-bit pointer value relocation.
+  ///
+  /// Fixup expression:
+  ///   Fixup <- Target + Addend : int16 or uint16
+  ///
+  /// Errors:
+  ///   - The result of the fixup expression must fit into 16 bits, signed or
+  ///     unsigned, otherwise an out-of-range error will be returned.
+  ///
+  Pointer16,
+
+  /// An 8-bit pointer value relocation.
+  ///
+  /// Fixup expression:
+  ///   Fixup <- Target + Addend : int8 or uint8
+  ///
+  /// Errors:
+  ///   - The result of the fixup expression must fit into 8 bits, signed or
+  ///     unsigned, otherwise an out-of-range error will be returned.
+  ///
+  Pointer8,
+
+  /// A 32-bit PC-relative delta, the displacement -fPIC code adds to the
+  /// address of the instruction.
+  ///
+  /// Fixup expression:
+  ///   Fixup <- Target - Fixup + Addend : int32
+  ///
+  Delta32,
+
+  /// A 16-bit PC-relative branch (Bcc, BRA, BRL).
+  ///
+  /// The assembler's addend makes the displacement relative to the end of
+  /// the instruction, two bytes past the fixup.
+  ///
+  /// Fixup expression:
+  ///   Fixup <- Target - Fixup + Addend : int16
+  ///
+  /// Errors:
+  ///   - The result of the fixup expression must fit into an int16, otherwise
+  ///     an out-of-range error will be returned.
+  ///
+  BranchPCRel16,
+
+  /// A 16-bit PC-relative branch to a jump stub.
+  ///
+  /// The stub is LD.L R31,#target; JMP (R31), the sequence the compiler and
+  /// lld use for branches that do not reach. It has the same fixup
+  /// expression as BranchPCRel16, and the branch may be pointed straight at
+  /// the ultimate target when that is within range.
+  ///
+  /// Fixup expression:
+  ///   Fixup <- Target - Fixup + Addend : int16
+  ///
+  /// Errors:
+  ///   - The result of the fixup expression must fit into an int16, otherwise
+  ///     an out-of-range error will be returned.
+  ///
+  BranchPCRel16ToStubBypassable,
+
+  /// An 8-bit PC-relative branch.
+  ///
+  /// Fixup expression:
+  ///   Fixup <- Target - Fixup + Addend : int8
+  ///
+  /// Errors:
+  ///   - The result of the fixup expression must fit into an int8, otherwise
+  ///     an out-of-range error will be returned.
+  ///
+  BranchPCRel8,
+
+  /// A 32-bit offset from __global_pointer$, for small data addressed as
+  /// R28 + offset.
+  ///
+  /// Fixup expression:
+  ///   Fixup <- Target - GlobalPointer + Addend : int32
+  ///
+  /// Errors:
+  ///   - __global_pointer$ must be defined by the graph or by the process
+  ///     the graph is linked into.
+  ///
+  Delta32FromGlobalPointer,
+
+  /// A 16-bit offset from __data_bank_base, for -mcmodel=bank globals
+  /// addressed through B.
+  ///
+  /// Fixup expression:
+  ///   Fixup <- Target - DataBank + Addend : uint16
+  ///
+  /// Errors:
+  ///   - __data_bank_base must be defined by the graph or by the process.
+  ///   - The target must lie in the 64K above __data_bank_base, otherwise an
+  ///     out-of-range error will be returned.
+  ///
+  Delta16FromDataBank,
+
+  /// An 8-bit offset from __direct_page, for a direct page operand.
+  ///
+  /// Fixup expression:
+  ///   Fixup <- Target - DirectPage + Addend : uint8
+  ///
+  /// Errors:
+  ///   - __direct_page must be defined by the graph or by the process.
+  ///   - The target must lie in the 256 bytes above __direct_page, otherwise
+  ///     an out-of-range error will be returned.
+  ///
+  Delta8FromDirectPage,
+
+  /// Label differences. Like the RISC-V relocations of the same names, the
+  /// Add kinds add Target + Addend to the field already in the content and
+  /// the Sub kinds subtract it, so a pair of them leaves the distance
+  /// between two symbols.
+  ///
+  /// Fixup expression:
+  ///   Fixup <- Fixup + (Target + Addend) : uintN
+  ///
+  Add8,
+  Add16,
+  Add32,
+
+  /// As Add8, on a ULEB128 whose encoded length is kept.
+  ///
+  /// Errors:
+  ///   - The field must be a valid ULEB128.
+  ///
+  AddULEB128,
+
+  /// Fixup expression:
+  ///   Fixup <- Fixup - (Target + Addend) : uintN
+  ///
+  Sub8,
+  Sub16,
+  Sub32,
+
+  /// As Sub8, on a ULEB128 whose encoded length is kept.
+  ///
+  /// Errors:
+  ///   - The field must be a valid ULEB128.
+  ///
+  SubULEB128,
+};
+
+/// Returns a string name for the given M65832 edge. For debugging purposes
+/// only
+LLVM_ABI const char *getEdgeKindName(Edge::Kind K);
+
+/// The symbols the Delta*From* edge kinds are measured from, null until a
+/// graph needs them.
+struct BaseSymbols {
+  const Symbol *GlobalPointer = nullptr;
+  const Symbol *DataBank = nullptr;
+  const Symbol *DirectPage = nullptr;
+};
+
+/// Names of the BaseSymbols, as the linker scripts define them.
+constexpr StringRef GlobalPointerSymbolName = "__global_pointer$";
+constexpr StringRef DataBankSymbolName = "__data_bank_base";
+constexpr StringRef DirectPageSymbolName = "__direct_page";
+
+/// Apply fixup expression for edge to block content.
+LLVM_ABI Error applyFixup(LinkGraph &G, Block &B, const Edge &E,
+                          const BaseSymbols &Bases);
+
+/// M65832 pointer size.
+constexpr uint32_t PointerSize = 4;
+
+/// M65832 null pointer content.
+LLVM_ABI extern const char NullPointerContent[PointerSize];
+
+/// M65832 pointer jump stub content.
+///
+/// Contains the instruction sequence for an indirect jump via an in-memory
+/// pointer, through the reserved scratch register R31:
+///   LD.L R31,ptr
+///   JMP (R31)
+LLVM_ABI extern const char PointerJumpStubContent[11];
+
+/// M65832 jump stub content.
+///
+/// Contains the instruction sequence for an absolute jump to a target,
+/// the same as lld's long-branch thunk:
+///   LD.L R31,#target
+///   JMP (R31)
+LLVM_ABI extern const char JumpStubContent[11];
+
+/// Creates a new pointer block in the given section and returns an anonymous
+/// symbol pointing to it.
+///
+/// If InitialTarget is given then an Pointer32 relocation will be added to the
+/// block pointing at InitialTarget.
+///
+/// The pointer block will have the following default values:
+///   alignment: 32-bit
+///   alignment-offset: 0
+inline Symbol &createAnonymousPointer(LinkGraph &G, Section &PointerSection,
+                                      Symbol *InitialTarget = nullptr,
+                                      uint64_t InitialAddend = 0) {
+  auto &B = G.createContentBlock(PointerSection, NullPointerContent,
+                                 orc::ExecutorAddr(), 4, 0);
+  if (InitialTarget)
+    B.addEdge(Pointer32, 0, *InitialTarget, InitialAddend);
+  return G.addAnonymousSymbol(B, 0, PointerSize, false, false);
+}
+
+/// Create a jump stub block that jumps via the pointer at the given symbol.
+///
+/// The stub block will have the following default values:
+///   alignment: 8-bit
+///   alignment-offset: 0
+inline Block &createPointerJumpStubBlock(LinkGraph &G, Section &StubSection,
+                                         Symbol &PointerSymbol) {
+  auto &B = G.createContentBlock(StubSection, PointerJumpStubContent,
+                                 orc::ExecutorAddr(), 1, 0);
+  // The address is the abs32 operand of LD.L, after $02 $80 mode dest.
+  B.addEdge(Pointer32, 4, PointerSymbol, 0);
+  return B;
+}
+
+/// Create a jump stub that jumps via the pointer at the given symbol and
+/// an anonymous symbol pointing to it. Return the anonymous symbol.
+///
+/// The stub block will be created by createPointerJumpStubBlock.
+inline Symbol &createAnonymousPointerJumpStub(LinkGraph &G,
+                                              Section &StubSection,
+                                              Symbol &PointerSymbol) {
+  return G.addAnonymousSymbol(
+      createPointerJumpStubBlock(G, StubSection, PointerSymbol), 0,
+      sizeof(PointerJumpStubContent), true, false);
+}
+
+/// Jump stubs for 16-bit branches to targets outside the graph, which may
+/// be allocated anywhere in the 32-bit address space.
+class JumpStubTableManager : public TableManager<JumpStubTableManager> {
+public:
+  static StringRef getSectionName() { return "$__STUBS"; }
+
+  bool visitEdge(LinkGraph &G, Block *B, Edge &E) {
+    // A stub jumps to its target itself, so only the usual branch to a
+    // symbol, whose addend is -2, can share it.
+    if (E.getKind() != BranchPCRel16 || E.getTarget().isDefined() ||
+        E.getAddend() != -2)
+      return false;
+    DEBUG_WITH_TYPE("jitlink", {
+      dbgs() << "  Fixing " << G.getEdgeKindName(E.getKind()) << " edge at "
+             << B->getFixupAddress(E) << " (" << B->getAddress() << " + "
+             << formatv("{0:x}", E.getOffset()) << ")\n";
+    });
+    E.setKind(BranchPCRel16ToStubBypassable);
+    E.setTarget(getEntryForTarget(G, E.getTarget()));
+    return true;
+  }
+
+  Symbol &createEntry(LinkGraph &G, Symbol &Target) {
+    auto &B = G.createContentBlock(getStubsSection(G), JumpStubContent,
+                                   orc::ExecutorAddr(), 1, 0);
+    B.addEdge(Pointer32, 4, Target, 0);
+    return G.addAnonymousSymbol(B, 0, sizeof(JumpStubContent), true, false);
+  }
+
+private:
+  Section &getStubsSection(LinkGraph &G) {
+    if (!StubsSection)
+      StubsSection = &G.createSection(getSectionName(),
+                                      orc::MemProt::Read | orc::MemProt::Exec);
+    return *StubsSection;
+  }
+
+  Section *StubsSection = nullptr;
+};
+
+/// Point BranchPCRel16ToStubBypassable edges straight at the stub's target
+/// when it is within range of the branch.
+LLVM_ABI Error optimizeStubAccesses(LinkGraph &G);
+
+} // namespace llvm::jitlink::m65832
+
+#endif // LLVM_EXECUTIONENGINE_JITLINK_M65832_H
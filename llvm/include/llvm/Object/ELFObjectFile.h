@@ -1324,6 +1324,8 @@ StringRef ELFObjectFile<ELFT>::getFileFormatName() const {
       return "elf32-loongarch";
     case ELF::EM_XTENSA:
       return "elf32-xtensa";
+    case ELF::EM_M65832:
+      return "elf32-m65832";
     default:
       return "elf32-unknown";
     }
@@ -1457,6 +1459,9 @@ template <class ELFT> Triple::ArchType ELFObjectFile<ELFT>::getArch() const {
   case ELF::EM_XTENSA:
     return Triple::xtensa;
 
+  case ELF::EM_M65832:
+    return Triple::m65832;
+
   default:
     return Triple::UnknownArch;
   }
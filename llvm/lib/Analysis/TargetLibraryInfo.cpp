@@ -58,6 +58,9 @@ static bool hasBcmp(const Triple &TT) {
   // implementations of the libc still have it.
   if (TT.isOSLinux())
     return TT.isGNUEnvironment() || TT.isMusl();
+  // The M65832 libc, newlib and picolibc all provide it.
+  if (TT.getArch() == Triple::m65832)
+    return true;
   // Both NetBSD and OpenBSD are planning to remove the function. Windows does
   // not have it.
   return TT.isOSFreeBSD() || TT.isOSSolaris();
@@ -16,6 +16,7 @@
 #include "llvm/ExecutionEngine/JITLink/ELF_aarch32.h"
 #include "llvm/ExecutionEngine/JITLink/ELF_aarch64.h"
 #include "llvm/ExecutionEngine/JITLink/ELF_loongarch.h"
+#include "llvm/ExecutionEngine/JITLink/ELF_m65832.h"
 #include "llvm/ExecutionEngine/JITLink/ELF_ppc64.h"
 #include "llvm/ExecutionEngine/JITLink/ELF_riscv.h"
 #include "llvm/ExecutionEngine/JITLink/ELF_systemz.h"
@@ -89,6 +90,8 @@ createLinkGraphFromELFObject(MemoryBufferRef ObjectBuffer,
     return createLinkGraphFromELFObject_aarch64(ObjectBuffer, std::move(SSP));
   case ELF::EM_ARM:
     return createLinkGraphFromELFObject_aarch32(ObjectBuffer, std::move(SSP));
+  case ELF::EM_M65832:
+    return createLinkGraphFromELFObject_m65832(ObjectBuffer, std::move(SSP));
   case ELF::EM_PPC64: {
     if (DataEncoding == ELF::ELFDATA2LSB)
       return createLinkGraphFromELFObject_ppc64le(ObjectBuffer, std::move(SSP));
@@ -128,6 +131,9 @@ void link_ELF(std::unique_ptr<LinkGraph> G,
   case Triple::loongarch64:
     link_ELF_loongarch(std::move(G), std::move(Ctx));
     return;
+  case Triple::m65832:
+    link_ELF_m65832(std::move(G), std::move(Ctx));
+    return;
   case Triple::ppc64:
     link_ELF_ppc64(std::move(G), std::move(Ctx));
     return;
@@ -0,0 +1,269 @@
+//===----- ELF_m65832.cpp - JIT linker implementation for ELF/M65832 ------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// ELF/M65832 jit-link implementation.
+//
+// Objects are linked as they were assembled: R_M65832_RELAX and
+// R_M65832_ALIGN are ignored, so -mrelax code keeps its long forms and the
+// assembler's alignment padding, both of which are correct as they stand.
+// There is no TLS support, and so no R_M65832_TPREL_32.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/JITLink/ELF_m65832.h"
+#include "ELFLinkGraphBuilder.h"
+#include "JITLinkGeneric.h"
+#include "llvm/BinaryFormat/ELF.h"
+#include "llvm/ExecutionEngine/JITLink/m65832.h"
+#include "llvm/Object/ELFObjectFile.h"
+
+#define DEBUG_TYPE "jitlink"
+
+using namespace llvm;
+using namespace llvm::jitlink;
+using namespace llvm::jitlink::m65832;
+
+namespace {
+
+Error buildTables_ELF_m65832(LinkGraph &G) {
+  LLVM_DEBUG(dbgs() << "Visiting edges in graph:\n");
+
+  JumpStubTableManager Stubs;
+  visitExistingEdges(G, Stubs);
+  return Error::success();
+}
+
+} // namespace
+
+namespace llvm::jitlink {
+
+class ELFJITLinker_m65832 : public JITLinker<ELFJITLinker_m65832> {
+  friend class JITLinker<ELFJITLinker_m65832>;
+
+public:
+  ELFJITLinker_m65832(std::unique_ptr<JITLinkContext> Ctx,
+                      std::unique_ptr<LinkGraph> G,
+                      PassConfiguration PassConfig)
+      : JITLinker(std::move(Ctx), std::move(G), std::move(PassConfig)) {
+    getPassConfig().PostPrunePasses.push_back(
+        [this](LinkGraph &G) { return findBaseSymbols(G); });
+  }
+
+private:
+  BaseSymbols Bases;
+
+  // The graph's own definition if it has one, otherwise an external that
+  // the process the code is linked into resolves, the way a running image
+  // exports the symbols its linker script defined.
+  static Symbol &getOrAddBaseSymbol(LinkGraph &G, StringRef Name) {
+    auto SymName = G.intern(Name);
+    if (auto *Sym = G.findDefinedSymbolByName(SymName))
+      return *Sym;
+    if (auto *Sym = G.findAbsoluteSymbolByName(SymName))
+      return *Sym;
+    if (auto *Sym = G.findExternalSymbolByName(SymName))
+      return *Sym;
+    return G.addExternalSymbol(std::move(SymName), 0, false);
+  }
+
+  // Runs after pruning, which would drop externals that no edge refers to.
+  Error findBaseSymbols(LinkGraph &G) {
+    bool NeedsGP = false, NeedsBank = false, NeedsDP = false;
+    for (auto *B : G.blocks())
+      for (auto &E : B->edges()) {
+        NeedsGP |= E.getKind() == Delta32FromGlobalPointer;
+        NeedsBank |= E.getKind() == Delta16FromDataBank;
+        NeedsDP |= E.getKind() == Delta8FromDirectPage;
+      }
+
+    if (NeedsGP)
+      Bases.GlobalPointer = &getOrAddBaseSymbol(G, GlobalPointerSymbolName);
+    if (NeedsBank)
+      Bases.DataBank = &getOrAddBaseSymbol(G, DataBankSymbolName);
+    if (NeedsDP)
+      Bases.DirectPage = &getOrAddBaseSymbol(G, DirectPageSymbolName);
+    return Error::success();
+  }
+
+  Error applyFixup(LinkGraph &G, Block &B, const Edge &E) const {
+    return m65832::applyFixup(G, B, E, Bases);
+  }
+};
+
+class ELFLinkGraphBuilder_m65832
+    : public ELFLinkGraphBuilder<object::ELF32LE> {
+private:
+  using ELFT = object::ELF32LE;
+
+  Expected<EdgeKind_m65832> getRelocationKind(const uint32_t Type) {
+    switch (Type) {
+    case ELF::R_M65832_8:
+      return Pointer8;
+    case ELF::R_M65832_16:
+      return Pointer16;
+    case ELF::R_M65832_24:
+      return Pointer24;
+    case ELF::R_M65832_32:
+      return Pointer32;
+    case ELF::R_M65832_PCREL_8:
+      return BranchPCRel8;
+    case ELF::R_M65832_PCREL_16:
+      return BranchPCRel16;
+    case ELF::R_M65832_PCREL_32:
+      return Delta32;
+    case ELF::R_M65832_GPREL_32:
+      return Delta32FromGlobalPointer;
+    case ELF::R_M65832_BANKREL_16:
+      return Delta16FromDataBank;
+    case ELF::R_M65832_DP_8:
+      return Delta8FromDirectPage;
+    case ELF::R_M65832_ADD8:
+      return Add8;
+    case ELF::R_M65832_ADD16:
+      return Add16;
+    case ELF::R_M65832_ADD32:
+      return Add32;
+    case ELF::R_M65832_ADD_ULEB128:
+      return AddULEB128;
+    case ELF::R_M65832_SUB8:
+      return Sub8;
+    case ELF::R_M65832_SUB16:
+      return Sub16;
+    case ELF::R_M65832_SUB32:
+      return Sub32;
+    case ELF::R_M65832_SUB_ULEB128:
+      return SubULEB128;
+    }
+
+    return make_error<JITLinkError>(
+        "In " + G->getName() + ": Unsupported M65832 relocation type " +
+        object::getELFRelocationTypeName(ELF::EM_M65832, Type));
+  }
+
+  Error addRelocations() override {
+    LLVM_DEBUG(dbgs() << "Processing relocations:\n");
+
+    using Base = ELFLinkGraphBuilder<ELFT>;
+    using Self = ELFLinkGraphBuilder_m65832;
+    for (const auto &RelSect : Base::Sections) {
+      if (RelSect.sh_type == ELF::SHT_REL)
+        return make_error<StringError>(
+            "No SHT_REL in valid M65832 ELF object files",
+            inconvertibleErrorCode());
+
+      if (Error Err = Base::forEachRelaRelocation(RelSect, this,
+                                                  &Self::addSingleRelocation))
+        return Err;
+    }
+
+    return Error::success();
+  }
+
+  Error addSingleRelocation(const typename ELFT::Rela &Rel,
+                            const typename ELFT::Shdr &FixupSect,
+                            Block &BlockToFix) {
+    using Base = ELFLinkGraphBuilder<ELFT>;
+
+    uint32_t Type = Rel.getType(false);
+    // Linker hints only; see the file comment.
+    if (Type == ELF::R_M65832_NONE || Type == ELF::R_M65832_RELAX ||
+        Type == ELF::R_M65832_ALIGN)
+      return Error::success();
+
+    Expected<EdgeKind_m65832> Kind = getRelocationKind(Type);
+    if (!Kind)
+      return Kind.takeError();
+
+    uint32_t SymbolIndex = Rel.getSymbol(false);
+    auto ObjSymbol = Base::Obj.getRelocationSymbol(Rel, Base::SymTabSec);
+    if (!ObjSymbol)
+      return ObjSymbol.takeError();
+
+    Symbol *GraphSymbol = Base::getGraphSymbol(SymbolIndex);
+    if (!GraphSymbol)
+      return make_error<StringError>(
+          formatv("Could not find symbol at given index, did you add it to "
+                  "JITSymbolTable? index: {0}, shndx: {1} Size of table: {2}",
+                  SymbolIndex, (*ObjSymbol)->st_shndx,
+                  Base::GraphSymbols.size()),
+          inconvertibleErrorCode());
+
+    int64_t Addend = Rel.r_addend;
+    auto FixupAddress = orc::ExecutorAddr(FixupSect.sh_addr) + Rel.r_offset;
+    Edge::OffsetT Offset = FixupAddress - BlockToFix.getAddress();
+    Edge GE(*Kind, Offset, *GraphSymbol, Addend);
+    LLVM_DEBUG({
+      dbgs() << "    ";
+      printEdge(dbgs(), BlockToFix, GE, getEdgeKindName(*Kind));
+      dbgs() << "\n";
+    });
+
+    BlockToFix.addEdge(std::move(GE));
+    return Error::success();
+  }
+
+public:
+  ELFLinkGraphBuilder_m65832(StringRef FileName,
+                             const object::ELFFile<ELFT> &Obj,
+                             std::shared_ptr<orc::SymbolStringPool> SSP,
+                             Triple TT, SubtargetFeatures Features)
+      : ELFLinkGraphBuilder<ELFT>(Obj, std::move(SSP), std::move(TT),
+                                  std::move(Features), FileName,
+                                  m65832::getEdgeKindName) {}
+};
+
+Expected<std::unique_ptr<LinkGraph>> createLinkGraphFromELFObject_m65832(
+    MemoryBufferRef ObjectBuffer, std::shared_ptr<orc::SymbolStringPool> SSP) {
+  LLVM_DEBUG({
+    dbgs() << "Building jitlink graph for new input "
+           << ObjectBuffer.getBufferIdentifier() << "...\n";
+  });
+
+  auto ELFObj = object::ObjectFile::createELFObjectFile(ObjectBuffer);
+  if (!ELFObj)
+    return ELFObj.takeError();
+
+  auto Features = (*ELFObj)->getFeatures();
+  if (!Features)
+    return Features.takeError();
+
+  assert((*ELFObj)->getArch() == Triple::m65832 &&
+         "Only M65832 (little endian) is supported");
+
+  auto &ELFObjFile = cast<object::ELFObjectFile<object::ELF32LE>>(**ELFObj);
+
+  return ELFLinkGraphBuilder_m65832((*ELFObj)->getFileName(),
+                                    ELFObjFile.getELFFile(), std::move(SSP),
+                                    (*ELFObj)->makeTriple(),
+                                    std::move(*Features))
+      .buildGraph();
+}
+
+void link_ELF_m65832(std::unique_ptr<LinkGraph> G,
+                     std::unique_ptr<JITLinkContext> Ctx) {
+  PassConfiguration Config;
+  const Triple &TT = G->getTargetTriple();
+  if (Ctx->shouldAddDefaultTargetPasses(TT)) {
+    if (auto MarkLive = Ctx->getMarkLivePass(TT))
+      Config.PrePrunePasses.push_back(std::move(MarkLive));
+    else
+      Config.PrePrunePasses.push_back(markAllSymbolsLive);
+
+    // Route 16-bit branches to externals through jump stubs.
+    Config.PostPrunePasses.push_back(buildTables_ELF_m65832);
+
+    // Bypass the stubs whose targets ended up within range.
+    Config.PreFixupPasses.push_back(optimizeStubAccesses);
+  }
+  if (auto Err = Ctx->modifyPassConfig(*G, Config))
+    return Ctx->notifyFailed(std::move(Err));
+
+  ELFJITLinker_m65832::link(std::move(Ctx), std::move(G), std::move(Config));
+}
+
+} // namespace llvm::jitlink
@@ -0,0 +1,265 @@
+//===------ m65832.cpp - Generic JITLink M65832 edge kinds, utilities -----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Generic utilities for graphs representing M65832 objects.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/JITLink/m65832.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/LEB128.h"
+
+#define DEBUG_TYPE "jitlink"
+
+namespace llvm::jitlink::m65832 {
+
+const char *getEdgeKindName(Edge::Kind K) {
+  switch (K) {
+  case Pointer32:
+    return "Pointer32";
+  case Pointer24:
+    return "Pointer24";
+  case Pointer16:
+    return "Pointer16";
+  case Pointer8:
+    return "Pointer8";
+  case Delta32:
+    return "Delta32";
+  case BranchPCRel16:
+    return "BranchPCRel16";
+  case BranchPCRel16ToStubBypassable:
+    return "BranchPCRel16ToStubBypassable";
+  case BranchPCRel8:
+    return "BranchPCRel8";
+  case Delta32FromGlobalPointer:
+    return "Delta32FromGlobalPointer";
+  case Delta16FromDataBank:
+    return "Delta16FromDataBank";
+  case Delta8FromDirectPage:
+    return "Delta8FromDirectPage";
+  case Add8:
+    return "Add8";
+  case Add16:
+    return "Add16";
+  case Add32:
+    return "Add32";
+  case AddULEB128:
+    return "AddULEB128";
+  case Sub8:
+    return "Sub8";
+  case Sub16:
+    return "Sub16";
+  case Sub32:
+    return "Sub32";
+  case SubULEB128:
+    return "SubULEB128";
+  }
+
+  return getGenericEdgeKindName(K);
+}
+
+const char NullPointerContent[PointerSize] = {0x00, 0x00, 0x00, 0x00};
+
+const char PointerJumpStubContent[11] = {
+    0x02, static_cast<char>(0x80u), static_cast<char>(0xB0u), 0x7C,
+    0x00, 0x00, 0x00, 0x00,         // LD.L R31,ptr
+    0x02, static_cast<char>(0xA5u), 0x7C}; // JMP (R31)
+
+const char JumpStubContent[11] = {
+    0x02, static_cast<char>(0x80u), static_cast<char>(0xB8u), 0x7C,
+    0x00, 0x00, 0x00, 0x00,         // LD.L R31,#target
+    0x02, static_cast<char>(0xA5u), 0x7C}; // JMP (R31)
+
+static Error makeMissingBaseError(LinkGraph &G, Block &B, const Edge &E,
+                                  StringRef Name) {
+  return make_error<JITLinkError>(
+      "In graph " + G.getName() + ", section " + B.getSection().getName() +
+      ": " + getEdgeKindName(E.getKind()) + " edge requires " + Name +
+      " to be defined");
+}
+
+// Add Value to the ULEB128 at FixupPtr, keeping its encoded length.
+static Error addToULEB128(LinkGraph &G, Block &B, const Edge &E,
+                          char *FixupPtr, uint64_t Value) {
+  const uint32_t MaxCount = 1 + 64 / 7;
+  auto *Loc = reinterpret_cast<uint8_t *>(FixupPtr);
+  const uint8_t *End =
+      reinterpret_cast<const uint8_t *>(B.getContent().end());
+  unsigned Count;
+  const char *ErrMsg = nullptr;
+  uint64_t Orig = decodeULEB128(Loc, &Count, End, &ErrMsg);
+  if (ErrMsg || Count > MaxCount)
+    return make_error<JITLinkError>(
+        "In graph " + G.getName() + ", section " + B.getSection().getName() +
+        ": invalid ULEB128 at offset " + formatv("{0:x}", E.getOffset()));
+  uint64_t Mask = Count < MaxCount ? (1ULL << 7 * Count) - 1 : ~0ULL;
+  encodeULEB128((Orig + Value) & Mask, Loc, Count);
+  return Error::success();
+}
+
+Error applyFixup(LinkGraph &G, Block &B, const Edge &E,
+                 const BaseSymbols &Bases) {
+  using namespace llvm::support;
+
+  char *BlockWorkingMem = B.getAlreadyMutableContent().data();
+  char *FixupPtr = BlockWorkingMem + E.getOffset();
+  orc::ExecutorAddr FixupAddress = B.getAddress() + E.getOffset();
+  uint64_t TargetAddress = E.getTarget().getAddress().getValue();
+
+  switch (E.getKind()) {
+  case Pointer32: {
+    uint64_t Value = TargetAddress + E.getAddend();
+    if (LLVM_UNLIKELY(!isUInt<32>(Value)))
+      return makeTargetOutOfRangeError(G, B, E);
+    *(ulittle32_t *)FixupPtr = Value;
+    break;
+  }
+
+  case Pointer24: {
+    uint64_t Value = TargetAddress + E.getAddend();
+    if (LLVM_UNLIKELY(!isUInt<24>(Value)))
+      return makeTargetOutOfRangeError(G, B, E);
+    *(ulittle16_t *)FixupPtr = Value & 0xFFFF;
+    FixupPtr[2] = (Value >> 16) & 0xFF;
+    break;
+  }
+
+  case Pointer16: {
+    int64_t Value = TargetAddress + E.getAddend();
+    if (LLVM_UNLIKELY(!isInt<16>(Value) && !isUInt<16>(Value)))
+      return makeTargetOutOfRangeError(G, B, E);
+    *(ulittle16_t *)FixupPtr = Value;
+    break;
+  }
+
+  case Pointer8: {
+    int64_t Value = TargetAddress + E.getAddend();
+    if (LLVM_UNLIKELY(!isInt<8>(Value) && !isUInt<8>(Value)))
+      return makeTargetOutOfRangeError(G, B, E);
+    *(uint8_t *)FixupPtr = Value;
+    break;
+  }
+
+  case Delta32: {
+    int64_t Value = E.getTarget().getAddress() - FixupAddress + E.getAddend();
+    *(little32_t *)FixupPtr = Value;
+    break;
+  }
+
+  case BranchPCRel16:
+  case BranchPCRel16ToStubBypassable: {
+    int64_t Value = E.getTarget().getAddress() - FixupAddress + E.getAddend();
+    if (LLVM_UNLIKELY(!isInt<16>(Value)))
+      return makeTargetOutOfRangeError(G, B, E);
+    *(little16_t *)FixupPtr = Value;
+    break;
+  }
+
+  case BranchPCRel8: {
+    int64_t Value = E.getTarget().getAddress() - FixupAddress + E.getAddend();
+    if (LLVM_UNLIKELY(!isInt<8>(Value)))
+      return makeTargetOutOfRangeError(G, B, E);
+    *(int8_t *)FixupPtr = Value;
+    break;
+  }
+
+  case Delta32FromGlobalPointer: {
+    if (!Bases.GlobalPointer)
+      return makeMissingBaseError(G, B, E, GlobalPointerSymbolName);
+    int64_t Value = E.getTarget().getAddress() -
+                    Bases.GlobalPointer->getAddress() + E.getAddend();
+    *(little32_t *)FixupPtr = Value;
+    break;
+  }
+
+  case Delta16FromDataBank: {
+    if (!Bases.DataBank)
+      return makeMissingBaseError(G, B, E, DataBankSymbolName);
+    int64_t Value = E.getTarget().getAddress() - Bases.DataBank->getAddress() +
+                    E.getAddend();
+    if (LLVM_UNLIKELY(!isUInt<16>(Value)))
+      return makeTargetOutOfRangeError(G, B, E);
+    *(ulittle16_t *)FixupPtr = Value;
+    break;
+  }
+
+  case Delta8FromDirectPage: {
+    if (!Bases.DirectPage)
+      return makeMissingBaseError(G, B, E, DirectPageSymbolName);
+    int64_t Value = E.getTarget().getAddress() -
+                    Bases.DirectPage->getAddress() + E.getAddend();
+    if (LLVM_UNLIKELY(!isUInt<8>(Value)))
+      return makeTargetOutOfRangeError(G, B, E);
+    *(uint8_t *)FixupPtr = Value;
+    break;
+  }
+
+  case Add8:
+    *(uint8_t *)FixupPtr += TargetAddress + E.getAddend();
+    break;
+  case Add16:
+    *(ulittle16_t *)FixupPtr += TargetAddress + E.getAddend();
+    break;
+  case Add32:
+    *(ulittle32_t *)FixupPtr += TargetAddress + E.getAddend();
+    break;
+  case AddULEB128:
+    return addToULEB128(G, B, E, FixupPtr, TargetAddress + E.getAddend());
+  case Sub8:
+    *(uint8_t *)FixupPtr -= TargetAddress + E.getAddend();
+    break;
+  case Sub16:
+    *(ulittle16_t *)FixupPtr -= TargetAddress + E.getAddend();
+    break;
+  case Sub32:
+    *(ulittle32_t *)FixupPtr -= TargetAddress + E.getAddend();
+    break;
+  case SubULEB128:
+    return addToULEB128(G, B, E, FixupPtr, -(TargetAddress + E.getAddend()));
+
+  default:
+    return make_error<JITLinkError>(
+        "In graph " + G.getName() + ", section " + B.getSection().getName() +
+        " unsupported edge kind " + getEdgeKindName(E.getKind()));
+  }
+
+  return Error::success();
+}
+
+Error optimizeStubAccesses(LinkGraph &G) {
+  LLVM_DEBUG(dbgs() << "Optimizing stubs:\n");
+
+  for (auto *B : G.blocks())
+    for (auto &E : B->edges()) {
+      if (E.getKind() != BranchPCRel16ToStubBypassable)
+        continue;
+      auto &StubBlock = E.getTarget().getBlock();
+      assert(StubBlock.getSize() == sizeof(JumpStubContent) &&
+             "Stub block should be stub sized");
+      assert(StubBlock.edges_size() == 1 &&
+             "Stub block should only have one outgoing edge");
+
+      auto &StubTarget = StubBlock.edges().begin()->getTarget();
+      orc::ExecutorAddr EdgeAddr = B->getAddress() + E.getOffset();
+      int64_t Displacement =
+          StubTarget.getAddress() - EdgeAddr + E.getAddend();
+      if (isInt<16>(Displacement)) {
+        E.setKind(BranchPCRel16);
+        E.setTarget(StubTarget);
+        LLVM_DEBUG({
+          dbgs() << "  Replaced stub branch with direct branch:\n    ";
+          printEdge(dbgs(), *B, E, getEdgeKindName(E.getKind()));
+          dbgs() << "\n";
+        });
+      }
+    }
+
+  return Error::success();
+}
+
+} // namespace llvm::jitlink::m65832
@@ -367,7 +367,11 @@ void MCObjectFileInfo::initELFMCObjectFileInfo(const Triple &T, bool Large) {
         PositionIndependent ? dwarf::DW_EH_PE_pcrel : dwarf::DW_EH_PE_absptr;
     break;
   case Triple::xtensa:
-    FDECFIEncoding = dwarf::DW_EH_PE_sdata4;
+  case Triple::m65832:
+    // A -fPIC image may be loaded anywhere, so its FDEs are PC-relative
+    FDECFIEncoding = PositionIndependent
+                         ? dwarf::DW_EH_PE_pcrel | dwarf::DW_EH_PE_sdata4
+                         : dwarf::DW_EH_PE_sdata4;
     break;
   default:
     FDECFIEncoding = dwarf::DW_EH_PE_pcrel | dwarf::DW_EH_PE_sdata4;
@@ -175,6 +175,57 @@ static uint64_t resolveMSP430(uint64_t Type, uint64_t Offset, uint64_t S,
   }
 }
 
+static bool supportsM65832(uint64_t Type) {
+  switch (Type) {
+  case ELF::R_M65832_NONE:
+  case ELF::R_M65832_8:
+  case ELF::R_M65832_16:
+  case ELF::R_M65832_32:
+  case ELF::R_M65832_ADD8:
+  case ELF::R_M65832_SUB8:
+  case ELF::R_M65832_ADD16:
+  case ELF::R_M65832_SUB16:
+  case ELF::R_M65832_ADD32:
+  case ELF::R_M65832_SUB32:
+    // As for RISC-V, the unrelocated .uleb128 A-B is meaningful and
+    // DebugInfoDWARF does not inspect these
+  case ELF::R_M65832_ADD_ULEB128:
+  case ELF::R_M65832_SUB_ULEB128:
+    return true;
+  default:
+    return false;
+  }
+}
+
+static uint64_t resolveM65832(uint64_t Type, uint64_t Offset, uint64_t S,
+                              uint64_t LocData, int64_t Addend) {
+  uint64_t A = LocData;
+  switch (Type) {
+  case ELF::R_M65832_NONE:
+    return LocData;
+  case ELF::R_M65832_8:
+    return (S + Addend) & 0xFF;
+  case ELF::R_M65832_16:
+    return (S + Addend) & 0xFFFF;
+  case ELF::R_M65832_32:
+    return (S + Addend) & 0xFFFFFFFF;
+  case ELF::R_M65832_ADD8:
+    return (A + (S + Addend)) & 0xFF;
+  case ELF::R_M65832_SUB8:
+    return (A - (S + Addend)) & 0xFF;
+  case ELF::R_M65832_ADD16:
+    return (A + (S + Addend)) & 0xFFFF;
+  case ELF::R_M65832_SUB16:
+    return (A - (S + Addend)) & 0xFFFF;
+  case ELF::R_M65832_ADD32:
+    return (A + (S + Addend)) & 0xFFFFFFFF;
+  case ELF::R_M65832_SUB32:
+    return (A - (S + Addend)) & 0xFFFFFFFF;
+  default:
+    llvm_unreachable("Invalid relocation type");
+  }
+}
+
 static bool supportsPPC64(uint64_t Type) {
   switch (Type) {
   case ELF::R_PPC64_ADDR32:
@@ -843,6 +894,8 @@ getRelocationResolver(const ObjectFile &Obj) {
     case Triple::mipsel:
     case Triple::mips:
       return {supportsMips32, resolveMips32};
+    case Triple::m65832:
+      return {supportsM65832, resolveM65832};
     case Triple::msp430:
       return {supportsMSP430, resolveMSP430};
     case Triple::sparc:
@@ -895,8 +948,10 @@ uint64_t resolveRelocation(RelocationResolver Resolver, const RelocationRef &R,
       if (GetRelSectionType() == ELF::SHT_RELA ||
           GetRelSectionType() == ELF::SHT_CREL) {
         Addend = getELFAddend(R);
-        // LoongArch and RISCV relocations use both LocData and Addend.
+        // LoongArch, M65832 and RISCV relocations use both LocData and
+        // Addend.
         if (Obj->getArch() != Triple::loongarch32 &&
+            Obj->getArch() != Triple::m65832 &&
             Obj->getArch() != Triple::loongarch64 &&
             Obj->getArch() != Triple::riscv32 &&
             Obj->getArch() != Triple::riscv64 &&
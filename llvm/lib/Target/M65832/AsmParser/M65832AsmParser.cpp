@@ -151,6 +151,12 @@ public:
     return Mem.BaseReg != 0 && Mem.Indirect && Mem.IndexReg == M65832::Y;
   }
 
+  // Check if this is stack-relative addressing $xx,S
+  bool isStackRel() const {
+    return Kind == k_Memory && Mem.StackRelative && !Mem.Indirect &&
+           !Mem.IndirectLong && Mem.BaseReg == 0;
+  }
+
   StringRef getToken() const {
     assert(Kind == k_Token && "Not a token");
     return StringRef(Tok.Data, Tok.Length);
@@ -190,12 +196,29 @@ public:
     Inst.addOperand(MCOperand::createReg(getReg()));
   }
 
+  /// Add Expr as an immediate when it is already known, so the encoder
+  /// doesn't evaluate it again.
+  static void addExpr(MCInst &Inst, const MCExpr *Expr) {
+    int64_t Imm;
+    if (Expr->evaluateAsAbsolute(Imm))
+      Inst.addOperand(MCOperand::createImm(Imm));
+    else
+      Inst.addOperand(MCOperand::createExpr(Expr));
+  }
+
   void addImmOperands(MCInst &Inst, unsigned N) const {
     assert(N == 1 && "Invalid number of operands!");
     if (isImm())
-      Inst.addOperand(MCOperand::createExpr(getImm()));
+      addExpr(Inst, getImm());
     else if (isMem())
-      Inst.addOperand(MCOperand::createExpr(Mem.Disp));
+      addExpr(Inst, Mem.Disp);
+  }
+
+  // Branch targets stay expressions: to the encoder an immediate branch
+  // operand is a *+N offset, not an address.
+  void addBrTargetOperands(MCInst &Inst, unsigned N) const {
+    assert(N == 1 && "Invalid number of operands!");
+    Inst.addOperand(MCOperand::createExpr(isImm() ? getImm() : Mem.Disp));
   }
 
   void addMemOperands(MCInst &Inst, unsigned N) const {
@@ -205,7 +228,7 @@ public:
     if (Mem.BaseReg != 0) {
       Inst.addOperand(MCOperand::createReg(Mem.BaseReg));
     } else if (Mem.Disp) {
-      Inst.addOperand(MCOperand::createExpr(Mem.Disp));
+      addExpr(Inst, Mem.Disp);
     } else {
       // Fallback - should not happen
       Inst.addOperand(MCOperand::createImm(0));
@@ -252,65 +275,25 @@ public:
 } // end anonymous namespace
 
 unsigned M65832AsmParser::parseRegisterName(StringRef Name) {
-  // GPR registers R0-R63
-  if (Name.size() >= 2 && (Name[0] == 'R' || Name[0] == 'r')) {
-    unsigned RegNum;
-    if (!Name.substr(1).getAsInteger(10, RegNum) && RegNum <= 63) {
-      // Map register number to LLVM register enum
-      static const unsigned GPRRegs[] = {
-        M65832::R0, M65832::R1, M65832::R2, M65832::R3,
-        M65832::R4, M65832::R5, M65832::R6, M65832::R7,
-        M65832::R8, M65832::R9, M65832::R10, M65832::R11,
-        M65832::R12, M65832::R13, M65832::R14, M65832::R15,
-        M65832::R16, M65832::R17, M65832::R18, M65832::R19,
-        M65832::R20, M65832::R21, M65832::R22, M65832::R23,
-        M65832::R24, M65832::R25, M65832::R26, M65832::R27,
-        M65832::R28, M65832::R29, M65832::R30, M65832::R31,
-        M65832::R32, M65832::R33, M65832::R34, M65832::R35,
-        M65832::R36, M65832::R37, M65832::R38, M65832::R39,
-        M65832::R40, M65832::R41, M65832::R42, M65832::R43,
-        M65832::R44, M65832::R45, M65832::R46, M65832::R47,
-        M65832::R48, M65832::R49, M65832::R50, M65832::R51,
-        M65832::R52, M65832::R53, M65832::R54, M65832::R55,
-        M65832::R56, M65832::R57, M65832::R58, M65832::R59,
-        M65832::R60, M65832::R61, M65832::R62, M65832::R63
-      };
-      return GPRRegs[RegNum];
-    }
-  }
-
-  // FPU registers F0-F15
-  if (Name.size() >= 2 && (Name[0] == 'F' || Name[0] == 'f')) {
+  // Every operand identifier comes through here, symbols included, so stay
+  // allocation-free. R0-R63 and F0-F15 are contiguous in the register enum.
+  if (Name.size() >= 2) {
     unsigned RegNum;
-    if (!Name.substr(1).getAsInteger(10, RegNum) && RegNum <= 15) {
-      switch (RegNum) {
-      case 0: return M65832::F0;
-      case 1: return M65832::F1;
-      case 2: return M65832::F2;
-      case 3: return M65832::F3;
-      case 4: return M65832::F4;
-      case 5: return M65832::F5;
-      case 6: return M65832::F6;
-      case 7: return M65832::F7;
-      case 8: return M65832::F8;
-      case 9: return M65832::F9;
-      case 10: return M65832::F10;
-      case 11: return M65832::F11;
-      case 12: return M65832::F12;
-      case 13: return M65832::F13;
-      case 14: return M65832::F14;
-      case 15: return M65832::F15;
-      default: return 0;
-      }
+    char C = Name[0] | 0x20;
+    if ((C == 'r' || C == 'f') && !Name.substr(1).getAsInteger(10, RegNum)) {
+      if (C == 'r' && RegNum <= 63)
+        return M65832::R0 + RegNum;
+      if (C == 'f' && RegNum <= 15)
+        return M65832::F0 + RegNum;
     }
   }
 
   // Special registers
-  return StringSwitch<unsigned>(Name.upper())
-      .Case("A", M65832::A)
-      .Case("X", M65832::X)
-      .Case("Y", M65832::Y)
-      .Case("SP", M65832::SP)
+  return StringSwitch<unsigned>(Name)
+      .CaseLower("a", M65832::A)
+      .CaseLower("x", M65832::X)
+      .CaseLower("y", M65832::Y)
+      .CaseLower("sp", M65832::SP)
       .Default(0);
 }
 
@@ -195,6 +195,13 @@ const M65_ExtInstruction m65_ext_instructions[] = {
     { "I2F.S",  0xC8, M65_AM_FPU_REG1 },
     { "FMOV.S", 0xC9, M65_AM_FPU_REG2 },
     { "FSQRT.S",0xCA, M65_AM_FPU_REG2 },
+    { "FMIN.S", 0xCB, M65_AM_FPU_REG2 },  /* fpu-minmax */
+    { "FMAX.S", 0xCC, M65_AM_FPU_REG2 },
+    { "FMADD.S",0xCD, M65_AM_FPU_REG3 },  /* fpu-fma */
+    { "FRINTN.S",0xCE, M65_AM_FPU_RND },  /* fpu-round */
+    { "FRINTZ.S",0xCE, M65_AM_FPU_RND },
+    { "FRINTM.S",0xCE, M65_AM_FPU_RND },
+    { "FRINTP.S",0xCE, M65_AM_FPU_RND },
     /* FPU double-precision */
     { "FADD.D", 0xD0, M65_AM_FPU_REG2 },
     { "FSUB.D", 0xD1, M65_AM_FPU_REG2 },
@@ -207,6 +214,13 @@ const M65_ExtInstruction m65_ext_instructions[] = {
     { "I2F.D",  0xD8, M65_AM_FPU_REG1 },
     { "FMOV.D", 0xD9, M65_AM_FPU_REG2 },
     { "FSQRT.D",0xDA, M65_AM_FPU_REG2 },
+    { "FMIN.D", 0xDB, M65_AM_FPU_REG2 },  /* fpu-minmax */
+    { "FMAX.D", 0xDC, M65_AM_FPU_REG2 },
+    { "FMADD.D",0xDD, M65_AM_FPU_REG3 },  /* fpu-fma */
+    { "FRINTN.D",0xDE, M65_AM_FPU_RND },  /* fpu-round */
+    { "FRINTZ.D",0xDE, M65_AM_FPU_RND },
+    { "FRINTM.D",0xDE, M65_AM_FPU_RND },
+    { "FRINTP.D",0xDE, M65_AM_FPU_RND },
     /* FPU register transfers */
     { "FTOA",   0xE0, M65_AM_FPU_REG1 },
     { "FTOT",   0xE1, M65_AM_FPU_REG1 },
@@ -452,6 +466,10 @@ int m65_get_operand_size(M65_AddrMode mode, int m_flag, int x_flag) {
             return 1;   /* Register byte (Fn, Rm) */
         case M65_AM_FPU_LONG:
             return 5;   /* Register byte + ABS32 */
+        case M65_AM_FPU_REG3:
+            return 2;   /* Register bytes $ds $t0 */
+        case M65_AM_FPU_RND:
+            return 2;   /* Register byte + rounding mode */
         default:
             return 0;
     }
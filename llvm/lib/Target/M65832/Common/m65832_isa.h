@@ -57,6 +57,8 @@ typedef enum {
     M65_AM_FPU_ABS,     /* FP register + Abs: LDF F0, $xxxx */
     M65_AM_FPU_IND,     /* FP register + GPR indirect: LDF F0, (R0) */
     M65_AM_FPU_LONG,    /* FP register + 32-bit Abs: LDF F0, $xxxxxxxx */
+    M65_AM_FPU_REG3,    /* Three FP registers: FMADD.S F0, F1, F2 */
+    M65_AM_FPU_RND,     /* Two FP registers + mode from mnemonic: FRINTZ.S F0, F1 */
     M65_AM_COUNT
 } M65_AddrMode;
 
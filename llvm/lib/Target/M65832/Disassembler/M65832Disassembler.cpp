@@ -0,0 +1,585 @@
+//===-- M65832Disassembler.cpp - Disassembler for M65832 ------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the M65832Disassembler class.
+//
+// Instruction lengths come from the shared opcode tables in
+// Common/m65832_isa.c, so the byte stream stays in step even across
+// encodings the backend never produces. Encodings the code emitter does
+// produce are mapped back to their MC opcodes and print exactly as llc -S
+// writes them; anything else is reported as unknown with its real length.
+//
+//===----------------------------------------------------------------------===//
+
+#include "MCTargetDesc/M65832MCTargetDesc.h"
+#include "TargetInfo/M65832TargetInfo.h"
+#include "m65832_isa.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/MC/MCContext.h"
+#include "llvm/MC/MCDecoderOps.h"
+#include "llvm/MC/MCDisassembler/MCDisassembler.h"
+#include "llvm/MC/MCInst.h"
+#include "llvm/MC/MCInstrInfo.h"
+#include "llvm/MC/MCRegisterInfo.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/MC/TargetRegistry.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/MathExtras.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "m65832-disassembler"
+
+typedef MCDisassembler::DecodeStatus DecodeStatus;
+
+namespace {
+
+/// One encoding the code emitter produces. Standard opcodes are keyed by
+/// their first byte, $02-prefixed ones by the byte after the prefix, and
+/// extended-ALU ones by the opcode and mode bytes together.
+struct OpcodeEntry {
+  uint8_t Byte;
+  uint8_t Mode;
+  unsigned Opcode;
+};
+
+// Standard (unprefixed) opcodes. The operand layout follows the
+// instruction's Size: opcode, opcode+dp/imm8, opcode+16-bit, opcode+imm32.
+const OpcodeEntry StandardOpcodes[] = {
+    // Load/store
+    {0xA5, 0, M65832::LDA_DP},    {0xA9, 0, M65832::LDA_IMM},
+    {0xAD, 0, M65832::LDA_ABS},   {0xBD, 0, M65832::LDA_ABS_X},
+    {0xB2, 0, M65832::LDA_IND},   {0xB1, 0, M65832::LDA_IND_Y},
+    {0x85, 0, M65832::STA_DP},    {0x8D, 0, M65832::STA_ABS},
+    {0x9D, 0, M65832::STA_ABS_X}, {0x92, 0, M65832::STA_IND},
+    {0x91, 0, M65832::STA_IND_Y}, {0xA6, 0, M65832::LDX_DP},
+    {0xA2, 0, M65832::LDX_IMM},   {0xA4, 0, M65832::LDY_DP},
+    {0xA0, 0, M65832::LDY_IMM},   {0x86, 0, M65832::STX_DP},
+    {0x84, 0, M65832::STY_DP},    {0x64, 0, M65832::STZ_DP},
+    {0x9C, 0, M65832::STZ_ABS},   {0xA3, 0, M65832::LDA_SR},
+    {0x83, 0, M65832::STA_SR},
+    // Arithmetic and logic
+    {0x65, 0, M65832::ADC_DP},    {0x69, 0, M65832::ADC_IMM},
+    {0x72, 0, M65832::ADC_IND_r}, {0x71, 0, M65832::ADC_IND_Y_r},
+    {0xE5, 0, M65832::SBC_DP},    {0xE9, 0, M65832::SBC_IMM},
+    {0x1A, 0, M65832::INC_A},     {0x3A, 0, M65832::DEC_A},
+    {0xE6, 0, M65832::INC_DP},    {0xC6, 0, M65832::DEC_DP},
+    {0xEE, 0, M65832::INC_ABS},   {0xCE, 0, M65832::DEC_ABS},
+    {0x25, 0, M65832::AND_DP},    {0x29, 0, M65832::AND_IMM},
+    {0x05, 0, M65832::ORA_DP},    {0x09, 0, M65832::ORA_IMM},
+    {0x45, 0, M65832::EOR_DP},    {0x49, 0, M65832::EOR_IMM},
+    {0x6D, 0, M65832::ADC_ABS},   {0xED, 0, M65832::SBC_ABS},
+    {0x2D, 0, M65832::AND_ABS},   {0x0D, 0, M65832::ORA_ABS},
+    {0x4D, 0, M65832::EOR_ABS},   {0x63, 0, M65832::ADC_SR},
+    {0xE3, 0, M65832::SBC_SR},    {0x23, 0, M65832::AND_SR},
+    {0x03, 0, M65832::ORA_SR},    {0x43, 0, M65832::EOR_SR},
+    // Shifts
+    {0x0A, 0, M65832::ASL_A},     {0x06, 0, M65832::ASL_DP},
+    {0x4A, 0, M65832::LSR_A},     {0x46, 0, M65832::LSR_DP},
+    {0x2A, 0, M65832::ROL_A},     {0x26, 0, M65832::ROL_DP},
+    {0x6A, 0, M65832::ROR_A},     {0x66, 0, M65832::ROR_DP},
+    {0x0E, 0, M65832::ASL_ABS},   {0x4E, 0, M65832::LSR_ABS},
+    {0x2E, 0, M65832::ROL_ABS},   {0x6E, 0, M65832::ROR_ABS},
+    // Compare
+    {0xC5, 0, M65832::CMP_DP},    {0xC9, 0, M65832::CMP_IMM},
+    {0xC4, 0, M65832::CPY_DP},    {0xC0, 0, M65832::CPY_IMM},
+    {0xE4, 0, M65832::CPX_DP},    {0xE0, 0, M65832::CPX_IMM},
+    // Flags
+    {0xC2, 0, M65832::REP},       {0xE2, 0, M65832::SEP},
+    {0x18, 0, M65832::CLC},       {0x38, 0, M65832::SEC},
+    {0x58, 0, M65832::CLI},       {0x78, 0, M65832::SEI},
+    {0xD8, 0, M65832::CLD},       {0xF8, 0, M65832::SED},
+    {0xB8, 0, M65832::CLV},
+    // Transfers, index increments
+    {0xAA, 0, M65832::TAX},       {0x8A, 0, M65832::TXA},
+    {0xA8, 0, M65832::TAY},       {0x98, 0, M65832::TYA},
+    {0xBA, 0, M65832::TSX},       {0x9A, 0, M65832::TXS},
+    {0xE8, 0, M65832::INX},       {0xC8, 0, M65832::INY},
+    {0xCA, 0, M65832::DEX},       {0x88, 0, M65832::DEY},
+    // Branches, jumps, calls
+    {0xF0, 0, M65832::BEQ},       {0xD0, 0, M65832::BNE},
+    {0xB0, 0, M65832::BCS},       {0x90, 0, M65832::BCC},
+    {0x30, 0, M65832::BMI},       {0x10, 0, M65832::BPL},
+    {0x70, 0, M65832::BVS},       {0x50, 0, M65832::BVC},
+    {0x80, 0, M65832::BRA},       {0x82, 0, M65832::BRL},
+    {0x4C, 0, M65832::JMP},       {0x20, 0, M65832::JSR},
+    {0x60, 0, M65832::RTS},       {0x40, 0, M65832::RTI},
+    // Stack
+    {0x48, 0, M65832::PHA},       {0x68, 0, M65832::PLA},
+    {0xDA, 0, M65832::PHX},       {0xFA, 0, M65832::PLX},
+    {0x5A, 0, M65832::PHY},       {0x7A, 0, M65832::PLY},
+    {0x08, 0, M65832::PHP},       {0x28, 0, M65832::PLP},
+    {0x8B, 0, M65832::PHB},       {0xAB, 0, M65832::PLB},
+    {0x62, 0, M65832::PER},
+    // System
+    {0xEA, 0, M65832::NOP},       {0xDB, 0, M65832::STP},
+    {0xCB, 0, M65832::WAI},
+};
+
+// $02-prefixed opcodes outside the extended-ALU, shifter and extend groups.
+// Implied, dp, imm8, abs16 and imm32 forms again follow the Size.
+const OpcodeEntry ExtendedOpcodes[] = {
+    {0x00, 0, M65832::MUL_DP},   {0x01, 0, M65832::MULU_DP},
+    {0x04, 0, M65832::DIV_DP},   {0x05, 0, M65832::DIVU_DP},
+    {0x10, 0, M65832::CAS_DP},   {0x11, 0, M65832::CAS_ABS},
+    {0x13, 0, M65832::LLI_ABS},  {0x15, 0, M65832::SCI_ABS},
+    {0x22, 0, M65832::SB_IMM},   {0x23, 0, M65832::SB_DP},
+    {0x30, 0, M65832::RSET},     {0x31, 0, M65832::RCLR},
+    {0x40, 0, M65832::TRAP},     {0x50, 0, M65832::FENCE},
+    {0x51, 0, M65832::FENCER},   {0x52, 0, M65832::FENCEW},
+    {0x70, 0, M65832::PHD32},    {0x71, 0, M65832::PLD32},
+    {0x72, 0, M65832::PHB32},    {0x73, 0, M65832::PLB32},
+    {0x91, 0, M65832::TAB},      {0x92, 0, M65832::TBA},
+    {0x93, 0, M65832::TXB},      {0x94, 0, M65832::TBX},
+    {0x95, 0, M65832::TYB},      {0x96, 0, M65832::TBY},
+    {0x9A, 0, M65832::TTA},      {0x9B, 0, M65832::TAT},
+    {0xA4, 0, M65832::TSPB},     {0xA5, 0, M65832::JMP_DP_IND},
+    {0xA6, 0, M65832::JSR_DP_IND},
+};
+
+// Extended ALU ($02 op mode dest src). Mode is [size:2][target:1][am:5].
+const OpcodeEntry ExtALUOpcodes[] = {
+    // LD/ST, long
+    {0x80, 0xA0, M65832::MOVR_DP},   {0x80, 0xB8, M65832::LDR_IMM},
+    {0x80, 0xB0, M65832::LDR_ABS32}, {0x81, 0xB0, M65832::STR_ABS32},
+    {0x80, 0xB2, M65832::LDR_ABS32_Y},
+    // LD/ST, byte
+    {0x80, 0x20, M65832::LDB_DP},    {0x80, 0x24, M65832::LDB_IND_Y},
+    {0x80, 0x28, M65832::LDB_ABS},   {0x80, 0x30, M65832::LDB_ABS32},
+    {0x80, 0x38, M65832::LDB_IMM},   {0x81, 0x20, M65832::STB_DP},
+    {0x81, 0x24, M65832::STB_IND_Y}, {0x81, 0x28, M65832::STB_ABS},
+    {0x81, 0x30, M65832::STB_ABS32}, {0x87, 0x20, M65832::CMPB_DP},
+    {0x87, 0x38, M65832::CMPB_IMM},
+    // LD/ST, word
+    {0x80, 0x60, M65832::LDW_DP},    {0x80, 0x64, M65832::LDW_IND_Y},
+    {0x80, 0x68, M65832::LDW_ABS},   {0x80, 0x70, M65832::LDW_ABS32},
+    {0x80, 0x78, M65832::LDW_IMM},   {0x81, 0x60, M65832::STW_DP},
+    {0x81, 0x64, M65832::STW_IND_Y}, {0x81, 0x68, M65832::STW_ABS},
+    {0x81, 0x70, M65832::STW_ABS32}, {0x87, 0x60, M65832::CMPW_DP},
+    {0x87, 0x78, M65832::CMPW_IMM},
+    // Two-operand ALU, long
+    {0x82, 0xA0, M65832::ADDR_DP},   {0x82, 0xB8, M65832::ADDR_IMM},
+    {0x83, 0xA0, M65832::SUBR_DP},   {0x83, 0xB8, M65832::SUBR_IMM},
+    {0x84, 0xA0, M65832::ANDR_DP},   {0x84, 0xB8, M65832::ANDR_IMM},
+    {0x85, 0xA0, M65832::ORAR_DP},   {0x85, 0xB8, M65832::ORAR_IMM},
+    {0x86, 0xA0, M65832::EORR_DP},   {0x86, 0xB8, M65832::EORR_IMM},
+    {0x87, 0xA0, M65832::CMPR_DP},   {0x87, 0xB8, M65832::CMPR_IMM},
+};
+
+// Barrel shifter ($02 $98 op|cnt dest src), keyed by the op bits; a count
+// of $1F selects the A-register form.
+const OpcodeEntry ShifterOpcodes[] = {
+    {0x00, 0x00, M65832::SHLR}, {0x20, 0x00, M65832::SHRR},
+    {0x40, 0x00, M65832::SARR}, {0x60, 0x00, M65832::ROLR},
+    {0x80, 0x00, M65832::RORR}, {0x00, 0x1F, M65832::SHLR_VAR},
+    {0x20, 0x1F, M65832::SHRR_VAR}, {0x40, 0x1F, M65832::SARR_VAR},
+};
+
+// Extend ops ($02 $99 subop dest src)
+const OpcodeEntry ExtendOpcodes[] = {
+    {0x00, 0, M65832::SEXT8},  {0x01, 0, M65832::SEXT16},
+    {0x02, 0, M65832::ZEXT8},  {0x03, 0, M65832::ZEXT16},
+    {0x04, 0, M65832::CLZ},    {0x05, 0, M65832::CTZ},
+    {0x06, 0, M65832::POPCNT},
+};
+
+// FPU group ($02 op $ds [...]). Mode is the FRINT rounding-mode byte.
+const OpcodeEntry FPUOpcodes[] = {
+    {0xB1, 0, M65832::LDF_abs},    {0xB3, 0, M65832::STF_abs},
+    {0xB4, 0, M65832::LDF_ind},    {0xB5, 0, M65832::STF_ind},
+    {0xBA, 0, M65832::LDF_S_ind},  {0xBB, 0, M65832::STF_S_ind},
+    {0xC0, 0, M65832::FADD_S},     {0xC1, 0, M65832::FSUB_S},
+    {0xC2, 0, M65832::FMUL_S},     {0xC3, 0, M65832::FDIV_S},
+    {0xC4, 0, M65832::FNEG_S},     {0xC5, 0, M65832::FABS_S},
+    {0xC6, 0, M65832::FCMP_S},     {0xC7, 0, M65832::F2I_S_real},
+    {0xC8, 0, M65832::I2F_S_real}, {0xC9, 0, M65832::FMOV_S},
+    {0xCA, 0, M65832::FSQRT_S},    {0xCB, 0, M65832::FMIN_S},
+    {0xCC, 0, M65832::FMAX_S},     {0xCD, 0, M65832::FMADD_S},
+    {0xCE, 0, M65832::FRINTN_S},   {0xCE, 1, M65832::FRINTZ_S},
+    {0xCE, 2, M65832::FRINTM_S},   {0xCE, 3, M65832::FRINTP_S},
+    {0xD0, 0, M65832::FADD_D},     {0xD1, 0, M65832::FSUB_D},
+    {0xD2, 0, M65832::FMUL_D},     {0xD3, 0, M65832::FDIV_D},
+    {0xD4, 0, M65832::FNEG_D},     {0xD5, 0, M65832::FABS_D},
+    {0xD6, 0, M65832::FCMP_D},     {0xD7, 0, M65832::F2I_D_real},
+    {0xD8, 0, M65832::I2F_D_real}, {0xD9, 0, M65832::FMOV_D},
+    {0xDA, 0, M65832::FSQRT_D},    {0xDB, 0, M65832::FMIN_D},
+    {0xDC, 0, M65832::FMAX_D},     {0xDD, 0, M65832::FMADD_D},
+    {0xDE, 0, M65832::FRINTN_D},   {0xDE, 1, M65832::FRINTZ_D},
+    {0xDE, 2, M65832::FRINTM_D},   {0xDE, 3, M65832::FRINTP_D},
+    {0xE0, 0, M65832::FTOA},       {0xE1, 0, M65832::FTOT},
+    {0xE2, 0, M65832::ATOF},       {0xE3, 0, M65832::TTOF},
+    {0xE4, 0, M65832::FCVT_DS},    {0xE5, 0, M65832::FCVT_SD},
+};
+
+const uint8_t EXT_PREFIX = 0x02;
+const uint8_t SHIFTER_OPCODE = 0x98;
+const uint8_t EXTEND_OPCODE = 0x99;
+
+unsigned lookupOpcode(ArrayRef<OpcodeEntry> Table, uint8_t Byte,
+                      uint8_t Mode = 0) {
+  for (const OpcodeEntry &E : Table)
+    if (E.Byte == Byte && E.Mode == Mode)
+      return E.Opcode;
+  return 0;
+}
+
+class M65832Disassembler : public MCDisassembler {
+  std::unique_ptr<const MCInstrInfo> MCII;
+
+  /// Encoded length of every standard and $02-prefixed opcode the Common
+  /// tables define, or 0 where the byte is unassigned. Extended-ALU, shifter
+  /// and extend instructions are sized from their mode bytes instead.
+  uint8_t StandardLength[256] = {};
+  uint8_t ExtendedLength[256] = {};
+
+  /// Byte-indexed views of StandardOpcodes and ExtendedOpcodes, and the
+  /// Common extended-ALU entry for each $02 opcode byte, built once so that
+  /// decoding never scans a table.
+  unsigned StandardOpcode[256] = {};
+  unsigned ExtendedOpcode[256] = {};
+  const M65_ExtALUInstruction *ExtALUInfo[256] = {};
+
+  DecodeStatus decodeStandard(MCInst &MI, uint64_t &Size,
+                              ArrayRef<uint8_t> Bytes) const;
+  DecodeStatus decodeExtended(MCInst &MI, uint64_t &Size,
+                              ArrayRef<uint8_t> Bytes) const;
+  DecodeStatus decodeExtALU(MCInst &MI, uint64_t &Size,
+                            ArrayRef<uint8_t> Bytes) const;
+  DecodeStatus decodeFPU(MCInst &MI, unsigned Opcode,
+                         ArrayRef<uint8_t> Bytes) const;
+
+  /// Build the operands of \p Opcode from the decoded fields, in operand
+  /// order: GPR fields are register numbers, FPR fields FPU register
+  /// numbers, everything else immediates. Operands of single-register
+  /// classes and tied operands take no field.
+  DecodeStatus addOperands(MCInst &MI, unsigned Opcode,
+                           ArrayRef<int64_t> Fields) const;
+
+public:
+  M65832Disassembler(const MCSubtargetInfo &STI, MCContext &Ctx,
+                     const MCInstrInfo *MCII);
+
+  DecodeStatus getInstruction(MCInst &MI, uint64_t &Size,
+                              ArrayRef<uint8_t> Bytes, uint64_t Address,
+                              raw_ostream &CStream) const override;
+};
+
+} // end anonymous namespace
+
+M65832Disassembler::M65832Disassembler(const MCSubtargetInfo &STI,
+                                       MCContext &Ctx,
+                                       const MCInstrInfo *MCII)
+    : MCDisassembler(STI, Ctx), MCII(MCII) {
+  // The backend always runs in 32-bit mode (M=X=32-bit), which fixes the
+  // immediate and relative-branch widths
+  for (const M65_Instruction *I = m65_instructions; I->name; ++I)
+    for (unsigned Mode = 0; Mode != M65_AM_COUNT; ++Mode)
+      if (I->opcodes[Mode] != M65_OP_INVALID)
+        StandardLength[I->opcodes[Mode]] =
+            1 + m65_get_operand_size(M65_AddrMode(Mode), 2, 2);
+
+  for (const M65_ExtInstruction *I = m65_ext_instructions; I->name; ++I)
+    ExtendedLength[I->ext_opcode] =
+        2 + m65_get_operand_size(I->mode, 2, 2);
+
+  for (const M65_ExtALUInstruction *I = m65_extalu_instructions; I->name; ++I)
+    ExtALUInfo[I->opcode] = I;
+
+  // Encodings the code emitter produces win over the tables, which predate
+  // some of them (the (dp) forms, the B and T transfers)
+  for (const OpcodeEntry &E : StandardOpcodes) {
+    StandardLength[E.Byte] = MCII->get(E.Opcode).getSize();
+    StandardOpcode[E.Byte] = E.Opcode;
+  }
+  for (const OpcodeEntry &E : ExtendedOpcodes) {
+    ExtendedLength[E.Byte] = MCII->get(E.Opcode).getSize();
+    ExtendedOpcode[E.Byte] = E.Opcode;
+  }
+
+#ifndef NDEBUG
+  // The decode tables, the .td encodings and the Common tables must agree
+  for (const OpcodeEntry &E : StandardOpcodes)
+    assert(M65832II::getOpcode(MCII->get(E.Opcode).TSFlags) == E.Byte &&
+           "standard opcode disagrees with M65832InstrInfo.td");
+  for (const OpcodeEntry &E : ExtendedOpcodes)
+    assert(M65832II::getOpcode(MCII->get(E.Opcode).TSFlags) == E.Byte &&
+           "extended opcode disagrees with M65832InstrInfo.td");
+  for (const OpcodeEntry &E : ExtALUOpcodes) {
+    uint64_t TSFlags = MCII->get(E.Opcode).TSFlags;
+    assert(M65832II::getOpcode(TSFlags) == E.Byte &&
+           M65832II::getExtMode(TSFlags) == E.Mode && ExtALUInfo[E.Byte] &&
+           "extended-ALU encoding disagrees with the .td or Common tables");
+    (void)TSFlags;
+  }
+#endif
+}
+
+static MCDisassembler *createM65832Disassembler(const Target &T,
+                                                const MCSubtargetInfo &STI,
+                                                MCContext &Ctx) {
+  return new M65832Disassembler(STI, Ctx, T.createMCInstrInfo());
+}
+
+extern "C" LLVM_EXTERNAL_VISIBILITY void LLVMInitializeM65832Disassembler() {
+  TargetRegistry::RegisterMCDisassembler(getTheM65832Target(),
+                                         createM65832Disassembler);
+}
+
+DecodeStatus M65832Disassembler::addOperands(MCInst &MI, unsigned Opcode,
+                                             ArrayRef<int64_t> Fields) const {
+  const MCInstrDesc &Desc = MCII->get(Opcode);
+  const MCRegisterInfo *MRI = getContext().getRegisterInfo();
+  MI.setOpcode(Opcode);
+
+  for (unsigned I = 0, E = Desc.getNumOperands(); I != E; ++I) {
+    int TiedTo = Desc.getOperandConstraint(I, MCOI::TIED_TO);
+    if (TiedTo != -1) {
+      MI.addOperand(MI.getOperand(TiedTo));
+      continue;
+    }
+
+    int16_t RCID = Desc.operands()[I].RegClass;
+    if (RCID != -1) {
+      const MCRegisterClass &RC = MRI->getRegClass(RCID);
+      if (RC.getNumRegs() == 1) {
+        MI.addOperand(MCOperand::createReg(RC.getRegister(0)));
+        continue;
+      }
+      // IDXREG only appears on the Y-register forms
+      if (RCID == M65832::IDXREGRegClassID) {
+        MI.addOperand(MCOperand::createReg(M65832::Y));
+        continue;
+      }
+      if (Fields.empty())
+        return MCDisassembler::Fail;
+      int64_t Num = Fields.front();
+      Fields = Fields.drop_front();
+      MCRegister First = RC.getRegister(0);
+      bool IsFPR = First >= M65832::F0 && First <= M65832::F15;
+      MCRegister Reg = IsFPR ? MCRegister(M65832::F0 + Num)
+                             : MCRegister(M65832::R0 + Num);
+      if (!RC.contains(Reg))
+        return MCDisassembler::Fail;
+      MI.addOperand(MCOperand::createReg(Reg));
+      continue;
+    }
+
+    if (Fields.empty())
+      return MCDisassembler::Fail;
+    MI.addOperand(MCOperand::createImm(Fields.front()));
+    Fields = Fields.drop_front();
+  }
+  return Fields.empty() ? MCDisassembler::Success : MCDisassembler::Fail;
+}
+
+/// Read the \p Size-byte little-endian operand at \p Bytes[Offset].
+static int64_t readOperand(ArrayRef<uint8_t> Bytes, unsigned Offset,
+                           unsigned Size) {
+  switch (Size) {
+  case 1:
+    return Bytes[Offset];
+  case 2:
+    return support::endian::read16le(&Bytes[Offset]);
+  default:
+    return support::endian::read32le(&Bytes[Offset]);
+  }
+}
+
+static bool isBranch(unsigned Opcode) {
+  switch (Opcode) {
+  case M65832::BEQ:
+  case M65832::BNE:
+  case M65832::BCS:
+  case M65832::BCC:
+  case M65832::BMI:
+  case M65832::BPL:
+  case M65832::BVS:
+  case M65832::BVC:
+  case M65832::BRA:
+  case M65832::BRL:
+  case M65832::PER: // PC-relative like a branch
+    return true;
+  default:
+    return false;
+  }
+}
+
+DecodeStatus M65832Disassembler::decodeStandard(MCInst &MI, uint64_t &Size,
+                                                ArrayRef<uint8_t> Bytes) const {
+  uint8_t Byte = Bytes[0];
+  Size = StandardLength[Byte] ? StandardLength[Byte] : 1;
+  if (Bytes.size() < Size)
+    return MCDisassembler::Fail;
+
+  unsigned Opcode = StandardOpcode[Byte];
+  if (!Opcode)
+    return MCDisassembler::Fail;
+  if (Size == 1)
+    return addOperands(MI, Opcode, {});
+
+  int64_t Value = readOperand(Bytes, 1, Size - 1);
+  // The (Rn) forms name the pointer register by its DP slot
+  if (MCII->get(Opcode).operands().back().RegClass != -1) {
+    if (Value % 4)
+      return MCDisassembler::Fail;
+    Value /= 4;
+  }
+  // Branch offsets count from the end of the instruction; the operand is
+  // the "*+N" distance from its start, as the emitter takes it
+  if (isBranch(Opcode))
+    Value = SignExtend64<16>(Value) + Size;
+  return addOperands(MI, Opcode, {Value});
+}
+
+DecodeStatus M65832Disassembler::decodeExtALU(MCInst &MI, uint64_t &Size,
+                                              ArrayRef<uint8_t> Bytes) const {
+  if (Bytes.size() < 3)
+    return MCDisassembler::Fail;
+  uint8_t Op = Bytes[1];
+  uint8_t Mode = Bytes[2];
+  unsigned SizeBits = Mode >> 6;
+  bool TargetsReg = Mode & 0x20;
+  unsigned AddrMode = Mode & 0x1F;
+
+  // dp-based modes take a byte, abs16 two, abs32 four; the immediate is as
+  // wide as the operation. Unary ops and STZ have no source operand.
+  unsigned SrcSize;
+  const M65_ExtALUInstruction *Info = ExtALUInfo[Op];
+  if (Info->is_unary || Op == 0x97)
+    SrcSize = TargetsReg ? 0 : m65_get_operand_size(M65_AM_DP, 2, 2);
+  else if (AddrMode < 0x08)
+    SrcSize = 1;
+  else if (AddrMode < 0x10)
+    SrcSize = 2;
+  else if (AddrMode < 0x18)
+    SrcSize = 4;
+  else
+    SrcSize = 1u << SizeBits;
+  Size = 3 + (TargetsReg ? 1 : 0) + SrcSize;
+  if (Bytes.size() < Size)
+    return MCDisassembler::Fail;
+
+  unsigned Opcode = lookupOpcode(ExtALUOpcodes, Op, Mode);
+  if (!Opcode)
+    return MCDisassembler::Fail;
+
+  // Register operands are DP slots; an unaligned byte is a plain DP
+  // address, which none of the register forms can print
+  uint8_t Dest = Bytes[3];
+  if (Dest % 4)
+    return MCDisassembler::Fail;
+  int64_t Src = readOperand(Bytes, 4, SrcSize);
+  if (AddrMode < 0x08) {
+    if (Src % 4)
+      return MCDisassembler::Fail;
+    Src /= 4;
+  }
+  return addOperands(MI, Opcode, {Dest / 4, Src});
+}
+
+DecodeStatus M65832Disassembler::decodeFPU(MCInst &MI, unsigned Opcode,
+                                           ArrayRef<uint8_t> Bytes) const {
+  unsigned D = Bytes[2] >> 4;
+  unsigned S = Bytes[2] & 0xF;
+
+  switch (Opcode) {
+  case M65832::LDF_abs:
+  case M65832::STF_abs:
+    return addOperands(MI, Opcode, {S, readOperand(Bytes, 3, 2)});
+  case M65832::FMADD_S:
+  case M65832::FMADD_D:
+    return addOperands(MI, Opcode, {D, S, Bytes[3] >> 4});
+  case M65832::F2I_S_real:
+  case M65832::F2I_D_real:
+  case M65832::I2F_S_real:
+  case M65832::I2F_D_real:
+  case M65832::FTOA:
+  case M65832::FTOT:
+  case M65832::ATOF:
+  case M65832::TTOF:
+    return addOperands(MI, Opcode, {D});
+  default:
+    // Two-register forms, including Fn,(Rm) loads and stores
+    return addOperands(MI, Opcode, {D, S});
+  }
+}
+
+DecodeStatus M65832Disassembler::decodeExtended(MCInst &MI, uint64_t &Size,
+                                                ArrayRef<uint8_t> Bytes) const {
+  if (Bytes.size() < 2) {
+    Size = 1;
+    return MCDisassembler::Fail;
+  }
+  uint8_t Op = Bytes[1];
+
+  if (ExtALUInfo[Op])
+    return decodeExtALU(MI, Size, Bytes);
+
+  // Shifter and extend: $02 $98/$99 op dest src
+  if (Op == SHIFTER_OPCODE || Op == EXTEND_OPCODE) {
+    Size = 5;
+    if (Bytes.size() < Size)
+      return MCDisassembler::Fail;
+    if (Bytes[3] % 4 || Bytes[4] % 4)
+      return MCDisassembler::Fail;
+    int64_t Dest = Bytes[3] / 4, Src = Bytes[4] / 4;
+    if (Op == EXTEND_OPCODE) {
+      unsigned Opcode = lookupOpcode(ExtendOpcodes, Bytes[2]);
+      if (!Opcode)
+        return MCDisassembler::Fail;
+      return addOperands(MI, Opcode, {Dest, Src});
+    }
+    uint8_t Count = Bytes[2] & 0x1F;
+    unsigned Opcode =
+        lookupOpcode(ShifterOpcodes, Bytes[2] & 0xE0, Count == 0x1F ? 0x1F : 0);
+    if (!Opcode)
+      return MCDisassembler::Fail;
+    if (Count == 0x1F)
+      return addOperands(MI, Opcode, {Dest, Src});
+    return addOperands(MI, Opcode, {Dest, Src, Count});
+  }
+
+  Size = ExtendedLength[Op] ? ExtendedLength[Op] : 2;
+  if (Bytes.size() < Size)
+    return MCDisassembler::Fail;
+
+  // FPU group: the register byte, then a rounding mode, a third register or
+  // a B-relative address
+  if (Op >= 0xB0 && Op <= 0xEF) {
+    if (Op == 0xCE || Op == 0xDE || Op == 0xCD || Op == 0xDD)
+      Size = 4;
+    if (Bytes.size() < Size)
+      return MCDisassembler::Fail;
+    uint8_t Mode = (Op == 0xCE || Op == 0xDE) ? Bytes[3] : 0;
+    unsigned Opcode = lookupOpcode(FPUOpcodes, Op, Mode);
+    if (!Opcode)
+      return MCDisassembler::Fail;
+    return decodeFPU(MI, Opcode, Bytes);
+  }
+
+  unsigned Opcode = ExtendedOpcode[Op];
+  if (!Opcode)
+    return MCDisassembler::Fail;
+  if (Size == 2)
+    return addOperands(MI, Opcode, {});
+  return addOperands(MI, Opcode, {readOperand(Bytes, 2, Size - 2)});
+}
+
+DecodeStatus M65832Disassembler::getInstruction(MCInst &MI, uint64_t &Size,
+                                                ArrayRef<uint8_t> Bytes,
+                                                uint64_t Address,
+                                                raw_ostream &CStream) const {
+  if (Bytes.empty()) {
+    Size = 0;
+    return MCDisassembler::Fail;
+  }
+  if (Bytes[0] == EXT_PREFIX)
+    return decodeExtended(MI, Size, Bytes);
+  return decodeStandard(MI, Size, Bytes);
+}
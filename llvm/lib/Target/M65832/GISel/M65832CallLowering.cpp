@@ -0,0 +1,279 @@
+//===-- M65832CallLowering.cpp - Call lowering ------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the lowering of LLVM calls to machine code calls for
+// GlobalISel.
+//
+//===----------------------------------------------------------------------===//
+
+#include "M65832CallLowering.h"
+#include "M65832ISelLowering.h"
+#include "M65832MachineFunctionInfo.h"
+#include "M65832Subtarget.h"
+#include "llvm/CodeGen/GlobalISel/MachineIRBuilder.h"
+#include "llvm/CodeGen/GlobalISel/Utils.h"
+#include "llvm/CodeGen/MachineFrameInfo.h"
+#include "llvm/IR/Function.h"
+
+using namespace llvm;
+
+namespace {
+
+struct M65832IncomingValueHandler : public CallLowering::IncomingValueHandler {
+  M65832IncomingValueHandler(MachineIRBuilder &MIRBuilder,
+                             MachineRegisterInfo &MRI)
+      : CallLowering::IncomingValueHandler(MIRBuilder, MRI) {}
+
+  void assignValueToReg(Register ValVReg, Register PhysReg,
+                        const CCValAssign &VA) override {
+    markPhysRegUsed(PhysReg);
+    IncomingValueHandler::assignValueToReg(ValVReg, PhysReg, VA);
+  }
+
+  void assignValueToAddress(Register ValVReg, Register Addr, LLT MemTy,
+                            const MachinePointerInfo &MPO,
+                            const CCValAssign &VA) override {
+    MachineFunction &MF = MIRBuilder.getMF();
+    auto *MMO = MF.getMachineMemOperand(MPO, MachineMemOperand::MOLoad, MemTy,
+                                        inferAlignFromPtrInfo(MF, MPO));
+    MIRBuilder.buildLoad(ValVReg, Addr, *MMO);
+  }
+
+  // Stack arguments sit above the return address, at the offsets
+  // LowerFormalArguments gives their fixed objects
+  Register getStackAddress(uint64_t Size, int64_t Offset,
+                           MachinePointerInfo &MPO,
+                           ISD::ArgFlagsTy Flags) override {
+    MachineFrameInfo &MFI = MIRBuilder.getMF().getFrameInfo();
+    int FI = MFI.CreateFixedObject(Size, Offset, /*IsImmutable=*/true);
+    MPO = MachinePointerInfo::getFixedStack(MIRBuilder.getMF(), FI);
+    return MIRBuilder.buildFrameIndex(LLT::pointer(0, 32), FI).getReg(0);
+  }
+
+  virtual void markPhysRegUsed(MCRegister PhysReg) = 0;
+};
+
+struct M65832FormalArgHandler : public M65832IncomingValueHandler {
+  M65832FormalArgHandler(MachineIRBuilder &MIRBuilder,
+                         MachineRegisterInfo &MRI)
+      : M65832IncomingValueHandler(MIRBuilder, MRI) {}
+
+  void markPhysRegUsed(MCRegister PhysReg) override {
+    MIRBuilder.getMRI()->addLiveIn(PhysReg);
+    MIRBuilder.getMBB().addLiveIn(PhysReg);
+  }
+};
+
+struct M65832CallReturnHandler : public M65832IncomingValueHandler {
+  M65832CallReturnHandler(MachineIRBuilder &MIRBuilder,
+                          MachineRegisterInfo &MRI, MachineInstrBuilder &MIB)
+      : M65832IncomingValueHandler(MIRBuilder, MRI), MIB(MIB) {}
+
+  void markPhysRegUsed(MCRegister PhysReg) override {
+    MIB.addDef(PhysReg, RegState::Implicit);
+  }
+
+  MachineInstrBuilder &MIB;
+};
+
+struct M65832OutgoingValueHandler : public CallLowering::OutgoingValueHandler {
+  M65832OutgoingValueHandler(MachineIRBuilder &MIRBuilder,
+                             MachineRegisterInfo &MRI,
+                             MachineInstrBuilder &MIB)
+      : OutgoingValueHandler(MIRBuilder, MRI), MIB(MIB) {}
+
+  void assignValueToReg(Register ValVReg, Register PhysReg,
+                        const CCValAssign &VA) override {
+    Register ExtReg = extendRegister(ValVReg, VA);
+    MIRBuilder.buildCopy(PhysReg, ExtReg);
+    MIB.addUse(PhysReg, RegState::Implicit);
+  }
+
+  void assignValueToAddress(Register ValVReg, Register Addr, LLT MemTy,
+                            const MachinePointerInfo &MPO,
+                            const CCValAssign &VA) override {
+    MachineFunction &MF = MIRBuilder.getMF();
+    Register ExtReg = extendRegister(ValVReg, VA);
+    auto *MMO = MF.getMachineMemOperand(MPO, MachineMemOperand::MOStore, MemTy,
+                                        inferAlignFromPtrInfo(MF, MPO));
+    MIRBuilder.buildStore(ExtReg, Addr, *MMO);
+  }
+
+  // Outgoing stack arguments are stored SP-relative once ADJCALLSTACKDOWN
+  // has made room for them, as LowerCall does
+  Register getStackAddress(uint64_t Size, int64_t Offset,
+                           MachinePointerInfo &MPO,
+                           ISD::ArgFlagsTy Flags) override {
+    MachineFunction &MF = MIRBuilder.getMF();
+    LLT p0 = LLT::pointer(0, 32);
+    LLT s32 = LLT::scalar(32);
+
+    if (!SPReg)
+      SPReg = MIRBuilder.buildCopy(p0, Register(M65832::SP)).getReg(0);
+
+    auto OffsetReg = MIRBuilder.buildConstant(s32, Offset);
+    auto AddrReg = MIRBuilder.buildPtrAdd(p0, SPReg, OffsetReg);
+    MPO = MachinePointerInfo::getStack(MF, Offset);
+    return AddrReg.getReg(0);
+  }
+
+  MachineInstrBuilder &MIB;
+  Register SPReg;
+};
+
+} // end anonymous namespace
+
+M65832CallLowering::M65832CallLowering(const M65832TargetLowering &TLI)
+    : CallLowering(&TLI) {}
+
+bool M65832CallLowering::lowerReturn(MachineIRBuilder &MIRBuilder,
+                                     const Value *Val,
+                                     ArrayRef<Register> VRegs,
+                                     FunctionLoweringInfo &FLI,
+                                     Register SwiftErrorVReg) const {
+  MachineFunction &MF = MIRBuilder.getMF();
+  const Function &F = MF.getFunction();
+  if (F.hasFnAttribute("interrupt"))
+    return false;
+
+  auto MIB = MIRBuilder.buildInstrNoInsert(M65832::RTS);
+
+  if (Val && !VRegs.empty()) {
+    const M65832TargetLowering &TLI = *getTLI<M65832TargetLowering>();
+    const DataLayout &DL = MF.getDataLayout();
+    MachineRegisterInfo &MRI = MF.getRegInfo();
+
+    ArgInfo OrigRetInfo(VRegs, Val->getType(), 0);
+    setArgFlags(OrigRetInfo, AttributeList::ReturnIndex, DL, F);
+
+    SmallVector<ArgInfo, 4> SplitRetInfos;
+    splitToValueTypes(OrigRetInfo, SplitRetInfos, DL, F.getCallingConv());
+
+    OutgoingValueAssigner Assigner(
+        TLI.getCCAssignFn(F.getCallingConv(), /*Return=*/true));
+    M65832OutgoingValueHandler Handler(MIRBuilder, MRI, MIB);
+    if (!determineAndHandleAssignments(Handler, Assigner, SplitRetInfos,
+                                       MIRBuilder, F.getCallingConv(),
+                                       F.isVarArg()))
+      return false;
+  }
+
+  MIRBuilder.insertInstr(MIB);
+  return true;
+}
+
+bool M65832CallLowering::lowerFormalArguments(
+    MachineIRBuilder &MIRBuilder, const Function &F,
+    ArrayRef<ArrayRef<Register>> VRegs, FunctionLoweringInfo &FLI) const {
+  const M65832TargetLowering &TLI = *getTLI<M65832TargetLowering>();
+
+  // The window shift, the RTI epilogue and the va_start slot are only set
+  // up by LowerFormalArguments
+  if (F.isVarArg() || F.hasFnAttribute("interrupt") || TLI.mayUseRegWindow(F))
+    return false;
+
+  MachineFunction &MF = MIRBuilder.getMF();
+  MachineRegisterInfo &MRI = MF.getRegInfo();
+  const DataLayout &DL = MF.getDataLayout();
+
+  SmallVector<ArgInfo, 8> SplitArgInfos;
+  unsigned Index = 0;
+  for (const Argument &Arg : F.args()) {
+    if (Arg.hasByValAttr())
+      return false;
+
+    ArgInfo AInfo(VRegs[Index], Arg.getType(), Index);
+    setArgFlags(AInfo, Index + AttributeList::FirstArgIndex, DL, F);
+    splitToValueTypes(AInfo, SplitArgInfos, DL, F.getCallingConv());
+    ++Index;
+  }
+
+  IncomingValueAssigner Assigner(
+      TLI.getCCAssignFn(F.getCallingConv(), /*Return=*/false));
+  M65832FormalArgHandler Handler(MIRBuilder, MRI);
+  if (!determineAndHandleAssignments(Handler, Assigner, SplitArgInfos,
+                                     MIRBuilder, F.getCallingConv(),
+                                     F.isVarArg()))
+    return false;
+
+  MF.getInfo<M65832MachineFunctionInfo>()->setArgumentStackSize(
+      Assigner.StackSize);
+  return true;
+}
+
+bool M65832CallLowering::lowerCall(MachineIRBuilder &MIRBuilder,
+                                   CallLoweringInfo &Info) const {
+  if (Info.IsMustTailCall || Info.IsVarArg)
+    return false;
+
+  MachineFunction &MF = MIRBuilder.getMF();
+  const DataLayout &DL = MF.getDataLayout();
+  MachineRegisterInfo &MRI = MF.getRegInfo();
+  const M65832Subtarget &STI = MF.getSubtarget<M65832Subtarget>();
+  const M65832TargetLowering &TLI = *getTLI<M65832TargetLowering>();
+  const M65832InstrInfo &TII = *STI.getInstrInfo();
+  const M65832RegisterInfo &TRI = *STI.getRegisterInfo();
+
+  // A -fPIC direct call goes through the callee's PC-relative address,
+  // which SelectionDAG sets up
+  if (!Info.Callee.isReg() && MF.getTarget().isPositionIndependent())
+    return false;
+
+  SmallVector<ArgInfo, 8> SplitArgInfos;
+  for (const ArgInfo &AInfo : Info.OrigArgs) {
+    if (AInfo.Flags[0].isByVal())
+      return false;
+    splitToValueTypes(AInfo, SplitArgInfos, DL, Info.CallConv);
+  }
+
+  SmallVector<ArgInfo, 4> SplitRetInfos;
+  if (!Info.OrigRet.Ty->isVoidTy())
+    splitToValueTypes(Info.OrigRet, SplitRetInfos, DL, Info.CallConv);
+
+  auto CallSeqStart = MIRBuilder.buildInstr(TII.getCallFrameSetupOpcode());
+
+  bool IsIndirect = Info.Callee.isReg();
+  auto MIB = MIRBuilder.buildInstrNoInsert(IsIndirect ? M65832::JSR_IND
+                                                      : M65832::JSR);
+  MIB.add(Info.Callee);
+  MIB.addRegMask(TRI.getCallPreservedMask(MF, Info.CallConv));
+
+  OutgoingValueAssigner ArgAssigner(
+      TLI.getCCAssignFn(Info.CallConv, /*Return=*/false));
+  M65832OutgoingValueHandler ArgHandler(MIRBuilder, MRI, MIB);
+  if (!determineAndHandleAssignments(ArgHandler, ArgAssigner, SplitArgInfos,
+                                     MIRBuilder, Info.CallConv,
+                                     Info.IsVarArg))
+    return false;
+
+  MIRBuilder.insertInstr(MIB);
+
+  if (IsIndirect)
+    constrainOperandRegClass(MF, TRI, MRI, TII, *STI.getRegBankInfo(), *MIB,
+                             MIB->getDesc(), MIB->getOperand(0), 0);
+
+  // JSR pushes the return address into the call frame, so it is never
+  // smaller than 4 bytes (see LowerCall)
+  unsigned CallFrameSize = std::max<unsigned>(ArgAssigner.StackSize, 4);
+  CallSeqStart.addImm(CallFrameSize).addImm(0);
+  MIRBuilder.buildInstr(TII.getCallFrameDestroyOpcode())
+      .addImm(CallFrameSize)
+      .addImm(0);
+
+  if (!SplitRetInfos.empty()) {
+    IncomingValueAssigner RetAssigner(
+        TLI.getCCAssignFn(Info.CallConv, /*Return=*/true));
+    M65832CallReturnHandler RetHandler(MIRBuilder, MRI, MIB);
+    if (!determineAndHandleAssignments(RetHandler, RetAssigner, SplitRetInfos,
+                                       MIRBuilder, Info.CallConv,
+                                       Info.IsVarArg))
+      return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,44 @@
+//===-- M65832CallLowering.h - Call lowering --------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file describes how to lower LLVM calls to machine code calls.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_M65832_GISEL_M65832CALLLOWERING_H
+#define LLVM_LIB_TARGET_M65832_GISEL_M65832CALLLOWERING_H
+
+#include "llvm/CodeGen/GlobalISel/CallLowering.h"
+
+namespace llvm {
+
+class M65832TargetLowering;
+
+/// Lowers arguments, returns and calls with the same CC_M65832/RetCC_M65832
+/// assignment as the SelectionDAG port. Functions that need more than the
+/// plain convention (interrupt handlers, register windows, variadic or byval
+/// arguments, tail calls) are left to SelectionDAG.
+class M65832CallLowering : public CallLowering {
+public:
+  M65832CallLowering(const M65832TargetLowering &TLI);
+
+  bool lowerReturn(MachineIRBuilder &MIRBuilder, const Value *Val,
+                   ArrayRef<Register> VRegs, FunctionLoweringInfo &FLI,
+                   Register SwiftErrorVReg) const override;
+
+  bool lowerFormalArguments(MachineIRBuilder &MIRBuilder, const Function &F,
+                            ArrayRef<ArrayRef<Register>> VRegs,
+                            FunctionLoweringInfo &FLI) const override;
+
+  bool lowerCall(MachineIRBuilder &MIRBuilder,
+                 CallLoweringInfo &Info) const override;
+};
+
+} // end namespace llvm
+
+#endif // LLVM_LIB_TARGET_M65832_GISEL_M65832CALLLOWERING_H
@@ -0,0 +1,466 @@
+//===-- M65832InstructionSelector.cpp ---------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the targeting of the InstructionSelector class for
+// M65832. The ALU patterns are imported from the SelectionDAG ones; memory
+// accesses, addresses, compares and branches go through the same pseudos
+// the DAG selector builds, since their patterns use complex operands.
+//
+//===----------------------------------------------------------------------===//
+
+#include "M65832RegisterBankInfo.h"
+#include "M65832Subtarget.h"
+#include "M65832TargetMachine.h"
+#include "llvm/CodeGen/Analysis.h"
+#include "llvm/CodeGen/GlobalISel/GIMatchTableExecutorImpl.h"
+#include "llvm/CodeGen/GlobalISel/GenericMachineInstrs.h"
+#include "llvm/CodeGen/GlobalISel/InstructionSelector.h"
+#include "llvm/CodeGen/GlobalISel/MachineIRBuilder.h"
+#include "llvm/CodeGen/GlobalISel/Utils.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/Support/Debug.h"
+
+#define DEBUG_TYPE "m65832-isel"
+
+using namespace llvm;
+
+#define GET_GLOBALISEL_PREDICATE_BITSET
+#include "M65832GenGlobalISel.inc"
+#undef GET_GLOBALISEL_PREDICATE_BITSET
+
+namespace {
+
+class M65832InstructionSelector : public InstructionSelector {
+public:
+  M65832InstructionSelector(const M65832TargetMachine &TM,
+                            const M65832Subtarget &STI,
+                            const M65832RegisterBankInfo &RBI);
+
+  bool select(MachineInstr &I) override;
+  static const char *getName() { return DEBUG_TYPE; }
+
+private:
+  bool selectImpl(MachineInstr &I, CodeGenCoverage &CoverageInfo) const;
+
+  const TargetRegisterClass *getRegClass(Register Reg,
+                                         MachineRegisterInfo &MRI) const;
+  bool selectCopy(MachineInstr &I, MachineRegisterInfo &MRI) const;
+  bool selectLoadStore(MachineInstr &I, MachineRegisterInfo &MRI) const;
+  bool selectPtrAdd(MachineInstr &I, MachineRegisterInfo &MRI) const;
+  bool selectICmp(MachineInstr &I, MachineRegisterInfo &MRI) const;
+  bool selectBrCond(MachineInstr &I, MachineRegisterInfo &MRI) const;
+  bool selectExt(MachineInstr &I, MachineRegisterInfo &MRI) const;
+
+  const M65832Subtarget &STI;
+  const M65832InstrInfo &TII;
+  const M65832RegisterInfo &TRI;
+  const M65832RegisterBankInfo &RBI;
+
+#define GET_GLOBALISEL_PREDICATES_DECL
+#include "M65832GenGlobalISel.inc"
+#undef GET_GLOBALISEL_PREDICATES_DECL
+
+#define GET_GLOBALISEL_TEMPORARIES_DECL
+#include "M65832GenGlobalISel.inc"
+#undef GET_GLOBALISEL_TEMPORARIES_DECL
+};
+
+} // end anonymous namespace
+
+#define GET_GLOBALISEL_IMPL
+#include "M65832GenGlobalISel.inc"
+#undef GET_GLOBALISEL_IMPL
+
+M65832InstructionSelector::M65832InstructionSelector(
+    const M65832TargetMachine &TM, const M65832Subtarget &STI,
+    const M65832RegisterBankInfo &RBI)
+    : STI(STI), TII(*STI.getInstrInfo()), TRI(*STI.getRegisterInfo()),
+      RBI(RBI),
+#define GET_GLOBALISEL_PREDICATES_INIT
+#include "M65832GenGlobalISel.inc"
+#undef GET_GLOBALISEL_PREDICATES_INIT
+#define GET_GLOBALISEL_TEMPORARIES_INIT
+#include "M65832GenGlobalISel.inc"
+#undef GET_GLOBALISEL_TEMPORARIES_INIT
+{
+}
+
+/// The class a value on Reg's bank is allocated from. A/X/Y bank values
+/// are only ever copies of the physical registers.
+const TargetRegisterClass *
+M65832InstructionSelector::getRegClass(Register Reg,
+                                       MachineRegisterInfo &MRI) const {
+  const RegisterBank *RB = RBI.getRegBank(Reg, MRI, TRI);
+  if (!RB)
+    return nullptr;
+  switch (RB->getID()) {
+  case M65832::GPRRegBankID:
+    return &M65832::GPRRegClass;
+  case M65832::FPRRegBankID:
+    return MRI.getType(Reg).getSizeInBits() == 64 ? &M65832::FPR64RegClass
+                                                  : &M65832::FPR32RegClass;
+  case M65832::AccIdxRegBankID:
+    return &M65832::AXYRegClass;
+  }
+  return nullptr;
+}
+
+bool M65832InstructionSelector::selectCopy(MachineInstr &I,
+                                           MachineRegisterInfo &MRI) const {
+  for (MachineOperand &MO : I.explicit_operands()) {
+    Register Reg = MO.getReg();
+    if (Reg.isPhysical() || MRI.getRegClassOrNull(Reg))
+      continue;
+    const TargetRegisterClass *RC = getRegClass(Reg, MRI);
+    if (!RC || !RBI.constrainGenericRegister(Reg, *RC, MRI))
+      return false;
+  }
+  return true;
+}
+
+/// Loads and stores take the same base + offset operands ADDRri gives the
+/// DAG patterns: a frame index (so eliminateFrameIndex can make the access
+/// B-relative) or a register, plus a constant folded from a G_PTR_ADD.
+bool M65832InstructionSelector::selectLoadStore(
+    MachineInstr &I, MachineRegisterInfo &MRI) const {
+  GLoadStore &LdSt = cast<GLoadStore>(I);
+  Register ValReg = LdSt.getReg(0);
+  unsigned MemSize = LdSt.getMemSizeInBits().getValue();
+  bool IsStore = isa<GStore>(LdSt);
+  bool IsFP = RBI.getRegBank(ValReg, MRI, TRI)->getID() == M65832::FPRRegBankID;
+
+  unsigned Opc;
+  if (IsFP) {
+    if (MemSize == 64)
+      Opc = IsStore ? M65832::STF64 : M65832::LDF64;
+    else
+      Opc = IsStore ? M65832::STF32 : M65832::LDF32;
+  } else {
+    switch (MemSize) {
+    case 8:
+      Opc = IsStore ? M65832::STORE8 : M65832::LOAD8;
+      break;
+    case 16:
+      Opc = IsStore ? M65832::STORE16 : M65832::LOAD16;
+      break;
+    case 32:
+      Opc = IsStore ? M65832::STORE32 : M65832::LOAD32;
+      break;
+    default:
+      return false;
+    }
+  }
+
+  Register Ptr = LdSt.getPointerReg();
+  MachineInstr *PtrDef = getDefIgnoringCopies(Ptr, MRI);
+  int64_t Offset = 0;
+  if (PtrDef->getOpcode() == TargetOpcode::G_PTR_ADD) {
+    if (auto Cst = getIConstantVRegSExtVal(PtrDef->getOperand(2).getReg(),
+                                           MRI)) {
+      Offset = *Cst;
+      Ptr = PtrDef->getOperand(1).getReg();
+      PtrDef = getDefIgnoringCopies(Ptr, MRI);
+    }
+  }
+
+  // A sign-extending load is LD.B/LD.W into a temporary and a SEXT8/SEXT16
+  bool IsSExt = isa<GSExtLoad>(LdSt);
+  Register DstReg = ValReg;
+  if (IsSExt)
+    DstReg = MRI.createVirtualRegister(&M65832::GPRRegClass);
+
+  MachineIRBuilder B(I);
+  auto MIB = IsStore ? B.buildInstr(Opc).addUse(ValReg)
+                     : B.buildInstr(Opc).addDef(DstReg);
+  if (PtrDef->getOpcode() == TargetOpcode::G_FRAME_INDEX)
+    MIB.addFrameIndex(PtrDef->getOperand(1).getIndex());
+  else
+    MIB.addUse(Ptr);
+  MIB.addImm(Offset).cloneMemRefs(I);
+  if (!constrainSelectedInstRegOperands(*MIB, TII, TRI, RBI))
+    return false;
+
+  if (IsSExt) {
+    auto Ext = B.buildInstr(MemSize == 8 ? M65832::SEXT8 : M65832::SEXT16)
+                   .addDef(ValReg)
+                   .addUse(DstReg);
+    if (!constrainSelectedInstRegOperands(*Ext, TII, TRI, RBI))
+      return false;
+  }
+
+  I.eraseFromParent();
+  return true;
+}
+
+/// &slot + imm folds into LEA_FI, as the DAG selector does for ADD/OR of a
+/// frame index
+bool M65832InstructionSelector::selectPtrAdd(MachineInstr &I,
+                                             MachineRegisterInfo &MRI) const {
+  Register DstReg = I.getOperand(0).getReg();
+  Register BaseReg = I.getOperand(1).getReg();
+  Register OffReg = I.getOperand(2).getReg();
+  std::optional<int64_t> Cst = getIConstantVRegSExtVal(OffReg, MRI);
+  MachineInstr *BaseDef = getDefIgnoringCopies(BaseReg, MRI);
+
+  MachineIRBuilder B(I);
+  MachineInstrBuilder MIB;
+  if (Cst && BaseDef->getOpcode() == TargetOpcode::G_FRAME_INDEX)
+    MIB = B.buildInstr(M65832::LEA_FI)
+              .addDef(DstReg)
+              .addFrameIndex(BaseDef->getOperand(1).getIndex())
+              .addImm(*Cst);
+  else if (Cst)
+    MIB = B.buildInstr(M65832::ADDI_GPR)
+              .addDef(DstReg)
+              .addUse(BaseReg)
+              .addImm(*Cst);
+  else
+    MIB = B.buildInstr(M65832::ADD_GPR)
+              .addDef(DstReg)
+              .addUse(BaseReg)
+              .addUse(OffReg);
+
+  I.eraseFromParent();
+  return constrainSelectedInstRegOperands(*MIB, TII, TRI, RBI);
+}
+
+/// SETGT/SETLE/SETUGT/SETULE swap their operands, as canonicalizeIntCC does
+/// before the DAG builds BR_CC_CMP and SELECT_CC
+static ISD::CondCode canonicalizeICmp(CmpInst::Predicate Pred, Register &LHS,
+                                      Register &RHS) {
+  switch (Pred) {
+  case CmpInst::ICMP_SGT:
+  case CmpInst::ICMP_SLE:
+  case CmpInst::ICMP_UGT:
+  case CmpInst::ICMP_ULE:
+    std::swap(LHS, RHS);
+    Pred = CmpInst::getSwappedPredicate(Pred);
+    break;
+  default:
+    break;
+  }
+  return getICmpCondCode(Pred);
+}
+
+/// An i1 result used as a value: SELECT_CC_PSEUDO between 1 and 0
+bool M65832InstructionSelector::selectICmp(MachineInstr &I,
+                                           MachineRegisterInfo &MRI) const {
+  GICmp &Cmp = cast<GICmp>(I);
+  Register LHS = Cmp.getLHSReg();
+  Register RHS = Cmp.getRHSReg();
+  ISD::CondCode CC = canonicalizeICmp(Cmp.getCond(), LHS, RHS);
+
+  MachineIRBuilder B(I);
+  Register One = MRI.createVirtualRegister(&M65832::GPRRegClass);
+  Register Zero = MRI.createVirtualRegister(&M65832::GPRRegClass);
+  B.buildInstr(M65832::LI).addDef(One).addImm(1);
+  B.buildInstr(M65832::LI).addDef(Zero).addImm(0);
+  auto MIB = B.buildInstr(M65832::SELECT_CC_PSEUDO)
+                 .addDef(Cmp.getReg(0))
+                 .addUse(LHS)
+                 .addUse(RHS)
+                 .addUse(One)
+                 .addUse(Zero)
+                 .addImm(CC);
+
+  I.eraseFromParent();
+  return constrainSelectedInstRegOperands(*MIB, TII, TRI, RBI);
+}
+
+/// A compare used only by the branch becomes the fused BR_CC_CMP_PSEUDO, so
+/// nothing can be scheduled between the CMP and the Bcc; any other
+/// condition is tested against zero.
+bool M65832InstructionSelector::selectBrCond(MachineInstr &I,
+                                             MachineRegisterInfo &MRI) const {
+  Register CondReg = I.getOperand(0).getReg();
+  MachineBasicBlock *Target = I.getOperand(1).getMBB();
+  MachineInstr *CondDef = MRI.getVRegDef(CondReg);
+
+  MachineIRBuilder B(I);
+  MachineInstrBuilder MIB;
+  if (CondDef && CondDef->getOpcode() == TargetOpcode::G_ICMP &&
+      CondDef->getParent() == I.getParent() &&
+      MRI.hasOneNonDBGUse(CondReg)) {
+    GICmp &Cmp = cast<GICmp>(*CondDef);
+    Register LHS = Cmp.getLHSReg();
+    Register RHS = Cmp.getRHSReg();
+    ISD::CondCode CC = canonicalizeICmp(Cmp.getCond(), LHS, RHS);
+    MIB = B.buildInstr(M65832::BR_CC_CMP_PSEUDO)
+              .addUse(LHS)
+              .addUse(RHS)
+              .addImm(CC)
+              .addMBB(Target);
+  } else {
+    MIB = B.buildInstr(M65832::BR_CC_CMP_IMM_PSEUDO)
+              .addUse(CondReg)
+              .addImm(0)
+              .addImm(ISD::SETNE)
+              .addMBB(Target);
+  }
+
+  I.eraseFromParent();
+  return constrainSelectedInstRegOperands(*MIB, TII, TRI, RBI);
+}
+
+bool M65832InstructionSelector::selectExt(MachineInstr &I,
+                                          MachineRegisterInfo &MRI) const {
+  Register DstReg = I.getOperand(0).getReg();
+  Register SrcReg = I.getOperand(1).getReg();
+  unsigned SrcSize = MRI.getType(SrcReg).getSizeInBits();
+  bool IsSigned = I.getOpcode() == TargetOpcode::G_SEXT;
+
+  MachineIRBuilder B(I);
+  MachineInstrBuilder MIB;
+  switch (SrcSize) {
+  case 1:
+    // A sign-extended i1 is never left by the legalizer's artifact combines
+    if (IsSigned)
+      return false;
+    MIB = B.buildInstr(M65832::ANDI_GPR).addDef(DstReg).addUse(SrcReg).addImm(
+        1);
+    break;
+  case 8:
+    MIB = B.buildInstr(IsSigned ? M65832::SEXT8 : M65832::ZEXT8)
+              .addDef(DstReg)
+              .addUse(SrcReg);
+    break;
+  case 16:
+    MIB = B.buildInstr(IsSigned ? M65832::SEXT16 : M65832::ZEXT16)
+              .addDef(DstReg)
+              .addUse(SrcReg);
+    break;
+  default:
+    return false;
+  }
+
+  I.eraseFromParent();
+  return constrainSelectedInstRegOperands(*MIB, TII, TRI, RBI);
+}
+
+bool M65832InstructionSelector::select(MachineInstr &I) {
+  MachineRegisterInfo &MRI = I.getMF()->getRegInfo();
+  unsigned Opc = I.getOpcode();
+
+  if (!isPreISelGenericOpcode(Opc)) {
+    if (I.isCopy())
+      return selectCopy(I, MRI);
+    return true;
+  }
+
+  if (selectImpl(I, *CoverageInfo))
+    return true;
+
+  MachineIRBuilder B(I);
+  switch (Opc) {
+  case TargetOpcode::G_ANYEXT:
+  case TargetOpcode::G_TRUNC:
+  case TargetOpcode::G_PTRTOINT:
+  case TargetOpcode::G_INTTOPTR:
+  case TargetOpcode::G_FREEZE:
+    // All of these are the same 32 bits in the same DP register
+    I.setDesc(TII.get(TargetOpcode::COPY));
+    return selectCopy(I, MRI);
+
+  case TargetOpcode::G_IMPLICIT_DEF:
+  case TargetOpcode::G_PHI: {
+    I.setDesc(TII.get(Opc == TargetOpcode::G_PHI ? TargetOpcode::PHI
+                                                 : TargetOpcode::IMPLICIT_DEF));
+    Register DstReg = I.getOperand(0).getReg();
+    const TargetRegisterClass *RC = getRegClass(DstReg, MRI);
+    return RC && RBI.constrainGenericRegister(DstReg, *RC, MRI);
+  }
+
+  case TargetOpcode::G_CONSTANT: {
+    const MachineOperand &Imm = I.getOperand(1);
+    int64_t Val = Imm.isCImm() ? Imm.getCImm()->getSExtValue() : Imm.getImm();
+    auto MIB =
+        B.buildInstr(M65832::LI).addDef(I.getOperand(0).getReg()).addImm(Val);
+    I.eraseFromParent();
+    return constrainSelectedInstRegOperands(*MIB, TII, TRI, RBI);
+  }
+
+  case TargetOpcode::G_FRAME_INDEX: {
+    auto MIB = B.buildInstr(M65832::LEA_FI)
+                   .addDef(I.getOperand(0).getReg())
+                   .addFrameIndex(I.getOperand(1).getIndex())
+                   .addImm(0);
+    I.eraseFromParent();
+    return constrainSelectedInstRegOperands(*MIB, TII, TRI, RBI);
+  }
+
+  case TargetOpcode::G_GLOBAL_VALUE: {
+    const GlobalValue *GV = I.getOperand(1).getGlobal();
+    if (GV->isThreadLocal()) {
+      if (I.getMF()->getTarget().useEmulatedTLS())
+        return false;
+      // R56 + %tprel(sym), as in SelectionDAG
+      auto MIB = B.buildInstr(M65832::LA_TPREL)
+                     .addDef(I.getOperand(0).getReg())
+                     .addGlobalAddress(GV, I.getOperand(1).getOffset(),
+                                       M65832II::MO_TPREL);
+      I.eraseFromParent();
+      return constrainSelectedInstRegOperands(*MIB, TII, TRI, RBI);
+    }
+    unsigned Opc = I.getMF()->getTarget().isPositionIndependent()
+                       ? M65832::LA_PCREL
+                       : M65832::LA;
+    auto MIB = B.buildInstr(Opc)
+                   .addDef(I.getOperand(0).getReg())
+                   .addGlobalAddress(GV, I.getOperand(1).getOffset());
+    I.eraseFromParent();
+    return constrainSelectedInstRegOperands(*MIB, TII, TRI, RBI);
+  }
+
+  case TargetOpcode::G_PTR_ADD:
+    return selectPtrAdd(I, MRI);
+
+  case TargetOpcode::G_ZEXT:
+  case TargetOpcode::G_SEXT:
+    return selectExt(I, MRI);
+
+  case TargetOpcode::G_LOAD:
+  case TargetOpcode::G_STORE:
+  case TargetOpcode::G_ZEXTLOAD:
+  case TargetOpcode::G_SEXTLOAD:
+    return selectLoadStore(I, MRI);
+
+  case TargetOpcode::G_ICMP:
+    return selectICmp(I, MRI);
+
+  case TargetOpcode::G_SELECT: {
+    auto MIB = B.buildInstr(M65832::SELECT_CC_IMM_PSEUDO)
+                   .addDef(I.getOperand(0).getReg())
+                   .addUse(I.getOperand(1).getReg())
+                   .addImm(0)
+                   .addUse(I.getOperand(2).getReg())
+                   .addUse(I.getOperand(3).getReg())
+                   .addImm(ISD::SETNE);
+    I.eraseFromParent();
+    return constrainSelectedInstRegOperands(*MIB, TII, TRI, RBI);
+  }
+
+  case TargetOpcode::G_BRCOND:
+    return selectBrCond(I, MRI);
+
+  case TargetOpcode::G_BR:
+    I.setDesc(TII.get(M65832::BRA));
+    return true;
+
+  default:
+    return false;
+  }
+}
+
+namespace llvm {
+InstructionSelector *
+createM65832InstructionSelector(const M65832TargetMachine &TM,
+                                const M65832Subtarget &Subtarget,
+                                const M65832RegisterBankInfo &RBI) {
+  return new M65832InstructionSelector(TM, Subtarget, RBI);
+}
+} // end namespace llvm
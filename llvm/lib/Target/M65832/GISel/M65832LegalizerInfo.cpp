@@ -0,0 +1,111 @@
+//===-- M65832LegalizerInfo.cpp ---------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the targeting of the MachineLegalizer class for M65832.
+// Everything is done in 32 bits, the width of A and of a DP register; i8 and
+// i16 arithmetic is widened, as the SelectionDAG port does by promoting.
+// Operations left without a rule make the function fall back to
+// SelectionDAG (-global-isel-abort=2).
+//
+//===----------------------------------------------------------------------===//
+
+#include "M65832LegalizerInfo.h"
+#include "M65832Subtarget.h"
+#include "llvm/CodeGen/GlobalISel/LegalizerHelper.h"
+#include "llvm/CodeGen/TargetOpcodes.h"
+
+using namespace llvm;
+
+M65832LegalizerInfo::M65832LegalizerInfo(const M65832Subtarget &ST) {
+  using namespace TargetOpcode;
+  const LLT s1 = LLT::scalar(1);
+  const LLT s8 = LLT::scalar(8);
+  const LLT s16 = LLT::scalar(16);
+  const LLT s32 = LLT::scalar(32);
+  const LLT s64 = LLT::scalar(64);
+  const LLT p0 = LLT::pointer(0, 32);
+
+  getActionDefinitionsBuilder({G_IMPLICIT_DEF, G_PHI, G_FREEZE})
+      .legalFor({s32, p0})
+      .clampScalar(0, s32, s32);
+
+  getActionDefinitionsBuilder({G_ADD, G_SUB, G_AND, G_OR, G_XOR})
+      .legalFor({s32})
+      .clampScalar(0, s32, s32);
+
+  if (ST.hasHWMul())
+    getActionDefinitionsBuilder(G_MUL).legalFor({s32}).clampScalar(0, s32,
+                                                                   s32);
+  else
+    getActionDefinitionsBuilder(G_MUL).libcallFor({s32}).clampScalar(0, s32,
+                                                                     s32);
+
+  getActionDefinitionsBuilder({G_SDIV, G_UDIV, G_SREM, G_UREM})
+      .libcallFor({s32})
+      .clampScalar(0, s32, s32);
+
+  getActionDefinitionsBuilder(G_SEXT_INREG).legalFor({s32}).lower();
+
+  getActionDefinitionsBuilder({G_ZEXT, G_SEXT, G_ANYEXT})
+      .legalFor({{s32, s8}, {s32, s16}, {s32, s1}})
+      .maxScalar(0, s32);
+  getActionDefinitionsBuilder(G_TRUNC).alwaysLegal();
+
+  getActionDefinitionsBuilder(G_CONSTANT)
+      .legalFor({s32, p0})
+      .clampScalar(0, s32, s32);
+
+  getActionDefinitionsBuilder(G_ICMP)
+      .legalFor({{s32, s32}, {s32, p0}})
+      .clampScalar(0, s32, s32)
+      .clampScalar(1, s32, s32);
+
+  getActionDefinitionsBuilder(G_SELECT)
+      .legalFor({{s32, s32}, {p0, s32}})
+      .clampScalar(0, s32, s32)
+      .clampScalar(1, s32, s32);
+
+  getActionDefinitionsBuilder(G_BRCOND).legalFor({s32}).clampScalar(0, s32,
+                                                                    s32);
+
+  getActionDefinitionsBuilder({G_FRAME_INDEX, G_GLOBAL_VALUE}).legalFor({p0});
+
+  getActionDefinitionsBuilder(G_PTR_ADD).legalFor({{p0, s32}});
+
+  getActionDefinitionsBuilder(G_PTRTOINT).legalFor({{s32, p0}});
+  getActionDefinitionsBuilder(G_INTTOPTR).legalFor({{p0, s32}});
+
+  // LD.B and LD.W zero-extend, so extending loads of i8/i16 are legal;
+  // sign-extending ones add a SEXT8/SEXT16
+  auto &LoadStoreActions = getActionDefinitionsBuilder({G_LOAD, G_STORE});
+  if (ST.hasFPU())
+    LoadStoreActions.legalForTypesWithMemDesc({{s32, p0, s8, 1},
+                                              {s32, p0, s16, 2},
+                                              {s32, p0, s32, 4},
+                                              {p0, p0, p0, 4},
+                                              {s64, p0, s64, 4}});
+  else
+    LoadStoreActions.legalForTypesWithMemDesc({{s32, p0, s8, 1},
+                                              {s32, p0, s16, 2},
+                                              {s32, p0, s32, 4},
+                                              {p0, p0, p0, 4}});
+  LoadStoreActions.clampScalar(0, s32, s32).lower();
+
+  getActionDefinitionsBuilder({G_ZEXTLOAD, G_SEXTLOAD})
+      .legalForTypesWithMemDesc({{s32, p0, s8, 1}, {s32, p0, s16, 2}})
+      .lower();
+
+  if (ST.hasFPU())
+    getActionDefinitionsBuilder({G_FADD, G_FSUB, G_FMUL, G_FDIV})
+        .legalFor({s32, s64});
+  else
+    getActionDefinitionsBuilder({G_FADD, G_FSUB, G_FMUL, G_FDIV})
+        .libcallFor({s32});
+
+  getLegacyLegalizerInfo().computeTables();
+}
@@ -0,0 +1,29 @@
+//===-- M65832LegalizerInfo.h -----------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the targeting of the MachineLegalizer class for M65832.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_M65832_GISEL_M65832LEGALIZERINFO_H
+#define LLVM_LIB_TARGET_M65832_GISEL_M65832LEGALIZERINFO_H
+
+#include "llvm/CodeGen/GlobalISel/LegalizerInfo.h"
+
+namespace llvm {
+
+class M65832Subtarget;
+
+class M65832LegalizerInfo : public LegalizerInfo {
+public:
+  M65832LegalizerInfo(const M65832Subtarget &ST);
+};
+
+} // end namespace llvm
+
+#endif // LLVM_LIB_TARGET_M65832_GISEL_M65832LEGALIZERINFO_H
@@ -0,0 +1,143 @@
+//===-- M65832RegisterBankInfo.cpp ------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the targeting of the RegisterBankInfo class for M65832.
+//
+//===----------------------------------------------------------------------===//
+
+#include "M65832RegisterBankInfo.h"
+#include "MCTargetDesc/M65832MCTargetDesc.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/CodeGen/RegisterBank.h"
+#include "llvm/CodeGen/RegisterBankInfo.h"
+#include "llvm/CodeGen/TargetRegisterInfo.h"
+
+#define GET_TARGET_REGBANK_IMPL
+#include "M65832GenRegisterBank.inc"
+
+using namespace llvm;
+
+namespace llvm {
+namespace M65832 {
+
+const RegisterBankInfo::PartialMapping PartMappings[] = {
+    {0, 32, GPRRegBank},
+    {0, 32, FPRRegBank},
+    {0, 64, FPRRegBank},
+};
+
+enum PartialMappingIdx {
+  PMI_GPR = 0,
+  PMI_FPR32 = 1,
+  PMI_FPR64 = 2,
+};
+
+// Three copies of each so that a three-operand instruction can point at one
+// run of them
+const RegisterBankInfo::ValueMapping ValueMappings[] = {
+    // Invalid value mapping
+    {nullptr, 0},
+    {&PartMappings[PMI_GPR], 1},
+    {&PartMappings[PMI_GPR], 1},
+    {&PartMappings[PMI_GPR], 1},
+    {&PartMappings[PMI_FPR32], 1},
+    {&PartMappings[PMI_FPR32], 1},
+    {&PartMappings[PMI_FPR32], 1},
+    {&PartMappings[PMI_FPR64], 1},
+    {&PartMappings[PMI_FPR64], 1},
+    {&PartMappings[PMI_FPR64], 1},
+};
+
+enum ValueMappingIdx {
+  InvalidIdx = 0,
+  GPRIdx = 1,
+  FPR32Idx = 4,
+  FPR64Idx = 7,
+};
+
+} // end namespace M65832
+} // end namespace llvm
+
+M65832RegisterBankInfo::M65832RegisterBankInfo(const TargetRegisterInfo &TRI)
+    : M65832GenRegisterBankInfo() {}
+
+static bool isFPOpcode(unsigned Opc) {
+  switch (Opc) {
+  case TargetOpcode::G_FADD:
+  case TargetOpcode::G_FSUB:
+  case TargetOpcode::G_FMUL:
+  case TargetOpcode::G_FDIV:
+  case TargetOpcode::G_FNEG:
+  case TargetOpcode::G_FABS:
+  case TargetOpcode::G_FSQRT:
+  case TargetOpcode::G_FPEXT:
+  case TargetOpcode::G_FPTRUNC:
+    return true;
+  default:
+    return false;
+  }
+}
+
+static const RegisterBankInfo::ValueMapping *getValueMapping(unsigned Size,
+                                                             bool IsFP) {
+  if (!IsFP && Size <= 32)
+    return &M65832::ValueMappings[M65832::GPRIdx];
+  return &M65832::ValueMappings[Size == 64 ? M65832::FPR64Idx
+                                           : M65832::FPR32Idx];
+}
+
+const RegisterBankInfo::InstructionMapping &
+M65832RegisterBankInfo::getInstrMapping(const MachineInstr &MI) const {
+  unsigned Opc = MI.getOpcode();
+  const MachineRegisterInfo &MRI = MI.getMF()->getRegInfo();
+
+  // A value copied out of an argument register, A/X/Y or SP is wanted in
+  // the DP window (or the FPU), not on the bank of its source: a vreg left
+  // on the A/X/Y bank would tie one of them up until its last use.
+  if (MI.isCopy()) {
+    Register Dst = MI.getOperand(0).getReg();
+    Register Src = MI.getOperand(1).getReg();
+    if (Dst.isVirtual() && Src.isPhysical() &&
+        !MRI.getRegClassOrRegBank(Dst) && MRI.getType(Dst).isValid()) {
+      const TargetRegisterInfo &TRI = *MRI.getTargetRegisterInfo();
+      const RegisterBank *SrcBank = getRegBank(Src, MRI, TRI);
+      bool IsFP = SrcBank && SrcBank->getID() == M65832::FPRRegBankID;
+      return getInstructionMapping(
+          DefaultMappingID, /*Cost=*/1,
+          getOperandsMapping(
+              {getValueMapping(MRI.getType(Dst).getSizeInBits(), IsFP)}),
+          /*NumOperands=*/1);
+    }
+  }
+
+  if (!isPreISelGenericOpcode(Opc) || Opc == TargetOpcode::G_PHI) {
+    const InstructionMapping &Mapping = getInstrMappingImpl(MI);
+    if (Mapping.isValid())
+      return Mapping;
+  }
+
+  unsigned NumOperands = MI.getNumOperands();
+  bool IsFP = isFPOpcode(Opc);
+
+  // Whatever is left is integer or pointer work, which only the GPR bank
+  // can do. A 64-bit value can only be an FPU double; the legalizer splits
+  // 64-bit integers.
+  SmallVector<const ValueMapping *, 4> OpdsMapping(NumOperands);
+  for (unsigned Idx = 0; Idx < NumOperands; ++Idx) {
+    const MachineOperand &MO = MI.getOperand(Idx);
+    if (!MO.isReg() || !MO.getReg())
+      continue;
+    LLT Ty = MRI.getType(MO.getReg());
+    if (!Ty.isValid())
+      continue;
+    OpdsMapping[Idx] = getValueMapping(Ty.getSizeInBits(), IsFP);
+  }
+
+  return getInstructionMapping(DefaultMappingID, /*Cost=*/1,
+                               getOperandsMapping(OpdsMapping), NumOperands);
+}
@@ -0,0 +1,45 @@
+//===-- M65832RegisterBankInfo.h --------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the targeting of the RegisterBankInfo class for M65832.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_M65832_GISEL_M65832REGISTERBANKINFO_H
+#define LLVM_LIB_TARGET_M65832_GISEL_M65832REGISTERBANKINFO_H
+
+#include "llvm/CodeGen/RegisterBankInfo.h"
+
+#define GET_REGBANK_DECLARATIONS
+#include "M65832GenRegisterBank.inc"
+#undef GET_REGBANK_DECLARATIONS
+
+namespace llvm {
+
+class TargetRegisterInfo;
+
+class M65832GenRegisterBankInfo : public RegisterBankInfo {
+protected:
+#define GET_TARGET_REGBANK_CLASS
+#include "M65832GenRegisterBank.inc"
+#undef GET_TARGET_REGBANK_CLASS
+};
+
+/// Integers and pointers go to the GPR bank and floating point values to the
+/// FPR bank. The A/X/Y bank only ever holds physical registers.
+class M65832RegisterBankInfo final : public M65832GenRegisterBankInfo {
+public:
+  M65832RegisterBankInfo(const TargetRegisterInfo &TRI);
+
+  const InstructionMapping &
+  getInstrMapping(const MachineInstr &MI) const override;
+};
+
+} // end namespace llvm
+
+#endif // LLVM_LIB_TARGET_M65832_GISEL_M65832REGISTERBANKINFO_H
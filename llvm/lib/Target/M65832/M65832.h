@@ -21,7 +21,15 @@
 namespace llvm {
 
 class M65832TargetMachine;
+class M65832RegisterBankInfo;
+class M65832Subtarget;
+class FastISel;
+class FunctionLoweringInfo;
 class FunctionPass;
+class InstructionSelector;
+class LibcallLoweringInfo;
+class PassRegistry;
+class TargetLibraryInfo;
 
 // Condition codes for branches
 namespace M65832CC {
@@ -44,15 +52,44 @@ namespace M65832CC {
   };
 } // namespace M65832CC
 
+// Target operand flags
+namespace M65832II {
+  enum TOF {
+    MO_NO_FLAG,
+    // Offset of a small-data symbol from the global pointer (R28)
+    MO_GPREL,
+    // Offset of a data-bank symbol from __data_bank_base (-mcmodel=bank)
+    MO_BANKREL,
+    // 32-bit address of a symbol the linker may reach B-relative (-mrelax)
+    MO_BANKABS,
+    // 32-bit address of a tail-call target the linker may reach with BRA
+    // (-mrelax)
+    MO_JMPABS,
+    // Offset of a .dpdata symbol in the direct page
+    MO_DP,
+    // Offset of a constant-pool entry from the function's first entry
+    MO_POOLREL,
+    // Offset of a TLS symbol from the thread pointer (R56)
+    MO_TPREL,
+  };
+} // namespace M65832II
+
 namespace M65832ISD {
   enum NodeType : unsigned {
     FIRST_NUMBER = ISD::BUILTIN_OP_END,
     
     // Return with flag
     RET_FLAG,
+
+    // Return from interrupt (RTI)
+    RETI_FLAG,
     
     // Subroutine call
     CALL,
+
+    // Tail call: epilogue then JMP to the callee, whose RTS returns to our
+    // caller
+    TAIL_CALL,
     
     // Compare (sets flags) - integer
     CMP,
@@ -65,6 +102,13 @@ namespace M65832ISD {
 
     // Fused compare-and-branch (single terminator)
     BR_CC_CMP,
+
+    // The same on the low 8/16 bits only (CMP.B/CMP.W)
+    BR_CC_CMP8,
+    BR_CC_CMP16,
+
+    // Fused FP compare-and-branch (chain, lhs, rhs, cc, dest)
+    BR_CC_FCMP,
     
     // Select on condition code (integer - includes LHS/RHS for CMP)
     SELECT_CC,
@@ -72,11 +116,27 @@ namespace M65832ISD {
     // Select on condition code (integer comparison, any result type)
     SELECT_CC_MIXED,
     
-    // Select on condition code (FP - uses glue from FCMP)
+    // Select on condition code (FP comparison - includes LHS/RHS for FCMP)
     SELECT_CC_FP,
+
+    // Branchless integer select (lhs, rhs, trueVal, falseVal, cc) built
+    // from a carry-derived all-ones/all-zeros mask
+    SELECT_CC_MASK,
+
+    // Branchless (lhs cc rhs) ? val : 0 (lhs, rhs, val, cc)
+    SELECT_CC_AND,
+
+    // Branchless 0/1 integer compare (lhs, rhs, cc) read from the carry
+    SETCC,
     
     // Global/constant address wrapper
     WRAPPER,
+
+    // The same address computed from the PC (-fPIC)
+    PCREL_WRAPPER,
+
+    // Address of a thread-local symbol: R56 + %tprel(sym)
+    TPREL_WRAPPER,
     
     // Multiply returning high:low
     SMUL_LOHI,
@@ -85,11 +145,56 @@ namespace M65832ISD {
     // Divide with remainder
     SDIVREM,
     UDIVREM,
+
+    // Multiply without hardware MUL (a, b) -> (a * b, clobbered a,
+    // clobbered b): an inline shift-and-add loop
+    MUL_LOOP,
+
+    // 64-bit add/sub on (lo, hi) pairs: (lo, hi) = (al, ah, bl, bh). Kept
+    // as one node so the carry never leaves SR between the two halves.
+    ADD64,
+    SUB64,
+
+    // f64 bit pattern <-> (lo, hi) GPR pair via FTOA/FTOT and ATOF/TTOF
+    SPLIT_F64,
+    BUILD_F64,
+
+    // Block copy (chain, dst, src, len) - MVN, copies upward one byte at a
+    // time, so memset uses it with dst = src + 1
+    BLOCK_MOVE,
+
+    // Overlap-safe block copy (chain, dst, src, len) - MVN or MVP picked
+    // at run time
+    BLOCK_MOVE_SAFE,
+
+    // Dynamic stack allocation (chain, size, mask) -> (addr, chain): SP
+    // moves down by size and is ANDed with mask; addr is the new SP
+    DYN_ALLOC,
   };
 } // namespace M65832ISD
 
 FunctionPass *createM65832ISelDag(M65832TargetMachine &TM,
                                    CodeGenOptLevel OptLevel);
+FunctionPass *createM65832CallFrameOptimizationPass();
+FunctionPass *createM65832ValueTrackingPass();
+FunctionPass *createM65832IndexLoopsPass();
+FunctionPass *createM65832ShrinkEncodingsPass();
+FunctionPass *createM65832CarryTrackingPass();
+
+FastISel *createM65832FastISel(FunctionLoweringInfo &FuncInfo,
+                               const TargetLibraryInfo *LibInfo,
+                               const LibcallLoweringInfo *LibcallLowering);
+
+InstructionSelector *
+createM65832InstructionSelector(const M65832TargetMachine &TM,
+                                const M65832Subtarget &Subtarget,
+                                const M65832RegisterBankInfo &RBI);
+
+void initializeM65832CallFrameOptimizationPass(PassRegistry &);
+void initializeM65832ValueTrackingPass(PassRegistry &);
+void initializeM65832IndexLoopsPass(PassRegistry &);
+void initializeM65832ShrinkEncodingsPass(PassRegistry &);
+void initializeM65832CarryTrackingPass(PassRegistry &);
 
 } // namespace llvm
 
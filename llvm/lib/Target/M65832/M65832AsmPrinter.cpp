@@ -14,32 +14,56 @@
 #include "M65832.h"
 #include "M65832InstrInfo.h"
 #include "M65832MCInstLower.h"
+#include "M65832MachineFunctionInfo.h"
 #include "M65832TargetMachine.h"
+#include "M65832TargetObjectFile.h"
 #include "MCTargetDesc/M65832InstPrinter.h"
+#include "MCTargetDesc/M65832MCAsmInfo.h"
 #include "TargetInfo/M65832TargetInfo.h"
+#include "llvm/ADT/StringSwitch.h"
 #include "llvm/CodeGen/AsmPrinter.h"
 #include "llvm/CodeGen/MachineConstantPool.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
 #include "llvm/CodeGen/MachineInstr.h"
 #include "llvm/CodeGen/MachineModuleInfo.h"
+#include "llvm/CodeGen/MachineOptimizationRemarkEmitter.h"
+#include "llvm/CodeGen/TargetInstrInfo.h"
+#include "llvm/CodeGen/TargetSchedule.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/InlineAsm.h"
 #include "llvm/IR/Mangler.h"
 #include "llvm/IR/Module.h"
 #include "llvm/MC/MCAsmInfo.h"
+#include "llvm/MC/MCCodeEmitter.h"
+#include "llvm/MC/MCExpr.h"
+#include "llvm/MC/MCFixup.h"
 #include "llvm/MC/MCInst.h"
+#include "llvm/MC/MCInstBuilder.h"
 #include "llvm/MC/MCSectionELF.h"
 #include "llvm/MC/MCStreamer.h"
 #include "llvm/CodeGen/Register.h"
 #include "llvm/MC/MCRegister.h"
 #include "llvm/MC/MCSymbol.h"
 #include "llvm/MC/TargetRegistry.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace llvm;
 
 #define DEBUG_TYPE "asm-printer"
 
+static cl::opt<bool> EmitCycleInfo(
+    "m65832-cycle-info", cl::Hidden,
+    cl::desc("Record each function's estimated cycle count in .m65832.cycles "
+             "for ld.lld --m65832-json-map"));
+
+static cl::opt<bool> VerifyInstSizes(
+    "m65832-verify-inst-sizes", cl::Hidden,
+    cl::desc("Encode every emitted instruction and check its size against "
+             "getInstSizeInBytes"));
+
 namespace {
 class M65832AsmPrinter : public AsmPrinter {
 public:
@@ -51,21 +75,337 @@ public:
 
   void emitInstruction(const MachineInstr *MI) override;
 
+  // Counts the encoded bytes for -m65832-verify-inst-sizes, then emits
+  void EmitToStreamer(MCStreamer &S, const MCInst &Inst);
+
+  void emitPatchableFunctionEnter(const MachineInstr &MI);
+
+  void emitPCRelAddress(const MachineInstr &MI);
+
+  void emitMulLoop(const MachineInstr &MI);
+
+  void emitConstantPool() override;
+
+  void emitFunctionBodyEnd() override;
+
   bool PrintAsmOperand(const MachineInstr *MI, unsigned OpNo,
                        const char *ExtraCode, raw_ostream &OS) override;
 
   bool PrintAsmMemoryOperand(const MachineInstr *MI, unsigned OpNo,
                              const char *ExtraCode, raw_ostream &OS) override;
+
+private:
+  void emitLoweredInstruction(const MachineInstr &MI);
+
+  std::unique_ptr<MCCodeEmitter> SizeEmitter;
+  unsigned EncodedBytes = 0;
 };
 } // end anonymous namespace
 
+void M65832AsmPrinter::EmitToStreamer(MCStreamer &S, const MCInst &Inst) {
+  if (VerifyInstSizes) {
+    if (!SizeEmitter)
+      SizeEmitter.reset(
+          TM.getTarget().createMCCodeEmitter(*TM.getMCInstrInfo(), OutContext));
+    SmallVector<char, 16> Code;
+    SmallVector<MCFixup, 4> Fixups;
+    SizeEmitter->encodeInstruction(Inst, Code, Fixups, getSubtargetInfo());
+    EncodedBytes += Code.size();
+  }
+  AsmPrinter::EmitToStreamer(S, Inst);
+}
+
+// Branch relaxation, the outliner, -fpatchable-function-entry and the
+// .m65832.cycles sizes all take getInstSizeInBytes on trust; with
+// -m65832-verify-inst-sizes every instruction is held to it.
 void M65832AsmPrinter::emitInstruction(const MachineInstr *MI) {
+  EncodedBytes = 0;
+  emitLoweredInstruction(*MI);
+  // The entry sled's NOPs go through AsmPrinter::emitNops uncounted
+  if (!VerifyInstSizes ||
+      MI->getOpcode() == TargetOpcode::PATCHABLE_FUNCTION_ENTER)
+    return;
+  const TargetInstrInfo *TII = MF->getSubtarget().getInstrInfo();
+  unsigned Predicted = TII->getInstSizeInBytes(*MI);
+  if (Predicted != EncodedBytes)
+    report_fatal_error(Twine("getInstSizeInBytes gives ") + Twine(Predicted) +
+                       " bytes for " + TII->getName(MI->getOpcode()) +
+                       ", which encodes as " + Twine(EncodedBytes));
+}
+
+void M65832AsmPrinter::emitLoweredInstruction(const MachineInstr &MI) {
+  if (MI.getOpcode() == TargetOpcode::PATCHABLE_FUNCTION_ENTER)
+    return emitPatchableFunctionEnter(MI);
+  if (MI.getOpcode() == M65832::LA_PCREL)
+    return emitPCRelAddress(MI);
+  if (MI.getOpcode() == M65832::MUL_LOOP)
+    return emitMulLoop(MI);
+
   M65832MCInstLower MCInstLowering(OutContext, *this);
   MCInst TmpInst;
-  MCInstLowering.Lower(MI, TmpInst);
+  MCInstLowering.Lower(&MI, TmpInst);
+
+  // Conditional tail call: the Bcc of its condition, to the callee
+  if (MI.getOpcode() == M65832::TAILCALL_CC) {
+    EmitToStreamer(*OutStreamer,
+                   MCInstBuilder(TmpInst.getOperand(1).getImm())
+                       .addOperand(TmpInst.getOperand(0)));
+    return;
+  }
   EmitToStreamer(*OutStreamer, TmpInst);
 }
 
+// -fpatchable-function-entry=N leaves N bytes at the entry (a NOP is one
+// byte) for a tracing agent to overwrite with a JSR to its trampoline; the
+// __patchable_function_entries table lists them. A disabled sled of more
+// than three bytes is one BRA over the rest, so it costs a single taken
+// branch whatever its size, like the assembler's own padding.
+void M65832AsmPrinter::emitPatchableFunctionEnter(const MachineInstr &MI) {
+  unsigned Num = MF->getSubtarget().getInstrInfo()->getInstSizeInBytes(MI);
+  if (Num <= 3)
+    return emitNops(Num);
+
+  MCSymbol *End = OutContext.createTempSymbol();
+  EmitToStreamer(*OutStreamer,
+                 MCInstBuilder(M65832::BRA)
+                     .addExpr(MCSymbolRefExpr::create(End, OutContext)));
+  emitNops(Num - 3);
+  OutStreamer->emitLabel(End);
+}
+
+// -fPIC address: PER *+6 pushes the address of the ADC's operand field,
+// and the field holds the distance from itself to the symbol
+// (R_M65832_PCREL_32). Emitted here rather than in expandPostRAPseudo so
+// that nothing between the PER and the field can change size.
+void M65832AsmPrinter::emitPCRelAddress(const MachineInstr &MI) {
+  M65832MCInstLower MCInstLowering(OutContext, *this);
+  MCInst TmpInst;
+  MCInstLowering.Lower(&MI, TmpInst);
+  unsigned DstDP = M65832InstrInfo::getDPOffset(
+      TmpInst.getOperand(0).getReg().id() - M65832::R0);
+  const MCExpr *Addr = MCSpecifierExpr::create(
+      TmpInst.getOperand(1).getExpr(), M65832::S_PCREL, OutContext);
+
+  EmitToStreamer(*OutStreamer, MCInstBuilder(M65832::PER).addImm(6));
+  EmitToStreamer(*OutStreamer, MCInstBuilder(M65832::PLA).addReg(M65832::A));
+  EmitToStreamer(*OutStreamer, MCInstBuilder(M65832::CLC));
+  EmitToStreamer(*OutStreamer, MCInstBuilder(M65832::ADC_IMM)
+                                   .addReg(M65832::A)
+                                   .addReg(M65832::A)
+                                   .addExpr(Addr));
+  EmitToStreamer(*OutStreamer, MCInstBuilder(M65832::STA_DP)
+                                   .addReg(M65832::A)
+                                   .addImm(DstDP));
+}
+
+// dst = a * b without MUL: shift b right into C, add a when it was set,
+// shift a left, until b runs out. 21 bytes; see MUL_LOOP.
+void M65832AsmPrinter::emitMulLoop(const MachineInstr &MI) {
+  auto DP = [&](unsigned Idx) -> int64_t {
+    return M65832InstrInfo::getDPOffset(MI.getOperand(Idx).getReg() -
+                                        M65832::R0);
+  };
+  int64_t Dst = DP(0), A = DP(3), B = DP(4);
+  MCSymbol *Loop = OutContext.createTempSymbol();
+  MCSymbol *Skip = OutContext.createTempSymbol();
+
+  EmitToStreamer(*OutStreamer, MCInstBuilder(M65832::STZ_DP).addImm(Dst));
+  OutStreamer->emitLabel(Loop);
+  EmitToStreamer(*OutStreamer, MCInstBuilder(M65832::LSR_DP).addImm(B));
+  EmitToStreamer(*OutStreamer,
+                 MCInstBuilder(M65832::BCC)
+                     .addExpr(MCSymbolRefExpr::create(Skip, OutContext)));
+  EmitToStreamer(*OutStreamer,
+                 MCInstBuilder(M65832::LDA_DP).addReg(M65832::A).addImm(Dst));
+  EmitToStreamer(*OutStreamer, MCInstBuilder(M65832::CLC));
+  EmitToStreamer(*OutStreamer, MCInstBuilder(M65832::ADC_DP)
+                                   .addReg(M65832::A)
+                                   .addReg(M65832::A)
+                                   .addImm(A));
+  EmitToStreamer(*OutStreamer,
+                 MCInstBuilder(M65832::STA_DP).addReg(M65832::A).addImm(Dst));
+  OutStreamer->emitLabel(Skip);
+  EmitToStreamer(*OutStreamer, MCInstBuilder(M65832::ASL_DP).addImm(A));
+  EmitToStreamer(*OutStreamer,
+                 MCInstBuilder(M65832::LDA_DP).addReg(M65832::A).addImm(B));
+  EmitToStreamer(*OutStreamer,
+                 MCInstBuilder(M65832::BNE)
+                     .addExpr(MCSymbolRefExpr::create(Loop, OutContext)));
+}
+
+// Most pools go through the generic code, which puts FP constants in the
+// mergeable .rodata.cst4/.rodata.cst8 so the linker keeps one copy of each
+// across objects. A pool that B addresses from .LCPI<n>_0 (see
+// emitPrologue) must stay in one section instead: its function's own
+// .rodata.<name> under -ffunction-sections (or in a comdat), so
+// --gc-sections drops it with the function, or .rodata.
+void M65832AsmPrinter::emitConstantPool() {
+  const MachineConstantPool *MCP = MF->getConstantPool();
+  const std::vector<MachineConstantPoolEntry> &CP = MCP->getConstants();
+  if (CP.empty())
+    return;
+
+  // Entries needing dynamic relocations belong in .data.rel.ro
+  bool HasRelRO = llvm::any_of(CP, [&](const MachineConstantPoolEntry &CPE) {
+    return CPE.getSectionKind(&getDataLayout()).isReadOnlyWithRel();
+  });
+  if (!MF->getInfo<M65832MachineFunctionInfo>()->usesLiteralPool() ||
+      HasRelRO)
+    return AsmPrinter::emitConstantPool();
+
+  const auto &TLOF =
+      static_cast<const M65832TargetObjectFile &>(getObjFileLowering());
+  MCSection *S = TLOF.getSectionForConstantPool(MF->getFunction(), TM);
+
+  OutStreamer->switchSection(S);
+  emitAlignment(MCP->getConstantPoolAlign());
+  uint64_t Offset = 0;
+  for (unsigned I = 0, E = CP.size(); I != E; ++I) {
+    const MachineConstantPoolEntry &CPE = CP[I];
+    uint64_t NewOffset = alignTo(Offset, CPE.getAlign());
+    OutStreamer->emitZeros(NewOffset - Offset);
+    Offset = NewOffset + CPE.getSizeInBytes(getDataLayout());
+
+    OutStreamer->emitLabel(GetCPISymbol(I));
+    if (CPE.isMachineConstantPoolEntry())
+      emitMachineConstantPoolValue(CPE.Val.MachineCPVal);
+    else
+      emitGlobalConstant(getDataLayout(), CPE.Val.ConstVal);
+  }
+}
+
+/// Remark pass name of the cycle estimates (-Rpass-analysis=m65832-cycles)
+static const char CycleRemarkPass[] = "m65832-cycles";
+
+namespace {
+/// Instruction classes in the cycle remarks, chosen by the first unit in
+/// this order the instruction's scheduling class uses
+enum InstrClass { IC_Branch, IC_FPU, IC_Memory, IC_DPALU, IC_AShuffle,
+                  IC_Other, IC_Num };
+
+const char *const InstrClassNames[IC_Num] = {
+    "Branch", "FPU", "Memory", "DPALU", "AShuffle", "Other"};
+
+/// Cycles and instruction counts for a block or a whole function
+struct CycleCount {
+  uint64_t Cycles = 0;
+  unsigned Instrs = 0;
+  unsigned ByClass[IC_Num] = {};
+
+  CycleCount &operator+=(const CycleCount &O) {
+    Cycles += O.Cycles;
+    Instrs += O.Instrs;
+    for (unsigned I = 0; I != IC_Num; ++I)
+      ByClass[I] += O.ByClass[I];
+    return *this;
+  }
+};
+} // end anonymous namespace
+
+/// Map each processor resource of the model to the class it stands for
+static void getResourceClasses(const MCSchedModel &SM,
+                               SmallVectorImpl<InstrClass> &Classes) {
+  Classes.assign(SM.getNumProcResourceKinds(), IC_Other);
+  for (unsigned I = 1, E = SM.getNumProcResourceKinds(); I != E; ++I) {
+    StringRef Name = SM.getProcResource(I)->Name;
+    Classes[I] = StringSwitch<InstrClass>(Name)
+                     .Case("M65832UnitBranch", IC_Branch)
+                     .Case("M65832UnitFPU", IC_FPU)
+                     .Case("M65832UnitLSU", IC_Memory)
+                     .Cases({"M65832UnitExtALU", "M65832UnitShift",
+                             "M65832UnitMulDiv"},
+                            IC_DPALU)
+                     .Case("M65832UnitAcc", IC_AShuffle)
+                     .Default(IC_Other);
+  }
+}
+
+static CycleCount countBlock(const MachineBasicBlock &MBB,
+                             const TargetSchedModel &SchedModel,
+                             ArrayRef<InstrClass> ResourceClasses) {
+  CycleCount Count;
+  for (const MachineInstr &MI : MBB) {
+    if (MI.isMetaInstruction())
+      continue;
+    Count.Cycles += SchedModel.computeInstrLatency(&MI);
+    ++Count.Instrs;
+    InstrClass Class = IC_Other;
+    const MCSchedClassDesc *SC = SchedModel.hasInstrSchedModel()
+                                     ? SchedModel.resolveSchedClass(&MI)
+                                     : nullptr;
+    if (SC && SC->isValid())
+      for (const MCWriteProcResEntry &WPR :
+           make_range(SchedModel.getWriteProcResBegin(SC),
+                      SchedModel.getWriteProcResEnd(SC)))
+        Class = std::min(Class, ResourceClasses[WPR.ProcResourceIdx]);
+    ++Count.ByClass[Class];
+  }
+  return Count;
+}
+
+static void addCounts(MachineOptimizationRemarkAnalysis &R,
+                      const CycleCount &Count) {
+  R << ore::NV("NumCycles", Count.Cycles) << " cycles estimated, "
+    << ore::NV("NumInstructions", Count.Instrs) << " instructions (";
+  for (unsigned I = 0; I != IC_Num; ++I) {
+    if (I)
+      R << ", ";
+    R << ore::NV(InstrClassNames[I], Count.ByClass[I]) << " "
+      << InstrClassNames[I];
+  }
+  R << ")";
+}
+
+// The estimate is the scheduling model's latency summed over every
+// instruction once: a straight-line pass, no loop or branch weighting. It is
+// meant for spotting regressions between builds, not for timing. It is
+// reported per block and per function as m65832-cycles remarks (into the
+// YAML record with -fsave-optimization-record) and, with -m65832-cycle-info,
+// recorded for the linker's JSON map.
+void M65832AsmPrinter::emitFunctionBodyEnd() {
+  bool Remarks = ORE->allowExtraAnalysis(CycleRemarkPass);
+  if (!EmitCycleInfo && !Remarks)
+    return;
+
+  TargetSchedModel SchedModel;
+  SchedModel.init(&MF->getSubtarget());
+  SmallVector<InstrClass, 8> ResourceClasses;
+  getResourceClasses(*SchedModel.getMCSchedModel(), ResourceClasses);
+
+  CycleCount Total;
+  for (const MachineBasicBlock &MBB : *MF) {
+    CycleCount Count = countBlock(MBB, SchedModel, ResourceClasses);
+    Total += Count;
+    if (!Remarks || MBB.empty())
+      continue;
+    MachineOptimizationRemarkAnalysis R(
+        CycleRemarkPass, "BlockCycles",
+        MBB.findDebugLoc(MBB.instr_begin()), &MBB);
+    R << "bb." << ore::NV("Block", MBB.getNumber()) << ": ";
+    addCounts(R, Count);
+    ORE->emit(R);
+  }
+
+  if (Remarks) {
+    MachineOptimizationRemarkAnalysis R(CycleRemarkPass, "EstimatedCycles",
+                                        MF->getFunction().getSubprogram(),
+                                        &MF->front());
+    R << "function: ";
+    addCounts(R, Total);
+    ORE->emit(R);
+  }
+
+  if (!EmitCycleInfo)
+    return;
+  const auto &TLOF =
+      static_cast<const M65832TargetObjectFile &>(getObjFileLowering());
+  OutStreamer->pushSection();
+  OutStreamer->switchSection(TLOF.getCycleInfoSection(*MF->getSection()));
+  OutStreamer->emitSymbolValue(CurrentFnSym, 4);
+  OutStreamer->emitIntValue(std::min<uint64_t>(Total.Cycles, UINT32_MAX), 4);
+  OutStreamer->popSection();
+}
+
 bool M65832AsmPrinter::PrintAsmOperand(const MachineInstr *MI, unsigned OpNo,
                                          const char *ExtraCode,
                                          raw_ostream &OS) {
@@ -100,7 +440,42 @@ bool M65832AsmPrinter::PrintAsmMemoryOperand(const MachineInstr *MI,
     return true;
     
   const MachineOperand &MO = MI->getOperand(OpNo);
-  
+
+  // The symbolic constraints print only the operand shape
+  // SelectInlineAsmMemoryOperand gave them; a register fallback is an error.
+  const InlineAsm::Flag F(MI->getOperand(OpNo - 1).getImm());
+  switch (F.getMemoryConstraintID()) {
+  default:
+    break;
+  case InlineAsm::ConstraintCode::Q:
+    if (!MO.isGlobal() || MO.getTargetFlags() != M65832II::MO_DP)
+      return true;
+    // A windowed function has moved D, so take the absolute address
+    if (MF->getInfo<M65832MachineFunctionInfo>()->getWindowShift() != 0) {
+      PrintSymbolOperand(MO, OS);
+      return false;
+    }
+    OS << "%dp(";
+    PrintSymbolOperand(MO, OS);
+    OS << ')';
+    return false;
+  case InlineAsm::ConstraintCode::S: {
+    if (!MO.isReg() || MO.getReg() != M65832::B ||
+        OpNo + 1 >= MI->getNumOperands() || !MI->getOperand(OpNo + 1).isImm())
+      return true;
+    int64_t Off = MI->getOperand(OpNo + 1).getImm();
+    if (!isUInt<16>(Off))
+      return true;
+    OS << "B+$" << format_hex_no_prefix(Off, 4);
+    return false;
+  }
+  case InlineAsm::ConstraintCode::A:
+    if (!MO.isGlobal())
+      return true;
+    PrintSymbolOperand(MO, OS);
+    return false;
+  }
+
   // Memory operand is a register containing the address
   if (MO.isReg()) {
     Register Reg = MO.getReg();
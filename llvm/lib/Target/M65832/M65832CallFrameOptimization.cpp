@@ -0,0 +1,310 @@
+//===-- M65832CallFrameOptimization.cpp - Push outgoing stack arguments --===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Arguments past R0-R7 (and byval copies) are stored into the outgoing
+// argument area SP-relative, each through A:
+//
+//   LDA R9                     PUSH32 R9  -> LDA R9; PHA
+//   STA $04,S          ->      PUSH32 R8  -> LDA R8; PHA
+//   LDA R8                     JSR callee
+//   STA $00,S                  ADJSP 8    -> PLY; PLY
+//   JSR callee
+//
+// Once every word of a call's stack arguments is stored in its call
+// sequence by a STORE32 of a GPR, this pass (like X86CallFrameOptimization)
+// replaces the stores with pushes in front of the call, highest offset
+// first. Such a function no longer reserves its call frame: the
+// ADJCALLSTACKDOWN keeps only the bytes that are not pushed, and the
+// ADJCALLSTACKUP frees the whole frame. Functions without a frame base get
+// a .cfi_adjust_cfa_offset for each push from eliminateCallFramePseudoInstr.
+//
+// FP stack arguments are STF stores through a pointer register, so calls
+// that have them keep the reserved frame.
+//
+//===----------------------------------------------------------------------===//
+
+#include "M65832.h"
+#include "M65832InstrInfo.h"
+#include "M65832MachineFunctionInfo.h"
+#include "M65832Subtarget.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineFrameInfo.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/Support/CommandLine.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "m65832-cf-opt"
+#define PASS_NAME "M65832 call frame optimization"
+
+STATISTIC(NumPushedCalls, "Number of calls with pushed stack arguments");
+
+static cl::opt<bool>
+    DisableCallFrameOpt("m65832-disable-call-frame-opt", cl::Hidden,
+                        cl::init(false),
+                        cl::desc("Store outgoing stack arguments into a "
+                                 "reserved call frame instead of pushing "
+                                 "them"));
+
+namespace {
+
+class M65832CallFrameOptimization : public MachineFunctionPass {
+public:
+  static char ID;
+
+  M65832CallFrameOptimization() : MachineFunctionPass(ID) {}
+
+  bool runOnMachineFunction(MachineFunction &MF) override;
+
+  StringRef getPassName() const override { return PASS_NAME; }
+
+private:
+  /// One call sequence and the stores that pass its stack arguments.
+  struct CallContext {
+    MachineInstr *FrameSetup = nullptr;
+    MachineInstr *Call = nullptr;
+    MachineInstr *FrameDestroy = nullptr;
+    /// COPY of SP into the base register of the stores, if there is one
+    MachineInstr *SPCopy = nullptr;
+    /// The STORE32 filling each word of the call frame
+    SmallVector<MachineInstr *, 8> ArgStores;
+    bool NoStackParams = false;
+    bool UsePush = false;
+  };
+
+  const M65832InstrInfo *TII = nullptr;
+  const TargetRegisterInfo *TRI = nullptr;
+  MachineRegisterInfo *MRI = nullptr;
+
+  bool isLegal(const MachineFunction &MF) const;
+  bool isProfitable(const MachineFunction &MF,
+                    ArrayRef<CallContext> Calls) const;
+  void collectCallInfo(MachineInstr &FrameSetup, CallContext &Context) const;
+  void adjustCallSequence(MachineFunction &MF,
+                          const CallContext &Context) const;
+};
+
+} // end anonymous namespace
+
+char M65832CallFrameOptimization::ID = 0;
+
+INITIALIZE_PASS(M65832CallFrameOptimization, DEBUG_TYPE, PASS_NAME, false,
+                false)
+
+FunctionPass *llvm::createM65832CallFrameOptimizationPass() {
+  return new M65832CallFrameOptimization();
+}
+
+/// Bytes of the SP adjustment adjustStackPtr emits for \p Bytes: a PHY or
+/// PLY per word up to MaxStackAdjustSlots, the TSX ... TXS sequence beyond.
+static unsigned getStackAdjustBytes(uint64_t Bytes) {
+  if (Bytes == 0)
+    return 0;
+  if (Bytes % 4 == 0 && Bytes / 4 <= M65832InstrInfo::MaxStackAdjustSlots)
+    return Bytes / 4;
+  return 10;
+}
+
+/// Every call sequence must open and close in one block, without nesting,
+/// for the pushes to be matched with the ADJCALLSTACKUP that pops them.
+bool M65832CallFrameOptimization::isLegal(const MachineFunction &MF) const {
+  for (const MachineBasicBlock &MBB : MF) {
+    bool InsideFrameSequence = false;
+    for (const MachineInstr &MI : MBB) {
+      if (MI.getOpcode() == M65832::ADJCALLSTACKDOWN) {
+        if (InsideFrameSequence)
+          return false;
+        InsideFrameSequence = true;
+      } else if (MI.getOpcode() == M65832::ADJCALLSTACKUP) {
+        if (!InsideFrameSequence)
+          return false;
+        InsideFrameSequence = false;
+      }
+    }
+    if (InsideFrameSequence)
+      return false;
+  }
+  return true;
+}
+
+/// Code size either way. A stored word is LDA; STA $xx,S and a pushed one
+/// LDA; PHA, one byte less, but the call is then followed by an ADJSP that
+/// pops the pushes. Without a reserved frame, every call with stack
+/// arguments that keeps its stores also needs an ADJSP on each side.
+bool M65832CallFrameOptimization::isProfitable(
+    const MachineFunction &MF, ArrayRef<CallContext> Calls) const {
+  if (MF.getFrameInfo().hasVarSizedObjects())
+    return true;
+
+  int64_t Advantage = 0;
+  for (const CallContext &CC : Calls) {
+    if (CC.NoStackParams)
+      continue;
+    uint64_t Bytes = TII->getFrameSize(*CC.FrameSetup);
+    if (CC.UsePush)
+      Advantage += (int64_t)CC.ArgStores.size() - getStackAdjustBytes(Bytes);
+    else
+      Advantage -= 2 * getStackAdjustBytes(Bytes);
+  }
+  return Advantage >= 0;
+}
+
+void M65832CallFrameOptimization::collectCallInfo(
+    MachineInstr &FrameSetup, CallContext &Context) const {
+  MachineBasicBlock &MBB = *FrameSetup.getParent();
+  Context.FrameSetup = &FrameSetup;
+
+  // LowerCall reserves a word for the return address even without stack
+  // arguments, so look for stores before deciding there are none
+  uint64_t FrameSize = TII->getFrameSize(FrameSetup);
+  if (FrameSize % 4 != 0)
+    return;
+  Context.ArgStores.assign(FrameSize / 4, nullptr);
+
+  // The stores are based on a COPY of SP, or on SP itself
+  Register StackPtr = M65832::SP;
+  MachineBasicBlock::iterator I = std::next(FrameSetup.getIterator());
+  for (auto J = I; J != MBB.end() && !J->isCall(); ++J)
+    if (J->isCopy() && J->getOperand(1).getReg() == M65832::SP) {
+      Context.SPCopy = &*J;
+      StackPtr = J->getOperand(0).getReg();
+      break;
+    }
+
+  // Anything else in the sequence has to leave memory, SP and the physical
+  // registers the stores read alone, since the pushes go in at the call.
+  SmallVector<Register, 4> UsedRegs;
+  bool SawStore = false;
+  for (; I != MBB.end() && !I->isCall(); ++I) {
+    if (&*I == Context.SPCopy || I->isDebugInstr())
+      continue;
+
+    if (I->getOpcode() == M65832::STORE32 && I->getOperand(1).isReg() &&
+        I->getOperand(1).getReg() == StackPtr && I->getOperand(2).isImm()) {
+      int64_t Offset = I->getOperand(2).getImm();
+      if (Offset < 0 || Offset % 4 != 0 ||
+          (uint64_t)Offset / 4 >= Context.ArgStores.size() ||
+          Context.ArgStores[Offset / 4])
+        return;
+      Context.ArgStores[Offset / 4] = &*I;
+      SawStore = true;
+      Register Src = I->getOperand(0).getReg();
+      if (Src.isPhysical())
+        UsedRegs.push_back(Src);
+      continue;
+    }
+
+    if (I->mayStore())
+      return;
+    for (const MachineOperand &MO : I->operands()) {
+      if (!MO.isReg() || !MO.getReg().isPhysical())
+        continue;
+      if (TRI->regsOverlap(MO.getReg(), M65832::SP))
+        return;
+      if (MO.isDef())
+        for (Register U : UsedRegs)
+          if (TRI->regsOverlap(MO.getReg(), U))
+            return;
+    }
+  }
+
+  if (I == MBB.end())
+    return;
+  Context.Call = &*I;
+  if (std::next(I) == MBB.end() ||
+      std::next(I)->getOpcode() != M65832::ADJCALLSTACKUP)
+    return;
+  Context.FrameDestroy = &*std::next(I);
+
+  if (!SawStore) {
+    Context.NoStackParams = true;
+    return;
+  }
+
+  // Every word is stored, so the pushes build the whole frame
+  if (llvm::is_contained(Context.ArgStores, nullptr))
+    return;
+  Context.UsePush = true;
+}
+
+void M65832CallFrameOptimization::adjustCallSequence(
+    MachineFunction &MF, const CallContext &Context) const {
+  MachineBasicBlock &MBB = *Context.Call->getParent();
+  const DebugLoc &DL = Context.Call->getDebugLoc();
+
+  // The ADJCALLSTACKDOWN allocates what is not pushed; operand 1 records
+  // the pushed part so that the frame totals still match ADJCALLSTACKUP
+  MachineInstr &FrameSetup = *Context.FrameSetup;
+  int64_t Pushed = 4 * Context.ArgStores.size();
+  FrameSetup.getOperand(0).setImm(TII->getFrameSize(FrameSetup) - Pushed);
+  FrameSetup.getOperand(1).setImm(Pushed);
+
+  for (MachineInstr *Store : llvm::reverse(Context.ArgStores)) {
+    // The value is now read later than the store read it
+    Register Src = Store->getOperand(0).getReg();
+    if (Src.isVirtual())
+      MRI->clearKillFlags(Src);
+    MachineInstr *Push =
+        BuildMI(MBB, Context.Call, DL, TII->get(M65832::PUSH32))
+            .addReg(Src)
+            .getInstr();
+    Push->cloneMemRefs(MF, *Store);
+    Store->eraseFromParent();
+  }
+
+  if (Context.SPCopy &&
+      MRI->use_nodbg_empty(Context.SPCopy->getOperand(0).getReg()))
+    Context.SPCopy->eraseFromParent();
+
+  MF.getInfo<M65832MachineFunctionInfo>()->setHasPushSequences(true);
+  ++NumPushedCalls;
+}
+
+bool M65832CallFrameOptimization::runOnMachineFunction(MachineFunction &MF) {
+  if (DisableCallFrameOpt || skipFunction(MF.getFunction()))
+    return false;
+
+  const M65832Subtarget &STI = MF.getSubtarget<M65832Subtarget>();
+  TII = STI.getInstrInfo();
+  TRI = STI.getRegisterInfo();
+  MRI = &MF.getRegInfo();
+
+  if (!isLegal(MF))
+    return false;
+
+  SmallVector<CallContext, 8> Calls;
+  for (MachineBasicBlock &MBB : MF)
+    for (MachineInstr &MI : MBB)
+      if (MI.getOpcode() == M65832::ADJCALLSTACKDOWN) {
+        Calls.emplace_back();
+        collectCallInfo(MI, Calls.back());
+      }
+
+  if (!isProfitable(MF, Calls))
+    return false;
+
+  bool Changed = false;
+  for (const CallContext &CC : Calls)
+    if (CC.UsePush) {
+      adjustCallSequence(MF, CC);
+      Changed = true;
+    }
+
+  // The word LowerCall reserves for the return address is only needed
+  // inside a reserved frame; JSR pushes below SP otherwise
+  if (Changed)
+    for (const CallContext &CC : Calls)
+      if (CC.NoStackParams) {
+        CC.FrameSetup->getOperand(0).setImm(0);
+        CC.FrameDestroy->getOperand(0).setImm(0);
+      }
+  return Changed;
+}
@@ -0,0 +1,355 @@
+//===-- M65832CarryTracking.cpp - Remove redundant CLC/SEC ----------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// There is no add or subtract without carry, so every expansion that adds a
+// constant emits CLC before its ADC and SEC before its SBC, whether or not
+// the carry is already known:
+//
+//   BCS .LBB0_2
+//   LDA R4
+//   CLC                 ; redundant - C is clear when BCS falls through
+//   ADC #$00000004
+//
+// This pass runs just before emission, after the encodings have been
+// shrunk (CLC; ADC #1 has become INC A by then), and tracks the carry flag
+// forward through every block. Loads, stores, transfers, INC/DEC and the
+// logical operations leave C alone; CLC and SEC set it; ADC #0 with C clear
+// and SBC #0 / CMP #0 leave it known. A BCC or BCS tells each successor what
+// C is on that edge. Anything else that writes SR makes C unknown. A CLC
+// when C is known clear, or a SEC when it is known set, is deleted.
+//
+// Fixed-offset inline branches (BEQ *+n) make the bytes they skip
+// untouchable and their landing point is a join, so C is unknown there and
+// nothing inside is removed.
+//
+//===----------------------------------------------------------------------===//
+
+#include "M65832.h"
+#include "M65832InstrInfo.h"
+#include "M65832Subtarget.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/Support/Debug.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "m65832-carry-tracking"
+#define PASS_NAME "M65832 carry flag tracking"
+
+STATISTIC(NumCLCRemoved, "Number of redundant CLC removed");
+STATISTIC(NumSECRemoved, "Number of redundant SEC removed");
+
+namespace {
+
+/// What is known about C. Unvisited is the lattice top for blocks the
+/// dataflow has not reached yet.
+enum class Carry { Unvisited, Clear, Set, Unknown };
+
+Carry meet(Carry A, Carry B) {
+  if (A == Carry::Unvisited)
+    return B;
+  if (B == Carry::Unvisited || A == B)
+    return A;
+  return Carry::Unknown;
+}
+
+class M65832CarryTracking : public MachineFunctionPass {
+public:
+  static char ID;
+
+  M65832CarryTracking() : MachineFunctionPass(ID) {}
+
+  bool runOnMachineFunction(MachineFunction &MF) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.setPreservesCFG();
+    MachineFunctionPass::getAnalysisUsage(AU);
+  }
+
+  MachineFunctionProperties getRequiredProperties() const override {
+    return MachineFunctionProperties().setNoVRegs();
+  }
+
+  StringRef getPassName() const override { return PASS_NAME; }
+
+private:
+  const TargetRegisterInfo *TRI = nullptr;
+
+  /// Carry state on entry to each block, by block number.
+  SmallVector<Carry, 32> In;
+
+  Carry step(const MachineInstr &MI, Carry C) const;
+  bool walkBlock(MachineBasicBlock &MBB, bool Rewrite,
+                 SmallVectorImpl<std::pair<MachineBasicBlock *, Carry>>
+                     &Edges) const;
+};
+
+} // end anonymous namespace
+
+char M65832CarryTracking::ID = 0;
+
+INITIALIZE_PASS(M65832CarryTracking, DEBUG_TYPE, PASS_NAME, false, false)
+
+FunctionPass *llvm::createM65832CarryTrackingPass() {
+  return new M65832CarryTracking();
+}
+
+static bool isInlineBranch(const MachineInstr &MI) {
+  return MI.isBranch() && MI.getNumOperands() && MI.getOperand(0).isImm();
+}
+
+static bool isImmZero(const MachineOperand &MO) {
+  return MO.isImm() && MO.getImm() == 0;
+}
+
+/// Instructions that write N/Z (and maybe V) but never C.
+static bool preservesCarry(unsigned Opc) {
+  switch (Opc) {
+  default:
+    return false;
+  case M65832::LDA_DP:
+  case M65832::LDA_IMM:
+  case M65832::LDA_ABS:
+  case M65832::LDA_ABS_X:
+  case M65832::LDA_SR:
+  case M65832::LDA_IND:
+  case M65832::LDA_IND_Y:
+  case M65832::LDA_DPG:
+  case M65832::LDX_DP:
+  case M65832::LDX_IMM:
+  case M65832::LDY_DP:
+  case M65832::LDY_IMM:
+  case M65832::LDR_IMM:
+  case M65832::LDR_ABS32:
+  case M65832::LDR_ABS32_Y:
+  case M65832::LDB_IMM:
+  case M65832::LDB_DP:
+  case M65832::LDB_ABS:
+  case M65832::LDB_ABS32:
+  case M65832::LDB_IND_Y:
+  case M65832::LDB_DPG:
+  case M65832::LDW_IMM:
+  case M65832::LDW_DP:
+  case M65832::LDW_ABS:
+  case M65832::LDW_ABS32:
+  case M65832::LDW_IND_Y:
+  case M65832::LDW_DPG:
+  case M65832::INC_A:
+  case M65832::DEC_A:
+  case M65832::INC_DP:
+  case M65832::DEC_DP:
+  case M65832::INC_ABS:
+  case M65832::DEC_ABS:
+  case M65832::INC_DPG:
+  case M65832::DEC_DPG:
+  case M65832::INX:
+  case M65832::INY:
+  case M65832::DEX:
+  case M65832::DEY:
+  case M65832::AND_DP:
+  case M65832::AND_IMM:
+  case M65832::AND_ABS:
+  case M65832::AND_SR:
+  case M65832::ORA_DP:
+  case M65832::ORA_IMM:
+  case M65832::ORA_ABS:
+  case M65832::ORA_SR:
+  case M65832::EOR_DP:
+  case M65832::EOR_IMM:
+  case M65832::EOR_ABS:
+  case M65832::EOR_SR:
+  case M65832::ANDR_DP:
+  case M65832::ANDR_IMM:
+  case M65832::ORAR_DP:
+  case M65832::ORAR_IMM:
+  case M65832::EORR_DP:
+  case M65832::EORR_IMM:
+  case M65832::TAX:
+  case M65832::TXA:
+  case M65832::TAY:
+  case M65832::TYA:
+  case M65832::TSX:
+  case M65832::TXS:
+  case M65832::TAB:
+  case M65832::TBA:
+  case M65832::TXB:
+  case M65832::TBX:
+  case M65832::TYB:
+  case M65832::TBY:
+  case M65832::PLA:
+  case M65832::PLX:
+  case M65832::PLY:
+  case M65832::PLB32:
+  case M65832::PLD32:
+  case M65832::CLI:
+  case M65832::SEI:
+  case M65832::CLV:
+    return true;
+  }
+}
+
+Carry M65832CarryTracking::step(const MachineInstr &MI, Carry C) const {
+  switch (MI.getOpcode()) {
+  case M65832::CLC:
+    return Carry::Clear;
+  case M65832::SEC:
+    return Carry::Set;
+
+  // Adding 0 with no carry in can't carry out, subtracting 0 with no
+  // borrow in can't borrow.
+  case M65832::ADC_IMM:
+  case M65832::ADDR_IMM:
+    return C == Carry::Clear && isImmZero(MI.getOperand(2)) ? Carry::Clear
+                                                            : Carry::Unknown;
+  case M65832::SBC_IMM:
+  case M65832::SUBR_IMM:
+    return C == Carry::Set && isImmZero(MI.getOperand(2)) ? Carry::Set
+                                                          : Carry::Unknown;
+
+  // Every unsigned value is >= 0.
+  case M65832::CMP_IMM:
+  case M65832::CPX_IMM:
+  case M65832::CPY_IMM:
+  case M65832::CMPR_IMM:
+    return isImmZero(MI.getOperand(1)) ? Carry::Set : Carry::Unknown;
+
+  default:
+    break;
+  }
+
+  if (MI.isCall() || MI.isInlineAsm())
+    return Carry::Unknown;
+  if (!MI.modifiesRegister(M65832::SR, TRI) || preservesCarry(MI.getOpcode()))
+    return C;
+  return Carry::Unknown;
+}
+
+/// Walk MBB from its entry state, collecting the carry state on each
+/// outgoing edge. With Rewrite set, redundant CLC/SEC are also deleted.
+bool M65832CarryTracking::walkBlock(
+    MachineBasicBlock &MBB, bool Rewrite,
+    SmallVectorImpl<std::pair<MachineBasicBlock *, Carry>> &Edges) const {
+  bool Changed = false;
+  Carry C = In[MBB.getNumber()];
+  if (C == Carry::Unvisited)
+    C = Carry::Unknown;
+
+  // A backwards inline branch makes part of this block a join that the
+  // dataflow does not see, so leave the whole block alone.
+  bool Blocked = llvm::any_of(MBB, [](const MachineInstr &MI) {
+    return isInlineBranch(MI) && MI.getOperand(0).getImm() < 0;
+  });
+
+  // Bytes still covered by a fixed-offset inline branch.
+  int64_t Protected = 0;
+
+  for (MachineInstr &MI : llvm::make_early_inc_range(MBB)) {
+    if (MI.isDebugInstr())
+      continue;
+
+    if (Blocked) {
+      C = Carry::Unknown;
+      continue;
+    }
+
+    if (Protected > 0) {
+      Protected -= MI.getDesc().getSize();
+      if (isInlineBranch(MI))
+        Protected = std::max(Protected, MI.getOperand(0).getImm());
+      C = Carry::Unknown;
+      continue;
+    }
+
+    if (isInlineBranch(MI)) {
+      Protected = MI.getOperand(0).getImm();
+      C = Carry::Unknown;
+      continue;
+    }
+
+    unsigned Opc = MI.getOpcode();
+    if (Rewrite && ((Opc == M65832::CLC && C == Carry::Clear) ||
+                    (Opc == M65832::SEC && C == Carry::Set))) {
+      LLVM_DEBUG(dbgs() << "Removing redundant " << MI);
+      ++(Opc == M65832::CLC ? NumCLCRemoved : NumSECRemoved);
+      MI.eraseFromParent();
+      Changed = true;
+      continue;
+    }
+
+    // BCC/BCS to a block: C is known on both edges.
+    if ((Opc == M65832::BCC || Opc == M65832::BCS) &&
+        MI.getOperand(0).isMBB()) {
+      bool TakenIfClear = Opc == M65832::BCC;
+      Edges.push_back({MI.getOperand(0).getMBB(),
+                       TakenIfClear ? Carry::Clear : Carry::Set});
+      C = TakenIfClear ? Carry::Set : Carry::Clear;
+      continue;
+    }
+
+    if (MI.isBranch())
+      for (const MachineOperand &MO : MI.operands())
+        if (MO.isMBB())
+          Edges.push_back({MO.getMBB(), C});
+
+    C = step(MI, C);
+  }
+
+  // Fallthrough, jump table targets and anything else not named by a
+  // branch get the state at the end of the block.
+  MachineBasicBlock *FallThrough = MBB.getFallThrough();
+  for (MachineBasicBlock *Succ : MBB.successors()) {
+    bool Named = llvm::any_of(
+        Edges, [Succ](const auto &Edge) { return Edge.first == Succ; });
+    if (!Named || Succ == FallThrough)
+      Edges.push_back({Succ, C});
+  }
+  return Changed;
+}
+
+bool M65832CarryTracking::runOnMachineFunction(MachineFunction &MF) {
+  if (skipFunction(MF.getFunction()))
+    return false;
+
+  TRI = MF.getSubtarget<M65832Subtarget>().getRegisterInfo();
+
+  // Forward dataflow to a fixed point. Entry, landing pads and blocks whose
+  // address is taken can be reached with any carry.
+  In.assign(MF.getNumBlockIDs(), Carry::Unvisited);
+  SmallVector<MachineBasicBlock *, 32> Worklist;
+  for (MachineBasicBlock &MBB : MF) {
+    if (&MBB == &MF.front() || MBB.isEHPad() ||
+        MBB.isMachineBlockAddressTaken() || MBB.isIRBlockAddressTaken()) {
+      In[MBB.getNumber()] = Carry::Unknown;
+      Worklist.push_back(&MBB);
+    }
+  }
+
+  SmallVector<std::pair<MachineBasicBlock *, Carry>, 4> Edges;
+  while (!Worklist.empty()) {
+    MachineBasicBlock *MBB = Worklist.pop_back_val();
+    Edges.clear();
+    walkBlock(*MBB, /*Rewrite=*/false, Edges);
+    for (auto [Succ, C] : Edges) {
+      Carry &SuccIn = In[Succ->getNumber()];
+      Carry New = meet(SuccIn, C);
+      if (New != SuccIn) {
+        SuccIn = New;
+        Worklist.push_back(Succ);
+      }
+    }
+  }
+
+  bool Changed = false;
+  for (MachineBasicBlock &MBB : MF) {
+    Edges.clear();
+    Changed |= walkBlock(MBB, /*Rewrite=*/true, Edges);
+  }
+  return Changed;
+}
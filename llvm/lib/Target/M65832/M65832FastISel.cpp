@@ -0,0 +1,649 @@
+//===-- M65832FastISel.cpp - Fast instruction selection for M65832 --------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// The -O0 instruction selector. SelectionDAG spends most of a debug build
+// building, combining and scheduling DAGs for code that is then neither
+// optimized nor scheduled; this pass picks the same pseudos directly from
+// the IR for the common cases:
+//
+//   - i32 and pointer add/sub/and/or/xor and constant shifts
+//   - i8/i16/i32 loads and stores to stack slots, globals and pointers,
+//     with constant GEP offsets folded into the access
+//   - conditional branches on a compare in the same block, as one
+//     BR_CC_CMP_PSEUDO like LowerBR_CC gives
+//   - direct and indirect calls with register arguments and results
+//   - returns of void or one register
+//
+// There is no -gen-fast-isel table: the patterns that would feed it select
+// through ComplexPatterns and wrapper nodes it cannot follow. Anything else
+// returns false, and SelectionDAG takes that instruction (or block, for a
+// terminator). Arguments always go through LowerFormalArguments, which also
+// decides whether the function moves D to a register window.
+//
+//===----------------------------------------------------------------------===//
+
+#include "M65832.h"
+#include "M65832ISelLowering.h"
+#include "M65832InstrInfo.h"
+#include "M65832MachineFunctionInfo.h"
+#include "M65832Subtarget.h"
+#include "llvm/CodeGen/Analysis.h"
+#include "llvm/CodeGen/CallingConvLower.h"
+#include "llvm/CodeGen/FastISel.h"
+#include "llvm/CodeGen/FunctionLoweringInfo.h"
+#include "llvm/CodeGen/MachineFrameInfo.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/IR/GetElementPtrTypeIterator.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Operator.h"
+#include "llvm/Support/MathExtras.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "m65832-fastisel"
+
+namespace {
+
+class M65832FastISel final : public FastISel {
+  /// A load or store address: a stack slot, a global or a register, plus a
+  /// constant offset
+  struct Address {
+    enum { RegBase, FrameIndexBase, GlobalBase } Kind = RegBase;
+    Register Reg;
+    int FI = 0;
+    const GlobalValue *GV = nullptr;
+    int64_t Offset = 0;
+  };
+
+  const M65832Subtarget &Subtarget;
+  const M65832InstrInfo &TII;
+  const M65832TargetLowering &TLI;
+
+public:
+  M65832FastISel(FunctionLoweringInfo &FuncInfo,
+                 const TargetLibraryInfo *LibInfo,
+                 const LibcallLoweringInfo *LibcallLowering)
+      : FastISel(FuncInfo, LibInfo, LibcallLowering),
+        Subtarget(FuncInfo.MF->getSubtarget<M65832Subtarget>()),
+        TII(*Subtarget.getInstrInfo()), TLI(*Subtarget.getTargetLowering()) {}
+
+  bool fastSelectInstruction(const Instruction *I) override;
+  bool fastLowerCall(CallLoweringInfo &CLI) override;
+
+  Register fastMaterializeConstant(const Constant *C) override;
+  Register fastMaterializeAlloca(const AllocaInst *AI) override;
+
+  Register fastEmit_i(MVT VT, MVT RetVT, unsigned Opcode,
+                      uint64_t Imm) override;
+  Register fastEmit_rr(MVT VT, MVT RetVT, unsigned Opcode, Register Op0,
+                       Register Op1) override;
+  Register fastEmit_ri(MVT VT, MVT RetVT, unsigned Opcode, Register Op0,
+                       uint64_t Imm) override;
+
+private:
+  bool isTypeLegal(Type *Ty, MVT &VT) const;
+  bool isLoadStoreType(Type *Ty, MVT &VT) const;
+  bool computeAddress(const Value *V, Address &Addr);
+  MachineInstrBuilder &addAddress(MachineInstrBuilder &MIB,
+                                  const Address &Addr, unsigned OpNo);
+
+  bool selectLoad(const Instruction *I);
+  bool selectStore(const Instruction *I);
+  bool selectBranch(const Instruction *I);
+  bool selectRet(const Instruction *I);
+};
+
+} // end anonymous namespace
+
+bool M65832FastISel::isTypeLegal(Type *Ty, MVT &VT) const {
+  EVT Evt = TLI.getValueType(DL, Ty, /*AllowUnknown=*/true);
+  if (Evt == MVT::Other || !Evt.isSimple())
+    return false;
+  VT = Evt.getSimpleVT();
+  return VT == MVT::i32;
+}
+
+/// i8 and i16 values live promoted in a GPR: LD.B/LD.W zero-extend into
+/// one and ST.B/ST.W store its low bits
+bool M65832FastISel::isLoadStoreType(Type *Ty, MVT &VT) const {
+  EVT Evt = TLI.getValueType(DL, Ty, /*AllowUnknown=*/true);
+  if (Evt == MVT::Other || !Evt.isSimple())
+    return false;
+  VT = Evt.getSimpleVT();
+  return VT == MVT::i8 || VT == MVT::i16 || VT == MVT::i32;
+}
+
+/// Globals are reached 32-bit absolute, as the DAG's _GLOBAL forms are
+/// without the small-data, bank and direct-page refinements. Under -fPIC
+/// the address is an LA_PCREL in a register like any other pointer.
+static bool isAbsoluteGlobal(const GlobalValue *GV, const TargetMachine &TM) {
+  return !TM.isPositionIndependent() && !GV->isThreadLocal();
+}
+
+/// Look through casts and constant GEPs defined in this block (whose
+/// addresses the DAG would also have folded) down to a slot, a global or a
+/// register.
+bool M65832FastISel::computeAddress(const Value *V, Address &Addr) {
+  const User *U = nullptr;
+  unsigned Opcode = Instruction::UserOp1;
+  if (const auto *I = dyn_cast<Instruction>(V)) {
+    if (FuncInfo.StaticAllocaMap.count(static_cast<const AllocaInst *>(V)) ||
+        FuncInfo.getMBB(I->getParent()) == FuncInfo.MBB) {
+      Opcode = I->getOpcode();
+      U = I;
+    }
+  } else if (const auto *CE = dyn_cast<ConstantExpr>(V)) {
+    Opcode = CE->getOpcode();
+    U = CE;
+  }
+
+  switch (Opcode) {
+  default:
+    break;
+  case Instruction::BitCast:
+    return computeAddress(U->getOperand(0), Addr);
+  case Instruction::IntToPtr:
+  case Instruction::PtrToInt:
+    if (TLI.getValueType(DL, U->getOperand(0)->getType()) ==
+        TLI.getPointerTy(DL))
+      return computeAddress(U->getOperand(0), Addr);
+    break;
+  case Instruction::GetElementPtr: {
+    // A variable index is left to selectGetElementPtr
+    Address SavedAddr = Addr;
+    int64_t Offset = Addr.Offset;
+    bool ConstantOffset = true;
+    for (gep_type_iterator GTI = gep_type_begin(U), E = gep_type_end(U);
+         GTI != E && ConstantOffset; ++GTI) {
+      const auto *CI = dyn_cast<ConstantInt>(GTI.getOperand());
+      if (!CI)
+        ConstantOffset = false;
+      else if (StructType *STy = GTI.getStructTypeOrNull())
+        Offset +=
+            DL.getStructLayout(STy)->getElementOffset(CI->getZExtValue());
+      else
+        Offset += GTI.getSequentialElementStride(DL) * CI->getSExtValue();
+    }
+    if (!ConstantOffset || !isInt<32>(Offset))
+      break;
+    Addr.Offset = Offset;
+    if (computeAddress(U->getOperand(0), Addr))
+      return true;
+    Addr = SavedAddr;
+    break;
+  }
+  case Instruction::Alloca: {
+    auto SI = FuncInfo.StaticAllocaMap.find(cast<AllocaInst>(V));
+    if (SI != FuncInfo.StaticAllocaMap.end()) {
+      Addr.Kind = Address::FrameIndexBase;
+      Addr.FI = SI->second;
+      return true;
+    }
+    break;
+  }
+  }
+
+  if (const auto *GV = dyn_cast<GlobalValue>(V)) {
+    if (isAbsoluteGlobal(GV, TM)) {
+      Addr.Kind = Address::GlobalBase;
+      Addr.GV = GV;
+      return true;
+    }
+  }
+
+  Addr.Kind = Address::RegBase;
+  Addr.Reg = getRegForValue(V);
+  return Addr.Reg.isValid();
+}
+
+/// Add the memsrc or i32imm address operands starting at operand \p OpNo
+MachineInstrBuilder &M65832FastISel::addAddress(MachineInstrBuilder &MIB,
+                                                const Address &Addr,
+                                                unsigned OpNo) {
+  switch (Addr.Kind) {
+  case Address::FrameIndexBase:
+    MIB.addFrameIndex(Addr.FI).addImm(Addr.Offset);
+    break;
+  case Address::GlobalBase:
+    MIB.addGlobalAddress(Addr.GV, Addr.Offset);
+    break;
+  case Address::RegBase: {
+    Register Base = constrainOperandRegClass(MIB->getDesc(), Addr.Reg, OpNo);
+    MIB.addReg(Base).addImm(Addr.Offset);
+    break;
+  }
+  }
+  return MIB;
+}
+
+bool M65832FastISel::selectLoad(const Instruction *I) {
+  const auto *LI = cast<LoadInst>(I);
+  MVT VT;
+  if (LI->isAtomic() || !isLoadStoreType(LI->getType(), VT))
+    return false;
+
+  Address Addr;
+  if (!computeAddress(LI->getPointerOperand(), Addr))
+    return false;
+
+  bool Global = Addr.Kind == Address::GlobalBase;
+  unsigned Opc;
+  switch (VT.SimpleTy) {
+  default:
+    llvm_unreachable("unexpected load type");
+  case MVT::i8:
+    Opc = Global ? M65832::LOAD8_GLOBAL : M65832::LOAD8;
+    break;
+  case MVT::i16:
+    Opc = Global ? M65832::LOAD16_GLOBAL : M65832::LOAD16;
+    break;
+  case MVT::i32:
+    Opc = Global ? M65832::LOAD32_GLOBAL : M65832::LOAD32;
+    break;
+  }
+
+  Register ResultReg = createResultReg(&M65832::GPRRegClass);
+  MachineInstrBuilder MIB =
+      BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, MIMD, TII.get(Opc), ResultReg);
+  addAddress(MIB, Addr, 1).addMemOperand(createMachineMemOperandFor(I));
+  updateValueMap(I, ResultReg);
+  return true;
+}
+
+bool M65832FastISel::selectStore(const Instruction *I) {
+  const auto *SI = cast<StoreInst>(I);
+  const Value *Val = SI->getValueOperand();
+  MVT VT;
+  if (SI->isAtomic() || !isLoadStoreType(Val->getType(), VT))
+    return false;
+
+  Register SrcReg = getRegForValue(Val);
+  if (!SrcReg)
+    return false;
+
+  Address Addr;
+  if (!computeAddress(SI->getPointerOperand(), Addr))
+    return false;
+
+  bool Global = Addr.Kind == Address::GlobalBase;
+  unsigned Opc;
+  switch (VT.SimpleTy) {
+  default:
+    llvm_unreachable("unexpected store type");
+  case MVT::i8:
+    Opc = Global ? M65832::STORE8_GLOBAL : M65832::STORE8;
+    break;
+  case MVT::i16:
+    Opc = Global ? M65832::STORE16_GLOBAL : M65832::STORE16;
+    break;
+  case MVT::i32:
+    Opc = Global ? M65832::STORE32_GLOBAL : M65832::STORE32;
+    break;
+  }
+
+  MachineInstrBuilder MIB =
+      BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, MIMD, TII.get(Opc))
+          .addReg(SrcReg);
+  addAddress(MIB, Addr, 1).addMemOperand(createMachineMemOperandFor(I));
+  return true;
+}
+
+/// The ISD condition code BR_CC_CMP_PSEUDO takes for \p Pred, after the
+/// rewrite canonicalizeIntCC does: GT/LE/UGT/ULE swap their operands, or
+/// bump a constant rhs, so the expansion is always one CMPR and one Bcc.
+static ISD::CondCode getBranchCC(CmpInst::Predicate Pred, const Value *&LHS,
+                                 const Value *&RHS, int64_t &Imm,
+                                 bool &IsImm) {
+  ISD::CondCode CC = getICmpCondCode(Pred);
+  const auto *C = dyn_cast<ConstantInt>(RHS);
+  IsImm = C && C->getBitWidth() <= 32;
+  if (IsImm)
+    Imm = C->getSExtValue();
+
+  ISD::CondCode NewCC;
+  switch (CC) {
+  case ISD::SETGT:  NewCC = ISD::SETGE;  break;
+  case ISD::SETLE:  NewCC = ISD::SETLT;  break;
+  case ISD::SETUGT: NewCC = ISD::SETUGE; break;
+  case ISD::SETULE: NewCC = ISD::SETULT; break;
+  default:
+    return CC;
+  }
+
+  if (IsImm) {
+    bool Signed = CC == ISD::SETGT || CC == ISD::SETLE;
+    const APInt &Val = C->getValue();
+    if (Signed ? !Val.isMaxSignedValue() : !Val.isMaxValue()) {
+      Imm = (int32_t)(Imm + 1);
+      return NewCC;
+    }
+    IsImm = false;
+  }
+
+  std::swap(LHS, RHS);
+  return ISD::getSetCCSwappedOperands(CC);
+}
+
+bool M65832FastISel::selectBranch(const Instruction *I) {
+  const auto *BI = cast<BranchInst>(I);
+  MachineBasicBlock *TBB = FuncInfo.getMBB(BI->getSuccessor(0));
+  MachineBasicBlock *FBB = FuncInfo.getMBB(BI->getSuccessor(1));
+
+  // A compare used only here folds into the branch, as in LowerBR_CC
+  if (const auto *CI = dyn_cast<ICmpInst>(BI->getCondition())) {
+    MVT VT;
+    if (CI->hasOneUse() && CI->getParent() == I->getParent() &&
+        isTypeLegal(CI->getOperand(0)->getType(), VT)) {
+      const Value *LHS = CI->getOperand(0);
+      const Value *RHS = CI->getOperand(1);
+      int64_t Imm = 0;
+      bool IsImm = false;
+      ISD::CondCode CC = getBranchCC(CI->getPredicate(), LHS, RHS, Imm, IsImm);
+
+      Register LHSReg = getRegForValue(LHS);
+      if (!LHSReg)
+        return false;
+      if (IsImm) {
+        BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, MIMD,
+                TII.get(M65832::BR_CC_CMP_IMM_PSEUDO))
+            .addReg(LHSReg)
+            .addImm(Imm)
+            .addImm(CC)
+            .addMBB(TBB);
+      } else {
+        Register RHSReg = getRegForValue(RHS);
+        if (!RHSReg)
+          return false;
+        BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, MIMD,
+                TII.get(M65832::BR_CC_CMP_PSEUDO))
+            .addReg(LHSReg)
+            .addReg(RHSReg)
+            .addImm(CC)
+            .addMBB(TBB);
+      }
+      finishCondBranch(BI->getParent(), TBB, FBB);
+      return true;
+    }
+  }
+
+  // Otherwise the condition is an i1 in a GPR, whose upper bits are not
+  // defined
+  Register CondReg = getRegForValue(BI->getCondition());
+  if (!CondReg)
+    return false;
+  Register Masked = fastEmitInst_ri(M65832::ANDI_GPR, &M65832::GPRRegClass,
+                                    CondReg, 1);
+  BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, MIMD,
+          TII.get(M65832::BR_CC_CMP_IMM_PSEUDO))
+      .addReg(Masked)
+      .addImm(0)
+      .addImm(ISD::SETNE)
+      .addMBB(TBB);
+  finishCondBranch(BI->getParent(), TBB, FBB);
+  return true;
+}
+
+/// A windowed function's result has to go where the caller's window sees
+/// it, and an interrupt handler leaves through RTI; both stay with
+/// LowerReturn.
+bool M65832FastISel::selectRet(const Instruction *I) {
+  const auto *Ret = cast<ReturnInst>(I);
+  const Function &F = *I->getFunction();
+  MachineFunction &MF = *FuncInfo.MF;
+
+  if (!FuncInfo.CanLowerReturn || F.isVarArg() ||
+      F.hasFnAttribute("interrupt") ||
+      MF.getInfo<M65832MachineFunctionInfo>()->getWindowShift() != 0)
+    return false;
+
+  SmallVector<Register, 1> RetRegs;
+  if (Ret->getNumOperands() > 0) {
+    const Value *RV = Ret->getOperand(0);
+    MVT VT;
+    if (!isTypeLegal(RV->getType(), VT))
+      return false;
+
+    SmallVector<ISD::OutputArg, 1> Outs;
+    GetReturnInfo(F.getCallingConv(), F.getReturnType(), F.getAttributes(),
+                  Outs, TLI, DL);
+    SmallVector<CCValAssign, 1> RVLocs;
+    CCState CCInfo(F.getCallingConv(), F.isVarArg(), MF, RVLocs,
+                   I->getContext());
+    CCInfo.AnalyzeReturn(Outs, TLI.getCCAssignFn(F.getCallingConv(), true));
+    if (RVLocs.size() != 1 || !RVLocs[0].isRegLoc() ||
+        RVLocs[0].getLocInfo() != CCValAssign::Full)
+      return false;
+
+    Register Reg = getRegForValue(RV);
+    if (!Reg)
+      return false;
+    MCRegister RetReg = RVLocs[0].getLocReg();
+    BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, MIMD,
+            TII.get(TargetOpcode::COPY), RetReg)
+        .addReg(Reg);
+    RetRegs.push_back(RetReg);
+  }
+
+  MachineInstrBuilder MIB =
+      BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, MIMD, TII.get(M65832::RTS));
+  for (Register Reg : RetRegs)
+    MIB.addReg(Reg, RegState::Implicit);
+  return true;
+}
+
+/// The call sequence LowerCall builds, for calls whose arguments and result
+/// all fit in registers: ADJCALLSTACKDOWN for the return address word, the
+/// argument copies, JSR (or LA_PCREL + JSR_IND under -fPIC) with the call's
+/// register mask, ADJCALLSTACKUP and the result copy.
+bool M65832FastISel::fastLowerCall(CallLoweringInfo &CLI) {
+  CallingConv::ID CC = CLI.CallConv;
+  if (CLI.IsVarArg || CLI.Symbol || (CLI.CB && CLI.CB->isMustTailCall()))
+    return false;
+  if (CC != CallingConv::C && CC != CallingConv::Fast)
+    return false;
+
+  MVT RetVT = MVT::isVoid;
+  if (!CLI.RetTy->isVoidTy() && !isTypeLegal(CLI.RetTy, RetVT))
+    return false;
+
+  for (ISD::ArgFlagsTy Flags : CLI.OutFlags)
+    if (Flags.isByVal() || Flags.isSRet() || Flags.isInReg() ||
+        Flags.isNest() || Flags.isSExt() || Flags.isZExt())
+      return false;
+
+  SmallVector<MVT, 8> OutVTs;
+  for (const Value *V : CLI.OutVals) {
+    MVT VT;
+    if (!isTypeLegal(V->getType(), VT))
+      return false;
+    OutVTs.push_back(VT);
+  }
+
+  MachineFunction &MF = *FuncInfo.MF;
+  SmallVector<CCValAssign, 8> ArgLocs;
+  CCState CCInfo(CC, /*IsVarArg=*/false, MF, ArgLocs,
+                 CLI.RetTy->getContext());
+  CCInfo.AnalyzeCallOperands(OutVTs, CLI.OutFlags,
+                             TLI.getCCAssignFn(CC, false));
+  if (CCInfo.getStackSize() != 0)
+    return false;
+
+  SmallVector<Register, 8> ArgRegs;
+  for (const Value *V : CLI.OutVals) {
+    Register Reg = getRegForValue(V);
+    if (!Reg)
+      return false;
+    ArgRegs.push_back(Reg);
+  }
+
+  // The callee: a direct JSR to an absolute address, or JSR (Rn)
+  const auto *GV = dyn_cast<GlobalValue>(CLI.Callee);
+  bool Direct = GV && isAbsoluteGlobal(GV, TM);
+  Register CalleeReg;
+  if (!Direct) {
+    CalleeReg = getRegForValue(CLI.Callee);
+    if (!CalleeReg)
+      return false;
+  }
+
+  // JSR pushes a return address word the frame has to leave room for
+  const unsigned CallFrameSize = 4;
+  BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, MIMD,
+          TII.get(M65832::ADJCALLSTACKDOWN))
+      .addImm(CallFrameSize)
+      .addImm(0);
+
+  for (unsigned I = 0, E = ArgLocs.size(); I != E; ++I) {
+    MCRegister LocReg = ArgLocs[I].getLocReg();
+    BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, MIMD,
+            TII.get(TargetOpcode::COPY), LocReg)
+        .addReg(ArgRegs[ArgLocs[I].getValNo()]);
+    CLI.OutRegs.push_back(LocReg);
+  }
+
+  MachineInstrBuilder MIB;
+  if (Direct) {
+    MIB = BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, MIMD, TII.get(M65832::JSR))
+              .addGlobalAddress(GV);
+  } else {
+    const MCInstrDesc &II = TII.get(M65832::JSR_IND);
+    CalleeReg = constrainOperandRegClass(II, CalleeReg, 0);
+    MIB = BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, MIMD, II).addReg(CalleeReg);
+  }
+  for (Register Reg : CLI.OutRegs)
+    MIB.addReg(Reg, RegState::Implicit);
+  MIB.addRegMask(Subtarget.getRegisterInfo()->getCallPreservedMask(MF, CC));
+  CLI.Call = MIB;
+
+  BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, MIMD,
+          TII.get(M65832::ADJCALLSTACKUP))
+      .addImm(CallFrameSize)
+      .addImm(0);
+
+  if (RetVT != MVT::isVoid) {
+    SmallVector<CCValAssign, 1> RVLocs;
+    CCState RVInfo(CC, /*IsVarArg=*/false, MF, RVLocs,
+                   CLI.RetTy->getContext());
+    RVInfo.AnalyzeCallResult(CLI.Ins, TLI.getCCAssignFn(CC, true));
+    if (RVLocs.size() != 1 || !RVLocs[0].isRegLoc())
+      return false;
+
+    Register ResultReg = createResultReg(&M65832::GPRRegClass);
+    BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, MIMD,
+            TII.get(TargetOpcode::COPY), ResultReg)
+        .addReg(RVLocs[0].getLocReg());
+    CLI.InRegs.push_back(RVLocs[0].getLocReg());
+    CLI.ResultReg = ResultReg;
+    CLI.NumResultRegs = 1;
+  }
+  return true;
+}
+
+Register M65832FastISel::fastMaterializeConstant(const Constant *C) {
+  const auto *GV = dyn_cast<GlobalValue>(C);
+  if (!GV || GV->isThreadLocal())
+    return Register();
+
+  unsigned Opc = TM.isPositionIndependent() ? M65832::LA_PCREL : M65832::LA;
+  Register ResultReg = createResultReg(&M65832::GPRRegClass);
+  BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, MIMD, TII.get(Opc), ResultReg)
+      .addGlobalAddress(GV);
+  return ResultReg;
+}
+
+Register M65832FastISel::fastMaterializeAlloca(const AllocaInst *AI) {
+  auto SI = FuncInfo.StaticAllocaMap.find(AI);
+  if (SI == FuncInfo.StaticAllocaMap.end())
+    return Register();
+
+  Register ResultReg = createResultReg(&M65832::GPRRegClass);
+  BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, MIMD, TII.get(M65832::LEA_FI),
+          ResultReg)
+      .addFrameIndex(SI->second)
+      .addImm(0);
+  return ResultReg;
+}
+
+Register M65832FastISel::fastEmit_i(MVT VT, MVT RetVT, unsigned Opcode,
+                                    uint64_t Imm) {
+  if (Opcode != ISD::Constant || VT != MVT::i32 || RetVT != MVT::i32)
+    return Register();
+  // Sign-extended like the DAG's 32-bit immediates
+  return fastEmitInst_i(M65832::LI, &M65832::GPRRegClass,
+                        SignExtend64<32>(Imm));
+}
+
+Register M65832FastISel::fastEmit_rr(MVT VT, MVT RetVT, unsigned Opcode,
+                                     Register Op0, Register Op1) {
+  if (VT != MVT::i32 || RetVT != MVT::i32)
+    return Register();
+
+  unsigned Opc;
+  switch (Opcode) {
+  default:
+    return Register();
+  case ISD::ADD: Opc = M65832::ADD_GPR; break;
+  case ISD::SUB: Opc = M65832::SUB_GPR; break;
+  case ISD::AND: Opc = M65832::AND_GPR; break;
+  case ISD::OR:  Opc = M65832::ORA_GPR; break;
+  case ISD::XOR: Opc = M65832::EOR_GPR; break;
+  }
+  return fastEmitInst_rr(Opc, &M65832::GPRRegClass, Op0, Op1);
+}
+
+Register M65832FastISel::fastEmit_ri(MVT VT, MVT RetVT, unsigned Opcode,
+                                     Register Op0, uint64_t Imm) {
+  if (VT != MVT::i32 || RetVT != MVT::i32)
+    return Register();
+
+  unsigned Opc;
+  switch (Opcode) {
+  default:
+    return Register();
+  case ISD::ADD: Opc = M65832::ADDI_GPR; break;
+  case ISD::SUB: Opc = M65832::SUBI_GPR; break;
+  case ISD::AND: Opc = M65832::ANDI_GPR; break;
+  case ISD::OR:  Opc = M65832::ORI_GPR;  break;
+  case ISD::XOR: Opc = M65832::XORI_GPR; break;
+  case ISD::SHL:
+  case ISD::SRL:
+  case ISD::SRA:
+    if (Imm >= 32)
+      return Register();
+    Opc = Opcode == ISD::SHL   ? M65832::SHLR
+          : Opcode == ISD::SRL ? M65832::SHRR
+                               : M65832::SARR;
+    break;
+  }
+  return fastEmitInst_ri(Opc, &M65832::GPRRegClass, Op0,
+                         SignExtend64<32>(Imm));
+}
+
+bool M65832FastISel::fastSelectInstruction(const Instruction *I) {
+  switch (I->getOpcode()) {
+  case Instruction::Load:
+    return selectLoad(I);
+  case Instruction::Store:
+    return selectStore(I);
+  case Instruction::Br:
+    return selectBranch(I);
+  case Instruction::Ret:
+    return selectRet(I);
+  default:
+    return false;
+  }
+}
+
+FastISel *
+llvm::createM65832FastISel(FunctionLoweringInfo &FuncInfo,
+                           const TargetLibraryInfo *LibInfo,
+                           const LibcallLoweringInfo *LibcallLowering) {
+  return new M65832FastISel(FuncInfo, LibInfo, LibcallLowering);
+}
@@ -15,13 +15,194 @@
 #include "M65832InstrInfo.h"
 #include "M65832MachineFunctionInfo.h"
 #include "M65832Subtarget.h"
+#include "llvm/CodeGen/CFIInstBuilder.h"
 #include "llvm/CodeGen/MachineFrameInfo.h"
 #include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/LivePhysRegs.h"
 #include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Support/CommandLine.h"
 
 using namespace llvm;
 
+static cl::opt<bool> FastCCCallerSavedB(
+    "m65832-fastcc-caller-saved-b", cl::Hidden, cl::init(false),
+    cl::desc("Let fastcc functions clobber B instead of saving it; callers "
+             "that use B set it again after such calls"));
+
+static bool isInterruptHandler(const MachineFunction &MF) {
+  return MF.getFunction().hasFnAttribute("interrupt");
+}
+
+/// Returns true if a function of convention \p CC leaves B as its caller
+/// had it: always, unless -m65832-fastcc-caller-saved-b makes B
+/// caller-saved under fastcc.
+static bool preservesB(CallingConv::ID CC) {
+  return !FastCCCallerSavedB || CC != CallingConv::Fast;
+}
+
+/// Returns true if B may hold something else once \p Call returns. Runtime
+/// helpers (external symbols) follow the C convention; an indirect callee's
+/// convention is unknown, so it is taken to clobber B.
+static bool callClobbersB(const MachineInstr &Call) {
+  if (!FastCCCallerSavedB)
+    return false;
+  for (const MachineOperand &MO : Call.operands()) {
+    if (MO.isSymbol())
+      return false;
+    if (MO.isGlobal())
+      if (const auto *F = dyn_cast<Function>(MO.getGlobal()))
+        return !preservesB(F->getCallingConv());
+  }
+  return true;
+}
+
+static bool hasBClobberingCall(const MachineFunction &MF) {
+  if (!FastCCCallerSavedB || !MF.getFrameInfo().hasCalls())
+    return false;
+  for (const MachineBasicBlock &MBB : MF)
+    for (const MachineInstr &MI : MBB)
+      if (MI.isCall() && !MI.isReturn() && callClobbersB(MI))
+        return true;
+  return false;
+}
+
+/// Shortest run of callee-saved GPRs worth a call to the runtime save and
+/// restore helpers: the JSR is 5 bytes against 3 per inline LDA/PHA.
+static constexpr unsigned MinCSRHelperRun = 3;
+
+/// Split CSI into (index, length) groups. At -Os a run of at least
+/// MinCSRHelperRun registers R16.. or R48.. in order forms one group, saved
+/// by __m65832_save_rN_rM; every other entry is a group of its own.
+static void
+getCSRGroups(const MachineFunction &MF, ArrayRef<CalleeSavedInfo> CSI,
+             SmallVectorImpl<std::pair<unsigned, unsigned>> &Groups) {
+  // The helpers are reached by JSR to their absolute address, which -fPIC
+  // code cannot use
+  bool UseHelpers = MF.getFunction().hasOptSize() && !isInterruptHandler(MF) &&
+                    !MF.getTarget().isPositionIndependent();
+  for (unsigned I = 0, E = CSI.size(); I != E;) {
+    Register First = CSI[I].getReg();
+    unsigned Len = 1;
+    if (UseHelpers && (First == M65832::R16 || First == M65832::R48)) {
+      while (I + Len != E && Len != 8 &&
+             CSI[I + Len].getReg() == First + Len)
+        ++Len;
+      if (Len < MinCSRHelperRun)
+        Len = 1;
+    }
+    Groups.push_back({I, Len});
+    I += Len;
+  }
+}
+
+/// Bytes JSR pushes for the return address. An interrupt pushes PC and P;
+/// the handler's usage counts a full word for each.
+static constexpr uint64_t ReturnAddressBytes = 4;
+static constexpr uint64_t InterruptEntryBytes = 8;
+
+/// Fewest B-relative -mcmodel=bank accesses that pay for pointing B at the
+/// data bank: PHB32, SB #__data_bank_base and PLB32 take 10 bytes, and each
+/// access saves 2-3 against its 32-bit absolute form.
+static constexpr unsigned MinDataBankAccesses = 4;
+
+/// The same for -mrelax %bankabs accesses, which the linker shortens by 2
+/// bytes and only when the global lands in the bank.
+static constexpr unsigned MinRelaxDataBankAccesses = 6;
+
+/// Number of global accesses with target flag \p Flags left by instruction
+/// selection.
+static unsigned countDataBankAccesses(const MachineFunction &MF,
+                                      unsigned Flags) {
+  unsigned Count = 0;
+  for (const MachineBasicBlock &MBB : MF)
+    for (const MachineInstr &MI : MBB)
+      for (const MachineOperand &MO : MI.operands())
+        if (MO.isGlobal() && MO.getTargetFlags() == Flags)
+          ++Count;
+  return Count;
+}
+
+/// Fewest FP constant-pool loads that pay for pointing B at the function's
+/// pool: PHB32, SB #.LCPI and PLB32 take 10 bytes, and each LDF B+offset
+/// saves 6 against LD.L R0,#.LCPI; LDF (R0).
+static constexpr unsigned MinLiteralPoolLoads = 2;
+
+/// Number of LDF*_CP constant-pool loads left by instruction selection.
+static unsigned countLiteralPoolLoads(const MachineFunction &MF) {
+  unsigned Count = 0;
+  for (const MachineBasicBlock &MBB : MF)
+    for (const MachineInstr &MI : MBB)
+      if (MI.getOpcode() == M65832::LDF32_CP ||
+          MI.getOpcode() == M65832::LDF64_CP)
+        ++Count;
+  return Count;
+}
+
+/// Bytes of callee-saved GPRs pushed below the locals; FPRs already have
+/// slots in the frame.
+static unsigned getCalleeSavedPushBytes(const MachineFunction &MF) {
+  unsigned Bytes = 0;
+  for (const CalleeSavedInfo &Info : MF.getFrameInfo().getCalleeSavedInfo())
+    if (!M65832::FPR64RegClass.contains(Info.getReg()))
+      Bytes += 4;
+  return Bytes;
+}
+
+/// After a dynamic alloca SP is somewhere below the frame. Put it back
+/// \p Below bytes under B, where the callee-saved GPR pushes left it:
+/// TBX; TXS, or TBX; TXA; SEC; SBC #Below; TAX; TXS.
+static void restoreSPFromFrameBase(MachineBasicBlock &MBB,
+                                   MachineBasicBlock::iterator MI,
+                                   const DebugLoc &DL,
+                                   const M65832InstrInfo &TII,
+                                   unsigned Below) {
+  BuildMI(MBB, MI, DL, TII.get(M65832::TBX), M65832::X);
+  if (Below != 0) {
+    BuildMI(MBB, MI, DL, TII.get(M65832::TXA), M65832::A)
+        .addReg(M65832::X, RegState::Kill);
+    BuildMI(MBB, MI, DL, TII.get(M65832::SEC));
+    BuildMI(MBB, MI, DL, TII.get(M65832::SBC_IMM), M65832::A)
+        .addReg(M65832::A)
+        .addImm(Below);
+    BuildMI(MBB, MI, DL, TII.get(M65832::TAX), M65832::X)
+        .addReg(M65832::A, RegState::Kill);
+  }
+  BuildMI(MBB, MI, DL, TII.get(M65832::TXS))
+      .addReg(M65832::X, RegState::Kill);
+}
+
+/// Frame-index users that have a stack-relative ($xx,S) form after frame
+/// index elimination and pseudo expansion.
+static bool hasStackRelativeForm(unsigned Opcode) {
+  switch (Opcode) {
+  case M65832::LOAD32:
+  case M65832::STORE32:
+  case M65832::LDA_ABS:
+  case M65832::STA_ABS:
+  case M65832::ADD_MEM:
+  case M65832::SUB_MEM:
+  case M65832::AND_MEM:
+  case M65832::ORA_MEM:
+  case M65832::EOR_MEM:
+    return true;
+  default:
+    return false;
+  }
+}
+
+static const char *getCSRHelperName(MachineFunction &MF, bool Save,
+                                    Register First, unsigned Len) {
+  unsigned FirstNum = First - M65832::R0;
+  std::string Name = (Save ? "__m65832_save_r" : "__m65832_restore_r") +
+                     std::to_string(FirstNum) + "_r" +
+                     std::to_string(FirstNum + Len - 1);
+  return MF.createExternalSymbolName(Name);
+}
+
 M65832FrameLowering::M65832FrameLowering(const M65832Subtarget &STI)
     : TargetFrameLowering(TargetFrameLowering::StackGrowsDown,
                           /*StackAlignment=*/Align(4),
@@ -36,8 +217,112 @@ bool M65832FrameLowering::hasFPImpl(const MachineFunction &MF) const {
 }
 
 bool M65832FrameLowering::hasReservedCallFrame(const MachineFunction &MF) const {
-  // Reserve call frame if we don't have variable sized objects
-  return !MF.getFrameInfo().hasVarSizedObjects();
+  // Reserve call frame if we don't have variable sized objects, and no call
+  // pushes its arguments (M65832CallFrameOptimization)
+  return !MF.getFrameInfo().hasVarSizedObjects() &&
+         !MF.getInfo<M65832MachineFunctionInfo>()->hasPushSequences();
+}
+
+bool M65832FrameLowering::needsFrameBase(const MachineFunction &MF) const {
+  const MachineFrameInfo &MFI = MF.getFrameInfo();
+
+  if (hasFP(MF))
+    return true;
+
+  // Frame slots addressed $xx,S, see canAddressFrameFromSP
+  if (MF.getInfo<M65832MachineFunctionInfo>()->usesSPRelativeFrame())
+    return false;
+
+  if (MFI.getStackSize() != 0)
+    return true;
+
+  // Any live stack object (incoming stack arguments included) is addressed
+  // B-relative.
+  for (int FI = MFI.getObjectIndexBegin(), E = MFI.getObjectIndexEnd(); FI != E;
+       ++FI)
+    if (!MFI.isDeadObjectIndex(FI))
+      return true;
+
+  // Explicit uses of B, e.g. from inline asm.
+  return !MF.getRegInfo().reg_nodbg_empty(M65832::B);
+}
+
+bool M65832FrameLowering::canAddressFrameFromSP(
+    const MachineFunction &MF) const {
+  const MachineFrameInfo &MFI = MF.getFrameInfo();
+
+  if (hasFP(MF) || MFI.getStackSize() == 0 ||
+      !MF.getRegInfo().reg_nodbg_empty(M65832::B))
+    return false;
+
+  // Incoming stack arguments and the varargs area are laid out above the
+  // saved B.
+  for (int FI = MFI.getObjectIndexBegin(); FI < 0; ++FI)
+    if (!MFI.isDeadObjectIndex(FI))
+      return false;
+
+  // Locals start StackSize bytes up from SP once ADJSP has run, plus the
+  // callee-saved GPRs pushed after it. Any other push (an A spill, inline
+  // asm) would move the slots out from under a fixed $xx,S offset; calls
+  // leave SP as they found it.
+  int64_t Bias = MFI.getStackSize() + getCalleeSavedPushBytes(MF);
+  for (const MachineBasicBlock &MBB : MF) {
+    for (const MachineInstr &MI : MBB) {
+      if (MI.isInlineAsm())
+        return false;
+      if (!MI.isCall() && !MI.getFlag(MachineInstr::FrameSetup) &&
+          !MI.getFlag(MachineInstr::FrameDestroy) &&
+          MI.modifiesRegister(M65832::SP, /*TRI=*/nullptr))
+        return false;
+
+      for (unsigned I = 0, E = MI.getNumOperands(); I != E; ++I) {
+        const MachineOperand &MO = MI.getOperand(I);
+        if (!MO.isFI())
+          continue;
+        if (!hasStackRelativeForm(MI.getOpcode()))
+          return false;
+        // Same offset as eliminateFrameIndex, without B's SP adjustment
+        int64_t Offset = MFI.getObjectOffset(MO.getIndex()) + Bias;
+        if (I + 1 != E && MI.getOperand(I + 1).isImm())
+          Offset += MI.getOperand(I + 1).getImm();
+        if (!isUInt<8>(Offset))
+          return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool M65832FrameLowering::enableShrinkWrapping(
+    const MachineFunction &MF) const {
+  // An interrupt handler must save A/X/Y/T, and a windowed function move D,
+  // before anything in it can run. B has to point at the data bank or the
+  // literal pool before any B-relative access.
+  return !isInterruptHandler(MF) &&
+         MF.getInfo<M65832MachineFunctionInfo>()->getWindowShift() == 0 &&
+         countDataBankAccesses(MF) == 0 && countLiteralPoolLoads(MF) == 0;
+}
+
+/// Large prologue and epilogue SP adjustments go through A and X and set the
+/// flags, so they can only be placed where none of those are live.
+bool M65832FrameLowering::canUseAsPrologue(
+    const MachineBasicBlock &MBB) const {
+  return !MBB.isLiveIn(M65832::A) && !MBB.isLiveIn(M65832::X);
+}
+
+bool M65832FrameLowering::canUseAsEpilogue(
+    const MachineBasicBlock &MBB) const {
+  // The epilogue goes in front of the terminators.
+  for (const MachineInstr &Term : MBB.terminators())
+    if (Term.readsRegister(M65832::SR, /*TRI=*/nullptr) ||
+        Term.readsRegister(M65832::A, /*TRI=*/nullptr) ||
+        Term.readsRegister(M65832::X, /*TRI=*/nullptr))
+      return false;
+
+  const TargetRegisterInfo &TRI = *Subtarget.getRegisterInfo();
+  LivePhysRegs LiveRegs(TRI);
+  LiveRegs.addLiveOuts(MBB);
+  return !LiveRegs.contains(M65832::A) && !LiveRegs.contains(M65832::X);
 }
 
 void M65832FrameLowering::emitPrologue(MachineFunction &MF,
@@ -51,36 +336,174 @@ void M65832FrameLowering::emitPrologue(MachineFunction &MF,
   if (MBBI != MBB.end())
     DL = MBBI->getDebugLoc();
 
+  // Decide on $xx,S frame addressing before anything below pushes
+  auto *FuncInfo = MF.getInfo<M65832MachineFunctionInfo>();
+  FuncInfo->setCalleeSavedFrameSize(getCalleeSavedPushBytes(MF));
+  FuncInfo->setSPRelativeFrame(canAddressFrameFromSP(MF));
   uint64_t StackSize = MFI.getStackSize();
 
-  // Save B register (B is the frame pointer in M65832)
-  BuildMI(MBB, MBBI, DL, TII.get(M65832::PHB32));
+  // Interrupt handler: push the architectural registers first, A before
+  // anything that goes through it
+  for (MCPhysReg Reg : FuncInfo->getInterruptSavedRegs()) {
+    if (Reg != M65832::T)
+      MBB.addLiveIn(Reg);
+    switch (Reg) {
+    case M65832::A:
+      BuildMI(MBB, MBBI, DL, TII.get(M65832::PHA)).addReg(M65832::A);
+      break;
+    case M65832::X:
+      BuildMI(MBB, MBBI, DL, TII.get(M65832::PHX)).addReg(M65832::X);
+      break;
+    case M65832::Y:
+      BuildMI(MBB, MBBI, DL, TII.get(M65832::PHY));
+      break;
+    case M65832::T:
+      BuildMI(MBB, MBBI, DL, TII.get(M65832::TTA), M65832::A);
+      BuildMI(MBB, MBBI, DL, TII.get(M65832::PHA))
+          .addReg(M65832::A, RegState::Kill);
+      break;
+    default:
+      llvm_unreachable("Unexpected interrupt-saved register");
+    }
+  }
 
-  // Allocate stack frame if needed
-  if (StackSize != 0) {
-    // Adjust stack pointer: SP = SP - StackSize
-    // TSX; TXA; SEC; SBC #stacksize; TAX; TXS
-    BuildMI(MBB, MBBI, DL, TII.get(M65832::TSX), M65832::X);
-    BuildMI(MBB, MBBI, DL, TII.get(M65832::TXA), M65832::A)
-        .addReg(M65832::X);
+  // Windowed function: save D, then move it down to a fresh window.
+  // PHD32; PHD32; PLA; SEC; SBC #bytes; PHA; PLD32
+  if (unsigned Shift = FuncInfo->getWindowShift()) {
+    BuildMI(MBB, MBBI, DL, TII.get(M65832::PHD32));
+    BuildMI(MBB, MBBI, DL, TII.get(M65832::PHD32));
+    BuildMI(MBB, MBBI, DL, TII.get(M65832::PLA), M65832::A);
     BuildMI(MBB, MBBI, DL, TII.get(M65832::SEC));
     BuildMI(MBB, MBBI, DL, TII.get(M65832::SBC_IMM), M65832::A)
         .addReg(M65832::A)
-        .addImm(StackSize);
-    BuildMI(MBB, MBBI, DL, TII.get(M65832::TAX), M65832::X)
-        .addReg(M65832::A);
-    BuildMI(MBB, MBBI, DL, TII.get(M65832::TXS))
-        .addReg(M65832::X);
+        .addImm(M65832InstrInfo::getDPOffset(Shift));
+    BuildMI(MBB, MBBI, DL, TII.get(M65832::PHA))
+        .addReg(M65832::A, RegState::Kill);
+    BuildMI(MBB, MBBI, DL, TII.get(M65832::PLD32));
   }
 
+  if (!needsFrameBase(MF)) {
+    // -mcmodel=bank: with B free, point it at the data bank so globals
+    // there are reached B+%bankrel(sym) instead of by 32-bit address.
+    // -mrelax leaves that choice for the other globals to the linker.
+    unsigned BankAccesses = countDataBankAccesses(MF, M65832II::MO_BANKREL);
+    unsigned RelaxAccesses = countDataBankAccesses(MF, M65832II::MO_BANKABS);
+    if (BankAccesses >= MinDataBankAccesses ||
+        BankAccesses + RelaxAccesses >= MinRelaxDataBankAccesses) {
+      FuncInfo->setUsesDataBank(true);
+    } else if (countLiteralPoolLoads(MF) >= MinLiteralPoolLoads) {
+      // Otherwise point it at the function's constant pool, which
+      // M65832AsmPrinter then keeps in one section starting at .LCPI<n>_0,
+      // and load FP constants as LDF B+(.LCPI<n>_k - .LCPI<n>_0)
+      FuncInfo->setUsesLiteralPool(true);
+    }
+
+    // B is saved if the function or a callee changes it, and the caller
+    // expects it back
+    bool PushedB = (FuncInfo->usesDataBank() || FuncInfo->usesLiteralPool() ||
+                    hasBClobberingCall(MF)) &&
+                   preservesB(MF.getFunction().getCallingConv());
+    FuncInfo->setSavedB(PushedB);
+    if (PushedB)
+      BuildMI(MBB, MBBI, DL, TII.get(M65832::PHB32));
+    if (FuncInfo->usesDataBank())
+      BuildMI(MBB, MBBI, DL, TII.get(M65832::SB_IMM))
+          .addExternalSymbol("__data_bank_base");
+    else if (FuncInfo->usesLiteralPool())
+      BuildMI(MBB, MBBI, DL, TII.get(M65832::SB_IMM)).addConstantPoolIndex(0);
+
+    // Locals addressed $xx,S go below whatever B was pushed for
+    if (FuncInfo->usesSPRelativeFrame())
+      BuildMI(MBB, MBBI, DL, TII.get(M65832::ADJSP))
+          .addImm(-(int64_t)StackSize);
+    emitPrologueCFI(MF, MBB, MBBI, /*FrameBase=*/false, PushedB,
+                    FuncInfo->usesSPRelativeFrame() ? StackSize : 0);
+    return;
+  }
+
+  // Save B register (B is the frame pointer in M65832). A fastcc function
+  // that may clobber it still pushes it when stack arguments or the return
+  // address are addressed from B, as their offsets allow for the push.
+  bool PushedB = preservesB(MF.getFunction().getCallingConv()) ||
+                 MFI.isReturnAddressTaken() || MFI.isFrameAddressTaken();
+  for (int FI = MFI.getObjectIndexBegin(); FI < 0 && !PushedB; ++FI)
+    PushedB = !MFI.isDeadObjectIndex(FI);
+  FuncInfo->setHasFrameBase(true);
+  FuncInfo->setSavedB(PushedB);
+  if (PushedB)
+    BuildMI(MBB, MBBI, DL, TII.get(M65832::PHB32));
+
+  // Allocate stack frame if needed: SP = SP - StackSize
+  if (StackSize != 0)
+    BuildMI(MBB, MBBI, DL, TII.get(M65832::ADJSP))
+        .addImm(-(int64_t)StackSize);
+
   // Set B = SP (frame base for B+offset addressing of locals)
   // Use TSPB instruction to transfer SP to B directly
   BuildMI(MBB, MBBI, DL, TII.get(M65832::TSPB));
+
+  emitPrologueCFI(MF, MBB, MBBI, /*FrameBase=*/true, PushedB, StackSize);
+}
+
+/// Describe the frame once the prologue and the callee-saved spills after
+/// \p MBBI have run. Only calls throw, and none come before the spills end
+/// (the -Os save helpers do not unwind), so one set of directives there
+/// covers the whole body. B is at CFA-ReturnAddressBytes-4 (after D for a
+/// windowed function) when \p PushedB, and \p LocalBytes were allocated
+/// below it. With \p FrameBase the CFA follows B, which stays put across
+/// dynamic allocas; otherwise it is a fixed offset from SP.
+void M65832FrameLowering::emitPrologueCFI(MachineFunction &MF,
+                                          MachineBasicBlock &MBB,
+                                          MachineBasicBlock::iterator MBBI,
+                                          bool FrameBase, bool PushedB,
+                                          uint64_t LocalBytes) const {
+  // An interrupt frame is never unwound through
+  if (!MF.needsFrameMoves() || isInterruptHandler(MF))
+    return;
+
+  while (MBBI != MBB.end() && MBBI->getFlag(MachineInstr::FrameSetup))
+    ++MBBI;
+
+  const MachineFrameInfo &MFI = MF.getFrameInfo();
+  auto *FuncInfo = MF.getInfo<M65832MachineFunctionInfo>();
+  CFIInstBuilder CFIBuilder(MBB, MBBI, MachineInstr::FrameSetup);
+
+  int64_t CFAOffset = ReturnAddressBytes;
+  if (FuncInfo->getWindowShift()) {
+    CFAOffset += 4;
+    CFIBuilder.buildOffset(M65832::D, -CFAOffset);
+  }
+  if (PushedB) {
+    CFAOffset += 4;
+    CFIBuilder.buildOffset(M65832::B, -CFAOffset);
+  }
+  CFAOffset += LocalBytes;
+
+  // GPRs are pushed in CSI order below the locals; FPRs are in frame slots
+  // LocalBytes - CFAOffset + their object offset from the CFA
+  int64_t PushOffset = CFAOffset;
+  for (const CalleeSavedInfo &Info : MFI.getCalleeSavedInfo()) {
+    Register Reg = Info.getReg();
+    if (M65832::FPR64RegClass.contains(Reg)) {
+      int64_t Slot = MFI.getObjectOffset(Info.getFrameIdx());
+      CFIBuilder.buildOffset(Reg, Slot + (int64_t)LocalBytes - CFAOffset);
+      continue;
+    }
+    PushOffset += 4;
+    CFIBuilder.buildOffset(Reg, -PushOffset);
+  }
+
+  if (FrameBase)
+    CFIBuilder.buildDefCFA(M65832::B, CFAOffset);
+  else
+    CFIBuilder.buildDefCFAOffset(PushOffset);
 }
 
 void M65832FrameLowering::emitEpilogue(MachineFunction &MF,
                                         MachineBasicBlock &MBB) const {
-  MachineBasicBlock::iterator MBBI = MBB.getLastNonDebugInstr();
+  // With shrink-wrapping the restore block need not end in RTS, so insert
+  // before whatever terminators it has (or at the end for a fall-through).
+  MachineBasicBlock::iterator MBBI = MBB.getFirstTerminator();
   MachineFrameInfo &MFI = MF.getFrameInfo();
   const M65832InstrInfo &TII =
       *static_cast<const M65832InstrInfo *>(Subtarget.getInstrInfo());
@@ -88,74 +511,159 @@ void M65832FrameLowering::emitEpilogue(MachineFunction &MF,
 
   if (MBBI != MBB.end())
     DL = MBBI->getDebugLoc();
+  else if (!MBB.empty())
+    DL = MBB.back().getDebugLoc();
 
   uint64_t StackSize = MFI.getStackSize();
+  auto *FuncInfo = MF.getInfo<M65832MachineFunctionInfo>();
 
-  // Deallocate stack frame if needed
-  if (StackSize > 0) {
-    // Restore SP by adding StackSize: SP = SP + StackSize
-    BuildMI(MBB, MBBI, DL, TII.get(M65832::TSX), M65832::X);
-    BuildMI(MBB, MBBI, DL, TII.get(M65832::TXA), M65832::A)
-        .addReg(M65832::X);
-    BuildMI(MBB, MBBI, DL, TII.get(M65832::CLC));
-    BuildMI(MBB, MBBI, DL, TII.get(M65832::ADC_IMM), M65832::A)
-        .addReg(M65832::A)
-        .addImm(StackSize);
-    BuildMI(MBB, MBBI, DL, TII.get(M65832::TAX), M65832::X)
-        .addReg(M65832::A);
-    BuildMI(MBB, MBBI, DL, TII.get(M65832::TXS))
-        .addReg(M65832::X);
+  // Locals addressed $xx,S, freed before a data-bank or literal-pool B
+  // is popped
+  if (FuncInfo->usesSPRelativeFrame())
+    BuildMI(MBB, MBBI, DL, TII.get(M65832::ADJSP)).addImm(StackSize);
+
+  if (!FuncInfo->hasFrameBase()) {
+    // Frameless, B pushed for the data bank, the literal pool or a callee
+    if (FuncInfo->savedB())
+      BuildMI(MBB, MBBI, DL, TII.get(M65832::PLB32));
+  } else {
+    // Dynamic allocas: SP back to B first, unless restoring the pushed
+    // GPRs already did
+    if (MFI.hasVarSizedObjects() && getCalleeSavedPushBytes(MF) == 0)
+      restoreSPFromFrameBase(MBB, MBBI, DL, TII, 0);
+
+    // Deallocate stack frame if needed: SP = SP + StackSize
+    if (StackSize != 0)
+      BuildMI(MBB, MBBI, DL, TII.get(M65832::ADJSP)).addImm(StackSize);
+
+    // Restore B register (frame pointer) before RTS
+    if (FuncInfo->savedB())
+      BuildMI(MBB, MBBI, DL, TII.get(M65832::PLB32));
   }
 
-  // Restore B register (frame pointer) before RTS
-  BuildMI(MBB, MBBI, DL, TII.get(M65832::PLB32));
+  // Windowed function: back to the caller's window
+  if (FuncInfo->getWindowShift() != 0)
+    BuildMI(MBB, MBBI, DL, TII.get(M65832::PLD32));
+
+  // Interrupt handler: pop the architectural registers last, right before
+  // RTI, so the frame teardown above may still use them
+  for (MCPhysReg Reg : llvm::reverse(FuncInfo->getInterruptSavedRegs())) {
+    switch (Reg) {
+    case M65832::A:
+      BuildMI(MBB, MBBI, DL, TII.get(M65832::PLA), M65832::A);
+      break;
+    case M65832::X:
+      BuildMI(MBB, MBBI, DL, TII.get(M65832::PLX), M65832::X);
+      break;
+    case M65832::Y:
+      BuildMI(MBB, MBBI, DL, TII.get(M65832::PLY));
+      break;
+    case M65832::T:
+      BuildMI(MBB, MBBI, DL, TII.get(M65832::PLA), M65832::A);
+      BuildMI(MBB, MBBI, DL, TII.get(M65832::TAT))
+          .addReg(M65832::A, RegState::Kill);
+      break;
+    default:
+      llvm_unreachable("Unexpected interrupt-saved register");
+    }
+  }
+}
+
+/// Point B back at whatever the function uses it for once a call that
+/// clobbers it returns. The frame base is SP plus the callee-saved GPR
+/// pushes: TSPB, or TSX; TXA; CLC; ADC #bytes; TAB. With dynamic allocas
+/// SP is no guide, so B is pushed around the call instead (see
+/// eliminateCallFramePseudoInstr).
+static void emitBRestore(MachineFunction &MF, MachineBasicBlock &MBB,
+                         MachineBasicBlock::iterator MI, const DebugLoc &DL,
+                         const M65832InstrInfo &TII) {
+  auto *FuncInfo = MF.getInfo<M65832MachineFunctionInfo>();
+  if (FuncInfo->usesDataBank()) {
+    BuildMI(MBB, MI, DL, TII.get(M65832::SB_IMM))
+        .addExternalSymbol("__data_bank_base");
+  } else if (FuncInfo->usesLiteralPool()) {
+    BuildMI(MBB, MI, DL, TII.get(M65832::SB_IMM)).addConstantPoolIndex(0);
+  } else if (FuncInfo->hasFrameBase()) {
+    if (MF.getFrameInfo().hasVarSizedObjects()) {
+      BuildMI(MBB, MI, DL, TII.get(M65832::PLB32));
+      return;
+    }
+    unsigned Bytes = FuncInfo->getCalleeSavedFrameSize();
+    if (Bytes == 0) {
+      BuildMI(MBB, MI, DL, TII.get(M65832::TSPB));
+      return;
+    }
+    BuildMI(MBB, MI, DL, TII.get(M65832::TSX), M65832::X);
+    BuildMI(MBB, MI, DL, TII.get(M65832::TXA), M65832::A)
+        .addReg(M65832::X, RegState::Kill);
+    BuildMI(MBB, MI, DL, TII.get(M65832::CLC));
+    BuildMI(MBB, MI, DL, TII.get(M65832::ADC_IMM), M65832::A)
+        .addReg(M65832::A)
+        .addImm(Bytes);
+    BuildMI(MBB, MI, DL, TII.get(M65832::TAB))
+        .addReg(M65832::A, RegState::Kill);
+  }
 }
 
 MachineBasicBlock::iterator M65832FrameLowering::eliminateCallFramePseudoInstr(
     MachineFunction &MF, MachineBasicBlock &MBB,
     MachineBasicBlock::iterator MI) const {
-  // If we have a reserved call frame, these are no-ops
-  if (hasReservedCallFrame(MF))
-    return MBB.erase(MI);
-
-  // Otherwise, adjust the stack pointer
   const M65832InstrInfo &TII =
       *static_cast<const M65832InstrInfo *>(Subtarget.getInstrInfo());
   DebugLoc DL = MI->getDebugLoc();
-  
-  int64_t Amount = MI->getOperand(0).getImm();
-  
-  if (Amount == 0)
+  bool IsSetup = MI->getOpcode() == M65832::ADJCALLSTACKDOWN;
+
+  // The call this sequence brackets, when B has to survive it
+  auto *FuncInfo = MF.getInfo<M65832MachineFunctionInfo>();
+  bool RestoreB = false;
+  if (FuncInfo->hasFrameBase() || FuncInfo->usesDataBank() ||
+      FuncInfo->usesLiteralPool()) {
+    MachineBasicBlock::iterator Call = MI;
+    if (IsSetup)
+      while (Call != MBB.end() && !Call->isCall())
+        ++Call;
+    else
+      while (Call != MBB.begin() && !Call->isCall())
+        --Call;
+    RestoreB = Call == MBB.end() || !Call->isCall() || callClobbersB(*Call);
+  }
+  bool PushB = RestoreB && MF.getFrameInfo().hasVarSizedObjects();
+
+  // If we have a reserved call frame, these are no-ops
+  if (hasReservedCallFrame(MF)) {
+    if (RestoreB && !IsSetup)
+      emitBRestore(MF, MBB, MI, DL, TII);
     return MBB.erase(MI);
-  
-  if (MI->getOpcode() == M65832::ADJCALLSTACKDOWN) {
-    // Subtract from SP
-    BuildMI(MBB, MI, DL, TII.get(M65832::TSX), M65832::X);
-    BuildMI(MBB, MI, DL, TII.get(M65832::TXA), M65832::A)
-        .addReg(M65832::X);
-    BuildMI(MBB, MI, DL, TII.get(M65832::SEC));
-    BuildMI(MBB, MI, DL, TII.get(M65832::SBC_IMM), M65832::A)
-        .addReg(M65832::A)
-        .addImm(Amount);
-    BuildMI(MBB, MI, DL, TII.get(M65832::TAX), M65832::X)
-        .addReg(M65832::A);
-    BuildMI(MBB, MI, DL, TII.get(M65832::TXS))
-        .addReg(M65832::X);
-  } else {
-    // ADJCALLSTACKUP - add to SP
-    BuildMI(MBB, MI, DL, TII.get(M65832::TSX), M65832::X);
-    BuildMI(MBB, MI, DL, TII.get(M65832::TXA), M65832::A)
-        .addReg(M65832::X);
-    BuildMI(MBB, MI, DL, TII.get(M65832::CLC));
-    BuildMI(MBB, MI, DL, TII.get(M65832::ADC_IMM), M65832::A)
-        .addReg(M65832::A)
-        .addImm(Amount);
-    BuildMI(MBB, MI, DL, TII.get(M65832::TAX), M65832::X)
-        .addReg(M65832::A);
-    BuildMI(MBB, MI, DL, TII.get(M65832::TXS))
-        .addReg(M65832::X);
   }
-  
+
+  // Otherwise, adjust the stack pointer. A push sequence has already
+  // taken operand 1 bytes of the ADJCALLSTACKDOWN amount out of operand 0;
+  // ADJCALLSTACKUP frees the whole call frame. B, pushed above the call
+  // frame, comes off after it.
+  if (PushB && IsSetup)
+    BuildMI(MBB, MI, DL, TII.get(M65832::PHB32));
+  int64_t Amount = MI->getOperand(0).getImm();
+  if (IsSetup)
+    Amount = -Amount;
+  if (Amount != 0)
+    BuildMI(MBB, MI, DL, TII.get(M65832::ADJSP)).addImm(Amount);
+  if (RestoreB && !IsSetup)
+    emitBRestore(MF, MBB, MI, DL, TII);
+
+  // A CFA taken from SP moves with every adjustment and push up to the
+  // call, and back after it
+  if (MF.needsFrameMoves() && !isInterruptHandler(MF) &&
+      !FuncInfo->hasFrameBase()) {
+    if (Amount != 0)
+      CFIInstBuilder(MBB, MI, MachineInstr::NoFlags)
+          .buildAdjustCFAOffset(-Amount);
+    if (IsSetup)
+      for (auto I = std::next(MI); I != MBB.end() && !I->isCall(); ++I)
+        if (I->getOpcode() == M65832::PUSH32)
+          CFIInstBuilder(MBB, std::next(I), MachineInstr::NoFlags)
+              .buildAdjustCFAOffset(4);
+  }
+
   return MBB.erase(MI);
 }
 
@@ -166,6 +674,73 @@ void M65832FrameLowering::determineCalleeSaves(MachineFunction &MF,
   
   // R29 is kernel-reserved, so it should never be in SavedRegs
   // B register (frame pointer) is handled via PHB/PLB in prologue/epilogue
+
+  if (!isInterruptHandler(MF))
+    return;
+
+  // The interrupted code may be holding anything in A, X, Y or T. A is
+  // always saved: spills, restores and most expansions go through it. X and
+  // Y are also used by the prologue/epilogue SP adjustment, which any stack
+  // object or spill slot brings in. Callees may clobber T (MUL/DIV).
+  const MachineFrameInfo &MFI = MF.getFrameInfo();
+  const MachineRegisterInfo &MRI = MF.getRegInfo();
+  bool AdjustsSP = SavedRegs.any() || MFI.estimateStackSize(MF) != 0;
+
+  SmallVector<MCPhysReg, 4> Regs = {M65832::A};
+  if (MFI.hasCalls() || MRI.isPhysRegModified(M65832::T))
+    Regs.push_back(M65832::T);
+  if (AdjustsSP || MFI.hasCalls() || MRI.isPhysRegModified(M65832::X))
+    Regs.push_back(M65832::X);
+  if (AdjustsSP || MFI.hasCalls() || MRI.isPhysRegModified(M65832::Y))
+    Regs.push_back(M65832::Y);
+  MF.getInfo<M65832MachineFunctionInfo>()->setInterruptSavedRegs(Regs);
+}
+
+void M65832FrameLowering::processFunctionBeforeFrameFinalized(
+    MachineFunction &MF, RegScavenger *RS) const {
+  // The prologue never realigns SP, so an i64 or f64 slot (or a struct
+  // holding one) laid out at 8 only gets padding: at run time it is 4-byte
+  // aligned like the stack. Every load and store, LDF/STF included, takes
+  // a 4-byte aligned address, as the 4-byte varargs slots already rely on.
+  // Wider alignments were asked for explicitly and are left alone.
+  MachineFrameInfo &MFI = MF.getFrameInfo();
+  for (int FI = 0, E = MFI.getObjectIndexEnd(); FI != E; ++FI)
+    if (!MFI.isDeadObjectIndex(FI) && MFI.getObjectAlign(FI) == Align(8))
+      MFI.setObjectAlignment(FI, getStackAlign());
+}
+
+void M65832FrameLowering::orderFrameObjects(
+    const MachineFunction &MF, SmallVectorImpl<int> &ObjectsToAllocate) const {
+  // PEI puts the first object furthest from B (or SP) and the last one at
+  // the smallest offset. $xx,S only reaches 255 bytes, so the spill slots
+  // and scalars with the most accesses per byte go last and a large array
+  // that is touched once goes first. Among equals, wider alignments go
+  // first, which keeps the byte and halfword objects together at the end
+  // instead of each padding out the slot after it.
+  if (ObjectsToAllocate.size() < 2)
+    return;
+
+  const MachineFrameInfo &MFI = MF.getFrameInfo();
+  SmallVector<unsigned, 32> Uses(MFI.getObjectIndexEnd());
+  for (const MachineBasicBlock &MBB : MF)
+    for (const MachineInstr &MI : MBB) {
+      if (MI.isDebugInstr())
+        continue;
+      for (const MachineOperand &MO : MI.operands())
+        if (MO.isFI() && MO.getIndex() >= 0)
+          ++Uses[MO.getIndex()];
+    }
+
+  auto Size = [&](int FI) {
+    return std::max<uint64_t>(MFI.getObjectSize(FI), 1);
+  };
+  llvm::stable_sort(ObjectsToAllocate, [&](int L, int R) {
+    uint64_t DensityL = uint64_t(Uses[L]) * Size(R);
+    uint64_t DensityR = uint64_t(Uses[R]) * Size(L);
+    if (DensityL != DensityR)
+      return DensityL < DensityR;
+    return MFI.getObjectAlign(L) > MFI.getObjectAlign(R);
+  });
 }
 
 StackOffset
@@ -175,7 +750,15 @@ M65832FrameLowering::getFrameIndexReference(const MachineFunction &MF, int FI,
   
   // Calculate offset from frame register
   int64_t Offset = MFI.getObjectOffset(FI);
-  
+
+  // No frame base: the locals sit above the pushed callee-saved GPRs
+  const auto *FuncInfo = MF.getInfo<M65832MachineFunctionInfo>();
+  if (FuncInfo->usesSPRelativeFrame()) {
+    FrameReg = M65832::SP;
+    return StackOffset::getFixed(Offset + MFI.getStackSize() +
+                                 FuncInfo->getCalleeSavedFrameSize());
+  }
+
   // Use B as frame base
   FrameReg = M65832::B;
   
@@ -194,6 +777,38 @@ M65832FrameLowering::getFrameIndexReference(const MachineFunction &MF, int FI,
   return StackOffset::getFixed(Offset);
 }
 
+uint64_t M65832FrameLowering::getStackUsage(const MachineFunction &MF) const {
+  const MachineFrameInfo &MFI = MF.getFrameInfo();
+  const auto *FuncInfo = MF.getInfo<M65832MachineFunctionInfo>();
+
+  uint64_t Usage = isInterruptHandler(MF) ? InterruptEntryBytes
+                                          : ReturnAddressBytes;
+  Usage += 4 * FuncInfo->getInterruptSavedRegs().size();
+
+  // PHD32; PHD32; PLA; ...; PHA; PLD32 peaks two words down and leaves one
+  uint64_t WindowPeak = 0;
+  if (FuncInfo->getWindowShift()) {
+    WindowPeak = Usage + 8;
+    Usage += 4;
+  }
+
+  // B is pushed by the prologue (frame base, data bank or literal pool)
+  // and again, briefly, by each CAS or LLI/SCI sequence. Those never
+  // nest, so count at most two.
+  unsigned BPushes = 0;
+  for (const MachineBasicBlock &MBB : MF)
+    for (const MachineInstr &MI : MBB)
+      if (MI.getOpcode() == M65832::PHB32)
+        ++BPushes;
+  Usage += 4 * std::min(BPushes, 2u);
+
+  // GPRs go on the stack with PHA (inline or in the -Os helpers)
+  Usage += getCalleeSavedPushBytes(MF);
+
+  Usage += MFI.getStackSize();
+  return std::max(Usage, WindowPeak);
+}
+
 bool M65832FrameLowering::spillCalleeSavedRegisters(
     MachineBasicBlock &MBB, MachineBasicBlock::iterator MI,
     ArrayRef<CalleeSavedInfo> CSI, const TargetRegisterInfo *TRI) const {
@@ -206,20 +821,53 @@ bool M65832FrameLowering::spillCalleeSavedRegisters(
   if (MI != MBB.end())
     DL = MI->getDebugLoc();
 
+  MachineFunction &MF = *MBB.getParent();
+  SmallVector<std::pair<unsigned, unsigned>, 16> Groups;
+  getCSRGroups(MF, CSI, Groups);
+
   // Save each callee-saved register by pushing to stack
   // For M65832, we save GPRs via: LDA $dp; PHA
-  for (const CalleeSavedInfo &Info : CSI) {
+  // A run of GPRs at -Os is pushed in the same order by one JSR to a
+  // runtime helper, which also uses X (never live here, see
+  // canUseAsPrologue)
+  // FPU registers go to their spill slots (STF, B-relative)
+  for (auto [Idx, Len] : Groups) {
+    const CalleeSavedInfo &Info = CSI[Idx];
     Register Reg = Info.getReg();
+
+    if (Len > 1) {
+      BuildMI(MBB, MI, DL, TII.get(M65832::JSR_CSR))
+          .addExternalSymbol(getCSRHelperName(MF, true, Reg, Len))
+          .setMIFlag(MachineInstr::FrameSetup);
+      continue;
+    }
+
+    if (M65832::FPR64RegClass.contains(Reg)) {
+      // Flagged like the pushes, so emitPrologueCFI can find the end of
+      // the spills
+      MachineBasicBlock::iterator Begin =
+          MI == MBB.begin() ? MBB.end() : std::prev(MI);
+      TII.storeRegToStackSlot(MBB, MI, Reg, !MBB.isLiveIn(Reg),
+                              Info.getFrameIdx(), &M65832::FPR64RegClass,
+                              Register());
+      Begin = Begin == MBB.end() ? MBB.begin() : std::next(Begin);
+      for (MachineInstr &Spill : make_range(Begin, MI))
+        Spill.setFlag(MachineInstr::FrameSetup);
+      continue;
+    }
     
     // Get the DP offset for this register
     unsigned RegNum = Reg - M65832::R0;
     unsigned DPOffset = M65832InstrInfo::getDPOffset(RegNum);
     
-    // LDA from DP location, then push
+    // LDA from DP location, then push. The pushes are flagged so
+    // canAddressFrameFromSP can tell them from other SP changes.
     BuildMI(MBB, MI, DL, TII.get(M65832::LDA_DP), M65832::A)
-        .addImm(DPOffset);
+        .addImm(DPOffset)
+        .setMIFlag(MachineInstr::FrameSetup);
     BuildMI(MBB, MI, DL, TII.get(M65832::PHA))
-        .addReg(M65832::A, RegState::Kill);
+        .addReg(M65832::A, RegState::Kill)
+        .setMIFlag(MachineInstr::FrameSetup);
   }
   
   return true;
@@ -237,19 +885,45 @@ bool M65832FrameLowering::restoreCalleeSavedRegisters(
   if (MI != MBB.end())
     DL = MI->getDebugLoc();
 
+  MachineFunction &MF = *MBB.getParent();
+  SmallVector<std::pair<unsigned, unsigned>, 16> Groups;
+  getCSRGroups(MF, CSI, Groups);
+
+  // Dynamic allocas: SP back to the last pushed GPR before popping
+  if (MF.getFrameInfo().hasVarSizedObjects())
+    if (unsigned Bytes = getCalleeSavedPushBytes(MF))
+      restoreSPFromFrameBase(MBB, MI, DL, TII, Bytes);
+
   // Restore each callee-saved register by popping from stack (reverse order)
-  for (auto I = CSI.rbegin(), E = CSI.rend(); I != E; ++I) {
+  for (auto G = Groups.rbegin(), GE = Groups.rend(); G != GE; ++G) {
+    auto [Idx, Len] = *G;
+    auto I = &CSI[Idx];
     Register Reg = I->getReg();
+
+    if (Len > 1) {
+      BuildMI(MBB, MI, DL, TII.get(M65832::JSR_CSR))
+          .addExternalSymbol(getCSRHelperName(MF, false, Reg, Len))
+          .setMIFlag(MachineInstr::FrameDestroy);
+      continue;
+    }
+
+    if (M65832::FPR64RegClass.contains(Reg)) {
+      TII.loadRegFromStackSlot(MBB, MI, Reg, I->getFrameIdx(),
+                               &M65832::FPR64RegClass, Register(), 0);
+      continue;
+    }
     
     // Get the DP offset for this register
     unsigned RegNum = Reg - M65832::R0;
     unsigned DPOffset = M65832InstrInfo::getDPOffset(RegNum);
     
     // Pop into A, then store to DP location
-    BuildMI(MBB, MI, DL, TII.get(M65832::PLA), M65832::A);
+    BuildMI(MBB, MI, DL, TII.get(M65832::PLA), M65832::A)
+        .setMIFlag(MachineInstr::FrameDestroy);
     BuildMI(MBB, MI, DL, TII.get(M65832::STA_DP))
         .addReg(M65832::A, RegState::Kill)
-        .addImm(DPOffset);
+        .addImm(DPOffset)
+        .setMIFlag(MachineInstr::FrameDestroy);
   }
   
   return true;
@@ -31,6 +31,22 @@ public:
   bool hasFPImpl(const MachineFunction &MF) const override;
   bool hasReservedCallFrame(const MachineFunction &MF) const override;
 
+  bool enableShrinkWrapping(const MachineFunction &MF) const override;
+  bool canUseAsPrologue(const MachineBasicBlock &MBB) const override;
+  bool canUseAsEpilogue(const MachineBasicBlock &MBB) const override;
+
+  /// Returns true if the function needs B saved and pointed at its frame.
+  /// Leaf-style functions with no stack objects run frameless: no PHB32,
+  /// TSPB or PLB32, just the body and RTS.
+  bool needsFrameBase(const MachineFunction &MF) const;
+
+  /// Returns true if every frame slot can be addressed $xx,S instead, so B
+  /// stays free. This needs SP fixed across the body (no dynamic allocas and
+  /// no pushes besides the callee-saved GPRs), no incoming stack arguments,
+  /// and only accesses that have a stack-relative form, all within 255
+  /// bytes of SP.
+  bool canAddressFrameFromSP(const MachineFunction &MF) const;
+
   MachineBasicBlock::iterator
   eliminateCallFramePseudoInstr(MachineFunction &MF, MachineBasicBlock &MBB,
                                 MachineBasicBlock::iterator MI) const override;
@@ -38,9 +54,28 @@ public:
   void determineCalleeSaves(MachineFunction &MF, BitVector &SavedRegs,
                             RegScavenger *RS = nullptr) const override;
 
+  /// Drops the 8-byte alignment of i64/f64 slots to the stack's 4, which
+  /// is all they get at run time anyway.
+  void processFunctionBeforeFrameFinalized(
+      MachineFunction &MF, RegScavenger *RS = nullptr) const override;
+
+  /// Puts the objects with the most accesses per byte at the smallest
+  /// B- or SP-relative offsets.
+  void orderFrameObjects(const MachineFunction &MF,
+                         SmallVectorImpl<int> &ObjectsToAllocate) const override;
+
   StackOffset getFrameIndexReference(const MachineFunction &MF, int FI,
                                      Register &FrameReg) const override;
 
+  void emitPrologueCFI(MachineFunction &MF, MachineBasicBlock &MBB,
+                       MachineBasicBlock::iterator MBBI, bool FrameBase,
+                       bool PushedB, uint64_t LocalBytes) const;
+
+  /// The frame plus everything pushed around it: the return address, the
+  /// interrupt-saved registers, D for a windowed function, B and the
+  /// callee-saved GPRs.
+  uint64_t getStackUsage(const MachineFunction &MF) const override;
+
   bool spillCalleeSavedRegisters(MachineBasicBlock &MBB,
                                   MachineBasicBlock::iterator MI,
                                   ArrayRef<CalleeSavedInfo> CSI,
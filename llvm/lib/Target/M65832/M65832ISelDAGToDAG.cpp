@@ -13,6 +13,7 @@
 #include "M65832.h"
 #include "M65832Subtarget.h"
 #include "M65832TargetMachine.h"
+#include "M65832TargetObjectFile.h"
 #include "llvm/CodeGen/MachineFrameInfo.h"
 #include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineInstrBuilder.h"
@@ -23,8 +24,10 @@
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/Function.h"
+#include "llvm/IR/GlobalVariable.h"
 #include "llvm/IR/InlineAsm.h"
 #include "llvm/IR/Intrinsics.h"
+#include "llvm/IR/IntrinsicsM65832.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
@@ -52,6 +55,14 @@ public:
   void Select(SDNode *N) override;
 
   bool selectAddr(SDValue N, SDValue &Base, SDValue &Offset);
+  bool selectAddrFI(SDValue N, SDValue &Base, SDValue &Offset);
+  bool selectAddrRR(SDValue N, SDValue &Base, SDValue &Index);
+  bool selectAddrGR(SDValue N, SDValue &Addr, SDValue &Index);
+  bool selectAddrFP(SDValue N, SDValue &Base, SDValue &Offset);
+  bool selectAddrGP(SDValue N, SDValue &Base, SDValue &Offset);
+  bool selectAddrTP(SDValue N, SDValue &Base, SDValue &Offset);
+  bool selectAddrBank(SDValue N, SDValue &Offset);
+  bool selectAddrDP(SDValue N, SDValue &Offset);
 
   bool SelectInlineAsmMemoryOperand(const SDValue &Op,
                                     InlineAsm::ConstraintCode ConstraintCode,
@@ -62,6 +73,7 @@ public:
 
 private:
   bool selectFrameIndex(SDNode *N);
+  bool tryBitfieldExtract(SDNode *N);
 };
 
 class M65832DAGToDAGISelLegacy : public SelectionDAGISelLegacy {
@@ -90,12 +102,34 @@ void M65832DAGToDAGISel::Select(SDNode *N) {
     if (selectFrameIndex(N))
       return;
     break;
+  case ISD::ADD:
+  case ISD::OR:
+    // &slot + imm used as a value: fold the offset into LEA_FI
+    if (CurDAG->isBaseWithConstantOffset(SDValue(N, 0)) &&
+        isa<FrameIndexSDNode>(N->getOperand(0))) {
+      SDLoc DL(N);
+      int FI = cast<FrameIndexSDNode>(N->getOperand(0))->getIndex();
+      int64_t Off = cast<ConstantSDNode>(N->getOperand(1))->getSExtValue();
+      ReplaceNode(N, CurDAG->getMachineNode(
+                         M65832::LEA_FI, DL, MVT::i32,
+                         CurDAG->getTargetFrameIndex(FI, MVT::i32),
+                         CurDAG->getTargetConstant(Off, DL, MVT::i32)));
+      return;
+    }
+    break;
+  case ISD::AND:
+    if (tryBitfieldExtract(N))
+      return;
+    break;
   }
 
   // Select the default instruction
   SelectCode(N);
 }
 
+/// A FrameIndex only reaches Select when something needs the slot address
+/// as a value (&buf, pointer arithmetic); loads and stores have already
+/// taken it as a TargetFrameIndex through selectAddr.
 bool M65832DAGToDAGISel::selectFrameIndex(SDNode *N) {
   SDLoc DL(N);
   int FI = cast<FrameIndexSDNode>(N)->getIndex();
@@ -108,6 +142,39 @@ bool M65832DAGToDAGISel::selectFrameIndex(SDNode *N) {
   return true;
 }
 
+/// Select (x >> s) & (2^n - 1) as two barrel shifts, SHL #(32 - s - n)
+/// then SHR #(32 - n), instead of a shift and an AND with a 32-bit
+/// immediate. The DAG combiner folds the shift pair back into the mask, so
+/// this can only happen here. Byte and halfword fields starting at bit 0
+/// stay on ZEXT8/ZEXT16.
+bool M65832DAGToDAGISel::tryBitfieldExtract(SDNode *N) {
+  auto *MaskC = dyn_cast<ConstantSDNode>(N->getOperand(1));
+  if (N->getValueType(0) != MVT::i32 || !MaskC)
+    return false;
+  uint64_t Mask = MaskC->getZExtValue();
+  if (!isMask_32(Mask))
+    return false;
+  unsigned Width = llvm::popcount(Mask);
+
+  SDValue Src = N->getOperand(0);
+  unsigned Shift = 0;
+  if (Src.getOpcode() == ISD::SRL && Src.hasOneUse() &&
+      isa<ConstantSDNode>(Src.getOperand(1))) {
+    Shift = Src.getConstantOperandVal(1);
+    Src = Src.getOperand(0);
+  }
+  if (Shift + Width >= 32 || (Shift == 0 && (Width == 8 || Width == 16)))
+    return false;
+
+  SDLoc DL(N);
+  SDNode *Hi = CurDAG->getMachineNode(
+      M65832::SHLR, DL, MVT::i32, Src,
+      CurDAG->getTargetConstant(32 - Shift - Width, DL, MVT::i32));
+  CurDAG->SelectNodeTo(N, M65832::SHRR, MVT::i32, SDValue(Hi, 0),
+                       CurDAG->getTargetConstant(32 - Width, DL, MVT::i32));
+  return true;
+}
+
 bool M65832DAGToDAGISel::selectAddr(SDValue N, SDValue &Base, SDValue &Offset) {
   if (N.getOpcode() == ISD::FrameIndex) {
     Base = CurDAG->getTargetFrameIndex(
@@ -116,12 +183,17 @@ bool M65832DAGToDAGISel::selectAddr(SDValue N, SDValue &Base, SDValue &Offset) {
     return true;
   }
 
-  if (N.getOpcode() == ISD::ADD) {
-    if (ConstantSDNode *CN = dyn_cast<ConstantSDNode>(N.getOperand(1))) {
-      Base = N.getOperand(0);
-      Offset = CurDAG->getTargetConstant(CN->getZExtValue(), SDLoc(N), MVT::i32);
-      return true;
-    }
+  if (CurDAG->isBaseWithConstantOffset(N)) {
+    // slot + imm stays a frame index so eliminateFrameIndex turns the access
+    // into a single B-relative LDA/STA/LD.B/LD.W
+    SDValue LHS = N.getOperand(0);
+    int64_t Imm = cast<ConstantSDNode>(N.getOperand(1))->getSExtValue();
+    if (auto *FIN = dyn_cast<FrameIndexSDNode>(LHS))
+      Base = CurDAG->getTargetFrameIndex(FIN->getIndex(), MVT::i32);
+    else
+      Base = LHS;
+    Offset = CurDAG->getTargetConstant(Imm, SDLoc(N), MVT::i32);
+    return true;
   }
 
   Base = N;
@@ -129,20 +201,215 @@ bool M65832DAGToDAGISel::selectAddr(SDValue N, SDValue &Base, SDValue &Offset) {
   return true;
 }
 
+/// Match a stack slot or slot + constant only, the addresses that become a
+/// single B+offset operand.
+bool M65832DAGToDAGISel::selectAddrFI(SDValue N, SDValue &Base,
+                                      SDValue &Offset) {
+  int64_t Imm = 0;
+  if (CurDAG->isBaseWithConstantOffset(N)) {
+    Imm = cast<ConstantSDNode>(N.getOperand(1))->getSExtValue();
+    N = N.getOperand(0);
+  }
+  auto *FIN = dyn_cast<FrameIndexSDNode>(N);
+  if (!FIN)
+    return false;
+  Base = CurDAG->getTargetFrameIndex(FIN->getIndex(), MVT::i32);
+  Offset = CurDAG->getTargetConstant(Imm, SDLoc(N), MVT::i32);
+  return true;
+}
+
+/// Match base + index for the (dp),Y forms, with the index loaded into Y
+/// from its register instead of adding it into a fresh address register.
+bool M65832DAGToDAGISel::selectAddrRR(SDValue N, SDValue &Base,
+                                      SDValue &Index) {
+  if (N.getOpcode() != ISD::ADD)
+    return false;
+
+  // base + constant is selectAddr's LDY #imm form
+  SDValue LHS = N.getOperand(0);
+  SDValue RHS = N.getOperand(1);
+  if (isa<ConstantSDNode>(LHS) || isa<ConstantSDNode>(RHS))
+    return false;
+
+  // Keep the scaled index in Y and the pointer in the DP base
+  if (LHS.getOpcode() == ISD::SHL || LHS.getOpcode() == ISD::MUL)
+    std::swap(LHS, RHS);
+
+  Base = LHS;
+  Index = RHS;
+  return true;
+}
+
+/// Match a global or jump table indexed by a register as sym,Y, which
+/// LD.L reaches with LDY index and its abs32,Y form instead of loading the
+/// table address first. -fPIC tables go through selectAddrRR.
+bool M65832DAGToDAGISel::selectAddrGR(SDValue N, SDValue &Addr,
+                                      SDValue &Index) {
+  if (N.getOpcode() != ISD::ADD)
+    return false;
+
+  SDValue LHS = N.getOperand(0);
+  SDValue RHS = N.getOperand(1);
+  if (RHS.getOpcode() == M65832ISD::WRAPPER)
+    std::swap(LHS, RHS);
+  if (LHS.getOpcode() != M65832ISD::WRAPPER || isa<ConstantSDNode>(RHS))
+    return false;
+
+  SDValue Sym = LHS.getOperand(0);
+  if (Sym.getOpcode() != ISD::TargetGlobalAddress &&
+      Sym.getOpcode() != ISD::TargetJumpTable)
+    return false;
+
+  Addr = Sym;
+  Index = RHS;
+  return true;
+}
+
+/// Match an LDF/STF address. Stack slots keep their constant like
+/// selectAddr; anything else is the (Rm) pointer itself, so base + offset and
+/// base + index become a plain ADD into an R0-R15 register rather than being
+/// recomputed through A and R0 by every expanded load and store.
+bool M65832DAGToDAGISel::selectAddrFP(SDValue N, SDValue &Base,
+                                      SDValue &Offset) {
+  if (selectAddrFI(N, Base, Offset))
+    return true;
+  Base = N;
+  Offset = CurDAG->getTargetConstant(0, SDLoc(N), MVT::i32);
+  return true;
+}
+
+/// Match a small-data global as R28 + %gprel(sym), which loads and stores
+/// reach with LDY #%gprel(sym) and (R28),Y instead of loading the address.
+bool M65832DAGToDAGISel::selectAddrGP(SDValue N, SDValue &Base,
+                                      SDValue &Offset) {
+  auto *GA = dyn_cast<GlobalAddressSDNode>(N.getOperand(0));
+  if (!GA)
+    return false;
+  const auto *GO = dyn_cast<GlobalObject>(GA->getGlobal());
+  const auto &TLOF =
+      static_cast<const M65832TargetObjectFile &>(*TM.getObjFileLowering());
+  if (!GO || !TLOF.isGlobalInSmallSection(GO, TM))
+    return false;
+
+  Base = CurDAG->getRegister(M65832::R28, MVT::i32);
+  Offset = CurDAG->getTargetGlobalAddress(GO, SDLoc(N), MVT::i32,
+                                          GA->getOffset(), M65832II::MO_GPREL);
+  return true;
+}
+
+/// Match a thread-local global as R56 + %tprel(sym), reached like small data
+/// with LDY #%tprel(sym) and (R56),Y.
+bool M65832DAGToDAGISel::selectAddrTP(SDValue N, SDValue &Base,
+                                      SDValue &Offset) {
+  Base = CurDAG->getRegister(M65832::R56, MVT::i32);
+  Offset = N.getOperand(0);
+  return true;
+}
+
+/// Match a -mcmodel=bank data global as B + %bankrel(sym). The _GLOBAL
+/// expansion only keeps the B-relative form in functions whose prologue
+/// pointed B at __data_bank_base; elsewhere it is a 32-bit absolute access.
+/// With -mrelax any other data global may also turn out to be in the bank:
+/// it is matched as %bankabs(sym), which stays 32-bit absolute and which
+/// the linker shortens to B-relative once the final address is known.
+bool M65832DAGToDAGISel::selectAddrBank(SDValue N, SDValue &Offset) {
+  auto *GA = dyn_cast<GlobalAddressSDNode>(N.getOperand(0));
+  if (!GA)
+    return false;
+  const auto *GO = dyn_cast<GlobalObject>(GA->getGlobal());
+  const auto &TLOF =
+      static_cast<const M65832TargetObjectFile &>(*TM.getObjFileLowering());
+  if (!GO)
+    return false;
+
+  unsigned Flags = M65832II::MO_BANKREL;
+  if (!TLOF.isGlobalInDataBank(GO, TM)) {
+    const auto *GV = dyn_cast<GlobalVariable>(GO);
+    if (!Subtarget->enableLinkerRelax() || !GV || GV->isThreadLocal())
+      return false;
+    Flags = M65832II::MO_BANKABS;
+  }
+
+  Offset = CurDAG->getTargetGlobalAddress(GO, SDLoc(N), MVT::i32,
+                                          GA->getOffset(), Flags);
+  return true;
+}
+
+/// Match a .dpdata global as %dp(sym), its offset in the direct page. The
+/// _GLOBAL expansion uses the DP forms unless the function moves D.
+bool M65832DAGToDAGISel::selectAddrDP(SDValue N, SDValue &Offset) {
+  auto *GA = dyn_cast<GlobalAddressSDNode>(N.getOperand(0));
+  if (!GA)
+    return false;
+  const auto *GO = dyn_cast<GlobalObject>(GA->getGlobal());
+  const auto &TLOF =
+      static_cast<const M65832TargetObjectFile &>(*TM.getObjFileLowering());
+  if (!GO || !TLOF.isGlobalInDirectPage(GO))
+    return false;
+
+  Offset = CurDAG->getTargetGlobalAddress(GO, SDLoc(N), MVT::i32,
+                                          GA->getOffset(), M65832II::MO_DP);
+  return true;
+}
+
 bool M65832DAGToDAGISel::SelectInlineAsmMemoryOperand(
     const SDValue &Op, InlineAsm::ConstraintCode ConstraintCode,
     std::vector<SDValue> &OutOps) {
-  // M65832 memory operands for inline asm: accept "m" and "o" constraints.
-  // Return the address in a register.
+  // M65832 memory operands for inline asm. "m" and "o" pass the address in
+  // a register. "Q" (a .dpdata global), "S" (a frame slot) and "A" (a
+  // non-PIC global) keep the address symbolic so the asm can use the DP,
+  // B+$xxxx or absolute forms; anything else falls back to a register,
+  // which PrintAsmMemoryOperand rejects for those constraints.
+  SDLoc DL(Op);
   switch (ConstraintCode) {
   default:
     return true;  // Unknown constraint
   case InlineAsm::ConstraintCode::m:
   case InlineAsm::ConstraintCode::o:
     break;  // Handled below
+  case InlineAsm::ConstraintCode::Q:
+  case InlineAsm::ConstraintCode::A: {
+    SDValue Base = Op;
+    int64_t Off = 0;
+    if (CurDAG->isBaseWithConstantOffset(Base)) {
+      Off = cast<ConstantSDNode>(Base.getOperand(1))->getSExtValue();
+      Base = Base.getOperand(0);
+    }
+    if (Base.getOpcode() != M65832ISD::WRAPPER)
+      break;
+    auto *GA = dyn_cast<GlobalAddressSDNode>(Base.getOperand(0));
+    if (!GA)
+      break;
+    const auto *GO = dyn_cast<GlobalObject>(GA->getGlobal());
+    const auto &TLOF =
+        static_cast<const M65832TargetObjectFile &>(*TM.getObjFileLowering());
+    unsigned Flags = M65832II::MO_NO_FLAG;
+    if (ConstraintCode == InlineAsm::ConstraintCode::Q) {
+      if (!GO || !TLOF.isGlobalInDirectPage(GO))
+        break;
+      Flags = M65832II::MO_DP;
+    }
+    OutOps.push_back(CurDAG->getTargetGlobalAddress(
+        GA->getGlobal(), DL, MVT::i32, GA->getOffset() + Off, Flags));
+    return false;
+  }
+  case InlineAsm::ConstraintCode::S: {
+    // eliminateFrameIndex turns the pair into B and the final offset
+    SDValue Base = Op;
+    int64_t Off = 0;
+    if (CurDAG->isBaseWithConstantOffset(Base)) {
+      Off = cast<ConstantSDNode>(Base.getOperand(1))->getSExtValue();
+      Base = Base.getOperand(0);
+    }
+    auto *FIN = dyn_cast<FrameIndexSDNode>(Base);
+    if (!FIN)
+      break;
+    OutOps.push_back(CurDAG->getTargetFrameIndex(FIN->getIndex(), MVT::i32));
+    OutOps.push_back(CurDAG->getTargetConstant(Off, DL, MVT::i32));
+    return false;
+  }
   }
 
-  SDLoc DL(Op);
   MachineRegisterInfo &MRI = MF->getRegInfo();
   EVT PtrVT = MVT::i32;
   
@@ -15,6 +15,8 @@
 #include "M65832MachineFunctionInfo.h"
 #include "M65832Subtarget.h"
 #include "M65832TargetMachine.h"
+#include "llvm/ADT/APSInt.h"
+#include "llvm/CodeGen/Analysis.h"
 #include "llvm/CodeGen/CallingConvLower.h"
 #include "llvm/MC/MCRegister.h"
 #include "llvm/CodeGen/MachineFrameInfo.h"
@@ -24,6 +26,8 @@
 #include "llvm/CodeGen/SelectionDAGNodes.h"
 #include "llvm/CodeGen/TargetLoweringObjectFileImpl.h"
 #include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ErrorHandling.h"
 #include <utility>
 
@@ -31,6 +35,48 @@ using namespace llvm;
 
 #define DEBUG_TYPE "m65832-lower"
 
+static cl::opt<bool> EnableBranchlessSelect(
+    "m65832-branchless-select", cl::Hidden, cl::init(true),
+    cl::desc("Lower integer selects on EQ/NE/unsigned conditions to "
+             "mask-and-merge sequences instead of a skip branch"));
+
+static cl::opt<bool> WindowedCalls(
+    "m65832-windowed-calls", cl::Hidden, cl::init(false),
+    cl::desc("Move D to a fresh register window on entry to every function "
+             "instead of saving callee-saved GPRs (as if each had the "
+             "\"m65832-window\" attribute)"));
+
+static cl::opt<unsigned> MaxInlineStores(
+    "m65832-max-inline-stores", cl::Hidden, cl::init(8),
+    cl::desc("Largest number of word stores a constant-size memcpy, "
+             "memmove or memset is expanded to before it becomes a block "
+             "move or a call"));
+
+static cl::opt<unsigned> MinJumpTableEntries(
+    "m65832-min-jump-table-entries", cl::Hidden, cl::init(6),
+    cl::desc("Fewest cases a switch needs before it is lowered to a jump "
+             "table"));
+
+static cl::opt<unsigned> CycleCounterAddr(
+    "m65832-cycle-counter-addr", cl::Hidden, cl::init(0x00FFF110),
+    cl::desc("Address of the memory-mapped 64-bit cycle counter that "
+             "llvm.readcyclecounter reads (low word first)"));
+
+/// Registers a windowed function moves D down by: far enough that every
+/// register its caller keeps across a call is out of DP reach, while the
+/// argument registers stay visible. Interrupt handlers take no arguments
+/// and leave the interrupted code's window entirely alone.
+static constexpr unsigned WindowShiftRegs = 48;
+static constexpr unsigned InterruptWindowShiftRegs = 64;
+
+/// The register Reg names once D has moved down by Shift registers
+static MCRegister shiftWindowReg(MCRegister Reg, unsigned Shift) {
+  if (Shift == 0 || Reg < M65832::R0 || Reg > M65832::R63)
+    return Reg;
+  assert(Reg - M65832::R0 + Shift <= 63 && "Register shifted out of DP");
+  return M65832::R0 + (Reg - M65832::R0 + Shift);
+}
+
 #include "M65832GenCallingConv.inc"
 
 M65832TargetLowering::M65832TargetLowering(const TargetMachine &TM,
@@ -39,10 +85,18 @@ M65832TargetLowering::M65832TargetLowering(const TargetMachine &TM,
   
   // Set up register classes - GPR for integers
   addRegisterClass(MVT::i32, &M65832::GPRRegClass);
-  
-  // FPU register classes for floating point
-  addRegisterClass(MVT::f32, &M65832::FPR32RegClass);
-  addRegisterClass(MVT::f64, &M65832::FPR64RegClass);
+
+  // Small vectors are SWAR values in one GPR (see the end of this function)
+  addRegisterClass(MVT::v4i8, &M65832::GPRVRegClass);
+  addRegisterClass(MVT::v2i16, &M65832::GPRVRegClass);
+  
+  // FPU register classes for floating point. Without the FPU f32/f64 are
+  // softened to i32 and i32 pairs, so arguments land in GPRs and every FP
+  // operation becomes a __*sf3/__*df3 libcall.
+  if (Subtarget.hasFPU()) {
+    addRegisterClass(MVT::f32, &M65832::FPR32RegClass);
+    addRegisterClass(MVT::f64, &M65832::FPR64RegClass);
+  }
   
   // Compute derived properties from register classes
   // MUST be called after all register classes are added
@@ -56,9 +110,11 @@ M65832TargetLowering::M65832TargetLowering(const TargetMachine &TM,
   
   // Operations that need custom lowering
   setOperationAction(ISD::GlobalAddress, MVT::i32, Custom);
+  setOperationAction(ISD::GlobalTLSAddress, MVT::i32, Custom);
   setOperationAction(ISD::ExternalSymbol, MVT::i32, Custom);
   setOperationAction(ISD::BlockAddress, MVT::i32, Custom);
   setOperationAction(ISD::ConstantPool, MVT::i32, Custom);
+  setOperationAction(ISD::JumpTable, MVT::i32, Custom);
   
   setOperationAction(ISD::BR_CC, MVT::i32, Custom);
   setOperationAction(ISD::BRCOND, MVT::Other, Expand);  // Expand to BR_CC with cmp against 0
@@ -81,6 +137,10 @@ M65832TargetLowering::M65832TargetLowering(const TargetMachine &TM,
   // Rotates - also supported by barrel shifter
   setOperationAction(ISD::ROTL, MVT::i32, Legal);
   setOperationAction(ISD::ROTR, MVT::i32, Legal);
+  // Funnel shifts are two shifts and an OR (LowerFunnelShift); i64 rotates
+  // are legalized into a pair of them.
+  setOperationAction(ISD::FSHL, MVT::i32, Custom);
+  setOperationAction(ISD::FSHR, MVT::i32, Custom);
   
   // Multi-word shifts (for 64-bit shifts on 32-bit target)
   // Custom lowering uses the barrel shifter for efficient implementation
@@ -89,7 +149,7 @@ M65832TargetLowering::M65832TargetLowering(const TargetMachine &TM,
   setOperationAction(ISD::SRA_PARTS, MVT::i32, Custom);
   
   setOperationAction(ISD::VASTART, MVT::Other, Custom);
-  setOperationAction(ISD::VAARG, MVT::Other, Expand);
+  setOperationAction(ISD::VAARG, MVT::Other, Custom);
   setOperationAction(ISD::VACOPY, MVT::Other, Expand);
   setOperationAction(ISD::VAEND, MVT::Other, Expand);
   
@@ -101,68 +161,122 @@ M65832TargetLowering::M65832TargetLowering(const TargetMachine &TM,
   setOperationAction(ISD::UDIV, MVT::i32, Subtarget.hasHWMul() ? Legal : Expand);
   setOperationAction(ISD::SREM, MVT::i32, Subtarget.hasHWMul() ? Legal : Expand);
   setOperationAction(ISD::UREM, MVT::i32, Subtarget.hasHWMul() ? Legal : Expand);
-  setOperationAction(ISD::MUL, MVT::i32, Subtarget.hasHWMul() ? Legal : Expand);
-  
-  setOperationAction(ISD::MULHS, MVT::i32, Expand);
-  setOperationAction(ISD::MULHU, MVT::i32, Expand);
-  setOperationAction(ISD::SMUL_LOHI, MVT::i32, Expand);
-  setOperationAction(ISD::UMUL_LOHI, MVT::i32, Expand);
+  // Without MUL a multiply is an inline shift-and-add loop, or __mulsi3
+  // when optimizing for size (LowerMUL)
+  setOperationAction(ISD::MUL, MVT::i32, Subtarget.hasHWMul() ? Legal : Custom);
+  setTargetDAGCombine({ISD::MUL, ISD::OR});
+
+  // DIV/DIVU leave the remainder in T, so a / b and a % b on the same
+  // operands combine into one divide
+  setOperationAction(ISD::SDIVREM, MVT::i32,
+                     Subtarget.hasHWMul() ? Legal : Expand);
+  setOperationAction(ISD::UDIVREM, MVT::i32,
+                     Subtarget.hasHWMul() ? Legal : Expand);
+  
+  // MUL/MULU leave the high word in T, so the widening forms are one
+  // multiply. With UMUL_LOHI legal, i64 multiply is expanded inline instead
+  // of calling __muldi3.
+  LegalizeAction MulHiAction = Subtarget.hasHWMul() ? Legal : Expand;
+  setOperationAction(ISD::MULHS, MVT::i32, MulHiAction);
+  setOperationAction(ISD::MULHU, MVT::i32, MulHiAction);
+  setOperationAction(ISD::SMUL_LOHI, MVT::i32, MulHiAction);
+  setOperationAction(ISD::UMUL_LOHI, MVT::i32, MulHiAction);
+
+  // 64-bit add/sub become ADD64/SUB64 (ADC/SBC chained through the carry
+  // flag), and the i32 overflow and saturating forms read C or V straight
+  // out of SR instead of comparing the result against the operands.
+  setOperationAction(ISD::ADD, MVT::i64, Custom);
+  setOperationAction(ISD::SUB, MVT::i64, Custom);
+  for (unsigned Opc : {ISD::UADDO, ISD::USUBO, ISD::SADDO, ISD::SSUBO,
+                       ISD::UADDSAT, ISD::USUBSAT, ISD::SADDSAT, ISD::SSUBSAT})
+    setOperationAction(Opc, MVT::i32, Legal);
   
   // Bit manipulation - now have hardware CLZ, CTZ, POPCNT!
   setOperationAction(ISD::CTLZ, MVT::i32, Legal);
   setOperationAction(ISD::CTTZ, MVT::i32, Legal);
   setOperationAction(ISD::CTPOP, MVT::i32, Legal);
-  setOperationAction(ISD::BSWAP, MVT::i32, Expand);
+  // i64 counts use the halves (ReplaceNodeResults); i64 CTPOP is already
+  // two POPCNTs and an add.
+  for (unsigned Opc : {ISD::CTLZ, ISD::CTLZ_ZERO_UNDEF, ISD::CTTZ,
+                       ISD::CTTZ_ZERO_UNDEF})
+    setOperationAction(Opc, MVT::i64, Custom);
+  // No byte-swap instruction, but two rotates and two masks do it (see the
+  // bswap patterns). Keeping it Legal also lets the load/store combiners form
+  // bswap(load) for byte-wise big-endian accesses instead of four loads.
+  setOperationAction(ISD::BSWAP, MVT::i32, Legal);
   
   // Sign/zero extends - now have hardware SEXT8/SEXT16!
   setOperationAction(ISD::SIGN_EXTEND_INREG, MVT::i8, Legal);
   setOperationAction(ISD::SIGN_EXTEND_INREG, MVT::i16, Legal);
   setOperationAction(ISD::SIGN_EXTEND_INREG, MVT::i1, Expand);
   
-  // Dynamic stack allocation not supported directly
-  setOperationAction(ISD::DYNAMIC_STACKALLOC, MVT::i32, Expand);
+  // Dynamic stack allocation moves SP in one TSX ... TXS sequence; B stays
+  // the frame base. Saving and restoring SP are plain copies.
+  setOperationAction(ISD::DYNAMIC_STACKALLOC, MVT::i32, Custom);
   setOperationAction(ISD::STACKSAVE, MVT::Other, Expand);
   setOperationAction(ISD::STACKRESTORE, MVT::Other, Expand);
   
   // We don't have conditional moves
   setOperationAction(ISD::SELECT, MVT::i32, Expand);
   
-  // Jump tables and indirect branches - expand to cascading branches
+  // Jump tables: BR_JT expands to a load of the table entry followed by
+  // BRIND, which is JMP (dp) through the register holding the target.
+  // Entries are 32-bit absolute addresses, or table-relative under PIC.
   setOperationAction(ISD::BR_JT, MVT::Other, Expand);
-  setOperationAction(ISD::BRIND, MVT::Other, Expand);
-  
-  // Minimum threshold for jump tables (effectively disable them)
-  setMinimumJumpTableEntries(UINT_MAX);
-  
-  // Boolean values are i32
+  setOperationAction(ISD::BRIND, MVT::Other, Legal);
+  // The dispatch (rebase, range check, scaled load, JMP (dp)) is about 40
+  // bytes against 11 for each CMP #imm; BEQ, so it pays from six cases.
+  // Below that, clusters within 32 values become bit tests.
+  setMinimumJumpTableEntries(MinJumpTableEntries);
+  
+  // Boolean values are i32; vector compares give all-ones lanes, which is
+  // what the SWAR masks are
   setBooleanContents(ZeroOrOneBooleanContent);
-  setBooleanVectorContents(ZeroOrOneBooleanContent);
+  setBooleanVectorContents(ZeroOrNegativeOneBooleanContent);
   
-  // Minimum function alignment
+  // Functions and loop headers start on a fetch boundary, so the first
+  // fetch of each is a full one. Padding falling into a loop is a BRA over
+  // the NOPs once it is longer than a few bytes (writeNopData).
   setMinFunctionAlignment(Align(1));
-  setPrefFunctionAlignment(Align(4));
+  setPrefFunctionAlignment(Align(Subtarget.getFetchWidth()));
+  setPrefLoopAlignment(Align(Subtarget.getFetchWidth()));
   
   // Stack alignment
   setMinStackArgumentAlignment(Align(4));
+
+  // memcpy/memmove/memset: small constant sizes become word loads/stores,
+  // misaligned ones too with unaligned-access, anything larger is an
+  // MVN/MVP block move (see M65832SelectionDAGInfo). The block move setup
+  // is about as big as two word copies.
+  MaxStoresPerMemcpy = MaxInlineStores;
+  MaxStoresPerMemcpyOptSize = 2;
+  MaxStoresPerMemmove = MaxInlineStores;
+  MaxStoresPerMemmoveOptSize = 2;
+  MaxStoresPerMemset = MaxInlineStores;
+  MaxStoresPerMemsetOptSize = 2;
+  // memcmp/bcmp of a small constant size: word loads and compares (see
+  // M65832TTIImpl::enableMemCmpExpansion)
+  MaxLoadsPerMemcmp = 8;
+  MaxLoadsPerMemcmpOptSize = 2;
   
   // =========================================================================
   // Load/Store Extension Actions
   // =========================================================================
   // Zero-extending loads: use extloadi8/extloadi16 patterns (LOAD8/LOAD16)
-  // Sign-extending loads: expand to load + sign-extend
+  // Extending loads. LD.B/LD.W zero-extend, so EXTLOAD and ZEXTLOAD are the
+  // same LOAD8/LOAD16; SEXTLOAD selects LOAD8/LOAD16 + SEXT8/SEXT16. Keeping
+  // them legal lets the combiner see the known-zero/sign bits and drop any
+  // later re-extension.
   for (MVT VT : MVT::integer_valuetypes()) {
-    // EXTLOAD (any-extending) - Legal, matched by LOAD8/LOAD16 patterns
     setLoadExtAction(ISD::EXTLOAD, VT, MVT::i1, Promote);
     setLoadExtAction(ISD::EXTLOAD, VT, MVT::i8, Legal);
     setLoadExtAction(ISD::EXTLOAD, VT, MVT::i16, Legal);
-    // ZEXTLOAD - expand to EXTLOAD + AND (if needed), or just use EXTLOAD
     setLoadExtAction(ISD::ZEXTLOAD, VT, MVT::i1, Promote);
-    setLoadExtAction(ISD::ZEXTLOAD, VT, MVT::i8, Expand);
-    setLoadExtAction(ISD::ZEXTLOAD, VT, MVT::i16, Expand);
-    // SEXTLOAD - expand to EXTLOAD + sign-extend (SEXT8/SEXT16)
+    setLoadExtAction(ISD::ZEXTLOAD, VT, MVT::i8, Legal);
+    setLoadExtAction(ISD::ZEXTLOAD, VT, MVT::i16, Legal);
     setLoadExtAction(ISD::SEXTLOAD, VT, MVT::i1, Promote);
-    setLoadExtAction(ISD::SEXTLOAD, VT, MVT::i8, Expand);
-    setLoadExtAction(ISD::SEXTLOAD, VT, MVT::i16, Expand);
+    setLoadExtAction(ISD::SEXTLOAD, VT, MVT::i8, Legal);
+    setLoadExtAction(ISD::SEXTLOAD, VT, MVT::i16, Legal);
   }
   
   // Truncating stores - Legal, matched by STORE8/STORE16 patterns
@@ -201,13 +315,15 @@ M65832TargetLowering::M65832TargetLowering(const TargetMachine &TM,
   setOperationAction(ISD::FP_TO_SINT, MVT::i32, Legal);
   setOperationAction(ISD::SINT_TO_FP, MVT::i32, Legal);
   
-  // Unsigned conversions - expand (no direct hardware support)
-  setOperationAction(ISD::FP_TO_UINT, MVT::i32, Expand);
-  setOperationAction(ISD::UINT_TO_FP, MVT::i32, Expand);
+  // Unsigned and i64 conversions are built from F2I/I2F and the 2^52 bias
+  // trick (see LowerINT_TO_FP). i64 -> f32 and all FP -> i64 stay libcalls.
+  LegalizeAction FPConvAction = Subtarget.hasFPU() ? Custom : Expand;
+  setOperationAction(ISD::FP_TO_UINT, MVT::i32, FPConvAction);
+  setOperationAction(ISD::UINT_TO_FP, MVT::i32, FPConvAction);
   setOperationAction(ISD::FP_TO_SINT, MVT::i64, Expand);
   setOperationAction(ISD::FP_TO_UINT, MVT::i64, Expand);
-  setOperationAction(ISD::SINT_TO_FP, MVT::i64, Expand);
-  setOperationAction(ISD::UINT_TO_FP, MVT::i64, Expand);
+  setOperationAction(ISD::SINT_TO_FP, MVT::i64, FPConvAction);
+  setOperationAction(ISD::UINT_TO_FP, MVT::i64, FPConvAction);
   
   // FP load/store - Legal (use LDF/STF instructions)
   setOperationAction(ISD::LOAD, MVT::f32, Legal);
@@ -219,11 +335,12 @@ M65832TargetLowering::M65832TargetLowering(const TargetMachine &TM,
   // (Can't do extending load directly, need separate load and convert)
   setLoadExtAction(ISD::EXTLOAD, MVT::f64, MVT::f32, Expand);
   
-  // FP/Int bitcast - expand through memory (no direct FMV instruction)
-  setOperationAction(ISD::BITCAST, MVT::f32, Expand);
-  setOperationAction(ISD::BITCAST, MVT::i32, Expand);
-  setOperationAction(ISD::BITCAST, MVT::f64, Expand);
-  setOperationAction(ISD::BITCAST, MVT::i64, Expand);
+  // FP/Int bitcast - f32<->i32 is a single FTOA/ATOF through A. i64 is not
+  // legal, so f64<->i64 is split into (lo, hi) around FTOA/FTOT/ATOF/TTOF
+  // instead of going through a stack slot.
+  setOperationAction(ISD::BITCAST, MVT::f32, Legal);
+  setOperationAction(ISD::BITCAST, MVT::i32, Legal);
+  setOperationAction(ISD::BITCAST, MVT::i64, FPConvAction);
   
   // FP comparisons - Custom lowering using FCMP + conditional select
   setOperationAction(ISD::SETCC, MVT::f32, Custom);
@@ -280,6 +397,47 @@ M65832TargetLowering::M65832TargetLowering(const TargetMachine &TM,
   setOperationAction(ISD::FMA, MVT::f64, Expand);
   setOperationAction(ISD::FMAD, MVT::f32, Expand);
   setOperationAction(ISD::FMAD, MVT::f64, Expand);
+
+  // Optional FPU extensions. Without fpu-round, f32 trunc/floor/ceil are
+  // built from F2I/I2F; f64 stays a libcall since F2I is only 32 bits wide.
+  if (Subtarget.hasFPUFMA()) {
+    setOperationAction(ISD::FMA, MVT::f32, Legal);
+    setOperationAction(ISD::FMA, MVT::f64, Legal);
+  }
+  if (Subtarget.hasFPUMinMax()) {
+    for (MVT VT : {MVT::f32, MVT::f64}) {
+      setOperationAction(ISD::FMINNUM, VT, Legal);
+      setOperationAction(ISD::FMAXNUM, VT, Legal);
+    }
+  }
+  if (Subtarget.hasFPURound()) {
+    for (MVT VT : {MVT::f32, MVT::f64}) {
+      setOperationAction(ISD::FTRUNC, VT, Legal);
+      setOperationAction(ISD::FFLOOR, VT, Legal);
+      setOperationAction(ISD::FCEIL, VT, Legal);
+      setOperationAction(ISD::FRINT, VT, Legal);
+      setOperationAction(ISD::FNEARBYINT, VT, Legal);
+      setOperationAction(ISD::FROUNDEVEN, VT, Legal);
+    }
+  } else if (Subtarget.hasFPU()) {
+    setOperationAction(ISD::FTRUNC, MVT::f32, Custom);
+    setOperationAction(ISD::FFLOOR, MVT::f32, Custom);
+    setOperationAction(ISD::FCEIL, MVT::f32, Custom);
+  }
+
+  // _Float16 is a storage type: loads and stores are i16 and arithmetic
+  // is done in f32. With the FPU, f16<->f32 are integer bit sequences
+  // (LowerFP16_TO_FP, LowerFP_TO_FP16) rather than __extendhfsf2 and
+  // __truncsfhf2. f16 -> f64 goes through f32; f64 -> f16 stays
+  // __truncdfhf2 so that it rounds once.
+  for (MVT VT : {MVT::f32, MVT::f64}) {
+    setLoadExtAction(ISD::EXTLOAD, VT, MVT::f16, Expand);
+    setTruncStoreAction(VT, MVT::f16, Expand);
+  }
+  if (Subtarget.hasFPU()) {
+    setOperationAction(ISD::FP16_TO_FP, MVT::f32, Custom);
+    setOperationAction(ISD::FP_TO_FP16, MVT::f32, Custom);
+  }
   
   // Common FP settings
   // For floating-point, we use Custom lowering for SELECT_CC and SELECT
@@ -290,31 +448,214 @@ M65832TargetLowering::M65832TargetLowering(const TargetMachine &TM,
   setOperationAction(ISD::SELECT, MVT::f32, Custom);
   setOperationAction(ISD::SELECT, MVT::f64, Custom);
   
-  // Floating point constants - always expand (load from constant pool)
+  // Floating point constants - expand to a constant-pool load unless
+  // isFPImmLegal accepts them (small integers and +0.0 via FLI_S/FLI_D)
   setOperationAction(ISD::ConstantFP, MVT::f32, Expand);
   setOperationAction(ISD::ConstantFP, MVT::f64, Expand);
   
   // Truncating stores for FP - expand to convert + store
   setTruncStoreAction(MVT::f64, MVT::f32, Expand);
+
+  // =========================================================================
+  // Atomics
+  // =========================================================================
+  // CAS and the LLI/SCI pair operate on a single 32-bit word. AtomicExpand
+  // widens i8/i16 operations to a masked cmpxchg and inserts the barriers
+  // for the requested ordering, so only monotonic 32-bit operations reach
+  // instruction selection. Cores without the atomics feature expand the
+  // same pseudos into PHP; SEI; ...; PLP critical sections, so no atomic
+  // becomes an __atomic_* libcall.
+  setMaxAtomicSizeInBitsSupported(32);
+  setMinCmpXchgSizeInBits(32);
+  setOperationAction(ISD::ATOMIC_CMP_SWAP_WITH_SUCCESS, MVT::i32, Expand);
+  setOperationAction(ISD::ATOMIC_FENCE, MVT::Other, Custom);
+
+  // There is no cycle counter instruction; the system timer block has a
+  // free-running counter whose high word is latched when the low word is
+  // read (see ReplaceNodeResults)
+  setOperationAction(ISD::READCYCLECOUNTER, MVT::i64, Custom);
+
+  // =========================================================================
+  // SWAR vectors
+  // =========================================================================
+  // v4i8 and v2i16 are i32s with lane 0 in the low bits. Memory and the
+  // bitwise operations are the i32 ones; add, sub and compares keep the
+  // lanes apart with masks, and the lane moves are shifts and rotates.
+  // Everything else is taken apart lane by lane.
+  for (MVT VT : {MVT::v4i8, MVT::v2i16}) {
+    for (unsigned Opc = 0; Opc < ISD::BUILTIN_OP_END; ++Opc)
+      if (Opc != ISD::BITCAST && Opc != ISD::UNDEF && Opc != ISD::FREEZE)
+        setOperationAction(Opc, VT, Expand);
+    for (unsigned Opc : {ISD::LOAD, ISD::STORE, ISD::AND, ISD::OR, ISD::XOR}) {
+      setOperationAction(Opc, VT, Promote);
+      AddPromotedToType(Opc, VT, MVT::i32);
+    }
+    for (unsigned Opc : {ISD::ADD, ISD::SUB, ISD::SETCC, ISD::BUILD_VECTOR,
+                         ISD::EXTRACT_VECTOR_ELT, ISD::INSERT_VECTOR_ELT,
+                         ISD::SCALAR_TO_VECTOR, ISD::VECTOR_SHUFFLE})
+      setOperationAction(Opc, VT, Custom);
+    for (MVT Other : MVT::fixedlen_vector_valuetypes()) {
+      setTruncStoreAction(VT, Other, Expand);
+      setTruncStoreAction(Other, VT, Expand);
+      for (auto Ext : {ISD::EXTLOAD, ISD::SEXTLOAD, ISD::ZEXTLOAD}) {
+        setLoadExtAction(Ext, VT, Other, Expand);
+        setLoadExtAction(Ext, Other, VT, Expand);
+      }
+    }
+  }
+}
+
+/// Rewrite GT/LE/UGT/ULE into LT/GE/ULT/UGE so every integer compare is one
+/// CMPR and one Bcc. A constant rhs is bumped by one (x > C is x >= C+1),
+/// which keeps it an immediate; otherwise the operands are swapped.
+static void canonicalizeIntCC(ISD::CondCode &CC, SDValue &LHS, SDValue &RHS,
+                              SelectionDAG &DAG, const SDLoc &DL) {
+  ISD::CondCode NewCC;
+  switch (CC) {
+  case ISD::SETGT:  NewCC = ISD::SETGE;  break;
+  case ISD::SETLE:  NewCC = ISD::SETLT;  break;
+  case ISD::SETUGT: NewCC = ISD::SETUGE; break;
+  case ISD::SETULE: NewCC = ISD::SETULT; break;
+  default:
+    return;
+  }
+
+  if (auto *C = dyn_cast<ConstantSDNode>(RHS)) {
+    const APInt &Imm = C->getAPIntValue();
+    bool Signed = CC == ISD::SETGT || CC == ISD::SETLE;
+    if (Signed ? !Imm.isMaxSignedValue() : !Imm.isMaxValue()) {
+      CC = NewCC;
+      RHS = DAG.getConstant(Imm + 1, DL, RHS.getValueType());
+      return;
+    }
+  }
+
+  CC = ISD::getSetCCSwappedOperands(CC);
+  std::swap(LHS, RHS);
+}
+
+/// uint8_t and uint16_t values are promoted, so comparing two of them
+/// compares an (and x, $FF) or (and x, $FFFF) per side. When both sides
+/// are zero-extended from the same width, CMP.B/CMP.W on the low bits gives
+/// the same answer without the masks, and its immediate is 1 or 2 bytes
+/// instead of 4. Returns that width after stripping the masks, or 0.
+static unsigned narrowIntCompare(ISD::CondCode &CC, SDValue &LHS,
+                                 SDValue &RHS, SelectionDAG &DAG) {
+  // Both sides are non-negative, so the signed predicates are the unsigned
+  // ones, which are the ones the narrow compare's carry gets right.
+  ISD::CondCode NewCC;
+  switch (CC) {
+  case ISD::SETEQ:
+  case ISD::SETNE:
+  case ISD::SETULT:
+  case ISD::SETUGE:
+    NewCC = CC;
+    break;
+  case ISD::SETLT:  NewCC = ISD::SETULT; break;
+  case ISD::SETGE:  NewCC = ISD::SETUGE; break;
+  default:
+    return 0;
+  }
+
+  for (unsigned Bits : {8u, 16u}) {
+    uint64_t Mask = maskTrailingOnes<uint64_t>(Bits);
+    bool Stripped = false;
+    auto Narrow = [&](SDValue V) -> SDValue {
+      if (auto *C = dyn_cast<ConstantSDNode>(V))
+        return C->getZExtValue() <= Mask ? V : SDValue();
+      if (V.getOpcode() == ISD::AND && isa<ConstantSDNode>(V.getOperand(1)) &&
+          V.getConstantOperandVal(1) == Mask) {
+        Stripped = true;
+        return V.getOperand(0);
+      }
+      if (DAG.computeKnownBits(V).countMinLeadingZeros() >= 32 - Bits)
+        return V;
+      return SDValue();
+    };
+    SDValue L = Narrow(LHS), R = Narrow(RHS);
+    if (!L || !R)
+      continue;
+    // Without a mask to drop, only a shorter immediate is gained, and a
+    // CMP.L #0 may not need emitting at all.
+    auto *C = dyn_cast<ConstantSDNode>(R);
+    if (!Stripped && (!C || C->isZero()))
+      return 0;
+    CC = NewCC;
+    LHS = L;
+    RHS = R;
+    return Bits;
+  }
+  return 0;
+}
+
+/// Bring an FP condition into the set getFCmpBranches can branch on.
+/// Predicates that do not care about NaNs (nnan, or operands known not to
+/// be NaN) drop to the plain forms, which test a single flag; GT/LE forms
+/// swap their operands. SETONE is left for the caller, which inverts SETUEQ.
+static void canonicalizeFPCC(ISD::CondCode &CC, SDValue &LHS, SDValue &RHS,
+                             SelectionDAG &DAG) {
+  if (DAG.isKnownNeverNaN(LHS) && DAG.isKnownNeverNaN(RHS))
+    CC = getFCmpCodeWithoutNaN(CC);
+
+  switch (CC) {
+  case ISD::SETGT:
+  case ISD::SETLE:
+  case ISD::SETOGT:
+  case ISD::SETOLE:
+  case ISD::SETUGT:
+  case ISD::SETULE:
+    CC = ISD::getSetCCSwappedOperands(CC);
+    std::swap(LHS, RHS);
+    break;
+  default:
+    break;
+  }
 }
 
 SDValue M65832TargetLowering::LowerOperation(SDValue Op,
                                                SelectionDAG &DAG) const {
   switch (Op.getOpcode()) {
   case ISD::GlobalAddress:    return LowerGlobalAddress(Op, DAG);
+  case ISD::GlobalTLSAddress: return LowerGlobalTLSAddress(Op, DAG);
   case ISD::ExternalSymbol:   return LowerExternalSymbol(Op, DAG);
   case ISD::BlockAddress:     return LowerBlockAddress(Op, DAG);
   case ISD::ConstantPool:     return LowerConstantPool(Op, DAG);
+  case ISD::JumpTable:        return LowerJumpTable(Op, DAG);
   case ISD::BR_CC:            return LowerBR_CC(Op, DAG);
   case ISD::SELECT_CC:        return LowerSELECT_CC(Op, DAG);
-  case ISD::SETCC:            return LowerSETCC(Op, DAG);
+  case ISD::SETCC:
+    return Op.getOperand(0).getValueType().isVector()
+               ? LowerSWAR_SETCC(Op, DAG)
+               : LowerSETCC(Op, DAG);
   case ISD::VASTART:          return LowerVASTART(Op, DAG);
+  case ISD::VAARG:            return LowerVAARG(Op, DAG);
   case ISD::FRAMEADDR:        return LowerFRAMEADDR(Op, DAG);
   case ISD::RETURNADDR:       return LowerRETURNADDR(Op, DAG);
+  case ISD::DYNAMIC_STACKALLOC: return LowerDYNAMIC_STACKALLOC(Op, DAG);
   case ISD::SHL_PARTS:        return LowerShiftLeftParts(Op, DAG);
+  case ISD::MUL:              return LowerMUL(Op, DAG);
   case ISD::SRL_PARTS:        return LowerShiftRightParts(Op, DAG, false);
   case ISD::SRA_PARTS:        return LowerShiftRightParts(Op, DAG, true);
+  case ISD::FSHL:
+  case ISD::FSHR:             return LowerFunnelShift(Op, DAG);
   case ISD::SELECT:           return LowerSELECT(Op, DAG);
+  case ISD::ATOMIC_FENCE:     return LowerATOMIC_FENCE(Op, DAG);
+  case ISD::BITCAST:          return LowerBITCAST(Op, DAG);
+  case ISD::FP_TO_UINT:       return LowerFP_TO_UINT(Op, DAG);
+  case ISD::SINT_TO_FP:
+  case ISD::UINT_TO_FP:       return LowerINT_TO_FP(Op, DAG);
+  case ISD::FTRUNC:
+  case ISD::FFLOOR:
+  case ISD::FCEIL:            return LowerFROUND_F32(Op, DAG);
+  case ISD::FP16_TO_FP:       return LowerFP16_TO_FP(Op, DAG);
+  case ISD::FP_TO_FP16:       return LowerFP_TO_FP16(Op, DAG);
+  case ISD::ADD:
+  case ISD::SUB:              return LowerSWAR_ADDSUB(Op, DAG);
+  case ISD::BUILD_VECTOR:     return LowerBUILD_VECTOR(Op, DAG);
+  case ISD::EXTRACT_VECTOR_ELT: return LowerEXTRACT_VECTOR_ELT(Op, DAG);
+  case ISD::INSERT_VECTOR_ELT: return LowerINSERT_VECTOR_ELT(Op, DAG);
+  case ISD::SCALAR_TO_VECTOR: return LowerSCALAR_TO_VECTOR(Op, DAG);
+  case ISD::VECTOR_SHUFFLE:   return LowerVECTOR_SHUFFLE(Op, DAG);
   default:
     llvm_unreachable("unimplemented operation");
   }
@@ -324,23 +665,140 @@ const char *M65832TargetLowering::getTargetNodeName(unsigned Opcode) const {
   switch (static_cast<M65832ISD::NodeType>(Opcode)) {
   case M65832ISD::FIRST_NUMBER: break;
   case M65832ISD::RET_FLAG:     return "M65832ISD::RET_FLAG";
+  case M65832ISD::RETI_FLAG:    return "M65832ISD::RETI_FLAG";
   case M65832ISD::CALL:         return "M65832ISD::CALL";
+  case M65832ISD::TAIL_CALL:    return "M65832ISD::TAIL_CALL";
   case M65832ISD::CMP:          return "M65832ISD::CMP";
   case M65832ISD::FCMP:         return "M65832ISD::FCMP";
   case M65832ISD::BR_CC:        return "M65832ISD::BR_CC";
   case M65832ISD::BR_CC_CMP:    return "M65832ISD::BR_CC_CMP";
+  case M65832ISD::BR_CC_CMP8:   return "M65832ISD::BR_CC_CMP8";
+  case M65832ISD::BR_CC_CMP16:  return "M65832ISD::BR_CC_CMP16";
+  case M65832ISD::BR_CC_FCMP:   return "M65832ISD::BR_CC_FCMP";
   case M65832ISD::SELECT_CC:    return "M65832ISD::SELECT_CC";
   case M65832ISD::SELECT_CC_MIXED: return "M65832ISD::SELECT_CC_MIXED";
   case M65832ISD::SELECT_CC_FP: return "M65832ISD::SELECT_CC_FP";
+  case M65832ISD::SELECT_CC_MASK: return "M65832ISD::SELECT_CC_MASK";
+  case M65832ISD::SELECT_CC_AND: return "M65832ISD::SELECT_CC_AND";
+  case M65832ISD::SETCC:        return "M65832ISD::SETCC";
   case M65832ISD::WRAPPER:      return "M65832ISD::WRAPPER";
+  case M65832ISD::PCREL_WRAPPER: return "M65832ISD::PCREL_WRAPPER";
+  case M65832ISD::TPREL_WRAPPER: return "M65832ISD::TPREL_WRAPPER";
   case M65832ISD::SMUL_LOHI:    return "M65832ISD::SMUL_LOHI";
   case M65832ISD::UMUL_LOHI:    return "M65832ISD::UMUL_LOHI";
   case M65832ISD::SDIVREM:      return "M65832ISD::SDIVREM";
   case M65832ISD::UDIVREM:      return "M65832ISD::UDIVREM";
+  case M65832ISD::MUL_LOOP:     return "M65832ISD::MUL_LOOP";
+  case M65832ISD::ADD64:        return "M65832ISD::ADD64";
+  case M65832ISD::SUB64:        return "M65832ISD::SUB64";
+  case M65832ISD::BLOCK_MOVE:   return "M65832ISD::BLOCK_MOVE";
+  case M65832ISD::BLOCK_MOVE_SAFE: return "M65832ISD::BLOCK_MOVE_SAFE";
+  case M65832ISD::DYN_ALLOC:    return "M65832ISD::DYN_ALLOC";
+  case M65832ISD::SPLIT_F64:    return "M65832ISD::SPLIT_F64";
+  case M65832ISD::BUILD_F64:    return "M65832ISD::BUILD_F64";
   }
   return nullptr;
 }
 
+void M65832TargetLowering::ReplaceNodeResults(SDNode *N,
+                                              SmallVectorImpl<SDValue> &Results,
+                                              SelectionDAG &DAG) const {
+  switch (N->getOpcode()) {
+  default:
+    return;
+  case ISD::ADD:
+  case ISD::SUB: {
+    SDLoc DL(N);
+    auto [LHSLo, LHSHi] =
+        DAG.SplitScalar(N->getOperand(0), DL, MVT::i32, MVT::i32);
+    auto [RHSLo, RHSHi] =
+        DAG.SplitScalar(N->getOperand(1), DL, MVT::i32, MVT::i32);
+    unsigned Opc =
+        N->getOpcode() == ISD::ADD ? M65832ISD::ADD64 : M65832ISD::SUB64;
+    SDValue Res = DAG.getNode(Opc, DL, DAG.getVTList(MVT::i32, MVT::i32),
+                              LHSLo, LHSHi, RHSLo, RHSHi);
+    Results.push_back(DAG.getNode(ISD::BUILD_PAIR, DL, MVT::i64,
+                                  Res.getValue(0), Res.getValue(1)));
+    return;
+  }
+  case ISD::BITCAST: {
+    // i64 = bitcast f64
+    SDValue Src = N->getOperand(0);
+    if (N->getValueType(0) != MVT::i64 || Src.getValueType() != MVT::f64)
+      return;
+    SDLoc DL(N);
+    SDValue Split = DAG.getNode(M65832ISD::SPLIT_F64, DL,
+                                DAG.getVTList(MVT::i32, MVT::i32), Src);
+    Results.push_back(DAG.getNode(ISD::BUILD_PAIR, DL, MVT::i64,
+                                  Split.getValue(0), Split.getValue(1)));
+    return;
+  }
+  case ISD::CTLZ:
+  case ISD::CTLZ_ZERO_UNDEF:
+  case ISD::CTTZ:
+  case ISD::CTTZ_ZERO_UNDEF: {
+    // CLZ/CTZ of 0 is 32, so the far half's count is only added when the
+    // near half is 0: ctlz(hi) + (hi == 0 ? ctlz(lo) : 0), an AND-mask
+    // select with no +32.
+    SDLoc DL(N);
+    auto [Lo, Hi] =
+        DAG.SplitScalar(N->getOperand(0), DL, MVT::i32, MVT::i32);
+    bool IsCTLZ = N->getOpcode() == ISD::CTLZ ||
+                  N->getOpcode() == ISD::CTLZ_ZERO_UNDEF;
+    unsigned CountOpc = IsCTLZ ? ISD::CTLZ : ISD::CTTZ;
+    SDValue Near = IsCTLZ ? Hi : Lo;
+    SDValue Far = IsCTLZ ? Lo : Hi;
+    SDValue Zero = DAG.getConstant(0, DL, MVT::i32);
+    SDValue FarCount = DAG.getSelectCC(
+        DL, Near, Zero, DAG.getNode(CountOpc, DL, MVT::i32, Far), Zero,
+        ISD::SETEQ);
+    SDValue Count =
+        DAG.getNode(ISD::ADD, DL, MVT::i32,
+                    DAG.getNode(CountOpc, DL, MVT::i32, Near), FarCount);
+    Results.push_back(
+        DAG.getNode(ISD::BUILD_PAIR, DL, MVT::i64, Count, Zero));
+    return;
+  }
+  case ISD::READCYCLECOUNTER: {
+    // Two volatile loads, low word first so the counter latches the high
+    // word that goes with it
+    SDLoc DL(N);
+    auto Flags = MachineMemOperand::MOVolatile;
+    SDValue Lo = DAG.getLoad(MVT::i32, DL, N->getOperand(0),
+                             DAG.getConstant(CycleCounterAddr, DL, MVT::i32),
+                             MachinePointerInfo(), Align(4), Flags);
+    SDValue Hi = DAG.getLoad(
+        MVT::i32, DL, Lo.getValue(1),
+        DAG.getConstant(CycleCounterAddr + 4, DL, MVT::i32),
+        MachinePointerInfo(), Align(4), Flags);
+    Results.push_back(DAG.getNode(ISD::BUILD_PAIR, DL, MVT::i64, Lo, Hi));
+    Results.push_back(Hi.getValue(1));
+    return;
+  }
+  }
+}
+
+SDValue M65832TargetLowering::LowerBITCAST(SDValue Op,
+                                           SelectionDAG &DAG) const {
+  // f64 = bitcast i64
+  SDValue Src = Op.getOperand(0);
+  if (Op.getValueType() != MVT::f64 || Src.getValueType() != MVT::i64)
+    return SDValue();
+  SDLoc DL(Op);
+  auto [Lo, Hi] = DAG.SplitScalar(Src, DL, MVT::i32, MVT::i32);
+  return DAG.getNode(M65832ISD::BUILD_F64, DL, MVT::f64, Lo, Hi);
+}
+
+// There is no GOT: -fPIC code reaches every symbol, including external
+// ones, at its distance from the code, which holds as long as the whole
+// image is loaded as one block
+SDValue M65832TargetLowering::wrapAddress(SDValue Addr, const SDLoc &DL,
+                                          SelectionDAG &DAG) const {
+  unsigned Opc = isPositionIndependent() ? M65832ISD::PCREL_WRAPPER
+                                         : M65832ISD::WRAPPER;
+  return DAG.getNode(Opc, DL, MVT::i32, Addr);
+}
+
 SDValue M65832TargetLowering::LowerGlobalAddress(SDValue Op,
                                                    SelectionDAG &DAG) const {
   SDLoc DL(Op);
@@ -349,7 +807,23 @@ SDValue M65832TargetLowering::LowerGlobalAddress(SDValue Op,
   int64_t Offset = GN->getOffset();
   
   SDValue GA = DAG.getTargetGlobalAddress(GV, DL, MVT::i32, Offset);
-  return DAG.getNode(M65832ISD::WRAPPER, DL, MVT::i32, GA);
+  return wrapAddress(GA, DL, DAG);
+}
+
+// A program is linked as one static image with no dynamic loader, so every
+// TLS model resolves to local-exec: the symbol's offset in the TLS segment
+// is a link-time constant, added to the thread pointer in R56. That also
+// holds for -fPIC, where the offset does not depend on the load address.
+SDValue M65832TargetLowering::LowerGlobalTLSAddress(SDValue Op,
+                                                    SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  const GlobalAddressSDNode *GN = cast<GlobalAddressSDNode>(Op);
+  if (DAG.getTarget().useEmulatedTLS())
+    return LowerToTLSEmulatedModel(GN, DAG);
+
+  SDValue GA = DAG.getTargetGlobalAddress(GN->getGlobal(), DL, MVT::i32,
+                                          GN->getOffset(), M65832II::MO_TPREL);
+  return DAG.getNode(M65832ISD::TPREL_WRAPPER, DL, MVT::i32, GA);
 }
 
 SDValue M65832TargetLowering::LowerExternalSymbol(SDValue Op,
@@ -358,7 +832,7 @@ SDValue M65832TargetLowering::LowerExternalSymbol(SDValue Op,
   const ExternalSymbolSDNode *ES = cast<ExternalSymbolSDNode>(Op);
   
   SDValue Symbol = DAG.getTargetExternalSymbol(ES->getSymbol(), MVT::i32);
-  return DAG.getNode(M65832ISD::WRAPPER, DL, MVT::i32, Symbol);
+  return wrapAddress(Symbol, DL, DAG);
 }
 
 SDValue M65832TargetLowering::LowerBlockAddress(SDValue Op,
@@ -367,7 +841,7 @@ SDValue M65832TargetLowering::LowerBlockAddress(SDValue Op,
   const BlockAddressSDNode *BA = cast<BlockAddressSDNode>(Op);
   
   SDValue Addr = DAG.getTargetBlockAddress(BA->getBlockAddress(), MVT::i32);
-  return DAG.getNode(M65832ISD::WRAPPER, DL, MVT::i32, Addr);
+  return wrapAddress(Addr, DL, DAG);
 }
 
 SDValue M65832TargetLowering::LowerConstantPool(SDValue Op,
@@ -383,7 +857,16 @@ SDValue M65832TargetLowering::LowerConstantPool(SDValue Op,
     Addr = DAG.getTargetConstantPool(CP->getConstVal(), MVT::i32,
                                      CP->getAlign(), CP->getOffset());
   
-  return DAG.getNode(M65832ISD::WRAPPER, DL, MVT::i32, Addr);
+  return wrapAddress(Addr, DL, DAG);
+}
+
+SDValue M65832TargetLowering::LowerJumpTable(SDValue Op,
+                                               SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  const JumpTableSDNode *JT = cast<JumpTableSDNode>(Op);
+
+  SDValue Addr = DAG.getTargetJumpTable(JT->getIndex(), MVT::i32);
+  return wrapAddress(Addr, DL, DAG);
 }
 
 SDValue M65832TargetLowering::LowerBR_CC(SDValue Op, SelectionDAG &DAG) const {
@@ -396,38 +879,33 @@ SDValue M65832TargetLowering::LowerBR_CC(SDValue Op, SelectionDAG &DAG) const {
   
   EVT CmpVT = LHS.getValueType();
   if (CmpVT == MVT::f32 || CmpVT == MVT::f64) {
-    SDValue Cmp = DAG.getNode(M65832ISD::FCMP, DL, MVT::Glue, LHS, RHS);
-    SDValue CCVal = DAG.getConstant(CC, DL, MVT::i32);
-    return DAG.getNode(M65832ISD::BR_CC, DL, Op.getValueType(), Chain, Dest,
-                       CCVal, Cmp);
+    canonicalizeFPCC(CC, LHS, RHS, DAG);
+    if (CC == ISD::SETONE) {
+      // No branch pair covers "ordered and not equal"; branch on the
+      // materialized UEQ result being false instead.
+      SDValue IsUEQ = DAG.getNode(
+          M65832ISD::SELECT_CC_FP, DL, MVT::i32, LHS, RHS,
+          DAG.getConstant(1, DL, MVT::i32), DAG.getConstant(0, DL, MVT::i32),
+          DAG.getConstant(ISD::SETUEQ, DL, MVT::i32));
+      return DAG.getNode(M65832ISD::BR_CC_CMP, DL, Op.getValueType(), Chain,
+                         IsUEQ, DAG.getConstant(0, DL, MVT::i32),
+                         DAG.getConstant(ISD::SETEQ, DL, MVT::i32), Dest);
+    }
+    // Fused FCMP + Bcc, so nothing can clobber the flags in between
+    return DAG.getNode(M65832ISD::BR_CC_FCMP, DL, Op.getValueType(), Chain,
+                       LHS, RHS, DAG.getConstant(CC, DL, MVT::i32), Dest);
   }
 
   // Canonicalize to avoid SETGT/SETLE/SETUGT/SETULE in fused branch
-  switch (CC) {
-  case ISD::SETGT:
-    CC = ISD::SETLT;
-    std::swap(LHS, RHS);
-    break;
-  case ISD::SETLE:
-    CC = ISD::SETGE;
-    std::swap(LHS, RHS);
-    break;
-  case ISD::SETUGT:
-    CC = ISD::SETULT;
-    std::swap(LHS, RHS);
-    break;
-  case ISD::SETULE:
-    CC = ISD::SETUGE;
-    std::swap(LHS, RHS);
-    break;
-  default:
-    break;
-  }
+  canonicalizeIntCC(CC, LHS, RHS, DAG, DL);
 
   // For integers, use fused compare-and-branch to prevent flag clobbering
+  unsigned Opc = M65832ISD::BR_CC_CMP;
+  if (unsigned Bits = narrowIntCompare(CC, LHS, RHS, DAG))
+    Opc = Bits == 8 ? M65832ISD::BR_CC_CMP8 : M65832ISD::BR_CC_CMP16;
   SDValue CCVal = DAG.getConstant(CC, DL, MVT::i32);
-  return DAG.getNode(M65832ISD::BR_CC_CMP, DL, Op.getValueType(), Chain,
-                     LHS, RHS, CCVal, Dest);
+  return DAG.getNode(Opc, DL, Op.getValueType(), Chain, LHS, RHS, CCVal,
+                     Dest);
 }
 
 SDValue M65832TargetLowering::LowerSELECT_CC(SDValue Op,
@@ -440,36 +918,20 @@ SDValue M65832TargetLowering::LowerSELECT_CC(SDValue Op,
   ISD::CondCode CC = cast<CondCodeSDNode>(Op.getOperand(4))->get();
   EVT CmpVT = LHS.getValueType();
   
-  // For floating point comparisons, use FCMP with glue-based SELECT_CC_FP
-  // FP operations don't have the flag-clobbering issue that integer ops do
+  // For floating point comparisons, SELECT_CC_FP carries the FCMP operands
   if (CmpVT == MVT::f32 || CmpVT == MVT::f64) {
-    SDValue Cmp = DAG.getNode(M65832ISD::FCMP, DL, MVT::Glue, LHS, RHS);
+    canonicalizeFPCC(CC, LHS, RHS, DAG);
+    if (CC == ISD::SETONE) {
+      CC = ISD::SETUEQ;
+      std::swap(TrueVal, FalseVal);
+    }
     SDValue CCVal = DAG.getConstant(CC, DL, MVT::i32);
-    return DAG.getNode(M65832ISD::SELECT_CC_FP, DL, Op.getValueType(), 
-                       TrueVal, FalseVal, CCVal, Cmp);
+    return DAG.getNode(M65832ISD::SELECT_CC_FP, DL, Op.getValueType(), LHS,
+                       RHS, TrueVal, FalseVal, CCVal);
   }
   
   // Canonicalize integer comparisons to avoid SETGT/SETLE/SETUGT/SETULE
-  switch (CC) {
-  case ISD::SETGT:
-    CC = ISD::SETLT;
-    std::swap(LHS, RHS);
-    break;
-  case ISD::SETLE:
-    CC = ISD::SETGE;
-    std::swap(LHS, RHS);
-    break;
-  case ISD::SETUGT:
-    CC = ISD::SETULT;
-    std::swap(LHS, RHS);
-    break;
-  case ISD::SETULE:
-    CC = ISD::SETUGE;
-    std::swap(LHS, RHS);
-    break;
-  default:
-    break;
-  }
+  canonicalizeIntCC(CC, LHS, RHS, DAG, DL);
 
   // For integers, include LHS/RHS so each SELECT has its own CMP
   // This ensures flags aren't clobbered by intervening instructions
@@ -477,12 +939,45 @@ SDValue M65832TargetLowering::LowerSELECT_CC(SDValue Op,
   
   // If result type is FP but comparison is integer, use SELECT_CC_MIXED
   EVT ResultVT = Op.getValueType();
+  if (ResultVT == MVT::i32) {
+    // x ? v : 0 only needs the mask ANDed with v, which is no bigger than
+    // the branch form, so it is used even at -Os.
+    auto TryAnd = [&](SDValue Val, SDValue Zero, ISD::CondCode Cond) {
+      if (!isNullConstant(Zero) || !isMaskSelectCC(Cond))
+        return SDValue();
+      return DAG.getNode(M65832ISD::SELECT_CC_AND, DL, MVT::i32, LHS, RHS,
+                         Val, DAG.getConstant(Cond, DL, MVT::i32));
+    };
+    if (SDValue R = TryAnd(TrueVal, FalseVal, CC))
+      return R;
+    if (SDValue R = TryAnd(FalseVal, TrueVal, ISD::getSetCCInverse(CC, CmpVT)))
+      return R;
+    if (isMaskSelectCC(CC) && EnableBranchlessSelect &&
+        !DAG.getMachineFunction().getFunction().hasOptSize())
+      return DAG.getNode(M65832ISD::SELECT_CC_MASK, DL, MVT::i32, LHS, RHS,
+                         TrueVal, FalseVal, CCVal);
+  }
   unsigned Opc = ResultVT.isFloatingPoint() ? M65832ISD::SELECT_CC_MIXED 
                                              : M65832ISD::SELECT_CC;
   
   return DAG.getNode(Opc, DL, ResultVT, LHS, RHS, TrueVal, FalseVal, CCVal);
 }
 
+bool M65832TargetLowering::isMaskSelectCC(ISD::CondCode CC) {
+  // These conditions come straight out of the carry (EQ/NE via
+  // (lhs ^ rhs) <u 1). Signed ones would first need both sides biased by
+  // $80000000, which makes the sequence longer than the branch it replaces.
+  switch (CC) {
+  case ISD::SETEQ:
+  case ISD::SETNE:
+  case ISD::SETULT:
+  case ISD::SETUGE:
+    return true;
+  default:
+    return false;
+  }
+}
+
 SDValue M65832TargetLowering::LowerSETCC(SDValue Op, SelectionDAG &DAG) const {
   SDLoc DL(Op);
   SDValue LHS = Op.getOperand(0);
@@ -494,39 +989,33 @@ SDValue M65832TargetLowering::LowerSETCC(SDValue Op, SelectionDAG &DAG) const {
   SDValue Zero = DAG.getConstant(0, DL, MVT::i32);
   SDValue CCVal = DAG.getConstant(CC, DL, MVT::i32);
   
-  // For floating point comparisons, use FCMP with glue-based SELECT_CC_FP
+  // For floating point comparisons, SELECT_CC_FP carries the FCMP operands
   if (CmpVT == MVT::f32 || CmpVT == MVT::f64) {
-    SDValue Cmp = DAG.getNode(M65832ISD::FCMP, DL, MVT::Glue, LHS, RHS);
-    return DAG.getNode(M65832ISD::SELECT_CC_FP, DL, MVT::i32, 
-                       One, Zero, CCVal, Cmp);
+    canonicalizeFPCC(CC, LHS, RHS, DAG);
+    if (CC == ISD::SETONE) {
+      CC = ISD::SETUEQ;
+      std::swap(One, Zero);
+    }
+    return DAG.getNode(M65832ISD::SELECT_CC_FP, DL, MVT::i32, LHS, RHS, One,
+                       Zero, DAG.getConstant(CC, DL, MVT::i32));
   }
   
   // Canonicalize integer comparisons to avoid SETGT/SETLE/SETUGT/SETULE
-  switch (CC) {
-  case ISD::SETGT:
-    CC = ISD::SETLT;
-    std::swap(LHS, RHS);
-    break;
-  case ISD::SETLE:
-    CC = ISD::SETGE;
-    std::swap(LHS, RHS);
-    break;
-  case ISD::SETUGT:
-    CC = ISD::SETULT;
-    std::swap(LHS, RHS);
-    break;
-  case ISD::SETULE:
-    CC = ISD::SETUGE;
-    std::swap(LHS, RHS);
-    break;
-  default:
-    break;
+  canonicalizeIntCC(CC, LHS, RHS, DAG, DL);
+
+  // The sign of x against 0 is one shift
+  if (isNullConstant(RHS) && (CC == ISD::SETLT || CC == ISD::SETGE)) {
+    SDValue Sign = DAG.getNode(ISD::SRL, DL, MVT::i32, LHS,
+                               DAG.getConstant(31, DL, MVT::i32));
+    return CC == ISD::SETLT ? Sign
+                            : DAG.getNode(ISD::XOR, DL, MVT::i32, Sign, One);
   }
 
-  // For integers, include LHS/RHS for comparison
+  // Every other integer predicate is a compare that leaves the answer in
+  // C, rotated into bit 0 (SETCC_PSEUDO). That is no bigger than the
+  // select diamond with its two constants, so it is used even at -Os.
   CCVal = DAG.getConstant(CC, DL, MVT::i32);
-  return DAG.getNode(M65832ISD::SELECT_CC, DL, MVT::i32, 
-                     LHS, RHS, One, Zero, CCVal);
+  return DAG.getNode(M65832ISD::SETCC, DL, MVT::i32, LHS, RHS, CCVal);
 }
 
 SDValue M65832TargetLowering::LowerSELECT(SDValue Op, SelectionDAG &DAG) const {
@@ -549,6 +1038,447 @@ SDValue M65832TargetLowering::LowerSELECT(SDValue Op, SelectionDAG &DAG) const {
   return DAG.getNode(Opc, DL, VT, Cond, Zero, TrueVal, FalseVal, CCVal);
 }
 
+// (double)(uint32_t)V: the bit pattern 0x43300000:V is 2^52 + V exactly
+static SDValue getU32ToF64(SDValue V, const SDLoc &DL, SelectionDAG &DAG) {
+  SDValue Biased = DAG.getNode(M65832ISD::BUILD_F64, DL, MVT::f64, V,
+                               DAG.getConstant(0x43300000, DL, MVT::i32));
+  return DAG.getNode(ISD::FSUB, DL, MVT::f64, Biased,
+                     DAG.getConstantFP(4503599627370496.0, DL, MVT::f64));
+}
+
+SDValue M65832TargetLowering::LowerFP_TO_UINT(SDValue Op,
+                                              SelectionDAG &DAG) const {
+  // x < 2^31 ? F2I(x) : F2I(x - 2^31) ^ 0x80000000
+  SDLoc DL(Op);
+  SDValue X = Op.getOperand(0);
+  EVT SrcVT = X.getValueType();
+  SDValue Limit = DAG.getConstantFP(2147483648.0, DL, SrcVT);
+  SDValue Small = DAG.getNode(ISD::FP_TO_SINT, DL, MVT::i32, X);
+  SDValue Big = DAG.getNode(
+      ISD::XOR, DL, MVT::i32,
+      DAG.getNode(ISD::FP_TO_SINT, DL, MVT::i32,
+                  DAG.getNode(ISD::FSUB, DL, SrcVT, X, Limit)),
+      DAG.getConstant(0x80000000, DL, MVT::i32));
+  return DAG.getSelectCC(DL, X, Limit, Small, Big, ISD::SETOLT);
+}
+
+SDValue M65832TargetLowering::LowerINT_TO_FP(SDValue Op,
+                                             SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  SDValue Src = Op.getOperand(0);
+  EVT VT = Op.getValueType();
+  bool IsSigned = Op.getOpcode() == ISD::SINT_TO_FP;
+
+  if (Src.getValueType() == MVT::i32) {
+    // u32 -> f64 is exact, so u32 -> f32 rounds only once in FCVT.SD
+    SDValue R = getU32ToF64(Src, DL, DAG);
+    if (VT == MVT::f32)
+      R = DAG.getNode(ISD::FP_ROUND, DL, MVT::f32, R,
+                      DAG.getIntPtrConstant(0, DL, /*isTarget=*/true));
+    return R;
+  }
+
+  // i64 -> f64 as hi * 2^32 + (double)lo. Both halves and the product are
+  // exact, so the final add is the only rounding. i64 -> f32 would round
+  // twice and is left to the libcall.
+  if (Src.getValueType() != MVT::i64 || VT != MVT::f64)
+    return SDValue();
+  auto [Lo, Hi] = DAG.SplitScalar(Src, DL, MVT::i32, MVT::i32);
+  SDValue HiF = IsSigned ? DAG.getNode(ISD::SINT_TO_FP, DL, MVT::f64, Hi)
+                         : getU32ToF64(Hi, DL, DAG);
+  SDValue LoF = getU32ToF64(Lo, DL, DAG);
+  SDValue Scale = DAG.getConstantFP(4294967296.0, DL, MVT::f64);
+  if (Subtarget.hasFPUFMA())
+    return DAG.getNode(ISD::FMA, DL, MVT::f64, HiF, Scale, LoF);
+  return DAG.getNode(ISD::FADD, DL, MVT::f64,
+                     DAG.getNode(ISD::FMUL, DL, MVT::f64, HiF, Scale), LoF);
+}
+
+bool M65832TargetLowering::isIntDivCheap(EVT VT, AttributeList Attr) const {
+  // LDA/DIV/STA is shorter than LDA/MULU/TTA/SHR/STA, so keep it for size
+  if (Attr.hasFnAttr(Attribute::MinSize))
+    return true;
+  return !Subtarget.isDivSlow() && Attr.hasFnAttr(Attribute::OptimizeForSize);
+}
+
+TargetLowering::ShiftLegalizationStrategy
+M65832TargetLowering::preferredShiftLegalizationStrategy(
+    SelectionDAG &DAG, SDNode *N, unsigned ExpansionFactor) const {
+  // The SHL_PARTS expansion is a dozen extended-ALU ops and two select
+  // diamonds; the call is four instructions
+  if (ExpansionFactor == 1 &&
+      DAG.getMachineFunction().getFunction().hasMinSize())
+    return ShiftLegalizationStrategy::LowerToLibcall;
+  return TargetLowering::preferredShiftLegalizationStrategy(DAG, N,
+                                                            ExpansionFactor);
+}
+
+/// Latency of \p Opc in the scheduling model of the CPU being tuned for.
+static unsigned getLatency(const M65832Subtarget &STI, unsigned Opc) {
+  const MCSchedModel &SM = STI.getSchedModel();
+  int Latency = SM.computeInstrLatency(
+      STI, STI.getInstrInfo()->get(Opc).getSchedClass());
+  return Latency > 0 ? Latency : 1;
+}
+
+/// Whether \p Shifts barrel shifts and \p AddSubs extended-ALU adds or
+/// subtracts are quicker than LDA; MUL; STA, or there is no MUL to beat.
+static bool shiftAddBeatsMul(const M65832Subtarget &STI, unsigned Shifts,
+                             unsigned AddSubs) {
+  if (!STI.hasHWMul())
+    return true;
+  unsigned MulCycles = getLatency(STI, M65832::LDA_DP) +
+                       getLatency(STI, M65832::MUL_DP) +
+                       getLatency(STI, M65832::STA_DP);
+  return Shifts * getLatency(STI, M65832::SHLR) +
+             AddSubs * getLatency(STI, M65832::ADDR_DP) <
+         MulCycles;
+}
+
+bool M65832TargetLowering::isLegalAddressingMode(const DataLayout &DL,
+                                                 const AddrMode &AM, Type *Ty,
+                                                 unsigned AddrSpace,
+                                                 Instruction *I) const {
+  // Globals are absolute B+addr operands with the offset in the fixup
+  if (AM.BaseGV)
+    return !AM.HasBaseReg && !AM.Scale;
+
+  // LDF/STF (Rm): an offset or index is an ADD of its own (selectAddrFP)
+  bool IsFP = Ty && Ty->isFloatingPointTy();
+  switch (AM.Scale) {
+  case 0:
+    break;
+  case 1:
+    if (!AM.HasBaseReg)
+      break;
+    // base + index is LDY index; (base),Y, with no room for an offset too
+    return !IsFP && AM.BaseOffs == 0;
+  default:
+    // No scaled index in any mode
+    return false;
+  }
+  return !IsFP || AM.BaseOffs == 0;
+}
+
+bool M65832TargetLowering::isMaskAndCmp0FoldingBeneficial(
+    const Instruction &AndI) const {
+  // The AND leaves Z set from its result, so a compare of it against 0 is
+  // dropped after RA (flagsReflectReg) once both are in the same block
+  return AndI.getType()->isIntegerTy(32);
+}
+
+bool M65832TargetLowering::decomposeMulByConstant(LLVMContext &Context,
+                                                  EVT VT, SDValue C) const {
+  // DAGCombiner turns these into (x << (n + m)) +- (x << m), an extra
+  // shift when m is not 0 and a negate for a negative constant.
+  if (VT != MVT::i32)
+    return false;
+  auto *ConstNode = dyn_cast<ConstantSDNode>(C);
+  if (!ConstNode)
+    return false;
+  const APInt &Imm = ConstNode->getAPIntValue();
+  APInt MulC = Imm.abs();
+  unsigned TZeros = MulC == 2 ? 0 : MulC.countr_zero();
+  MulC.lshrInPlace(TZeros);
+  if (!(MulC - 1).isPowerOf2() && !(MulC + 1).isPowerOf2())
+    return false;
+  return shiftAddBeatsMul(Subtarget, TZeros ? 2 : 1,
+                          Imm.isNegative() ? 2 : 1);
+}
+
+SDValue M65832TargetLowering::LowerMUL(SDValue Op, SelectionDAG &DAG) const {
+  // The loop is 21 bytes against a 5-byte JSR
+  if (DAG.getMachineFunction().getFunction().hasOptSize())
+    return SDValue();
+  SDLoc DL(Op);
+  return DAG.getNode(M65832ISD::MUL_LOOP, DL,
+                     DAG.getVTList(MVT::i32, MVT::i32, MVT::i32),
+                     Op.getOperand(0), Op.getOperand(1));
+}
+
+/// Multiply by a constant with up to four non-zero digits in its
+/// non-adjacent form (x * 11 = (x << 3) + (x << 1) + x) as shifts and
+/// adds. DAGCombiner already handles the two-digit constants through
+/// decomposeMulByConstant.
+static SDValue combineMulByConstant(SDNode *N, SelectionDAG &DAG,
+                                    const M65832Subtarget &STI) {
+  auto *ConstNode = dyn_cast<ConstantSDNode>(N->getOperand(1));
+  if (N->getValueType(0) != MVT::i32 || !ConstNode ||
+      (STI.hasHWMul() && DAG.getMachineFunction().getFunction().hasOptSize()))
+    return SDValue();
+  const APInt &Imm = ConstNode->getAPIntValue();
+  if (Imm.isMinSignedValue())
+    return SDValue();
+
+  // Non-adjacent form, lowest digit first: (shift, subtract)
+  SmallVector<std::pair<unsigned, bool>, 4> Digits;
+  APInt MulC = Imm.abs();
+  for (unsigned Bit = 0; !MulC.isZero(); ++Bit, MulC.lshrInPlace(1)) {
+    if (!MulC[0])
+      continue;
+    if (Digits.size() == 4)
+      return SDValue();
+    bool Sub = MulC[1];
+    Digits.push_back({Bit, Sub});
+    if (Sub)
+      ++MulC;
+    else
+      --MulC;
+  }
+  if (Digits.size() < 3)
+    return SDValue();
+
+  unsigned Shifts = llvm::count_if(
+      Digits, [](const auto &Digit) { return Digit.first != 0; });
+  unsigned AddSubs = Digits.size() - 1 + Imm.isNegative();
+  if (!shiftAddBeatsMul(STI, Shifts, AddSubs))
+    return SDValue();
+
+  SDLoc DL(N);
+  SDValue X = N->getOperand(0);
+  auto Term = [&](unsigned Shift) {
+    return Shift ? DAG.getNode(ISD::SHL, DL, MVT::i32, X,
+                               DAG.getConstant(Shift, DL, MVT::i32))
+                 : X;
+  };
+  // The top digit is always an add
+  SDValue R = Term(Digits.back().first);
+  for (const auto &[Shift, Sub] : llvm::drop_end(Digits))
+    R = DAG.getNode(Sub ? ISD::SUB : ISD::ADD, DL, MVT::i32, R, Term(Shift));
+  return Imm.isNegative() ? DAG.getNegative(R, DL, MVT::i32) : R;
+}
+
+/// Bit-field insert, (x & ~M) | (y & M), as the masked merge
+/// x ^ ((x ^ y) & M): one 32-bit mask immediate instead of two. The
+/// combiner only turns it back on targets with an and-not.
+static SDValue combineBitfieldInsert(SDNode *N, SelectionDAG &DAG) {
+  if (N->getValueType(0) != MVT::i32)
+    return SDValue();
+  SDValue LHS = N->getOperand(0);
+  SDValue RHS = N->getOperand(1);
+  if (LHS.getOpcode() != ISD::AND || RHS.getOpcode() != ISD::AND ||
+      !LHS.hasOneUse() || !RHS.hasOneUse())
+    return SDValue();
+  auto *KeepC = dyn_cast<ConstantSDNode>(LHS.getOperand(1));
+  auto *InsC = dyn_cast<ConstantSDNode>(RHS.getOperand(1));
+  if (!KeepC || !InsC || KeepC->getAPIntValue() != ~InsC->getAPIntValue())
+    return SDValue();
+
+  SDLoc DL(N);
+  SDValue X = LHS.getOperand(0);
+  SDValue Diff = DAG.getNode(ISD::XOR, DL, MVT::i32, X, RHS.getOperand(0));
+  SDValue Field = DAG.getNode(ISD::AND, DL, MVT::i32, Diff, RHS.getOperand(1));
+  return DAG.getNode(ISD::XOR, DL, MVT::i32, X, Field);
+}
+
+SDValue M65832TargetLowering::PerformDAGCombine(SDNode *N,
+                                                DAGCombinerInfo &DCI) const {
+  switch (N->getOpcode()) {
+  default:
+    return SDValue();
+  case ISD::MUL:
+    return combineMulByConstant(N, DCI.DAG, Subtarget);
+  case ISD::OR:
+    return combineBitfieldInsert(N, DCI.DAG);
+  }
+}
+
+SDValue
+M65832TargetLowering::BuildSDIVPow2(SDNode *N, const APInt &Divisor,
+                                    SelectionDAG &DAG,
+                                    SmallVectorImpl<SDNode *> &Created) const {
+  // Always take the generic SAR/SHR/ADD sequence, even at minsize: it is
+  // about as small as the DIV and avoids the slow divider entirely.
+  return SDValue();
+}
+
+bool M65832TargetLowering::isFMAFasterThanFMulAndFAdd(const MachineFunction &MF,
+                                                      EVT VT) const {
+  return Subtarget.hasFPUFMA() &&
+         (VT.getScalarType() == MVT::f32 || VT.getScalarType() == MVT::f64);
+}
+
+bool M65832TargetLowering::allowsMisalignedMemoryAccesses(
+    EVT VT, unsigned AddrSpace, Align Alignment, MachineMemOperand::Flags Flags,
+    unsigned *Fast) const {
+  if (!Subtarget.hasUnalignedAccess())
+    return false;
+  if (Fast)
+    *Fast = 1;
+  return true;
+}
+
+bool M65832TargetLowering::isI2FImm(const APFloat &Imm) {
+  // -0.0 is integral but I2F(0) gives +0.0
+  if (Imm.isNegZero() || !Imm.isInteger())
+    return false;
+  APSInt Int(32, /*isUnsigned=*/false);
+  bool IsExact;
+  return Imm.convertToInteger(Int, APFloat::rmTowardZero, &IsExact) ==
+         APFloat::opOK;
+}
+
+bool M65832TargetLowering::isFPImmLegal(const APFloat &Imm, EVT VT,
+                                        bool ForCodeSize) const {
+  if (VT != MVT::f32 && VT != MVT::f64)
+    return false;
+  return isI2FImm(Imm);
+}
+
+// f32 trunc/floor/ceil without FRINT. Anything with |x| >= 2^23 is already
+// integral (or NaN/Inf) and passes through; smaller values fit F2I's i32
+// range, so truncate via F2I/I2F and step by one for floor/ceil.
+SDValue M65832TargetLowering::LowerFROUND_F32(SDValue Op,
+                                              SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  SDValue X = Op.getOperand(0);
+  EVT VT = Op.getValueType();
+  if (VT != MVT::f32)
+    return SDValue();
+
+  SDValue Limit = DAG.getConstantFP(8388608.0, DL, VT); // 2^23
+  SDValue Zero = DAG.getConstantFP(0.0, DL, VT);
+  SDValue One = DAG.getConstantFP(1.0, DL, VT);
+
+  SDValue T = DAG.getNode(ISD::SINT_TO_FP, DL, VT,
+                          DAG.getNode(ISD::FP_TO_SINT, DL, MVT::i32, X));
+  // I2F(0) is +0.0; keep the sign of x so trunc(-0.5) == -0.0.
+  SDValue SignedZero = DAG.getNode(ISD::FMUL, DL, VT, X, Zero);
+  T = DAG.getSelectCC(DL, T, Zero, SignedZero, T, ISD::SETOEQ);
+
+  SDValue AbsX = DAG.getNode(ISD::FABS, DL, VT, X);
+  SDValue Trunc = DAG.getSelectCC(DL, AbsX, Limit, T, X, ISD::SETOLT);
+
+  switch (Op.getOpcode()) {
+  case ISD::FFLOOR:
+    return DAG.getSelectCC(DL, Trunc, X,
+                           DAG.getNode(ISD::FSUB, DL, VT, Trunc, One), Trunc,
+                           ISD::SETOGT);
+  case ISD::FCEIL:
+    return DAG.getSelectCC(DL, Trunc, X,
+                           DAG.getNode(ISD::FADD, DL, VT, Trunc, One), Trunc,
+                           ISD::SETOLT);
+  default:
+    return Trunc;
+  }
+}
+
+// half -> float on the bits: move exponent and mantissa up to their f32
+// places and rebias the exponent. Inf/NaN get the rest of the f32 range;
+// a denormal is rebuilt as 2^-14 * (1 + m) and the 2^-14 subtracted, which
+// is exact and never hands the FPU a denormal.
+SDValue M65832TargetLowering::LowerFP16_TO_FP(SDValue Op,
+                                              SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  if (Op.getValueType() != MVT::f32)
+    return SDValue();
+  SDValue H = DAG.getZExtOrTrunc(Op.getOperand(0), DL, MVT::i32);
+
+  auto Const = [&](uint32_t V) { return DAG.getConstant(V, DL, MVT::i32); };
+  SDValue Bits = DAG.getNode(ISD::SHL, DL, MVT::i32,
+                             DAG.getNode(ISD::AND, DL, MVT::i32, H,
+                                         Const(0x7fff)),
+                             Const(13));
+  SDValue Exp = DAG.getNode(ISD::AND, DL, MVT::i32, Bits, Const(0x0f800000));
+  SDValue Normal =
+      DAG.getNode(ISD::ADD, DL, MVT::i32, Bits, Const((127 - 15) << 23));
+  SDValue InfNaN =
+      DAG.getNode(ISD::ADD, DL, MVT::i32, Normal, Const((128 - 16) << 23));
+  SDValue Denorm = DAG.getNode(
+      ISD::FSUB, DL, MVT::f32,
+      DAG.getBitcast(MVT::f32, DAG.getNode(ISD::ADD, DL, MVT::i32, Normal,
+                                           Const(1 << 23))),
+      DAG.getConstantFP(1.0 / (1 << 14), DL, MVT::f32));
+
+  SDValue R = DAG.getSelectCC(DL, Exp, Const(0x0f800000), InfNaN, Normal,
+                              ISD::SETEQ);
+  R = DAG.getSelectCC(DL, Exp, Const(0), DAG.getBitcast(MVT::i32, Denorm), R,
+                      ISD::SETEQ);
+  SDValue Sign = DAG.getNode(ISD::SHL, DL, MVT::i32,
+                             DAG.getNode(ISD::AND, DL, MVT::i32, H,
+                                         Const(0x8000)),
+                             Const(16));
+  return DAG.getBitcast(MVT::f32, DAG.getNode(ISD::OR, DL, MVT::i32, R, Sign));
+}
+
+// float -> half, rounding to nearest even. Too large gives Inf (NaN stays
+// a quiet NaN). A normal result adds the rounding bias below bit 13 plus
+// the odd bit, then shifts; a denormal one comes from an FADD of 0.5, which
+// the FPU rounds at exactly the half denormal's last place.
+SDValue M65832TargetLowering::LowerFP_TO_FP16(SDValue Op,
+                                              SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  SDValue F = Op.getOperand(0);
+  if (F.getValueType() != MVT::f32)
+    return SDValue();
+
+  auto Const = [&](uint32_t V) { return DAG.getConstant(V, DL, MVT::i32); };
+  SDValue Bits = DAG.getBitcast(MVT::i32, F);
+  SDValue Sign = DAG.getNode(ISD::AND, DL, MVT::i32, Bits, Const(0x80000000));
+  SDValue Abs = DAG.getNode(ISD::XOR, DL, MVT::i32, Bits, Sign);
+
+  const uint32_t DenormMagic = ((127 - 15) + (23 - 10) + 1) << 23;
+  SDValue Denorm = DAG.getNode(
+      ISD::SUB, DL, MVT::i32,
+      DAG.getBitcast(MVT::i32,
+                     DAG.getNode(ISD::FADD, DL, MVT::f32,
+                                 DAG.getBitcast(MVT::f32, Abs),
+                                 DAG.getConstantFP(0.5, DL, MVT::f32))),
+      Const(DenormMagic));
+
+  SDValue Odd = DAG.getNode(ISD::AND, DL, MVT::i32,
+                            DAG.getNode(ISD::SRL, DL, MVT::i32, Abs,
+                                        Const(13)),
+                            Const(1));
+  SDValue Normal = DAG.getNode(ISD::ADD, DL, MVT::i32, Abs,
+                               Const((uint32_t(15 - 127) << 23) + 0xfff));
+  Normal = DAG.getNode(ISD::SRL, DL, MVT::i32,
+                       DAG.getNode(ISD::ADD, DL, MVT::i32, Normal, Odd),
+                       Const(13));
+
+  SDValue Overflow = DAG.getSelectCC(DL, Abs, Const(0x7f800000),
+                                     Const(0x7e00), Const(0x7c00),
+                                     ISD::SETUGT);
+  SDValue R = DAG.getSelectCC(DL, Abs, Const(113 << 23), Denorm, Normal,
+                              ISD::SETULT);
+  R = DAG.getSelectCC(DL, Abs, Const((127 + 16) << 23), Overflow, R,
+                      ISD::SETUGE);
+  R = DAG.getNode(ISD::OR, DL, MVT::i32, R,
+                  DAG.getNode(ISD::SRL, DL, MVT::i32, Sign, Const(16)));
+  return DAG.getZExtOrTrunc(R, DL, Op.getValueType());
+}
+
+SDValue M65832TargetLowering::LowerATOMIC_FENCE(SDValue Op,
+                                                SelectionDAG &DAG) const {
+  // A single-thread fence only has to stop the compiler from reordering;
+  // cross-thread fences are matched to FENCER/FENCEW/FENCE.
+  auto SSID = static_cast<SyncScope::ID>(Op.getConstantOperandVal(2));
+  if (SSID == SyncScope::SingleThread)
+    return DAG.getNode(ISD::MEMBARRIER, SDLoc(Op), MVT::Other,
+                       Op.getOperand(0));
+  return Op;
+}
+
+TargetLowering::AtomicExpansionKind
+M65832TargetLowering::shouldExpandAtomicRMWInIR(const AtomicRMWInst *AI) const {
+  // The LLI/SCI loops cover 32-bit add/sub/and/or/xor/nand/xchg. Everything
+  // else, including sub-word operations, becomes a cmpxchg loop.
+  if (AI->getType()->getPrimitiveSizeInBits() < 32)
+    return AtomicExpansionKind::CmpXChg;
+  switch (AI->getOperation()) {
+  case AtomicRMWInst::Xchg:
+  case AtomicRMWInst::Add:
+  case AtomicRMWInst::Sub:
+  case AtomicRMWInst::And:
+  case AtomicRMWInst::Or:
+  case AtomicRMWInst::Xor:
+  case AtomicRMWInst::Nand:
+    return AtomicExpansionKind::None;
+  default:
+    return AtomicExpansionKind::CmpXChg;
+  }
+}
+
 SDValue M65832TargetLowering::LowerVASTART(SDValue Op, SelectionDAG &DAG) const {
   MachineFunction &MF = DAG.getMachineFunction();
   M65832MachineFunctionInfo *FuncInfo = MF.getInfo<M65832MachineFunctionInfo>();
@@ -566,6 +1496,27 @@ SDValue M65832TargetLowering::LowerVASTART(SDValue Op, SelectionDAG &DAG) const
                       MachinePointerInfo(SV));
 }
 
+SDValue M65832TargetLowering::LowerVAARG(SDValue Op, SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  EVT VT = Op.getValueType();
+  SDValue Chain = Op.getOperand(0);
+  SDValue VAListPtr = Op.getOperand(1);
+  const Value *SV = cast<SrcValueSDNode>(Op.getOperand(2))->getValue();
+
+  // Every variadic argument has its own 4-byte aligned stack slot (see
+  // CC_M65832), so unlike the generic expansion there is no rounding of
+  // the pointer for i64/f64: load it, bump it past the slot and load the
+  // argument.
+  SDValue VAList = DAG.getLoad(MVT::i32, DL, Chain, VAListPtr,
+                               MachinePointerInfo(SV));
+  SDValue Next =
+      DAG.getNode(ISD::ADD, DL, MVT::i32, VAList,
+                  DAG.getConstant(alignTo(VT.getStoreSize(), 4), DL, MVT::i32));
+  Chain = DAG.getStore(VAList.getValue(1), DL, Next, VAListPtr,
+                       MachinePointerInfo(SV));
+  return DAG.getLoad(VT, DL, Chain, VAList, MachinePointerInfo(), Align(4));
+}
+
 SDValue M65832TargetLowering::LowerFRAMEADDR(SDValue Op,
                                                SelectionDAG &DAG) const {
   MachineFunction &MF = DAG.getMachineFunction();
@@ -584,6 +1535,26 @@ SDValue M65832TargetLowering::LowerFRAMEADDR(SDValue Op,
   return DAG.getCopyFromReg(DAG.getEntryNode(), DL, M65832::R29, MVT::i32);
 }
 
+SDValue M65832TargetLowering::LowerDYNAMIC_STACKALLOC(SDValue Op,
+                                                       SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  SDValue Chain = Op.getOperand(0);
+  SDValue Size = Op.getOperand(1);
+
+  // SP stays word-aligned: rounding SP - size down to the alignment also
+  // rounds the size up, so no separate ADD/AND of the size is needed.
+  MaybeAlign Requested =
+      cast<ConstantSDNode>(Op.getOperand(2))->getMaybeAlignValue();
+  Align A = std::max(Requested.valueOrOne(),
+                     Subtarget.getFrameLowering()->getStackAlign());
+  SDValue Mask = DAG.getTargetConstant(-(int64_t)A.value(), DL, MVT::i32);
+
+  SDValue Addr = DAG.getNode(M65832ISD::DYN_ALLOC, DL,
+                             DAG.getVTList(MVT::i32, MVT::Other), Chain, Size,
+                             Mask);
+  return DAG.getMergeValues({Addr, Addr.getValue(1)}, DL);
+}
+
 SDValue M65832TargetLowering::LowerRETURNADDR(SDValue Op,
                                                 SelectionDAG &DAG) const {
   MachineFunction &MF = DAG.getMachineFunction();
@@ -642,6 +1613,321 @@ SDValue M65832TargetLowering::LowerShiftLeftParts(SDValue Op,
   return DAG.getMergeValues(Parts, DL);
 }
 
+// fshl(x, y, z) = (x << z) | (y >> (32 - z)), fshr the mirror image, with
+// z taken mod 32. A constant amount is two barrel shifts and an OR. A
+// variable one goes through (y >> 1) >> (31 - z) so neither count reaches
+// 32, and once z is masked 31 - z is just z ^ 31.
+SDValue M65832TargetLowering::LowerFunnelShift(SDValue Op,
+                                               SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  SDValue X = Op.getOperand(0);
+  SDValue Y = Op.getOperand(1);
+  SDValue Z = Op.getOperand(2);
+  bool IsFSHL = Op.getOpcode() == ISD::FSHL;
+  if (X == Y)
+    return DAG.getNode(IsFSHL ? ISD::ROTL : ISD::ROTR, DL, MVT::i32, X, Z);
+
+  if (auto *C = dyn_cast<ConstantSDNode>(Z)) {
+    unsigned Amt = C->getZExtValue() % 32;
+    if (Amt == 0)
+      return IsFSHL ? X : Y;
+    unsigned ShlAmt = IsFSHL ? Amt : 32 - Amt;
+    SDValue Hi = DAG.getNode(ISD::SHL, DL, MVT::i32, X,
+                             DAG.getConstant(ShlAmt, DL, MVT::i32));
+    SDValue Lo = DAG.getNode(ISD::SRL, DL, MVT::i32, Y,
+                             DAG.getConstant(32 - ShlAmt, DL, MVT::i32));
+    return DAG.getNode(ISD::OR, DL, MVT::i32, Hi, Lo);
+  }
+
+  SDValue ThirtyOne = DAG.getConstant(31, DL, MVT::i32);
+  SDValue One = DAG.getConstant(1, DL, MVT::i32);
+  SDValue Amt = DAG.getNode(ISD::AND, DL, MVT::i32, Z, ThirtyOne);
+  SDValue InvAmt = DAG.getNode(ISD::XOR, DL, MVT::i32, Amt, ThirtyOne);
+  SDValue Hi, Lo;
+  if (IsFSHL) {
+    Hi = DAG.getNode(ISD::SHL, DL, MVT::i32, X, Amt);
+    Lo = DAG.getNode(ISD::SRL, DL, MVT::i32,
+                     DAG.getNode(ISD::SRL, DL, MVT::i32, Y, One), InvAmt);
+  } else {
+    Hi = DAG.getNode(ISD::SHL, DL, MVT::i32,
+                     DAG.getNode(ISD::SHL, DL, MVT::i32, X, One), InvAmt);
+    Lo = DAG.getNode(ISD::SRL, DL, MVT::i32, Y, Amt);
+  }
+  return DAG.getNode(ISD::OR, DL, MVT::i32, Hi, Lo);
+}
+
+// SWAR vectors are i32s with lane 0 in the low bits. H below is the top bit
+// of every lane and L the rest: carries and borrows are kept from crossing
+// into the next lane by working out the low bits and the top bits apart.
+
+/// \p Lane repeated across an i32 at every multiple of \p Bits
+static uint32_t splatLanes(uint32_t Lane, unsigned Bits) {
+  uint32_t R = 0;
+  for (unsigned Shift = 0; Shift < 32; Shift += Bits)
+    R |= Lane << Shift;
+  return R;
+}
+
+/// Lane-wise a + b or a - b on the i32s holding \p Bits wide lanes:
+///   a + b = ((a & L) + (b & L)) ^ ((a ^ b) & H)
+///   a - b = ((a | H) - (b & L)) ^ ((a ^ ~b) & H)
+static SDValue getSWARAddSub(unsigned Opc, SDValue A, SDValue B, unsigned Bits,
+                             const SDLoc &DL, SelectionDAG &DAG) {
+  uint32_t HBits = splatLanes(1u << (Bits - 1), Bits);
+  SDValue H = DAG.getConstant(HBits, DL, MVT::i32);
+  SDValue L = DAG.getConstant(~HBits, DL, MVT::i32);
+  SDValue BLow = DAG.getNode(ISD::AND, DL, MVT::i32, B, L);
+  SDValue Low, Top;
+  if (Opc == ISD::ADD) {
+    Low = DAG.getNode(ISD::ADD, DL, MVT::i32,
+                      DAG.getNode(ISD::AND, DL, MVT::i32, A, L), BLow);
+    Top = DAG.getNode(ISD::XOR, DL, MVT::i32, A, B);
+  } else {
+    Low = DAG.getNode(ISD::SUB, DL, MVT::i32,
+                      DAG.getNode(ISD::OR, DL, MVT::i32, A, H), BLow);
+    Top = DAG.getNode(ISD::XOR, DL, MVT::i32, A, DAG.getNOT(DL, B, MVT::i32));
+  }
+  Top = DAG.getNode(ISD::AND, DL, MVT::i32, Top, H);
+  return DAG.getNode(ISD::XOR, DL, MVT::i32, Low, Top);
+}
+
+/// The shift that brings lane \p Idx of \p Bits wide lanes down to bit 0
+static SDValue getLaneShift(SDValue Idx, unsigned Bits, const SDLoc &DL,
+                            SelectionDAG &DAG) {
+  return DAG.getNode(ISD::SHL, DL, MVT::i32,
+                     DAG.getZExtOrTrunc(Idx, DL, MVT::i32),
+                     DAG.getConstant(Log2_32(Bits), DL, MVT::i32));
+}
+
+SDValue M65832TargetLowering::LowerSWAR_ADDSUB(SDValue Op,
+                                               SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  EVT VT = Op.getValueType();
+  SDValue A = DAG.getBitcast(MVT::i32, Op.getOperand(0));
+  SDValue B = DAG.getBitcast(MVT::i32, Op.getOperand(1));
+  return DAG.getBitcast(VT, getSWARAddSub(Op.getOpcode(), A, B,
+                                          VT.getScalarSizeInBits(), DL, DAG));
+}
+
+// Each compare leaves its answer in the top bit t of every lane, which is
+// then smeared down the lane as (t - (t >> (W - 1))) | t. Lanes differ (NE)
+// when x = a ^ b has ((x & L) + L) | x set at the top. a < b (ULT) is the
+// borrow out of the lane in a - b: (~a & b) | (~(a ^ b) & (a - b)). Signed
+// lanes compare as unsigned ones with their top bits flipped, and the other
+// conditions swap the operands or invert the mask.
+SDValue M65832TargetLowering::LowerSWAR_SETCC(SDValue Op,
+                                              SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  EVT VT = Op.getValueType();
+  if (Op.getOperand(0).getValueType() != VT)
+    return SDValue();
+  unsigned Bits = VT.getScalarSizeInBits();
+  SDValue A = DAG.getBitcast(MVT::i32, Op.getOperand(0));
+  SDValue B = DAG.getBitcast(MVT::i32, Op.getOperand(1));
+  ISD::CondCode CC = cast<CondCodeSDNode>(Op.getOperand(2))->get();
+  uint32_t HBits = splatLanes(1u << (Bits - 1), Bits);
+  SDValue H = DAG.getConstant(HBits, DL, MVT::i32);
+  SDValue L = DAG.getConstant(~HBits, DL, MVT::i32);
+
+  if (ISD::isSignedIntSetCC(CC)) {
+    A = DAG.getNode(ISD::XOR, DL, MVT::i32, A, H);
+    B = DAG.getNode(ISD::XOR, DL, MVT::i32, B, H);
+    switch (CC) {
+    case ISD::SETLT: CC = ISD::SETULT; break;
+    case ISD::SETGT: CC = ISD::SETUGT; break;
+    case ISD::SETLE: CC = ISD::SETULE; break;
+    default:         CC = ISD::SETUGE; break;
+    }
+  }
+  if (CC == ISD::SETUGT || CC == ISD::SETULE) {
+    std::swap(A, B);
+    CC = ISD::getSetCCSwappedOperands(CC);
+  }
+
+  SDValue Diff = DAG.getNode(ISD::XOR, DL, MVT::i32, A, B);
+  SDValue Top;
+  switch (CC) {
+  case ISD::SETEQ:
+  case ISD::SETNE:
+    Top = DAG.getNode(ISD::ADD, DL, MVT::i32,
+                      DAG.getNode(ISD::AND, DL, MVT::i32, Diff, L), L);
+    Top = DAG.getNode(ISD::OR, DL, MVT::i32, Top, Diff);
+    break;
+  case ISD::SETULT:
+  case ISD::SETUGE: {
+    SDValue Sub = getSWARAddSub(ISD::SUB, A, B, Bits, DL, DAG);
+    Top = DAG.getNode(
+        ISD::OR, DL, MVT::i32,
+        DAG.getNode(ISD::AND, DL, MVT::i32, DAG.getNOT(DL, A, MVT::i32), B),
+        DAG.getNode(ISD::AND, DL, MVT::i32, DAG.getNOT(DL, Diff, MVT::i32),
+                    Sub));
+    break;
+  }
+  default:
+    return SDValue();
+  }
+
+  Top = DAG.getNode(ISD::AND, DL, MVT::i32, Top, H);
+  SDValue Ones = DAG.getNode(ISD::SRL, DL, MVT::i32, Top,
+                             DAG.getConstant(Bits - 1, DL, MVT::i32));
+  SDValue Mask = DAG.getNode(ISD::OR, DL, MVT::i32,
+                             DAG.getNode(ISD::SUB, DL, MVT::i32, Top, Ones),
+                             Top);
+  if (CC == ISD::SETEQ || CC == ISD::SETUGE)
+    Mask = DAG.getNOT(DL, Mask, MVT::i32);
+  return DAG.getBitcast(VT, Mask);
+}
+
+// Constant lanes fold into one immediate; the others are masked, shifted
+// into place and ORed in. A splat masks once and doubles up with shifts.
+SDValue M65832TargetLowering::LowerBUILD_VECTOR(SDValue Op,
+                                                SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  EVT VT = Op.getValueType();
+  unsigned Bits = VT.getScalarSizeInBits();
+  uint32_t LaneMask = maskTrailingOnes<uint32_t>(Bits);
+  SDValue LaneMaskV = DAG.getConstant(LaneMask, DL, MVT::i32);
+  auto *BV = cast<BuildVectorSDNode>(Op.getNode());
+
+  SDValue Splat = BV->getSplatValue();
+  if (Splat && !isa<ConstantSDNode>(Splat)) {
+    SDValue R = DAG.getNode(ISD::AND, DL, MVT::i32,
+                            DAG.getAnyExtOrTrunc(Splat, DL, MVT::i32),
+                            LaneMaskV);
+    for (unsigned Shift = Bits; Shift < 32; Shift *= 2)
+      R = DAG.getNode(ISD::OR, DL, MVT::i32, R,
+                      DAG.getNode(ISD::SHL, DL, MVT::i32, R,
+                                  DAG.getConstant(Shift, DL, MVT::i32)));
+    return DAG.getBitcast(VT, R);
+  }
+
+  uint32_t Imm = 0;
+  SDValue R;
+  for (unsigned I = 0, E = Op.getNumOperands(); I != E; ++I) {
+    SDValue Lane = Op.getOperand(I);
+    unsigned Shift = I * Bits;
+    if (Lane.isUndef())
+      continue;
+    if (auto *C = dyn_cast<ConstantSDNode>(Lane)) {
+      Imm |= (C->getZExtValue() & LaneMask) << Shift;
+      continue;
+    }
+    Lane = DAG.getAnyExtOrTrunc(Lane, DL, MVT::i32);
+    // The top lane's high bits are shifted out
+    if (I != E - 1)
+      Lane = DAG.getNode(ISD::AND, DL, MVT::i32, Lane, LaneMaskV);
+    if (Shift)
+      Lane = DAG.getNode(ISD::SHL, DL, MVT::i32, Lane,
+                         DAG.getConstant(Shift, DL, MVT::i32));
+    R = R ? DAG.getNode(ISD::OR, DL, MVT::i32, R, Lane) : Lane;
+  }
+  SDValue ImmV = DAG.getConstant(Imm, DL, MVT::i32);
+  if (!R)
+    R = ImmV;
+  else if (Imm)
+    R = DAG.getNode(ISD::OR, DL, MVT::i32, R, ImmV);
+  return DAG.getBitcast(VT, R);
+}
+
+// The lane is shifted down, leaving the lanes above it in the high bits of
+// the (any-extended) result
+SDValue M65832TargetLowering::LowerEXTRACT_VECTOR_ELT(SDValue Op,
+                                                      SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  SDValue Vec = Op.getOperand(0);
+  unsigned Bits = Vec.getValueType().getScalarSizeInBits();
+  SDValue R = DAG.getNode(ISD::SRL, DL, MVT::i32,
+                          DAG.getBitcast(MVT::i32, Vec),
+                          getLaneShift(Op.getOperand(1), Bits, DL, DAG));
+  return DAG.getAnyExtOrTrunc(R, DL, Op.getValueType());
+}
+
+// (v & ~(M << s)) | ((e << s) & (M << s)) for the lane mask M
+SDValue M65832TargetLowering::LowerINSERT_VECTOR_ELT(SDValue Op,
+                                                     SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  EVT VT = Op.getValueType();
+  unsigned Bits = VT.getScalarSizeInBits();
+  SDValue Vec = DAG.getBitcast(MVT::i32, Op.getOperand(0));
+  SDValue Elt = DAG.getAnyExtOrTrunc(Op.getOperand(1), DL, MVT::i32);
+  SDValue Shift = getLaneShift(Op.getOperand(2), Bits, DL, DAG);
+  SDValue Mask = DAG.getNode(
+      ISD::SHL, DL, MVT::i32,
+      DAG.getConstant(maskTrailingOnes<uint32_t>(Bits), DL, MVT::i32), Shift);
+  SDValue Kept = DAG.getNode(ISD::AND, DL, MVT::i32, Vec,
+                             DAG.getNOT(DL, Mask, MVT::i32));
+  SDValue New = DAG.getNode(ISD::AND, DL, MVT::i32,
+                            DAG.getNode(ISD::SHL, DL, MVT::i32, Elt, Shift),
+                            Mask);
+  return DAG.getBitcast(VT, DAG.getNode(ISD::OR, DL, MVT::i32, Kept, New));
+}
+
+// Lane 0 is the low bits; the lanes above are undefined
+SDValue M65832TargetLowering::LowerSCALAR_TO_VECTOR(SDValue Op,
+                                                    SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  return DAG.getBitcast(Op.getValueType(),
+                        DAG.getAnyExtOrTrunc(Op.getOperand(0), DL, MVT::i32));
+}
+
+// The single-source shuffles one instruction does: a lane rotation is a
+// barrel rotate, reversing the bytes of a v4i8 is BSWAP, and a splat is an
+// extract and a BUILD_VECTOR splat. The rest are expanded lane by lane.
+SDValue M65832TargetLowering::LowerVECTOR_SHUFFLE(SDValue Op,
+                                                  SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  EVT VT = Op.getValueType();
+  unsigned Bits = VT.getScalarSizeInBits();
+  int NumElts = VT.getVectorNumElements();
+  auto *SVN = cast<ShuffleVectorSDNode>(Op.getNode());
+  ArrayRef<int> Mask = SVN->getMask();
+
+  // Every defined lane has to come from the same source
+  int Src = -1;
+  for (int M : Mask) {
+    if (M < 0)
+      continue;
+    if (Src >= 0 && M / NumElts != Src)
+      return SDValue();
+    Src = M / NumElts;
+  }
+  if (Src < 0)
+    return DAG.getUNDEF(VT);
+  SDValue V = Op.getOperand(Src);
+
+  if (SVN->isSplat()) {
+    SDValue Lane = DAG.getNode(
+        ISD::EXTRACT_VECTOR_ELT, DL, MVT::i32, V,
+        DAG.getVectorIdxConstant(SVN->getSplatIndex() % NumElts, DL));
+    return DAG.getSplatBuildVector(VT, DL, Lane);
+  }
+
+  // Result lane I is source lane (I + K) mod N: a rotate right by K lanes
+  int Rot = -1;
+  for (int I = 0; I != NumElts; ++I) {
+    if (Mask[I] < 0)
+      continue;
+    int K = (Mask[I] % NumElts - I + NumElts) % NumElts;
+    if (Rot >= 0 && K != Rot) {
+      Rot = -2;
+      break;
+    }
+    Rot = K;
+  }
+  SDValue X = DAG.getBitcast(MVT::i32, V);
+  if (Rot >= 0)
+    return DAG.getBitcast(
+        VT, DAG.getNode(ISD::ROTR, DL, MVT::i32, X,
+                        DAG.getConstant(Rot * Bits, DL, MVT::i32)));
+
+  if (VT != MVT::v4i8)
+    return SDValue();
+  for (int I = 0; I != NumElts; ++I)
+    if (Mask[I] >= 0 && Mask[I] % NumElts != NumElts - 1 - I)
+      return SDValue();
+  return DAG.getBitcast(VT, DAG.getNode(ISD::BSWAP, DL, MVT::i32, X));
+}
+
 // Lower 64-bit shift right on 32-bit target using barrel shifter
 // SRL_PARTS/SRA_PARTS: (Lo, Hi) = SRL_PARTS(LoIn, HiIn, ShiftAmt)
 SDValue M65832TargetLowering::LowerShiftRightParts(SDValue Op,
@@ -696,6 +1982,16 @@ SDValue M65832TargetLowering::LowerShiftRightParts(SDValue Op,
   return DAG.getMergeValues(Parts, DL);
 }
 
+Register M65832TargetLowering::getExceptionPointerRegister(
+    const Constant *PersonalityFn) const {
+  return M65832::R0;
+}
+
+Register M65832TargetLowering::getExceptionSelectorRegister(
+    const Constant *PersonalityFn) const {
+  return M65832::R1;
+}
+
 Register M65832TargetLowering::getRegisterByName(const char *RegName, LLT VT,
                                                    const MachineFunction &MF) const {
   // Handle named registers
@@ -707,6 +2003,27 @@ Register M65832TargetLowering::getRegisterByName(const char *RegName, LLT VT,
 
 // Calling convention implementation
 
+CCAssignFn *M65832TargetLowering::getCCAssignFn(CallingConv::ID CC,
+                                                bool Return) const {
+  if (CC == CallingConv::Fast)
+    return Return ? RetCC_M65832_Fast : CC_M65832_Fast;
+  return Return ? RetCC_M65832 : CC_M65832;
+}
+
+FastISel *M65832TargetLowering::createFastISel(
+    FunctionLoweringInfo &FuncInfo, const TargetLibraryInfo *LibInfo,
+    const LibcallLoweringInfo *LibcallLowering) const {
+  return createM65832FastISel(FuncInfo, LibInfo, LibcallLowering);
+}
+
+bool M65832TargetLowering::mayUseRegWindow(const Function &F) const {
+  // The unwinder treats R0-R63 as registers at a fixed D, so a frame an
+  // exception can pass through must not move the window
+  if (!F.doesNotThrow())
+    return false;
+  return WindowedCalls || F.hasFnAttribute("m65832-window");
+}
+
 SDValue M65832TargetLowering::LowerFormalArguments(
     SDValue Chain, CallingConv::ID CallConv, bool isVarArg,
     const SmallVectorImpl<ISD::InputArg> &Ins, const SDLoc &DL,
@@ -718,7 +2035,24 @@ SDValue M65832TargetLowering::LowerFormalArguments(
   
   SmallVector<CCValAssign, 16> ArgLocs;
   CCState CCInfo(CallConv, isVarArg, MF, ArgLocs, *DAG.getContext());
-  CCInfo.AnalyzeFormalArguments(Ins, CC_M65832);
+  CCInfo.AnalyzeFormalArguments(Ins, getCCAssignFn(CallConv, false));
+
+  // Windowed functions move D in the prologue instead of saving GPRs. The
+  // frame offsets of stack arguments do not allow for the extra push, so
+  // functions with stack or variadic arguments keep the normal convention.
+  // Neither can a fastcc function using R8-R15, which would shift out of
+  // the window.
+  const Function &F = MF.getFunction();
+  bool ArgsFitWindow = llvm::none_of(ArgLocs, [](const CCValAssign &VA) {
+    return VA.isRegLoc() && VA.getLocReg() >= M65832::R8 &&
+           VA.getLocReg() <= M65832::R15;
+  });
+  if (mayUseRegWindow(F) && !isVarArg && CCInfo.getStackSize() == 0 &&
+      ArgsFitWindow && M65832RegisterInfo::hasFullRegWindow(MF))
+    FuncInfo->setWindowShift(F.hasFnAttribute("interrupt")
+                                 ? InterruptWindowShiftRegs
+                                 : WindowShiftRegs);
+  unsigned WindowShift = FuncInfo->getWindowShift();
   
   for (unsigned i = 0, e = ArgLocs.size(); i != e; ++i) {
     CCValAssign &VA = ArgLocs[i];
@@ -726,7 +2060,7 @@ SDValue M65832TargetLowering::LowerFormalArguments(
     if (VA.isRegLoc()) {
       // Argument passed in register
       EVT RegVT = VA.getLocVT();
-      MCRegister LocReg = VA.getLocReg();
+      MCRegister LocReg = shiftWindowReg(VA.getLocReg(), WindowShift);
       
       // Select the correct register class based on register type
       const TargetRegisterClass *RC;
@@ -750,10 +2084,19 @@ SDValue M65832TargetLowering::LowerFormalArguments(
         ArgValue = DAG.getNode(ISD::AssertZext, DL, RegVT, ArgValue,
                                DAG.getValueType(VA.getValVT()));
       
-      if (VA.getLocInfo() != CCValAssign::Full)
+      if (VA.getLocInfo() == CCValAssign::BCvt)
+        ArgValue = DAG.getNode(ISD::BITCAST, DL, VA.getValVT(), ArgValue);
+      else if (VA.getLocInfo() != CCValAssign::Full)
         ArgValue = DAG.getNode(ISD::TRUNCATE, DL, VA.getValVT(), ArgValue);
       
       InVals.push_back(ArgValue);
+    } else if (Ins[i].Flags.isByVal()) {
+      // The caller's copy is the argument
+      assert(VA.isMemLoc() && "Must be memory location");
+      int FI = MFI.CreateFixedObject(Ins[i].Flags.getByValSize(),
+                                     VA.getLocMemOffset(),
+                                     /*IsImmutable=*/false);
+      InVals.push_back(DAG.getFrameIndex(FI, MVT::i32));
     } else {
       // Argument passed on stack
       assert(VA.isMemLoc() && "Must be memory location");
@@ -763,12 +2106,18 @@ SDValue M65832TargetLowering::LowerFormalArguments(
       SDValue FIN = DAG.getFrameIndex(FI, MVT::i32);
       SDValue Load = DAG.getLoad(VA.getLocVT(), DL, Chain, FIN,
                                  MachinePointerInfo::getFixedStack(MF, FI));
+      if (VA.getLocInfo() == CCValAssign::BCvt)
+        Load = DAG.getNode(ISD::BITCAST, DL, VA.getValVT(), Load);
       InVals.push_back(Load);
     }
   }
   
+  FuncInfo->setArgumentStackSize(CCInfo.getStackSize());
+
   if (isVarArg) {
-    // Save the position of first vararg for va_start
+    // Variadic arguments follow the named stack arguments (R0-R7 only ever
+    // hold named ones), so va_start just points past those and nothing is
+    // spilled
     unsigned FirstVarArg = CCInfo.getStackSize();
     FuncInfo->setVarArgsFrameIndex(
         MFI.CreateFixedObject(4, FirstVarArg, true));
@@ -777,6 +2126,37 @@ SDValue M65832TargetLowering::LowerFormalArguments(
   return Chain;
 }
 
+/// A sibling call leaves through the epilogue and a JMP, so the callee must
+/// want nothing the caller's frame cannot give it: the same convention (and
+/// so the same callee-saved set and return registers), no byval or sret
+/// memory, and stack arguments that fit in our own incoming argument area.
+bool M65832TargetLowering::isEligibleForTailCallOptimization(
+    CCState &CCInfo, CallLoweringInfo &CLI, MachineFunction &MF,
+    const SmallVectorImpl<CCValAssign> &ArgLocs) const {
+  const Function &Caller = MF.getFunction();
+  auto *FuncInfo = MF.getInfo<M65832MachineFunctionInfo>();
+
+  if (CLI.CallConv != Caller.getCallingConv())
+    return false;
+
+  // An interrupt handler has to leave through its own epilogue and RTI, and
+  // a windowed function's outgoing arguments are only where the callee
+  // looks once D is back
+  if (Caller.hasStructRetAttr() || Caller.hasFnAttribute("interrupt") ||
+      FuncInfo->getWindowShift() != 0)
+    return false;
+
+  for (const ISD::OutputArg &Out : CLI.Outs)
+    if (Out.Flags.isByVal() || Out.Flags.isSRet())
+      return false;
+
+  return CCInfo.getStackSize() <= FuncInfo->getArgumentStackSize();
+}
+
+bool M65832TargetLowering::mayBeEmittedAsTailCall(const CallInst *CI) const {
+  return CI->isTailCall();
+}
+
 SDValue M65832TargetLowering::LowerCall(TargetLowering::CallLoweringInfo &CLI,
                                           SmallVectorImpl<SDValue> &InVals) const {
   SelectionDAG &DAG = CLI.DAG;
@@ -788,15 +2168,23 @@ SDValue M65832TargetLowering::LowerCall(TargetLowering::CallLoweringInfo &CLI,
   SDValue Callee = CLI.Callee;
   CallingConv::ID CallConv = CLI.CallConv;
   bool isVarArg = CLI.IsVarArg;
-  
-  // Disable tail call optimization - not properly implemented yet
-  CLI.IsTailCall = false;
+  bool &IsTailCall = CLI.IsTailCall;
   
   MachineFunction &MF = DAG.getMachineFunction();
+  MachineFrameInfo &MFI = MF.getFrameInfo();
   
   SmallVector<CCValAssign, 16> ArgLocs;
   CCState CCInfo(CallConv, isVarArg, MF, ArgLocs, *DAG.getContext());
-  CCInfo.AnalyzeCallOperands(Outs, CC_M65832);
+  CCInfo.AnalyzeCallOperands(Outs, getCCAssignFn(CallConv, false));
+
+  bool IsMustTail = CLI.CB && CLI.CB->isMustTailCall();
+  if (IsTailCall)
+    IsTailCall = isEligibleForTailCallOptimization(CCInfo, CLI, MF, ArgLocs);
+  if (IsMustTail && !IsTailCall)
+    report_fatal_error("failed to perform tail call elimination on a call "
+                       "site marked musttail");
+  if (IsTailCall)
+    MFI.setHasTailCall();
   
   unsigned StackSize = CCInfo.getStackSize();
   
@@ -805,8 +2193,13 @@ SDValue M65832TargetLowering::LowerCall(TargetLowering::CallLoweringInfo &CLI,
   // Without this, local variables on the stack would be corrupted by JSR.
   unsigned CallFrameSize = std::max(StackSize, 4u);
   
-  // Adjust stack
-  Chain = DAG.getCALLSEQ_START(Chain, CallFrameSize, 0, DL);
+  // Adjust stack. A tail call has no call frame of its own: its stack
+  // arguments go into our incoming argument area.
+  if (!IsTailCall)
+    Chain = DAG.getCALLSEQ_START(Chain, CallFrameSize, 0, DL);
+  else if (StackSize != 0)
+    // Incoming arguments must all be read before any are overwritten
+    Chain = DAG.getStackArgumentTokenFactor(Chain);
   
   SmallVector<std::pair<unsigned, SDValue>, 8> RegsToPass;
   SmallVector<SDValue, 8> MemOpChains;
@@ -829,25 +2222,69 @@ SDValue M65832TargetLowering::LowerCall(TargetLowering::CallLoweringInfo &CLI,
     case CCValAssign::AExt:
       Arg = DAG.getNode(ISD::ANY_EXTEND, DL, VA.getLocVT(), Arg);
       break;
+    case CCValAssign::BCvt:
+      Arg = DAG.getNode(ISD::BITCAST, DL, VA.getLocVT(), Arg);
+      break;
     default:
       llvm_unreachable("Unknown loc info");
     }
     
     if (VA.isRegLoc()) {
       RegsToPass.push_back(std::make_pair(VA.getLocReg(), Arg));
+    } else if (IsTailCall) {
+      assert(VA.isMemLoc() && "Must be mem loc");
+      unsigned Size = VA.getLocVT().getSizeInBits() / 8;
+      int64_t Offset = VA.getLocMemOffset();
+
+      // An argument forwarded from the same incoming slot is already there
+      if (auto *Ld = dyn_cast<LoadSDNode>(Arg))
+        if (auto *FIN = dyn_cast<FrameIndexSDNode>(Ld->getBasePtr()))
+          if (MFI.isFixedObjectIndex(FIN->getIndex()) &&
+              MFI.getObjectOffset(FIN->getIndex()) == Offset &&
+              MFI.getObjectSize(FIN->getIndex()) == Size &&
+              Ld->getMemoryVT() == VA.getLocVT())
+            continue;
+
+      int FI = MFI.CreateFixedObject(Size, Offset, /*IsImmutable=*/false);
+      SDValue FIN = DAG.getFrameIndex(FI, MVT::i32);
+      MemOpChains.push_back(
+          DAG.getStore(Chain, DL, Arg, FIN,
+                       MachinePointerInfo::getFixedStack(MF, FI)));
     } else {
       assert(VA.isMemLoc() && "Must be mem loc");
       SDValue StackPtr = DAG.getCopyFromReg(Chain, DL, M65832::SP, MVT::i32);
       SDValue PtrOff = DAG.getIntPtrConstant(VA.getLocMemOffset(), DL);
       PtrOff = DAG.getNode(ISD::ADD, DL, MVT::i32, StackPtr, PtrOff);
-      MemOpChains.push_back(
-          DAG.getStore(Chain, DL, Arg, PtrOff, MachinePointerInfo()));
+      ISD::ArgFlagsTy Flags = Outs[i].Flags;
+      if (Flags.isByVal()) {
+        // The callee gets its own copy. Copied inline, so that nothing
+        // calls out inside the call sequence; a small struct becomes word
+        // stores that M65832CallFrameOptimization can turn into pushes.
+        SDValue Size = DAG.getIntPtrConstant(Flags.getByValSize(), DL);
+        MemOpChains.push_back(DAG.getMemcpy(
+            Chain, DL, PtrOff, Arg, Size, Flags.getNonZeroByValAlign(),
+            /*isVol=*/false, /*AlwaysInline=*/true, /*CI=*/nullptr,
+            std::nullopt, MachinePointerInfo(), MachinePointerInfo()));
+      } else {
+        MemOpChains.push_back(
+            DAG.getStore(Chain, DL, Arg, PtrOff, MachinePointerInfo()));
+      }
     }
   }
   
   if (!MemOpChains.empty())
     Chain = DAG.getNode(ISD::TokenFactor, DL, MVT::Other, MemOpChains);
   
+  // Get callee address. JSR and TAILCALL take a 32-bit absolute target,
+  // so -fPIC calls go through a register holding the PC-relative address.
+  if (GlobalAddressSDNode *G = dyn_cast<GlobalAddressSDNode>(Callee))
+    Callee = DAG.getTargetGlobalAddress(G->getGlobal(), DL, MVT::i32);
+  else if (ExternalSymbolSDNode *E = dyn_cast<ExternalSymbolSDNode>(Callee))
+    Callee = DAG.getTargetExternalSymbol(E->getSymbol(), MVT::i32);
+  if (isPositionIndependent() && (isa<GlobalAddressSDNode>(Callee) ||
+                                  isa<ExternalSymbolSDNode>(Callee)))
+    Callee = wrapAddress(Callee, DL, DAG);
+
   // Build list of register copies
   SDValue InGlue;
   for (auto &Reg : RegsToPass) {
@@ -855,12 +2292,6 @@ SDValue M65832TargetLowering::LowerCall(TargetLowering::CallLoweringInfo &CLI,
     InGlue = Chain.getValue(1);
   }
   
-  // Get callee address
-  if (GlobalAddressSDNode *G = dyn_cast<GlobalAddressSDNode>(Callee))
-    Callee = DAG.getTargetGlobalAddress(G->getGlobal(), DL, MVT::i32);
-  else if (ExternalSymbolSDNode *E = dyn_cast<ExternalSymbolSDNode>(Callee))
-    Callee = DAG.getTargetExternalSymbol(E->getSymbol(), MVT::i32);
-  
   // Build call
   SmallVector<SDValue, 8> Ops;
   Ops.push_back(Chain);
@@ -868,9 +2299,17 @@ SDValue M65832TargetLowering::LowerCall(TargetLowering::CallLoweringInfo &CLI,
   
   for (auto &Reg : RegsToPass)
     Ops.push_back(DAG.getRegister(Reg.first, Reg.second.getValueType()));
-  
+
+  // The caller-saved clobbers live only in the mask, so -enable-ipra can
+  // swap in the callee's actual usage
+  const TargetRegisterInfo *TRI = Subtarget.getRegisterInfo();
+  Ops.push_back(DAG.getRegisterMask(TRI->getCallPreservedMask(MF, CallConv)));
+
   if (InGlue.getNode())
     Ops.push_back(InGlue);
+
+  if (IsTailCall)
+    return DAG.getNode(M65832ISD::TAIL_CALL, DL, MVT::Other, Ops);
   
   SDVTList NodeTys = DAG.getVTList(MVT::Other, MVT::Glue);
   Chain = DAG.getNode(M65832ISD::CALL, DL, NodeTys, Ops);
@@ -883,7 +2322,7 @@ SDValue M65832TargetLowering::LowerCall(TargetLowering::CallLoweringInfo &CLI,
   // Handle return values
   SmallVector<CCValAssign, 16> RVLocs;
   CCState RVInfo(CallConv, isVarArg, MF, RVLocs, *DAG.getContext());
-  RVInfo.AnalyzeCallResult(Ins, RetCC_M65832);
+  RVInfo.AnalyzeCallResult(Ins, getCCAssignFn(CallConv, true));
   
   for (unsigned i = 0, e = RVLocs.size(); i != e; ++i) {
     CCValAssign &VA = RVLocs[i];
@@ -899,7 +2338,9 @@ SDValue M65832TargetLowering::LowerCall(TargetLowering::CallLoweringInfo &CLI,
       Val = DAG.getNode(ISD::AssertZext, DL, VA.getLocVT(), Val,
                         DAG.getValueType(VA.getValVT()));
     
-    if (VA.getLocInfo() != CCValAssign::Full)
+    if (VA.getLocInfo() == CCValAssign::BCvt)
+      Val = DAG.getNode(ISD::BITCAST, DL, VA.getValVT(), Val);
+    else if (VA.getLocInfo() != CCValAssign::Full)
       Val = DAG.getNode(ISD::TRUNCATE, DL, VA.getValVT(), Val);
     
     InVals.push_back(Val);
@@ -918,15 +2359,18 @@ SDValue M65832TargetLowering::LowerReturn(SDValue Chain, CallingConv::ID CallCon
   
   SmallVector<CCValAssign, 16> RVLocs;
   CCState CCInfo(CallConv, isVarArg, MF, RVLocs, *DAG.getContext());
-  CCInfo.AnalyzeReturn(Outs, RetCC_M65832);
+  CCInfo.AnalyzeReturn(Outs, getCCAssignFn(CallConv, true));
   
   SDValue Glue;
   SmallVector<SDValue, 4> RetOps(1, Chain);
+  unsigned WindowShift =
+      MF.getInfo<M65832MachineFunctionInfo>()->getWindowShift();
   
   // Copy return values to registers
   for (unsigned i = 0, e = RVLocs.size(); i != e; ++i) {
     CCValAssign &VA = RVLocs[i];
     SDValue Val = OutVals[i];
+    MCRegister RetReg = shiftWindowReg(VA.getLocReg(), WindowShift);
     
     // Promote if necessary
     switch (VA.getLocInfo()) {
@@ -941,20 +2385,26 @@ SDValue M65832TargetLowering::LowerReturn(SDValue Chain, CallingConv::ID CallCon
     case CCValAssign::AExt:
       Val = DAG.getNode(ISD::ANY_EXTEND, DL, VA.getLocVT(), Val);
       break;
+    case CCValAssign::BCvt:
+      Val = DAG.getNode(ISD::BITCAST, DL, VA.getLocVT(), Val);
+      break;
     default:
       llvm_unreachable("Unknown loc info");
     }
     
-    Chain = DAG.getCopyToReg(Chain, DL, VA.getLocReg(), Val, Glue);
+    Chain = DAG.getCopyToReg(Chain, DL, RetReg, Val, Glue);
     Glue = Chain.getValue(1);
-    RetOps.push_back(DAG.getRegister(VA.getLocReg(), VA.getLocVT()));
+    RetOps.push_back(DAG.getRegister(RetReg, VA.getLocVT()));
   }
   
   RetOps[0] = Chain;
   if (Glue.getNode())
     RetOps.push_back(Glue);
-  
-  return DAG.getNode(M65832ISD::RET_FLAG, DL, MVT::Other, RetOps);
+
+  unsigned Opc = MF.getFunction().hasFnAttribute("interrupt")
+                     ? M65832ISD::RETI_FLAG
+                     : M65832ISD::RET_FLAG;
+  return DAG.getNode(Opc, DL, MVT::Other, RetOps);
 }
 
 bool M65832TargetLowering::CanLowerReturn(
@@ -963,7 +2413,7 @@ bool M65832TargetLowering::CanLowerReturn(
     const Type *RetTy) const {
   SmallVector<CCValAssign, 16> RVLocs;
   CCState CCInfo(CallConv, isVarArg, MF, RVLocs, Context);
-  return CCInfo.CheckReturn(Outs, RetCC_M65832);
+  return CCInfo.CheckReturn(Outs, getCCAssignFn(CallConv, true));
 }
 
 MachineBasicBlock *
@@ -978,9 +2428,12 @@ M65832TargetLowering::EmitInstrWithCustomInserter(MachineInstr &MI,
   case M65832::SELECT_CC_F32_PSEUDO:
   case M65832::SELECT_CC_F64_PSEUDO:
     return emitSelectCC(MI, MBB);
-  case M65832::SELECT_CC_FP_PSEUDO:
-  case M65832::SELECT_CC_FP_F32_PSEUDO:
-  case M65832::SELECT_CC_FP_F64_PSEUDO:
+  case M65832::SELECT_CC_FPS_PSEUDO:
+  case M65832::SELECT_CC_FPS_F32_PSEUDO:
+  case M65832::SELECT_CC_FPS_F64_PSEUDO:
+  case M65832::SELECT_CC_FPD_PSEUDO:
+  case M65832::SELECT_CC_FPD_F32_PSEUDO:
+  case M65832::SELECT_CC_FPD_F64_PSEUDO:
     return emitSelectCCFP(MI, MBB);
   default:
     llvm_unreachable("Unexpected instruction for custom inserter");
@@ -1110,8 +2563,8 @@ MachineBasicBlock *M65832TargetLowering::emitSelectCC(MachineInstr &MI,
 
 MachineBasicBlock *M65832TargetLowering::emitSelectCCFP(MachineInstr &MI,
                                                           MachineBasicBlock *MBB) const {
-  // SELECT_CC_FP_PSEUDO: (dst, trueVal, falseVal, cc)
-  // Uses flags already set by FCMP (no comparison in this pseudo)
+  // SELECT_CC_FP{S,D}_*PSEUDO: (dst, lhs, rhs, trueVal, falseVal, cc)
+  // Same shape as emitSelectCC, with an FP compare-and-branch
   const TargetInstrInfo &TII = *Subtarget.getInstrInfo();
   DebugLoc DL = MI.getDebugLoc();
   
@@ -1130,30 +2583,23 @@ MachineBasicBlock *M65832TargetLowering::emitSelectCCFP(MachineInstr &MI,
   MBB->addSuccessor(SinkMBB);
   TrueMBB->addSuccessor(SinkMBB);
   
-  // Get operands: dst, trueVal, falseVal, cc
+  // Get operands: dst, lhs, rhs, trueVal, falseVal, cc
   Register DstReg = MI.getOperand(0).getReg();
-  Register TrueReg = MI.getOperand(1).getReg();
-  Register FalseReg = MI.getOperand(2).getReg();
-  int64_t CC = MI.getOperand(3).getImm();
-  
-  // Map condition code to branch opcode (flags already set by FCMP)
-  unsigned BrOpc;
-  switch (CC) {
-  case ISD::SETEQ:  BrOpc = M65832::BEQ; break;
-  case ISD::SETNE:  BrOpc = M65832::BNE; break;
-  case ISD::SETLT:  BrOpc = M65832::BMI; break;
-  case ISD::SETGE:  BrOpc = M65832::BPL; break;
-  case ISD::SETULT: BrOpc = M65832::BCC; break;
-  case ISD::SETUGE: BrOpc = M65832::BCS; break;
-  case ISD::SETGT:  BrOpc = M65832::BNE; break;
-  case ISD::SETLE:  BrOpc = M65832::BEQ; break;
-  case ISD::SETUGT: BrOpc = M65832::BNE; break;
-  case ISD::SETULE: BrOpc = M65832::BEQ; break;
-  default:          BrOpc = M65832::BNE; break;
-  }
-  
-  // MBB: Branch to TrueMBB if condition is true, else fall through
-  BuildMI(MBB, DL, TII.get(BrOpc)).addMBB(TrueMBB);
+  Register LHSReg = MI.getOperand(1).getReg();
+  Register RHSReg = MI.getOperand(2).getReg();
+  Register TrueReg = MI.getOperand(3).getReg();
+  Register FalseReg = MI.getOperand(4).getReg();
+  int64_t CC = MI.getOperand(5).getImm();
+
+  // Fused FCMP + Bcc terminator, so PHI copies go before the compare
+  bool IsDouble =
+      MF->getRegInfo().getRegClass(LHSReg) == &M65832::FPR64RegClass;
+  BuildMI(MBB, DL, TII.get(IsDouble ? M65832::FCMP_BR_CC_D
+                                    : M65832::FCMP_BR_CC_S))
+      .addReg(LHSReg)
+      .addReg(RHSReg)
+      .addImm(CC)
+      .addMBB(TrueMBB);
   BuildMI(MBB, DL, TII.get(M65832::BRA)).addMBB(SinkMBB);
   
   // TrueMBB: Empty, just used for PHI
@@ -1185,6 +2631,9 @@ M65832TargetLowering::getConstraintType(StringRef Constraint) const {
       return C_RegisterClass;
     case 'm':  // Memory operand
     case 'o':  // Memory operand with offsettable addressing
+    case 'Q':  // Direct-page global, %dp(sym)
+    case 'S':  // Frame slot, B+$xxxx
+    case 'A':  // Absolute global, sym+off
       return C_Memory;
     }
   }
@@ -1198,6 +2647,23 @@ M65832TargetLowering::getConstraintType(StringRef Constraint) const {
   return TargetLowering::getConstraintType(Constraint);
 }
 
+InlineAsm::ConstraintCode
+M65832TargetLowering::getInlineAsmMemConstraint(StringRef ConstraintCode) const {
+  if (ConstraintCode.size() == 1) {
+    switch (ConstraintCode[0]) {
+    default:
+      break;
+    case 'Q':
+      return InlineAsm::ConstraintCode::Q;
+    case 'S':
+      return InlineAsm::ConstraintCode::S;
+    case 'A':
+      return InlineAsm::ConstraintCode::A;
+    }
+  }
+  return TargetLowering::getInlineAsmMemConstraint(ConstraintCode);
+}
+
 std::pair<unsigned, const TargetRegisterClass *>
 M65832TargetLowering::getRegForInlineAsmConstraint(
     const TargetRegisterInfo *TRI, StringRef Constraint, MVT VT) const {
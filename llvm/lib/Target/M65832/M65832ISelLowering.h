@@ -15,11 +15,14 @@
 #define LLVM_LIB_TARGET_M65832_M65832ISELLOWERING_H
 
 #include "M65832.h"
+#include "llvm/CodeGen/CallingConvLower.h"
 #include "llvm/CodeGen/SelectionDAG.h"
 #include "llvm/CodeGen/TargetLowering.h"
 
 namespace llvm {
 
+class CCState;
+class CCValAssign;
 class M65832Subtarget;
 
 class M65832TargetLowering : public TargetLowering {
@@ -30,36 +33,145 @@ public:
                                  const M65832Subtarget &STI);
 
   SDValue LowerOperation(SDValue Op, SelectionDAG &DAG) const override;
+  void ReplaceNodeResults(SDNode *N, SmallVectorImpl<SDValue> &Results,
+                          SelectionDAG &DAG) const override;
 
   const char *getTargetNodeName(unsigned Opcode) const override;
 
+  SDValue PerformDAGCombine(SDNode *N, DAGCombinerInfo &DCI) const override;
+
   MachineBasicBlock *
   EmitInstrWithCustomInserter(MachineInstr &MI,
                               MachineBasicBlock *MBB) const override;
 
+  // libunwind hands the landing pad the exception in R0 and the selector
+  // in R1 (__builtin_eh_return_data_regno 0 and 1)
+  Register
+  getExceptionPointerRegister(const Constant *PersonalityFn) const override;
+  Register
+  getExceptionSelectorRegister(const Constant *PersonalityFn) const override;
+
   Register getRegisterByName(const char *RegName, LLT VT,
                              const MachineFunction &MF) const override;
 
+  bool isFMAFasterThanFMulAndFAdd(const MachineFunction &MF,
+                                  EVT VT) const override;
+
+  // Integer loads and stores take base + imm (LDY #imm) and base + index
+  // ((dp),Y); LDF/STF take a bare R0-R15 pointer, so LSR walks float arrays
+  // with a pointer per array instead of rebuilding base + i * 4 each access
+  bool isLegalAddressingMode(const DataLayout &DL, const AddrMode &AM,
+                             Type *Ty, unsigned AddrSpace,
+                             Instruction *I = nullptr) const override;
+
+  // The data bus is byte-wide, so with unaligned-access a misaligned word
+  // is as fast as an aligned one and adjacent narrow stores can merge
+  bool allowsMisalignedMemoryAccesses(
+      EVT VT, unsigned AddrSpace, Align Alignment,
+      MachineMemOperand::Flags Flags = MachineMemOperand::MONone,
+      unsigned *Fast = nullptr) const override;
+
+  // DIV is the slowest instruction on the core: constant divisors become
+  // MULHU/MULHS (high word from T) magic sequences except at minsize, or
+  // at optsize too when the divider is fast (no slow-div)
+  bool isIntDivCheap(EVT VT, AttributeList Attr) const override;
+  SDValue BuildSDIVPow2(SDNode *N, const APInt &Divisor, SelectionDAG &DAG,
+                        SmallVectorImpl<SDNode *> &Created) const override;
+
+  // Variable i64 shifts are __ashldi3 and friends at minsize
+  ShiftLegalizationStrategy
+  preferredShiftLegalizationStrategy(SelectionDAG &DAG, SDNode *N,
+                                     unsigned ExpansionFactor) const override;
+
+  // A variable shift is one barrel shift, so switch bit tests and
+  // (x & (1 << y)) != 0 keep their form. An AND tested against 0 is sunk
+  // next to the branch so the compare folds into the AND's flags.
+  bool hasBitTest(SDValue X, SDValue Y) const override { return true; }
+  bool isMaskAndCmp0FoldingBeneficial(const Instruction &AndI) const override;
+
+  // Multiplies by (2^n+-1) * 2^m become shifts and an add/sub when the
+  // scheduling model has them beating MUL, or when there is no MUL
+  bool decomposeMulByConstant(LLVMContext &Context, EVT VT,
+                              SDValue C) const override;
+
+  // FP immediates that FLI_S/FLI_D build as LDA #n; I2F instead of a
+  // constant-pool load
+  bool isFPImmLegal(const APFloat &Imm, EVT VT,
+                    bool ForCodeSize) const override;
+  static bool isI2FImm(const APFloat &Imm);
+
+  // Atomics
+  bool shouldInsertFencesForAtomic(const Instruction *I) const override {
+    return true;
+  }
+  AtomicExpansionKind
+  shouldExpandAtomicRMWInIR(const AtomicRMWInst *AI) const override;
+  ISD::NodeType getExtendForAtomicOps() const override {
+    return ISD::ZERO_EXTEND;
+  }
+
   // Inline assembly constraint support
   ConstraintType getConstraintType(StringRef Constraint) const override;
   std::pair<unsigned, const TargetRegisterClass *>
   getRegForInlineAsmConstraint(const TargetRegisterInfo *TRI,
                                StringRef Constraint, MVT VT) const override;
+  InlineAsm::ConstraintCode
+  getInlineAsmMemConstraint(StringRef ConstraintCode) const override;
+
+  // -O0 selects through M65832FastISel, falling back to the DAG
+  FastISel *
+  createFastISel(FunctionLoweringInfo &FuncInfo,
+                 const TargetLibraryInfo *LibInfo,
+                 const LibcallLoweringInfo *LibcallLowering) const override;
+
+  /// Argument or return convention for CC (fastcc or the C convention)
+  CCAssignFn *getCCAssignFn(CallingConv::ID CC, bool Return) const;
+
+  /// Whether F may move D to a register window on entry instead of
+  /// following the plain convention (-m65832-windowed-calls or the
+  /// "m65832-window" attribute)
+  bool mayUseRegWindow(const Function &F) const;
 
 private:
+  /// Wrap a target address node for selection: a 32-bit absolute address,
+  /// or one computed from the PC under -fPIC
+  SDValue wrapAddress(SDValue Addr, const SDLoc &DL, SelectionDAG &DAG) const;
   SDValue LowerGlobalAddress(SDValue Op, SelectionDAG &DAG) const;
+  SDValue LowerGlobalTLSAddress(SDValue Op, SelectionDAG &DAG) const;
   SDValue LowerExternalSymbol(SDValue Op, SelectionDAG &DAG) const;
   SDValue LowerBlockAddress(SDValue Op, SelectionDAG &DAG) const;
   SDValue LowerConstantPool(SDValue Op, SelectionDAG &DAG) const;
+  SDValue LowerJumpTable(SDValue Op, SelectionDAG &DAG) const;
   SDValue LowerBR_CC(SDValue Op, SelectionDAG &DAG) const;
   SDValue LowerSELECT_CC(SDValue Op, SelectionDAG &DAG) const;
   SDValue LowerSETCC(SDValue Op, SelectionDAG &DAG) const;
   SDValue LowerSELECT(SDValue Op, SelectionDAG &DAG) const;
+  /// True if \p CC can be turned into a branchless select mask.
+  static bool isMaskSelectCC(ISD::CondCode CC);
+  SDValue LowerATOMIC_FENCE(SDValue Op, SelectionDAG &DAG) const;
+  SDValue LowerBITCAST(SDValue Op, SelectionDAG &DAG) const;
+  SDValue LowerFP_TO_UINT(SDValue Op, SelectionDAG &DAG) const;
+  SDValue LowerINT_TO_FP(SDValue Op, SelectionDAG &DAG) const;
+  SDValue LowerFROUND_F32(SDValue Op, SelectionDAG &DAG) const;
+  SDValue LowerFP16_TO_FP(SDValue Op, SelectionDAG &DAG) const;
+  SDValue LowerFP_TO_FP16(SDValue Op, SelectionDAG &DAG) const;
   SDValue LowerVASTART(SDValue Op, SelectionDAG &DAG) const;
+  SDValue LowerVAARG(SDValue Op, SelectionDAG &DAG) const;
   SDValue LowerFRAMEADDR(SDValue Op, SelectionDAG &DAG) const;
   SDValue LowerRETURNADDR(SDValue Op, SelectionDAG &DAG) const;
+  SDValue LowerDYNAMIC_STACKALLOC(SDValue Op, SelectionDAG &DAG) const;
   SDValue LowerShiftLeftParts(SDValue Op, SelectionDAG &DAG) const;
+  SDValue LowerMUL(SDValue Op, SelectionDAG &DAG) const;
   SDValue LowerShiftRightParts(SDValue Op, SelectionDAG &DAG, bool IsSRA) const;
+  SDValue LowerFunnelShift(SDValue Op, SelectionDAG &DAG) const;
+  // SWAR vectors (v4i8, v2i16) as i32 operations
+  SDValue LowerSWAR_ADDSUB(SDValue Op, SelectionDAG &DAG) const;
+  SDValue LowerSWAR_SETCC(SDValue Op, SelectionDAG &DAG) const;
+  SDValue LowerBUILD_VECTOR(SDValue Op, SelectionDAG &DAG) const;
+  SDValue LowerEXTRACT_VECTOR_ELT(SDValue Op, SelectionDAG &DAG) const;
+  SDValue LowerINSERT_VECTOR_ELT(SDValue Op, SelectionDAG &DAG) const;
+  SDValue LowerSCALAR_TO_VECTOR(SDValue Op, SelectionDAG &DAG) const;
+  SDValue LowerVECTOR_SHUFFLE(SDValue Op, SelectionDAG &DAG) const;
 
   // Calling convention lowering
   SDValue LowerFormalArguments(SDValue Chain, CallingConv::ID CallConv,
@@ -71,6 +183,12 @@ private:
   SDValue LowerCall(TargetLowering::CallLoweringInfo &CLI,
                     SmallVectorImpl<SDValue> &InVals) const override;
 
+  bool isEligibleForTailCallOptimization(
+      CCState &CCInfo, CallLoweringInfo &CLI, MachineFunction &MF,
+      const SmallVectorImpl<CCValAssign> &ArgLocs) const;
+
+  bool mayBeEmittedAsTailCall(const CallInst *CI) const override;
+
   SDValue LowerReturn(SDValue Chain, CallingConv::ID CallConv, bool isVarArg,
                       const SmallVectorImpl<ISD::OutputArg> &Outs,
                       const SmallVectorImpl<SDValue> &OutVals, const SDLoc &DL,
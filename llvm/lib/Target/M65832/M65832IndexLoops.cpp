@@ -0,0 +1,349 @@
+//===-- M65832IndexLoops.cpp - Keep loop indices and counters in X/Y -----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Once loop strength reduction has turned pointer walks such as
+//
+//   while (n--) *d++ = *s++;
+//
+// into base + index accesses, every (dp),Y load and store in the loop body
+// reloads Y from the index register, and the index and the trip count are
+// stepped and compared with extended-ALU instructions:
+//
+//   loop: LDY R5          ; index
+//         LD.B R6,(R2),Y
+//         ST.B (R3),Y,R6
+//         INC R5
+//         DEC R4          ; trip count
+//         BNE loop
+//
+// For single-block loops in which a register is only reloaded into Y (or
+// X), stepped by one and compared, this pass keeps it in that index
+// register for the whole loop instead: it is loaded once in each
+// predecessor, INC/DEC become INY/DEY (INX/DEX), compares become CPY (CPX),
+// and the register is written back on the way out. Y is tried first for the
+// register the loop reloads into Y; X then takes a down-counter, giving a
+// DEX/BNE back-edge.
+//
+//   loop: LD.B R6,(R2),Y
+//         ST.B (R3),Y,R6
+//         INY
+//         DEX
+//         BNE loop
+//
+// Loops that call out, or already use X/Y for something else (SP-relative
+// accesses go through X), keep the register form.
+//
+//===----------------------------------------------------------------------===//
+
+#include "M65832.h"
+#include "M65832InstrInfo.h"
+#include "M65832Subtarget.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/Support/Debug.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "m65832-index-loops"
+#define PASS_NAME "M65832 keep loop indices in X/Y"
+
+STATISTIC(NumYLoops, "Number of loops with an index kept in Y");
+STATISTIC(NumXLoops, "Number of loops with a counter kept in X");
+
+namespace {
+
+/// Opcodes for one of the two index registers.
+struct IndexRegOps {
+  Register Reg;
+  unsigned Load, Store, Inc, Dec, CmpDP, CmpImm;
+};
+
+const IndexRegOps YOps = {M65832::Y,     M65832::LDY_DP, M65832::STY_DP,
+                          M65832::INY,   M65832::DEY,    M65832::CPY_DP,
+                          M65832::CPY_IMM};
+const IndexRegOps XOps = {M65832::X,     M65832::LDX_DP, M65832::STX_DP,
+                          M65832::INX,   M65832::DEX,    M65832::CPX_DP,
+                          M65832::CPX_IMM};
+
+class M65832IndexLoops : public MachineFunctionPass {
+public:
+  static char ID;
+
+  M65832IndexLoops() : MachineFunctionPass(ID) {}
+
+  bool runOnMachineFunction(MachineFunction &MF) override;
+
+  MachineFunctionProperties getRequiredProperties() const override {
+    return MachineFunctionProperties().setNoVRegs();
+  }
+
+  StringRef getPassName() const override { return PASS_NAME; }
+
+private:
+  const M65832InstrInfo *TII = nullptr;
+  const TargetRegisterInfo *TRI = nullptr;
+  bool TracksLiveness = false;
+
+  bool processLoop(MachineBasicBlock &Loop, const IndexRegOps &Ops);
+  Register findCandidate(MachineBasicBlock &Loop,
+                         const IndexRegOps &Ops) const;
+  bool findLoadPoint(MachineBasicBlock &Pred, Register Counter,
+                     Register IdxReg, MachineBasicBlock::iterator &IP) const;
+};
+
+} // end anonymous namespace
+
+char M65832IndexLoops::ID = 0;
+
+INITIALIZE_PASS(M65832IndexLoops, DEBUG_TYPE, PASS_NAME, false, false)
+
+FunctionPass *llvm::createM65832IndexLoopsPass() {
+  return new M65832IndexLoops();
+}
+
+static unsigned dpOf(Register Reg) {
+  return M65832InstrInfo::getDPOffset(Reg - M65832::R0);
+}
+
+/// GPR whose DP slot is at Offset, or 0 if Offset is not a register slot.
+static Register regAtDP(int64_t Offset) {
+  if (Offset < 0 || Offset % 4 != 0 || Offset / 4 > 63)
+    return Register();
+  return M65832::R0 + Offset / 4;
+}
+
+/// Fixed-offset inline branches (BEQ *+n) count bytes, so a block that holds
+/// one must not change size.
+static bool hasInlineBranch(const MachineBasicBlock &MBB) {
+  for (const MachineInstr &MI : MBB)
+    if (MI.isBranch() && MI.getNumOperands() && MI.getOperand(0).isImm())
+      return true;
+  return false;
+}
+
+/// True if MI reads or writes Reg, either as a register operand or as the
+/// DP offset of a classic 6502 operand. Any immediate that equals the DP
+/// offset counts, which is conservative for #imm operands.
+static bool mentions(const MachineInstr &MI, Register Reg) {
+  unsigned DP = dpOf(Reg);
+  for (const MachineOperand &MO : MI.operands()) {
+    if (MO.isReg() && MO.getReg() == Reg)
+      return true;
+    if (MO.isImm() && MO.getImm() == DP)
+      return true;
+  }
+  return false;
+}
+
+/// If MI is one of the forms that can move onto the index register when
+/// Counter lives there, return true.
+static bool isRewritable(const MachineInstr &MI, Register Counter,
+                         const IndexRegOps &Ops) {
+  unsigned Opc = MI.getOpcode();
+  if (Opc == Ops.Load)
+    return regAtDP(MI.getOperand(1).getImm()) == Counter;
+  switch (Opc) {
+  case M65832::INCr:
+  case M65832::DECr:
+  case M65832::CMPR_IMM:
+    return MI.getOperand(0).getReg() == Counter;
+  case M65832::INC_DP:
+  case M65832::DEC_DP:
+    return MI.getOperand(0).getImm() == dpOf(Counter);
+  case M65832::CMPR_DP:
+    return MI.getOperand(0).getReg() == Counter &&
+           MI.getOperand(1).getReg() != Counter;
+  default:
+    return false;
+  }
+}
+
+/// Pick the register to keep in Ops.Reg: the one the loop reloads into it,
+/// or failing that the register the loop steps.
+Register M65832IndexLoops::findCandidate(MachineBasicBlock &Loop,
+                                         const IndexRegOps &Ops) const {
+  Register Loaded, Stepped;
+  for (MachineInstr &MI : Loop) {
+    unsigned Opc = MI.getOpcode();
+    if (Opc == Ops.Load) {
+      Register Reg = regAtDP(MI.getOperand(1).getImm());
+      if (!Reg || (Loaded && Loaded != Reg))
+        return Register();
+      Loaded = Reg;
+    } else if (!Stepped && (Opc == M65832::INCr || Opc == M65832::DECr)) {
+      Stepped = MI.getOperand(0).getReg();
+    } else if (!Stepped && (Opc == M65832::INC_DP || Opc == M65832::DEC_DP)) {
+      Stepped = regAtDP(MI.getOperand(0).getImm());
+    }
+  }
+  return Loaded ? Loaded : Stepped;
+}
+
+/// Find where to load the index register in a predecessor: before the
+/// terminators, or before the compare that the terminators test, since
+/// LDX/LDY set N and Z.
+bool M65832IndexLoops::findLoadPoint(MachineBasicBlock &Pred,
+                                     Register Counter, Register IdxReg,
+                                     MachineBasicBlock::iterator &IP) const {
+  if (hasInlineBranch(Pred))
+    return false;
+
+  IP = Pred.getFirstTerminator();
+  bool TermsReadSR = false;
+  for (auto I = IP, E = Pred.end(); I != E; ++I)
+    TermsReadSR |= I->readsRegister(M65832::SR, TRI);
+
+  if (TermsReadSR) {
+    bool Found = false;
+    while (IP != Pred.begin()) {
+      --IP;
+      if (IP->isDebugInstr())
+        continue;
+      if (IP->definesRegister(M65832::SR, TRI)) {
+        Found = true;
+        break;
+      }
+    }
+    if (!Found)
+      return false;
+  }
+
+  // Everything after the load must leave the index register and the
+  // counter alone.
+  for (auto I = IP, E = Pred.end(); I != E; ++I)
+    if (I->isCall() || I->readsRegister(IdxReg, TRI) ||
+        I->definesRegister(IdxReg, TRI) || mentions(*I, Counter))
+      return false;
+  return true;
+}
+
+bool M65832IndexLoops::processLoop(MachineBasicBlock &Loop,
+                                   const IndexRegOps &Ops) {
+  if (hasInlineBranch(Loop))
+    return false;
+
+  Register Counter = findCandidate(Loop, Ops);
+  if (!Counter)
+    return false;
+
+  // Every other use of the index register and of the counter must have an
+  // index-register form.
+  SmallVector<MachineInstr *, 8> Rewrite;
+  for (MachineInstr &MI : Loop) {
+    if (MI.isDebugInstr())
+      continue;
+    if (MI.isCall() || MI.isInlineAsm() || MI.getOpcode() == M65832::RSET ||
+        MI.getOpcode() == M65832::RCLR)
+      return false;
+    if (isRewritable(MI, Counter, Ops)) {
+      Rewrite.push_back(&MI);
+      continue;
+    }
+    if (MI.readsRegister(Ops.Reg, TRI) || MI.definesRegister(Ops.Reg, TRI) ||
+        mentions(MI, Counter))
+      return false;
+  }
+
+  // Load on entry and write the counter back on exit.
+  SmallVector<std::pair<MachineBasicBlock *, MachineBasicBlock::iterator>, 2>
+      Entries;
+  for (MachineBasicBlock *Pred : Loop.predecessors()) {
+    if (Pred == &Loop)
+      continue;
+    MachineBasicBlock::iterator IP;
+    if (!findLoadPoint(*Pred, Counter, Ops.Reg, IP))
+      return false;
+    Entries.push_back({Pred, IP});
+  }
+  SmallVector<MachineBasicBlock *, 2> Exits;
+  for (MachineBasicBlock *Succ : Loop.successors()) {
+    if (Succ == &Loop || (TracksLiveness && !Succ->isLiveIn(Counter)))
+      continue;
+    // The write-back must only run on the way out of this loop.
+    if (Succ->pred_size() != 1)
+      return false;
+    Exits.push_back(Succ);
+  }
+  if (Entries.empty())
+    return false;
+
+  LLVM_DEBUG(dbgs() << "Keeping " << printReg(Counter, TRI) << " in "
+                    << printReg(Ops.Reg, TRI) << " in "
+                    << printMBBReference(Loop) << '\n');
+
+  unsigned DP = dpOf(Counter);
+  for (auto &[Pred, IP] : Entries)
+    BuildMI(*Pred, IP, DebugLoc(), TII->get(Ops.Load), Ops.Reg).addImm(DP);
+  for (MachineBasicBlock *Exit : Exits)
+    BuildMI(*Exit, Exit->begin(), DebugLoc(), TII->get(Ops.Store))
+        .addReg(Ops.Reg)
+        .addImm(DP);
+
+  for (MachineInstr *MI : Rewrite) {
+    MachineBasicBlock::iterator I = MI->getIterator();
+    const DebugLoc &DL = MI->getDebugLoc();
+    switch (MI->getOpcode()) {
+    case M65832::INCr:
+    case M65832::INC_DP:
+      BuildMI(Loop, I, DL, TII->get(Ops.Inc));
+      break;
+    case M65832::DECr:
+    case M65832::DEC_DP:
+      BuildMI(Loop, I, DL, TII->get(Ops.Dec));
+      break;
+    case M65832::CMPR_IMM:
+      BuildMI(Loop, I, DL, TII->get(Ops.CmpImm))
+          .addReg(Ops.Reg)
+          .addImm(MI->getOperand(1).getImm());
+      break;
+    case M65832::CMPR_DP:
+      BuildMI(Loop, I, DL, TII->get(Ops.CmpDP))
+          .addReg(Ops.Reg)
+          .addImm(dpOf(MI->getOperand(1).getReg()));
+      break;
+    default: // Reload: the index register already holds the counter
+      break;
+    }
+    MI->eraseFromParent();
+  }
+
+  if (TracksLiveness) {
+    Loop.addLiveIn(Ops.Reg);
+    for (MachineBasicBlock *Exit : Exits)
+      Exit->addLiveIn(Ops.Reg);
+  }
+  return true;
+}
+
+bool M65832IndexLoops::runOnMachineFunction(MachineFunction &MF) {
+  if (skipFunction(MF.getFunction()))
+    return false;
+
+  const M65832Subtarget &STI = MF.getSubtarget<M65832Subtarget>();
+  TII = STI.getInstrInfo();
+  TRI = STI.getRegisterInfo();
+  TracksLiveness = MF.getRegInfo().tracksLiveness();
+
+  bool Changed = false;
+  for (MachineBasicBlock &MBB : MF) {
+    if (!MBB.isSuccessor(&MBB))
+      continue;
+    if (processLoop(MBB, YOps)) {
+      ++NumYLoops;
+      Changed = true;
+    }
+    if (processLoop(MBB, XOps)) {
+      ++NumXLoops;
+      Changed = true;
+    }
+  }
+  return Changed;
+}
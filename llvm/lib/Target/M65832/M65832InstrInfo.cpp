@@ -12,14 +12,25 @@
 
 #include "M65832InstrInfo.h"
 #include "M65832.h"
+#include "M65832MachineFunctionInfo.h"
 #include "M65832Subtarget.h"
 #include "M65832TargetMachine.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/CodeGen/ISDOpcodes.h"
+#include "llvm/CodeGen/LiveIntervals.h"
+#include "llvm/CodeGen/LivePhysRegs.h"
+#include "llvm/CodeGen/LiveVariables.h"
 #include "llvm/CodeGen/MachineFrameInfo.h"
 #include "llvm/CodeGen/MachineInstrBuilder.h"
 #include "llvm/CodeGen/MachineMemOperand.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/IR/Module.h"
+#include "llvm/MC/MCAsmInfo.h"
+#include "llvm/MC/MCInstBuilder.h"
 #include "llvm/MC/TargetRegistry.h"
 #include "llvm/Support/ErrorHandling.h"
+#include <optional>
 
 using namespace llvm;
 
@@ -30,7 +41,7 @@ using namespace llvm;
 
 M65832InstrInfo::M65832InstrInfo(const M65832Subtarget &STI)
     : M65832GenInstrInfo(STI, RI, M65832::ADJCALLSTACKDOWN,
-                          M65832::ADJCALLSTACKUP),
+                          M65832::ADJCALLSTACKUP, ~0u, M65832::RTS),
       RI(STI) {}
 
 void M65832InstrInfo::copyPhysReg(MachineBasicBlock &MBB,
@@ -91,35 +102,33 @@ void M65832InstrInfo::copyPhysReg(MachineBasicBlock &MBB,
     return;
   }
   
-  // GPR <-> Y transfers (via A)
-  if (DestReg == M65832::Y && M65832::GPRRegClass.contains(SrcReg)) {
+  // GPR <-> X/Y transfers. LDX/LDY/STX/STY reach the direct page
+  // directly, so these leave A alone.
+  if (DestReg == M65832::X && M65832::GPRRegClass.contains(SrcReg)) {
     unsigned SrcDP = getDPOffset(SrcReg - M65832::R0);
-    BuildMI(MBB, I, DL, get(M65832::LDA_DP), M65832::A).addImm(SrcDP);
-    BuildMI(MBB, I, DL, get(M65832::TAY), M65832::Y)
-        .addReg(M65832::A, RegState::Kill);
+    BuildMI(MBB, I, DL, get(M65832::LDX_DP), M65832::X).addImm(SrcDP);
     return;
   }
-  
-  if (M65832::GPRRegClass.contains(DestReg) && SrcReg == M65832::Y) {
+
+  if (M65832::GPRRegClass.contains(DestReg) && SrcReg == M65832::X) {
     unsigned DstDP = getDPOffset(DestReg - M65832::R0);
-    BuildMI(MBB, I, DL, get(M65832::TYA), M65832::A).addReg(M65832::Y, getKillRegState(KillSrc));
-    BuildMI(MBB, I, DL, get(M65832::STA_DP)).addReg(M65832::A, RegState::Kill).addImm(DstDP);
+    BuildMI(MBB, I, DL, get(M65832::STX_DP))
+        .addReg(M65832::X, getKillRegState(KillSrc))
+        .addImm(DstDP);
     return;
   }
-  
-  // GPR <-> X transfers (via A)
-  if (DestReg == M65832::X && M65832::GPRRegClass.contains(SrcReg)) {
+
+  if (DestReg == M65832::Y && M65832::GPRRegClass.contains(SrcReg)) {
     unsigned SrcDP = getDPOffset(SrcReg - M65832::R0);
-    BuildMI(MBB, I, DL, get(M65832::LDA_DP), M65832::A).addImm(SrcDP);
-    BuildMI(MBB, I, DL, get(M65832::TAX), M65832::X)
-        .addReg(M65832::A, RegState::Kill);
+    BuildMI(MBB, I, DL, get(M65832::LDY_DP), M65832::Y).addImm(SrcDP);
     return;
   }
-  
-  if (M65832::GPRRegClass.contains(DestReg) && SrcReg == M65832::X) {
+
+  if (M65832::GPRRegClass.contains(DestReg) && SrcReg == M65832::Y) {
     unsigned DstDP = getDPOffset(DestReg - M65832::R0);
-    BuildMI(MBB, I, DL, get(M65832::TXA), M65832::A).addReg(M65832::X, getKillRegState(KillSrc));
-    BuildMI(MBB, I, DL, get(M65832::STA_DP)).addReg(M65832::A, RegState::Kill).addImm(DstDP);
+    BuildMI(MBB, I, DL, get(M65832::STY_DP))
+        .addReg(M65832::Y, getKillRegState(KillSrc))
+        .addImm(DstDP);
     return;
   }
   
@@ -138,19 +147,19 @@ void M65832InstrInfo::copyPhysReg(MachineBasicBlock &MBB,
   
   // SP <-> GPR transfers
   if (M65832::GPRRegClass.contains(DestReg) && SrcReg == M65832::SP) {
-    // TSX; TXA; STA dst  (copy SP to GPR via X and A)
+    // TSX; STX dst  (copy SP to GPR via X)
     unsigned DstDP = getDPOffset(DestReg - M65832::R0);
     BuildMI(MBB, I, DL, get(M65832::TSX), M65832::X);
-    BuildMI(MBB, I, DL, get(M65832::TXA), M65832::A).addReg(M65832::X, RegState::Kill);
-    BuildMI(MBB, I, DL, get(M65832::STA_DP)).addReg(M65832::A, RegState::Kill).addImm(DstDP);
+    BuildMI(MBB, I, DL, get(M65832::STX_DP))
+        .addReg(M65832::X, RegState::Kill)
+        .addImm(DstDP);
     return;
   }
   
   if (DestReg == M65832::SP && M65832::GPRRegClass.contains(SrcReg)) {
-    // LDA src; TAX; TXS  (copy GPR to SP via A and X)
+    // LDX src; TXS  (copy GPR to SP via X)
     unsigned SrcDP = getDPOffset(SrcReg - M65832::R0);
-    BuildMI(MBB, I, DL, get(M65832::LDA_DP), M65832::A).addImm(SrcDP);
-    BuildMI(MBB, I, DL, get(M65832::TAX), M65832::X).addReg(M65832::A, RegState::Kill);
+    BuildMI(MBB, I, DL, get(M65832::LDX_DP), M65832::X).addImm(SrcDP);
     BuildMI(MBB, I, DL, get(M65832::TXS)).addReg(M65832::X, RegState::Kill);
     return;
   }
@@ -168,12 +177,64 @@ void M65832InstrInfo::copyPhysReg(MachineBasicBlock &MBB,
     return;
   }
   
+  // GPR <-> FPR bit-pattern copies (low word through A)
+  if (M65832::GPRRegClass.contains(DestReg) &&
+      M65832::FPR32RegClass.contains(SrcReg)) {
+    BuildMI(MBB, I, DL, get(M65832::FTOA))
+        .addReg(SrcReg, getKillRegState(KillSrc));
+    BuildMI(MBB, I, DL, get(M65832::STA_DP))
+        .addReg(M65832::A, RegState::Kill)
+        .addImm(getDPOffset(DestReg - M65832::R0));
+    return;
+  }
+
+  if (M65832::FPR32RegClass.contains(DestReg) &&
+      M65832::GPRRegClass.contains(SrcReg)) {
+    BuildMI(MBB, I, DL, get(M65832::LDA_DP), M65832::A)
+        .addImm(getDPOffset(SrcReg - M65832::R0));
+    BuildMI(MBB, I, DL, get(M65832::ATOF), DestReg)
+        .addReg(DestReg, RegState::Undef);
+    return;
+  }
+
+  // A <-> FPR, for values that getLargestLegalSuperClass let into an FPR
+  if (DestReg == M65832::A && M65832::FPR32RegClass.contains(SrcReg)) {
+    BuildMI(MBB, I, DL, get(M65832::FTOA))
+        .addReg(SrcReg, getKillRegState(KillSrc));
+    return;
+  }
+
+  if (M65832::FPR32RegClass.contains(DestReg) && SrcReg == M65832::A) {
+    BuildMI(MBB, I, DL, get(M65832::ATOF), DestReg)
+        .addReg(DestReg, RegState::Undef);
+    return;
+  }
+
   // Print debug info before crashing
   dbgs() << "Cannot copy from " << printReg(SrcReg, &getRegisterInfo())
          << " to " << printReg(DestReg, &getRegisterInfo()) << "\n";
   llvm_unreachable("Cannot copy between these registers");
 }
 
+/// The bank of \p Reg when it has a GPRSpill/FPRSpill class (see
+/// getLargestLegalSuperClass). The spiller's fresh virtual registers are
+/// narrowed to the value's own bank, since the stack forms take only that.
+static const TargetRegisterClass *
+getSpillBankClass(Register Reg, const TargetRegisterClass *RC,
+                  MachineRegisterInfo &MRI) {
+  if (RC != &M65832::GPRSpillRegClass && RC != &M65832::FPRSpillRegClass)
+    return RC;
+  if (Reg.isVirtual()) {
+    const TargetRegisterClass *Bank = RC == &M65832::GPRSpillRegClass
+                                          ? &M65832::GPRRegClass
+                                          : &M65832::FPR32RegClass;
+    MRI.constrainRegClass(Reg, Bank);
+    return Bank;
+  }
+  return M65832::FPR32RegClass.contains(Reg) ? &M65832::FPR32RegClass
+                                             : &M65832::GPRRegClass;
+}
+
 void M65832InstrInfo::storeRegToStackSlot(MachineBasicBlock &MBB,
                                            MachineBasicBlock::iterator I,
                                            Register SrcReg, bool isKill,
@@ -192,6 +253,7 @@ void M65832InstrInfo::storeRegToStackSlot(MachineBasicBlock &MBB,
       MachinePointerInfo::getFixedStack(MF, FrameIndex),
       MachineMemOperand::MOStore, MFI.getObjectSize(FrameIndex),
       MFI.getObjectAlign(FrameIndex));
+  RC = getSpillBankClass(SrcReg, RC, MF.getRegInfo());
 
   if (M65832::GPRRegClass.hasSubClassEq(RC)) {
     // Use STORE32 pseudo which properly supports frame indices
@@ -240,6 +302,7 @@ void M65832InstrInfo::loadRegFromStackSlot(MachineBasicBlock &MBB,
       MachinePointerInfo::getFixedStack(MF, FrameIndex),
       MachineMemOperand::MOLoad, MFI.getObjectSize(FrameIndex),
       MFI.getObjectAlign(FrameIndex));
+  RC = getSpillBankClass(DestReg, RC, MF.getRegInfo());
 
   if (M65832::GPRRegClass.hasSubClassEq(RC)) {
     // Use LOAD32 pseudo which properly supports frame indices
@@ -267,57 +330,232 @@ void M65832InstrInfo::loadRegFromStackSlot(MachineBasicBlock &MBB,
   }
 }
 
+/// Operand 1 of a LOAD32/STORE32/LDF/STF pseudo as a whole stack slot.
+static bool isWholeStackSlot(const MachineInstr &MI, int &FrameIndex) {
+  if (!MI.getOperand(1).isFI() || !MI.getOperand(2).isImm() ||
+      MI.getOperand(2).getImm() != 0)
+    return false;
+  FrameIndex = MI.getOperand(1).getIndex();
+  return true;
+}
+
+Register M65832InstrInfo::isLoadFromStackSlot(const MachineInstr &MI,
+                                              int &FrameIndex) const {
+  switch (MI.getOpcode()) {
+  case M65832::LOAD32:
+  case M65832::LDF32:
+  case M65832::LDF64:
+    if (isWholeStackSlot(MI, FrameIndex))
+      return MI.getOperand(0).getReg();
+    break;
+  default:
+    break;
+  }
+  return Register();
+}
+
+Register M65832InstrInfo::isStoreToStackSlot(const MachineInstr &MI,
+                                             int &FrameIndex) const {
+  switch (MI.getOpcode()) {
+  case M65832::STORE32:
+  case M65832::STF32:
+  case M65832::STF64:
+    if (isWholeStackSlot(MI, FrameIndex))
+      return MI.getOperand(0).getReg();
+    break;
+  default:
+    break;
+  }
+  return Register();
+}
+
+/// Branches taken after FCMP when CC holds. FCMP sets Z when the operands
+/// are equal, N when lhs < rhs, C when lhs >= rhs, and V (with N, Z and C
+/// clear) when they are unordered. Lowering swaps GT/LE forms and handles
+/// ONE, so every remaining predicate is one or two branches to the target.
+static SmallVector<unsigned, 2> getFCmpBranches(ISD::CondCode CC) {
+  switch (CC) {
+  case ISD::SETEQ:
+  case ISD::SETOEQ: return {M65832::BEQ};
+  case ISD::SETNE:
+  case ISD::SETUNE: return {M65832::BNE};
+  case ISD::SETLT:
+  case ISD::SETOLT: return {M65832::BMI};
+  case ISD::SETGE:
+  case ISD::SETUGE: return {M65832::BPL};
+  case ISD::SETOGE: return {M65832::BCS};
+  case ISD::SETULT: return {M65832::BCC};
+  case ISD::SETUO:  return {M65832::BVS};
+  case ISD::SETO:   return {M65832::BVC};
+  case ISD::SETUEQ: return {M65832::BEQ, M65832::BVS};
+  default:
+    llvm_unreachable("FP condition not canonicalized by lowering");
+  }
+}
+
+static bool isCondBranchOpcode(unsigned Opc) {
+  switch (Opc) {
+  case M65832::BEQ:
+  case M65832::BNE:
+  case M65832::BCS:
+  case M65832::BCC:
+  case M65832::BMI:
+  case M65832::BPL:
+  case M65832::BVS:
+  case M65832::BVC:
+    return true;
+  default:
+    return false;
+  }
+}
+
+static bool isUncondBranchOpcode(unsigned Opc) {
+  return Opc == M65832::BRA || Opc == M65832::BRL || Opc == M65832::JMP;
+}
+
+/// The integer compare-and-branch pseudos, (lhs, rhs, cc, target)
+static bool isCmpBranchOpcode(unsigned Opc) {
+  switch (Opc) {
+  case M65832::BR_CC_CMP_PSEUDO:
+  case M65832::BR_CC_CMP_IMM_PSEUDO:
+  case M65832::BR_CC_CMP8_PSEUDO:
+  case M65832::BR_CC_CMP8_IMM_PSEUDO:
+  case M65832::BR_CC_CMP16_PSEUDO:
+  case M65832::BR_CC_CMP16_IMM_PSEUDO:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Cond holds one Bcc opcode, or two when the condition needs a pair of
+// branches to the same target (e.g. BEQ/BMI for signed LE), meaning "taken
+// if either branch is taken". Before the pseudos are expanded it is instead
+// a compare-and-branch opcode followed by that pseudo's lhs, rhs and
+// condition code.
+MachineInstr *M65832InstrInfo::foldMemoryOperandImpl(
+    MachineFunction &MF, MachineInstr &MI, ArrayRef<unsigned> Ops,
+    MachineBasicBlock::iterator InsertPt, int FrameIndex, LiveIntervals *LIS,
+    VirtRegMap *VRM) const {
+  // One reloaded source; a spilled result or a register used twice stays
+  if (Ops.size() != 1 || MF.getFrameInfo().getObjectSize(FrameIndex) != 4)
+    return nullptr;
+
+  unsigned MemOpc;
+  bool Commutable = true;
+  switch (MI.getOpcode()) {
+  case M65832::ADD_GPR:
+    MemOpc = M65832::ADD_MEM;
+    break;
+  case M65832::SUB_GPR:
+    MemOpc = M65832::SUB_MEM;
+    Commutable = false;
+    break;
+  case M65832::AND_GPR:
+    MemOpc = M65832::AND_MEM;
+    break;
+  case M65832::ORA_GPR:
+    MemOpc = M65832::ORA_MEM;
+    break;
+  case M65832::EOR_GPR:
+    MemOpc = M65832::EOR_MEM;
+    break;
+  default:
+    return nullptr;
+  }
+
+  unsigned KeepOp;
+  if (Ops[0] == 2)
+    KeepOp = 1;
+  else if (Ops[0] == 1 && Commutable)
+    KeepOp = 2;
+  else
+    return nullptr;
+
+  MachineBasicBlock &MBB = *InsertPt->getParent();
+  return BuildMI(MBB, InsertPt, MI.getDebugLoc(), get(MemOpc))
+      .add(MI.getOperand(0))
+      .add(MI.getOperand(KeepOp))
+      .addFrameIndex(FrameIndex)
+      .addImm(0);
+}
+
 bool M65832InstrInfo::analyzeBranch(MachineBasicBlock &MBB,
                                      MachineBasicBlock *&TBB,
                                      MachineBasicBlock *&FBB,
                                      SmallVectorImpl<MachineOperand> &Cond,
                                      bool AllowModify) const {
-  // Start from the bottom of the block and work up
+  // Collect the terminators, bottom first
+  SmallVector<MachineInstr *, 4> Terms;
   MachineBasicBlock::iterator I = MBB.end();
   while (I != MBB.begin()) {
     --I;
-    
     if (I->isDebugInstr())
       continue;
-    
-    // If we've hit a non-terminator, we're done
     if (!isUnpredicatedTerminator(*I))
       break;
-    
-    // Handle unconditional branches
-    if (I->getOpcode() == M65832::BRA || I->getOpcode() == M65832::JMP) {
-      // Check if operand is actually an MBB - might be immediate for inline asm
-      if (!I->getOperand(0).isMBB())
-        return true; // Can't analyze non-MBB branch targets
-      if (TBB) {
-        // Already have a branch target - this is the fallthrough
-        FBB = TBB;
-      }
-      TBB = I->getOperand(0).getMBB();
-      continue;
-    }
-    
-    // Handle conditional branches
-    if (I->getOpcode() == M65832::BEQ || I->getOpcode() == M65832::BNE ||
-        I->getOpcode() == M65832::BCS || I->getOpcode() == M65832::BCC ||
-        I->getOpcode() == M65832::BMI || I->getOpcode() == M65832::BPL ||
-        I->getOpcode() == M65832::BVS || I->getOpcode() == M65832::BVC) {
-      // Check if operand is actually an MBB - might be immediate for inline asm
-      if (!I->getOperand(0).isMBB())
-        return true; // Can't analyze non-MBB branch targets
-      if (TBB) {
-        // Already have unconditional, this is conditional to different target
-        return true; // Can't handle this
-      }
-      TBB = I->getOperand(0).getMBB();
-      Cond.push_back(MachineOperand::CreateImm(I->getOpcode()));
+    unsigned Opc = I->getOpcode();
+    if (!isUncondBranchOpcode(Opc) && !isCondBranchOpcode(Opc) &&
+        !isCmpBranchOpcode(Opc))
+      return true; // Unknown terminator
+    // Check if operand is actually an MBB - might be immediate for inline asm
+    if (!I->getOperand(isCmpBranchOpcode(Opc) ? 3 : 0).isMBB())
+      return true; // Can't analyze non-MBB branch targets
+    Terms.push_back(&*I);
+  }
+
+  // Anything after the first unconditional branch is dead
+  for (unsigned Idx = Terms.size(); Idx-- > 0;) {
+    if (!isUncondBranchOpcode(Terms[Idx]->getOpcode()))
       continue;
-    }
-    
-    // Unknown terminator
+    if (AllowModify)
+      for (unsigned Dead = 0; Dead != Idx; ++Dead)
+        Terms[Dead]->eraseFromParent();
+    Terms.erase(Terms.begin(), Terms.begin() + Idx);
+    break;
+  }
+
+  if (Terms.empty())
+    return false; // Fallthrough
+
+  MachineBasicBlock *UncondTarget = nullptr;
+  if (isUncondBranchOpcode(Terms.front()->getOpcode())) {
+    UncondTarget = Terms.front()->getOperand(0).getMBB();
+    Terms.erase(Terms.begin());
+  }
+
+  if (Terms.empty()) {
+    TBB = UncondTarget;
+    return false;
+  }
+
+  if (Terms.size() > 2)
     return true;
+
+  // A compare-and-branch is the whole condition on its own
+  for (MachineInstr *Term : Terms) {
+    if (!isCmpBranchOpcode(Term->getOpcode()))
+      continue;
+    if (Terms.size() != 1)
+      return true;
+    TBB = Term->getOperand(3).getMBB();
+    FBB = UncondTarget;
+    Cond.push_back(MachineOperand::CreateImm(Term->getOpcode()));
+    Cond.push_back(Term->getOperand(0));
+    Cond.push_back(Term->getOperand(1));
+    Cond.push_back(Term->getOperand(2));
+    return false;
   }
-  
+
+  // Both branches of a pair must go to the same place
+  MachineBasicBlock *CondTarget = Terms.back()->getOperand(0).getMBB();
+  if (Terms.front()->getOperand(0).getMBB() != CondTarget)
+    return true;
+
+  TBB = CondTarget;
+  FBB = UncondTarget;
+  for (unsigned Idx = Terms.size(); Idx-- > 0;)
+    Cond.push_back(MachineOperand::CreateImm(Terms[Idx]->getOpcode()));
   return false;
 }
 
@@ -359,21 +597,30 @@ unsigned M65832InstrInfo::insertBranch(MachineBasicBlock &MBB,
     MachineInstr &MI = *BuildMI(&MBB, DL, get(M65832::BRA)).addMBB(TBB);
     Added += MI.getDesc().getSize();
     ++Count;
-  } else {
-    // Conditional branch
-    unsigned Opc = Cond[0].getImm();
-    MachineInstr &MI = *BuildMI(&MBB, DL, get(Opc)).addMBB(TBB);
+  } else if (isCmpBranchOpcode(Cond[0].getImm())) {
+    MachineInstr &MI = *BuildMI(&MBB, DL, get(Cond[0].getImm()))
+                            .add(Cond[1])
+                            .add(Cond[2])
+                            .add(Cond[3])
+                            .addMBB(TBB);
     Added += MI.getDesc().getSize();
     ++Count;
-
-    if (FBB) {
-      // Need unconditional branch to false block
-      MachineInstr &MI2 = *BuildMI(&MBB, DL, get(M65832::BRA)).addMBB(FBB);
-      Added += MI2.getDesc().getSize();
+  } else {
+    // Conditional branch, possibly a pair to the same target
+    for (const MachineOperand &CC : Cond) {
+      MachineInstr &MI = *BuildMI(&MBB, DL, get(CC.getImm())).addMBB(TBB);
+      Added += MI.getDesc().getSize();
       ++Count;
     }
   }
 
+  if (!Cond.empty() && FBB) {
+    // Need unconditional branch to false block
+    MachineInstr &MI2 = *BuildMI(&MBB, DL, get(M65832::BRA)).addMBB(FBB);
+    Added += MI2.getDesc().getSize();
+    ++Count;
+  }
+
   if (BytesAdded)
     *BytesAdded = Added;
   return Count;
@@ -381,6 +628,15 @@ unsigned M65832InstrInfo::insertBranch(MachineBasicBlock &MBB,
 
 bool M65832InstrInfo::reverseBranchCondition(
     SmallVectorImpl<MachineOperand> &Cond) const {
+  // Every integer condition code has an inverse the expansion handles
+  if (Cond.size() == 4 && isCmpBranchOpcode(Cond[0].getImm())) {
+    Cond[3].setImm(
+        ISD::getSetCCInverse(ISD::CondCode(Cond[3].getImm()), MVT::i32));
+    return false;
+  }
+
+  // The inverse of a two-branch "either" condition needs both flags to hold
+  // at once, which a Bcc pair cannot express.
   if (Cond.size() != 1)
     return true;
 
@@ -404,26 +660,1584 @@ bool M65832InstrInfo::reverseBranchCondition(
   return false;
 }
 
+unsigned
+M65832InstrInfo::getTailDuplicateSize(CodeGenOptLevel OptLevel) const {
+  // A taken BRA costs a branch-unit slot and the refetch behind it, while
+  // one GPR operation is already three instructions (LDA; op; STA). The
+  // generic limits of 2 and 4 would only ever copy a lone branch.
+  return OptLevel >= CodeGenOptLevel::Aggressive ? 6 : 3;
+}
+
+/// The one Bcc that expandCondBranch emits for \p CC, or 0 when it needs
+/// two branches.
+static unsigned getSingleCondBranch(int64_t CC) {
+  switch (CC) {
+  case ISD::SETEQ:  return M65832::BEQ;
+  case ISD::SETNE:  return M65832::BNE;
+  case ISD::SETLT:  return M65832::BMI;
+  case ISD::SETGE:  return M65832::BPL;
+  case ISD::SETULT: return M65832::BCC;
+  case ISD::SETUGE: return M65832::BCS;
+  default:          return 0;
+  }
+}
+
+bool M65832InstrInfo::isUnconditionalTailCall(const MachineInstr &MI) const {
+  return MI.getOpcode() == M65832::TAILCALL &&
+         (MI.getOperand(0).isGlobal() || MI.getOperand(0).isSymbol());
+}
+
+bool M65832InstrInfo::canMakeTailCallConditional(
+    SmallVectorImpl<MachineOperand> &Cond,
+    const MachineInstr &TailCall) const {
+  if (!isUnconditionalTailCall(TailCall))
+    return false;
+  // A Bcc pair, or a compare whose condition expands to one, would need the
+  // tail call twice
+  if (Cond.size() == 1)
+    return isCondBranchOpcode(Cond[0].getImm());
+  return Cond.size() == 4 && isCmpBranchOpcode(Cond[0].getImm()) &&
+         getSingleCondBranch(Cond[3].getImm());
+}
+
+void M65832InstrInfo::replaceBranchWithTailCall(
+    MachineBasicBlock &MBB, SmallVectorImpl<MachineOperand> &Cond,
+    const MachineInstr &TailCall) const {
+  // The conditional branch is the first terminator analyzeBranch looked at
+  // that is not a BRA
+  MachineBasicBlock::iterator I = MBB.getFirstTerminator();
+  while (I != MBB.end() && I->getOpcode() != Cond[0].getImm())
+    ++I;
+  assert(I != MBB.end() && "conditional branch not found");
+
+  MachineInstrBuilder MIB =
+      BuildMI(MBB, I, I->getDebugLoc(), get(M65832::TAILCALL_CC))
+          .add(TailCall.getOperand(0));
+  for (const MachineOperand &MO : Cond)
+    MIB.add(MO);
+  MIB.copyImplicitOps(TailCall);
+
+  // Registers live out of MBB stay live across the call that may not happen
+  LivePhysRegs LiveRegs(getRegisterInfo());
+  LiveRegs.addLiveOuts(MBB);
+  SmallVector<std::pair<MCPhysReg, const MachineOperand *>, 8> Clobbers;
+  LiveRegs.stepForward(*MIB, Clobbers);
+  for (const auto &C : Clobbers) {
+    MIB.addReg(C.first, RegState::Implicit);
+    MIB.addReg(C.first, RegState::Implicit | RegState::Define);
+  }
+
+  I->eraseFromParent();
+}
+
+namespace {
+/// Loop control for the MachinePipeliner: the loop ends in one
+/// compare-and-branch, whose Cond is reused for the prolog exits.
+class M65832PipelinerLoopInfo : public TargetInstrInfo::PipelinerLoopInfo {
+  const MachineInstr *LHS;
+  const MachineInstr *RHS;
+  SmallVector<MachineOperand, 4> Cond;
+
+public:
+  M65832PipelinerLoopInfo(const MachineInstr *LHS, const MachineInstr *RHS,
+                          const SmallVectorImpl<MachineOperand> &Cond)
+      : LHS(LHS), RHS(RHS), Cond(Cond.begin(), Cond.end()) {}
+
+  // The instructions feeding the compare stay in stage 0
+  bool shouldIgnoreForPipelining(const MachineInstr *MI) const override {
+    return MI == LHS || MI == RHS;
+  }
+
+  // The branch is "if (Cond) goto epilog", Cond being the loop's exit test
+  std::optional<bool> createTripCountGreaterCondition(
+      int TC, MachineBasicBlock &MBB,
+      SmallVectorImpl<MachineOperand> &CondParam) override {
+    CondParam = Cond;
+    return {};
+  }
+
+  void setPreheader(MachineBasicBlock *NewPreheader) override {}
+
+  void adjustTripCount(int TripCountAdjust) override {}
+};
+} // namespace
+
+std::unique_ptr<TargetInstrInfo::PipelinerLoopInfo>
+M65832InstrInfo::analyzeLoopForPipelining(MachineBasicBlock *LoopBB) const {
+  MachineBasicBlock *TBB = nullptr, *FBB = nullptr;
+  SmallVector<MachineOperand, 4> Cond;
+  if (analyzeBranch(*LoopBB, TBB, FBB, Cond) || Cond.empty() ||
+      !isCmpBranchOpcode(Cond[0].getImm()))
+    return nullptr;
+
+  // A single-block loop with an exit
+  if (!FBB || (TBB == LoopBB) == (FBB == LoopBB))
+    return nullptr;
+  if (TBB == LoopBB)
+    reverseBranchCondition(Cond);
+
+  const MachineRegisterInfo &MRI = LoopBB->getParent()->getRegInfo();
+  auto FindRegDef = [&MRI](const MachineOperand &Op) -> const MachineInstr * {
+    if (!Op.isReg() || !Op.getReg().isVirtual())
+      return nullptr;
+    return MRI.getVRegDef(Op.getReg());
+  };
+  const MachineInstr *LHS = FindRegDef(Cond[1]);
+  const MachineInstr *RHS = FindRegDef(Cond[2]);
+  if ((LHS && LHS->isPHI()) || (RHS && RHS->isPHI()))
+    return nullptr;
+
+  return std::make_unique<M65832PipelinerLoopInfo>(LHS, RHS, Cond);
+}
+
+bool M65832InstrInfo::analyzeCompare(const MachineInstr &MI,
+                                     Register &SrcReg, Register &SrcReg2,
+                                     int64_t &CmpMask,
+                                     int64_t &CmpValue) const {
+  switch (MI.getOpcode()) {
+  default:
+    return false;
+  case M65832::CMP_GPR:
+  case M65832::CMPR_DP:
+  case M65832::BR_CC_CMP_PSEUDO:
+    SrcReg = MI.getOperand(0).getReg();
+    SrcReg2 = MI.getOperand(1).getReg();
+    CmpMask = ~0;
+    CmpValue = 0;
+    return true;
+  case M65832::CMP_GPR_IMM:
+  case M65832::CMPR_IMM:
+  case M65832::BR_CC_CMP_IMM_PSEUDO:
+    if (!MI.getOperand(1).isImm())
+      return false;
+    SrcReg = MI.getOperand(0).getReg();
+    SrcReg2 = Register();
+    CmpMask = ~0;
+    CmpValue = MI.getOperand(1).getImm();
+    return true;
+  }
+}
+
+/// Pseudos whose expansion leaves N and Z describing their result.
+static bool setsNZFromResult(unsigned Opc) {
+  switch (Opc) {
+  default:
+    return false;
+  case M65832::ADD_GPR:
+  case M65832::SUB_GPR:
+  case M65832::AND_GPR:
+  case M65832::ORA_GPR:
+  case M65832::EOR_GPR:
+  case M65832::ADDI_GPR:
+  case M65832::SUBI_GPR:
+  case M65832::ANDI_GPR:
+  case M65832::ORI_GPR:
+  case M65832::XORI_GPR:
+  case M65832::INC_GPR:
+  case M65832::DEC_GPR:
+  case M65832::ADDR_DP:
+  case M65832::SUBR_DP:
+  case M65832::ANDR_DP:
+  case M65832::ORAR_DP:
+  case M65832::EORR_DP:
+  case M65832::ADDR_IMM:
+  case M65832::SUBR_IMM:
+  case M65832::ANDR_IMM:
+  case M65832::ORAR_IMM:
+  case M65832::EORR_IMM:
+  case M65832::MAC_GPR:
+    return true;
+  }
+}
+
+bool M65832InstrInfo::optimizeCompareInstr(
+    MachineInstr &CmpInstr, Register SrcReg, Register SrcReg2,
+    int64_t CmpMask, int64_t CmpValue, const MachineRegisterInfo *MRI) const {
+  // Only the fused branch carries its condition, and only small constants
+  // can move to 0. canonicalizeIntCC turns x > 0 into x >= 1 and x <= 0
+  // into x < 1, which this undoes.
+  if (CmpInstr.getOpcode() != M65832::BR_CC_CMP_IMM_PSEUDO || SrcReg2 ||
+      CmpValue != 1 || !SrcReg.isVirtual())
+    return false;
+
+  // Whether lhs comes from an instruction in this block whose flags reach
+  // the branch, so that the compare against 0 costs nothing.
+  auto FlagsReachBranch = [&]() {
+    MachineInstr *Def = MRI->getUniqueVRegDef(SrcReg);
+    if (!Def || Def->getParent() != CmpInstr.getParent() ||
+        !setsNZFromResult(Def->getOpcode()))
+      return false;
+    for (MachineBasicBlock::iterator I = std::next(Def->getIterator()),
+                                     E = CmpInstr.getIterator();
+         I != E; ++I)
+      if (I->isCall() || I->isInlineAsm() ||
+          I->modifiesRegister(M65832::SR, /*TRI=*/nullptr))
+        return false;
+    return true;
+  };
+
+  // The unsigned forms cost a single branch either way; the signed ones
+  // need BEQ as well and are only worth it when the CMP goes away.
+  ISD::CondCode NewCC;
+  switch (CmpInstr.getOperand(2).getImm()) {
+  case ISD::SETULT: NewCC = ISD::SETEQ; break;
+  case ISD::SETUGE: NewCC = ISD::SETNE; break;
+  case ISD::SETLT:
+    if (!FlagsReachBranch())
+      return false;
+    NewCC = ISD::SETLE;
+    break;
+  case ISD::SETGE:
+    if (!FlagsReachBranch())
+      return false;
+    NewCC = ISD::SETGT;
+    break;
+  default:
+    return false;
+  }
+
+  BuildMI(*CmpInstr.getParent(), CmpInstr, CmpInstr.getDebugLoc(),
+          get(M65832::BR_CC_CMP_IMM_PSEUDO))
+      .add(CmpInstr.getOperand(0))
+      .addImm(0)
+      .addImm(NewCC)
+      .add(CmpInstr.getOperand(3));
+  CmpInstr.eraseFromParent();
+  return true;
+}
+
+bool M65832InstrInfo::isAssociativeAndCommutative(const MachineInstr &Inst,
+                                                  bool Invert) const {
+  if (Invert)
+    return false;
+  switch (Inst.getOpcode()) {
+  case M65832::ADD_GPR:
+  case M65832::AND_GPR:
+  case M65832::ORA_GPR:
+  case M65832::EOR_GPR:
+    return true;
+  case M65832::FADD_S:
+  case M65832::FADD_D:
+  case M65832::FMUL_S:
+  case M65832::FMUL_D:
+    return Inst.getFlag(MachineInstr::MIFlag::FmReassoc) &&
+           Inst.getFlag(MachineInstr::MIFlag::FmNsz);
+  default:
+    return false;
+  }
+}
+
+// The integer pseudos define SR, which nothing may read once the chain is
+// reordered
+bool M65832InstrInfo::hasReassociableOperands(
+    const MachineInstr &Inst, const MachineBasicBlock *MBB) const {
+  if (Inst.definesRegister(M65832::SR, /*TRI=*/nullptr) &&
+      !Inst.registerDefIsDead(M65832::SR, /*TRI=*/nullptr))
+    return false;
+  return TargetInstrInfo::hasReassociableOperands(Inst, MBB);
+}
+
+MachineInstr *M65832InstrInfo::convertToThreeAddress(MachineInstr &MI,
+                                                     LiveVariables *LV,
+                                                     LiveIntervals *LIS) const {
+  MachineBasicBlock &MBB = *MI.getParent();
+  unsigned NewOpc;
+  bool ClobbersA = false;
+  switch (MI.getOpcode()) {
+  default:
+    return nullptr;
+  // dst = src +/- 1 as LDA src; INC A/DEC A; STA dst once the encodings are
+  // shrunk, 5 bytes against 7 for LD dst,src; INC dst.
+  case M65832::INC_GPR:
+    NewOpc = M65832::ADDI_GPR;
+    ClobbersA = true;
+    break;
+  case M65832::DEC_GPR:
+    NewOpc = M65832::SUBI_GPR;
+    ClobbersA = true;
+    break;
+  // The barrel shifter has a separate source.
+  case M65832::ASL_GPR:
+    NewOpc = M65832::SHLR;
+    break;
+  case M65832::LSR_GPR:
+    NewOpc = M65832::SHRR;
+    break;
+  }
+
+  // A carries values between a few hard-wired instructions; don't land in
+  // the middle of one of those.
+  if (ClobbersA && MBB.computeRegisterLiveness(&RI, M65832::A, MI) !=
+                       MachineBasicBlock::LQR_Dead)
+    return nullptr;
+
+  MachineInstr *NewMI = BuildMI(MBB, MI, MI.getDebugLoc(), get(NewOpc))
+                            .add(MI.getOperand(0))
+                            .add(MI.getOperand(1))
+                            .addImm(1);
+
+  if (LV) {
+    const MachineOperand &Src = MI.getOperand(1);
+    if (Src.isKill())
+      LV->replaceKillInstruction(Src.getReg(), MI, *NewMI);
+  }
+
+  if (LIS) {
+    LIS->ReplaceMachineInstrInMaps(MI, *NewMI);
+    // The new A def is recomputed on demand.
+    if (ClobbersA)
+      LIS->removeAllRegUnitsForPhysReg(M65832::A);
+  }
+
+  return NewMI;
+}
+
+int M65832InstrInfo::getSPAdjust(const MachineInstr &MI) const {
+  if (MI.getOpcode() == M65832::PUSH32)
+    return 4;
+  return TargetInstrInfo::getSPAdjust(MI);
+}
+
+bool M65832InstrInfo::isIgnorableUse(const MachineOperand &MO) const {
+  return MO.getReg() == M65832::SP &&
+         MO.getParent()->getOpcode() == M65832::LA_PCREL;
+}
+
+bool M65832InstrInfo::shouldHoist(const MachineInstr &MI,
+                                  const MachineLoop *FromLoop) const {
+  const MachineRegisterInfo &MRI = MI.getMF()->getRegInfo();
+  for (const MachineOperand &MO : MI.defs())
+    if (MO.getReg().isVirtual() &&
+        M65832::AXYRegClass.hasSubClassEq(MRI.getRegClass(MO.getReg())))
+      return false;
+  return true;
+}
+
+unsigned M65832InstrInfo::getInstSizeInBytes(const MachineInstr &MI) const {
+  if (MI.isInlineAsm()) {
+    const MachineFunction &MF = *MI.getParent()->getParent();
+    return getInlineAsmLength(MI.getOperand(0).getSymbolName(),
+                              *MF.getTarget().getMCAsmInfo());
+  }
+  // One byte per NOP of -fpatchable-function-entry (see M65832AsmPrinter)
+  if (MI.getOpcode() == TargetOpcode::PATCHABLE_FUNCTION_ENTER) {
+    unsigned Num = 0;
+    (void)MI.getMF()
+        ->getFunction()
+        .getFnAttribute("patchable-function-entry")
+        .getValueAsString()
+        .getAsInteger(10, Num);
+    return Num;
+  }
+  return MI.getDesc().getSize();
+}
+
+MCInst M65832InstrInfo::getNop() const {
+  return MCInstBuilder(M65832::NOP);
+}
+
+bool M65832InstrInfo::isBranchOffsetInRange(unsigned BranchOpc,
+                                            int64_t BrOffset) const {
+  switch (BranchOpc) {
+  case M65832::BRA:
+  case M65832::BRL:
+  case M65832::BEQ:
+  case M65832::BNE:
+  case M65832::BCS:
+  case M65832::BCC:
+  case M65832::BMI:
+  case M65832::BPL:
+  case M65832::BVS:
+  case M65832::BVC:
+    // BrOffset is measured from the start of the 3-byte branch
+    return isInt<16>(BrOffset - 3);
+  default:
+    // JMP and the indirect jumps are not PC-relative
+    return true;
+  }
+}
+
+MachineBasicBlock *
+M65832InstrInfo::getBranchDestBlock(const MachineInstr &MI) const {
+  assert(MI.getOperand(0).isMBB() && "Branch target is not a block");
+  return MI.getOperand(0).getMBB();
+}
+
+void M65832InstrInfo::insertIndirectBranch(MachineBasicBlock &MBB,
+                                           MachineBasicBlock &NewDestBB,
+                                           MachineBasicBlock &RestoreBB,
+                                           const DebugLoc &DL, int64_t BrOffset,
+                                           RegScavenger *RS) const {
+  // A never carries a value across a block boundary and R31 is reserved, so
+  // neither needs to be saved and RestoreBB stays empty.
+  unsigned ScratchDP = getDPOffset(M65832::R31 - M65832::R0);
+  BuildMI(&MBB, DL, get(M65832::LDA_IMM), M65832::A).addMBB(&NewDestBB);
+  BuildMI(&MBB, DL, get(M65832::STA_DP))
+      .addReg(M65832::A, RegState::Kill)
+      .addImm(ScratchDP);
+  BuildMI(&MBB, DL, get(M65832::JMP_DP_IND)).addImm(ScratchDP);
+}
+
+bool M65832InstrInfo::isFunctionSafeToSplit(const MachineFunction &MF) const {
+  // The relaxed cross-section branches load an absolute address, which
+  // -fPIC code cannot use.
+  if (MF.getTarget().isPositionIndependent())
+    return false;
+  return TargetInstrInfo::isFunctionSafeToSplit(MF);
+}
+
+bool M65832InstrInfo::isMBBSafeToSplitToCold(
+    const MachineBasicBlock &MBB) const {
+  // Branches inside an asm goto cannot be relaxed, so its labels have to
+  // stay within reach.
+  if (MBB.isInlineAsmBrIndirectTarget())
+    return false;
+  return llvm::none_of(MBB, [](const MachineInstr &MI) {
+    return MI.getOpcode() == TargetOpcode::INLINEASM_BR;
+  });
+}
+
+bool M65832InstrInfo::isFunctionSafeToOutlineFrom(
+    MachineFunction &MF, bool OutlineFromLinkOnceODRs) const {
+  const Function &F = MF.getFunction();
+
+  // The linker may deduplicate linkonce_odr functions, and code placed in a
+  // named section is expected to stay there.
+  if (!OutlineFromLinkOnceODRs && F.hasLinkOnceODRLinkage())
+    return false;
+  if (F.hasSection())
+    return false;
+
+  // Patchable entries and exits must keep their exact layout.
+  if (F.hasFnAttribute("patchable-function-entry"))
+    return false;
+  // Outlined calls are a JSR or LD.L #fn to an absolute address
+  if (MF.getTarget().isPositionIndependent())
+    return false;
+  return true;
+}
+
+bool M65832InstrInfo::isMBBSafeToOutlineFrom(MachineBasicBlock &MBB,
+                                             unsigned &Flags) const {
+  // The SP and return checks are done per instruction and per candidate.
+  return TargetInstrInfo::isMBBSafeToOutlineFrom(MBB, Flags);
+}
+
+bool M65832InstrInfo::shouldOutlineFromFunctionByDefault(
+    MachineFunction &MF) const {
+  // Every outlined call costs a JSR/RTS round trip; only worth it at -Oz
+  return MF.getFunction().hasMinSize();
+}
+
+// How an outlined sequence is called and left
+enum MachineOutlinerConstructionID {
+  MachineOutlinerTailCall, // LD.L R31,#fn; JMP (R31), fn ends in our RTS
+  MachineOutlinerDefault   // JSR fn, fn ends in an added RTS
+};
+
+static bool touchesSP(const MachineInstr &MI) {
+  return MI.readsRegister(M65832::SP, /*TRI=*/nullptr) ||
+         MI.modifiesRegister(M65832::SP, /*TRI=*/nullptr);
+}
+
+/// A block whose last instruction is RTS can hand its return to an
+/// outlined tail, so SP users there are still candidates.
+static bool endsInRTS(const MachineBasicBlock &MBB) {
+  return !MBB.empty() && MBB.back().getOpcode() == M65832::RTS;
+}
+
+std::optional<std::unique_ptr<outliner::OutlinedFunction>>
+M65832InstrInfo::getOutliningCandidateInfo(
+    const MachineModuleInfo &MMI,
+    std::vector<outliner::Candidate> &RepeatedSequenceLocs,
+    unsigned MinRepeats) const {
+  // Each candidate is the same sequence, so one of them decides.
+  outliner::Candidate &Candidate = RepeatedSequenceLocs[0];
+
+  MachineOutlinerConstructionID MOCI;
+  unsigned CallOverhead, FrameOverhead;
+  if (Candidate.back().getOpcode() == M65832::RTS) {
+    // The RTS moves into the outlined function and the caller jumps to it
+    // with SP untouched, so stack-relative code keeps its offsets. R31 is
+    // the reserved scratch and dead by the time we reach an RTS.
+    MOCI = MachineOutlinerTailCall;
+    CallOverhead =
+        get(M65832::LDR_IMM).getSize() + get(M65832::JMP_DP_IND).getSize();
+    FrameOverhead = 0;
+  } else {
+    // JSR leaves the return address on the stack for the body to see.
+    if (llvm::any_of(Candidate, touchesSP))
+      return std::nullopt;
+    MOCI = MachineOutlinerDefault;
+    CallOverhead = get(M65832::JSR).getSize();
+    FrameOverhead = get(M65832::RTS).getSize();
+  }
+
+  for (outliner::Candidate &C : RepeatedSequenceLocs)
+    C.setCallInfo(MOCI, CallOverhead);
+
+  unsigned SequenceSize = 0;
+  for (const MachineInstr &MI : Candidate)
+    SequenceSize += getInstSizeInBytes(MI);
+
+  return std::make_unique<outliner::OutlinedFunction>(
+      RepeatedSequenceLocs, SequenceSize, FrameOverhead, MOCI);
+}
+
+outliner::InstrType
+M65832InstrInfo::getOutliningTypeImpl(const MachineModuleInfo &MMI,
+                                      MachineBasicBlock::iterator &MIT,
+                                      unsigned Flags) const {
+  MachineInstr &MI = *MIT;
+
+  // CFI describes the frame of the function it is in
+  if (MI.isCFIInstruction())
+    return outliner::InstrType::Illegal;
+
+  // RTS is the only exit that can move into the outlined function. RTI
+  // depends on the interrupt frame, and the indirect jumps read a DP slot
+  // (R31 for tail calls) that the liveness tracking does not see.
+  if (MI.isReturn() || MI.isIndirectBranch())
+    return MI.getOpcode() == M65832::RTS ? outliner::InstrType::Legal
+                                         : outliner::InstrType::Illegal;
+
+  // Skips inside an expanded select or block move are Bcc/BRA *+N with an
+  // immediate offset; the generic code only sees blocks, so keep the whole
+  // expansion together by never outlining its branches.
+  if ((MI.isConditionalBranch() || MI.isUnconditionalBranch()) &&
+      MI.getOperand(0).isImm())
+    return outliner::InstrType::Illegal;
+
+  // Stack pointer users only survive a tail call
+  if (touchesSP(MI) && !endsInRTS(*MI.getParent()))
+    return outliner::InstrType::Illegal;
+
+  return outliner::InstrType::Legal;
+}
+
+void M65832InstrInfo::buildOutlinedFrame(
+    MachineBasicBlock &MBB, MachineFunction &MF,
+    const outliner::OutlinedFunction &OF) const {
+  if (OF.FrameConstructionID == MachineOutlinerTailCall)
+    return;
+
+  MBB.insert(MBB.end(), BuildMI(MF, DebugLoc(), get(M65832::RTS)));
+}
+
+MachineBasicBlock::iterator M65832InstrInfo::insertOutlinedCall(
+    Module &M, MachineBasicBlock &MBB, MachineBasicBlock::iterator &It,
+    MachineFunction &MF, outliner::Candidate &C) const {
+  const GlobalValue *Callee = M.getNamedValue(MF.getName());
+
+  if (C.CallConstructionID == MachineOutlinerTailCall) {
+    // Same shape as an expanded TAILCALL, including the -mrelax marker
+    // that lets the linker turn it into a BRA.
+    unsigned Flags = MBB.getParent()->getSubtarget<M65832Subtarget>()
+                             .enableLinkerRelax()
+                         ? M65832II::MO_JMPABS
+                         : 0;
+    BuildMI(MBB, It, DebugLoc(), get(M65832::LDR_IMM), M65832::R31)
+        .addGlobalAddress(Callee, 0, Flags);
+    It = BuildMI(MBB, It, DebugLoc(), get(M65832::JMP_DP_IND))
+             .addImm(getDPOffset(M65832::R31 - M65832::R0));
+    return It;
+  }
+
+  // Unlike a call to real code, the outlined body clobbers nothing but
+  // what it defines itself (the outliner adds those as implicit defs), so
+  // leave off JSR's caller-saved clobber list.
+  MachineInstr *Call =
+      MF.CreateMachineInstr(get(M65832::JSR), DebugLoc(), /*NoImplicit=*/true);
+  MachineInstrBuilder(MF, Call)
+      .addGlobalAddress(Callee)
+      .addReg(M65832::SP, RegState::Implicit)
+      .addReg(M65832::SP, RegState::ImplicitDefine);
+  It = MBB.insert(It, Call);
+  return It;
+}
+
+namespace {
+/// B-relative values known to be held in A and in DP registers, as seen by
+/// a forward walk over already-expanded frame address computations.
+struct FrameAddrState {
+  std::optional<int64_t> A;
+  SmallDenseMap<unsigned, int64_t, 8> Slots; // DP offset -> B + value
+  bool CarryClear = false;
+
+  void clobberSlotsUsedBy(const MachineInstr &MI) {
+    for (const MachineOperand &MO : MI.operands()) {
+      if (MO.isImm())
+        Slots.erase(MO.getImm());
+      else if (MO.isReg() && MO.isDef() && M65832::GPRRegClass.contains(
+                                               MO.getReg()))
+        Slots.erase(
+            M65832InstrInfo::getDPOffset(MO.getReg() - M65832::R0));
+    }
+  }
+
+  void step(const MachineInstr &MI);
+};
+} // end anonymous namespace
+
+void FrameAddrState::step(const MachineInstr &MI) {
+  bool WasCarryClear = CarryClear;
+  CarryClear = false;
+
+  switch (MI.getOpcode()) {
+  case M65832::TBA:
+    A = 0;
+    return;
+  case M65832::CLC:
+    CarryClear = true;
+    return;
+  case M65832::ADC_IMM:
+    if (A && WasCarryClear && MI.getOperand(2).isImm())
+      A = *A + MI.getOperand(2).getImm();
+    else
+      A.reset();
+    return;
+  case M65832::STA_DP:
+    if (A)
+      Slots[MI.getOperand(1).getImm()] = *A;
+    else
+      Slots.erase(MI.getOperand(1).getImm());
+    if (MI.killsRegister(M65832::A, /*TRI=*/nullptr))
+      A.reset();
+    return;
+  case M65832::MOVR_DP: {
+    unsigned Dst = M65832InstrInfo::getDPOffset(MI.getOperand(0).getReg() -
+                                                M65832::R0);
+    unsigned Src = M65832InstrInfo::getDPOffset(MI.getOperand(1).getReg() -
+                                                M65832::R0);
+    auto It = Slots.find(Src);
+    if (It != Slots.end())
+      Slots[Dst] = It->second;
+    else
+      Slots.erase(Dst);
+    return;
+  }
+  case M65832::ADDR_IMM: {
+    unsigned Dst = M65832InstrInfo::getDPOffset(MI.getOperand(0).getReg() -
+                                                M65832::R0);
+    auto It = Slots.find(Dst);
+    if (It != Slots.end() && WasCarryClear && MI.getOperand(2).isImm())
+      It->second += MI.getOperand(2).getImm();
+    else
+      Slots.erase(Dst);
+    return;
+  }
+  default:
+    break;
+  }
+
+  if (MI.modifiesRegister(M65832::A, /*TRI=*/nullptr) ||
+      MI.killsRegister(M65832::A, /*TRI=*/nullptr))
+    A.reset();
+  if (MI.mayStore())
+    Slots.clear();
+  else
+    clobberSlotsUsedBy(MI);
+}
+
+/// How far back to look for an earlier frame address computation.
+static constexpr unsigned FrameAddrScanLimit = 32;
+
+void M65832InstrInfo::expandFrameAddrFromB(MachineInstr &MI, Register DstReg,
+                                           int64_t Offset) const {
+  MachineBasicBlock &MBB = *MI.getParent();
+  DebugLoc DL = MI.getDebugLoc();
+  unsigned DstDP = getDPOffset(DstReg - M65832::R0);
+
+  // Find the most recent TBA that nothing after it has invalidated, then
+  // replay the instructions from there to learn which of A and the DP
+  // registers still hold B + constant.
+  MachineBasicBlock::iterator Start = MI.getIterator();
+  bool Found = false;
+  for (unsigned Scanned = 0;
+       Start != MBB.begin() && Scanned < FrameAddrScanLimit; ++Scanned) {
+    --Start;
+    if (Start->isCall() || Start->isInlineAsm() ||
+        Start->modifiesRegister(M65832::B, /*TRI=*/nullptr) ||
+        Start->modifiesRegister(M65832::D, /*TRI=*/nullptr) ||
+        (Start->isBranch() && Start->getNumOperands() &&
+         Start->getOperand(0).isImm()))
+      break;
+    if (Start->getOpcode() == M65832::TBA) {
+      Found = true;
+      break;
+    }
+  }
+
+  FrameAddrState State;
+  if (Found)
+    for (MachineBasicBlock::iterator I = Start; I != MI.getIterator(); ++I)
+      if (!I->isDebugInstr())
+        State.step(*I);
+
+  // dst already available in another register: LD Rd,Rs (no flags, no A).
+  for (const auto &[SlotDP, Value] : State.Slots) {
+    if (Value != Offset)
+      continue;
+    if (SlotDP != DstDP)
+      BuildMI(MBB, MI, DL, get(M65832::MOVR_DP), DstReg)
+          .addReg(M65832::R0 + SlotDP / 4);
+    return;
+  }
+
+  // A holds B + n: CLC; ADC #(offset - n); STA dst.
+  if (State.A) {
+    int64_t Delta = Offset - *State.A;
+    if (Delta != 0) {
+      BuildMI(MBB, MI, DL, get(M65832::CLC));
+      BuildMI(MBB, MI, DL, get(M65832::ADC_IMM), M65832::A)
+          .addReg(M65832::A)
+          .addImm(Delta);
+    }
+    BuildMI(MBB, MI, DL, get(M65832::STA_DP))
+        .addReg(M65832::A)
+        .addImm(DstDP);
+    return;
+  }
+
+  // A GPR holds B + n: LD dst,Rs; CLC; ADC dst,#(offset - n).
+  if (!State.Slots.empty()) {
+    auto [SlotDP, Value] = *State.Slots.begin();
+    BuildMI(MBB, MI, DL, get(M65832::MOVR_DP), DstReg)
+        .addReg(M65832::R0 + SlotDP / 4);
+    BuildMI(MBB, MI, DL, get(M65832::CLC));
+    BuildMI(MBB, MI, DL, get(M65832::ADDR_IMM), DstReg)
+        .addReg(DstReg)
+        .addImm(Offset - Value);
+    return;
+  }
+
+  // Nothing to reuse: TBA; CLC; ADC #offset; STA dst. A is left holding the
+  // address so later siblings can start from it.
+  BuildMI(MBB, MI, DL, get(M65832::TBA), M65832::A);
+  if (Offset != 0) {
+    BuildMI(MBB, MI, DL, get(M65832::CLC));
+    BuildMI(MBB, MI, DL, get(M65832::ADC_IMM), M65832::A)
+        .addReg(M65832::A)
+        .addImm(Offset);
+  }
+  BuildMI(MBB, MI, DL, get(M65832::STA_DP))
+      .addReg(M65832::A)
+      .addImm(DstDP);
+}
+
+void M65832InstrInfo::adjustStackPtr(MachineBasicBlock &MBB,
+                                     MachineBasicBlock::iterator I,
+                                     const DebugLoc &DL,
+                                     int64_t Amount) const {
+  if (Amount == 0)
+    return;
+
+  uint64_t Bytes = Amount < 0 ? -(uint64_t)Amount : (uint64_t)Amount;
+  if (Bytes % 4 == 0 && Bytes / 4 <= MaxStackAdjustSlots) {
+    for (uint64_t N = Bytes / 4; N != 0; --N) {
+      if (Amount < 0) {
+        // Allocate: the pushed value is irrelevant.
+        MachineInstr *Push = BuildMI(MBB, I, DL, get(M65832::PHY));
+        Push->findRegisterUseOperand(M65832::Y, /*TRI=*/nullptr)
+            ->setIsUndef();
+      } else {
+        BuildMI(MBB, I, DL, get(M65832::PLY));
+      }
+    }
+    return;
+  }
+
+  // TSX; TXA; SEC; SBC #n (or CLC; ADC #n); TAX; TXS
+  BuildMI(MBB, I, DL, get(M65832::TSX), M65832::X);
+  BuildMI(MBB, I, DL, get(M65832::TXA), M65832::A).addReg(M65832::X);
+  if (Amount < 0) {
+    BuildMI(MBB, I, DL, get(M65832::SEC));
+    BuildMI(MBB, I, DL, get(M65832::SBC_IMM), M65832::A)
+        .addReg(M65832::A)
+        .addImm(Bytes);
+  } else {
+    BuildMI(MBB, I, DL, get(M65832::CLC));
+    BuildMI(MBB, I, DL, get(M65832::ADC_IMM), M65832::A)
+        .addReg(M65832::A)
+        .addImm(Bytes);
+  }
+  BuildMI(MBB, I, DL, get(M65832::TAX), M65832::X).addReg(M65832::A);
+  BuildMI(MBB, I, DL, get(M65832::TXS)).addReg(M65832::X);
+}
+
+MachineInstr *M65832InstrInfo::loadImmediate(MachineBasicBlock &MBB,
+                                             MachineBasicBlock::iterator I,
+                                             const DebugLoc &DL,
+                                             Register DstReg,
+                                             uint32_t Imm) const {
+  // STZ $dst (2 bytes), LD.B/LD.W $dst,#imm (5/6), LD.L $dst,#imm (8)
+  if (Imm == 0)
+    return BuildMI(MBB, I, DL, get(M65832::STZ_DP))
+        .addImm(getDPOffset(DstReg - M65832::R0))
+        .addReg(DstReg, RegState::ImplicitDefine);
+  unsigned Opc = isUInt<8>(Imm)    ? M65832::LDB_IMM
+                 : isUInt<16>(Imm) ? M65832::LDW_IMM
+                                   : M65832::LDR_IMM;
+  return BuildMI(MBB, I, DL, get(Opc), DstReg).addImm(Imm);
+}
+
+/// Return true if N and Z just before \p I describe the value in \p Reg.
+/// The flag-setting instruction may only be followed by stores of A and by
+/// register moves into other registers (the copies PHI elimination puts in
+/// front of a loop's back-edge), which leave SR alone.
+static bool flagsReflectReg(MachineBasicBlock &MBB,
+                            MachineBasicBlock::iterator I, Register Reg) {
+  if (Reg < M65832::R0 || Reg > M65832::R63)
+    return false;
+  unsigned DP = M65832InstrInfo::getDPOffset(Reg - M65832::R0);
+  bool AHoldsReg = false;
+  while (I != MBB.begin()) {
+    --I;
+    if (I->isDebugInstr())
+      continue;
+    switch (I->getOpcode()) {
+    case M65832::STA_DP:
+      if (I->getOperand(1).getImm() == DP)
+        AHoldsReg = true;
+      continue;
+    // GPR copies are MOVR_DP, which sets no flags
+    case M65832::MOVR_DP:
+    case TargetOpcode::COPY:
+      if (I->getOperand(0).getReg() == Reg ||
+          !M65832::GPRRegClass.contains(I->getOperand(0).getReg()) ||
+          !M65832::GPRRegClass.contains(I->getOperand(1).getReg()))
+        return false;
+      continue;
+
+    // N/Z from the result in A
+    case M65832::LDA_DP:
+    case M65832::LDA_IMM:
+    case M65832::ADC_DP:
+    case M65832::ADC_IMM:
+    case M65832::SBC_DP:
+    case M65832::SBC_IMM:
+    case M65832::AND_DP:
+    case M65832::AND_IMM:
+    case M65832::ORA_DP:
+    case M65832::ORA_IMM:
+    case M65832::EOR_DP:
+    case M65832::EOR_IMM:
+    case M65832::INC_A:
+    case M65832::DEC_A:
+    case M65832::TXA:
+    case M65832::TYA:
+      return AHoldsReg;
+
+    // N/Z from the DP location itself
+    case M65832::INC_DP:
+    case M65832::DEC_DP:
+      return !AHoldsReg && I->getOperand(0).getImm() == DP;
+
+    // N/Z from the register result of the extended ALU
+    case M65832::ADDR_DP:
+    case M65832::SUBR_DP:
+    case M65832::ANDR_DP:
+    case M65832::ORAR_DP:
+    case M65832::EORR_DP:
+    case M65832::ADDR_IMM:
+    case M65832::SUBR_IMM:
+    case M65832::ANDR_IMM:
+    case M65832::ORAR_IMM:
+    case M65832::EORR_IMM:
+    case M65832::INCr:
+    case M65832::DECr:
+      return !AHoldsReg && I->getOperand(0).getReg() == Reg;
+
+    default:
+      return false;
+    }
+  }
+  return false;
+}
+
+namespace {
+/// How a _GLOBAL pseudo reaches its global.
+enum class GlobalAccess { Abs32, BankRel, DirectPage };
+} // namespace
+
+/// The address operand of a _GLOBAL pseudo and how to reach it. %bankrel
+/// needs a function whose prologue pointed B at __data_bank_base, and %dp
+/// one that leaves D alone; everything else is 32-bit absolute. In a
+/// function with B at the data bank a %bankabs access keeps its flag, so
+/// that the linker may shorten it to B-relative.
+static MachineOperand getGlobalAddress(const MachineInstr &MI,
+                                       GlobalAccess &Kind,
+                                       unsigned OpNo = 1) {
+  MachineOperand MO = MI.getOperand(OpNo);
+  const auto *FuncInfo = MI.getMF()->getInfo<M65832MachineFunctionInfo>();
+  if (MO.getTargetFlags() == M65832II::MO_BANKREL && FuncInfo->usesDataBank()) {
+    Kind = GlobalAccess::BankRel;
+  } else if (MO.getTargetFlags() == M65832II::MO_BANKABS &&
+             FuncInfo->usesDataBank()) {
+    Kind = GlobalAccess::Abs32;
+  } else if (MO.getTargetFlags() == M65832II::MO_DP &&
+             FuncInfo->getWindowShift() == 0) {
+    Kind = GlobalAccess::DirectPage;
+  } else {
+    Kind = GlobalAccess::Abs32;
+    MO.setTargetFlags(M65832II::MO_NO_FLAG);
+  }
+  return MO;
+}
+
+/// The sized load/store opcode for a _GLOBAL access of kind \p Kind.
+static unsigned getGlobalAccessOpcode(GlobalAccess Kind, unsigned Abs32,
+                                      unsigned BankRel, unsigned DirectPage) {
+  switch (Kind) {
+  case GlobalAccess::Abs32:
+    return Abs32;
+  case GlobalAccess::BankRel:
+    return BankRel;
+  case GlobalAccess::DirectPage:
+    return DirectPage;
+  }
+  llvm_unreachable("Unknown global access kind");
+}
+
+/// Number of bytes from \p From up to (not including) \p To. Used to form
+/// the "*+N" immediates of branches inside a pseudo expansion.
+static int64_t getRangeSize(MachineBasicBlock::iterator From,
+                            MachineBasicBlock::iterator To) {
+  int64_t Bytes = 0;
+  for (MachineBasicBlock::iterator I = From; I != To; ++I)
+    Bytes += I->getDesc().getSize();
+  return Bytes;
+}
+
+void M65832InstrInfo::expandAtomicRMW(MachineInstr &MI) const {
+  MachineBasicBlock &MBB = *MI.getParent();
+  DebugLoc DL = MI.getDebugLoc();
+  unsigned DstDP = getDPOffset(MI.getOperand(0).getReg() - M65832::R0);
+  unsigned AddrDP = getDPOffset(MI.getOperand(1).getReg() - M65832::R0);
+  unsigned ValDP = getDPOffset(MI.getOperand(2).getReg() - M65832::R0);
+
+  // Without LLI/SCI the operation runs with interrupts masked instead:
+  //   PHP; SEI; LDA (addr); STA dst; <op>; STA (addr); PLP
+  // PLP restores the caller's I flag, so nothing outside the sequence
+  // changes I.
+  bool Masked =
+      !MBB.getParent()->getSubtarget<M65832Subtarget>().hasAtomics();
+  MachineBasicBlock::iterator Retry;
+  if (Masked) {
+    BuildMI(MBB, MI, DL, get(M65832::PHP));
+    BuildMI(MBB, MI, DL, get(M65832::SEI));
+    BuildMI(MBB, MI, DL, get(M65832::LDA_IND), M65832::A).addImm(AddrDP);
+  } else {
+    // Point B at the target word so the B-relative LLI/SCI can reach it.
+    BuildMI(MBB, MI, DL, get(M65832::PHB32));
+    BuildMI(MBB, MI, DL, get(M65832::SB_DP)).addImm(AddrDP);
+
+    // retry: LLI $0000; STA dst; <op>; SCI $0000; BCC retry
+    Retry = BuildMI(MBB, MI, DL, get(M65832::LLI_ABS)).addImm(0);
+  }
+  BuildMI(MBB, MI, DL, get(M65832::STA_DP)).addReg(M65832::A).addImm(DstDP);
+
+  switch (MI.getOpcode()) {
+  default:
+    llvm_unreachable("unexpected atomic pseudo");
+  case M65832::ATOMIC_SWAP32:
+    BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A).addImm(ValDP);
+    break;
+  case M65832::ATOMIC_LOAD_ADD32:
+    BuildMI(MBB, MI, DL, get(M65832::CLC));
+    BuildMI(MBB, MI, DL, get(M65832::ADC_DP), M65832::A)
+        .addReg(M65832::A)
+        .addImm(ValDP);
+    break;
+  case M65832::ATOMIC_LOAD_SUB32:
+    BuildMI(MBB, MI, DL, get(M65832::SEC));
+    BuildMI(MBB, MI, DL, get(M65832::SBC_DP), M65832::A)
+        .addReg(M65832::A)
+        .addImm(ValDP);
+    break;
+  case M65832::ATOMIC_LOAD_AND32:
+  case M65832::ATOMIC_LOAD_NAND32:
+    BuildMI(MBB, MI, DL, get(M65832::AND_DP), M65832::A)
+        .addReg(M65832::A)
+        .addImm(ValDP);
+    if (MI.getOpcode() == M65832::ATOMIC_LOAD_NAND32)
+      BuildMI(MBB, MI, DL, get(M65832::EOR_IMM), M65832::A)
+          .addReg(M65832::A)
+          .addImm(-1);
+    break;
+  case M65832::ATOMIC_LOAD_OR32:
+    BuildMI(MBB, MI, DL, get(M65832::ORA_DP), M65832::A)
+        .addReg(M65832::A)
+        .addImm(ValDP);
+    break;
+  case M65832::ATOMIC_LOAD_XOR32:
+    BuildMI(MBB, MI, DL, get(M65832::EOR_DP), M65832::A)
+        .addReg(M65832::A)
+        .addImm(ValDP);
+    break;
+  }
+
+  if (Masked) {
+    BuildMI(MBB, MI, DL, get(M65832::STA_IND))
+        .addReg(M65832::A, RegState::Kill)
+        .addImm(AddrDP);
+    BuildMI(MBB, MI, DL, get(M65832::PLP));
+    return;
+  }
+
+  BuildMI(MBB, MI, DL, get(M65832::SCI_ABS)).addImm(0);
+
+  // Branch offsets are relative to the start of the branch instruction.
+  BuildMI(MBB, MI, DL, get(M65832::BCC))
+      .addImm(-getRangeSize(Retry, MI.getIterator()));
+
+  BuildMI(MBB, MI, DL, get(M65832::PLB32));
+}
+
+void M65832InstrInfo::expandBlockMove(MachineInstr &MI) const {
+  MachineBasicBlock &MBB = *MI.getParent();
+  DebugLoc DL = MI.getDebugLoc();
+  MachineBasicBlock::iterator End = MI.getIterator();
+  unsigned DstDP = getDPOffset(MI.getOperand(0).getReg() - M65832::R0);
+  unsigned SrcDP = getDPOffset(MI.getOperand(1).getReg() - M65832::R0);
+
+  // Constant length, known non-zero: LDX src; LDY dst; LDA #len-1; MVN
+  if (MI.getOpcode() == M65832::BLKMOVE_IMM) {
+    BuildMI(MBB, MI, DL, get(M65832::LDX_DP), M65832::X).addImm(SrcDP);
+    BuildMI(MBB, MI, DL, get(M65832::LDY_DP), M65832::Y).addImm(DstDP);
+    BuildMI(MBB, MI, DL, get(M65832::LDA_IMM), M65832::A)
+        .addImm(MI.getOperand(2).getImm() - 1);
+    BuildMI(MBB, MI, DL, get(M65832::MVN));
+    return;
+  }
+
+  unsigned LenDP = getDPOffset(MI.getOperand(2).getReg() - M65832::R0);
+
+  // MVN/MVP always move A+1 bytes, so a zero length must branch around.
+  BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A).addImm(LenDP);
+  MachineInstr *SkipAll = BuildMI(MBB, MI, DL, get(M65832::BEQ)).addImm(0);
+
+  // Forward copy: LDX src; LDY dst; LDA len; DEC A; MVN
+  auto emitForward = [&]() {
+    BuildMI(MBB, MI, DL, get(M65832::LDX_DP), M65832::X).addImm(SrcDP);
+    BuildMI(MBB, MI, DL, get(M65832::LDY_DP), M65832::Y).addImm(DstDP);
+    BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A).addImm(LenDP);
+    BuildMI(MBB, MI, DL, get(M65832::DEC_A), M65832::A).addReg(M65832::A);
+    BuildMI(MBB, MI, DL, get(M65832::MVN));
+  };
+
+  if (MI.getOpcode() == M65832::BLKMOVE) {
+    emitForward();
+    SkipAll->getOperand(0).setImm(getRangeSize(SkipAll, End));
+    return;
+  }
+
+  // BLKMOVE_SAFE: copy upward when dst < src, otherwise downward from the
+  // last byte so an overlapping source is read before it is overwritten.
+  BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A).addImm(DstDP);
+  BuildMI(MBB, MI, DL, get(M65832::CMP_DP))
+      .addReg(M65832::A, RegState::Kill)
+      .addImm(SrcDP);
+  MachineInstr *ToForward = BuildMI(MBB, MI, DL, get(M65832::BCC)).addImm(0);
+
+  // X = src + len - 1; Y = dst + len - 1; A = len - 1; MVP
+  BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A).addImm(SrcDP);
+  BuildMI(MBB, MI, DL, get(M65832::CLC));
+  BuildMI(MBB, MI, DL, get(M65832::ADC_DP), M65832::A)
+      .addReg(M65832::A)
+      .addImm(LenDP);
+  BuildMI(MBB, MI, DL, get(M65832::TAX), M65832::X).addReg(M65832::A);
+  BuildMI(MBB, MI, DL, get(M65832::DEX));
+  BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A).addImm(DstDP);
+  BuildMI(MBB, MI, DL, get(M65832::CLC));
+  BuildMI(MBB, MI, DL, get(M65832::ADC_DP), M65832::A)
+      .addReg(M65832::A)
+      .addImm(LenDP);
+  BuildMI(MBB, MI, DL, get(M65832::TAY)).addReg(M65832::A);
+  BuildMI(MBB, MI, DL, get(M65832::DEY));
+  BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A).addImm(LenDP);
+  BuildMI(MBB, MI, DL, get(M65832::DEC_A), M65832::A).addReg(M65832::A);
+  BuildMI(MBB, MI, DL, get(M65832::MVP));
+  MachineInstr *SkipForward = BuildMI(MBB, MI, DL, get(M65832::BRA)).addImm(0);
+
+  emitForward();
+  MachineBasicBlock::iterator Forward = std::next(SkipForward->getIterator());
+
+  ToForward->getOperand(0).setImm(getRangeSize(ToForward, Forward));
+  SkipForward->getOperand(0).setImm(getRangeSize(SkipForward, End));
+  SkipAll->getOperand(0).setImm(getRangeSize(SkipAll, End));
+}
+
+// SETGT and SETUGT are taken only when Z is clear as well, so they first
+// branch to the not-taken successor on Z (and on N for signed): the target
+// of the BRA that follows the pseudo, or else the layout successor the
+// block falls through to. Branching to the layout successor regardless of
+// the CFG breaks blocks that end in BRA and leaves BranchFolder with
+// branches to blocks that are not successors.
+void M65832InstrInfo::emitBranchCompare(MachineInstr &MI, unsigned Opc,
+                                        const MachineOperand &Lhs,
+                                        const MachineOperand &Rhs,
+                                        int64_t CC) const {
+  MachineBasicBlock &MBB = *MI.getParent();
+  DebugLoc DL = MI.getDebugLoc();
+  Register LhsReg = Lhs.getReg();
+
+  unsigned CmpOpc;
+  switch (Opc) {
+  default: llvm_unreachable("not a compare-and-branch");
+  case M65832::BR_CC_CMP_PSEUDO:       CmpOpc = M65832::CMPR_DP;  break;
+  case M65832::BR_CC_CMP_IMM_PSEUDO:   CmpOpc = M65832::CMPR_IMM; break;
+  case M65832::BR_CC_CMP8_PSEUDO:      CmpOpc = M65832::CMPB_DP;  break;
+  case M65832::BR_CC_CMP16_PSEUDO:     CmpOpc = M65832::CMPW_DP;  break;
+  case M65832::BR_CC_CMP8_IMM_PSEUDO:  CmpOpc = M65832::CMPB_IMM; break;
+  case M65832::BR_CC_CMP16_IMM_PSEUDO: CmpOpc = M65832::CMPW_IMM; break;
+  }
+
+  // A compare against zero is redundant when the instruction that produced
+  // lhs already left its N/Z flags behind, which is the usual shape of a
+  // counted loop's back-edge. Carry-based conditions still need the CMP.
+  if (Opc == M65832::BR_CC_CMP_IMM_PSEUDO && Rhs.getImm() == 0) {
+    bool NZOnly = CC == ISD::SETEQ || CC == ISD::SETNE || CC == ISD::SETLT ||
+                  CC == ISD::SETGE || CC == ISD::SETGT || CC == ISD::SETLE;
+    if (NZOnly && flagsReflectReg(MBB, MI.getIterator(), LhsReg))
+      return;
+  }
+
+  BuildMI(MBB, MI, DL, get(CmpOpc)).addReg(LhsReg).add(Rhs);
+}
+
+void M65832InstrInfo::expandCondBranch(MachineInstr &MI, int64_t CC,
+                                       MachineBasicBlock *Target) const {
+  MachineBasicBlock &MBB = *MI.getParent();
+  DebugLoc DL = MI.getDebugLoc();
+
+  auto Branch = [&](unsigned Opc, MachineBasicBlock *Dest) {
+    BuildMI(MBB, MI, DL, get(Opc)).addMBB(Dest);
+  };
+
+  switch (CC) {
+  case ISD::SETEQ:  return Branch(M65832::BEQ, Target);
+  case ISD::SETNE:  return Branch(M65832::BNE, Target);
+  case ISD::SETLT:  return Branch(M65832::BMI, Target);
+  case ISD::SETGE:  return Branch(M65832::BPL, Target);
+  case ISD::SETULT: return Branch(M65832::BCC, Target);
+  case ISD::SETUGE: return Branch(M65832::BCS, Target);
+  case ISD::SETLE:
+    Branch(M65832::BEQ, Target);
+    return Branch(M65832::BMI, Target);
+  case ISD::SETULE:
+    Branch(M65832::BEQ, Target);
+    return Branch(M65832::BCC, Target);
+  case ISD::SETGT:
+  case ISD::SETUGT:
+    break;
+  default:
+    return Branch(M65832::BNE, Target);
+  }
+
+  MachineBasicBlock::iterator Next = next_nodbg(MI.getIterator(), MBB.end());
+  MachineInstr *FalseBRA = nullptr;
+  MachineBasicBlock *FalseMBB = nullptr;
+  if (Next == MBB.end()) {
+    MachineBasicBlock *NextMBB = MBB.getNextNode();
+    if (NextMBB && MBB.isSuccessor(NextMBB))
+      FalseMBB = NextMBB;
+  } else if (Next->getOpcode() == M65832::BRA && Next->getOperand(0).isMBB()) {
+    FalseBRA = &*Next;
+    FalseMBB = FalseBRA->getOperand(0).getMBB();
+  } else {
+    llvm_unreachable("unexpected terminator after a conditional branch");
+  }
+
+  // Without a not-taken successor only the taken path is reachable
+  if (!FalseMBB || FalseMBB == Target)
+    return Branch(M65832::BRA, Target);
+
+  Branch(M65832::BEQ, FalseMBB);
+  if (CC == ISD::SETUGT)
+    return Branch(M65832::BCS, Target);
+
+  Branch(M65832::BMI, FalseMBB);
+  // Reuse the BRA to the not-taken successor, which is otherwise dead
+  // after the branch to Target
+  if (FalseBRA)
+    FalseBRA->getOperand(0).setMBB(Target);
+  else
+    Branch(M65832::BRA, Target);
+}
+
+namespace {
+/// The in-place forms of one read-modify-write operation.
+struct RMWOpcodes {
+  unsigned Abs; // B+off
+  unsigned DPG; // %dp(sym)
+  unsigned DP;  // register slot
+  unsigned Acc; // A
+};
+} // end anonymous namespace
+
+static RMWOpcodes getRMWOpcodes(unsigned Opc) {
+  switch (Opc) {
+  case M65832::INC32_MEM:
+  case M65832::INC32_MEM_GLOBAL:
+    return {M65832::INC_ABS, M65832::INC_DPG, M65832::INC_DP, M65832::INC_A};
+  case M65832::DEC32_MEM:
+  case M65832::DEC32_MEM_GLOBAL:
+    return {M65832::DEC_ABS, M65832::DEC_DPG, M65832::DEC_DP, M65832::DEC_A};
+  case M65832::ASL32_MEM:
+  case M65832::ASL32_MEM_GLOBAL:
+    return {M65832::ASL_ABS, M65832::ASL_DPG, M65832::ASL_DP, M65832::ASL_A};
+  case M65832::LSR32_MEM:
+  case M65832::LSR32_MEM_GLOBAL:
+    return {M65832::LSR_ABS, M65832::LSR_DPG, M65832::LSR_DP, M65832::LSR_A};
+  default:
+    llvm_unreachable("not a read-modify-write pseudo");
+  }
+}
+
+void M65832InstrInfo::expandRMWMem(MachineInstr &MI) const {
+  MachineBasicBlock &MBB = *MI.getParent();
+  DebugLoc DL = MI.getDebugLoc();
+  RMWOpcodes Ops = getRMWOpcodes(MI.getOpcode());
+
+  switch (MI.getOpcode()) {
+  case M65832::INC32_MEM_GLOBAL:
+  case M65832::DEC32_MEM_GLOBAL:
+  case M65832::ASL32_MEM_GLOBAL:
+  case M65832::LSR32_MEM_GLOBAL: {
+    // The same choice of address as the _GLOBAL loads and stores
+    GlobalAccess Kind;
+    MachineOperand Addr = getGlobalAddress(MI, Kind, /*OpNo=*/0);
+    if (Kind == GlobalAccess::BankRel) {
+      BuildMI(MBB, MI, DL, get(Ops.Abs)).add(Addr);
+      return;
+    }
+    if (Kind == GlobalAccess::DirectPage) {
+      BuildMI(MBB, MI, DL, get(Ops.DPG)).add(Addr);
+      return;
+    }
+    // No 32-bit absolute RMW form: go through the reserved scratch R31
+    BuildMI(MBB, MI, DL, get(M65832::LDR_ABS32), M65832::R31).add(Addr);
+    BuildMI(MBB, MI, DL, get(Ops.DP))
+        .addImm(getDPOffset(M65832::R31 - M65832::R0));
+    BuildMI(MBB, MI, DL, get(M65832::STR_ABS32))
+        .addReg(M65832::R31)
+        .add(Addr);
+    return;
+  }
+  default:
+    break;
+  }
+
+  // base + offset: a stack slot is INC B+off; a pointer, R28 + %gprel(sym)
+  // or R56 + %tprel(sym) is LDY #off; LDA (base),Y; INC A; STA (base),Y
+  Register BaseReg = MI.getOperand(0).getReg();
+  const MachineOperand &Offset = MI.getOperand(1);
+  if (BaseReg == M65832::B) {
+    BuildMI(MBB, MI, DL, get(Ops.Abs)).add(Offset);
+    return;
+  }
+  unsigned BaseDP = getDPOffset(BaseReg - M65832::R0);
+  BuildMI(MBB, MI, DL, get(M65832::LDY_IMM), M65832::Y).add(Offset);
+  BuildMI(MBB, MI, DL, get(M65832::LDA_IND_Y), M65832::A).addImm(BaseDP);
+  BuildMI(MBB, MI, DL, get(Ops.Acc), M65832::A).addReg(M65832::A);
+  BuildMI(MBB, MI, DL, get(M65832::STA_IND_Y))
+      .addReg(M65832::A, RegState::Kill)
+      .addImm(BaseDP);
+}
+
+void M65832InstrInfo::expandALUMem(MachineInstr &MI) const {
+  MachineBasicBlock &MBB = *MI.getParent();
+  DebugLoc DL = MI.getDebugLoc();
+  unsigned Opc = MI.getOpcode();
+  Register DstReg = MI.getOperand(0).getReg();
+  Register Src1Reg = MI.getOperand(1).getReg();
+
+  unsigned AbsOpc, SROpc, DPOpc;
+  switch (Opc) {
+  default:
+    llvm_unreachable("not a GPR op memory pseudo");
+  case M65832::ADD_MEM:
+  case M65832::ADD_MEM_GLOBAL:
+    AbsOpc = M65832::ADC_ABS;
+    SROpc = M65832::ADC_SR;
+    DPOpc = M65832::ADC_DP;
+    break;
+  case M65832::SUB_MEM:
+  case M65832::SUB_MEM_GLOBAL:
+    AbsOpc = M65832::SBC_ABS;
+    SROpc = M65832::SBC_SR;
+    DPOpc = M65832::SBC_DP;
+    break;
+  case M65832::AND_MEM:
+  case M65832::AND_MEM_GLOBAL:
+    AbsOpc = M65832::AND_ABS;
+    SROpc = M65832::AND_SR;
+    DPOpc = M65832::AND_DP;
+    break;
+  case M65832::ORA_MEM:
+  case M65832::ORA_MEM_GLOBAL:
+    AbsOpc = M65832::ORA_ABS;
+    SROpc = M65832::ORA_SR;
+    DPOpc = M65832::ORA_DP;
+    break;
+  case M65832::EOR_MEM:
+  case M65832::EOR_MEM_GLOBAL:
+    AbsOpc = M65832::EOR_ABS;
+    SROpc = M65832::EOR_SR;
+    DPOpc = M65832::EOR_DP;
+    break;
+  }
+
+  // The second operand: B+off for a stack slot or a bank global in a
+  // data-bank function, $xx,S for a stack slot without a frame base,
+  // otherwise a 32-bit absolute load into R31
+  MachineOperand Addr = MI.getOperand(3);
+  unsigned MemOpc = AbsOpc;
+  bool ViaR31 = false;
+  if (Opc == M65832::ADD_MEM_GLOBAL || Opc == M65832::SUB_MEM_GLOBAL ||
+      Opc == M65832::AND_MEM_GLOBAL || Opc == M65832::ORA_MEM_GLOBAL ||
+      Opc == M65832::EOR_MEM_GLOBAL) {
+    GlobalAccess Kind;
+    Addr = getGlobalAddress(MI, Kind, /*OpNo=*/2);
+    if (Kind != GlobalAccess::BankRel) {
+      BuildMI(MBB, MI, DL, get(M65832::LDR_ABS32), M65832::R31).add(Addr);
+      ViaR31 = true;
+    }
+  } else if (MI.getOperand(2).getReg() == M65832::SP) {
+    assert(isUInt<8>(Addr.getImm()) && "stack slot out of $xx,S range");
+    MemOpc = SROpc;
+  } else {
+    assert(MI.getOperand(2).getReg() == M65832::B &&
+           "_MEM pseudos only take stack slots");
+  }
+
+  BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A)
+      .addImm(getDPOffset(Src1Reg - M65832::R0));
+  if (AbsOpc == M65832::ADC_ABS)
+    BuildMI(MBB, MI, DL, get(M65832::CLC));
+  else if (AbsOpc == M65832::SBC_ABS)
+    BuildMI(MBB, MI, DL, get(M65832::SEC));
+  if (ViaR31)
+    BuildMI(MBB, MI, DL, get(DPOpc), M65832::A)
+        .addReg(M65832::A)
+        .addImm(getDPOffset(M65832::R31 - M65832::R0));
+  else
+    BuildMI(MBB, MI, DL, get(MemOpc), M65832::A).addReg(M65832::A).add(Addr);
+  BuildMI(MBB, MI, DL, get(M65832::STA_DP))
+      .addReg(M65832::A, RegState::Kill)
+      .addImm(getDPOffset(DstReg - M65832::R0));
+}
+
+void M65832InstrInfo::expandSymbolRelAccess(MachineInstr &MI) const {
+  MachineBasicBlock &MBB = *MI.getParent();
+  DebugLoc DL = MI.getDebugLoc();
+  Register Reg = MI.getOperand(0).getReg();
+  Register Base = MI.getOperand(1).getReg();
+  unsigned BaseDP = getDPOffset(Base - M65832::R0);
+
+  BuildMI(MBB, MI, DL, get(M65832::LDY_IMM), M65832::Y).add(MI.getOperand(2));
+  switch (MI.getOpcode()) {
+  default:
+    llvm_unreachable("not a base + symbol access");
+  case M65832::LOAD32:
+    BuildMI(MBB, MI, DL, get(M65832::LDA_IND_Y), M65832::A).addImm(BaseDP);
+    BuildMI(MBB, MI, DL, get(M65832::STA_DP))
+        .addReg(M65832::A, RegState::Kill)
+        .addImm(getDPOffset(Reg - M65832::R0));
+    break;
+  case M65832::LOAD8:
+    BuildMI(MBB, MI, DL, get(M65832::LDB_IND_Y), Reg).addReg(Base);
+    break;
+  case M65832::LOAD16:
+    BuildMI(MBB, MI, DL, get(M65832::LDW_IND_Y), Reg).addReg(Base);
+    break;
+  case M65832::STORE32:
+    BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A)
+        .addImm(getDPOffset(Reg - M65832::R0));
+    BuildMI(MBB, MI, DL, get(M65832::STA_IND_Y))
+        .addReg(M65832::A, RegState::Kill)
+        .addImm(BaseDP);
+    break;
+  case M65832::STORE8:
+    BuildMI(MBB, MI, DL, get(M65832::STB_IND_Y))
+        .addReg(Reg)
+        .addReg(Base);
+    break;
+  case M65832::STORE16:
+    BuildMI(MBB, MI, DL, get(M65832::STW_IND_Y))
+        .addReg(Reg)
+        .addReg(Base);
+    break;
+  }
+}
+
 bool M65832InstrInfo::expandPostRAPseudo(MachineInstr &MI) const {
   MachineBasicBlock &MBB = *MI.getParent();
   DebugLoc DL = MI.getDebugLoc();
 
+  switch (MI.getOpcode()) {
+  case M65832::LOAD32:
+  case M65832::LOAD8:
+  case M65832::LOAD16:
+  case M65832::STORE32:
+  case M65832::STORE8:
+  case M65832::STORE16:
+    // Small data and TLS: the offset is %gprel(sym) or %tprel(sym) rather
+    // than an immediate
+    if (MI.getOperand(2).isGlobal()) {
+      expandSymbolRelAccess(MI);
+      MI.eraseFromParent();
+      return true;
+    }
+    break;
+  default:
+    break;
+  }
+
   switch (MI.getOpcode()) {
   default:
     return false;
 
-  case M65832::LI: {
-    // Load immediate: LD.L $dst,#imm
+  case M65832::ADJSP:
+    adjustStackPtr(MBB, MI, DL, MI.getOperand(0).getImm());
+    break;
+
+  case M65832::PUSH32:
+    BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A)
+        .addImm(getDPOffset(MI.getOperand(0).getReg() - M65832::R0));
+    BuildMI(MBB, MI, DL, get(M65832::PHA))
+        .addReg(M65832::A, RegState::Kill);
+    break;
+
+  case M65832::DYNALLOC:
+  case M65832::DYNALLOC_IMM: {
+    // TSX; TXA; SEC; SBC size; AND #mask; TAX; TXS; STA dst. SP starts
+    // word-aligned, so a word multiple needs no AND at the stack alignment.
     Register DstReg = MI.getOperand(0).getReg();
-    int64_t Imm = MI.getOperand(1).getImm();
-    BuildMI(MBB, MI, DL, get(M65832::LDR_IMM), DstReg).addImm(Imm);
+    const MachineOperand &Size = MI.getOperand(1);
+    int64_t Mask = MI.getOperand(2).getImm();
+    BuildMI(MBB, MI, DL, get(M65832::TSX), M65832::X);
+    BuildMI(MBB, MI, DL, get(M65832::TXA), M65832::A)
+        .addReg(M65832::X, RegState::Kill);
+    BuildMI(MBB, MI, DL, get(M65832::SEC));
+    if (Size.isImm())
+      BuildMI(MBB, MI, DL, get(M65832::SBC_IMM), M65832::A)
+          .addReg(M65832::A)
+          .addImm(Size.getImm());
+    else
+      BuildMI(MBB, MI, DL, get(M65832::SBC_DP), M65832::A)
+          .addReg(M65832::A)
+          .addImm(getDPOffset(Size.getReg() - M65832::R0));
+    if (!Size.isImm() || Mask != -4 || (Size.getImm() & 3) != 0)
+      BuildMI(MBB, MI, DL, get(M65832::AND_IMM), M65832::A)
+          .addReg(M65832::A)
+          .addImm(Mask);
+    BuildMI(MBB, MI, DL, get(M65832::TAX), M65832::X).addReg(M65832::A);
+    BuildMI(MBB, MI, DL, get(M65832::TXS)).addReg(M65832::X, RegState::Kill);
+    BuildMI(MBB, MI, DL, get(M65832::STA_DP))
+        .addReg(M65832::A, RegState::Kill)
+        .addImm(getDPOffset(DstReg - M65832::R0));
+    break;
+  }
+
+  case M65832::BLKMOVE_IMM:
+  case M65832::BLKMOVE:
+  case M65832::BLKMOVE_SAFE:
+    expandBlockMove(MI);
+    break;
+
+  case M65832::INC32_MEM:
+  case M65832::DEC32_MEM:
+  case M65832::ASL32_MEM:
+  case M65832::LSR32_MEM:
+  case M65832::INC32_MEM_GLOBAL:
+  case M65832::DEC32_MEM_GLOBAL:
+  case M65832::ASL32_MEM_GLOBAL:
+  case M65832::LSR32_MEM_GLOBAL:
+    expandRMWMem(MI);
+    break;
+
+  case M65832::ADD_MEM:
+  case M65832::SUB_MEM:
+  case M65832::AND_MEM:
+  case M65832::ORA_MEM:
+  case M65832::EOR_MEM:
+  case M65832::ADD_MEM_GLOBAL:
+  case M65832::SUB_MEM_GLOBAL:
+  case M65832::AND_MEM_GLOBAL:
+  case M65832::ORA_MEM_GLOBAL:
+  case M65832::EOR_MEM_GLOBAL:
+    expandALUMem(MI);
+    break;
+
+  case M65832::ATOMIC_SWAP32:
+  case M65832::ATOMIC_LOAD_ADD32:
+  case M65832::ATOMIC_LOAD_SUB32:
+  case M65832::ATOMIC_LOAD_AND32:
+  case M65832::ATOMIC_LOAD_OR32:
+  case M65832::ATOMIC_LOAD_XOR32:
+  case M65832::ATOMIC_LOAD_NAND32:
+    expandAtomicRMW(MI);
+    break;
+
+  case M65832::CAS: {
+    // PHB32; SB addr; LDX expected; LDA desired; CAS $0000; STX dst; PLB32
+    // On failure CAS loads the current value into X, so X holds the old
+    // value either way.
+    unsigned DstDP = getDPOffset(MI.getOperand(0).getReg() - M65832::R0);
+    unsigned AddrDP = getDPOffset(MI.getOperand(1).getReg() - M65832::R0);
+    unsigned ExpDP = getDPOffset(MI.getOperand(2).getReg() - M65832::R0);
+    unsigned NewDP = getDPOffset(MI.getOperand(3).getReg() - M65832::R0);
+
+    // Without the hardware CAS, compare and store with interrupts masked:
+    //   PHP; SEI; LDA (addr); TAX; CMP expected; BNE *+n; LDA desired;
+    //   STA (addr); STX dst; PLP
+    // The old value is written last so dst may share a register with any
+    // input.
+    if (!MBB.getParent()->getSubtarget<M65832Subtarget>().hasAtomics()) {
+      BuildMI(MBB, MI, DL, get(M65832::PHP));
+      BuildMI(MBB, MI, DL, get(M65832::SEI));
+      BuildMI(MBB, MI, DL, get(M65832::LDA_IND), M65832::A).addImm(AddrDP);
+      BuildMI(MBB, MI, DL, get(M65832::TAX), M65832::X).addReg(M65832::A);
+      BuildMI(MBB, MI, DL, get(M65832::CMP_DP))
+          .addReg(M65832::A, RegState::Kill)
+          .addImm(ExpDP);
+      MachineInstr *Skip = BuildMI(MBB, MI, DL, get(M65832::BNE)).addImm(0);
+      BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A).addImm(NewDP);
+      BuildMI(MBB, MI, DL, get(M65832::STA_IND))
+          .addReg(M65832::A, RegState::Kill)
+          .addImm(AddrDP);
+      Skip->getOperand(0).setImm(getRangeSize(Skip, MI));
+      BuildMI(MBB, MI, DL, get(M65832::STX_DP))
+          .addReg(M65832::X, RegState::Kill)
+          .addImm(DstDP);
+      BuildMI(MBB, MI, DL, get(M65832::PLP));
+      break;
+    }
+
+    BuildMI(MBB, MI, DL, get(M65832::PHB32));
+    BuildMI(MBB, MI, DL, get(M65832::SB_DP)).addImm(AddrDP);
+    BuildMI(MBB, MI, DL, get(M65832::LDX_DP), M65832::X).addImm(ExpDP);
+    BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A).addImm(NewDP);
+    BuildMI(MBB, MI, DL, get(M65832::CAS_ABS)).addImm(0);
+    BuildMI(MBB, MI, DL, get(M65832::STX_DP))
+        .addReg(M65832::X, RegState::Kill)
+        .addImm(DstDP);
+    BuildMI(MBB, MI, DL, get(M65832::PLB32));
     break;
   }
 
+  case M65832::LI:
+    loadImmediate(MBB, MI, DL, MI.getOperand(0).getReg(),
+                  static_cast<uint32_t>(MI.getOperand(1).getImm()));
+    break;
+
   case M65832::LA:
   case M65832::LA_EXT:
   case M65832::LA_BA:
-  case M65832::LA_CP: {
+  case M65832::LA_CP:
+  case M65832::LA_JT: {
     // Load address: LD.L $dst,#addr
     // LA_CP is for constant pool entries (floating point constants, etc.)
     Register DstReg = MI.getOperand(0).getReg();
@@ -432,6 +2246,21 @@ bool M65832InstrInfo::expandPostRAPseudo(MachineInstr &MI) const {
     break;
   }
 
+  case M65832::LA_TPREL: {
+    // Thread-local address: LDA R56; CLC; ADC #%tprel(sym); STA dst
+    Register DstReg = MI.getOperand(0).getReg();
+    BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A)
+        .addImm(getDPOffset(M65832::R56 - M65832::R0));
+    BuildMI(MBB, MI, DL, get(M65832::CLC));
+    BuildMI(MBB, MI, DL, get(M65832::ADC_IMM), M65832::A)
+        .addReg(M65832::A)
+        .add(MI.getOperand(1));
+    BuildMI(MBB, MI, DL, get(M65832::STA_DP))
+        .addReg(M65832::A, RegState::Kill)
+        .addImm(getDPOffset(DstReg - M65832::R0));
+    break;
+  }
+
   case M65832::LEA_FI: {
     // Load effective address from frame index
     // After eliminateFrameIndex, operands are: dst, FrameReg, Offset
@@ -458,18 +2287,7 @@ bool M65832InstrInfo::expandPostRAPseudo(MachineInstr &MI) const {
           .addReg(M65832::A, RegState::Kill)
           .addImm(DstDP);
     } else if (FrameReg == M65832::B) {
-      // For B-relative: Use TBA to transfer B to A directly
-      // TBA; CLC; ADC #offset; STA dst
-      BuildMI(MBB, MI, DL, get(M65832::TBA), M65832::A);
-      if (Offset != 0) {
-        BuildMI(MBB, MI, DL, get(M65832::CLC));
-        BuildMI(MBB, MI, DL, get(M65832::ADC_IMM), M65832::A)
-            .addReg(M65832::A)
-            .addImm(Offset);
-      }
-      BuildMI(MBB, MI, DL, get(M65832::STA_DP))
-          .addReg(M65832::A, RegState::Kill)
-          .addImm(DstDP);
+      expandFrameAddrFromB(MI, DstReg, Offset);
     } else {
       // LDA FrameReg; CLC; ADC #offset; STA dst
       unsigned FrameDP = getDPOffset(29);  // R29 = FP
@@ -702,6 +2520,10 @@ bool M65832InstrInfo::expandPostRAPseudo(MachineInstr &MI) const {
       // Use B+offset addressing
       BuildMI(MBB, MI, DL, get(M65832::LDA_ABS), M65832::A)
           .addImm(Offset);
+    } else if (BaseReg == M65832::SP && isUInt<8>(Offset)) {
+      // Stack slot in a function without a frame base, or an outgoing
+      // argument: LDA $xx,S
+      BuildMI(MBB, MI, DL, get(M65832::LDA_SR), M65832::A).addImm(Offset);
     } else if (BaseReg == M65832::R29 || BaseReg == M65832::SP) {
       // Load base pointer into a temp register and use indirect addressing
       unsigned BaseDP = getDPOffset(29); // R29 = FP
@@ -741,15 +2563,24 @@ bool M65832InstrInfo::expandPostRAPseudo(MachineInstr &MI) const {
   }
 
   case M65832::LOAD32_GLOBAL: {
-    // Load from global address: LDA global; STA dst
+    // Load from global address: LDA B+%bankrel(global) or LDA %dp(global),
+    // then STA dst; LD.L dst,global otherwise
     Register DstReg = MI.getOperand(0).getReg();
-    unsigned DstDP = getDPOffset(DstReg - M65832::R0);
+    GlobalAccess Kind;
+    MachineOperand Addr = getGlobalAddress(MI, Kind);
 
-    BuildMI(MBB, MI, DL, get(M65832::LDA_ABS), M65832::A)
-        .add(MI.getOperand(1)); // Copy the global address operand
+    if (Kind == GlobalAccess::Abs32) {
+      BuildMI(MBB, MI, DL, get(M65832::LDR_ABS32), DstReg).add(Addr);
+      break;
+    }
+    BuildMI(MBB, MI, DL,
+            get(Kind == GlobalAccess::BankRel ? M65832::LDA_ABS
+                                              : M65832::LDA_DPG),
+            M65832::A)
+        .add(Addr);
     BuildMI(MBB, MI, DL, get(M65832::STA_DP))
         .addReg(M65832::A, RegState::Kill)
-        .addImm(DstDP);
+        .addImm(getDPOffset(DstReg - M65832::R0));
     break;
   }
 
@@ -769,6 +2600,10 @@ bool M65832InstrInfo::expandPostRAPseudo(MachineInstr &MI) const {
       BuildMI(MBB, MI, DL, get(M65832::STA_ABS))
           .addReg(M65832::A, RegState::Kill)
           .addImm(Offset);
+    } else if (BaseReg == M65832::SP && isUInt<8>(Offset)) {
+      BuildMI(MBB, MI, DL, get(M65832::STA_SR))
+          .addReg(M65832::A, RegState::Kill)
+          .addImm(Offset);
     } else if (BaseReg == M65832::R29 || BaseReg == M65832::SP) {
       unsigned BaseDP = getDPOffset(29);
       if (BaseReg == M65832::SP) {
@@ -808,14 +2643,23 @@ bool M65832InstrInfo::expandPostRAPseudo(MachineInstr &MI) const {
   }
 
   case M65832::STORE32_GLOBAL: {
-    // Store to global address: LDA src; STA global
+    // Store to global address: LDA src, then STA B+%bankrel(global) or
+    // STA %dp(global); ST.L global,src otherwise
     Register SrcReg = MI.getOperand(0).getReg();
-    unsigned SrcDP = getDPOffset(SrcReg - M65832::R0);
+    GlobalAccess Kind;
+    MachineOperand Addr = getGlobalAddress(MI, Kind);
 
-    BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A).addImm(SrcDP);
-    BuildMI(MBB, MI, DL, get(M65832::STA_ABS))
+    if (Kind == GlobalAccess::Abs32) {
+      BuildMI(MBB, MI, DL, get(M65832::STR_ABS32)).addReg(SrcReg).add(Addr);
+      break;
+    }
+    BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A)
+        .addImm(getDPOffset(SrcReg - M65832::R0));
+    BuildMI(MBB, MI, DL,
+            get(Kind == GlobalAccess::BankRel ? M65832::STA_ABS
+                                              : M65832::STA_DPG))
         .addReg(M65832::A, RegState::Kill)
-        .add(MI.getOperand(1)); // Copy the global address operand
+        .add(Addr);
     break;
   }
 
@@ -827,8 +2671,13 @@ bool M65832InstrInfo::expandPostRAPseudo(MachineInstr &MI) const {
 
     if (MI.getOpcode() == M65832::LOAD8_GLOBAL) {
       // Load byte from global address using Extended ALU LD.B
-      BuildMI(MBB, MI, DL, get(M65832::LDB_ABS), DstReg)
-          .add(MI.getOperand(1));
+      GlobalAccess Kind;
+      MachineOperand Addr = getGlobalAddress(MI, Kind);
+      BuildMI(MBB, MI, DL,
+              get(getGlobalAccessOpcode(Kind, M65832::LDB_ABS32,
+                                        M65832::LDB_ABS, M65832::LDB_DPG)),
+              DstReg)
+          .add(Addr);
     } else {
       Register BaseReg = MI.getOperand(1).getReg();
       int64_t Offset = MI.getNumOperands() > 2 ? MI.getOperand(2).getImm() : 0;
@@ -874,8 +2723,13 @@ bool M65832InstrInfo::expandPostRAPseudo(MachineInstr &MI) const {
 
     if (MI.getOpcode() == M65832::LOAD16_GLOBAL) {
       // Load word from global address using Extended ALU LD.W
-      BuildMI(MBB, MI, DL, get(M65832::LDW_ABS), DstReg)
-          .add(MI.getOperand(1));
+      GlobalAccess Kind;
+      MachineOperand Addr = getGlobalAddress(MI, Kind);
+      BuildMI(MBB, MI, DL,
+              get(getGlobalAccessOpcode(Kind, M65832::LDW_ABS32,
+                                        M65832::LDW_ABS, M65832::LDW_DPG)),
+              DstReg)
+          .add(Addr);
     } else {
       Register BaseReg = MI.getOperand(1).getReg();
       int64_t Offset = MI.getNumOperands() > 2 ? MI.getOperand(2).getImm() : 0;
@@ -920,9 +2774,13 @@ bool M65832InstrInfo::expandPostRAPseudo(MachineInstr &MI) const {
 
     if (MI.getOpcode() == M65832::STORE8_GLOBAL) {
       // Store byte to global address using Extended ALU ST.B
-      BuildMI(MBB, MI, DL, get(M65832::STB_ABS))
+      GlobalAccess Kind;
+      MachineOperand Addr = getGlobalAddress(MI, Kind);
+      BuildMI(MBB, MI, DL,
+              get(getGlobalAccessOpcode(Kind, M65832::STB_ABS32,
+                                        M65832::STB_ABS, M65832::STB_DPG)))
           .addReg(SrcReg)
-          .add(MI.getOperand(1));
+          .add(Addr);
     } else {
       Register BaseReg = MI.getOperand(1).getReg();
       int64_t Offset = MI.getNumOperands() > 2 ? MI.getOperand(2).getImm() : 0;
@@ -970,9 +2828,13 @@ bool M65832InstrInfo::expandPostRAPseudo(MachineInstr &MI) const {
 
     if (MI.getOpcode() == M65832::STORE16_GLOBAL) {
       // Store word to global address using Extended ALU ST.W
-      BuildMI(MBB, MI, DL, get(M65832::STW_ABS))
+      GlobalAccess Kind;
+      MachineOperand Addr = getGlobalAddress(MI, Kind);
+      BuildMI(MBB, MI, DL,
+              get(getGlobalAccessOpcode(Kind, M65832::STW_ABS32,
+                                        M65832::STW_ABS, M65832::STW_DPG)))
           .addReg(SrcReg)
-          .add(MI.getOperand(1));
+          .add(Addr);
     } else {
       Register BaseReg = MI.getOperand(1).getReg();
       int64_t Offset = MI.getNumOperands() > 2 ? MI.getOperand(2).getImm() : 0;
@@ -1012,6 +2874,66 @@ bool M65832InstrInfo::expandPostRAPseudo(MachineInstr &MI) const {
     break;
   }
 
+  case M65832::LOAD32_RR:
+  case M65832::LOAD8_RR:
+  case M65832::LOAD16_RR: {
+    // Load from base + index: LDY index; LDA (base),Y / LD.B / LD.W
+    Register DstReg = MI.getOperand(0).getReg();
+    Register BaseReg = MI.getOperand(1).getReg();
+    Register IndexReg = MI.getOperand(2).getReg();
+
+    BuildMI(MBB, MI, DL, get(M65832::LDY_DP), M65832::Y)
+        .addImm(getDPOffset(IndexReg - M65832::R0));
+    if (MI.getOpcode() == M65832::LOAD32_RR) {
+      BuildMI(MBB, MI, DL, get(M65832::LDA_IND_Y), M65832::A)
+          .addImm(getDPOffset(BaseReg - M65832::R0));
+      BuildMI(MBB, MI, DL, get(M65832::STA_DP))
+          .addReg(M65832::A, RegState::Kill)
+          .addImm(getDPOffset(DstReg - M65832::R0));
+    } else {
+      unsigned Opc = MI.getOpcode() == M65832::LOAD8_RR ? M65832::LDB_IND_Y
+                                                        : M65832::LDW_IND_Y;
+      BuildMI(MBB, MI, DL, get(Opc), DstReg).addReg(BaseReg);
+    }
+    break;
+  }
+
+  case M65832::LOAD32_GLOBAL_RR: {
+    // Load from table + index: LDY index; LD.L dst,sym,Y
+    Register DstReg = MI.getOperand(0).getReg();
+    Register IndexReg = MI.getOperand(2).getReg();
+
+    BuildMI(MBB, MI, DL, get(M65832::LDY_DP), M65832::Y)
+        .addImm(getDPOffset(IndexReg - M65832::R0));
+    BuildMI(MBB, MI, DL, get(M65832::LDR_ABS32_Y), DstReg)
+        .add(MI.getOperand(1));
+    break;
+  }
+
+  case M65832::STORE32_RR:
+  case M65832::STORE8_RR:
+  case M65832::STORE16_RR: {
+    // Store to base + index: LDY index; STA (base),Y / ST.B / ST.W
+    Register SrcReg = MI.getOperand(0).getReg();
+    Register BaseReg = MI.getOperand(1).getReg();
+    Register IndexReg = MI.getOperand(2).getReg();
+
+    BuildMI(MBB, MI, DL, get(M65832::LDY_DP), M65832::Y)
+        .addImm(getDPOffset(IndexReg - M65832::R0));
+    if (MI.getOpcode() == M65832::STORE32_RR) {
+      BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A)
+          .addImm(getDPOffset(SrcReg - M65832::R0));
+      BuildMI(MBB, MI, DL, get(M65832::STA_IND_Y))
+          .addReg(M65832::A, RegState::Kill)
+          .addImm(getDPOffset(BaseReg - M65832::R0));
+    } else {
+      unsigned Opc = MI.getOpcode() == M65832::STORE8_RR ? M65832::STB_IND_Y
+                                                         : M65832::STW_IND_Y;
+      BuildMI(MBB, MI, DL, get(Opc)).addReg(SrcReg).addReg(BaseReg);
+    }
+    break;
+  }
+
   case M65832::JSR_IND: {
     // Indirect call through register (function pointer)
     // Load the target address into A, then use JSR (dp) where dp holds the address
@@ -1020,14 +2942,70 @@ bool M65832InstrInfo::expandPostRAPseudo(MachineInstr &MI) const {
     
     // JSR indirect uses JSR (dp) - opcode $FC dp
     // The dp location contains the 32-bit target address
+    // Carry over the register mask and argument uses; the clobbers are
+    // not in JSR_DP_IND's implicit defs
     BuildMI(MBB, MI, DL, get(M65832::JSR_DP_IND))
-        .addImm(TargetDP);
+        .addImm(TargetDP)
+        .copyImplicitOps(MI);
+    break;
+  }
+
+  case M65832::JMP_IND: {
+    // Indirect jump through register: JMP (dp)
+    Register TargetReg = MI.getOperand(0).getReg();
+    BuildMI(MBB, MI, DL, get(M65832::JMP_DP_IND))
+        .addImm(getDPOffset(TargetReg - M65832::R0));
+    break;
+  }
+
+  case M65832::TAILCALL: {
+    // LD.L R31,#target; JMP (R31). The epilogue has already run, so SP is
+    // back at our return address and the callee's RTS uses it. With
+    // -mrelax the linker turns the pair into a BRA when the target is in
+    // reach.
+    MachineOperand Target = MI.getOperand(0);
+    if (MBB.getParent()->getSubtarget<M65832Subtarget>().enableLinkerRelax())
+      Target.setTargetFlags(M65832II::MO_JMPABS);
+    BuildMI(MBB, MI, DL, get(M65832::LDR_IMM), M65832::R31).add(Target);
+    BuildMI(MBB, MI, DL, get(M65832::JMP_DP_IND))
+        .addImm(getDPOffset(M65832::R31 - M65832::R0));
+    break;
+  }
+
+  case M65832::TAILCALL_IND: {
+    Register TargetReg = MI.getOperand(0).getReg();
+    BuildMI(MBB, MI, DL, get(M65832::JMP_DP_IND))
+        .addImm(getDPOffset(TargetReg - M65832::R0));
     break;
   }
 
   // FPU Load/Store pseudo expansions
   // FPU supports: LDF Fn, dp | LDF Fn, abs | LDF Fn, (Rm)
   
+  case M65832::LDF32_CP:
+  case M65832::LDF64_CP: {
+    // FP constant. With B at the literal pool (see emitPrologue) this is
+    // LDF Fn,B+(.LCPI<n>_k - .LCPI<n>_0); like LDF*_GLOBAL it loads 64 bits
+    // for f32 too. Otherwise LD.L R0,#.LCPI<n>_k; LDF[.S] Fn,(R0), and the
+    // pseudo's R0 def covers the scratch.
+    Register DstReg = MI.getOperand(0).getReg();
+    const auto *FuncInfo =
+        MBB.getParent()->getInfo<M65832MachineFunctionInfo>();
+    if (FuncInfo->usesLiteralPool()) {
+      MachineOperand Addr = MI.getOperand(1);
+      Addr.setTargetFlags(M65832II::MO_POOLREL);
+      BuildMI(MBB, MI, DL, get(M65832::LDF_abs), DstReg).add(Addr);
+      break;
+    }
+    bool IsSingle = (MI.getOpcode() == M65832::LDF32_CP);
+    BuildMI(MBB, MI, DL, get(M65832::LDR_IMM), M65832::R0)
+        .add(MI.getOperand(1));
+    BuildMI(MBB, MI, DL,
+            get(IsSingle ? M65832::LDF_S_ind : M65832::LDF_ind), DstReg)
+        .addReg(M65832::R0, RegState::Kill);
+    break;
+  }
+
   case M65832::LDF32_GLOBAL:
   case M65832::LDF64_GLOBAL: {
     // Load float from global address into FPU register
@@ -1257,6 +3235,76 @@ bool M65832InstrInfo::expandPostRAPseudo(MachineInstr &MI) const {
     break;
   }
 
+  // FP integer constant: LDA #n; I2F Fd
+  case M65832::FLI_S:
+  case M65832::FLI_D: {
+    Register DstFPR = MI.getOperand(0).getReg();
+    int64_t Imm = MI.getOperand(1).getImm();
+
+    BuildMI(MBB, MI, DL, get(M65832::LDA_IMM), M65832::A).addImm(Imm);
+    BuildMI(MBB, MI, DL,
+            get(MI.getOpcode() == M65832::FLI_S ? M65832::I2F_S_real
+                                                : M65832::I2F_D_real),
+            DstFPR);
+    break;
+  }
+
+  // GPR <-> FPR bit-pattern moves through A (low word) and T (high word)
+  case M65832::FMV_X_S: {
+    // FTOA Fs; STA dst
+    Register DstReg = MI.getOperand(0).getReg();
+    Register SrcFPR = MI.getOperand(1).getReg();
+    BuildMI(MBB, MI, DL, get(M65832::FTOA)).addReg(SrcFPR);
+    BuildMI(MBB, MI, DL, get(M65832::STA_DP))
+        .addReg(M65832::A, RegState::Kill)
+        .addImm(getDPOffset(DstReg - M65832::R0));
+    break;
+  }
+
+  case M65832::FMV_S_X: {
+    // LDA src; ATOF Fd (the high word of an f32 register is don't-care)
+    Register DstFPR = MI.getOperand(0).getReg();
+    Register SrcReg = MI.getOperand(1).getReg();
+    BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A)
+        .addImm(getDPOffset(SrcReg - M65832::R0));
+    BuildMI(MBB, MI, DL, get(M65832::ATOF), DstFPR)
+        .addReg(DstFPR, RegState::Undef);
+    break;
+  }
+
+  case M65832::SPLIT_F64_PSEUDO: {
+    // FTOA Fs; STA lo; FTOT Fs; TTA; STA hi
+    Register LoReg = MI.getOperand(0).getReg();
+    Register HiReg = MI.getOperand(1).getReg();
+    Register SrcFPR = MI.getOperand(2).getReg();
+    BuildMI(MBB, MI, DL, get(M65832::FTOA)).addReg(SrcFPR);
+    BuildMI(MBB, MI, DL, get(M65832::STA_DP))
+        .addReg(M65832::A, RegState::Kill)
+        .addImm(getDPOffset(LoReg - M65832::R0));
+    BuildMI(MBB, MI, DL, get(M65832::FTOT)).addReg(SrcFPR);
+    BuildMI(MBB, MI, DL, get(M65832::TTA), M65832::A);
+    BuildMI(MBB, MI, DL, get(M65832::STA_DP))
+        .addReg(M65832::A, RegState::Kill)
+        .addImm(getDPOffset(HiReg - M65832::R0));
+    break;
+  }
+
+  case M65832::BUILD_F64_PSEUDO: {
+    // LDA hi; TAT; LDA lo; ATOF Fd; TTOF Fd
+    Register DstFPR = MI.getOperand(0).getReg();
+    Register LoReg = MI.getOperand(1).getReg();
+    Register HiReg = MI.getOperand(2).getReg();
+    BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A)
+        .addImm(getDPOffset(HiReg - M65832::R0));
+    BuildMI(MBB, MI, DL, get(M65832::TAT)).addReg(M65832::A, RegState::Kill);
+    BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A)
+        .addImm(getDPOffset(LoReg - M65832::R0));
+    BuildMI(MBB, MI, DL, get(M65832::ATOF), DstFPR)
+        .addReg(DstFPR, RegState::Undef);
+    BuildMI(MBB, MI, DL, get(M65832::TTOF), DstFPR).addReg(DstFPR);
+    break;
+  }
+
   case M65832::SHL_GPR: {
     // Shift left: LDA src; repeat amt times: ASL A; STA dst
     Register DstReg = MI.getOperand(0).getReg();
@@ -1389,214 +3437,52 @@ bool M65832InstrInfo::expandPostRAPseudo(MachineInstr &MI) const {
   }
 
   case M65832::CMP_GPR_IMM: {
-    // Compare GPR with immediate: CMP.L lhs, #imm
-    Register LhsReg = MI.getOperand(0).getReg();
-    int64_t Imm = MI.getOperand(1).getImm();
-    BuildMI(MBB, MI, DL, get(M65832::CMPR_IMM))
-        .addReg(LhsReg)
-        .addImm(Imm);
-    break;
-  }
-
-  case M65832::BR_CC_CMP_PSEUDO: {
-    // Fused compare-and-branch: CMP lhs, rhs; Bcc target
-    Register LhsReg = MI.getOperand(0).getReg();
-    Register RhsReg = MI.getOperand(1).getReg();
-    int64_t CC = MI.getOperand(2).getImm();
-    MachineBasicBlock *Target = MI.getOperand(3).getMBB();
-    MachineBasicBlock *NextMBB = MBB.getNextNode();
-
-    BuildMI(MBB, MI, DL, get(M65832::CMPR_DP))
-        .addReg(LhsReg)
-        .addReg(RhsReg);
-
-    unsigned BrOpc;
-    bool Emitted = false;
-    switch (CC) {
-    case ISD::SETEQ:  BrOpc = M65832::BEQ; break;
-    case ISD::SETNE:  BrOpc = M65832::BNE; break;
-    case ISD::SETLT:  BrOpc = M65832::BMI; break;
-    case ISD::SETGE:  BrOpc = M65832::BPL; break;
-    case ISD::SETGT:
-      if (NextMBB) {
-        BuildMI(MBB, MI, DL, get(M65832::BEQ)).addMBB(NextMBB);
-        BuildMI(MBB, MI, DL, get(M65832::BMI)).addMBB(NextMBB);
-        BuildMI(MBB, MI, DL, get(M65832::BRA)).addMBB(Target);
-        Emitted = true;
-        break;
-      }
-      BrOpc = M65832::BPL;
-      break;
-    case ISD::SETLE:
-      if (NextMBB) {
-        BuildMI(MBB, MI, DL, get(M65832::BEQ)).addMBB(Target);
-        BuildMI(MBB, MI, DL, get(M65832::BMI)).addMBB(Target);
-        Emitted = true;
-        break;
-      }
-      BrOpc = M65832::BMI;
-      break;
-    case ISD::SETULT: BrOpc = M65832::BCC; break;
-    case ISD::SETUGE: BrOpc = M65832::BCS; break;
-    case ISD::SETUGT:
-      if (NextMBB) {
-        BuildMI(MBB, MI, DL, get(M65832::BEQ)).addMBB(NextMBB);
-        BuildMI(MBB, MI, DL, get(M65832::BCS)).addMBB(Target);
-        Emitted = true;
-        break;
-      }
-      BrOpc = M65832::BCS;
-      break;
-    case ISD::SETULE:
-      if (NextMBB) {
-        BuildMI(MBB, MI, DL, get(M65832::BEQ)).addMBB(Target);
-        BuildMI(MBB, MI, DL, get(M65832::BCC)).addMBB(Target);
-        Emitted = true;
-        break;
-      }
-      BrOpc = M65832::BCC;
-      break;
-    default:
-      BrOpc = M65832::BNE;
-      break;
-    }
-
-    if (!Emitted) {
-      BuildMI(MBB, MI, DL, get(BrOpc)).addMBB(Target);
-    }
-    break;
-  }
-
-  case M65832::BR_CC_CMP_IMM_PSEUDO: {
-    // Fused compare-and-branch with immediate: CMP lhs, #imm; Bcc target
-    Register LhsReg = MI.getOperand(0).getReg();
-    int64_t Imm = MI.getOperand(1).getImm();
-    int64_t CC = MI.getOperand(2).getImm();
-    MachineBasicBlock *Target = MI.getOperand(3).getMBB();
-    MachineBasicBlock *NextMBB = MBB.getNextNode();
-
-    BuildMI(MBB, MI, DL, get(M65832::CMPR_IMM))
-        .addReg(LhsReg)
-        .addImm(Imm);
-
-    unsigned BrOpc;
-    bool Emitted = false;
-    switch (CC) {
-    case ISD::SETEQ:  BrOpc = M65832::BEQ; break;
-    case ISD::SETNE:  BrOpc = M65832::BNE; break;
-    case ISD::SETLT:  BrOpc = M65832::BMI; break;
-    case ISD::SETGE:  BrOpc = M65832::BPL; break;
-    case ISD::SETGT:
-      if (NextMBB) {
-        BuildMI(MBB, MI, DL, get(M65832::BEQ)).addMBB(NextMBB);
-        BuildMI(MBB, MI, DL, get(M65832::BMI)).addMBB(NextMBB);
-        BuildMI(MBB, MI, DL, get(M65832::BRA)).addMBB(Target);
-        Emitted = true;
-        break;
-      }
-      BrOpc = M65832::BPL;
-      break;
-    case ISD::SETLE:
-      if (NextMBB) {
-        BuildMI(MBB, MI, DL, get(M65832::BEQ)).addMBB(Target);
-        BuildMI(MBB, MI, DL, get(M65832::BMI)).addMBB(Target);
-        Emitted = true;
-        break;
-      }
-      BrOpc = M65832::BMI;
-      break;
-    case ISD::SETULT: BrOpc = M65832::BCC; break;
-    case ISD::SETUGE: BrOpc = M65832::BCS; break;
-    case ISD::SETUGT:
-      if (NextMBB) {
-        BuildMI(MBB, MI, DL, get(M65832::BEQ)).addMBB(NextMBB);
-        BuildMI(MBB, MI, DL, get(M65832::BCS)).addMBB(Target);
-        Emitted = true;
-        break;
-      }
-      BrOpc = M65832::BCS;
-      break;
-    case ISD::SETULE:
-      if (NextMBB) {
-        BuildMI(MBB, MI, DL, get(M65832::BEQ)).addMBB(Target);
-        BuildMI(MBB, MI, DL, get(M65832::BCC)).addMBB(Target);
-        Emitted = true;
-        break;
-      }
-      BrOpc = M65832::BCC;
-      break;
-    default:
-      BrOpc = M65832::BNE;
-      break;
-    }
-
-    if (!Emitted) {
-      BuildMI(MBB, MI, DL, get(BrOpc)).addMBB(Target);
-    }
-    break;
-  }
-
-  case M65832::BR_CC_PSEUDO: {
-    // Conditional branch based on condition code
-    // The compare has already been done (via CMPR_DP), flags are set
-    int64_t CC = MI.getOperand(0).getImm();
-    MachineBasicBlock *Target = MI.getOperand(1).getMBB();
-    MachineBasicBlock *NextMBB = MBB.getNextNode();
-    
-    unsigned BrOpc;
-    bool Emitted = false;
-    switch (CC) {
-    case ISD::SETEQ:  BrOpc = M65832::BEQ; break;
-    case ISD::SETNE:  BrOpc = M65832::BNE; break;
-    case ISD::SETLT:  BrOpc = M65832::BMI; break;  // Signed less than
-    case ISD::SETGE:  BrOpc = M65832::BPL; break;  // Signed greater or equal
-    case ISD::SETGT:  // Signed greater than - need BNE + BPL combo
-      if (NextMBB) {
-        BuildMI(MBB, MI, DL, get(M65832::BEQ)).addMBB(NextMBB);
-        BuildMI(MBB, MI, DL, get(M65832::BMI)).addMBB(NextMBB);
-        BuildMI(MBB, MI, DL, get(M65832::BRA)).addMBB(Target);
-        Emitted = true;
-        break;
-      }
-      BrOpc = M65832::BPL;
-      break;
-    case ISD::SETLE:
-      if (NextMBB) {
-        BuildMI(MBB, MI, DL, get(M65832::BEQ)).addMBB(Target);
-        BuildMI(MBB, MI, DL, get(M65832::BMI)).addMBB(Target);
-        Emitted = true;
-        break;
-      }
-      BrOpc = M65832::BMI;
-      break;
-    case ISD::SETULT: BrOpc = M65832::BCC; break;  // Unsigned less than
-    case ISD::SETUGE: BrOpc = M65832::BCS; break;  // Unsigned greater or equal
-    case ISD::SETUGT:
-      if (NextMBB) {
-        BuildMI(MBB, MI, DL, get(M65832::BEQ)).addMBB(NextMBB);
-        BuildMI(MBB, MI, DL, get(M65832::BCS)).addMBB(Target);
-        Emitted = true;
-        break;
-      }
-      BrOpc = M65832::BCS;
-      break;
-    case ISD::SETULE:
-      if (NextMBB) {
-        BuildMI(MBB, MI, DL, get(M65832::BEQ)).addMBB(Target);
-        BuildMI(MBB, MI, DL, get(M65832::BCC)).addMBB(Target);
-        Emitted = true;
-        break;
-      }
-      BrOpc = M65832::BCC;
-      break;
-    default:
-      BrOpc = M65832::BNE;
-      break;
-    }
-    
-    if (!Emitted) {
-      BuildMI(MBB, MI, DL, get(BrOpc)).addMBB(Target);
-    }
+    // Compare GPR with immediate: CMP.L lhs, #imm
+    Register LhsReg = MI.getOperand(0).getReg();
+    int64_t Imm = MI.getOperand(1).getImm();
+    BuildMI(MBB, MI, DL, get(M65832::CMPR_IMM))
+        .addReg(LhsReg)
+        .addImm(Imm);
+    break;
+  }
+
+  case M65832::BR_CC_CMP_PSEUDO:
+  case M65832::BR_CC_CMP_IMM_PSEUDO:
+  case M65832::BR_CC_CMP8_PSEUDO:
+  case M65832::BR_CC_CMP16_PSEUDO:
+  case M65832::BR_CC_CMP8_IMM_PSEUDO:
+  case M65832::BR_CC_CMP16_IMM_PSEUDO: {
+    // Fused compare-and-branch: CMP[.B/.W] lhs, rhs; Bcc target
+    int64_t CC = MI.getOperand(2).getImm();
+    emitBranchCompare(MI, MI.getOpcode(), MI.getOperand(0), MI.getOperand(1),
+                      CC);
+    expandCondBranch(MI, CC, MI.getOperand(3).getMBB());
+    break;
+  }
+
+  case M65832::TAILCALL_CC: {
+    // A Bcc condition stays for the AsmPrinter. A compare-and-branch one
+    // emits its compare and becomes the Bcc canMakeTailCallConditional
+    // checked it expands to.
+    unsigned CondOpc = MI.getOperand(1).getImm();
+    if (isCondBranchOpcode(CondOpc))
+      return false;
+    int64_t CC = MI.getOperand(4).getImm();
+    emitBranchCompare(MI, CondOpc, MI.getOperand(2), MI.getOperand(3), CC);
+    BuildMI(MBB, MI, DL, get(M65832::TAILCALL_CC))
+        .add(MI.getOperand(0))
+        .addImm(getSingleCondBranch(CC))
+        .copyImplicitOps(MI);
+    break;
+  }
+
+  case M65832::BR_CC_PSEUDO: {
+    // Conditional branch based on condition code
+    // The compare has already been done (via CMPR_DP), flags are set
+    int64_t CC = MI.getOperand(0).getImm();
+    MachineBasicBlock *Target = MI.getOperand(1).getMBB();
+
+    expandCondBranch(MI, CC, Target);
     break;
   }
 
@@ -1608,78 +3494,40 @@ bool M65832InstrInfo::expandPostRAPseudo(MachineInstr &MI) const {
     Register RHSReg = MI.getOperand(1).getReg();
     int64_t CC = MI.getOperand(2).getImm();
     MachineBasicBlock *Target = MI.getOperand(3).getMBB();
-    MachineBasicBlock *NextMBB = MBB.getNextNode();
     
     // Emit compare - IMMEDIATELY followed by branch
     BuildMI(MBB, MI, DL, get(M65832::CMPR_DP))
         .addReg(LHSReg)
         .addReg(RHSReg);
     
-    // Map condition code to branch opcode
-    unsigned BrOpc;
-    bool Emitted = false;
-    switch (CC) {
-    case ISD::SETEQ:  BrOpc = M65832::BEQ; break;
-    case ISD::SETNE:  BrOpc = M65832::BNE; break;
-    case ISD::SETLT:  BrOpc = M65832::BMI; break;
-    case ISD::SETGE:  BrOpc = M65832::BPL; break;
-    case ISD::SETGT:
-      if (NextMBB) {
-        BuildMI(MBB, MI, DL, get(M65832::BEQ)).addMBB(NextMBB);
-        BuildMI(MBB, MI, DL, get(M65832::BMI)).addMBB(NextMBB);
-        BuildMI(MBB, MI, DL, get(M65832::BRA)).addMBB(Target);
-        Emitted = true;
-        break;
-      }
-      BrOpc = M65832::BPL;
-      break;
-    case ISD::SETLE:
-      if (NextMBB) {
-        BuildMI(MBB, MI, DL, get(M65832::BEQ)).addMBB(Target);
-        BuildMI(MBB, MI, DL, get(M65832::BMI)).addMBB(Target);
-        Emitted = true;
-        break;
-      }
-      BrOpc = M65832::BMI;
-      break;
-    case ISD::SETULT: BrOpc = M65832::BCC; break;
-    case ISD::SETUGE: BrOpc = M65832::BCS; break;
-    case ISD::SETUGT:
-      if (NextMBB) {
-        BuildMI(MBB, MI, DL, get(M65832::BEQ)).addMBB(NextMBB);
-        BuildMI(MBB, MI, DL, get(M65832::BCS)).addMBB(Target);
-        Emitted = true;
-        break;
-      }
-      BrOpc = M65832::BCS;
-      break;
-    case ISD::SETULE:
-      if (NextMBB) {
-        BuildMI(MBB, MI, DL, get(M65832::BEQ)).addMBB(Target);
-        BuildMI(MBB, MI, DL, get(M65832::BCC)).addMBB(Target);
-        Emitted = true;
-        break;
-      }
-      BrOpc = M65832::BCC;
-      break;
-    default:
-      BrOpc = M65832::BNE;
-      break;
-    }
+    expandCondBranch(MI, CC, Target);
+    break;
+  }
 
-    if (!Emitted) {
+  case M65832::FCMP_BR_CC_S:
+  case M65832::FCMP_BR_CC_D: {
+    // Fused FP compare-and-branch: FCMP.x lhs, rhs; Bcc target [; Bcc target]
+    int64_t CC = MI.getOperand(2).getImm();
+    MachineBasicBlock *Target = MI.getOperand(3).getMBB();
+    unsigned CmpOpc = MI.getOpcode() == M65832::FCMP_BR_CC_S ? M65832::FCMP_S
+                                                             : M65832::FCMP_D;
+    BuildMI(MBB, MI, DL, get(CmpOpc))
+        .add(MI.getOperand(0))
+        .add(MI.getOperand(1));
+    for (unsigned BrOpc : getFCmpBranches(static_cast<ISD::CondCode>(CC)))
       BuildMI(MBB, MI, DL, get(BrOpc)).addMBB(Target);
-    }
     break;
   }
 
-  case M65832::SELECT_CC_PSEUDO: {
+  case M65832::SELECT_CC_PSEUDO:
+  case M65832::SELECT_CC_IMM_PSEUDO: {
     // Conditional select: dst = (lhs cc rhs) ? trueVal : falseVal
     // Use inline branch sequence - MBB splitting causes iterator issues in expandPostRAPseudo
-    // Operands: dst, lhs, rhs, trueVal, falseVal, cc
+    // Operands: dst, lhs, rhs, trueVal, falseVal, cc (rhs is an immediate
+    // for SELECT_CC_IMM_PSEUDO)
     Register DstReg = MI.getOperand(0).getReg();
     Register LHSReg = MI.getOperand(1).getReg();
-    Register RHSReg = MI.getOperand(2).getReg();
+    const MachineOperand &RHS = MI.getOperand(2);
     Register TrueReg = MI.getOperand(3).getReg();
     Register FalseReg = MI.getOperand(4).getReg();
     int64_t CC = MI.getOperand(5).getImm();
@@ -1687,9 +3535,14 @@ bool M65832InstrInfo::expandPostRAPseudo(MachineInstr &MI) const {
     // First, emit the CMP instruction to set flags
     // This ensures each SELECT_CC has its own comparison, regardless of
     // any flag-clobbering instructions scheduled between multiple SELECTs
-    BuildMI(MBB, MI, DL, get(M65832::CMPR_DP))
-        .addReg(LHSReg)
-        .addReg(RHSReg);
+    if (RHS.isImm())
+      BuildMI(MBB, MI, DL, get(M65832::CMPR_IMM))
+          .addReg(LHSReg)
+          .addImm(RHS.getImm());
+    else
+      BuildMI(MBB, MI, DL, get(M65832::CMPR_DP))
+          .addReg(LHSReg)
+          .addReg(RHS.getReg());
     
     // Handle register aliasing: when TrueReg == DstReg, we must NOT clobber it
     // by copying FalseReg first. Instead, invert the logic:
@@ -1830,100 +3683,188 @@ bool M65832InstrInfo::expandPostRAPseudo(MachineInstr &MI) const {
     break;
   }
 
-  case M65832::SELECT_CC_FP_PSEUDO: {
-    // FP conditional select: dst = (cc) ? trueVal : falseVal
-    // Flags are already set by FCMP (via glue), so no CMP needed
-    // Operands: dst, trueVal, falseVal, cc
-    Register DstReg = MI.getOperand(0).getReg();
-    Register TrueReg = MI.getOperand(1).getReg();
-    Register FalseReg = MI.getOperand(2).getReg();
-    int64_t CC = MI.getOperand(3).getImm();
-    
-    // Handle register aliasing same as integer version
-    bool InvertLogic = (TrueReg == DstReg && TrueReg != FalseReg);
-    
-    if (TrueReg == DstReg && FalseReg == DstReg) {
-      break;  // Both aliases - nothing to do
+  case M65832::SELECT_CC_MASK_PSEUDO:
+  case M65832::SELECT_CC_AND_PSEUDO: {
+    // Branchless select, see the pseudo definitions for the sequences.
+    // Operands: dst, lhs, rhs, trueVal, [falseVal,] cc
+    bool IsAnd = MI.getOpcode() == M65832::SELECT_CC_AND_PSEUDO;
+    unsigned DstDP = getDPOffset(MI.getOperand(0).getReg() - M65832::R0);
+    unsigned LHSDP = getDPOffset(MI.getOperand(1).getReg() - M65832::R0);
+    unsigned RHSDP = getDPOffset(MI.getOperand(2).getReg() - M65832::R0);
+    unsigned TrueDP = getDPOffset(MI.getOperand(3).getReg() - M65832::R0);
+    int64_t CC = MI.getOperand(MI.getNumExplicitOperands() - 1).getImm();
+
+    // Leave C clear exactly when the mask should select trueVal.
+    BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A).addImm(LHSDP);
+    bool IsEquality = CC == ISD::SETEQ || CC == ISD::SETNE;
+    if (IsEquality) {
+      // lhs == rhs  <=>  (lhs ^ rhs) <u 1
+      BuildMI(MBB, MI, DL, get(M65832::EOR_DP), M65832::A)
+          .addReg(M65832::A)
+          .addImm(RHSDP);
+      BuildMI(MBB, MI, DL, get(M65832::CMP_IMM))
+          .addReg(M65832::A, RegState::Kill)
+          .addImm(1);
+    } else {
+      BuildMI(MBB, MI, DL, get(M65832::CMP_DP))
+          .addReg(M65832::A, RegState::Kill)
+          .addImm(RHSDP);
     }
-    
-    Register FirstCopyReg = InvertLogic ? TrueReg : FalseReg;
-    Register SecondCopyReg = InvertLogic ? FalseReg : TrueReg;
-    
-    auto InvertCC = [](int64_t cc) -> int64_t {
-      switch (cc) {
-      case ISD::SETEQ: return ISD::SETNE;
-      case ISD::SETNE: return ISD::SETEQ;
-      case ISD::SETLT: return ISD::SETGE;
-      case ISD::SETGE: return ISD::SETLT;
-      case ISD::SETGT: return ISD::SETLE;
-      case ISD::SETLE: return ISD::SETGT;
-      case ISD::SETULT: return ISD::SETUGE;
-      case ISD::SETUGE: return ISD::SETULT;
-      case ISD::SETUGT: return ISD::SETULE;
-      case ISD::SETULE: return ISD::SETUGT;
-      case ISD::SETOEQ: return ISD::SETONE;
-      case ISD::SETONE: return ISD::SETOEQ;
-      case ISD::SETOLT: return ISD::SETOGE;
-      case ISD::SETOGE: return ISD::SETOLT;
-      case ISD::SETOGT: return ISD::SETOLE;
-      case ISD::SETOLE: return ISD::SETOGT;
-      case ISD::SETUNE: return ISD::SETOEQ;
-      default: return cc;
-      }
-    };
-    
-    int64_t EffectiveCC = InvertLogic ? InvertCC(CC) : CC;
-    
-    if (FirstCopyReg != DstReg) {
-      BuildMI(MBB, MI, DL, get(M65832::MOVR_DP), DstReg).addReg(FirstCopyReg);
+    bool MaskIsCond = CC == ISD::SETEQ || CC == ISD::SETULT;
+
+    // A = C ? 0 : -1
+    BuildMI(MBB, MI, DL, get(M65832::LDA_IMM), M65832::A).addImm(0);
+    BuildMI(MBB, MI, DL, get(M65832::SBC_IMM), M65832::A)
+        .addReg(M65832::A)
+        .addImm(0);
+
+    if (IsAnd) {
+      if (!MaskIsCond)
+        BuildMI(MBB, MI, DL, get(M65832::EOR_IMM), M65832::A)
+            .addReg(M65832::A)
+            .addImm(-1);
+      BuildMI(MBB, MI, DL, get(M65832::AND_DP), M65832::A)
+          .addReg(M65832::A)
+          .addImm(TrueDP);
+      BuildMI(MBB, MI, DL, get(M65832::STA_DP))
+          .addReg(M65832::A, RegState::Kill)
+          .addImm(DstDP);
+      break;
     }
-    
-    unsigned SkipBrOpc;
-    bool NeedDualBranch = false;
-    
-    switch (EffectiveCC) {
-    case ISD::SETEQ:
-    case ISD::SETOEQ:  SkipBrOpc = M65832::BNE; break;
+
+    // dst = f ^ ((t ^ f) & mask), with t/f swapped when the mask is the
+    // inverse of the condition.
+    unsigned FalseDP = getDPOffset(MI.getOperand(4).getReg() - M65832::R0);
+    if (!MaskIsCond)
+      std::swap(TrueDP, FalseDP);
+    BuildMI(MBB, MI, DL, get(M65832::STA_DP))
+        .addReg(M65832::A, RegState::Kill)
+        .addImm(DstDP);
+    BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A).addImm(TrueDP);
+    BuildMI(MBB, MI, DL, get(M65832::EOR_DP), M65832::A)
+        .addReg(M65832::A)
+        .addImm(FalseDP);
+    BuildMI(MBB, MI, DL, get(M65832::AND_DP), M65832::A)
+        .addReg(M65832::A)
+        .addImm(DstDP);
+    BuildMI(MBB, MI, DL, get(M65832::EOR_DP), M65832::A)
+        .addReg(M65832::A)
+        .addImm(FalseDP);
+    BuildMI(MBB, MI, DL, get(M65832::STA_DP))
+        .addReg(M65832::A, RegState::Kill)
+        .addImm(DstDP);
+    break;
+  }
+
+  case M65832::SETCC_PSEUDO:
+  case M65832::SETCC_IMM_PSEUDO: {
+    // 0/1 compare through the carry, see the pseudo definitions for the
+    // sequences. Operands: dst, lhs, rhs, cc
+    unsigned DstDP = getDPOffset(MI.getOperand(0).getReg() - M65832::R0);
+    unsigned LHSDP = getDPOffset(MI.getOperand(1).getReg() - M65832::R0);
+    const MachineOperand &RHS = MI.getOperand(2);
+    int64_t CC = MI.getOperand(3).getImm();
+    bool IsImm = RHS.isImm();
+    int64_t Imm = IsImm ? RHS.getImm() : 0;
+    unsigned RHSDP =
+        IsImm ? 0 : getDPOffset(RHS.getReg() - M65832::R0);
+    const uint32_t SignBit = 0x80000000;
+
+    // A op rhs, with op's DP or immediate form
+    auto emitOpRHS = [&](unsigned DPOpc, unsigned ImmOpc, int64_t ImmVal) {
+      if (IsImm)
+        BuildMI(MBB, MI, DL, get(ImmOpc), M65832::A)
+            .addReg(M65832::A)
+            .addImm(ImmVal);
+      else
+        BuildMI(MBB, MI, DL, get(DPOpc), M65832::A)
+            .addReg(M65832::A)
+            .addImm(RHSDP);
+    };
+    auto emitCmp = [&](unsigned Opc, int64_t Operand) {
+      BuildMI(MBB, MI, DL, get(Opc))
+          .addReg(M65832::A, RegState::Kill)
+          .addImm(Operand);
+    };
+
+    // Leave C set when the condition holds, or when it does not if Invert
+    bool Invert = false;
+    switch (CC) {
+    default:
+      llvm_unreachable("unexpected SETCC condition");
+    case ISD::SETULT:
+      if (IsImm && Imm != 0) {
+        // lhs < imm  <=>  imm - 1 >= lhs
+        BuildMI(MBB, MI, DL, get(M65832::LDA_IMM), M65832::A)
+            .addImm(static_cast<uint32_t>(Imm - 1));
+        emitCmp(M65832::CMP_DP, LHSDP);
+        break;
+      }
+      Invert = true;
+      [[fallthrough]];
+    case ISD::SETUGE:
+      BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A).addImm(LHSDP);
+      if (IsImm)
+        emitCmp(M65832::CMP_IMM, Imm);
+      else
+        emitCmp(M65832::CMP_DP, RHSDP);
+      break;
     case ISD::SETNE:
-    case ISD::SETONE:
-    case ISD::SETUNE:  SkipBrOpc = M65832::BEQ; break;
+      // lhs != rhs  <=>  (lhs ^ rhs) >= 1
+      BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A).addImm(LHSDP);
+      if (!IsImm || Imm != 0)
+        emitOpRHS(M65832::EOR_DP, M65832::EOR_IMM, Imm);
+      emitCmp(M65832::CMP_IMM, 1);
+      break;
+    case ISD::SETEQ: {
+      // lhs == rhs  <=>  0 >= (lhs ^ rhs)
+      unsigned DiffDP = LHSDP;
+      if (!IsImm || Imm != 0) {
+        BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A).addImm(LHSDP);
+        emitOpRHS(M65832::EOR_DP, M65832::EOR_IMM, Imm);
+        BuildMI(MBB, MI, DL, get(M65832::STA_DP))
+            .addReg(M65832::A, RegState::Kill)
+            .addImm(DstDP);
+        DiffDP = DstDP;
+      }
+      BuildMI(MBB, MI, DL, get(M65832::LDA_IMM), M65832::A).addImm(0);
+      emitCmp(M65832::CMP_DP, DiffDP);
+      break;
+    }
     case ISD::SETLT:
-    case ISD::SETOLT:  SkipBrOpc = M65832::BPL; break;
+      Invert = true;
+      [[fallthrough]];
     case ISD::SETGE:
-    case ISD::SETOGE:  SkipBrOpc = M65832::BMI; break;
-    case ISD::SETGT:
-    case ISD::SETOGT:  NeedDualBranch = true; break;
-    case ISD::SETLE:
-    case ISD::SETOLE:  NeedDualBranch = true; break;
-    case ISD::SETULT:  SkipBrOpc = M65832::BCS; break;
-    case ISD::SETUGE:  SkipBrOpc = M65832::BCC; break;
-    case ISD::SETUGT:  NeedDualBranch = true; break;
-    case ISD::SETULE:  NeedDualBranch = true; break;
-    default:           SkipBrOpc = M65832::BEQ; break;
-    }
-    
-    if (NeedDualBranch) {
-      if (EffectiveCC == ISD::SETGT || EffectiveCC == ISD::SETOGT) {
-        BuildMI(MBB, MI, DL, get(M65832::BEQ)).addImm(11);
-        BuildMI(MBB, MI, DL, get(M65832::BMI)).addImm(8);
-      } else if (EffectiveCC == ISD::SETLE || EffectiveCC == ISD::SETOLE) {
-        BuildMI(MBB, MI, DL, get(M65832::BEQ)).addImm(9);
-        BuildMI(MBB, MI, DL, get(M65832::BMI)).addImm(6);
-        BuildMI(MBB, MI, DL, get(M65832::BRA)).addImm(8);
-      } else if (EffectiveCC == ISD::SETUGT) {
-        BuildMI(MBB, MI, DL, get(M65832::BEQ)).addImm(11);
-        BuildMI(MBB, MI, DL, get(M65832::BCC)).addImm(8);
-      } else if (EffectiveCC == ISD::SETULE) {
-        BuildMI(MBB, MI, DL, get(M65832::BEQ)).addImm(9);
-        BuildMI(MBB, MI, DL, get(M65832::BCC)).addImm(6);
-        BuildMI(MBB, MI, DL, get(M65832::BRA)).addImm(8);
+      // Signed order is unsigned order with both sign bits flipped
+      if (!IsImm) {
+        BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A).addImm(RHSDP);
+        BuildMI(MBB, MI, DL, get(M65832::EOR_IMM), M65832::A)
+            .addReg(M65832::A)
+            .addImm(SignBit);
+        BuildMI(MBB, MI, DL, get(M65832::STA_DP))
+            .addReg(M65832::A, RegState::Kill)
+            .addImm(DstDP);
       }
-    } else {
-      BuildMI(MBB, MI, DL, get(SkipBrOpc)).addImm(8);
+      BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A).addImm(LHSDP);
+      BuildMI(MBB, MI, DL, get(M65832::EOR_IMM), M65832::A)
+          .addReg(M65832::A)
+          .addImm(SignBit);
+      if (IsImm)
+        emitCmp(M65832::CMP_IMM, static_cast<uint32_t>(Imm) ^ SignBit);
+      else
+        emitCmp(M65832::CMP_DP, DstDP);
+      break;
     }
-    
-    BuildMI(MBB, MI, DL, get(M65832::MOVR_DP), DstReg).addReg(SecondCopyReg);
-    
+
+    BuildMI(MBB, MI, DL, get(M65832::LDA_IMM), M65832::A).addImm(0);
+    BuildMI(MBB, MI, DL, get(M65832::ROL_A), M65832::A).addReg(M65832::A);
+    if (Invert)
+      BuildMI(MBB, MI, DL, get(M65832::EOR_IMM), M65832::A)
+          .addReg(M65832::A)
+          .addImm(1);
+    BuildMI(MBB, MI, DL, get(M65832::STA_DP))
+        .addReg(M65832::A, RegState::Kill)
+        .addImm(DstDP);
     break;
   }
 
@@ -1959,6 +3900,29 @@ bool M65832InstrInfo::expandPostRAPseudo(MachineInstr &MI) const {
     break;
   }
   
+  case M65832::MAC_GPR: {
+    // dst = src1 * src2 + acc: LDA src1; MUL src2; CLC; ADC acc; STA dst
+    unsigned DstDP = getDPOffset(MI.getOperand(0).getReg() - M65832::R0);
+    unsigned Src1DP = getDPOffset(MI.getOperand(1).getReg() - M65832::R0);
+    unsigned Src2DP = getDPOffset(MI.getOperand(2).getReg() - M65832::R0);
+    unsigned AccDP = getDPOffset(MI.getOperand(3).getReg() - M65832::R0);
+
+    BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A).addImm(Src1DP);
+    BuildMI(MBB, MI, DL, get(M65832::MUL_DP))
+        .addReg(M65832::A, RegState::Define)
+        .addReg(M65832::T, RegState::Define | RegState::Dead)
+        .addReg(M65832::A)
+        .addImm(Src2DP);
+    BuildMI(MBB, MI, DL, get(M65832::CLC));
+    BuildMI(MBB, MI, DL, get(M65832::ADC_DP), M65832::A)
+        .addReg(M65832::A)
+        .addImm(AccDP);
+    BuildMI(MBB, MI, DL, get(M65832::STA_DP))
+        .addReg(M65832::A, RegState::Kill)
+        .addImm(DstDP);
+    break;
+  }
+
   case M65832::SDIV_GPR:
   case M65832::UDIV_GPR: {
     // dst = src1 / src2: LDA src1; DIV src2; STA dst
@@ -2013,6 +3977,214 @@ bool M65832InstrInfo::expandPostRAPseudo(MachineInstr &MI) const {
         .addImm(DstDP);
     break;
   }
+
+  case M65832::UMUL_LOHI_GPR:
+  case M65832::SMUL_LOHI_GPR:
+  case M65832::MULHU_GPR:
+  case M65832::MULHS_GPR: {
+    // LDA src1; MUL/MULU src2; [STA lo;] TTA; STA hi
+    bool HasLo = MI.getOpcode() == M65832::UMUL_LOHI_GPR ||
+                 MI.getOpcode() == M65832::SMUL_LOHI_GPR;
+    bool IsSigned = MI.getOpcode() == M65832::SMUL_LOHI_GPR ||
+                    MI.getOpcode() == M65832::MULHS_GPR;
+    unsigned SrcIdx = HasLo ? 2 : 1;
+    unsigned HiDP = getDPOffset(MI.getOperand(HasLo ? 1 : 0).getReg() -
+                                M65832::R0);
+    unsigned Src1DP =
+        getDPOffset(MI.getOperand(SrcIdx).getReg() - M65832::R0);
+    unsigned Src2DP =
+        getDPOffset(MI.getOperand(SrcIdx + 1).getReg() - M65832::R0);
+
+    BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A).addImm(Src1DP);
+    BuildMI(MBB, MI, DL, get(IsSigned ? M65832::MUL_DP : M65832::MULU_DP))
+        .addReg(M65832::A, RegState::Define | (HasLo ? 0 : RegState::Dead))
+        .addReg(M65832::T, RegState::Define)
+        .addReg(M65832::A)
+        .addImm(Src2DP);
+    if (HasLo) {
+      unsigned LoDP = getDPOffset(MI.getOperand(0).getReg() - M65832::R0);
+      BuildMI(MBB, MI, DL, get(M65832::STA_DP))
+          .addReg(M65832::A, RegState::Kill)
+          .addImm(LoDP);
+    }
+    BuildMI(MBB, MI, DL, get(M65832::TTA), M65832::A);
+    BuildMI(MBB, MI, DL, get(M65832::STA_DP))
+        .addReg(M65832::A, RegState::Kill)
+        .addImm(HiDP);
+    break;
+  }
+
+  case M65832::SDIVREM_GPR:
+  case M65832::UDIVREM_GPR: {
+    // LDA src1; DIV/DIVU src2; STA quot; TTA; STA rem
+    bool IsSigned = MI.getOpcode() == M65832::SDIVREM_GPR;
+    unsigned QuotDP = getDPOffset(MI.getOperand(0).getReg() - M65832::R0);
+    unsigned RemDP = getDPOffset(MI.getOperand(1).getReg() - M65832::R0);
+    unsigned Src1DP = getDPOffset(MI.getOperand(2).getReg() - M65832::R0);
+    unsigned Src2DP = getDPOffset(MI.getOperand(3).getReg() - M65832::R0);
+
+    BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A).addImm(Src1DP);
+    BuildMI(MBB, MI, DL, get(IsSigned ? M65832::DIV_DP : M65832::DIVU_DP))
+        .addReg(M65832::A, RegState::Define)
+        .addReg(M65832::T, RegState::Define)
+        .addReg(M65832::A)
+        .addImm(Src2DP);
+    BuildMI(MBB, MI, DL, get(M65832::STA_DP))
+        .addReg(M65832::A, RegState::Kill)
+        .addImm(QuotDP);
+    BuildMI(MBB, MI, DL, get(M65832::TTA), M65832::A);
+    BuildMI(MBB, MI, DL, get(M65832::STA_DP))
+        .addReg(M65832::A, RegState::Kill)
+        .addImm(RemDP);
+    break;
+  }
+
+  case M65832::ADD64_GPR:
+  case M65832::SUB64_GPR: {
+    // LDA al; CLC/SEC; ADC/SBC bl; STA lo; LDA ah; ADC/SBC bh; STA hi
+    // LDA and STA leave C alone, so the carry out of the low half feeds
+    // the high half directly.
+    bool IsAdd = MI.getOpcode() == M65832::ADD64_GPR;
+    unsigned Opc = IsAdd ? M65832::ADC_DP : M65832::SBC_DP;
+    unsigned LoDP = getDPOffset(MI.getOperand(0).getReg() - M65832::R0);
+    unsigned HiDP = getDPOffset(MI.getOperand(1).getReg() - M65832::R0);
+    unsigned ALoDP = getDPOffset(MI.getOperand(2).getReg() - M65832::R0);
+    unsigned AHiDP = getDPOffset(MI.getOperand(3).getReg() - M65832::R0);
+    unsigned BLoDP = getDPOffset(MI.getOperand(4).getReg() - M65832::R0);
+    unsigned BHiDP = getDPOffset(MI.getOperand(5).getReg() - M65832::R0);
+
+    BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A).addImm(ALoDP);
+    BuildMI(MBB, MI, DL, get(IsAdd ? M65832::CLC : M65832::SEC));
+    BuildMI(MBB, MI, DL, get(Opc), M65832::A).addReg(M65832::A).addImm(BLoDP);
+    BuildMI(MBB, MI, DL, get(M65832::STA_DP))
+        .addReg(M65832::A, RegState::Kill)
+        .addImm(LoDP);
+    BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A).addImm(AHiDP);
+    BuildMI(MBB, MI, DL, get(Opc), M65832::A).addReg(M65832::A).addImm(BHiDP);
+    BuildMI(MBB, MI, DL, get(M65832::STA_DP))
+        .addReg(M65832::A, RegState::Kill)
+        .addImm(HiDP);
+    break;
+  }
+
+  case M65832::UADDO_GPR:
+  case M65832::USUBO_GPR: {
+    // LDA a; CLC/SEC; ADC/SBC b; STA res; LDA #0; ROL A; [EOR #1;] STA ovf
+    // SBC leaves C set when there was no borrow, hence the EOR.
+    bool IsAdd = MI.getOpcode() == M65832::UADDO_GPR;
+    unsigned ResDP = getDPOffset(MI.getOperand(0).getReg() - M65832::R0);
+    unsigned OvfDP = getDPOffset(MI.getOperand(1).getReg() - M65832::R0);
+    unsigned ADP = getDPOffset(MI.getOperand(2).getReg() - M65832::R0);
+    unsigned BDP = getDPOffset(MI.getOperand(3).getReg() - M65832::R0);
+
+    BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A).addImm(ADP);
+    BuildMI(MBB, MI, DL, get(IsAdd ? M65832::CLC : M65832::SEC));
+    BuildMI(MBB, MI, DL, get(IsAdd ? M65832::ADC_DP : M65832::SBC_DP),
+            M65832::A)
+        .addReg(M65832::A)
+        .addImm(BDP);
+    BuildMI(MBB, MI, DL, get(M65832::STA_DP))
+        .addReg(M65832::A, RegState::Kill)
+        .addImm(ResDP);
+    BuildMI(MBB, MI, DL, get(M65832::LDA_IMM), M65832::A).addImm(0);
+    BuildMI(MBB, MI, DL, get(M65832::ROL_A), M65832::A).addReg(M65832::A);
+    if (!IsAdd)
+      BuildMI(MBB, MI, DL, get(M65832::EOR_IMM), M65832::A)
+          .addReg(M65832::A)
+          .addImm(1);
+    BuildMI(MBB, MI, DL, get(M65832::STA_DP))
+        .addReg(M65832::A, RegState::Kill)
+        .addImm(OvfDP);
+    break;
+  }
+  case M65832::SADDO_GPR:
+  case M65832::SSUBO_GPR: {
+    // LDA a; CLC/SEC; ADC/SBC b; STA res; LDA #0; BVC *+8; LDA #1; STA ovf
+    bool IsAdd = MI.getOpcode() == M65832::SADDO_GPR;
+    unsigned ResDP = getDPOffset(MI.getOperand(0).getReg() - M65832::R0);
+    unsigned OvfDP = getDPOffset(MI.getOperand(1).getReg() - M65832::R0);
+    unsigned ADP = getDPOffset(MI.getOperand(2).getReg() - M65832::R0);
+    unsigned BDP = getDPOffset(MI.getOperand(3).getReg() - M65832::R0);
+
+    BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A).addImm(ADP);
+    BuildMI(MBB, MI, DL, get(IsAdd ? M65832::CLC : M65832::SEC));
+    BuildMI(MBB, MI, DL, get(IsAdd ? M65832::ADC_DP : M65832::SBC_DP),
+            M65832::A)
+        .addReg(M65832::A)
+        .addImm(BDP);
+    BuildMI(MBB, MI, DL, get(M65832::STA_DP))
+        .addReg(M65832::A, RegState::Kill)
+        .addImm(ResDP);
+    BuildMI(MBB, MI, DL, get(M65832::LDA_IMM), M65832::A).addImm(0);
+    MachineInstr *Skip = BuildMI(MBB, MI, DL, get(M65832::BVC)).addImm(0);
+    BuildMI(MBB, MI, DL, get(M65832::LDA_IMM), M65832::A).addImm(1);
+    Skip->getOperand(0).setImm(getRangeSize(Skip, MI));
+    BuildMI(MBB, MI, DL, get(M65832::STA_DP))
+        .addReg(M65832::A, RegState::Kill)
+        .addImm(OvfDP);
+    break;
+  }
+  case M65832::UADDSAT_GPR:
+  case M65832::USUBSAT_GPR: {
+    // LDA a; CLC/SEC; ADC/SBC b; STA dst; SBC dst; EOR #-1; ORA/AND dst;
+    // STA dst. After the STA, A - dst - !C is C - 1, inverted into a mask
+    // that is all ones when the add carried or the subtract did not borrow.
+    bool IsAdd = MI.getOpcode() == M65832::UADDSAT_GPR;
+    unsigned DstDP = getDPOffset(MI.getOperand(0).getReg() - M65832::R0);
+    unsigned ADP = getDPOffset(MI.getOperand(1).getReg() - M65832::R0);
+    unsigned BDP = getDPOffset(MI.getOperand(2).getReg() - M65832::R0);
+
+    BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A).addImm(ADP);
+    BuildMI(MBB, MI, DL, get(IsAdd ? M65832::CLC : M65832::SEC));
+    BuildMI(MBB, MI, DL, get(IsAdd ? M65832::ADC_DP : M65832::SBC_DP),
+            M65832::A)
+        .addReg(M65832::A)
+        .addImm(BDP);
+    BuildMI(MBB, MI, DL, get(M65832::STA_DP)).addReg(M65832::A).addImm(DstDP);
+    BuildMI(MBB, MI, DL, get(M65832::SBC_DP), M65832::A)
+        .addReg(M65832::A)
+        .addImm(DstDP);
+    BuildMI(MBB, MI, DL, get(M65832::EOR_IMM), M65832::A)
+        .addReg(M65832::A)
+        .addImm(-1);
+    BuildMI(MBB, MI, DL, get(IsAdd ? M65832::ORA_DP : M65832::AND_DP),
+            M65832::A)
+        .addReg(M65832::A)
+        .addImm(DstDP);
+    BuildMI(MBB, MI, DL, get(M65832::STA_DP))
+        .addReg(M65832::A, RegState::Kill)
+        .addImm(DstDP);
+    break;
+  }
+  case M65832::SADDSAT_GPR:
+  case M65832::SSUBSAT_GPR: {
+    // LDA a; CLC/SEC; ADC/SBC b; BVC *+16; LDA a; ASL A;
+    // LDA #$7FFFFFFF; ADC #0; STA dst
+    // On overflow C = sign(a), and $7FFFFFFF + C is the clamp.
+    bool IsAdd = MI.getOpcode() == M65832::SADDSAT_GPR;
+    unsigned DstDP = getDPOffset(MI.getOperand(0).getReg() - M65832::R0);
+    unsigned ADP = getDPOffset(MI.getOperand(1).getReg() - M65832::R0);
+    unsigned BDP = getDPOffset(MI.getOperand(2).getReg() - M65832::R0);
+
+    BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A).addImm(ADP);
+    BuildMI(MBB, MI, DL, get(IsAdd ? M65832::CLC : M65832::SEC));
+    BuildMI(MBB, MI, DL, get(IsAdd ? M65832::ADC_DP : M65832::SBC_DP),
+            M65832::A)
+        .addReg(M65832::A)
+        .addImm(BDP);
+    MachineInstr *Skip = BuildMI(MBB, MI, DL, get(M65832::BVC)).addImm(0);
+    BuildMI(MBB, MI, DL, get(M65832::LDA_DP), M65832::A).addImm(ADP);
+    BuildMI(MBB, MI, DL, get(M65832::ASL_A), M65832::A).addReg(M65832::A);
+    BuildMI(MBB, MI, DL, get(M65832::LDA_IMM), M65832::A).addImm(0x7FFFFFFF);
+    BuildMI(MBB, MI, DL, get(M65832::ADC_IMM), M65832::A)
+        .addReg(M65832::A)
+        .addImm(0);
+    Skip->getOperand(0).setImm(getRangeSize(Skip, MI));
+    BuildMI(MBB, MI, DL, get(M65832::STA_DP))
+        .addReg(M65832::A, RegState::Kill)
+        .addImm(DstDP);
+    break;
+  }
   }
 
   MI.eraseFromParent();
@@ -47,6 +47,34 @@ public:
       unsigned SubReg = 0,
       MachineInstr::MIFlag Flags = MachineInstr::NoFlags) const override;
 
+  /// Recognize the spill and reload forms above (LOAD32/STORE32 and the
+  /// LDF/STF pseudos at offset 0), so the spiller can drop redundant
+  /// spills and StackSlotColoring removes dead reload/spill pairs.
+  Register isLoadFromStackSlot(const MachineInstr &MI,
+                               int &FrameIndex) const override;
+  Register isStoreToStackSlot(const MachineInstr &MI,
+                              int &FrameIndex) const override;
+
+  /// Fold a reload of an ADD/SUB/AND/ORA/EOR_GPR source into the matching
+  /// _MEM pseudo, which reads the slot with ADC/SBC/AND/ORA/EOR B+off.
+  using TargetInstrInfo::foldMemoryOperandImpl;
+  MachineInstr *
+  foldMemoryOperandImpl(MachineFunction &MF, MachineInstr &MI,
+                        ArrayRef<unsigned> Ops,
+                        MachineBasicBlock::iterator InsertPt, int FrameIndex,
+                        LiveIntervals *LIS = nullptr,
+                        VirtRegMap *VRM = nullptr) const override;
+
+  /// MachineLICM. LA_PCREL pushes and pulls the PC through the stack,
+  /// leaving SP as it found it, so its SP use need not keep it in a loop
+  bool isIgnorableUse(const MachineOperand &MO) const override;
+
+  /// Keep values in A, X and Y out of the preheader: nearly every GPR
+  /// pseudo expands through them, so one live across a loop cannot be
+  /// allocated
+  bool shouldHoist(const MachineInstr &MI,
+                   const MachineLoop *FromLoop) const override;
+
   bool analyzeBranch(MachineBasicBlock &MBB, MachineBasicBlock *&TBB,
                      MachineBasicBlock *&FBB,
                      SmallVectorImpl<MachineOperand> &Cond,
@@ -63,12 +91,169 @@ public:
   bool reverseBranchCondition(
       SmallVectorImpl<MachineOperand> &Cond) const override;
 
+  /// Instructions a block may have for block placement to copy it into
+  /// its predecessors instead of branching to it
+  unsigned getTailDuplicateSize(CodeGenOptLevel OptLevel) const override;
+
+  /// A direct TAILCALL in a block of its own can become TAILCALL_CC, the
+  /// Bcc of a predecessor that branches to it, when the condition is one
+  /// Bcc (or a compare-and-branch that expands to one)
+  bool isUnconditionalTailCall(const MachineInstr &MI) const override;
+  bool canMakeTailCallConditional(SmallVectorImpl<MachineOperand> &Cond,
+                                  const MachineInstr &TailCall) const override;
+  void replaceBranchWithTailCall(MachineBasicBlock &MBB,
+                                 SmallVectorImpl<MachineOperand> &Cond,
+                                 const MachineInstr &TailCall) const override;
+
+  /// Single-block loops that end in a compare-and-branch pseudo, for the
+  /// MachinePipeliner
+  std::unique_ptr<PipelinerLoopInfo>
+  analyzeLoopForPipelining(MachineBasicBlock *LoopBB) const override;
+
+  bool analyzeCompare(const MachineInstr &MI, Register &SrcReg,
+                      Register &SrcReg2, int64_t &CmpMask,
+                      int64_t &CmpValue) const override;
+
+  /// Turn a fused compare against 1 or -1 into the equivalent compare
+  /// against 0, whose CMP expandPostRAPseudo drops when the instruction that
+  /// defined lhs left its N/Z flags behind.
+  bool optimizeCompareInstr(MachineInstr &CmpInstr, Register SrcReg,
+                            Register SrcReg2, int64_t CmpMask,
+                            int64_t CmpValue,
+                            const MachineRegisterInfo *MRI) const override;
+
+  /// Untie INC/DEC into the A-based add and subtract, and the in-place
+  /// shifts into the barrel shifter, when the tied source stays live.
+  MachineInstr *convertToThreeAddress(MachineInstr &MI, LiveVariables *LV,
+                                      LiveIntervals *LIS) const override;
+
+  /// Let the MachineCombiner rebalance chains of integer ADD/AND/ORA/EOR,
+  /// and of FADD/FMUL under reassoc and nsz.
+  bool useMachineCombiner() const override { return true; }
+  bool isAssociativeAndCommutative(const MachineInstr &Inst,
+                                   bool Invert) const override;
+  bool hasReassociableOperands(const MachineInstr &Inst,
+                               const MachineBasicBlock *MBB) const override;
+
+  unsigned getInstSizeInBytes(const MachineInstr &MI) const override;
+
+  /// PUSH32 moves SP by a word inside its call sequence
+  int getSPAdjust(const MachineInstr &MI) const override;
+
+  MCInst getNop() const override;
+
+  /// Bcc, BRA and BRL all carry a signed 16-bit displacement from the end of
+  /// the instruction.
+  bool isBranchOffsetInRange(unsigned BranchOpc,
+                             int64_t BrOffset) const override;
+
+  MachineBasicBlock *getBranchDestBlock(const MachineInstr &MI) const override;
+
+  /// Reach a block outside BRA range through the reserved scratch R31:
+  /// LDA #dest; STA R31; JMP (R31).
+  void insertIndirectBranch(MachineBasicBlock &MBB,
+                            MachineBasicBlock &NewDestBB,
+                            MachineBasicBlock &RestoreBB, const DebugLoc &DL,
+                            int64_t BrOffset = 0,
+                            RegScavenger *RS = nullptr) const override;
+
+  // MachineFunctionSplitter. Branch relaxation treats every branch between
+  // the hot and the .text.split part as out of range, so they become the
+  // absolute JMP (R31) above.
+  bool isFunctionSafeToSplit(const MachineFunction &MF) const override;
+
+  bool isMBBSafeToSplitToCold(const MachineBasicBlock &MBB) const override;
+
   bool expandPostRAPseudo(MachineInstr &MI) const override;
 
+  // MachineOutliner. The outlined call is a JSR, which leaves A, X, Y and
+  // SR alone but pushes a return address, so a sequence that touches SP
+  // can only be outlined as a tail call (JMP to it, the RTS moves along).
+  bool isFunctionSafeToOutlineFrom(MachineFunction &MF,
+                                   bool OutlineFromLinkOnceODRs) const override;
+
+  bool isMBBSafeToOutlineFrom(MachineBasicBlock &MBB,
+                              unsigned &Flags) const override;
+
+  bool shouldOutlineFromFunctionByDefault(MachineFunction &MF) const override;
+
+  std::optional<std::unique_ptr<outliner::OutlinedFunction>>
+  getOutliningCandidateInfo(
+      const MachineModuleInfo &MMI,
+      std::vector<outliner::Candidate> &RepeatedSequenceLocs,
+      unsigned MinRepeats) const override;
+
+  outliner::InstrType getOutliningTypeImpl(const MachineModuleInfo &MMI,
+                                           MachineBasicBlock::iterator &MIT,
+                                           unsigned Flags) const override;
+
+  void buildOutlinedFrame(MachineBasicBlock &MBB, MachineFunction &MF,
+                          const outliner::OutlinedFunction &OF) const override;
+
+  MachineBasicBlock::iterator
+  insertOutlinedCall(Module &M, MachineBasicBlock &MBB,
+                     MachineBasicBlock::iterator &It, MachineFunction &MF,
+                     outliner::Candidate &C) const override;
+
+  /// Emit SP = SP + Amount before I. Multiples of 4 up to
+  /// MaxStackAdjustSlots words become PHY (allocate) or PLY (free), which
+  /// preserve A and X; other amounts use TSX; TXA; ADC/SBC; TAX; TXS.
+  void adjustStackPtr(MachineBasicBlock &MBB, MachineBasicBlock::iterator I,
+                      const DebugLoc &DL, int64_t Amount) const;
+
+  /// Largest SP adjustment, in 32-bit words, done with single-byte
+  /// pushes/pulls. Ten bytes matches the size of the A/X sequence.
+  static constexpr unsigned MaxStackAdjustSlots = 8;
+
+  /// Load Imm into the GPR DstReg before I with the shortest encoding:
+  /// STZ for zero, LD.B/LD.W when it zero-extends from 8/16 bits, LD.L
+  /// otherwise. None of them touch A or the flags.
+  MachineInstr *loadImmediate(MachineBasicBlock &MBB,
+                              MachineBasicBlock::iterator I,
+                              const DebugLoc &DL, Register DstReg,
+                              uint32_t Imm) const;
+
   /// Get the Direct Page offset for a register (Rn -> n*4)
   static unsigned getDPOffset(unsigned RegNum) {
     return RegNum * 4;
   }
+
+private:
+  /// Expand a B-relative LEA_FI, reusing a B+offset value that an earlier
+  /// LEA_FI in the same block left in A or in a GPR when possible.
+  void expandFrameAddrFromB(MachineInstr &MI, Register DstReg,
+                            int64_t Offset) const;
+
+  /// Expand an ATOMIC_* read-modify-write pseudo into an LLI/SCI loop, or
+  /// into a PHP/SEI/PLP critical section without the atomics feature.
+  void expandAtomicRMW(MachineInstr &MI) const;
+
+  /// Expand a BLKMOVE* pseudo into an MVN/MVP sequence.
+  void expandBlockMove(MachineInstr &MI) const;
+
+  /// Expand an ADD/SUB/AND/ORA/EOR _MEM or _MEM_GLOBAL pseudo:
+  /// LDA src1; [CLC|SEC]; op mem; STA dst.
+  void expandALUMem(MachineInstr &MI) const;
+
+  /// Expand an INC32/DEC32/ASL32/LSR32 _MEM or _MEM_GLOBAL pseudo into the
+  /// in-place memory form where one reaches the address.
+  void expandRMWMem(MachineInstr &MI) const;
+
+  /// Expand a LOAD*/STORE* whose address is R28 + %gprel(sym) (small data)
+  /// or R56 + %tprel(sym) (TLS) into LDY #sym and a (base),Y access.
+  void expandSymbolRelAccess(MachineInstr &MI) const;
+
+  /// Expand the branch half of a BR_CC-style pseudo: one or two Bcc to
+  /// \p Target for condition \p CC on the flags a compare left in SR.
+  void expandCondBranch(MachineInstr &MI, int64_t CC,
+                        MachineBasicBlock *Target) const;
+
+  /// Emit the compare half of compare-and-branch pseudo \p Opc in front of
+  /// \p MI: lhs against rhs, or nothing for a compare against 0 whose N/Z
+  /// the instruction that defined lhs already left behind.
+  void emitBranchCompare(MachineInstr &MI, unsigned Opc,
+                         const MachineOperand &Lhs, const MachineOperand &Rhs,
+                         int64_t CC) const;
 };
 
 } // end namespace llvm
@@ -12,6 +12,8 @@
 //===----------------------------------------------------------------------===//
 
 #include "M65832MCInstLower.h"
+#include "M65832.h"
+#include "MCTargetDesc/M65832MCAsmInfo.h"
 #include "llvm/CodeGen/AsmPrinter.h"
 #include "llvm/CodeGen/MachineBasicBlock.h"
 #include "llvm/CodeGen/MachineInstr.h"
@@ -56,6 +58,22 @@ MCOperand M65832MCInstLower::LowerSymbolOperand(const MachineOperand &MO,
     Expr = MCBinaryExpr::createAdd(
         Expr, MCConstantExpr::create(MO.getOffset(), Ctx), Ctx);
 
+  if (MO.getTargetFlags() == M65832II::MO_GPREL)
+    Expr = MCSpecifierExpr::create(Expr, M65832::S_GPREL, Ctx);
+  else if (MO.getTargetFlags() == M65832II::MO_BANKREL)
+    Expr = MCSpecifierExpr::create(Expr, M65832::S_BANKREL, Ctx);
+  else if (MO.getTargetFlags() == M65832II::MO_BANKABS)
+    Expr = MCSpecifierExpr::create(Expr, M65832::S_BANKABS, Ctx);
+  else if (MO.getTargetFlags() == M65832II::MO_JMPABS)
+    Expr = MCSpecifierExpr::create(Expr, M65832::S_JMPABS, Ctx);
+  else if (MO.getTargetFlags() == M65832II::MO_DP)
+    Expr = MCSpecifierExpr::create(Expr, M65832::S_DP, Ctx);
+  else if (MO.getTargetFlags() == M65832II::MO_TPREL)
+    Expr = MCSpecifierExpr::create(Expr, M65832::S_TPREL, Ctx);
+  else if (MO.getTargetFlags() == M65832II::MO_POOLREL)
+    Expr = MCBinaryExpr::createSub(
+        Expr, MCSymbolRefExpr::create(Printer.GetCPISymbol(0), Ctx), Ctx);
+
   return MCOperand::createExpr(Expr);
 }
 
@@ -13,6 +13,7 @@
 #ifndef LLVM_LIB_TARGET_M65832_M65832MACHINEFUNCTIONINFO_H
 #define LLVM_LIB_TARGET_M65832_M65832MACHINEFUNCTIONINFO_H
 
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/CodeGen/MachineFunction.h"
 
 namespace llvm {
@@ -28,6 +29,48 @@ class M65832MachineFunctionInfo : public MachineFunctionInfo {
   /// ReturnAddrIndex - FrameIndex for return slot.
   int ReturnAddrIndex = 0;
 
+  /// ArgumentStackSize - Bytes of incoming stack arguments. A sibling call
+  /// may reuse this area for its own stack arguments.
+  unsigned ArgumentStackSize = 0;
+
+  /// InterruptSavedRegs - A, X, Y and T as pushed by an interrupt handler's
+  /// prologue, in push order. Chosen once by determineCalleeSaves so the
+  /// prologue and every epilogue agree.
+  SmallVector<MCPhysReg, 4> InterruptSavedRegs;
+
+  /// WindowShift - Registers the prologue moves D down by in a windowed
+  /// function, 0 otherwise.
+  unsigned WindowShift = 0;
+
+  /// UsesDataBank - The prologue points B at __data_bank_base, so
+  /// -mcmodel=bank globals are addressed B-relative. Only frameless
+  /// functions do this; B is the frame base otherwise.
+  bool UsesDataBank = false;
+
+  /// UsesLiteralPool - The prologue points B at the function's constant
+  /// pool, so FP constants load B-relative. Frameless functions only, and
+  /// never together with UsesDataBank.
+  bool UsesLiteralPool = false;
+
+  /// SPRelativeFrame - Frame slots are addressed $xx,S, SP plus the
+  /// CalleeSavedFrameSize bytes of GPRs pushed below the locals, so the
+  /// prologue neither saves B nor points it at the frame. Chosen by
+  /// emitPrologue, before the frame indices are replaced.
+  bool SPRelativeFrame = false;
+
+  /// FrameBase - The prologue pointed B at the frame, which the CFA then
+  /// follows. Otherwise the CFA is a fixed offset from SP outside call
+  /// sequences.
+  bool FrameBase = false;
+
+  /// SavedB - The prologue pushed the caller's B, for the epilogue to pull.
+  /// A fastcc function under -m65832-fastcc-caller-saved-b may skip it.
+  bool SavedB = false;
+
+  /// HasPushSequences - Some call pushes its stack arguments instead of
+  /// storing them into a reserved call frame.
+  bool HasPushSequences = false;
+
 public:
   M65832MachineFunctionInfo() = default;
   
@@ -49,6 +92,37 @@ public:
 
   int getReturnAddrIndex() const { return ReturnAddrIndex; }
   void setReturnAddrIndex(int Index) { ReturnAddrIndex = Index; }
+
+  unsigned getArgumentStackSize() const { return ArgumentStackSize; }
+  void setArgumentStackSize(unsigned Size) { ArgumentStackSize = Size; }
+
+  ArrayRef<MCPhysReg> getInterruptSavedRegs() const {
+    return InterruptSavedRegs;
+  }
+  void setInterruptSavedRegs(ArrayRef<MCPhysReg> Regs) {
+    InterruptSavedRegs.assign(Regs.begin(), Regs.end());
+  }
+
+  unsigned getWindowShift() const { return WindowShift; }
+  void setWindowShift(unsigned Regs) { WindowShift = Regs; }
+
+  bool usesDataBank() const { return UsesDataBank; }
+  void setUsesDataBank(bool V) { UsesDataBank = V; }
+
+  bool usesLiteralPool() const { return UsesLiteralPool; }
+  void setUsesLiteralPool(bool V) { UsesLiteralPool = V; }
+
+  bool usesSPRelativeFrame() const { return SPRelativeFrame; }
+  void setSPRelativeFrame(bool V) { SPRelativeFrame = V; }
+
+  bool hasFrameBase() const { return FrameBase; }
+  void setHasFrameBase(bool V) { FrameBase = V; }
+
+  bool savedB() const { return SavedB; }
+  void setSavedB(bool V) { SavedB = V; }
+
+  bool hasPushSequences() const { return HasPushSequences; }
+  void setHasPushSequences(bool V) { HasPushSequences = V; }
 };
 
 } // end namespace llvm
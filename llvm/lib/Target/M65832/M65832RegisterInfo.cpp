@@ -13,12 +13,16 @@
 #include "M65832RegisterInfo.h"
 #include "M65832.h"
 #include "M65832FrameLowering.h"
+#include "M65832MachineFunctionInfo.h"
 #include "M65832Subtarget.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/CodeGen/MachineFrameInfo.h"
 #include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
 #include "llvm/CodeGen/RegisterScavenging.h"
 #include "llvm/CodeGen/TargetInstrInfo.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ErrorHandling.h"
 
 using namespace llvm;
@@ -28,20 +32,100 @@ using namespace llvm;
 #define GET_REGINFO_TARGET_DESC
 #include "M65832GenRegisterInfo.inc"
 
+namespace {
+enum class RegWindow { Base, Full };
+} // end anonymous namespace
+
+static cl::opt<RegWindow> RegWindowOpt(
+    "m65832-reg-window", cl::Hidden, cl::init(RegWindow::Full),
+    cl::desc("GPR window available to the register allocator"),
+    cl::values(clEnumValN(RegWindow::Base, "base", "R0-R23 and R30 only"),
+               clEnumValN(RegWindow::Full, "full",
+                          "Also R32-R47 (caller-saved) and R48-R55 "
+                          "(callee-saved)")));
+
+static cl::opt<unsigned> FastCCSavedGPRs(
+    "m65832-fastcc-saved-gprs", cl::Hidden, cl::init(8),
+    cl::desc("Callee-saved GPRs under fastcc: 0, 4 (R16-R19), 8 (R16-R23) "
+             "or 16 (also R48-R55, as for the C convention)"));
+
+static cl::opt<bool> SpillToFPR(
+    "m65832-spill-to-fpr", cl::Hidden, cl::init(true),
+    cl::desc("Let split GPR live ranges sit in idle FPRs, and f32 ranges in "
+             "free GPRs, instead of stack slots"));
+
+/// The window for MF: the "m65832-reg-window" function attribute if
+/// present, otherwise the command-line default.
+static RegWindow getRegWindow(const MachineFunction &MF) {
+  Attribute Attr = MF.getFunction().getFnAttribute("m65832-reg-window");
+  if (Attr.isStringAttribute()) {
+    StringRef Value = Attr.getValueAsString();
+    if (Value == "base")
+      return RegWindow::Base;
+    if (Value == "full")
+      return RegWindow::Full;
+  }
+  return RegWindowOpt;
+}
+
+bool M65832RegisterInfo::hasFullRegWindow(const MachineFunction &MF) {
+  return getRegWindow(MF) == RegWindow::Full;
+}
+
 M65832RegisterInfo::M65832RegisterInfo(const M65832Subtarget & /*STI*/)
     : M65832GenRegisterInfo(M65832::R30) {} // Return address register
 
 const MCPhysReg *
 M65832RegisterInfo::getCalleeSavedRegs(const MachineFunction *MF) const {
+  if (!MF)
+    return CSR_M65832_SaveList;
+  bool IsInterrupt = MF->getFunction().hasFnAttribute("interrupt");
+  // A windowed function runs in DP below its caller's registers, so only
+  // FPU state is left to save
+  if (MF->getInfo<M65832MachineFunctionInfo>()->getWindowShift() != 0)
+    return IsInterrupt ? CSR_M65832_InterruptWindow_SaveList
+                       : CSR_M65832_Window_SaveList;
+  if (IsInterrupt)
+    return CSR_M65832_Interrupt_SaveList;
+  if (MF->getFunction().getCallingConv() == CallingConv::Fast) {
+    switch (FastCCSavedGPRs) {
+    case 0:
+      return CSR_M65832_Fast0_SaveList;
+    case 4:
+      return CSR_M65832_Fast4_SaveList;
+    case 8:
+      return CSR_M65832_Fast8_SaveList;
+    }
+  }
   return CSR_M65832_SaveList;
 }
 
 const uint32_t *
 M65832RegisterInfo::getCallPreservedMask(const MachineFunction &MF,
                                           CallingConv::ID CC) const {
+  if (CC == CallingConv::Fast) {
+    switch (FastCCSavedGPRs) {
+    case 0:
+      return CSR_M65832_Fast0_RegMask;
+    case 4:
+      return CSR_M65832_Fast4_RegMask;
+    case 8:
+      return CSR_M65832_Fast8_RegMask;
+    }
+  }
   return CSR_M65832_RegMask;
 }
 
+// IPRA collects a callee's clobbers in its own register numbering. A
+// windowed function has moved D, so its R0 is not the caller's R0; report
+// every GPR clobbered rather than a mask that names the wrong slots.
+ArrayRef<MCPhysReg>
+M65832RegisterInfo::getIntraCallClobberedRegs(const MachineFunction *MF) const {
+  if (MF->getInfo<M65832MachineFunctionInfo>()->getWindowShift() != 0)
+    return M65832::GPRRegClass.getRegisters();
+  return {};
+}
+
 BitVector M65832RegisterInfo::getReservedRegs(const MachineFunction &MF) const {
   BitVector Reserved(getNumRegs());
 
@@ -67,10 +151,15 @@ BitVector M65832RegisterInfo::getReservedRegs(const MachineFunction &MF) const {
   Reserved.set(M65832::R28);
   Reserved.set(M65832::R29);
   
-  // Reserved R31
+  // Reserved R31, also the scratch for out-of-range branches
   Reserved.set(M65832::R31);
   
-  // Future reserved registers (R56-R63)
+  // Extended window (R32-R55), when the function is limited to the base one
+  if (getRegWindow(MF) == RegWindow::Base)
+    for (unsigned Reg = M65832::R32; Reg <= M65832::R55; ++Reg)
+      Reserved.set(Reg);
+
+  // Thread pointer (R56) and future reserved registers (R57-R63)
   Reserved.set(M65832::R56);
   Reserved.set(M65832::R57);
   Reserved.set(M65832::R58);
@@ -83,6 +172,99 @@ BitVector M65832RegisterInfo::getReservedRegs(const MachineFunction &MF) const {
   return Reserved;
 }
 
+/// Whether VirtReg may be live across a call. Block-local values are
+/// checked exactly; anything live out of its defining block is assumed to
+/// cross one if the function makes calls at all.
+static bool mayLiveAcrossCall(Register VirtReg, const MachineFunction &MF) {
+  if (!MF.getFrameInfo().hasCalls())
+    return false;
+
+  const MachineRegisterInfo &MRI = MF.getRegInfo();
+  const MachineInstr *Def = MRI.getUniqueVRegDef(VirtReg);
+  if (!Def)
+    return true;
+  const MachineBasicBlock *MBB = Def->getParent();
+
+  SmallPtrSet<const MachineInstr *, 8> Uses;
+  for (const MachineInstr &UseMI : MRI.use_nodbg_instructions(VirtReg)) {
+    if (UseMI.getParent() != MBB || UseMI.isPHI())
+      return true;
+    Uses.insert(&UseMI);
+  }
+
+  for (auto I = std::next(Def->getIterator()), E = MBB->end();
+       I != E && !Uses.empty(); ++I) {
+    Uses.erase(&*I);
+    if (I->isCall() && !Uses.empty())
+      return true;
+  }
+  // A use before the def means the value comes round a loop.
+  return !Uses.empty();
+}
+
+/// Latency of \p Opc in the scheduling model of the CPU being tuned for.
+static unsigned getLatency(const M65832Subtarget &STI, unsigned Opc) {
+  const MCSchedModel &SM = STI.getSchedModel();
+  int Latency = SM.computeInstrLatency(
+      STI, STI.getInstrInfo()->get(Opc).getSchedClass());
+  return Latency > 0 ? Latency : 1;
+}
+
+const TargetRegisterClass *
+M65832RegisterInfo::getLargestLegalSuperClass(const TargetRegisterClass *RC,
+                                              const MachineFunction &MF) const {
+  const auto &STI = MF.getSubtarget<M65832Subtarget>();
+  if (!SpillToFPR || !STI.hasFPU())
+    return RC;
+
+  // Either way the value leaves or enters its register through A, so only
+  // the other end differs: ATOF/FTOA against the STA/LDA B+off of a GPR
+  // spill, and STA/LDA dp against the stack STF.S/LDF.S, which first
+  // build B+off in R0 (TBA; CLC; ADC #off; STA R0).
+  unsigned Transfer = getLatency(STI, M65832::ATOF) +
+                      getLatency(STI, M65832::FTOA);
+  unsigned GPRSlot = getLatency(STI, M65832::STA_ABS) +
+                     getLatency(STI, M65832::LDA_ABS);
+  if (M65832::GPRRegClass.hasSubClassEq(RC))
+    return Transfer < GPRSlot ? &M65832::GPRSpillRegClass : RC;
+
+  if (M65832::FPR32RegClass.hasSubClassEq(RC)) {
+    unsigned SlotAddr = getLatency(STI, M65832::TBA) +
+                        getLatency(STI, M65832::CLC) +
+                        getLatency(STI, M65832::ADC_IMM) +
+                        getLatency(STI, M65832::STA_DP);
+    unsigned FPRSlot = 2 * SlotAddr + getLatency(STI, M65832::STF_S_ind) +
+                       getLatency(STI, M65832::LDF_S_ind);
+    unsigned GPRHome = Transfer + getLatency(STI, M65832::STA_DP) +
+                       getLatency(STI, M65832::LDA_DP);
+    return GPRHome < FPRSlot ? &M65832::FPRSpillRegClass : RC;
+  }
+  return RC;
+}
+
+// Every GPR is a DP slot, so the order among them only matters for the
+// cost of saving them: short-lived values keep the caller-saved-first class
+// order, while values that cross a call go to callee-saved slots first
+// instead of being split and spilled to the B-relative frame around it.
+bool M65832RegisterInfo::getRegAllocationHints(
+    Register VirtReg, ArrayRef<MCPhysReg> Order,
+    SmallVectorImpl<MCPhysReg> &Hints, const MachineFunction &MF,
+    const VirtRegMap *VRM, const LiveRegMatrix *Matrix) const {
+  bool BaseImplRetVal = TargetRegisterInfo::getRegAllocationHints(
+      VirtReg, Order, Hints, MF, VRM, Matrix);
+
+  const MachineRegisterInfo &MRI = MF.getRegInfo();
+  if (!M65832::GPRRegClass.hasSubClassEq(MRI.getRegClass(VirtReg)) ||
+      !mayLiveAcrossCall(VirtReg, MF))
+    return BaseImplRetVal;
+
+  for (MCPhysReg Reg : Order)
+    if (M65832::GPRCalleeSavedRegClass.contains(Reg) &&
+        !is_contained(Hints, Reg))
+      Hints.push_back(Reg);
+  return BaseImplRetVal;
+}
+
 bool M65832RegisterInfo::eliminateFrameIndex(MachineBasicBlock::iterator II,
                                                int SPAdj, unsigned FIOperandNum,
                                                RegScavenger *RS) const {
@@ -95,8 +277,14 @@ bool M65832RegisterInfo::eliminateFrameIndex(MachineBasicBlock::iterator II,
   
   // B is set to the stack pointer after local allocation (bottom of locals).
   // Convert from negative object offsets to B-relative positive offsets.
+  // Without a frame base the same offsets are taken from SP, which the
+  // callee-saved GPR pushes have moved further down. B stays put inside a
+  // call sequence, so only SP-relative offsets follow SPAdj.
+  const auto *FuncInfo = MF.getInfo<M65832MachineFunctionInfo>();
+  bool SPRelative = FuncInfo->usesSPRelativeFrame();
   Offset += MFI.getStackSize();
-  Offset += SPAdj;
+  if (SPRelative)
+    Offset += SPAdj + FuncInfo->getCalleeSavedFrameSize();
   
   // Check if there's an additional offset operand after the frame index
   // This is the case for complex memory operands like memsrc
@@ -123,10 +311,20 @@ bool M65832RegisterInfo::eliminateFrameIndex(MachineBasicBlock::iterator II,
   if (usesBRelAddr) {
     // For B-relative instructions, convert frame index to immediate offset.
     // The B register is already set up to point to the frame base.
+    // canAddressFrameFromSP only allows the LDA/STA forms here; those
+    // become $xx,S.
+    if (SPRelative) {
+      assert(isUInt<8>(Offset) && "frame slot out of $xx,S range");
+      const TargetInstrInfo &TII = *MF.getSubtarget().getInstrInfo();
+      MI.setDesc(TII.get(Opcode == M65832::LDA_ABS ? M65832::LDA_SR
+                                                   : M65832::STA_SR));
+    }
     MI.getOperand(FIOperandNum).ChangeToImmediate(Offset);
   } else {
     // For other instructions, replace frame index with frame register.
-    Register FrameReg = getFrameRegister(MF);
+    // Pseudo expansion picks the $xx,S forms for an SP base.
+    Register FrameReg = SPRelative ? Register(M65832::SP)
+                                   : getFrameRegister(MF);
     MI.getOperand(FIOperandNum).ChangeToRegister(FrameReg, false);
   }
 
@@ -0,0 +1,93 @@
+//===-- M65832SelectionDAGInfo.cpp - M65832 SelectionDAG Info -------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the M65832SelectionDAGInfo class. Small constant-size
+// memcpy/memmove/memset are expanded to word loads and stores by the generic
+// code (bounded by MaxStoresPerMem*); everything that reaches these hooks is
+// turned into an MVN/MVP block move instead of a call into the C library.
+// The exception is a variable-length zero fill, which can call the word-wise
+// __bzero in m65832-stdlib instead of memset.
+//
+//===----------------------------------------------------------------------===//
+
+#include "M65832SelectionDAGInfo.h"
+#include "M65832.h"
+#include "llvm/CodeGen/SelectionDAG.h"
+#include "llvm/CodeGen/TargetLowering.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/Support/CommandLine.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "m65832-selectiondag-info"
+
+static cl::opt<bool> UseBzero(
+    "m65832-bzero", cl::Hidden,
+    cl::desc("Zero variable-length blocks with __bzero rather than memset "
+             "(needs m65832-stdlib)"));
+
+SDValue M65832SelectionDAGInfo::EmitTargetCodeForMemcpy(
+    SelectionDAG &DAG, const SDLoc &dl, SDValue Chain, SDValue Dst,
+    SDValue Src, SDValue Size, Align Alignment, bool isVolatile,
+    bool AlwaysInline, MachinePointerInfo DstPtrInfo,
+    MachinePointerInfo SrcPtrInfo) const {
+  // A non-zero constant length selects BLKMOVE_IMM, which needs neither the
+  // zero check nor a length register.
+  if (auto *C = dyn_cast<ConstantSDNode>(Size))
+    if (C->isZero())
+      return Chain;
+  return DAG.getNode(M65832ISD::BLOCK_MOVE, dl, MVT::Other, Chain, Dst, Src,
+                     Size);
+}
+
+SDValue M65832SelectionDAGInfo::EmitTargetCodeForMemmove(
+    SelectionDAG &DAG, const SDLoc &dl, SDValue Chain, SDValue Dst,
+    SDValue Src, SDValue Size, Align Alignment, bool isVolatile,
+    MachinePointerInfo DstPtrInfo, MachinePointerInfo SrcPtrInfo) const {
+  if (auto *C = dyn_cast<ConstantSDNode>(Size))
+    if (C->isZero())
+      return Chain;
+  return DAG.getNode(M65832ISD::BLOCK_MOVE_SAFE, dl, MVT::Other, Chain, Dst,
+                     Src, Size);
+}
+
+SDValue M65832SelectionDAGInfo::EmitTargetCodeForMemset(
+    SelectionDAG &DAG, const SDLoc &dl, SDValue Chain, SDValue Dst,
+    SDValue Val, SDValue Size, Align Alignment, bool isVolatile,
+    bool AlwaysInline, MachinePointerInfo DstPtrInfo) const {
+  // Store the first byte, then let MVN propagate it by copying the block
+  // onto itself shifted up by one. Only worth it for constant lengths; a
+  // variable length would need its own zero and one checks.
+  auto *C = dyn_cast<ConstantSDNode>(Size);
+  if (!C && UseBzero && isNullConstant(Val)) {
+    const TargetLowering &TLI = DAG.getTargetLoweringInfo();
+    LLVMContext &Ctx = *DAG.getContext();
+    const DataLayout &DL = DAG.getDataLayout();
+    TargetLowering::ArgListTy Args;
+    Args.emplace_back(Dst, PointerType::getUnqual(Ctx));
+    Args.emplace_back(Size, DL.getIntPtrType(Ctx));
+    TargetLowering::CallLoweringInfo CLI(DAG);
+    CLI.setDebugLoc(dl)
+        .setChain(Chain)
+        .setLibCallee(CallingConv::C, Type::getVoidTy(Ctx),
+                      DAG.getExternalSymbol("__bzero", TLI.getPointerTy(DL)),
+                      std::move(Args))
+        .setDiscardResult();
+    return TLI.LowerCallTo(CLI).second;
+  }
+  if (!C || C->getZExtValue() < 2)
+    return SDValue();
+
+  MachineMemOperand::Flags Flags =
+      isVolatile ? MachineMemOperand::MOVolatile : MachineMemOperand::MONone;
+  Chain = DAG.getTruncStore(Chain, dl, Val, Dst, DstPtrInfo, MVT::i8,
+                            Alignment, Flags);
+  SDValue Next = DAG.getMemBasePlusOffset(Dst, TypeSize::getFixed(1), dl);
+  return DAG.getNode(M65832ISD::BLOCK_MOVE, dl, MVT::Other, Chain, Next, Dst,
+                     DAG.getConstant(C->getZExtValue() - 1, dl, MVT::i32));
+}
@@ -0,0 +1,363 @@
+//===-- M65832ShrinkEncodings.cpp - Pick shorter equivalent encodings ----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// The pseudo expansions pick one encoding per pseudo without looking at the
+// surrounding code. Once A and the flags are known to be dead, several of
+// those sequences have shorter equivalents:
+//
+//   LD.L R4,#$00000042     ->  LD.B R4,#$42        (8 -> 5 bytes)
+//   LDA #$00001234         ->  LD.W R4,#$1234      (7 -> 6 bytes)
+//   STA R4
+//   CLC                    ->  INC A               (6 -> 1 byte)
+//   ADC #$00000001
+//   CLC                    ->  INC R4              (9 -> 2 bytes)
+//   ADC R4,#$00000001
+//   CMP.L R4,#$00000000    ->  LDA R4              (8 -> 2 bytes)
+//   BEQ target                 BEQ target
+//
+// When optimizing for size a CMP.L against any other constant also becomes
+// LDA; CMP #imm.
+//
+// Branch displacements are already as short as the 32-bit mode allows
+// (Bcc/BRA rel16), so only operands are shrunk. Like the value tracking
+// pass, nothing inside a fixed-offset inline branch (BEQ *+n) is touched.
+// Savings are reported under -Rpass=m65832-shrink.
+//
+//===----------------------------------------------------------------------===//
+
+#include "M65832.h"
+#include "M65832InstrInfo.h"
+#include "M65832Subtarget.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineOptimizationRemarkEmitter.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/Support/Debug.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "m65832-shrink"
+#define PASS_NAME "M65832 shrink encodings"
+
+STATISTIC(NumShrunk, "Number of instruction sequences shrunk");
+STATISTIC(NumBytesSaved, "Number of code bytes saved by shrinking");
+
+namespace {
+
+/// How the flags an instruction leaves behind are read before being
+/// redefined.
+enum class FlagUse { None, NZOnly, All };
+
+class M65832ShrinkEncodings : public MachineFunctionPass {
+public:
+  static char ID;
+
+  M65832ShrinkEncodings() : MachineFunctionPass(ID) {}
+
+  bool runOnMachineFunction(MachineFunction &MF) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<MachineOptimizationRemarkEmitterPass>();
+    AU.setPreservesCFG();
+    MachineFunctionPass::getAnalysisUsage(AU);
+  }
+
+  MachineFunctionProperties getRequiredProperties() const override {
+    return MachineFunctionProperties().setNoVRegs();
+  }
+
+  StringRef getPassName() const override { return PASS_NAME; }
+
+private:
+  const M65832InstrInfo *TII = nullptr;
+  const TargetRegisterInfo *TRI = nullptr;
+  bool TracksLiveness = false;
+  bool OptSize = false;
+
+  // Per-function totals for the remark.
+  unsigned FnShrunk = 0;
+  int64_t FnBytesSaved = 0;
+
+  FlagUse flagUseAfter(MachineInstr &MI) const;
+  bool regDeadAfter(MachineInstr &MI, Register Reg) const;
+  MachineInstr *shrink(MachineInstr &MI, MachineInstr *Prev);
+  bool processBlock(MachineBasicBlock &MBB);
+};
+
+} // end anonymous namespace
+
+char M65832ShrinkEncodings::ID = 0;
+
+INITIALIZE_PASS_BEGIN(M65832ShrinkEncodings, DEBUG_TYPE, PASS_NAME, false,
+                      false)
+INITIALIZE_PASS_DEPENDENCY(MachineOptimizationRemarkEmitterPass)
+INITIALIZE_PASS_END(M65832ShrinkEncodings, DEBUG_TYPE, PASS_NAME, false,
+                    false)
+
+FunctionPass *llvm::createM65832ShrinkEncodingsPass() {
+  return new M65832ShrinkEncodings();
+}
+
+static bool isInlineBranch(const MachineInstr &MI) {
+  return MI.isBranch() && MI.getNumOperands() && MI.getOperand(0).isImm();
+}
+
+/// Branches that only look at N and Z.
+static bool isNZBranch(unsigned Opc) {
+  return Opc == M65832::BEQ || Opc == M65832::BNE || Opc == M65832::BMI ||
+         Opc == M65832::BPL;
+}
+
+FlagUse M65832ShrinkEncodings::flagUseAfter(MachineInstr &MI) const {
+  MachineBasicBlock &MBB = *MI.getParent();
+  bool ReadsNZ = false;
+  for (MachineBasicBlock::iterator I = std::next(MI.getIterator()),
+                                   E = MBB.end();
+       I != E; ++I) {
+    if (I->isDebugInstr())
+      continue;
+    // A definition the inline branch skips over does not end the range.
+    if (I->isCall() || I->isInlineAsm() || isInlineBranch(*I))
+      return FlagUse::All;
+    if (I->readsRegister(M65832::SR, TRI)) {
+      if (!isNZBranch(I->getOpcode()))
+        return FlagUse::All;
+      ReadsNZ = true;
+    }
+    if (I->definesRegister(M65832::SR, TRI))
+      return ReadsNZ ? FlagUse::NZOnly : FlagUse::None;
+  }
+  if (!TracksLiveness)
+    return FlagUse::All;
+  for (MachineBasicBlock *Succ : MBB.successors())
+    if (Succ->isLiveIn(M65832::SR))
+      return FlagUse::All;
+  return ReadsNZ ? FlagUse::NZOnly : FlagUse::None;
+}
+
+bool M65832ShrinkEncodings::regDeadAfter(MachineInstr &MI,
+                                         Register Reg) const {
+  MachineBasicBlock &MBB = *MI.getParent();
+  for (MachineBasicBlock::iterator I = std::next(MI.getIterator()),
+                                   E = MBB.end();
+       I != E; ++I) {
+    if (I->isDebugInstr())
+      continue;
+    if (I->isCall() || I->isInlineAsm() || isInlineBranch(*I))
+      return false;
+    if (I->readsRegister(Reg, TRI))
+      return false;
+    if (I->definesRegister(Reg, TRI))
+      return true;
+  }
+  if (!TracksLiveness)
+    return false;
+  for (MachineBasicBlock *Succ : MBB.successors())
+    if (Succ->isLiveIn(Reg))
+      return false;
+  return true;
+}
+
+/// Try to replace MI, together with Prev (the instruction before it, or
+/// null), by something shorter. Returns the last new instruction.
+MachineInstr *M65832ShrinkEncodings::shrink(MachineInstr &MI,
+                                            MachineInstr *Prev) {
+  MachineBasicBlock &MBB = *MI.getParent();
+  MachineBasicBlock::iterator I = MI.getIterator();
+  const DebugLoc &DL = MI.getDebugLoc();
+  int64_t OldBytes = MI.getDesc().getSize();
+  int64_t NewBytes = 0;
+  MachineInstr *First = &MI;
+  MachineInstr *Last = nullptr;
+  auto Emit = [&](MachineInstr *New) {
+    NewBytes += New->getDesc().getSize();
+    Last = New;
+  };
+
+  switch (MI.getOpcode()) {
+  default:
+    return nullptr;
+
+  // LD.L Rd,#imm built directly rather than through LI.
+  case M65832::LDR_IMM: {
+    const MachineOperand &Imm = MI.getOperand(1);
+    if (!Imm.isImm() || !isUInt<16>(static_cast<uint32_t>(Imm.getImm())))
+      return nullptr;
+    Emit(TII->loadImmediate(MBB, I, DL, MI.getOperand(0).getReg(),
+                            static_cast<uint32_t>(Imm.getImm())));
+    break;
+  }
+
+  // LDA #imm; STA $dp -> the shortest LD $dp,#imm.
+  case M65832::STA_DP: {
+    if (!Prev || Prev->getOpcode() != M65832::LDA_IMM ||
+        !Prev->getOperand(1).isImm())
+      return nullptr;
+    int64_t DP = MI.getOperand(1).getImm();
+    if (DP < 0 || DP % 4 != 0 || DP / 4 > 63)
+      return nullptr;
+    if (flagUseAfter(MI) != FlagUse::None ||
+        !regDeadAfter(MI, M65832::A))
+      return nullptr;
+    Emit(TII->loadImmediate(
+        MBB, I, DL, M65832::R0 + DP / 4,
+        static_cast<uint32_t>(Prev->getOperand(1).getImm())));
+    First = Prev;
+    OldBytes += Prev->getDesc().getSize();
+    break;
+  }
+
+  // CLC; ADC #n or SEC; SBC #n with |n| <= 2 -> INC A/DEC A, when only N
+  // and Z are read afterwards.
+  case M65832::ADC_IMM:
+  case M65832::SBC_IMM: {
+    bool IsAdd = MI.getOpcode() == M65832::ADC_IMM;
+    if (!Prev || Prev->getOpcode() != (IsAdd ? M65832::CLC : M65832::SEC) ||
+        !MI.getOperand(2).isImm())
+      return nullptr;
+    int64_t N = MI.getOperand(2).getImm();
+    if (N == 0 || N < -2 || N > 2 || flagUseAfter(MI) == FlagUse::All)
+      return nullptr;
+    unsigned Opc = (N > 0) == IsAdd ? M65832::INC_A : M65832::DEC_A;
+    for (int64_t K = 0, E = N < 0 ? -N : N; K != E; ++K)
+      Emit(BuildMI(MBB, I, DL, TII->get(Opc), M65832::A).addReg(M65832::A));
+    First = Prev;
+    OldBytes += Prev->getDesc().getSize();
+    break;
+  }
+
+  // CLC; ADC.L Rd,#n or SEC; SBC.L Rd,#n with |n| <= 2 -> INC/DEC Rd, the
+  // only add on a register that does not go through the carry.
+  case M65832::ADDR_IMM:
+  case M65832::SUBR_IMM: {
+    bool IsAdd = MI.getOpcode() == M65832::ADDR_IMM;
+    if (!Prev || Prev->getOpcode() != (IsAdd ? M65832::CLC : M65832::SEC) ||
+        !MI.getOperand(2).isImm())
+      return nullptr;
+    int64_t N = MI.getOperand(2).getImm();
+    if (N == 0 || N < -2 || N > 2 || flagUseAfter(MI) == FlagUse::All)
+      return nullptr;
+    unsigned Opc = (N > 0) == IsAdd ? M65832::INC_DP : M65832::DEC_DP;
+    unsigned DP =
+        M65832InstrInfo::getDPOffset(MI.getOperand(0).getReg() - M65832::R0);
+    for (int64_t K = 0, E = N < 0 ? -N : N; K != E; ++K)
+      Emit(BuildMI(MBB, I, DL, TII->get(Opc)).addImm(DP));
+    First = Prev;
+    OldBytes += Prev->getDesc().getSize();
+    break;
+  }
+
+  // CMP.L Rn,#0 -> LDA Rn, which sets N and Z the same way.
+  case M65832::CMPR_IMM: {
+    const MachineOperand &Imm = MI.getOperand(1);
+    if (!Imm.isImm() || !regDeadAfter(MI, M65832::A))
+      return nullptr;
+    unsigned DP =
+        M65832InstrInfo::getDPOffset(MI.getOperand(0).getReg() - M65832::R0);
+    if (Imm.getImm() == 0) {
+      if (flagUseAfter(MI) == FlagUse::All)
+        return nullptr;
+      Emit(BuildMI(MBB, I, DL, TII->get(M65832::LDA_DP), M65832::A)
+               .addImm(DP)
+               .addReg(M65832::SR, RegState::ImplicitDefine));
+      break;
+    }
+    // LDA Rn; CMP #imm sets every flag CMP.L does, one byte shorter but one
+    // instruction longer.
+    if (!OptSize)
+      return nullptr;
+    Emit(BuildMI(MBB, I, DL, TII->get(M65832::LDA_DP), M65832::A).addImm(DP));
+    Emit(BuildMI(MBB, I, DL, TII->get(M65832::CMP_IMM))
+             .addReg(M65832::A, RegState::Kill)
+             .add(Imm));
+    break;
+  }
+  }
+
+  assert(Last && NewBytes < OldBytes && "shrinking made the code longer");
+
+  LLVM_DEBUG(dbgs() << "Shrinking (" << OldBytes << " -> " << NewBytes
+                    << " bytes): " << MI);
+  if (First != &MI)
+    First->eraseFromParent();
+  MI.eraseFromParent();
+  ++NumShrunk;
+  NumBytesSaved += OldBytes - NewBytes;
+  ++FnShrunk;
+  FnBytesSaved += OldBytes - NewBytes;
+  return Last;
+}
+
+bool M65832ShrinkEncodings::processBlock(MachineBasicBlock &MBB) {
+  bool Changed = false;
+
+  // Bytes still covered by a fixed-offset inline branch.
+  int64_t Protected = 0;
+  MachineInstr *Prev = nullptr;
+
+  for (MachineInstr &MI : llvm::make_early_inc_range(MBB)) {
+    if (MI.isDebugInstr())
+      continue;
+
+    if (Protected > 0) {
+      Protected -= MI.getDesc().getSize();
+      if (isInlineBranch(MI))
+        Protected = std::max(Protected, MI.getOperand(0).getImm());
+      Prev = nullptr;
+      continue;
+    }
+
+    if (isInlineBranch(MI)) {
+      int64_t Offset = MI.getOperand(0).getImm();
+      if (Offset < 0)
+        return Changed; // Backwards into this block: give up on the rest.
+      Protected = Offset;
+      Prev = nullptr;
+      continue;
+    }
+
+    if (MachineInstr *Last = shrink(MI, Prev)) {
+      Prev = Last;
+      Changed = true;
+      continue;
+    }
+    Prev = &MI;
+  }
+  return Changed;
+}
+
+bool M65832ShrinkEncodings::runOnMachineFunction(MachineFunction &MF) {
+  if (skipFunction(MF.getFunction()))
+    return false;
+
+  const M65832Subtarget &STI = MF.getSubtarget<M65832Subtarget>();
+  TII = STI.getInstrInfo();
+  TRI = STI.getRegisterInfo();
+  TracksLiveness = MF.getRegInfo().tracksLiveness();
+  OptSize = MF.getFunction().hasOptSize();
+  FnShrunk = 0;
+  FnBytesSaved = 0;
+
+  bool Changed = false;
+  for (MachineBasicBlock &MBB : MF)
+    Changed |= processBlock(MBB);
+
+  if (FnShrunk) {
+    auto &ORE = getAnalysis<MachineOptimizationRemarkEmitterPass>().getORE();
+    ORE.emit([&]() {
+      return MachineOptimizationRemark(DEBUG_TYPE, "Shrunk",
+                                       MF.getFunction().getSubprogram(),
+                                       &MF.front())
+             << "shrank " << ore::NV("NumShrunk", FnShrunk)
+             << " instruction sequences, saving "
+             << ore::NV("BytesSaved", FnBytesSaved) << " bytes";
+    });
+  }
+  return Changed;
+}
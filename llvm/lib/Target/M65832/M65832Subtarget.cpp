@@ -11,7 +11,11 @@
 //===----------------------------------------------------------------------===//
 
 #include "M65832Subtarget.h"
+#include "GISel/M65832CallLowering.h"
+#include "GISel/M65832LegalizerInfo.h"
+#include "GISel/M65832RegisterBankInfo.h"
 #include "M65832.h"
+#include "M65832TargetMachine.h"
 #include "llvm/MC/TargetRegistry.h"
 
 using namespace llvm;
@@ -23,19 +27,51 @@ using namespace llvm;
 #include "M65832GenSubtargetInfo.inc"
 
 M65832Subtarget::M65832Subtarget(const Triple &TT, const std::string &CPU,
-                                   const std::string &FS,
-                                   const TargetMachine &TM)
-    : M65832GenSubtargetInfo(TT, CPU, /*TuneCPU*/ CPU, FS),
+                                 const std::string &TuneCPU,
+                                 const std::string &FS,
+                                 const TargetMachine &TM)
+    : M65832GenSubtargetInfo(TT, CPU, TuneCPU, FS),
       TargetTriple(TT),
-      InstrInfo(*this),
+      InstrInfo(initializeSubtargetDependencies(CPU, TuneCPU, FS)),
       FrameLowering(*this),
       TLInfo(TM, *this),
       RegInfo(*this) {
-  
-  // Parse features string
-  std::string CPUName = std::string(CPU);
-  if (CPUName.empty())
-    CPUName = "generic";
-  
-  ParseSubtargetFeatures(CPUName, CPUName, FS);
+  CallLoweringInfo.reset(new M65832CallLowering(*getTargetLowering()));
+  Legalizer.reset(new M65832LegalizerInfo(*this));
+
+  auto *RBI = new M65832RegisterBankInfo(*getRegisterInfo());
+  RegBankInfo.reset(RBI);
+  InstSelector.reset(createM65832InstructionSelector(
+      static_cast<const M65832TargetMachine &>(TM), *this, *RBI));
+}
+
+M65832Subtarget::~M65832Subtarget() = default;
+
+// Features have to be parsed before TLInfo is built, since its constructor
+// picks legal types and operations from them. Without -mtune the CPU's own
+// tuning and scheduling model are used.
+M65832Subtarget &
+M65832Subtarget::initializeSubtargetDependencies(StringRef CPU,
+                                                 StringRef TuneCPU,
+                                                 StringRef FS) {
+  StringRef CPUName = CPU.empty() ? "generic" : CPU;
+  StringRef TuneName = TuneCPU.empty() ? CPUName : TuneCPU;
+  ParseSubtargetFeatures(CPUName, TuneName, FS);
+  return *this;
+}
+
+const CallLowering *M65832Subtarget::getCallLowering() const {
+  return CallLoweringInfo.get();
+}
+
+InstructionSelector *M65832Subtarget::getInstructionSelector() const {
+  return InstSelector.get();
+}
+
+const LegalizerInfo *M65832Subtarget::getLegalizerInfo() const {
+  return Legalizer.get();
+}
+
+const RegisterBankInfo *M65832Subtarget::getRegBankInfo() const {
+  return RegBankInfo.get();
 }
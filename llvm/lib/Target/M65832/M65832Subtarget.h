@@ -18,6 +18,10 @@
 #include "M65832InstrInfo.h"
 #include "M65832RegisterInfo.h"
 #include "M65832SelectionDAGInfo.h"
+#include "llvm/CodeGen/GlobalISel/CallLowering.h"
+#include "llvm/CodeGen/GlobalISel/InstructionSelector.h"
+#include "llvm/CodeGen/GlobalISel/LegalizerInfo.h"
+#include "llvm/CodeGen/RegisterBankInfo.h"
 #include "llvm/CodeGen/TargetSubtargetInfo.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/Target/TargetMachine.h"
@@ -34,8 +38,20 @@ class M65832Subtarget : public M65832GenSubtargetInfo {
   
   // Subtarget features
   bool HasFPU = false;
+  bool HasFPUFMA = false;
+  bool HasFPURound = false;
+  bool HasFPUMinMax = false;
   bool HasHWMul = true;
   bool HasAtomics = true;
+  bool EnableLinkerRelax = false;
+  bool HasUnalignedAccess = false;
+
+  // Bytes per instruction fetch; loops and functions are aligned to it
+  unsigned FetchWidth = 4;
+
+  // Tuning features (-mtune)
+  bool IsDivSlow = false;
+  bool HasFastShifter = false;
 
   M65832InstrInfo InstrInfo;
   M65832FrameLowering FrameLowering;
@@ -43,14 +59,26 @@ class M65832Subtarget : public M65832GenSubtargetInfo {
   M65832SelectionDAGInfo TSInfo;
   M65832RegisterInfo RegInfo;
 
+  // GlobalISel (-global-isel)
+  std::unique_ptr<CallLowering> CallLoweringInfo;
+  std::unique_ptr<InstructionSelector> InstSelector;
+  std::unique_ptr<LegalizerInfo> Legalizer;
+  std::unique_ptr<RegisterBankInfo> RegBankInfo;
+
 public:
   M65832Subtarget(const Triple &TT, const std::string &CPU,
-                   const std::string &FS, const TargetMachine &TM);
+                  const std::string &TuneCPU, const std::string &FS,
+                  const TargetMachine &TM);
+  ~M65832Subtarget() override;
 
   /// ParseSubtargetFeatures - Parses features string setting specified
   /// subtarget options. Defined by tablegen in M65832GenSubtargetInfo.inc.
   void ParseSubtargetFeatures(StringRef CPU, StringRef TuneCPU, StringRef FS);
 
+  M65832Subtarget &initializeSubtargetDependencies(StringRef CPU,
+                                                   StringRef TuneCPU,
+                                                   StringRef FS);
+
   const M65832InstrInfo *getInstrInfo() const override { return &InstrInfo; }
   const M65832FrameLowering *getFrameLowering() const override {
     return &FrameLowering;
@@ -65,9 +93,33 @@ public:
     return &RegInfo;
   }
 
+  const CallLowering *getCallLowering() const override;
+  InstructionSelector *getInstructionSelector() const override;
+  const LegalizerInfo *getLegalizerInfo() const override;
+  const RegisterBankInfo *getRegBankInfo() const override;
+
+  /// Use the MachineScheduler so the M65832Model latencies are honoured.
+  bool enableMachineScheduler() const override { return true; }
+
+  /// Software-pipeline FPU loops on the same latencies, so a dependent
+  /// FADD/FMUL chain overlaps across iterations. Resources come from the
+  /// model rather than a DFA.
+  bool enableMachinePipeliner() const override {
+    return HasFPU && getSchedModel().hasInstrSchedModel();
+  }
+  bool useDFAforSMS() const override { return false; }
+
   bool hasFPU() const { return HasFPU; }
+  bool hasFPUFMA() const { return HasFPUFMA; }
+  bool hasFPURound() const { return HasFPURound; }
+  bool hasFPUMinMax() const { return HasFPUMinMax; }
   bool hasHWMul() const { return HasHWMul; }
   bool hasAtomics() const { return HasAtomics; }
+  bool enableLinkerRelax() const { return EnableLinkerRelax; }
+  bool hasUnalignedAccess() const { return HasUnalignedAccess; }
+  unsigned getFetchWidth() const { return FetchWidth; }
+  bool isDivSlow() const { return IsDivSlow; }
+  bool hasFastShifter() const { return HasFastShifter; }
 };
 
 } // end namespace llvm
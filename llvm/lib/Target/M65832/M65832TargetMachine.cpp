@@ -14,23 +14,63 @@
 #include "M65832.h"
 #include "M65832MachineFunctionInfo.h"
 #include "M65832TargetObjectFile.h"
+#include "M65832TargetTransformInfo.h"
 #include "TargetInfo/M65832TargetInfo.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/CodeGen/GlobalISel/IRTranslator.h"
+#include "llvm/CodeGen/GlobalISel/InstructionSelect.h"
+#include "llvm/CodeGen/GlobalISel/Legalizer.h"
+#include "llvm/CodeGen/GlobalISel/RegBankSelect.h"
 #include "llvm/CodeGen/Passes.h"
 #include "llvm/CodeGen/TargetLoweringObjectFileImpl.h"
 #include "llvm/CodeGen/TargetPassConfig.h"
+#include "llvm/IR/Function.h"
 #include "llvm/MC/TargetRegistry.h"
+#include "llvm/PassRegistry.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Transforms/Scalar.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 
 using namespace llvm;
 
+static cl::opt<cl::boolOrDefault> EnableGlobalMerge(
+    "m65832-global-merge", cl::Hidden,
+    cl::desc("Merge small globals so they share one base address (default: "
+             "on for -fPIC above -O0)"));
+
+static cl::opt<bool> EnableMachinePipeliner(
+    "m65832-enable-pipeliner", cl::Hidden, cl::init(true),
+    cl::desc("Software-pipeline single-block loops on FPU targets"));
+
 extern "C" LLVM_ABI LLVM_EXTERNAL_VISIBILITY void LLVMInitializeM65832Target() {
   // Register the target.
   RegisterTargetMachine<M65832TargetMachine> X(getTheM65832Target());
+
+  PassRegistry &PR = *PassRegistry::getPassRegistry();
+  initializeGlobalISel(PR);
+  initializeM65832CallFrameOptimizationPass(PR);
+  initializeM65832ValueTrackingPass(PR);
+  initializeM65832IndexLoopsPass(PR);
+  initializeM65832ShrinkEncodingsPass(PR);
+  initializeM65832CarryTrackingPass(PR);
 }
 
+// -fPIC and -fPIE give the GOT-free PC-relative model. There is no dynamic
+// loader, so anything else is static.
 static Reloc::Model getEffectiveRelocModel(std::optional<Reloc::Model> RM) {
-  return RM.value_or(Reloc::Static);
+  if (RM == Reloc::PIC_ || RM == Reloc::ROPI || RM == Reloc::ROPI_RWPI)
+    return Reloc::PIC_;
+  return Reloc::Static;
+}
+
+// Tiny is the bank model (clang -mcmodel=bank): .data and .bss fit in one
+// 64K bank at __data_bank_base, so their globals can be reached B-relative.
+static CodeModel::Model
+getEffectiveM65832CodeModel(std::optional<CodeModel::Model> CM) {
+  if (CM == CodeModel::Tiny)
+    return *CM;
+  return getEffectiveCodeModel(CM, CodeModel::Small);
 }
 
 // M65832 data layout:
@@ -51,10 +91,54 @@ M65832TargetMachine::M65832TargetMachine(const Target &T, const Triple &TT,
                                            CodeGenOptLevel OL, bool JIT)
     : CodeGenTargetMachineImpl(T, M65832DataLayout, TT, CPU, FS, Options,
                                getEffectiveRelocModel(RM),
-                               getEffectiveCodeModel(CM, CodeModel::Small), OL),
-      TLOF(std::make_unique<M65832TargetObjectFile>()),
-      Subtarget(TT, std::string(CPU), std::string(FS), *this) {
+                               getEffectiveM65832CodeModel(CM), OL),
+      TLOF(std::make_unique<M65832TargetObjectFile>()) {
   initAsmInfo();
+
+  // Outline repeated sequences in -Oz functions (see
+  // M65832InstrInfo::shouldOutlineFromFunctionByDefault)
+  setMachineOutliner(true);
+  setSupportsDefaultOutlining(true);
+}
+
+const M65832Subtarget *
+M65832TargetMachine::getSubtargetImpl(const Function &F) const {
+  Attribute CPUAttr = F.getFnAttribute("target-cpu");
+  Attribute TuneAttr = F.getFnAttribute("tune-cpu");
+  Attribute FSAttr = F.getFnAttribute("target-features");
+  std::string CPU =
+      CPUAttr.isValid() ? CPUAttr.getValueAsString().str() : TargetCPU;
+  std::string TuneCPU =
+      TuneAttr.isValid() ? TuneAttr.getValueAsString().str() : CPU;
+  std::string FS =
+      FSAttr.isValid() ? FSAttr.getValueAsString().str() : TargetFS;
+
+  auto &I = SubtargetMap[CPU + TuneCPU + FS];
+  if (!I) {
+    resetTargetOptions(F);
+    I = std::make_unique<M65832Subtarget>(TargetTriple, CPU, TuneCPU, FS,
+                                          *this);
+  }
+  return I.get();
+}
+
+// Each partition is compiled with the others' globals as declarations.
+// Everything else the backend decides per global already reads only what
+// SplitModule copies into a declaration: -mcmodel=bank and .dpdata go by
+// section and constness, fastcc and the B convention by the callee's
+// calling convention. Constant pools, jump tables and FP literal pools
+// are per-function and stay with their function.
+bool M65832TargetMachine::splitModule(
+    Module &M, unsigned NumParts,
+    function_ref<void(std::unique_ptr<Module> MPart)> ModuleCallback) {
+  static_cast<M65832TargetObjectFile &>(*TLOF).pinSmallDataSections(M, *this);
+  SplitModule(M, NumParts, ModuleCallback, /*PreserveLocals=*/false);
+  return true;
+}
+
+TargetTransformInfo
+M65832TargetMachine::getTargetTransformInfo(const Function &F) const {
+  return TargetTransformInfo(std::make_unique<M65832TTIImpl>(this, F));
 }
 
 namespace {
@@ -68,8 +152,17 @@ public:
     return getTM<M65832TargetMachine>();
   }
 
+  void addIRPasses() override;
+  bool addPreISel() override;
   bool addInstSelector() override;
+  bool addIRTranslator() override;
+  bool addLegalizeMachineIR() override;
+  bool addRegBankSelect() override;
+  bool addGlobalInstructionSelect() override;
+  bool addILPOpts() override;
+  void addPreRegAlloc() override;
   void addPreEmitPass() override;
+  void addPreEmitPass2() override;
 };
 } // namespace
 
@@ -77,13 +170,94 @@ TargetPassConfig *M65832TargetMachine::createPassConfig(PassManagerBase &PM) {
   return new M65832PassConfig(*this, PM);
 }
 
+void M65832PassConfig::addIRPasses() {
+  addPass(createAtomicExpandLegacyPass());
+  TargetPassConfig::addIRPasses();
+}
+
+bool M65832PassConfig::addPreISel() {
+  // Under -fPIC each global costs an LA_PCREL (12 bytes) before it can be
+  // loaded. Merged, the function materializes one base and reaches the rest
+  // with LDY #off; LDA (base),Y. Static code loads every global with one
+  // LD.L abs32, which an offset folds into for free, so there is nothing
+  // to share. 64K keeps a merged block within one data bank, and globals
+  // under the small-data limit stay out (GlobalMerge reads the same module
+  // flag).
+  bool Enable = EnableGlobalMerge == cl::BOU_UNSET
+                    ? TM->isPositionIndependent() &&
+                          getOptLevel() != CodeGenOptLevel::None
+                    : EnableGlobalMerge == cl::BOU_TRUE;
+  if (Enable)
+    addPass(createGlobalMergePass(TM, 0xFFFF, /*OnlyOptimizeForSize=*/false,
+                                  /*MergeExternalByDefault=*/true));
+  return false;
+}
+
 bool M65832PassConfig::addInstSelector() {
   addPass(createM65832ISelDag(getM65832TargetMachine(), getOptLevel()));
   return false;
 }
 
+// GlobalISel is opt-in (-global-isel); SelectionDAG stays the default and
+// takes over any function the GlobalISel pipeline cannot handle when
+// -global-isel-abort=2 (clang -fglobal-isel)
+bool M65832PassConfig::addIRTranslator() {
+  addPass(new IRTranslator(getOptLevel()));
+  return false;
+}
+
+bool M65832PassConfig::addLegalizeMachineIR() {
+  addPass(new Legalizer());
+  return false;
+}
+
+bool M65832PassConfig::addRegBankSelect() {
+  addPass(new RegBankSelect());
+  return false;
+}
+
+bool M65832PassConfig::addGlobalInstructionSelect() {
+  addPass(new InstructionSelect(getOptLevel()));
+  return false;
+}
+
+bool M65832PassConfig::addILPOpts() {
+  // Rebalance reassociable chains so the two-address FPU ops (and the A
+  // funnel) are not one long dependency
+  addPass(&MachineCombinerID);
+  return true;
+}
+
+void M65832PassConfig::addPreRegAlloc() {
+  // Still in SSA: pushes can take their arguments' virtual registers, and
+  // the pipeliner runs ahead of the two-address pass that ties the FPU
+  // operands
+  if (getOptLevel() != CodeGenOptLevel::None) {
+    addPass(createM65832CallFrameOptimizationPass());
+    if (EnableMachinePipeliner)
+      addPass(&MachinePipelinerID);
+  }
+}
+
 void M65832PassConfig::addPreEmitPass() {
-  // Add any M65832-specific passes before code emission
+  // Clean up redundant A/X/Y/B traffic left behind by the pseudo expansions,
+  // after moving simple loop indices into Y so the reloads it leaves behind
+  // fold away too. Shrinking comes after that, when A is dead as often as
+  // it will get, and then the CLC/SEC it left in front of ADC/SBC that the
+  // carry is already known for are dropped.
+  if (getOptLevel() != CodeGenOptLevel::None) {
+    addPass(createM65832IndexLoopsPass());
+    addPass(createM65832ValueTrackingPass());
+    addPass(createM65832ShrinkEncodingsPass());
+    addPass(createM65832CarryTrackingPass());
+  }
+}
+
+void M65832PassConfig::addPreEmitPass2() {
+  // Runs after the MachineOutliner so that block sizes are final. Bcc/BRA
+  // reach +-32KB; relaxed branches become an inverted Bcc over an absolute
+  // JMP (R31).
+  addPass(&BranchRelaxationPassID);
 }
 
 MachineFunctionInfo *M65832TargetMachine::createMachineFunctionInfo(
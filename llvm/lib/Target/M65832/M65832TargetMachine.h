@@ -14,6 +14,7 @@
 #define LLVM_LIB_TARGET_M65832_M65832TARGETMACHINE_H
 
 #include "M65832Subtarget.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/CodeGen/CodeGenTargetMachineImpl.h"
 #include <optional>
 
@@ -21,7 +22,7 @@ namespace llvm {
 
 class M65832TargetMachine : public CodeGenTargetMachineImpl {
   std::unique_ptr<TargetLoweringObjectFile> TLOF;
-  M65832Subtarget Subtarget;
+  mutable StringMap<std::unique_ptr<M65832Subtarget>> SubtargetMap;
 
 public:
   M65832TargetMachine(const Target &T, const Triple &TT, StringRef CPU,
@@ -30,12 +31,21 @@ public:
                        std::optional<CodeModel::Model> CM,
                        CodeGenOptLevel OL, bool JIT);
 
-  const M65832Subtarget *getSubtargetImpl(const Function &F) const override {
-    return &Subtarget;
-  }
+  /// The subtarget for F's "target-cpu" and "target-features", so that an
+  /// LTO link of m65832 and m65832-fpu objects builds each function for
+  /// its own CPU
+  const M65832Subtarget *getSubtargetImpl(const Function &F) const override;
 
   TargetPassConfig *createPassConfig(PassManagerBase &PM) override;
 
+  /// --lto-partitions: SplitModule, after fixing the small-data placement
+  /// that the partitions would otherwise each decide for themselves
+  bool splitModule(Module &M, unsigned NumParts,
+                   function_ref<void(std::unique_ptr<Module> MPart)>
+                       ModuleCallback) override;
+
+  TargetTransformInfo getTargetTransformInfo(const Function &F) const override;
+
   TargetLoweringObjectFile *getObjFileLowering() const override {
     return TLOF.get();
   }
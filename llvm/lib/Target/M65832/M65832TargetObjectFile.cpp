@@ -7,12 +7,205 @@
 //===----------------------------------------------------------------------===//
 
 #include "M65832TargetObjectFile.h"
+#include "llvm/BinaryFormat/ELF.h"
+#include "llvm/IR/Comdat.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/Module.h"
 #include "llvm/MC/MCContext.h"
+#include "llvm/MC/MCSectionELF.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Target/TargetMachine.h"
 
 using namespace llvm;
 
+static cl::opt<unsigned> SSThresholdOpt(
+    "m65832-ssection-threshold", cl::Hidden,
+    cl::desc("Small data and bss section threshold size (default=0, off)"));
+
 void M65832TargetObjectFile::Initialize(MCContext &Ctx,
                                           const TargetMachine &TM) {
   TargetLoweringObjectFileELF::Initialize(Ctx, TM);
+
+  SmallDataSection = getContext().getELFSection(
+      ".sdata", ELF::SHT_PROGBITS, ELF::SHF_WRITE | ELF::SHF_ALLOC);
+  SmallBSSSection = getContext().getELFSection(".sbss", ELF::SHT_NOBITS,
+                                               ELF::SHF_WRITE | ELF::SHF_ALLOC);
+  SmallRODataSection =
+      getContext().getELFSection(".srodata", ELF::SHT_PROGBITS, ELF::SHF_ALLOC);
+  SSThreshold = SSThresholdOpt;
+}
+
+/// -m65832-ssection-threshold, else the "SmallDataLimit" module flag
+static unsigned getSmallDataLimit(const Module &M) {
+  if (SSThresholdOpt.getNumOccurrences())
+    return SSThresholdOpt;
+  if (auto *Limit = mdconst::extract_or_null<ConstantInt>(
+          M.getModuleFlag("SmallDataLimit")))
+    return Limit->getZExtValue();
+  return SSThresholdOpt;
+}
+
+void M65832TargetObjectFile::getModuleMetadata(Module &M) {
+  TargetLoweringObjectFileELF::getModuleMetadata(M);
+  SSThreshold = getSmallDataLimit(M);
+}
+
+/// .sdata and .sbss, or one of their -fdata-sections subsections
+static bool isSmallDataSectionName(StringRef Section) {
+  for (StringRef Name : {".sdata", ".sbss"})
+    if (Section == Name ||
+        (Section.starts_with(Name) && Section[Name.size()] == '.'))
+      return true;
+  return false;
+}
+
+bool M65832TargetObjectFile::isGlobalInSmallSection(
+    const GlobalObject *GO, const TargetMachine &TM) const {
+  const auto *GVA = dyn_cast<GlobalVariable>(GO);
+  if (!GVA || GVA->isThreadLocal())
+    return false;
+
+  // An explicit .sdata/.sbss placement counts whatever the size, and for
+  // a declaration too; any other explicit section does not
+  if (GVA->hasSection())
+    return isSmallDataSectionName(GVA->getSection());
+
+  // The definition that wins at link time has to be this one, or it may not
+  // be in small data at all
+  if (GVA->isDeclarationForLinker() || GVA->isInterposable() ||
+      GVA->hasCommonLinkage())
+    return false;
+
+  Type *Ty = GVA->getValueType();
+  if (!Ty->isSized())
+    return false;
+  uint64_t Size = GVA->getDataLayout().getTypeAllocSize(Ty);
+  return Size > 0 && Size <= SSThreshold;
+}
+
+void M65832TargetObjectFile::pinSmallDataSections(Module &M,
+                                                  const TargetMachine &TM) {
+  SSThreshold = getSmallDataLimit(M);
+  if (SSThreshold == 0)
+    return;
+
+  // Small constants are still placed by their definer alone; the other
+  // partitions reach them 32-bit absolute, which is always correct
+  for (GlobalVariable &GV : M.globals()) {
+    if (GV.hasSection() || !isGlobalInSmallSection(&GV, TM))
+      continue;
+    SectionKind Kind = getKindForGlobal(&GV, TM);
+    StringRef Prefix;
+    if (Kind.isBSS())
+      Prefix = ".sbss";
+    else if (Kind.isData())
+      Prefix = ".sdata";
+    else
+      continue;
+    if (TM.getDataSections())
+      GV.setSection((Prefix + "." + GV.getName()).str());
+    else
+      GV.setSection(Prefix);
+  }
+}
+
+bool M65832TargetObjectFile::isGlobalInDataBank(const GlobalObject *GO,
+                                                const TargetMachine &TM) const {
+  // The bank model is CodeModel::Tiny, which the driver's -mcmodel=bank maps to
+  if (TM.getCodeModel() != CodeModel::Tiny)
+    return false;
+
+  // The linker keeps .data and .bss (small data included) inside the bank;
+  // constants and TLS live elsewhere
+  const auto *GVA = dyn_cast<GlobalVariable>(GO);
+  if (!GVA || GVA->isThreadLocal() || GVA->isConstant())
+    return false;
+
+  if (GVA->hasSection()) {
+    StringRef Section = GVA->getSection();
+    return Section.starts_with(".data") || Section.starts_with(".bss") ||
+           Section.starts_with(".sdata") || Section.starts_with(".sbss");
+  }
+  return true;
+}
+
+bool M65832TargetObjectFile::isGlobalInDirectPage(
+    const GlobalObject *GO) const {
+  const auto *GVA = dyn_cast<GlobalVariable>(GO);
+  if (!GVA || GVA->isThreadLocal() || !GVA->hasSection())
+    return false;
+  StringRef Section = GVA->getSection();
+  return Section == ".dpdata" || Section.starts_with(".dpdata.");
+}
+
+MCSection *M65832TargetObjectFile::SelectSectionForGlobal(
+    const GlobalObject *GO, SectionKind Kind, const TargetMachine &TM) const {
+  if (isGlobalInSmallSection(GO, TM)) {
+    // One section per object under -fdata-sections, like .data.<name>
+    bool Unique = TM.getDataSections() && !GO->hasSection();
+    StringRef Prefix;
+    MCSection *Section = nullptr;
+    unsigned Type = ELF::SHT_PROGBITS;
+    unsigned Flags = ELF::SHF_ALLOC;
+    if (Kind.isBSS()) {
+      Prefix = ".sbss.";
+      Section = SmallBSSSection;
+      Type = ELF::SHT_NOBITS;
+      Flags |= ELF::SHF_WRITE;
+    } else if (Kind.isData()) {
+      Prefix = ".sdata.";
+      Section = SmallDataSection;
+      Flags |= ELF::SHF_WRITE;
+    } else if (Kind.isReadOnly()) {
+      Prefix = ".srodata.";
+      Section = SmallRODataSection;
+    }
+
+    if (Section) {
+      if (!Unique)
+        return Section;
+      return getContext().getELFSection(Prefix + GO->getName(), Type, Flags);
+    }
+  }
+
+  return TargetLoweringObjectFileELF::SelectSectionForGlobal(GO, Kind, TM);
+}
+
+MCSection *
+M65832TargetObjectFile::getSectionForConstantPool(const Function &F,
+                                                  const TargetMachine &TM) const {
+  // Like getSectionForJumpTable: a pool in the shared .rodata would keep
+  // every constant of a dead function alive under --gc-sections
+  const Comdat *C = F.getComdat();
+  if (!TM.getFunctionSections() && !C)
+    return getReadOnlySection();
+
+  unsigned Flags = ELF::SHF_ALLOC;
+  StringRef Group;
+  bool IsComdat = false;
+  if (C) {
+    Flags |= ELF::SHF_GROUP;
+    Group = C->getName();
+    IsComdat = C->getSelectionKind() == Comdat::Any;
+  }
+  return getContext().getELFSection(".rodata." + F.getName(),
+                                    ELF::SHT_PROGBITS, Flags, 0, Group,
+                                    IsComdat);
+}
+
+MCSection *
+M65832TargetObjectFile::getCycleInfoSection(const MCSection &TextSec) const {
+  const auto &ElfSec = static_cast<const MCSectionELF &>(TextSec);
+  unsigned Flags = ELF::SHF_LINK_ORDER;
+  StringRef GroupName;
+  if (const MCSymbol *Group = ElfSec.getGroup()) {
+    GroupName = Group->getName();
+    Flags |= ELF::SHF_GROUP;
+  }
+  return getContext().getELFSection(
+      ".m65832.cycles", ELF::SHT_PROGBITS, Flags, 0, GroupName, true,
+      ElfSec.getUniqueID(),
+      static_cast<const MCSymbolELF *>(TextSec.getBeginSymbol()));
 }
@@ -14,8 +14,53 @@
 namespace llvm {
 
 class M65832TargetObjectFile : public TargetLoweringObjectFileELF {
+  MCSection *SmallDataSection;
+  MCSection *SmallBSSSection;
+  MCSection *SmallRODataSection;
+  /// Largest object placed in .sdata/.sbss/.srodata; 0 disables small data.
+  /// Set from the "SmallDataLimit" module flag (-msmall-data-limit=).
+  unsigned SSThreshold = 0;
+
 public:
   void Initialize(MCContext &Ctx, const TargetMachine &TM) override;
+
+  void getModuleMetadata(Module &M) override;
+
+  /// True if \p GO is defined here in .sdata/.sbss/.srodata, or declared
+  /// with an explicit .sdata/.sbss section, so loads and stores may address
+  /// it relative to the global pointer.
+  bool isGlobalInSmallSection(const GlobalObject *GO,
+                              const TargetMachine &TM) const;
+
+  /// Give each writable small-data definition in \p M the .sdata/.sbss
+  /// section SelectSectionForGlobal would pick for it. Run before splitting
+  /// \p M into LTO partitions, which see each other's globals only as
+  /// declarations, so that they still reach them relative to R28.
+  void pinSmallDataSections(Module &M, const TargetMachine &TM);
+
+  /// True if \p GO is writable data that -mcmodel=bank places in the 64K
+  /// bank at __data_bank_base, so it can be addressed B-relative.
+  bool isGlobalInDataBank(const GlobalObject *GO,
+                          const TargetMachine &TM) const;
+
+  /// True if \p GO is in .dpdata (__attribute__((dp))), which the linker
+  /// maps into unallocated direct-page slots.
+  bool isGlobalInDirectPage(const GlobalObject *GO) const;
+
+  MCSection *SelectSectionForGlobal(const GlobalObject *GO, SectionKind Kind,
+                                    const TargetMachine &TM) const override;
+
+  /// Section for a constant pool addressed B-relative from its first
+  /// entry, which has to stay contiguous rather than be spread over the
+  /// mergeable .rodata.cstN sections. \p F's own .rodata.<name> when \p F
+  /// may be removed on its own (-ffunction-sections or a comdat), so that
+  /// the pool is collected with it; the shared .rodata otherwise.
+  MCSection *getSectionForConstantPool(const Function &F,
+                                       const TargetMachine &TM) const;
+
+  /// .m65832.cycles section for the functions in \p TextSec, linked to it
+  /// the way .stack_sizes is so --gc-sections drops both together.
+  MCSection *getCycleInfoSection(const MCSection &TextSec) const;
 };
 
 } // end namespace llvm
@@ -0,0 +1,393 @@
+//===-- M65832TargetTransformInfo.cpp - M65832 specific TTI ---------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "M65832TargetTransformInfo.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Support/MathExtras.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "m65832tti"
+
+// Allocatable GPRs: R0-R23, R30, R32-R55 (see M65832RegisterInfo.td and
+// getReservedRegs). All of them live in the DP register window.
+static constexpr unsigned NumAllocatableGPRs = 49;
+
+unsigned M65832TTIImpl::getNumberOfRegisters(unsigned ClassID) const {
+  // v4i8 and v2i16 are SWAR values in the same GPRs as the scalars
+  return NumAllocatableGPRs;
+}
+
+TypeSize
+M65832TTIImpl::getRegisterBitWidth(TargetTransformInfo::RegisterKind K) const {
+  switch (K) {
+  case TargetTransformInfo::RGK_Scalar:
+    return TypeSize::getFixed(32);
+  case TargetTransformInfo::RGK_FixedWidthVector:
+    return TypeSize::getFixed(32);
+  case TargetTransformInfo::RGK_ScalableVector:
+    return TypeSize::getScalable(0);
+  }
+  llvm_unreachable("Unsupported register kind");
+}
+
+TTI::PopcntSupportKind M65832TTIImpl::getPopcntSupport(unsigned TyWidth) const {
+  // POPCNT is a single $02 $99 extend op on a 32-bit register.
+  assert(isPowerOf2_32(TyWidth) && "Type width must be power of 2");
+  return TyWidth <= 32 ? TTI::PSK_FastHardware : TTI::PSK_Software;
+}
+
+unsigned M65832TTIImpl::getOpcodeLatency(unsigned Opcode) const {
+  unsigned SchedClass = ST->getInstrInfo()->get(Opcode).getSchedClass();
+  int Latency = ST->getSchedModel().computeInstrLatency(*ST, SchedClass);
+  return Latency > 0 ? Latency : 1;
+}
+
+InstructionCost
+M65832TTIImpl::getEncodedSizeCost(ArrayRef<unsigned> Opcodes) const {
+  // Encoded bytes, counted in units of one register-to-register extended
+  // ALU op (5 bytes), which is the instruction the generic thresholds have
+  // in mind for TCC_Basic
+  const TargetInstrInfo *TII = ST->getInstrInfo();
+  unsigned Bytes = 0;
+  for (unsigned Opcode : Opcodes)
+    Bytes += TII->get(Opcode).getSize();
+  return divideCeil(Bytes, TII->get(M65832::ADDR_DP).getSize());
+}
+
+InstructionCost M65832TTIImpl::getLibcallSizeCost() const {
+  // Operands into R0/R1, JSR, result out of R0
+  return getEncodedSizeCost(
+      {M65832::MOVR_DP, M65832::MOVR_DP, M65832::JSR, M65832::MOVR_DP});
+}
+
+bool M65832TTIImpl::hasDivRemOp(Type *DataType, bool IsSigned) const {
+  // DIV/DIVU leave the quotient in A and the remainder in T.
+  if (!ST->hasHWMul())
+    return false;
+  return DataType->isIntegerTy() && DataType->getIntegerBitWidth() <= 32;
+}
+
+InstructionCost M65832TTIImpl::getBranchMispredictPenalty() const {
+  return ST->getSchedModel().MispredictPenalty;
+}
+
+InstructionCost M65832TTIImpl::getIntImmCost(const APInt &Imm, Type *Ty,
+                                             TTI::TargetCostKind CostKind) const {
+  assert(Ty->isIntegerTy());
+  unsigned BitSize = Ty->getPrimitiveSizeInBits();
+  // There is no cost model for constants with a bit size of 0. Return
+  // TCC_Free here, so that constant hoisting will ignore this constant.
+  if (BitSize == 0)
+    return TTI::TCC_Free;
+  // STZ and the immediate ALU forms cover zero for free.
+  if (Imm == 0)
+    return TTI::TCC_Free;
+  // ALU immediates are full 32-bit fields (*_IMM are 8 bytes against 5 for
+  // the register form), and one LI (LD.B/LD.W/LD.L) materialises any
+  // 32-bit value. Wider constants need one LD per 32-bit part.
+  if (BitSize <= 32)
+    return TTI::TCC_Basic;
+  return divideCeil(BitSize, 32) * TTI::TCC_Basic;
+}
+
+InstructionCost
+M65832TTIImpl::getIntImmCostInst(unsigned Opc, unsigned Idx, const APInt &Imm,
+                                 Type *Ty, TTI::TargetCostKind CostKind,
+                                 Instruction *Inst) const {
+  // The immediate ALU forms and CMPR #imm accept any 32-bit value directly,
+  // so hoisting only pays off for size: three bytes per reuse. A load or
+  // store at a fixed address is a single LD/ST abs32 (8 bytes); a hoisted
+  // base would cost LDY #off; LDA (base),Y; STA per access on top of the LI,
+  // so MMIO addresses are left in place too.
+  unsigned BitSize = Ty->getPrimitiveSizeInBits();
+  if (BitSize == 0 || BitSize > 32)
+    return getIntImmCost(Imm, Ty, CostKind);
+  switch (Opc) {
+  case Instruction::Add:
+  case Instruction::Sub:
+  case Instruction::And:
+  case Instruction::Or:
+  case Instruction::Xor:
+  case Instruction::ICmp:
+  case Instruction::Shl:
+  case Instruction::LShr:
+  case Instruction::AShr:
+  case Instruction::Load:
+  case Instruction::Store:
+    return TTI::TCC_Free;
+  default:
+    return getIntImmCost(Imm, Ty, CostKind);
+  }
+}
+
+InstructionCost
+M65832TTIImpl::getIntImmCostIntrin(Intrinsic::ID IID, unsigned Idx,
+                                   const APInt &Imm, Type *Ty,
+                                   TTI::TargetCostKind CostKind) const {
+  return getIntImmCost(Imm, Ty, CostKind);
+}
+
+InstructionCost M65832TTIImpl::getArithmeticInstrCost(
+    unsigned Opcode, Type *Ty, TTI::TargetCostKind CostKind,
+    TTI::OperandValueInfo Op1Info, TTI::OperandValueInfo Op2Info,
+    ArrayRef<const Value *> Args, const Instruction *CxtI) const {
+  std::pair<InstructionCost, MVT> LT = getTypeLegalizationCost(Ty);
+  int ISD = TLI->InstructionOpcodeToISD(Opcode);
+
+  // Latency numbers come from the -mtune CPU's scheduling model; size
+  // numbers are the encoded bytes of the expansions in M65832InstrInfo,
+  // or of the call when there is no multiplier.
+  switch (ISD) {
+  default:
+    break;
+  case ISD::MUL:
+    if (LT.second != MVT::i32)
+      break;
+    if (CostKind == TTI::TCK_CodeSize)
+      return (ST->hasHWMul() ? getEncodedSizeCost({M65832::LDA_DP,
+                                                    M65832::MUL_DP,
+                                                    M65832::STA_DP})
+                             : getLibcallSizeCost()) *
+             LT.first;
+    if (!ST->hasHWMul())
+      return 32 * LT.first; // MUL_LOOP, one pass per multiplier bit
+    return getOpcodeLatency(M65832::MUL_GPR) * LT.first;
+  case ISD::SDIV:
+  case ISD::UDIV:
+  case ISD::SREM:
+  case ISD::UREM:
+    if (LT.second != MVT::i32)
+      break;
+    if (CostKind == TTI::TCK_CodeSize) {
+      if (!ST->hasHWMul())
+        return getLibcallSizeCost() * LT.first;
+      // The remainder is read back from T
+      if (ISD == ISD::SREM || ISD == ISD::UREM)
+        return getEncodedSizeCost({M65832::LDA_DP, M65832::DIVU_DP,
+                                   M65832::TTA, M65832::STA_DP}) *
+               LT.first;
+      return getEncodedSizeCost(
+                 {M65832::LDA_DP, M65832::DIVU_DP, M65832::STA_DP}) *
+             LT.first;
+    }
+    if (!ST->hasHWMul())
+      return 64 * LT.first; // __divsi3 and friends
+    return getOpcodeLatency(M65832::UDIV_GPR) * LT.first;
+  case ISD::AND:
+  case ISD::OR:
+  case ISD::XOR:
+  case ISD::ADD:
+  case ISD::SUB: {
+    // SWAR lanes: the i32 operation, plus for add and sub the masks that
+    // keep carries inside a lane (LowerSWAR_ADDSUB)
+    if (LT.second != MVT::v4i8 && LT.second != MVT::v2i16)
+      break;
+    unsigned NumOps = ISD == ISD::ADD ? 6 : ISD == ISD::SUB ? 7 : 1;
+    return NumOps *
+           BaseT::getArithmeticInstrCost(
+               Opcode, Type::getInt32Ty(Ty->getContext()), CostKind) *
+           LT.first;
+  }
+  case ISD::FDIV:
+    if (!ST->hasFPU())
+      break;
+    if (CostKind == TTI::TCK_CodeSize)
+      return LT.first;
+    return getOpcodeLatency(LT.second == MVT::f64 ? M65832::FDIV_D
+                                                  : M65832::FDIV_S) *
+           LT.first;
+  case ISD::FADD:
+  case ISD::FSUB:
+  case ISD::FMUL:
+    if (!ST->hasFPU())
+      break;
+    if (CostKind == TTI::TCK_CodeSize)
+      return LT.first;
+    return getOpcodeLatency(ISD == ISD::FMUL ? M65832::FMUL_S
+                                             : M65832::FADD_S) *
+           LT.first;
+  }
+
+  return BaseT::getArithmeticInstrCost(Opcode, Ty, CostKind, Op1Info, Op2Info,
+                                       Args, CxtI);
+}
+
+InstructionCost M65832TTIImpl::getMemoryOpCost(unsigned Opcode, Type *Src,
+                                               Align Alignment,
+                                               unsigned AddressSpace,
+                                               TTI::TargetCostKind CostKind,
+                                               TTI::OperandValueInfo OpInfo,
+                                               const Instruction *I) const {
+  InstructionCost BaseCost = BaseT::getMemoryOpCost(
+      Opcode, Src, Alignment, AddressSpace, CostKind, OpInfo, I);
+  // SWAR vectors are loaded and stored as the i32 they live in
+  bool IsSWAR = Src->isVectorTy() &&
+                Src->getPrimitiveSizeInBits().getFixedValue() == 32;
+  if ((Src->isVectorTy() && !IsSWAR) || !BaseCost.isValid())
+    return BaseCost;
+
+  // LOAD32/STORE32 and friends go through A: LDA/STA against B+abs or
+  // (Rn),Y plus the STA/LDA to the DP register. Sub-word loads also need
+  // the extend, and FPU accesses need the address in a GPR first.
+  InstructionCost PerPart = 2;
+  if (CostKind != TTI::TCK_CodeSize && Opcode == Instruction::Load)
+    PerPart = ST->getSchedModel().LoadLatency;
+  unsigned Bits = Src->getPrimitiveSizeInBits().getFixedValue();
+  if (Src->isIntegerTy() && Bits < 32)
+    PerPart += 1;
+  return BaseCost * PerPart;
+}
+
+InstructionCost M65832TTIImpl::getCFInstrCost(unsigned Opcode,
+                                              TTI::TargetCostKind CostKind,
+                                              const Instruction *I) const {
+  if (Opcode != Instruction::Br || CostKind == TTI::TCK_RecipThroughput)
+    return BaseT::getCFInstrCost(Opcode, CostKind, I);
+
+  // Conditional branches are a CMPR plus a 3-byte Bcc; unconditional ones
+  // are a single BRA, and fallthroughs are free.
+  if (I && cast<BranchInst>(I)->isConditional())
+    return 2 * TTI::TCC_Basic;
+  return TTI::TCC_Basic;
+}
+
+InstructionCost M65832TTIImpl::getCmpSelInstrCost(
+    unsigned Opcode, Type *ValTy, Type *CondTy, CmpInst::Predicate VecPred,
+    TTI::TargetCostKind CostKind, TTI::OperandValueInfo Op1Info,
+    TTI::OperandValueInfo Op2Info, const Instruction *I) const {
+  if (ValTy->isVectorTy())
+    return BaseT::getCmpSelInstrCost(Opcode, ValTy, CondTy, VecPred, CostKind,
+                                     Op1Info, Op2Info, I);
+
+  std::pair<InstructionCost, MVT> LT = getTypeLegalizationCost(ValTy);
+
+  // There is no conditional move: SELECT_CC and SETCC are expanded by the
+  // custom inserter into a compare, a branch and a copy on each side.
+  if (Opcode == Instruction::Select) {
+    if (CostKind == TTI::TCK_CodeSize && ValTy->isIntegerTy())
+      return getEncodedSizeCost({M65832::CMPR_DP, M65832::MOVR_DP,
+                                 M65832::BEQ, M65832::MOVR_DP}) *
+             LT.first;
+    return 4 * LT.first;
+  }
+  if (Opcode == Instruction::ICmp || Opcode == Instruction::FCmp) {
+    // A compare feeding only a branch folds into CMP_BR_CC.
+    if (I && I->hasOneUse() && isa<BranchInst>(*I->user_begin()))
+      return LT.first;
+    return 3 * LT.first;
+  }
+  return BaseT::getCmpSelInstrCost(Opcode, ValTy, CondTy, VecPred, CostKind,
+                                   Op1Info, Op2Info, I);
+}
+
+TTI::MemCmpExpansionOptions
+M65832TTIImpl::enableMemCmpExpansion(bool OptSize, bool IsZeroCmp) const {
+  // Expansion loads at whatever alignment the pointers have; without
+  // unaligned-access each misaligned word would be split into bytes.
+  TTI::MemCmpExpansionOptions Options;
+  if (!ST->hasUnalignedAccess())
+    return Options;
+
+  // Ordered results byte-swap each word pair (BSWAP is one instruction)
+  // and compare them unsigned. Equality-only compares OR the XORs of a
+  // whole block together, so a small key costs one branch.
+  Options.MaxNumLoads = TLI->getMaxExpandSizeMemcmp(OptSize);
+  Options.NumLoadsPerBlock = IsZeroCmp ? Options.MaxNumLoads : 1;
+  Options.LoadSizes = {4, 2, 1};
+  Options.AllowOverlappingLoads = true;
+  Options.AllowedTailExpansions = {3};
+  return Options;
+}
+
+bool M65832TTIImpl::isLegalAddressingMode(Type *Ty, GlobalValue *BaseGV,
+                                          int64_t BaseOffset, bool HasBaseReg,
+                                          int64_t Scale, unsigned AddrSpace,
+                                          Instruction *I,
+                                          int64_t ScalableOffset) const {
+  if (ScalableOffset)
+    return false;
+
+  // Absolute: B+abs for globals, optionally with a constant offset.
+  if (BaseGV)
+    return !HasBaseReg && Scale == 0;
+
+  // No scaled index: (Rn),Y only adds a byte offset held in Y.
+  if (Scale > 1 || Scale < 0)
+    return false;
+  // reg+reg is (Rn),Y with Y loaded from the second register.
+  if (Scale == 1)
+    return HasBaseReg ? BaseOffset == 0 : true;
+
+  // reg+imm is (Rn),Y with Y loaded by LDY #imm; selectAddr folds any
+  // 32-bit displacement.
+  return isInt<32>(BaseOffset);
+}
+
+InstructionCost M65832TTIImpl::getScalingFactorCost(Type *Ty,
+                                                    GlobalValue *BaseGV,
+                                                    StackOffset BaseOffset,
+                                                    bool HasBaseReg,
+                                                    int64_t Scale,
+                                                    unsigned AddrSpace) const {
+  // Y-indexed forms cost the same LDY whether Y comes from #imm or from the
+  // index register, so an unscaled index is free. Use this class's own
+  // isLegalAddressingMode; the BasicTTI default would ask TargetLowering.
+  if (!isLegalAddressingMode(Ty, BaseGV, BaseOffset.getFixed(), HasBaseReg,
+                             Scale, AddrSpace, /*I=*/nullptr,
+                             BaseOffset.getScalable()))
+    return InstructionCost::getInvalid();
+  return 0;
+}
+
+bool M65832TTIImpl::isLSRCostLess(const TTI::LSRCost &C1,
+                                  const TTI::LSRCost &C2) const {
+  // GPRs are plentiful; what hurts is the number of instructions funnelled
+  // through A to update induction variables and form addresses.
+  return std::tie(C1.Insns, C1.NumBaseAdds, C1.AddRecCost, C1.NumIVMuls,
+                  C1.NumRegs, C1.ScaleCost, C1.ImmCost, C1.SetupCost) <
+         std::tie(C2.Insns, C2.NumBaseAdds, C2.AddRecCost, C2.NumIVMuls,
+                  C2.NumRegs, C2.ScaleCost, C2.ImmCost, C2.SetupCost);
+}
+
+void M65832TTIImpl::getUnrollingPreferences(
+    Loop *L, ScalarEvolution &SE, TTI::UnrollingPreferences &UP,
+    OptimizationRemarkEmitter *ORE) const {
+  // The core has a small instruction cache and no branch predictor worth
+  // feeding, so only unroll small loops fully and avoid partial/runtime
+  // unrolling that duplicates bodies the cache cannot hold.
+  UP.Partial = false;
+  UP.Runtime = false;
+  UP.UpperBound = false;
+  UP.Threshold = 60;
+  UP.MaxPercentThresholdBoost = 150;
+  UP.PartialThreshold = 0;
+  UP.OptSizeThreshold = 0;
+  UP.PartialOptSizeThreshold = 0;
+  UP.MaxCount = 4;
+  UP.FullUnrollMaxCount = 8;
+
+  // Loops containing calls gain nothing from unrolling.
+  for (BasicBlock *BB : L->blocks())
+    for (Instruction &I : *BB)
+      if (isa<CallBase>(I) && !isa<IntrinsicInst>(I)) {
+        UP.Threshold = 0;
+        return;
+      }
+}
+
+void M65832TTIImpl::getPeelingPreferences(Loop *L, ScalarEvolution &SE,
+                                          TTI::PeelingPreferences &PP) const {
+  BaseT::getPeelingPreferences(L, SE, PP);
+  // Peeling copies the loop body as well; keep it to loops the unroller
+  // would have considered and never across nests.
+  PP.AllowLoopNestsPeeling = false;
+  if (L->getHeader()->getParent()->hasOptSize())
+    PP.AllowPeeling = false;
+}
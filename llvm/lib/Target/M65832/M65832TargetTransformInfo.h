@@ -0,0 +1,132 @@
+//===-- M65832TargetTransformInfo.h - M65832 specific TTI -------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a TargetTransformInfoImplBase conforming object specific
+// to the M65832 target machine. Costs are derived from the encodings emitted
+// by M65832MCCodeEmitter and the pseudo expansions in M65832InstrInfo, so the
+// middle end sees that memory and A/X/Y traffic is more expensive than the
+// register-to-register extended ALU.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_M65832_M65832TARGETTRANSFORMINFO_H
+#define LLVM_LIB_TARGET_M65832_M65832TARGETTRANSFORMINFO_H
+
+#include "M65832Subtarget.h"
+#include "M65832TargetMachine.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/CodeGen/BasicTTIImpl.h"
+#include "llvm/CodeGen/TargetLowering.h"
+
+namespace llvm {
+
+class M65832TTIImpl final : public BasicTTIImplBase<M65832TTIImpl> {
+  typedef BasicTTIImplBase<M65832TTIImpl> BaseT;
+  typedef TargetTransformInfo TTI;
+  friend BaseT;
+
+  const M65832Subtarget *ST;
+  const M65832TargetLowering *TLI;
+
+  const M65832Subtarget *getST() const { return ST; }
+  const M65832TargetLowering *getTLI() const { return TLI; }
+
+  /// Latency of \p Opcode in the tuned CPU's scheduling model
+  unsigned getOpcodeLatency(unsigned Opcode) const;
+  /// TCK_CodeSize cost of the instruction sequence \p Opcodes
+  InstructionCost getEncodedSizeCost(ArrayRef<unsigned> Opcodes) const;
+  /// TCK_CodeSize cost of a two-operand libcall
+  InstructionCost getLibcallSizeCost() const;
+
+public:
+  explicit M65832TTIImpl(const M65832TargetMachine *TM, const Function &F)
+      : BaseT(TM, F.getDataLayout()), ST(TM->getSubtargetImpl(F)),
+        TLI(ST->getTargetLowering()) {}
+
+  /// \name Register file
+  /// @{
+  unsigned getNumberOfRegisters(unsigned ClassID) const override;
+  TypeSize
+  getRegisterBitWidth(TargetTransformInfo::RegisterKind K) const override;
+  unsigned getMaxInterleaveFactor(ElementCount VF) const override { return 1; }
+  /// @}
+
+  /// \name Scalar cost queries
+  /// @{
+  TTI::PopcntSupportKind getPopcntSupport(unsigned TyWidth) const override;
+  bool hasDivRemOp(Type *DataType, bool IsSigned) const override;
+  InstructionCost getBranchMispredictPenalty() const override;
+
+  InstructionCost getIntImmCost(const APInt &Imm, Type *Ty,
+                                TTI::TargetCostKind CostKind) const override;
+  InstructionCost
+  getIntImmCostInst(unsigned Opc, unsigned Idx, const APInt &Imm, Type *Ty,
+                    TTI::TargetCostKind CostKind,
+                    Instruction *Inst = nullptr) const override;
+  InstructionCost
+  getIntImmCostIntrin(Intrinsic::ID IID, unsigned Idx, const APInt &Imm,
+                      Type *Ty, TTI::TargetCostKind CostKind) const override;
+
+  InstructionCost getArithmeticInstrCost(
+      unsigned Opcode, Type *Ty, TTI::TargetCostKind CostKind,
+      TTI::OperandValueInfo Op1Info = {TTI::OK_AnyValue, TTI::OP_None},
+      TTI::OperandValueInfo Op2Info = {TTI::OK_AnyValue, TTI::OP_None},
+      ArrayRef<const Value *> Args = {},
+      const Instruction *CxtI = nullptr) const override;
+
+  InstructionCost getMemoryOpCost(
+      unsigned Opcode, Type *Src, Align Alignment, unsigned AddressSpace,
+      TTI::TargetCostKind CostKind,
+      TTI::OperandValueInfo OpInfo = {TTI::OK_AnyValue, TTI::OP_None},
+      const Instruction *I = nullptr) const override;
+
+  InstructionCost getCFInstrCost(unsigned Opcode, TTI::TargetCostKind CostKind,
+                                 const Instruction *I = nullptr) const override;
+
+  InstructionCost getCmpSelInstrCost(
+      unsigned Opcode, Type *ValTy, Type *CondTy, CmpInst::Predicate VecPred,
+      TTI::TargetCostKind CostKind,
+      TTI::OperandValueInfo Op1Info = {TTI::OK_AnyValue, TTI::OP_None},
+      TTI::OperandValueInfo Op2Info = {TTI::OK_AnyValue, TTI::OP_None},
+      const Instruction *I = nullptr) const override;
+  /// @}
+
+  /// \name Memory intrinsics
+  /// @{
+  TTI::MemCmpExpansionOptions
+  enableMemCmpExpansion(bool OptSize, bool IsZeroCmp) const override;
+  /// @}
+
+  /// \name Addressing modes and LSR
+  /// @{
+  bool isLegalAddressingMode(Type *Ty, GlobalValue *BaseGV, int64_t BaseOffset,
+                             bool HasBaseReg, int64_t Scale,
+                             unsigned AddrSpace, Instruction *I = nullptr,
+                             int64_t ScalableOffset = 0) const override;
+  InstructionCost getScalingFactorCost(Type *Ty, GlobalValue *BaseGV,
+                                       StackOffset BaseOffset, bool HasBaseReg,
+                                       int64_t Scale,
+                                       unsigned AddrSpace) const override;
+  bool isLSRCostLess(const TTI::LSRCost &C1,
+                     const TTI::LSRCost &C2) const override;
+  bool isNumRegsMajorCostOfLSR() const override { return false; }
+  /// @}
+
+  /// \name Loop transformations
+  /// @{
+  void getUnrollingPreferences(Loop *L, ScalarEvolution &SE,
+                               TTI::UnrollingPreferences &UP,
+                               OptimizationRemarkEmitter *ORE) const override;
+  void getPeelingPreferences(Loop *L, ScalarEvolution &SE,
+                             TTI::PeelingPreferences &PP) const override;
+  /// @}
+};
+
+} // end namespace llvm
+
+#endif // LLVM_LIB_TARGET_M65832_M65832TARGETTRANSFORMINFO_H
@@ -0,0 +1,427 @@
+//===-- M65832ValueTracking.cpp - Remove redundant A/X/Y/B traffic --------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// copyPhysReg and expandPostRAPseudo route almost everything through A, and
+// back-to-back expansions frequently reload a value that A (or X/Y/B)
+// already holds:
+//
+//   STA $10          ; end of one expansion
+//   LDA $10          ; start of the next one - redundant
+//
+// This pass runs just before emission and walks each basic block keeping a
+// value number for A, X, Y, B, SP and every DP register slot. A load,
+// transfer or store that writes a location with the value it already holds
+// is deleted, provided the N/Z flags it would set are dead.
+//
+// Fixed-offset inline branches (BEQ *+n, emitted by the SELECT_CC
+// expansions) make the bytes they skip untouchable, and their landing point
+// is a join, so nothing is learned or removed inside such a region.
+//
+//===----------------------------------------------------------------------===//
+
+#include "M65832.h"
+#include "M65832InstrInfo.h"
+#include "M65832Subtarget.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/Support/Debug.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "m65832-value-tracking"
+#define PASS_NAME "M65832 A/X/Y/B value tracking"
+
+STATISTIC(NumLoadsRemoved, "Number of redundant loads removed");
+STATISTIC(NumTransfersRemoved, "Number of redundant transfers removed");
+STATISTIC(NumStoresRemoved, "Number of redundant DP stores removed");
+
+namespace {
+
+/// Locations tracked besides the DP register slots.
+enum TrackedLoc { LocA, LocX, LocY, LocB, LocSP, NumFixedLocs };
+
+/// 64 DP register slots (R0-R63), one per 4 bytes of direct page.
+constexpr unsigned NumDPSlots = 64;
+
+class M65832ValueTracking : public MachineFunctionPass {
+public:
+  static char ID;
+
+  M65832ValueTracking() : MachineFunctionPass(ID) {}
+
+  bool runOnMachineFunction(MachineFunction &MF) override;
+
+  MachineFunctionProperties getRequiredProperties() const override {
+    return MachineFunctionProperties().setNoVRegs();
+  }
+
+  StringRef getPassName() const override { return PASS_NAME; }
+
+private:
+  const M65832InstrInfo *TII = nullptr;
+  const TargetRegisterInfo *TRI = nullptr;
+  bool TracksLiveness = false;
+
+  // Value numbers: 0 is "unknown", every other number names a value.
+  unsigned NextValue = 1;
+  unsigned Fixed[NumFixedLocs];
+  unsigned DP[NumDPSlots];
+  DenseMap<int64_t, unsigned> ConstValues;
+
+  unsigned freshValue() { return NextValue++; }
+  unsigned constValue(int64_t Imm);
+  void resetAll();
+  void resetDP();
+
+  /// Value held by a location, materialising a fresh number for unknowns
+  /// so that copies between locations can be tracked.
+  unsigned &fixedLoc(TrackedLoc L);
+  /// DP slot for a direct-page operand, or null if it is not a register.
+  unsigned *dpSlot(int64_t Offset);
+  unsigned *locForReg(Register Reg);
+
+  bool flagsDeadAfter(MachineInstr &MI) const;
+  bool analyzeCopy(MachineInstr &MI, unsigned *&Dst, unsigned &Val);
+  void clobberDefs(MachineInstr &MI);
+  bool processBlock(MachineBasicBlock &MBB);
+};
+
+} // end anonymous namespace
+
+char M65832ValueTracking::ID = 0;
+
+INITIALIZE_PASS(M65832ValueTracking, DEBUG_TYPE, PASS_NAME, false, false)
+
+FunctionPass *llvm::createM65832ValueTrackingPass() {
+  return new M65832ValueTracking();
+}
+
+unsigned M65832ValueTracking::constValue(int64_t Imm) {
+  auto It = ConstValues.try_emplace(Imm, 0);
+  if (It.second)
+    It.first->second = freshValue();
+  return It.first->second;
+}
+
+void M65832ValueTracking::resetDP() {
+  for (unsigned &V : DP)
+    V = 0;
+}
+
+void M65832ValueTracking::resetAll() {
+  for (unsigned &V : Fixed)
+    V = 0;
+  resetDP();
+}
+
+unsigned &M65832ValueTracking::fixedLoc(TrackedLoc L) {
+  if (!Fixed[L])
+    Fixed[L] = freshValue();
+  return Fixed[L];
+}
+
+unsigned *M65832ValueTracking::dpSlot(int64_t Offset) {
+  if (Offset < 0 || Offset % 4 != 0 || Offset / 4 >= NumDPSlots)
+    return nullptr;
+  unsigned &V = DP[Offset / 4];
+  if (!V)
+    V = freshValue();
+  return &V;
+}
+
+unsigned *M65832ValueTracking::locForReg(Register Reg) {
+  switch (Reg) {
+  case M65832::A:
+    return &Fixed[LocA];
+  case M65832::X:
+    return &Fixed[LocX];
+  case M65832::Y:
+    return &Fixed[LocY];
+  case M65832::B:
+    return &Fixed[LocB];
+  case M65832::SP:
+    return &Fixed[LocSP];
+  default:
+    break;
+  }
+  if (Reg >= M65832::R0 && Reg <= M65832::R63)
+    return &DP[Reg - M65832::R0];
+  return nullptr;
+}
+
+/// Most 6502 loads and transfers set N and Z even where the instruction
+/// description does not model it, so only drop them when nothing reads SR
+/// before it is redefined.
+static bool setsNZ(unsigned Opc) {
+  switch (Opc) {
+  case M65832::LDA_DP:
+  case M65832::LDA_IMM:
+  case M65832::LDX_DP:
+  case M65832::LDX_IMM:
+  case M65832::LDY_DP:
+  case M65832::LDY_IMM:
+  case M65832::TAX:
+  case M65832::TXA:
+  case M65832::TAY:
+  case M65832::TYA:
+  case M65832::TSX:
+  case M65832::TBA:
+  case M65832::TBX:
+  case M65832::TBY:
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool M65832ValueTracking::flagsDeadAfter(MachineInstr &MI) const {
+  MachineBasicBlock &MBB = *MI.getParent();
+  for (MachineBasicBlock::iterator I = std::next(MI.getIterator()),
+                                   E = MBB.end();
+       I != E; ++I) {
+    if (I->isDebugInstr())
+      continue;
+    if (I->readsRegister(M65832::SR, TRI))
+      return false;
+    if (I->definesRegister(M65832::SR, TRI))
+      return true;
+  }
+  if (!TracksLiveness)
+    return false;
+  for (MachineBasicBlock *Succ : MBB.successors())
+    if (Succ->isLiveIn(M65832::SR))
+      return false;
+  return true;
+}
+
+/// If MI copies a value into a tracked location, return that location and
+/// the value number being written.
+bool M65832ValueTracking::analyzeCopy(MachineInstr &MI, unsigned *&Dst,
+                                      unsigned &Val) {
+  unsigned Opc = MI.getOpcode();
+  Dst = nullptr;
+  Val = 0;
+
+  switch (Opc) {
+  default:
+    return false;
+
+  // Loads from the DP register window.
+  case M65832::LDA_DP:
+  case M65832::LDX_DP:
+  case M65832::LDY_DP:
+    if (unsigned *Src = dpSlot(MI.getOperand(1).getImm()))
+      Val = *Src;
+    Dst = &Fixed[Opc == M65832::LDA_DP   ? LocA
+                 : Opc == M65832::LDX_DP ? LocX
+                                         : LocY];
+    break;
+
+  // Immediate loads. Symbolic operands (globals, CPIs) are not numbered.
+  case M65832::LDA_IMM:
+  case M65832::LDX_IMM:
+  case M65832::LDY_IMM:
+    if (!MI.getOperand(1).isImm())
+      return false;
+    Val = constValue(MI.getOperand(1).getImm());
+    Dst = &Fixed[Opc == M65832::LDA_IMM   ? LocA
+                 : Opc == M65832::LDX_IMM ? LocX
+                                          : LocY];
+    break;
+  case M65832::LDR_IMM:
+  case M65832::LDB_IMM:
+  case M65832::LDW_IMM:
+    if (!MI.getOperand(1).isImm())
+      return false;
+    Val = constValue(MI.getOperand(1).getImm());
+    Dst = locForReg(MI.getOperand(0).getReg());
+    break;
+  case M65832::MOVR_DP:
+    if (unsigned *Src = locForReg(MI.getOperand(1).getReg())) {
+      if (!*Src)
+        *Src = freshValue();
+      Val = *Src;
+    }
+    Dst = locForReg(MI.getOperand(0).getReg());
+    break;
+
+  // Stores into the DP register window.
+  case M65832::STA_DP:
+  case M65832::STX_DP:
+  case M65832::STY_DP:
+    Dst = dpSlot(MI.getOperand(1).getImm());
+    Val = fixedLoc(Opc == M65832::STA_DP   ? LocA
+                   : Opc == M65832::STX_DP ? LocX
+                                           : LocY);
+    break;
+  case M65832::STZ_DP:
+    Dst = dpSlot(MI.getOperand(0).getImm());
+    Val = constValue(0);
+    break;
+
+  // Register transfers.
+  case M65832::TAX: Dst = &Fixed[LocX]; Val = fixedLoc(LocA); break;
+  case M65832::TXA: Dst = &Fixed[LocA]; Val = fixedLoc(LocX); break;
+  case M65832::TAY: Dst = &Fixed[LocY]; Val = fixedLoc(LocA); break;
+  case M65832::TYA: Dst = &Fixed[LocA]; Val = fixedLoc(LocY); break;
+  case M65832::TSX: Dst = &Fixed[LocX]; Val = fixedLoc(LocSP); break;
+  case M65832::TXS: Dst = &Fixed[LocSP]; Val = fixedLoc(LocX); break;
+  case M65832::TAB: Dst = &Fixed[LocB]; Val = fixedLoc(LocA); break;
+  case M65832::TBA: Dst = &Fixed[LocA]; Val = fixedLoc(LocB); break;
+  case M65832::TXB: Dst = &Fixed[LocB]; Val = fixedLoc(LocX); break;
+  case M65832::TBX: Dst = &Fixed[LocX]; Val = fixedLoc(LocB); break;
+  case M65832::TYB: Dst = &Fixed[LocB]; Val = fixedLoc(LocY); break;
+  case M65832::TBY: Dst = &Fixed[LocY]; Val = fixedLoc(LocB); break;
+  case M65832::TSPB: Dst = &Fixed[LocB]; Val = fixedLoc(LocSP); break;
+  }
+
+  return Dst && Val;
+}
+
+static void countRemoved(unsigned Opc) {
+  switch (Opc) {
+  case M65832::LDA_DP:
+  case M65832::LDX_DP:
+  case M65832::LDY_DP:
+  case M65832::LDA_IMM:
+  case M65832::LDX_IMM:
+  case M65832::LDY_IMM:
+  case M65832::LDR_IMM:
+  case M65832::LDB_IMM:
+  case M65832::LDW_IMM:
+    ++NumLoadsRemoved;
+    break;
+  case M65832::STA_DP:
+  case M65832::STX_DP:
+  case M65832::STY_DP:
+  case M65832::STZ_DP:
+    ++NumStoresRemoved;
+    break;
+  default:
+    ++NumTransfersRemoved;
+    break;
+  }
+}
+
+void M65832ValueTracking::clobberDefs(MachineInstr &MI) {
+  for (const MachineOperand &MO : MI.operands()) {
+    if (MO.isRegMask()) {
+      resetAll();
+      return;
+    }
+    if (!MO.isReg() || !MO.isDef() || !MO.getReg())
+      continue;
+    Register Reg = MO.getReg();
+    // Moving D remaps the whole DP window.
+    if (Reg == M65832::D) {
+      resetDP();
+      continue;
+    }
+    if (unsigned *Loc = locForReg(Reg))
+      *Loc = 0;
+  }
+
+  // Writes to DP slots that are encoded as immediates.
+  switch (MI.getOpcode()) {
+  case M65832::INC_DP:
+  case M65832::DEC_DP:
+  case M65832::ASL_DP:
+  case M65832::LSR_DP:
+  case M65832::ROL_DP:
+  case M65832::ROR_DP:
+    if (MI.getOperand(0).isImm())
+      if (unsigned *Slot = dpSlot(MI.getOperand(0).getImm()))
+        *Slot = 0;
+    return;
+  case M65832::CAS_DP:
+    resetDP();
+    return;
+  default:
+    break;
+  }
+
+  // Any other store might target the DP window (STF to a DP slot, stores
+  // through a pointer that aliases the register file with R=0, ...).
+  // Patternless instructions only carry a guessed hasSideEffects, so treat
+  // those as possible stores too.
+  if (MI.mayStore() || MI.hasUnmodeledSideEffects())
+    resetDP();
+}
+
+bool M65832ValueTracking::processBlock(MachineBasicBlock &MBB) {
+  bool Changed = false;
+  resetAll();
+
+  // Bytes still covered by a fixed-offset inline branch.
+  int64_t Protected = 0;
+
+  for (MachineInstr &MI : llvm::make_early_inc_range(MBB)) {
+    if (MI.isDebugInstr())
+      continue;
+
+    if (Protected > 0) {
+      Protected -= MI.getDesc().getSize();
+      if (MI.isBranch() && MI.getOperand(0).isImm())
+        Protected = std::max(Protected, MI.getOperand(0).getImm());
+      resetAll();
+      continue;
+    }
+
+    if (MI.isBranch() && MI.getNumOperands() && MI.getOperand(0).isImm()) {
+      int64_t Offset = MI.getOperand(0).getImm();
+      if (Offset < 0)
+        return Changed; // Backwards into this block: give up on the rest.
+      Protected = Offset;
+      resetAll();
+      continue;
+    }
+
+    if (MI.isCall() || MI.isInlineAsm() || MI.getOpcode() == M65832::RSET ||
+        MI.getOpcode() == M65832::RCLR) {
+      resetAll();
+      continue;
+    }
+
+    unsigned *Dst;
+    unsigned Val;
+    if (analyzeCopy(MI, Dst, Val)) {
+      if (*Dst == Val &&
+          (!setsNZ(MI.getOpcode()) || flagsDeadAfter(MI))) {
+        LLVM_DEBUG(dbgs() << "Removing redundant: " << MI);
+        countRemoved(MI.getOpcode());
+        MI.eraseFromParent();
+        Changed = true;
+        continue;
+      }
+      clobberDefs(MI);
+      *Dst = Val;
+      continue;
+    }
+
+    clobberDefs(MI);
+  }
+  return Changed;
+}
+
+bool M65832ValueTracking::runOnMachineFunction(MachineFunction &MF) {
+  if (skipFunction(MF.getFunction()))
+    return false;
+
+  const M65832Subtarget &STI = MF.getSubtarget<M65832Subtarget>();
+  TII = STI.getInstrInfo();
+  TRI = STI.getRegisterInfo();
+  TracksLiveness = MF.getRegInfo().tracksLiveness();
+
+  bool Changed = false;
+  for (MachineBasicBlock &MBB : MF)
+    Changed |= processBlock(MBB);
+  return Changed;
+}
@@ -8,7 +8,11 @@
 
 #include "MCTargetDesc/M65832FixupKinds.h"
 #include "MCTargetDesc/M65832MCTargetDesc.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/BinaryFormat/Dwarf.h"
+#include "llvm/BinaryFormat/ELF.h"
 #include "llvm/MC/MCAsmBackend.h"
+#include "llvm/MC/MCAsmInfo.h"
 #include "llvm/MC/MCAssembler.h"
 #include "llvm/MC/MCContext.h"
 #include "llvm/MC/MCELFObjectWriter.h"
@@ -16,17 +20,21 @@
 #include "llvm/MC/MCObjectWriter.h"
 #include "llvm/MC/MCSubtargetInfo.h"
 #include "llvm/MC/MCValue.h"
+#include "llvm/Support/EndianStream.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/LEB128.h"
+#include "llvm/Support/MathExtras.h"
 
 using namespace llvm;
 
 namespace {
 class M65832AsmBackend : public MCAsmBackend {
   uint8_t OSABI;
+  bool Relax;
 
 public:
-  M65832AsmBackend(uint8_t OSABI)
-      : MCAsmBackend(llvm::endianness::little), OSABI(OSABI) {}
+  M65832AsmBackend(uint8_t OSABI, bool Relax)
+      : MCAsmBackend(llvm::endianness::little), OSABI(OSABI), Relax(Relax) {}
 
   ~M65832AsmBackend() override = default;
 
@@ -34,9 +42,17 @@ public:
                   const MCValue &Target, uint8_t *Data, uint64_t Value,
                   bool IsResolved) override;
 
+  bool relaxAlign(MCFragment &F, unsigned &Size) override;
+  bool relaxDwarfLineAddr(MCFragment &F) const override;
+  bool relaxDwarfCFA(MCFragment &F) const override;
+  std::pair<bool, bool> relaxLEB128(MCFragment &F,
+                                    int64_t &Value) const override;
+
+  std::optional<MCFixupKind> getFixupKind(StringRef Name) const override;
+
   std::unique_ptr<MCObjectTargetWriter>
   createObjectTargetWriter() const override {
-    return createM65832ELFObjectWriter(OSABI);
+    return createM65832ELFObjectWriter(OSABI, Relax);
   }
 
   MCFixupKindInfo getFixupKindInfo(MCFixupKind Kind) const override {
@@ -51,11 +67,20 @@ public:
       {"fixup_m65832_32",         0,     32,  0},
       {"fixup_m65832_pcrel_8",    0,     8,   0},
       {"fixup_m65832_pcrel_16",   0,     16,  0},
+      {"fixup_m65832_gprel_32",   0,     32,  0},
+      {"fixup_m65832_bankrel_16", 0,     16,  0},
+      {"fixup_m65832_dp_8",       0,     8,   0},
+      {"fixup_m65832_pcrel_32",   0,     32,  0},
+      {"fixup_m65832_tprel_32",   0,     32,  0},
     };
     // clang-format on
     static_assert((std::size(Infos)) == M65832::NumTargetFixupKinds,
                   "Not all fixup kinds added to Infos array");
 
+    // R_M65832_RELAX and R_M65832_ALIGN are relocations, not fixups
+    if (mc::isRelocation(Kind))
+      return {};
+
     if (Kind < FirstTargetFixupKind)
       return MCAsmBackend::getFixupKindInfo(Kind);
 
@@ -66,19 +91,231 @@ public:
 
   bool writeNopData(raw_ostream &OS, uint64_t Count,
                     const MCSubtargetInfo *STI) const override {
-    // NOP opcode is $EA
-    for (uint64_t i = 0; i < Count; ++i)
-      OS << '\xEA';
+    // Short pads are NOPs ($EA). Longer pads start with a BRA ($80 rel16,
+    // relative to the end of the BRA) over the rest, so falling through
+    // costs one taken branch rather than one NOP per byte. lld writes the
+    // same pattern when relaxation shrinks a pad.
+    while (Count > MaxNopRun) {
+      uint64_t Skip = std::min<uint64_t>(Count - 3, INT16_MAX);
+      OS << '\x80' << char(Skip & 0xFF) << char(Skip >> 8);
+      OS << std::string(Skip, '\xEA');
+      Count -= 3 + Skip;
+    }
+    OS << std::string(Count, '\xEA');
     return true;
   }
+
+  /// Longest pad written as plain NOPs.
+  static constexpr uint64_t MaxNopRun = 3;
+
+private:
+  void recordAddSub(const MCFragment &F, const MCFixup &Fixup,
+                    const MCValue &Target);
 };
 
+static std::pair<unsigned, unsigned> getAddSubRelocs(MCFixupKind Kind) {
+  switch (Kind) {
+  default:
+    llvm_unreachable("unsupported label difference size");
+  case FK_Data_1:
+    return {ELF::R_M65832_ADD8, ELF::R_M65832_SUB8};
+  case FK_Data_2:
+    return {ELF::R_M65832_ADD16, ELF::R_M65832_SUB16};
+  case FK_Data_4:
+    return {ELF::R_M65832_ADD32, ELF::R_M65832_SUB32};
+  case FK_Data_leb128:
+    return {ELF::R_M65832_ADD_ULEB128, ELF::R_M65832_SUB_ULEB128};
+  }
+}
+
+// Relocation names for .reloc, including the BFD_RELOC_NONE entries the
+// streamer writes into .llvm.call-graph-profile (-fprofile-use)
+std::optional<MCFixupKind>
+M65832AsmBackend::getFixupKind(StringRef Name) const {
+  unsigned Type = llvm::StringSwitch<unsigned>(Name)
+#define ELF_RELOC(NAME, ID) .Case(#NAME, ID)
+#include "llvm/BinaryFormat/ELFRelocs/M65832.def"
+#undef ELF_RELOC
+                      .Case("BFD_RELOC_NONE", ELF::R_M65832_NONE)
+                      .Case("BFD_RELOC_8", ELF::R_M65832_8)
+                      .Case("BFD_RELOC_16", ELF::R_M65832_16)
+                      .Case("BFD_RELOC_32", ELF::R_M65832_32)
+                      .Default(-1u);
+  if (Type == -1u)
+    return std::nullopt;
+  return static_cast<MCFixupKind>(FirstLiteralRelocationKind + Type);
+}
+
+// An alignment after linker-relaxable code pads with the most NOPs it can
+// need and tells the linker with R_M65832_ALIGN, whose addend is the padding
+// size, so that the linker can delete the NOPs it does not.
+bool M65832AsmBackend::relaxAlign(MCFragment &F, unsigned &Size) {
+  auto *Sec = F.getParent();
+  if (F.getLayoutOrder() <= Sec->firstLinkerRelaxable())
+    return false;
+  if (F.getAlignment() <= 1)
+    return false;
+
+  Size = F.getAlignment().value() - 1;
+  auto *Expr = MCConstantExpr::create(Size, getContext());
+  MCFixup Fixup =
+      MCFixup::create(0, Expr, FirstLiteralRelocationKind + ELF::R_M65832_ALIGN);
+  F.setVarFixups({Fixup});
+  F.setLinkerRelaxable();
+  return true;
+}
+
+// A label difference that layout could not fold (its labels are in
+// different sections, or -mrelax code lies between them) is left to the
+// linker as an ADD/SUB pair on the field, which starts out as zero.
+void M65832AsmBackend::recordAddSub(const MCFragment &F, const MCFixup &Fixup,
+                                    const MCValue &Target) {
+  auto [AddType, SubType] = getAddSubRelocs(Fixup.getKind());
+  MCValue A = MCValue::get(Target.getAddSym(), nullptr, Target.getConstant());
+  MCValue B = MCValue::get(Target.getSubSym());
+  auto FA = MCFixup::create(Fixup.getOffset(), nullptr, AddType);
+  auto FB = MCFixup::create(Fixup.getOffset(), nullptr, SubType);
+  uint64_t ValueA, ValueB;
+  Asm->getWriter().recordRelocation(F, FA, A, ValueA);
+  Asm->getWriter().recordRelocation(F, FB, B, ValueB);
+}
+
+// Address advances in the line table that layout cannot resolve become
+// DW_LNS_fixed_advance_pc (or DW_LNE_set_address past 60000 bytes), whose
+// operand is a plain field the ADD/SUB pair can patch.
+bool M65832AsmBackend::relaxDwarfLineAddr(MCFragment &F) const {
+  int64_t LineDelta = F.getDwarfLineDelta();
+  const MCExpr &AddrDelta = F.getDwarfAddrDelta();
+  int64_t Value;
+  if (AddrDelta.evaluateAsAbsolute(Value, *Asm))
+    return false;
+  [[maybe_unused]] bool IsAbsolute =
+      AddrDelta.evaluateKnownAbsolute(Value, *Asm);
+  assert(IsAbsolute && "line delta with an invalid expression");
+
+  SmallVector<char> Data;
+  raw_svector_ostream OS(Data);
+
+  // INT64_MAX is a signal that this is actually a DW_LNE_end_sequence.
+  if (LineDelta != INT64_MAX) {
+    OS << uint8_t(dwarf::DW_LNS_advance_line);
+    encodeSLEB128(LineDelta, OS);
+  }
+
+  // DW_LNE_set_address takes the address itself, the label being advanced
+  // to, rather than the difference
+  const MCExpr *PCExpr = &AddrDelta;
+  unsigned PCBytes;
+  if (Value > 60000) {
+    PCBytes = getContext().getAsmInfo()->getCodePointerSize();
+    PCExpr = cast<MCBinaryExpr>(AddrDelta).getLHS();
+    OS << uint8_t(dwarf::DW_LNS_extended_op) << uint8_t(PCBytes + 1)
+       << uint8_t(dwarf::DW_LNE_set_address);
+    OS.write_zeros(PCBytes);
+  } else {
+    PCBytes = 2;
+    OS << uint8_t(dwarf::DW_LNS_fixed_advance_pc);
+    support::endian::write<uint16_t>(OS, 0, llvm::endianness::little);
+  }
+  auto Offset = OS.tell() - PCBytes;
+
+  if (LineDelta == INT64_MAX) {
+    OS << uint8_t(dwarf::DW_LNS_extended_op) << uint8_t(1)
+       << uint8_t(dwarf::DW_LNE_end_sequence);
+  } else {
+    OS << uint8_t(dwarf::DW_LNS_copy);
+  }
+
+  F.setVarContents(Data);
+  F.setVarFixups({MCFixup::create(Offset, PCExpr,
+                                  MCFixup::getDataKindForSize(PCBytes))});
+  return true;
+}
+
+// Likewise DW_CFA_advance_loc1/2/4 for CFI advances
+bool M65832AsmBackend::relaxDwarfCFA(MCFragment &F) const {
+  const MCExpr &AddrDelta = F.getDwarfAddrDelta();
+  int64_t Value;
+  if (AddrDelta.evaluateAsAbsolute(Value, *Asm))
+    return false;
+  [[maybe_unused]] bool IsAbsolute =
+      AddrDelta.evaluateKnownAbsolute(Value, *Asm);
+  assert(IsAbsolute && "CFA with invalid expression");
+
+  if (Value == 0) {
+    F.clearVarContents();
+    F.clearVarFixups();
+    return true;
+  }
+
+  SmallVector<char, 8> Data;
+  raw_svector_ostream OS(Data);
+  unsigned Size;
+  if (isUInt<8>(Value)) {
+    OS << uint8_t(dwarf::DW_CFA_advance_loc1);
+    Size = 1;
+  } else if (isUInt<16>(Value)) {
+    OS << uint8_t(dwarf::DW_CFA_advance_loc2);
+    Size = 2;
+  } else {
+    OS << uint8_t(dwarf::DW_CFA_advance_loc4);
+    Size = 4;
+  }
+  OS.write_zeros(Size);
+
+  F.setVarContents(Data);
+  F.setVarFixups(
+      {MCFixup::create(1, &AddrDelta, MCFixup::getDataKindForSize(Size))});
+  return true;
+}
+
+// Unsigned LEB128 label differences (DWARF 5 range and location lists) get
+// a zero-padded field of the size the difference has now, relocated with
+// R_M65832_ADD_ULEB128/R_M65832_SUB_ULEB128.
+std::pair<bool, bool> M65832AsmBackend::relaxLEB128(MCFragment &F,
+                                                    int64_t &Value) const {
+  const MCExpr &Expr = F.getLEBValue();
+  if (F.isLEBSigned() || !Expr.evaluateKnownAbsolute(Value, *Asm))
+    return std::make_pair(false, false);
+  F.setVarFixups({MCFixup::create(0, &Expr, FK_Data_leb128)});
+  return std::make_pair(true, true);
+}
+
 void M65832AsmBackend::applyFixup(const MCFragment &F, const MCFixup &Fixup,
                                   const MCValue &Target, uint8_t *Data,
                                   uint64_t Value, bool IsResolved) {
+  // %gprel, %bankrel, %dp and %tprel are relative to __global_pointer$,
+  // __data_bank_base, __direct_page and the TLS segment, which only the
+  // linker knows
+  if (Fixup.getKind() == M65832::fixup_m65832_gprel_32 ||
+      Fixup.getKind() == M65832::fixup_m65832_bankrel_16 ||
+      Fixup.getKind() == M65832::fixup_m65832_dp_8 ||
+      Fixup.getKind() == M65832::fixup_m65832_tprel_32)
+    IsResolved = false;
+
+  // A %bankabs access always gets its R_M65832_32, followed by the
+  // R_M65832_RELAX that lets the linker shorten it
+  if (Fixup.isLinkerRelaxable())
+    IsResolved = false;
+
+  if (!IsResolved && Target.getSubSym()) {
+    recordAddSub(F, Fixup, Target);
+    return;
+  }
+
   // Call maybeAddReloc to emit relocations for unresolved symbols
   maybeAddReloc(F, Fixup, Target, Value, IsResolved);
-  
+  if (mc::isRelocation(Fixup.getKind()))
+    return;
+
+  if (Fixup.isLinkerRelaxable()) {
+    MCFixup RelaxFixup =
+        MCFixup::create(Fixup.getOffset(), nullptr, ELF::R_M65832_RELAX);
+    MCValue RelaxTarget = MCValue::get(nullptr);
+    uint64_t RelaxValue;
+    Asm->getWriter().recordRelocation(F, RelaxFixup, RelaxTarget, RelaxValue);
+  }
+
   if (!Value)
     return; // Nothing to apply
 
@@ -92,11 +329,13 @@ void M65832AsmBackend::applyFixup(const MCFragment &F, const MCFixup &Fixup,
   case FK_Data_1:
   case M65832::fixup_m65832_8:
   case M65832::fixup_m65832_pcrel_8:
+  case M65832::fixup_m65832_dp_8:
     NumBytes = 1;
     break;
   case FK_Data_2:
   case M65832::fixup_m65832_16:
   case M65832::fixup_m65832_pcrel_16:
+  case M65832::fixup_m65832_bankrel_16:
     NumBytes = 2;
     break;
   case M65832::fixup_m65832_24:
@@ -104,6 +343,9 @@ void M65832AsmBackend::applyFixup(const MCFragment &F, const MCFixup &Fixup,
     break;
   case FK_Data_4:
   case M65832::fixup_m65832_32:
+  case M65832::fixup_m65832_gprel_32:
+  case M65832::fixup_m65832_pcrel_32:
+  case M65832::fixup_m65832_tprel_32:
     NumBytes = 4;
     break;
   }
@@ -123,5 +365,5 @@ MCAsmBackend *llvm::createM65832AsmBackend(const Target &T,
                                             const MCTargetOptions &Options) {
   const Triple &TT = STI.getTargetTriple();
   uint8_t OSABI = MCELFObjectTargetWriter::getOSABI(TT.getOS());
-  return new M65832AsmBackend(OSABI);
+  return new M65832AsmBackend(OSABI, STI.hasFeature(M65832::FeatureRelax));
 }
@@ -14,6 +14,7 @@
 #include "llvm/MC/MCExpr.h"
 #include "llvm/MC/MCFixup.h"
 #include "llvm/MC/MCObjectWriter.h"
+#include "llvm/MC/MCSymbolELF.h"
 #include "llvm/MC/MCValue.h"
 #include "llvm/Support/ErrorHandling.h"
 
@@ -21,14 +22,23 @@ using namespace llvm;
 
 namespace {
 class M65832ELFObjectWriter : public MCELFObjectTargetWriter {
+  bool Relax;
+
 public:
-  M65832ELFObjectWriter(uint8_t OSABI)
+  M65832ELFObjectWriter(uint8_t OSABI, bool Relax)
       : MCELFObjectTargetWriter(/*Is64Bit=*/false, OSABI,
                                 ELF::EM_M65832,
-                                /*HasRelocationAddend=*/true) {}
+                                /*HasRelocationAddend=*/true),
+        Relax(Relax) {}
 
   unsigned getRelocType(const MCFixup &Fixup, const MCValue &Target,
                         bool IsPCRel) const override;
+
+  // Linker relaxation moves code within a section, which a section symbol
+  // plus addend would not follow
+  bool needsRelocateWithSymbol(const MCValue &, unsigned Type) const override {
+    return Relax;
+  }
 };
 } // end anonymous namespace
 
@@ -36,7 +46,11 @@ unsigned M65832ELFObjectWriter::getRelocType(const MCFixup &Fixup,
                                              const MCValue &Target,
                                              bool IsPCRel) const {
   unsigned Kind = Fixup.getKind();
-  
+
+  // R_M65832_RELAX and R_M65832_ALIGN from the asm backend
+  if (mc::isRelocation(Kind))
+    return Kind;
+
   if (IsPCRel) {
     switch (Kind) {
     default:
@@ -47,6 +61,9 @@ unsigned M65832ELFObjectWriter::getRelocType(const MCFixup &Fixup,
     case FK_Data_2:
     case M65832::fixup_m65832_pcrel_16:
       return ELF::R_M65832_PCREL_16;
+    case FK_Data_4:
+    case M65832::fixup_m65832_pcrel_32:
+      return ELF::R_M65832_PCREL_32;
     }
   }
 
@@ -64,16 +81,30 @@ unsigned M65832ELFObjectWriter::getRelocType(const MCFixup &Fixup,
   case FK_Data_4:
   case M65832::fixup_m65832_32:
     return ELF::R_M65832_32;
+  case M65832::fixup_m65832_gprel_32:
+    return ELF::R_M65832_GPREL_32;
+  case M65832::fixup_m65832_bankrel_16:
+    return ELF::R_M65832_BANKREL_16;
+  case M65832::fixup_m65832_dp_8:
+    return ELF::R_M65832_DP_8;
+  case M65832::fixup_m65832_tprel_32:
+    // The linker checks that both ends agree the symbol is TLS, including
+    // a reference to one defined elsewhere
+    if (auto *SA = const_cast<MCSymbol *>(Target.getAddSym()))
+      static_cast<MCSymbolELF *>(SA)->setType(ELF::STT_TLS);
+    return ELF::R_M65832_TPREL_32;
   // PC-relative fixup kinds (handled here even when IsPCRel=false
   // because we use the fixup kind to identify PC-relative fixups)
   case M65832::fixup_m65832_pcrel_8:
     return ELF::R_M65832_PCREL_8;
   case M65832::fixup_m65832_pcrel_16:
     return ELF::R_M65832_PCREL_16;
+  case M65832::fixup_m65832_pcrel_32:
+    return ELF::R_M65832_PCREL_32;
   }
 }
 
 std::unique_ptr<MCObjectTargetWriter>
-llvm::createM65832ELFObjectWriter(uint8_t OSABI) {
-  return std::make_unique<M65832ELFObjectWriter>(OSABI);
+llvm::createM65832ELFObjectWriter(uint8_t OSABI, bool Relax) {
+  return std::make_unique<M65832ELFObjectWriter>(OSABI, Relax);
 }
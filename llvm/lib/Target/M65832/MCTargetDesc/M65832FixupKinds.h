@@ -30,6 +30,16 @@ enum Fixups {
   fixup_m65832_pcrel_8,
   // A 16 bit PC relative fixup (for long branches).
   fixup_m65832_pcrel_16,
+  // A 32 bit offset from the global pointer (%gprel, for small data).
+  fixup_m65832_gprel_32,
+  // A 16 bit offset from the data bank base (%bankrel, for -mcmodel=bank).
+  fixup_m65832_bankrel_16,
+  // A 8 bit offset from the direct page base (%dp, for .dpdata).
+  fixup_m65832_dp_8,
+  // A 32 bit PC relative fixup (%pcrel, for -fPIC addresses).
+  fixup_m65832_pcrel_32,
+  // A 32 bit offset from the thread pointer (%tprel, for TLS).
+  fixup_m65832_tprel_32,
 
   // Marker
   LastTargetFixupKind,
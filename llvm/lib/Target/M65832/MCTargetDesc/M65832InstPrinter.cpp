@@ -109,6 +109,17 @@ void M65832InstPrinter::printBRelAddr(const MCInst *MI, unsigned OpNo,
   }
 }
 
+void M65832InstPrinter::printSROperand(const MCInst *MI, unsigned OpNo,
+                                        raw_ostream &O) {
+  const MCOperand &Op = MI->getOperand(OpNo);
+  // Stack-relative address - print as $XX,S
+  if (Op.isImm())
+    O << '$' << format_hex_no_prefix(Op.getImm() & 0xFF, 2);
+  else if (Op.isExpr())
+    MAI.printExpr(O, *Op.getExpr());
+  O << ",S";
+}
+
 void M65832InstPrinter::printDPOperand(const MCInst *MI, unsigned OpNo,
                                          raw_ostream &O) {
   const MCOperand &Op = MI->getOperand(OpNo);
@@ -158,6 +169,23 @@ void M65832InstPrinter::printMemOperand(const MCInst *MI, unsigned OpNo,
   }
 }
 
+void M65832InstPrinter::printMemRROperand(const MCInst *MI, unsigned OpNo,
+                                          raw_ostream &O) {
+  // (base)+index
+  O << '(';
+  printRegName(O, MI->getOperand(OpNo).getReg());
+  O << ")+";
+  printRegName(O, MI->getOperand(OpNo + 1).getReg());
+}
+
+void M65832InstPrinter::printMemGROperand(const MCInst *MI, unsigned OpNo,
+                                          raw_ostream &O) {
+  // sym+index
+  printOperand(MI, OpNo, O);
+  O << '+';
+  printRegName(O, MI->getOperand(OpNo + 1).getReg());
+}
+
 void M65832InstPrinter::printBranchTarget(const MCInst *MI, unsigned OpNo,
                                             raw_ostream &O) {
   const MCOperand &Op = MI->getOperand(OpNo);
@@ -41,10 +41,13 @@ public:
   void printOperand(const MCInst *MI, unsigned OpNo, raw_ostream &O);
   void printDPOperand(const MCInst *MI, unsigned OpNo, raw_ostream &O);
   void printMemOperand(const MCInst *MI, unsigned OpNo, raw_ostream &O);
+  void printMemRROperand(const MCInst *MI, unsigned OpNo, raw_ostream &O);
+  void printMemGROperand(const MCInst *MI, unsigned OpNo, raw_ostream &O);
   void printBranchTarget(const MCInst *MI, unsigned OpNo, raw_ostream &O);
   void printCondCode(const MCInst *MI, unsigned OpNo, raw_ostream &O);
   void printAbsAddr(const MCInst *MI, unsigned OpNo, raw_ostream &O);
   void printBRelAddr(const MCInst *MI, unsigned OpNo, raw_ostream &O);
+  void printSROperand(const MCInst *MI, unsigned OpNo, raw_ostream &O);
   void printIndirectOperand(const MCInst *MI, unsigned OpNo, raw_ostream &O);
   void printIndirectYOperand(const MCInst *MI, unsigned OpNo, raw_ostream &O);
 };
@@ -11,6 +11,9 @@
 //===----------------------------------------------------------------------===//
 
 #include "M65832MCAsmInfo.h"
+#include "llvm/MC/MCExpr.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/raw_ostream.h"
 
 using namespace llvm;
 
@@ -43,8 +46,9 @@ M65832MCAsmInfo::M65832MCAsmInfo(const Triple &TT) {
   
   // DWARF debug information
   SupportsDebugInformation = true;
-  // ExceptionsType defaults to None to match Triple
-  // Use DwarfCFI for unwind info when needed
+  // Table-based C++ exceptions: .eh_frame plus .gcc_except_table, unwound
+  // by libunwind
+  ExceptionsType = ExceptionHandling::DwarfCFI;
   DwarfRegNumForCFI = true;
   
   // Code pointer size
@@ -54,3 +58,37 @@ M65832MCAsmInfo::M65832MCAsmInfo(const Triple &TT) {
   // Little endian
   IsLittleEndian = true;
 }
+
+void M65832MCAsmInfo::printSpecifierExpr(raw_ostream &OS,
+                                         const MCSpecifierExpr &Expr) const {
+  switch (Expr.getSpecifier()) {
+  default:
+    llvm_unreachable("Invalid specifier");
+  case M65832::S_None:
+    printExpr(OS, *Expr.getSubExpr());
+    return;
+  case M65832::S_GPREL:
+    OS << "%gprel(";
+    break;
+  case M65832::S_BANKREL:
+    OS << "%bankrel(";
+    break;
+  case M65832::S_BANKABS:
+    OS << "%bankabs(";
+    break;
+  case M65832::S_JMPABS:
+    OS << "%jmpabs(";
+    break;
+  case M65832::S_DP:
+    OS << "%dp(";
+    break;
+  case M65832::S_PCREL:
+    OS << "%pcrel(";
+    break;
+  case M65832::S_TPREL:
+    OS << "%tprel(";
+    break;
+  }
+  printExpr(OS, *Expr.getSubExpr());
+  OS << ')';
+}
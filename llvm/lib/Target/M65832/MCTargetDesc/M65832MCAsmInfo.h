@@ -21,8 +21,32 @@ class Triple;
 class M65832MCAsmInfo : public MCAsmInfoELF {
 public:
   explicit M65832MCAsmInfo(const Triple &TT);
+  void printSpecifierExpr(raw_ostream &OS,
+                          const MCSpecifierExpr &Expr) const override;
 };
 
+namespace M65832 {
+using Specifier = uint8_t;
+enum {
+  S_None,
+  // %gprel(sym): sym - __global_pointer$
+  S_GPREL,
+  // %bankrel(sym): sym - __data_bank_base
+  S_BANKREL,
+  // %bankabs(sym): sym, with B at __data_bank_base (linker relaxation)
+  S_BANKABS,
+  // %jmpabs(sym): sym, as the target of LD.L R31; JMP (R31) (linker
+  // relaxation)
+  S_JMPABS,
+  // %dp(sym): sym - __direct_page
+  S_DP,
+  // %pcrel(sym): sym - the address of the field (-fPIC)
+  S_PCREL,
+  // %tprel(sym): offset of TLS sym from the thread pointer (R56)
+  S_TPREL,
+};
+} // namespace M65832
+
 } // namespace llvm
 
 #endif // LLVM_LIB_TARGET_M65832_MCTARGETDESC_M65832MCASMINFO_H
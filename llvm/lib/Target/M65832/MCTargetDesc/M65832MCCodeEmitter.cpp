@@ -23,9 +23,13 @@
 // - Barrel shifter: $02 $98 op|cnt dest src
 // - Extend ops: $02 $99 subop dest src
 //
+// The opcode byte, layout and extended-ALU mode byte come from TSFlags (see
+// M65832InstrFormats.td); only the FPU group is encoded case by case.
+//
 //===----------------------------------------------------------------------===//
 
 #include "M65832FixupKinds.h"
+#include "M65832MCAsmInfo.h"
 #include "M65832MCTargetDesc.h"
 #include "llvm/MC/MCCodeEmitter.h"
 #include "llvm/MC/MCContext.h"
@@ -50,9 +54,6 @@ class M65832MCCodeEmitter : public MCCodeEmitter {
   const MCInstrInfo &MCII;
   MCContext &Ctx;
 
-  // Get opcode from instruction description
-  uint8_t getOpcode(unsigned MIOpcode) const;
-
 public:
   M65832MCCodeEmitter(const MCInstrInfo &MCII, MCContext &Ctx)
       : MCII(MCII), Ctx(Ctx) {}
@@ -90,234 +91,6 @@ MCCodeEmitter *llvm::createM65832MCCodeEmitter(const MCInstrInfo &MCII,
   return new M65832MCCodeEmitter(MCII, Ctx);
 }
 
-// Map of instruction opcodes
-// This is a simplified lookup - a full implementation would use TableGen
-uint8_t M65832MCCodeEmitter::getOpcode(unsigned MIOpcode) const {
-  // Standard 6502/65816 opcodes
-  switch (MIOpcode) {
-  // Load/Store
-  case M65832::LDA_DP:    return 0xA5;
-  case M65832::LDAr:      return 0xA5;  // GPR variant uses same opcode
-  case M65832::LDA_IMM:   return 0xA9;
-  case M65832::LDA_ABS:   return 0xAD;
-  case M65832::LDA_ABS_X: return 0xBD;
-  case M65832::LDA_IND:   return 0xB2;
-  case M65832::LDA_IND_r: return 0xB2;  // GPR indirect variant
-  case M65832::LDA_IND_Y: return 0xB1;
-  case M65832::LDA_IND_Y_r: return 0xB1;  // GPR indirect Y variant
-  case M65832::STA_DP:    return 0x85;
-  case M65832::STAr:      return 0x85;  // GPR variant uses same opcode
-  case M65832::STA_ABS:   return 0x8D;
-  case M65832::STA_ABS_X: return 0x9D;
-  case M65832::STA_IND:   return 0x92;
-  case M65832::STA_IND_r: return 0x92;  // GPR indirect variant
-  case M65832::STA_IND_Y: return 0x91;
-  case M65832::STA_IND_Y_r: return 0x91;  // GPR indirect Y variant
-  case M65832::LDX_DP:    return 0xA6;
-  case M65832::LDXr:      return 0xA6;  // GPR variant uses same opcode
-  case M65832::LDX_IMM:   return 0xA2;
-  case M65832::LDY_DP:    return 0xA4;
-  case M65832::LDYr:      return 0xA4;  // GPR variant uses same opcode
-  case M65832::LDY_IMM:   return 0xA0;
-  case M65832::STX_DP:    return 0x86;
-  case M65832::STXr:      return 0x86;  // GPR variant uses same opcode
-  case M65832::STY_DP:    return 0x84;
-  case M65832::STYr:      return 0x84;  // GPR variant uses same opcode
-  case M65832::STZ_DP:    return 0x64;
-  case M65832::STZr:      return 0x64;  // GPR variant uses same opcode
-  case M65832::STZ_ABS:   return 0x9C;
-  
-  // Arithmetic
-  case M65832::ADC_DP:    return 0x65;
-  case M65832::ADCr:      return 0x65;  // GPR variant uses same opcode
-  case M65832::ADC_IMM:   return 0x69;
-  case M65832::ADC_IND_r: return 0x72;  // GPR indirect variant
-  case M65832::ADC_IND_Y_r: return 0x71;  // GPR indirect Y variant
-  case M65832::SBC_DP:    return 0xE5;
-  case M65832::SBCr:      return 0xE5;  // GPR variant uses same opcode
-  case M65832::SBC_IMM:   return 0xE9;
-  case M65832::INC_A:     return 0x1A;
-  case M65832::DEC_A:     return 0x3A;
-  case M65832::INC_DP:    return 0xE6;
-  case M65832::INCr:      return 0xE6;  // GPR variant uses same opcode
-  case M65832::DEC_DP:    return 0xC6;
-  case M65832::DECr:      return 0xC6;  // GPR variant uses same opcode
-  
-  // Logic
-  case M65832::AND_DP:    return 0x25;
-  case M65832::ANDr:      return 0x25;  // GPR variant uses same opcode
-  case M65832::AND_IMM:   return 0x29;
-  case M65832::ORA_DP:    return 0x05;
-  case M65832::ORAr:      return 0x05;  // GPR variant uses same opcode
-  case M65832::ORA_IMM:   return 0x09;
-  case M65832::EOR_DP:    return 0x45;
-  case M65832::EORr:      return 0x45;  // GPR variant uses same opcode
-  case M65832::EOR_IMM:   return 0x49;
-  
-  // Shift
-  case M65832::ASL_A:     return 0x0A;
-  case M65832::ASL_DP:    return 0x06;
-  case M65832::ASLr:      return 0x06;  // GPR variant uses same opcode
-  case M65832::LSR_A:     return 0x4A;
-  case M65832::LSR_DP:    return 0x46;
-  case M65832::LSRr:      return 0x46;  // GPR variant uses same opcode
-  case M65832::ROL_A:     return 0x2A;
-  case M65832::ROL_DP:    return 0x26;
-  case M65832::ROLr:      return 0x26;  // GPR variant uses same opcode
-  case M65832::ROR_A:     return 0x6A;
-  case M65832::ROR_DP:    return 0x66;
-  case M65832::RORr:      return 0x66;  // GPR variant uses same opcode
-  
-  // Compare
-  case M65832::CMP_DP:    return 0xC5;
-  case M65832::CMPr:      return 0xC5;  // GPR variant uses same opcode
-  case M65832::CMP_IMM:   return 0xC9;
-  case M65832::SB_IMM:    return 0x22;
-  case M65832::SB_DP:     return 0x23;
-  
-  // Flags
-  case M65832::REP:       return 0xC2;
-  case M65832::SEP:       return 0xE2;
-  case M65832::CLC:       return 0x18;
-  case M65832::SEC:       return 0x38;
-  case M65832::CLI:       return 0x58;
-  case M65832::SEI:       return 0x78;
-  case M65832::CLD:       return 0xD8;
-  case M65832::SED:       return 0xF8;
-  case M65832::CLV:       return 0xB8;
-  
-  // Transfer
-  case M65832::TAX:       return 0xAA;
-  case M65832::TXA:       return 0x8A;
-  case M65832::TAY:       return 0xA8;
-  case M65832::TYA:       return 0x98;
-  case M65832::TSX:       return 0xBA;
-  case M65832::TXS:       return 0x9A;
-  
-  // Increment/Decrement X/Y
-  case M65832::INX:       return 0xE8;
-  case M65832::INY:       return 0xC8;
-  case M65832::DEX:       return 0xCA;
-  case M65832::DEY:       return 0x88;
-  
-  // Branch
-  case M65832::BEQ:       return 0xF0;
-  case M65832::BNE:       return 0xD0;
-  case M65832::BCS:       return 0xB0;
-  case M65832::BCC:       return 0x90;
-  case M65832::BMI:       return 0x30;
-  case M65832::BPL:       return 0x10;
-  case M65832::BVS:       return 0x70;
-  case M65832::BVC:       return 0x50;
-  case M65832::BRA:       return 0x80;
-  case M65832::BRL:       return 0x82;
-  
-  // Jump/Call
-  case M65832::JMP:       return 0x4C;
-  case M65832::JMP_IND:   return 0x6C;
-  case M65832::JSR:       return 0x20;
-  case M65832::RTS:       return 0x60;
-  case M65832::RTI:       return 0x40;
-  
-  // Stack
-  case M65832::PHA:       return 0x48;
-  case M65832::PLA:       return 0x68;
-  case M65832::PHX:       return 0xDA;
-  case M65832::PLX:       return 0xFA;
-  case M65832::PHY:       return 0x5A;
-  case M65832::PLY:       return 0x7A;
-  case M65832::PHP:       return 0x08;
-  case M65832::PLP:       return 0x28;
-  case M65832::PHB:       return 0x8B;
-  case M65832::PLB:       return 0xAB;
-  case M65832::PHD32:     return 0x70;
-  case M65832::PLD32:     return 0x71;
-  case M65832::PHB32:     return 0x72;
-  case M65832::PLB32:     return 0x73;
-  
-  // Misc
-  case M65832::NOP:       return 0xEA;
-  case M65832::STP:       return 0xDB;
-  case M65832::WAI:       return 0xCB;
-  
-  // Extended instructions ($02 prefix)
-  case M65832::MUL_DP:    return 0x00;
-  case M65832::MULU_DP:   return 0x01;
-  case M65832::DIV_DP:    return 0x04;
-  case M65832::DIVU_DP:   return 0x05;
-  case M65832::CAS_DP:    return 0x10;
-  case M65832::RSET:      return 0x30;
-  case M65832::RCLR:      return 0x31;
-  case M65832::TRAP:      return 0x40;
-  case M65832::FENCE:     return 0x50;
-  case M65832::FENCER:    return 0x51;
-  case M65832::FENCEW:    return 0x52;
-  case M65832::TAB:       return 0x91;
-  case M65832::TBA:       return 0x92;
-  case M65832::TXB:       return 0x93;
-  case M65832::TBX:       return 0x94;
-  case M65832::TYB:       return 0x95;
-  case M65832::TBY:       return 0x96;
-  case M65832::TSPB:      return 0xA4;
-  case M65832::TTA:       return 0x9A;
-  case M65832::TAT:       return 0x9B;
-  
-  // Extended ALU opcodes ($02 $80-$97)
-  case M65832::MOVR_DP:   return 0x80;
-  case M65832::LDR_IMM:   return 0x80;
-  case M65832::ADDR_DP:   return 0x82;
-  case M65832::ADDR_IMM:  return 0x82;
-  case M65832::SUBR_DP:   return 0x83;
-  case M65832::SUBR_IMM:  return 0x83;
-  case M65832::ANDR_DP:   return 0x84;
-  case M65832::ANDR_IMM:  return 0x84;
-  case M65832::ORAR_DP:   return 0x85;
-  case M65832::ORAR_IMM:  return 0x85;
-  case M65832::EORR_DP:   return 0x86;
-  case M65832::EORR_IMM:  return 0x86;
-  case M65832::CMPR_DP:   return 0x87;
-  case M65832::CMPR_IMM:  return 0x87;
-  
-  // Extended ALU - byte operations (LD.B/ST.B)
-  case M65832::LDB_DP:    return 0x80;
-  case M65832::LDB_ABS:   return 0x80;
-  case M65832::LDB_IND_Y: return 0x80;
-  case M65832::STB_DP:    return 0x81;
-  case M65832::STB_ABS:   return 0x81;
-  case M65832::STB_IND_Y: return 0x81;
-  
-  // Extended ALU - word operations (LD.W/ST.W)
-  case M65832::LDW_DP:    return 0x80;
-  case M65832::LDW_ABS:   return 0x80;
-  case M65832::LDW_IND_Y: return 0x80;
-  case M65832::STW_DP:    return 0x81;
-  case M65832::STW_ABS:   return 0x81;
-  case M65832::STW_IND_Y: return 0x81;
-  
-  // Barrel shifter - opcode encodes op|cnt
-  case M65832::SHLR:      return 0x00;
-  case M65832::SHRR:      return 0x20;
-  case M65832::SARR:      return 0x40;
-  case M65832::ROLR:      return 0x60;
-  case M65832::RORR:      return 0x80;
-  case M65832::SHLR_VAR:  return 0x1F;
-  case M65832::SHRR_VAR:  return 0x3F;
-  case M65832::SARR_VAR:  return 0x5F;
-  
-  // Extend operations
-  case M65832::SEXT8:     return 0x00;
-  case M65832::SEXT16:    return 0x01;
-  case M65832::ZEXT8:     return 0x02;
-  case M65832::ZEXT16:    return 0x03;
-  case M65832::CLZ:       return 0x04;
-  case M65832::CTZ:       return 0x05;
-  case M65832::POPCNT:    return 0x06;
-  
-  default:
-    return 0xEA; // NOP as fallback
-  }
-}
-
 void M65832MCCodeEmitter::encodeInstruction(const MCInst &MI,
                                               SmallVectorImpl<char> &CB,
                                               SmallVectorImpl<MCFixup> &Fixups,
@@ -325,7 +98,8 @@ void M65832MCCodeEmitter::encodeInstruction(const MCInst &MI,
   const MCInstrDesc &Desc = MCII.get(MI.getOpcode());
   unsigned Size = Desc.getSize();
   unsigned MIOp = MI.getOpcode();
-  uint8_t Opcode = getOpcode(MI.getOpcode());
+  uint64_t TSFlags = Desc.TSFlags;
+  uint8_t Opcode = M65832II::getOpcode(TSFlags);
 
   // Helper to evaluate constant expressions from inline assembly
   auto tryEvaluateConstant = [&](const MCExpr *Expr, int64_t &Value) -> bool {
@@ -344,8 +118,12 @@ void M65832MCCodeEmitter::encodeInstruction(const MCInst &MI,
       if (tryEvaluateConstant(MO.getExpr(), Value)) {
         emitByte(static_cast<uint8_t>(Value), CB);
       } else {
-        Fixups.push_back(
-            MCFixup::create(Offset, MO.getExpr(), MCFixupKind(FK_Data_1)));
+        // %dp(sym) from a .dpdata access (LDA $xx)
+        MCFixupKind Kind = MCFixupKind(FK_Data_1);
+        if (const auto *SE = dyn_cast<MCSpecifierExpr>(MO.getExpr()))
+          if (SE->getSpecifier() == M65832::S_DP)
+            Kind = MCFixupKind(M65832::fixup_m65832_dp_8);
+        Fixups.push_back(MCFixup::create(Offset, MO.getExpr(), Kind));
         emitByte(0, CB);
       }
     } else {
@@ -375,6 +153,10 @@ void M65832MCCodeEmitter::encodeInstruction(const MCInst &MI,
         // so we use a custom fixup kind to identify PC-relative fixups instead.
         MCFixupKind Kind = IsPCRel ? MCFixupKind(M65832::fixup_m65832_pcrel_16) 
                                    : MCFixupKind(FK_Data_2);
+        // B+%bankrel(sym) from a -mcmodel=bank global access
+        if (const auto *SE = dyn_cast<MCSpecifierExpr>(MO.getExpr()))
+          if (SE->getSpecifier() == M65832::S_BANKREL)
+            Kind = MCFixupKind(M65832::fixup_m65832_bankrel_16);
         const MCExpr *Expr = MO.getExpr();
         
         // For PC-relative branches, the M65832 calculates target from the 
@@ -404,8 +186,41 @@ void M65832MCCodeEmitter::encodeInstruction(const MCInst &MI,
       if (tryEvaluateConstant(MO.getExpr(), Value)) {
         emitLE32(static_cast<uint32_t>(Value), CB);
       } else {
-        Fixups.push_back(
-            MCFixup::create(Offset, MO.getExpr(), MCFixupKind(FK_Data_4)));
+        // %gprel(sym) from a small-data access (LDY #%gprel(sym))
+        MCFixupKind Kind = MCFixupKind(FK_Data_4);
+        const MCExpr *Expr = MO.getExpr();
+        bool Relaxable = false;
+        if (const auto *SE = dyn_cast<MCSpecifierExpr>(Expr)) {
+          if (SE->getSpecifier() == M65832::S_GPREL) {
+            Kind = MCFixupKind(M65832::fixup_m65832_gprel_32);
+          } else if (SE->getSpecifier() == M65832::S_TPREL) {
+            // %tprel(sym) from a TLS access (LDY #%tprel(sym), or the
+            // ADC #%tprel(sym) added to R56)
+            Kind = MCFixupKind(M65832::fixup_m65832_tprel_32);
+          } else if (SE->getSpecifier() == M65832::S_BANKABS) {
+            // %bankabs(sym) from a -mrelax global access: a plain 32-bit
+            // address the linker may turn into the abs16 (B+addr) form,
+            // which only the extended-ALU abs32 mode byte can express
+            Kind = MCFixupKind(M65832::fixup_m65832_32);
+            Expr = SE->getSubExpr();
+            Relaxable = M65832II::getFormat(TSFlags) == M65832II::FrmExtALU &&
+                        (M65832II::getExtMode(TSFlags) & 0x1F) == 0x10;
+          } else if (SE->getSpecifier() == M65832::S_JMPABS) {
+            // %jmpabs(sym) from a -mrelax tail call: the LD.L R31,#sym of
+            // LD.L R31,#sym; JMP (R31), which the linker may turn into BRA
+            Kind = MCFixupKind(M65832::fixup_m65832_32);
+            Expr = SE->getSubExpr();
+            Relaxable = M65832II::getFormat(TSFlags) == M65832II::FrmExtALU;
+          } else if (SE->getSpecifier() == M65832::S_PCREL) {
+            // %pcrel(sym) from a -fPIC address, the ADC #imm added to the
+            // PC that PER pushed
+            Kind = MCFixupKind(M65832::fixup_m65832_pcrel_32);
+            Expr = SE->getSubExpr();
+          }
+        }
+        Fixups.push_back(MCFixup::create(Offset, Expr, Kind));
+        if (Relaxable)
+          Fixups.back().setLinkerRelaxable();
         emitLE32(0, CB);
       }
     } else {
@@ -427,343 +242,97 @@ void M65832MCCodeEmitter::encodeInstruction(const MCInst &MI,
     }
   };
 
-  // Extended instructions ($02 prefix)
-  // Note: PHB and PLB are NOT extended - they use standard 65816 opcodes 0x8B and 0xAB
-  switch (MIOp) {
-  case M65832::MUL_DP:
-  case M65832::MULU_DP:
-  case M65832::DIV_DP:
-  case M65832::DIVU_DP:
-  case M65832::CAS_DP: {
-    emitByte(EXT_PREFIX, CB);
-    emitByte(Opcode, CB);
-    const MCOperand &MO = MI.getOperand(MI.getNumOperands() - 1);
-    emitImm8(MO, 2);
-    return;
-  }
-  case M65832::RSET:
-  case M65832::RCLR:
-  case M65832::FENCE:
-  case M65832::FENCER:
-  case M65832::FENCEW:
-  case M65832::PHD32:
-  case M65832::PLD32:
-  case M65832::PHB32:
-  case M65832::PLB32:
-  case M65832::TAB:
-  case M65832::TBA:
-  case M65832::TXB:
-  case M65832::TBX:
-  case M65832::TYB:
-  case M65832::TBY:
-  case M65832::TSPB:
-  case M65832::TTA:
-  case M65832::TAT: {
-    emitByte(EXT_PREFIX, CB);
-    emitByte(Opcode, CB);
-    return;
-  }
-  case M65832::SB_DP: {
-    // SB dp - Set B from direct page (3 bytes: $02 $23 dp)
-    emitByte(EXT_PREFIX, CB);
-    emitByte(Opcode, CB);
-    const MCOperand &MO = MI.getOperand(0);
-    emitDPOp(MO, 2);
-    return;
-  }
-  case M65832::JMP_DP_IND: {
-    // JMP (dp) - Jump indirect through DP (3 bytes: $02 $A5 dp)
-    emitByte(EXT_PREFIX, CB);
-    emitByte(0xA5, CB);
-    const MCOperand &MO = MI.getOperand(0);
-    emitDPOp(MO, 2);
-    return;
-  }
-  case M65832::JSR_DP_IND: {
-    // JSR (dp) - Call indirect through DP (3 bytes: $02 $A6 dp)
-    emitByte(EXT_PREFIX, CB);
-    emitByte(0xA6, CB);
-    const MCOperand &MO = MI.getOperand(0);
-    emitDPOp(MO, 2);
-    return;
-  }
-  case M65832::SB_IMM: {
-    // SB #imm32 - Set B from immediate (6 bytes: $02 $22 imm32)
-    emitByte(EXT_PREFIX, CB);
-    emitByte(Opcode, CB);
-    const MCOperand &MO = MI.getOperand(0);
-    emitImm32(MO, 2);
-    return;
-  }
-  case M65832::TRAP: {
-    emitByte(EXT_PREFIX, CB);
-    emitByte(Opcode, CB);
+  // The trailing operand as a Width-byte field at Offset. Operand-less
+  // forms (MVN/MVP) encode the field as zero.
+  auto emitLastOp = [&](unsigned Offset, unsigned Width, bool IsPCRel) {
+    if (MI.getNumOperands() == 0) {
+      for (unsigned I = 0; I != Width; ++I)
+        emitByte(0, CB);
+      return;
+    }
     const MCOperand &MO = MI.getOperand(MI.getNumOperands() - 1);
-    emitImm8(MO, 2);
-    return;
-  }
-
-  // Extended ALU (dp source)
-  case M65832::MOVR_DP:
-  case M65832::ADDR_DP:
-  case M65832::SUBR_DP:
-  case M65832::ANDR_DP:
-  case M65832::ORAR_DP:
-  case M65832::EORR_DP:
-  case M65832::CMPR_DP: {
-    emitByte(EXT_PREFIX, CB);
-    emitByte(Opcode, CB);
-    emitByte(0xA0, CB); // size=long, target=Rn, addr_mode=dp
-    if (MI.getNumOperands() >= 1 && MI.getOperand(0).isReg())
-      emitByte(regToDP(MI.getOperand(0).getReg()), CB);
-    else
-      emitByte(0, CB);
-    const MCOperand &SrcOp = MI.getOperand(MI.getNumOperands() - 1);
-    emitDPOp(SrcOp, 4);
-    return;
-  }
-
-  // Extended ALU (immediate)
-  case M65832::LDR_IMM:
-  case M65832::ADDR_IMM:
-  case M65832::SUBR_IMM:
-  case M65832::ANDR_IMM:
-  case M65832::ORAR_IMM:
-  case M65832::EORR_IMM:
-  case M65832::CMPR_IMM: {
-    emitByte(EXT_PREFIX, CB);
-    emitByte(Opcode, CB);
-    emitByte(0xB8, CB); // size=long, target=Rn, addr_mode=imm
-    if (MI.getNumOperands() >= 1 && MI.getOperand(0).isReg())
-      emitByte(regToDP(MI.getOperand(0).getReg()), CB);
-    else
-      emitByte(0, CB);
-    const MCOperand &ImmOp = MI.getOperand(MI.getNumOperands() - 1);
-    emitImm32(ImmOp, 4);
-    return;
-  }
-
-  // Extended ALU - BYTE (8-bit) operations
-  // Mode byte: [size:2=00][target:1=1][addr_mode:5]
-  // addr_mode: 0=dp, 4=(dp)Y, 8=abs
-  case M65832::LDB_DP: {
-    emitByte(EXT_PREFIX, CB);
-    emitByte(Opcode, CB);
-    emitByte(0x20, CB); // size=byte(00), target=Rn(1), addr_mode=dp(0)
-    if (MI.getNumOperands() >= 1 && MI.getOperand(0).isReg())
-      emitByte(regToDP(MI.getOperand(0).getReg()), CB);
-    else
-      emitByte(0, CB);
-    const MCOperand &SrcOp = MI.getOperand(MI.getNumOperands() - 1);
-    emitDPOp(SrcOp, 4);
-    return;
-  }
-  case M65832::STB_DP: {
-    emitByte(EXT_PREFIX, CB);
-    emitByte(Opcode, CB);
-    emitByte(0x20, CB); // size=byte(00), target=Rn(1), addr_mode=dp(0)
-    // For ST: dest_dp = value register, src_operand = dest address register
-    // Operand 0 = src (value to store), Operand 1 = dst (address)
-    if (MI.getNumOperands() >= 1 && MI.getOperand(0).isReg())
-      emitByte(regToDP(MI.getOperand(0).getReg()), CB);  // value reg (dest_dp)
-    else
-      emitByte(0, CB);
-    if (MI.getNumOperands() >= 2 && MI.getOperand(1).isReg())
-      emitByte(regToDP(MI.getOperand(1).getReg()), CB);  // dest address
-    else
-      emitByte(0, CB);
-    return;
-  }
-  case M65832::LDB_ABS: {
-    emitByte(EXT_PREFIX, CB);
-    emitByte(Opcode, CB);
-    emitByte(0x28, CB); // size=byte(00), target=Rn(1), addr_mode=abs(8)
-    if (MI.getNumOperands() >= 1 && MI.getOperand(0).isReg())
-      emitByte(regToDP(MI.getOperand(0).getReg()), CB);
-    else
-      emitByte(0, CB);
-    const MCOperand &AddrOp = MI.getOperand(MI.getNumOperands() - 1);
-    emitImm16(AddrOp, 4);
-    return;
-  }
-  case M65832::STB_ABS: {
-    emitByte(EXT_PREFIX, CB);
-    emitByte(Opcode, CB);
-    emitByte(0x28, CB); // size=byte(00), target=Rn(1), addr_mode=abs(8)
-    // For stores: emit dest address register, then src register address
-    if (MI.getNumOperands() >= 1 && MI.getOperand(0).isReg())
-      emitByte(regToDP(MI.getOperand(0).getReg()), CB);
-    else
-      emitByte(0, CB);
-    const MCOperand &AddrOp = MI.getOperand(MI.getNumOperands() - 1);
-    emitImm16(AddrOp, 4);
-    return;
-  }
-  case M65832::LDB_IND_Y: {
-    emitByte(EXT_PREFIX, CB);
-    emitByte(Opcode, CB);
-    emitByte(0x24, CB); // size=byte(00), target=Rn(1), addr_mode=(dp)Y(4)
-    if (MI.getNumOperands() >= 1 && MI.getOperand(0).isReg())
-      emitByte(regToDP(MI.getOperand(0).getReg()), CB);
-    else
-      emitByte(0, CB);
-    if (MI.getNumOperands() >= 2 && MI.getOperand(1).isReg())
-      emitByte(regToDP(MI.getOperand(1).getReg()), CB);
-    else
-      emitByte(0, CB);
-    return;
-  }
-  case M65832::STB_IND_Y: {
-    emitByte(EXT_PREFIX, CB);
-    emitByte(Opcode, CB);
-    emitByte(0x24, CB); // size=byte(00), target=Rn(1), addr_mode=(dp)Y(4)
-    // For ST: dest_dp = value register, src_operand = address register
-    // Operand 0 = src (value to store), Operand 1 = base (address)
-    if (MI.getNumOperands() >= 1 && MI.getOperand(0).isReg())
-      emitByte(regToDP(MI.getOperand(0).getReg()), CB);  // value reg (dest_dp)
-    else
-      emitByte(0, CB);
-    if (MI.getNumOperands() >= 2 && MI.getOperand(1).isReg())
-      emitByte(regToDP(MI.getOperand(1).getReg()), CB);  // address reg (src)
-    else
-      emitByte(0, CB);
-    return;
-  }
+    switch (Width) {
+    case 1:
+      emitDPOp(MO, Offset);
+      break;
+    case 2:
+      emitImm16(MO, Offset, IsPCRel);
+      break;
+    default:
+      emitImm32(MO, Offset);
+      break;
+    }
+  };
 
-  // Extended ALU - WORD (16-bit) operations
-  // Mode byte: [size:2=01][target:1=1][addr_mode:5]
-  case M65832::LDW_DP: {
-    emitByte(EXT_PREFIX, CB);
+  switch (M65832II::getFormat(TSFlags)) {
+  case M65832II::FrmStd: {
+    // opcode [dp | abs16/rel16 | imm32]
     emitByte(Opcode, CB);
-    emitByte(0x60, CB); // size=word(01), target=Rn(1), addr_mode=dp(0)
-    if (MI.getNumOperands() >= 1 && MI.getOperand(0).isReg())
-      emitByte(regToDP(MI.getOperand(0).getReg()), CB);
-    else
-      emitByte(0, CB);
-    const MCOperand &SrcOp = MI.getOperand(MI.getNumOperands() - 1);
-    emitDPOp(SrcOp, 4);
-    return;
-  }
-  case M65832::STW_DP: {
-    emitByte(EXT_PREFIX, CB);
-    emitByte(Opcode, CB);
-    emitByte(0x60, CB); // size=word(01), target=Rn(1), addr_mode=dp(0)
-    // For ST: dest_dp = value register, src_operand = dest address register
-    // Operand 0 = src (value to store), Operand 1 = dst (address)
-    if (MI.getNumOperands() >= 1 && MI.getOperand(0).isReg())
-      emitByte(regToDP(MI.getOperand(0).getReg()), CB);  // value reg (dest_dp)
-    else
-      emitByte(0, CB);
-    if (MI.getNumOperands() >= 2 && MI.getOperand(1).isReg())
-      emitByte(regToDP(MI.getOperand(1).getReg()), CB);  // dest address
-    else
-      emitByte(0, CB);
+    if (Size > 1) {
+      bool IsPCRel = Desc.getNumOperands() > 0 &&
+                     Desc.operands().back().OperandType == MCOI::OPERAND_PCREL;
+      emitLastOp(1, Size - 1, IsPCRel);
+    }
     return;
   }
-  case M65832::LDW_ABS: {
+  case M65832II::FrmExt:
+    // $02 opcode [dp | imm8 | abs16 | imm32]
+    // Note: PHB and PLB are NOT extended - they use standard 65816 opcodes 0x8B and 0xAB
     emitByte(EXT_PREFIX, CB);
     emitByte(Opcode, CB);
-    emitByte(0x68, CB); // size=word(01), target=Rn(1), addr_mode=abs(8)
-    if (MI.getNumOperands() >= 1 && MI.getOperand(0).isReg())
-      emitByte(regToDP(MI.getOperand(0).getReg()), CB);
-    else
-      emitByte(0, CB);
-    const MCOperand &AddrOp = MI.getOperand(MI.getNumOperands() - 1);
-    emitImm16(AddrOp, 4);
+    if (Size > 2)
+      emitLastOp(2, Size - 2, /*IsPCRel=*/false);
     return;
-  }
-  case M65832::STW_ABS: {
+  case M65832II::FrmExtALU: {
+    // $02 opcode mode dest src. Loads and ALU ops name the destination in
+    // operand 0, stores the value register; the source or address is last.
+    uint8_t Mode = M65832II::getExtMode(TSFlags);
     emitByte(EXT_PREFIX, CB);
     emitByte(Opcode, CB);
-    emitByte(0x68, CB); // size=word(01), target=Rn(1), addr_mode=abs(8)
-    // For stores: emit src register, then address
-    if (MI.getNumOperands() >= 1 && MI.getOperand(0).isReg())
-      emitByte(regToDP(MI.getOperand(0).getReg()), CB);
-    else
-      emitByte(0, CB);
-    const MCOperand &AddrOp = MI.getOperand(MI.getNumOperands() - 1);
-    emitImm16(AddrOp, 4);
-    return;
-  }
-  case M65832::LDW_IND_Y: {
-    emitByte(EXT_PREFIX, CB);
-    emitByte(Opcode, CB);
-    emitByte(0x64, CB); // size=word(01), target=Rn(1), addr_mode=(dp)Y(4)
-    if (MI.getNumOperands() >= 1 && MI.getOperand(0).isReg())
-      emitByte(regToDP(MI.getOperand(0).getReg()), CB);
-    else
-      emitByte(0, CB);
-    if (MI.getNumOperands() >= 2 && MI.getOperand(1).isReg())
-      emitByte(regToDP(MI.getOperand(1).getReg()), CB);
-    else
-      emitByte(0, CB);
-    return;
-  }
-  case M65832::STW_IND_Y: {
-    emitByte(EXT_PREFIX, CB);
-    emitByte(Opcode, CB);
-    emitByte(0x64, CB); // size=word(01), target=Rn(1), addr_mode=(dp)Y(4)
-    // For ST: dest_dp = value register, src_operand = address register
-    // Operand 0 = src (value to store), Operand 1 = base (address)
-    if (MI.getNumOperands() >= 1 && MI.getOperand(0).isReg())
-      emitByte(regToDP(MI.getOperand(0).getReg()), CB);  // value reg (dest_dp)
-    else
-      emitByte(0, CB);
-    if (MI.getNumOperands() >= 2 && MI.getOperand(1).isReg())
-      emitByte(regToDP(MI.getOperand(1).getReg()), CB);  // address reg (src)
-    else
-      emitByte(0, CB);
-    return;
-  }
-
-  // Barrel shifter ($02 $98 op|cnt dest src)
-  case M65832::SHLR:
-  case M65832::SHRR:
-  case M65832::SARR:
-  case M65832::ROLR:
-  case M65832::RORR:
-  case M65832::SHLR_VAR:
-  case M65832::SHRR_VAR:
-  case M65832::SARR_VAR: {
+    emitByte(Mode, CB);
+    emitDPOp(MI.getOperand(0), 3);
+    // The operand field is whatever Size leaves after those four bytes, so
+    // the encoding never disagrees with getInstSizeInBytes. The mode byte
+    // implies the same width: addr_mode 0=dp, 4=(dp)Y, 8=abs, $10=abs32,
+    // $18=imm (operation size).
+    unsigned Width = Size - 4;
+#ifndef NDEBUG
+    unsigned AddrMode = Mode & 0x1F;
+    unsigned ModeWidth = AddrMode < 0x08   ? 1
+                         : AddrMode < 0x10 ? 2
+                         : AddrMode < 0x18 ? 4
+                                           : 1u << (Mode >> 6);
+    assert(Width == ModeWidth && "Size does not match the addressing mode");
+#endif
+    emitLastOp(4, Width, /*IsPCRel=*/false);
+    return;
+  }
+  case M65832II::FrmShift: {
+    // $02 $98 op|cnt dest src; the _VAR forms take the count from A
     emitByte(EXT_PREFIX, CB);
     emitByte(0x98, CB);
-    uint8_t opcnt = Opcode;
+    uint8_t OpCnt = Opcode;
     if (MI.getNumOperands() >= 3 && MI.getOperand(2).isImm())
-      opcnt = (Opcode & 0xE0) | (MI.getOperand(2).getImm() & 0x1F);
-    emitByte(opcnt, CB);
-    if (MI.getNumOperands() >= 1 && MI.getOperand(0).isReg())
-      emitByte(regToDP(MI.getOperand(0).getReg()), CB);
-    else
-      emitByte(0, CB);
-    if (MI.getNumOperands() >= 2 && MI.getOperand(1).isReg())
-      emitByte(regToDP(MI.getOperand(1).getReg()), CB);
-    else
-      emitByte(0, CB);
+      OpCnt = (Opcode & 0xE0) | (MI.getOperand(2).getImm() & 0x1F);
+    emitByte(OpCnt, CB);
+    emitDPOp(MI.getOperand(0), 3);
+    emitDPOp(MI.getOperand(1), 4);
     return;
   }
-
-  // Extend ops ($02 $99 subop dest src)
-  case M65832::SEXT8:
-  case M65832::SEXT16:
-  case M65832::ZEXT8:
-  case M65832::ZEXT16:
-  case M65832::CLZ:
-  case M65832::CTZ:
-  case M65832::POPCNT: {
+  case M65832II::FrmExtend:
+    // $02 $99 subop dest src
     emitByte(EXT_PREFIX, CB);
     emitByte(0x99, CB);
     emitByte(Opcode, CB);
-    if (MI.getNumOperands() >= 1 && MI.getOperand(0).isReg())
-      emitByte(regToDP(MI.getOperand(0).getReg()), CB);
-    else
-      emitByte(0, CB);
-    if (MI.getNumOperands() >= 2 && MI.getOperand(1).isReg())
-      emitByte(regToDP(MI.getOperand(1).getReg()), CB);
-    else
-      emitByte(0, CB);
+    emitDPOp(MI.getOperand(0), 3);
+    emitDPOp(MI.getOperand(1), 4);
     return;
+  case M65832II::FrmOther:
+    break;
   }
 
+  // FPU instructions are defined directly on Instruction and encoded here
+  switch (MIOp) {
   // FPU register-indirect load/store ($02 $B4/$B5 $nm)
   // LDF Fn, (Rm) / STF Fn, (Rm)
   // Encoding: $02 $B4 $nm for load, $02 $B5 $nm for store
@@ -813,6 +382,18 @@ void M65832MCCodeEmitter::encodeInstruction(const MCInst &MI,
     return;
   }
 
+  // FPU B-relative load/store ($02 $B1/$B3 $0n abs16)
+  // LDF Fn, B+abs16 / STF Fn, B+abs16
+  case M65832::LDF_abs:
+  case M65832::STF_abs: {
+    emitByte(EXT_PREFIX, CB);
+    emitByte(MI.getOpcode() == M65832::LDF_abs ? 0xB1 : 0xB3, CB);
+    unsigned FReg = MI.getOperand(0).getReg();
+    emitByte(FReg - M65832::F0, CB);
+    emitImm16(MI.getOperand(1), 3);
+    return;
+  }
+
   // FPU binary arithmetic ($02 opcode $nm) - single precision
   case M65832::FADD_S:
   case M65832::FSUB_S:
@@ -897,6 +478,65 @@ void M65832MCCodeEmitter::encodeInstruction(const MCInst &MI,
     return;
   }
 
+  // FPU minNum/maxNum ($02 opcode $ds), two-address like FADD
+  case M65832::FMIN_S:
+  case M65832::FMAX_S:
+  case M65832::FMIN_D:
+  case M65832::FMAX_D: {
+    emitByte(EXT_PREFIX, CB);
+    unsigned opcodeVal = 0xCB;
+    switch (MIOp) {
+    case M65832::FMIN_S: opcodeVal = 0xCB; break;
+    case M65832::FMAX_S: opcodeVal = 0xCC; break;
+    case M65832::FMIN_D: opcodeVal = 0xDB; break;
+    case M65832::FMAX_D: opcodeVal = 0xDC; break;
+    }
+    emitByte(opcodeVal, CB);
+    unsigned d = MI.getOperand(0).getReg() - M65832::F0;
+    unsigned s = MI.getOperand(2).getReg() - M65832::F0;  // Operand 1 is tied
+    emitByte((d << 4) | s, CB);
+    return;
+  }
+
+  // FPU fused multiply-add ($02 opcode $ds $t0): Fd = Fd + Fs * Ft
+  case M65832::FMADD_S:
+  case M65832::FMADD_D: {
+    emitByte(EXT_PREFIX, CB);
+    emitByte(MIOp == M65832::FMADD_S ? 0xCD : 0xDD, CB);
+    unsigned d = MI.getOperand(0).getReg() - M65832::F0;
+    unsigned s = MI.getOperand(2).getReg() - M65832::F0;  // Operand 1 is tied
+    unsigned t = MI.getOperand(3).getReg() - M65832::F0;
+    emitByte((d << 4) | s, CB);
+    emitByte(t << 4, CB);
+    return;
+  }
+
+  // FPU round to integral ($02 opcode $ds $mode)
+  case M65832::FRINTN_S:
+  case M65832::FRINTZ_S:
+  case M65832::FRINTM_S:
+  case M65832::FRINTP_S:
+  case M65832::FRINTN_D:
+  case M65832::FRINTZ_D:
+  case M65832::FRINTM_D:
+  case M65832::FRINTP_D: {
+    unsigned Mode = 0;
+    switch (MIOp) {
+    case M65832::FRINTZ_S: case M65832::FRINTZ_D: Mode = 1; break;
+    case M65832::FRINTM_S: case M65832::FRINTM_D: Mode = 2; break;
+    case M65832::FRINTP_S: case M65832::FRINTP_D: Mode = 3; break;
+    }
+    bool IsDouble = MIOp == M65832::FRINTN_D || MIOp == M65832::FRINTZ_D ||
+                    MIOp == M65832::FRINTM_D || MIOp == M65832::FRINTP_D;
+    emitByte(EXT_PREFIX, CB);
+    emitByte(IsDouble ? 0xDE : 0xCE, CB);
+    unsigned d = MI.getOperand(0).getReg() - M65832::F0;
+    unsigned s = MI.getOperand(1).getReg() - M65832::F0;
+    emitByte((d << 4) | s, CB);
+    emitByte(Mode, CB);
+    return;
+  }
+
   // FPU compare ($02 opcode $nm)
   case M65832::FCMP_S: {
     emitByte(EXT_PREFIX, CB);
@@ -975,70 +615,44 @@ void M65832MCCodeEmitter::encodeInstruction(const MCInst &MI,
     return;
   }
 
-  default:
-    break;
-  }
-
-  // Standard encodings by size
-  switch (Size) {
-  case 0:
-  case 1:
-    emitByte(Opcode, CB);
-    break;
-  case 2: {
-    emitByte(Opcode, CB);
-    if (MI.getNumOperands() > 0) {
-      const MCOperand &MO = MI.getOperand(MI.getNumOperands() - 1);
-      // Use emitDPOp to handle both register operands (R0-R63) and immediates
-      emitDPOp(MO, 1);
-    } else {
-      emitByte(0, CB);
-    }
-    break;
-  }
-  case 3: {
-    emitByte(Opcode, CB);
-    if (MI.getNumOperands() > 0) {
-      const MCOperand &MO = MI.getOperand(MI.getNumOperands() - 1);
-      // Check if this is a branch instruction (needs PC-relative fixup)
-      bool IsBranch = false;
-      switch (MIOp) {
-      case M65832::BEQ:
-      case M65832::BNE:
-      case M65832::BCS:
-      case M65832::BCC:
-      case M65832::BMI:
-      case M65832::BPL:
-      case M65832::BVS:
-      case M65832::BVC:
-      case M65832::BRA:
-      case M65832::BRL:
-        IsBranch = true;
-        break;
-      default:
-        break;
-      }
-      emitImm16(MO, 1, IsBranch);
-    } else {
-      emitLE16(0, CB);
+  // FPU register transfers: $02 op (f<<4)|f. FTOA/FTOT take the FPR as
+  // their only operand; ATOF/TTOF have it as the tied def.
+  case M65832::FTOA:
+  case M65832::FTOT:
+  case M65832::ATOF:
+  case M65832::TTOF: {
+    unsigned Op;
+    switch (MIOp) {
+    case M65832::FTOA: Op = 0xE0; break;
+    case M65832::FTOT: Op = 0xE1; break;
+    case M65832::ATOF: Op = 0xE2; break;
+    default:           Op = 0xE3; break;
     }
-    break;
+    emitByte(EXT_PREFIX, CB);
+    emitByte(Op, CB);
+    unsigned f = MI.getOperand(0).getReg() - M65832::F0;
+    emitByte((f << 4) | f, CB);
+    return;
   }
-  case 5: {
-    emitByte(Opcode, CB);
-    if (MI.getNumOperands() > 0) {
-      const MCOperand &MO = MI.getOperand(MI.getNumOperands() - 1);
-      emitImm32(MO, 1);
-    } else {
-      emitLE32(0, CB);
-    }
-    break;
+
+  // FPU precision conversion ($02 opcode $ds)
+  case M65832::FCVT_DS:
+  case M65832::FCVT_SD: {
+    emitByte(EXT_PREFIX, CB);
+    emitByte(MIOp == M65832::FCVT_DS ? 0xE4 : 0xE5, CB);
+    unsigned d = MI.getOperand(0).getReg() - M65832::F0;
+    unsigned s = MI.getOperand(1).getReg() - M65832::F0;
+    emitByte((d << 4) | s, CB);
+    return;
   }
+
   default:
-    for (unsigned i = 0; i < Size; ++i)
-      emitByte(0xEA, CB);
     break;
   }
+
+  // No encoding for this instruction: keep the layout intact with NOPs
+  for (unsigned i = 0; i < Size; ++i)
+    emitByte(0xEA, CB);
 }
 
 unsigned M65832MCCodeEmitter::getMachineOpValue(const MCInst &MI,
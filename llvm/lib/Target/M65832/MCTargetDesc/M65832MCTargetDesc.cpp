@@ -15,11 +15,14 @@
 #include "M65832MCAsmInfo.h"
 #include "TargetInfo/M65832TargetInfo.h"
 #include "llvm/MC/MCDwarf.h"
+#include "llvm/MC/MCInstrAnalysis.h"
 #include "llvm/MC/MCInstrInfo.h"
 #include "llvm/MC/MCRegisterInfo.h"
 #include "llvm/MC/MCSubtargetInfo.h"
 #include "llvm/MC/TargetRegistry.h"
 #include "llvm/Support/ErrorHandling.h"
+#include <bitset>
+#include <optional>
 
 using namespace llvm;
 
@@ -64,13 +67,169 @@ static MCAsmInfo *createM65832MCAsmInfo(const MCRegisterInfo &MRI,
                                          const MCTargetOptions &Options) {
   MCAsmInfo *MAI = new M65832MCAsmInfo(TT);
 
-  // Initial state of the frame pointer is SP.
-  MCCFIInstruction Inst = MCCFIInstruction::cfiDefCfa(nullptr, M65832::SP, 0);
-  MAI->addInitialFrameState(Inst);
+  // On entry the CFA (the caller's SP) is just above the return address
+  // JSR pushed. The return address column is R30 (lr), which is
+  // caller-saved, so handing it the return address in the caller's frame
+  // loses nothing.
+  unsigned SP = MRI.getDwarfRegNum(M65832::SP, true);
+  unsigned RA = MRI.getDwarfRegNum(M65832::R30, true);
+  MAI->addInitialFrameState(MCCFIInstruction::cfiDefCfa(nullptr, SP, 4));
+  MAI->addInitialFrameState(MCCFIInstruction::createOffset(nullptr, RA, -4));
 
   return MAI;
 }
 
+namespace {
+
+class M65832MCInstrAnalysis : public MCInstrAnalysis {
+  /// Constants last loaded into R0-R63 in the current block. Direct tail
+  /// calls and calls through a loaded address go LD.L Rn,#target;
+  /// JMP/JSR (Rn), so this is what recovers their targets.
+  int64_t GPRState[64] = {};
+  std::bitset<64> GPRValidMask;
+
+  static bool isGPR(MCRegister Reg) {
+    return Reg >= M65832::R0 && Reg <= M65832::R63;
+  }
+
+  void setGPRState(MCRegister Reg, std::optional<int64_t> Value) {
+    unsigned Index = Reg - M65832::R0;
+    if (Value) {
+      GPRState[Index] = *Value;
+      GPRValidMask.set(Index);
+    } else {
+      GPRValidMask.reset(Index);
+    }
+  }
+
+  std::optional<int64_t> getGPRState(MCRegister Reg) const {
+    unsigned Index = Reg - M65832::R0;
+    if (GPRValidMask.test(Index))
+      return GPRState[Index];
+    return std::nullopt;
+  }
+
+  /// Standard opcodes that write the DP slot named by their DP operand
+  static bool writesDPSlot(unsigned Opcode) {
+    switch (Opcode) {
+    case M65832::STA_DP:
+    case M65832::STX_DP:
+    case M65832::STY_DP:
+    case M65832::STZ_DP:
+    case M65832::INC_DP:
+    case M65832::DEC_DP:
+    case M65832::ASL_DP:
+    case M65832::LSR_DP:
+    case M65832::ROL_DP:
+    case M65832::ROR_DP:
+      return true;
+    default:
+      return false;
+    }
+  }
+
+public:
+  explicit M65832MCInstrAnalysis(const MCInstrInfo *Info)
+      : MCInstrAnalysis(Info) {}
+
+  void resetState() override { GPRValidMask.reset(); }
+
+  void updateState(const MCInst &Inst, uint64_t Addr) override {
+    // A terminator ends the block and a callee may clobber anything
+    if (isTerminator(Inst) || isCall(Inst)) {
+      resetState();
+      return;
+    }
+
+    switch (Inst.getOpcode()) {
+    case M65832::LDR_IMM:
+    case M65832::LDW_IMM:
+    case M65832::LDB_IMM:
+      if (Inst.getOperand(1).isImm()) {
+        setGPRState(Inst.getOperand(0).getReg(),
+                    static_cast<uint32_t>(Inst.getOperand(1).getImm()));
+        return;
+      }
+      break;
+    case M65832::MOVR_DP:
+      setGPRState(Inst.getOperand(0).getReg(),
+                  getGPRState(Inst.getOperand(1).getReg()));
+      return;
+    default:
+      break;
+    }
+
+    // Anything else invalidates every register it names, and the A/X/Y
+    // stores and read-modify-writes invalidate the slot they address
+    for (const MCOperand &MO : Inst) {
+      if (MO.isReg() && isGPR(MO.getReg()))
+        setGPRState(MO.getReg(), std::nullopt);
+    }
+    if (writesDPSlot(Inst.getOpcode())) {
+      const MCOperand &MO = Inst.getOperand(Inst.getNumOperands() - 1);
+      if (!MO.isImm()) {
+        resetState();
+        return;
+      }
+      // An unaligned 32-bit write straddles two slots
+      uint64_t Slot = static_cast<uint8_t>(MO.getImm()) / 4;
+      GPRValidMask.reset(Slot);
+      if (MO.getImm() % 4 && Slot + 1 < 64)
+        GPRValidMask.reset(Slot + 1);
+    }
+  }
+
+  bool evaluateBranch(const MCInst &Inst, uint64_t Addr, uint64_t Size,
+                      uint64_t &Target) const override {
+    if (Inst.getNumOperands() == 0 || !Inst.getOperand(0).isImm())
+      return false;
+    int64_t Imm = Inst.getOperand(0).getImm();
+
+    switch (Inst.getOpcode()) {
+    // Relative branches carry the "*+N" distance from the instruction start
+    case M65832::BEQ:
+    case M65832::BNE:
+    case M65832::BCS:
+    case M65832::BCC:
+    case M65832::BMI:
+    case M65832::BPL:
+    case M65832::BVS:
+    case M65832::BVC:
+    case M65832::BRA:
+    case M65832::BRL:
+      Target = Addr + Imm;
+      return true;
+    // JSR takes a 32-bit absolute address; 0 is an unrelocated call in an
+    // object file. JMP abs is B-relative, so its target is not known here.
+    case M65832::JSR:
+    case M65832::JSR_CSR:
+      if (Imm == 0)
+        return false;
+      Target = static_cast<uint32_t>(Imm);
+      return true;
+    // JMP/JSR (dp) go through the register in that DP slot
+    case M65832::JMP_DP_IND:
+    case M65832::JSR_DP_IND: {
+      if (Imm % 4 || Imm / 4 >= 64)
+        return false;
+      std::optional<int64_t> Value = getGPRState(M65832::R0 + Imm / 4);
+      if (!Value || *Value == 0)
+        return false;
+      Target = *Value;
+      return true;
+    }
+    default:
+      return false;
+    }
+  }
+};
+
+} // end anonymous namespace
+
+static MCInstrAnalysis *createM65832MCInstrAnalysis(const MCInstrInfo *Info) {
+  return new M65832MCInstrAnalysis(Info);
+}
+
 extern "C" LLVM_EXTERNAL_VISIBILITY void LLVMInitializeM65832TargetMC() {
   Target &T = getTheM65832Target();
 
@@ -79,6 +238,7 @@ extern "C" LLVM_EXTERNAL_VISIBILITY void LLVMInitializeM65832TargetMC() {
   TargetRegistry::RegisterMCRegInfo(T, createM65832MCRegisterInfo);
   TargetRegistry::RegisterMCSubtargetInfo(T, createM65832MCSubtargetInfo);
   TargetRegistry::RegisterMCInstPrinter(T, createM65832MCInstPrinter);
+  TargetRegistry::RegisterMCInstrAnalysis(T, createM65832MCInstrAnalysis);
   TargetRegistry::RegisterMCCodeEmitter(T, createM65832MCCodeEmitter);
   TargetRegistry::RegisterMCAsmBackend(T, createM65832AsmBackend);
 }
@@ -14,6 +14,7 @@
 #define LLVM_LIB_TARGET_M65832_MCTARGETDESC_M65832MCTARGETDESC_H
 
 #include "llvm/MC/MCTargetOptions.h"
+#include <cstdint>
 #include <memory>
 
 namespace llvm {
@@ -33,7 +34,30 @@ MCAsmBackend *createM65832AsmBackend(const Target &T, const MCSubtargetInfo &STI
                                       const MCRegisterInfo &MRI,
                                       const MCTargetOptions &Options);
 
-std::unique_ptr<MCObjectTargetWriter> createM65832ELFObjectWriter(uint8_t OSABI);
+std::unique_ptr<MCObjectTargetWriter> createM65832ELFObjectWriter(uint8_t OSABI,
+                                                                  bool Relax);
+
+namespace M65832II {
+/// Encoding layout in TSFlags{10-8}; must match M65832InstrFormats.td.
+enum Format {
+  FrmOther = 0,
+  FrmStd = 1,
+  FrmExt = 2,
+  FrmExtALU = 3,
+  FrmShift = 4,
+  FrmExtend = 5,
+};
+
+/// Opcode byte (after the $02 prefix for extended forms)
+inline uint8_t getOpcode(uint64_t TSFlags) { return TSFlags & 0xFF; }
+
+inline Format getFormat(uint64_t TSFlags) {
+  return static_cast<Format>((TSFlags >> 8) & 0x7);
+}
+
+/// Extended-ALU mode byte: [size:2][target:1][addr_mode:5]
+inline uint8_t getExtMode(uint64_t TSFlags) { return (TSFlags >> 11) & 0xFF; }
+} // namespace M65832II
 
 } // namespace llvm
 
@@ -0,0 +1,72 @@
+//===-- Target.cpp ----------------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// The M65832 ExegesisTarget. The host cannot run M65832 code, so snippets
+// are only generated and assembled here (--benchmark-phase=
+// assemble-measured-code --dump-object-to-disk) and timed on the emulator
+// or a board by m65832-stdlib/bench/exegesis.sh.
+//===----------------------------------------------------------------------===//
+#include "../Target.h"
+#include "M65832.h"
+#include "M65832RegisterInfo.h"
+
+#define GET_AVAILABLE_OPCODE_CHECKER
+#include "M65832GenInstrInfo.inc"
+
+namespace llvm {
+namespace exegesis {
+
+#include "M65832GenExegesis.inc"
+
+namespace {
+class ExegesisM65832Target : public ExegesisTarget {
+public:
+  ExegesisM65832Target()
+      : ExegesisTarget(M65832CpuPfmCounters, M65832_MC::isOpcodeAvailable) {}
+
+private:
+  // The snippet is called as foo(scratch), so the first argument register
+  // holds the scratch buffer.
+  MCRegister getScratchMemoryRegister(const Triple &TT) const override {
+    return M65832::R0;
+  }
+
+  std::vector<MCInst> setRegTo(const MCSubtargetInfo &STI, MCRegister Reg,
+                               const APInt &Value) const override;
+  bool matchesArch(Triple::ArchType Arch) const override {
+    return Arch == Triple::m65832;
+  }
+};
+} // end anonymous namespace
+
+std::vector<MCInst> ExegesisM65832Target::setRegTo(const MCSubtargetInfo &STI,
+                                                   MCRegister Reg,
+                                                   const APInt &Value) const {
+  const int64_t Imm = Value.getZExtValue();
+  // LD.L Rn,#imm leaves A and the flags alone
+  if (M65832::GPRRegClass.contains(Reg))
+    return {MCInstBuilder(M65832::LDR_IMM).addReg(Reg).addImm(Imm)};
+  if (Reg == M65832::A)
+    return {MCInstBuilder(M65832::LDA_IMM).addReg(Reg).addImm(Imm)};
+  if (Reg == M65832::X)
+    return {MCInstBuilder(M65832::LDX_IMM).addReg(Reg).addImm(Imm)};
+  if (Reg == M65832::Y)
+    return {MCInstBuilder(M65832::LDY_IMM).addReg(Reg).addImm(Imm)};
+  errs() << "setRegTo is not implemented, results will be unreliable\n";
+  return {};
+}
+
+static ExegesisTarget *getTheExegesisM65832Target() {
+  static ExegesisM65832Target Target;
+  return &Target;
+}
+
+void InitializeM65832ExegesisTarget() {
+  ExegesisTarget::registerTarget(getTheExegesisM65832Target());
+}
+
+} // namespace exegesis
+} // namespace llvm
@@ -0,0 +1,24 @@
+/* bench.h - Interface between harness.c and one benchmark kernel
+ *
+ * Each kernel file defines bench_run, which does one full run of the
+ * kernel (setting up its own input) and returns a checksum of its output,
+ * and the checksum a correct run gives. harness.c times bench_run on the
+ * cycle counter and checks the result.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+
+extern const char bench_name[];
+extern const uint32_t bench_expect;
+uint32_t bench_run(void);
+
+/* Deterministic input data, the same on every target */
+static inline uint32_t bench_rand(uint32_t *state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state;
+}
+
+#endif /* BENCH_H */
@@ -0,0 +1,36 @@
+#!/bin/bash
+# Compare two run_bench.sh result files
+# Prints the cycle and size change of every kernel and fails when any
+# kernel got more than THRESHOLD percent slower or larger, or stopped
+# passing.
+#
+# Usage: compare.sh <baseline.json> <new.json> [threshold percent, default 2]
+
+BASE="$1"
+NEW="$2"
+THRESHOLD="${3:-2}"
+
+if [ ! -f "$BASE" ] || [ ! -f "$NEW" ]; then
+	echo "usage: compare.sh <baseline.json> <new.json> [threshold]"
+	exit 2
+fi
+
+# name cycles text status, one line per kernel
+records() {
+	sed -n 's/.*"name": "\([^"]*\)", "cycles": \([0-9]*\), "text": \([0-9]*\), "status": "\([^"]*\)".*/\1 \2 \3 \4/p' "$1"
+}
+
+join <(records "$BASE" | sort) <(records "$NEW" | sort) | awk -v t="$THRESHOLD" '
+function pct(old, new) { return old ? (new - old) * 100.0 / old : 0 }
+BEGIN {
+	printf "%-10s %12s %12s %8s %8s %8s %8s\n", "kernel", "cycles", "new", "delta", "text", "new", "delta"
+	bad = 0
+}
+{
+	dc = pct($2, $5); dt = pct($3, $6)
+	flag = ""
+	if ($7 != "pass" && $4 == "pass") { flag = "  " $7; bad = 1 }
+	else if (dc > t || dt > t) { flag = "  REGRESSION"; bad = 1 }
+	printf "%-10s %12d %12d %+7.2f%% %8d %8d %+7.2f%%%s\n", $1, $2, $5, dc, $3, $6, dt, flag
+}
+END { exit bad }'
@@ -0,0 +1,28 @@
+/* crc32.c - Table-driven CRC-32 (IEEE) over 4 KiB */
+
+#include "bench.h"
+
+#define LEN 4096
+
+const char bench_name[] = "crc32";
+const uint32_t bench_expect = 0x5b24a61a;
+
+static uint8_t buf[LEN];
+static uint32_t table[256];
+
+uint32_t bench_run(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++)
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        table[i] = c;
+    }
+    uint32_t seed = 1;
+    for (uint32_t i = 0; i < LEN; i++)
+        buf[i] = (uint8_t)(bench_rand(&seed) >> 24);
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (uint32_t i = 0; i < LEN; i++)
+        crc = table[(crc ^ buf[i]) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
@@ -0,0 +1,27 @@
+/* exegesis.c - Times one llvm-exegesis snippet on the cycle counter
+ *
+ * The snippet object (llvm-exegesis --dump-object-to-disk) defines
+ * foo(scratch): the register setup, then the snippet repeated up to
+ * --min-instructions. Prints one line the runner parses:
+ *   exegesis cycles <cycles for one call>
+ * The setup and the call itself are in the count; exegesis.sh takes the
+ * difference between two repetition counts to cancel them.
+ */
+
+#include <stdio.h>
+#include <timer.h>
+
+void foo(char *scratch);
+
+/* The M65832 target gives snippets no memory operands, so the scratch
+ * buffer is only passed along */
+static char scratch[64] __attribute__((aligned(4)));
+
+int main(void) {
+    uint64_t start = timer_cycles();
+    foo(scratch);
+    uint64_t cycles = timer_cycles() - start;
+
+    printf("exegesis cycles %llu\n", (unsigned long long)cycles);
+    return 0;
+}
@@ -0,0 +1,85 @@
+#!/bin/bash
+# llvm-exegesis runner for the emulator or a board
+# llvm-exegesis generates and assembles a snippet for each opcode; this
+# links it with exegesis.c, runs it and reports the cycles per
+# instruction. Each opcode is built at two repetition counts, and the
+# difference is divided by the extra instructions, so the register setup
+# and the call drop out. Measured on an r1 core, the numbers go into the
+# WriteRes entries of M65832Schedule.td; on r2, M65832ScheduleR2.td.
+#
+# Usage: exegesis.sh [llvm build dir] [output.txt] <opcode...>
+#   MODE          latency (dependent chain, default) or inverse_throughput
+#   MCPU          -mcpu for snippet generation (default m65832)
+#   REPS          instructions in the shorter run (default 1000)
+#   RUN           command that runs an image and prints its console output
+#                 (default: the emulator under CYCLE_LIMIT); a board
+#                 loader that echoes the UART works the same way
+#   EMU           emulator binary
+#   CYCLE_LIMIT   per-run emulator cycle limit
+#
+# Output, one line per opcode:
+#   <opcode> <mode> <cycles per instruction>
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+STDLIB_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$STDLIB_DIR/build/exegesis"
+
+LLVM_BUILD="${1:-/Users/benjamincooley/projects/llvm-m65832/build-fast}"
+OUT="${2:-$BUILD_DIR/results.txt}"
+shift $(($# < 2 ? $# : 2))
+
+CC="$LLVM_BUILD/bin/clang"
+LD="$LLVM_BUILD/bin/ld.lld"
+EXEGESIS="$LLVM_BUILD/bin/llvm-exegesis"
+EMU="${EMU:-/Users/benjamincooley/projects/m65832/emu/m65832emu}"
+CYCLE_LIMIT="${CYCLE_LIMIT:-50000000}"
+RUN="${RUN:-$EMU -c $CYCLE_LIMIT -s}"
+BUILTINS="${BUILTINS:-/Users/benjamincooley/projects/m65832-sysroot/lib/libclang_rt.builtins-m65832.a}"
+MODE="${MODE:-latency}"
+MCPU="${MCPU:-m65832}"
+REPS="${REPS:-1000}"
+
+CFLAGS="-target m65832 -O2 -ffreestanding -nostdlib -I$STDLIB_DIR/libc/include"
+LIBS="$STDLIB_DIR/build/libc.a $STDLIB_DIR/build/libplatform.a $BUILTINS"
+STARTUP="$STDLIB_DIR/build/crt0.o $STDLIB_DIR/build/init.o"
+LDSCRIPT="$STDLIB_DIR/scripts/baremetal/m65832.ld"
+
+if [ $# -eq 0 ]; then
+	echo "usage: exegesis.sh [llvm build dir] [output.txt] <opcode...>" >&2
+	exit 2
+fi
+
+mkdir -p "$BUILD_DIR"
+
+"$CC" $CFLAGS -c "$SCRIPT_DIR/exegesis.c" -o "$BUILD_DIR/exegesis.o" || exit 1
+
+# Cycles for one call of the snippet for opcode $1 at $2 instructions,
+# empty on failure
+measure() {
+	local obj="$BUILD_DIR/$1.$2.o"
+	local elf="$BUILD_DIR/$1.$2.elf"
+	"$EXEGESIS" -mtriple=m65832 -mcpu="$MCPU" -mode="$MODE" \
+		-opcode-name="$1" -min-instructions="$2" \
+		--benchmark-phase=assemble-measured-code \
+		--dump-object-to-disk="$obj" > /dev/null || return
+	"$LD" -T "$LDSCRIPT" -o "$elf" $STARTUP "$BUILD_DIR/exegesis.o" \
+		"$obj" $LIBS || return
+	$RUN "$elf" 2>&1 | awk '$1 == "exegesis" && $2 == "cycles" { print $3; exit }'
+}
+
+FAILED=0
+: > "$OUT"
+for op in "$@"; do
+	short=$(measure "$op" "$REPS")
+	long=$(measure "$op" $((REPS * 2)))
+	if [ -z "$short" ] || [ -z "$long" ]; then
+		echo "$op: no measurement" >&2
+		FAILED=1
+		continue
+	fi
+	awk -v op="$op" -v mode="$MODE" -v s="$short" -v l="$long" -v n="$REPS" \
+		'BEGIN { printf "%s %s %.2f\n", op, mode, (l - s) / n }' | tee -a "$OUT"
+done
+echo "Wrote $OUT"
+
+exit $FAILED
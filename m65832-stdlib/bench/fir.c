@@ -0,0 +1,35 @@
+/* fir.c - 16-tap Q15 FIR filter over 1024 samples */
+
+#include "bench.h"
+
+#define TAPS 16
+#define SAMPLES 1024
+
+const char bench_name[] = "fir";
+const uint32_t bench_expect = 0xfcfe62fc;
+
+static const int16_t coeff[TAPS] = {
+    -120, -310, -205, 480, 1630, 3020, 4150, 4600,
+    4600, 4150, 3020, 1630, 480, -205, -310, -120,
+};
+
+static int16_t in[SAMPLES + TAPS];
+static int16_t out[SAMPLES];
+
+uint32_t bench_run(void) {
+    uint32_t seed = 4;
+    for (uint32_t i = 0; i < SAMPLES + TAPS; i++)
+        in[i] = (int16_t)(bench_rand(&seed) >> 16);
+
+    for (uint32_t n = 0; n < SAMPLES; n++) {
+        int32_t acc = 0;
+        for (uint32_t k = 0; k < TAPS; k++)
+            acc += (int32_t)in[n + k] * coeff[k];
+        out[n] = (int16_t)(acc >> 15);
+    }
+
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < SAMPLES; i++)
+        sum = sum * 31 + (uint16_t)out[i];
+    return sum;
+}
@@ -0,0 +1,28 @@
+/* harness.c - Times one benchmark kernel on the cycle counter
+ *
+ * Prints one line the runner parses:
+ *   bench <name> cycles <per run> check <checksum>
+ * and exits 0 when the checksum matches, 1 when it does not.
+ */
+
+#include <stdio.h>
+#include <timer.h>
+#include "bench.h"
+
+#ifndef BENCH_ITERS
+#define BENCH_ITERS 4
+#endif
+
+int main(void) {
+    /* The first run warms nothing (no caches) but gives the checksum */
+    uint32_t check = bench_run();
+
+    uint64_t start = timer_cycles();
+    for (unsigned i = 0; i < BENCH_ITERS; i++)
+        bench_run();
+    uint64_t cycles = (timer_cycles() - start) / BENCH_ITERS;
+
+    printf("bench %s cycles %llu check %08lx\n", bench_name,
+           (unsigned long long)cycles, (unsigned long)check);
+    return check == bench_expect ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+/* interp.c - Switch-dispatched bytecode interpreter loop
+ *
+ * A small stack machine running a counted loop that sums a polynomial
+ * and a gcd, the dispatch pattern an embedded scripting VM spends its
+ * time in.
+ */
+
+#include "bench.h"
+
+const char bench_name[] = "interp";
+const uint32_t bench_expect = 0x019ec5a4;
+
+enum op {
+    OP_PUSH, OP_LOAD, OP_STORE, OP_ADD, OP_SUB, OP_MUL, OP_MOD,
+    OP_DUP, OP_JZ, OP_JMP, OP_HALT,
+};
+
+/* Locals: 0 = i, 1 = acc, 2 = a, 3 = b */
+static const int32_t program[] = {
+    /* for (i = 300; i != 0; i--) */
+    OP_PUSH, 300, OP_STORE, 0,
+    /* top: 4 */
+    OP_LOAD, 0, OP_JZ, 67,
+    /* acc += i * i * 3 + i */
+    OP_LOAD, 0, OP_DUP, OP_MUL, OP_PUSH, 3, OP_MUL, OP_LOAD, 0, OP_ADD,
+    OP_LOAD, 1, OP_ADD, OP_STORE, 1,
+    /* a = i + 1000; b = i; while (b) { t = a % b; a = b; b = t; } */
+    OP_LOAD, 0, OP_PUSH, 1000, OP_ADD, OP_STORE, 2,
+    OP_LOAD, 0, OP_STORE, 3,
+    /* gcd: 34 */
+    OP_LOAD, 3, OP_JZ, 51,
+    OP_LOAD, 2, OP_LOAD, 3, OP_MOD, OP_LOAD, 3, OP_STORE, 2, OP_STORE, 3,
+    OP_JMP, 34,
+    /* 51: acc += a; i-- */
+    OP_LOAD, 2, OP_LOAD, 1, OP_ADD, OP_STORE, 1,
+    OP_LOAD, 0, OP_PUSH, 1, OP_SUB, OP_STORE, 0,
+    OP_JMP, 4,
+    /* 67 */
+    OP_HALT,
+};
+
+static int32_t run(const int32_t *code) {
+    int32_t stack[16], locals[4] = { 0 };
+    int32_t *sp = stack;
+    const int32_t *pc = code;
+    for (;;) {
+        switch ((enum op)*pc++) {
+        case OP_PUSH:  *sp++ = *pc++; break;
+        case OP_LOAD:  *sp++ = locals[*pc++]; break;
+        case OP_STORE: locals[*pc++] = *--sp; break;
+        case OP_ADD:   sp--; sp[-1] += sp[0]; break;
+        case OP_SUB:   sp--; sp[-1] -= sp[0]; break;
+        case OP_MUL:   sp--; sp[-1] *= sp[0]; break;
+        case OP_MOD:   sp--; sp[-1] %= sp[0]; break;
+        case OP_DUP:   sp[0] = sp[-1]; sp++; break;
+        case OP_JZ:
+            if (*--sp == 0)
+                pc = code + *pc;
+            else
+                pc++;
+            break;
+        case OP_JMP:   pc = code + *pc; break;
+        case OP_HALT:  return locals[1];
+        }
+    }
+}
+
+uint32_t bench_run(void) {
+    return (uint32_t)run(program);
+}
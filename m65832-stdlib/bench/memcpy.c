@@ -0,0 +1,38 @@
+/* memcpy.c - memcpy/memmove/memset at aligned and misaligned offsets */
+
+#include <string.h>
+#include "bench.h"
+
+#define LEN 4096
+
+const char bench_name[] = "memcpy";
+const uint32_t bench_expect = 0xc139fc1a;
+
+static uint32_t src_words[LEN / 4 + 1];
+static uint32_t dst_words[LEN / 4 + 1];
+
+uint32_t bench_run(void) {
+    uint8_t *src = (uint8_t *)src_words;
+    uint8_t *dst = (uint8_t *)dst_words;
+    uint32_t seed = 2;
+    for (uint32_t i = 0; i < LEN / 4; i++)
+        src_words[i] = bench_rand(&seed);
+
+    uint32_t sum = 0;
+    /* Large aligned, mutually misaligned, and the short copies that
+     * struct assignment and string code make */
+    static const uint16_t sizes[] = { 4096, 1024, 256, 64, 31, 16, 7, 3 };
+    for (unsigned s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        for (unsigned off = 0; off < 4; off++) {
+            uint32_t n = sizes[s] - (sizes[s] == LEN ? off : 0);
+            memcpy(dst + off, src, n);
+            sum = sum * 31 + dst[off + n / 2] + dst[off + n - 1];
+        }
+    }
+    memmove(dst + 1, dst, LEN - 1);
+    memmove(dst, dst + 3, LEN - 3);
+    memset(dst + 5, 0xA5, 1000);
+    for (uint32_t i = 0; i < LEN; i += 61)
+        sum = sum * 31 + dst[i];
+    return sum;
+}
@@ -0,0 +1,28 @@
+/* qsort.c - libc qsort of 512 integers */
+
+#include <stdlib.h>
+#include "bench.h"
+
+#define COUNT 512
+
+const char bench_name[] = "qsort";
+const uint32_t bench_expect = 0x58f20946;
+
+static int32_t data[COUNT];
+
+static int cmp_int(const void *a, const void *b) {
+    int32_t x = *(const int32_t *)a, y = *(const int32_t *)b;
+    return (x > y) - (x < y);
+}
+
+uint32_t bench_run(void) {
+    uint32_t seed = 3;
+    for (uint32_t i = 0; i < COUNT; i++)
+        data[i] = (int32_t)(bench_rand(&seed) >> 8) - 0x800000;
+    qsort(data, COUNT, sizeof(data[0]), cmp_int);
+
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < COUNT; i++)
+        sum = sum * 33 + (uint32_t)data[i];
+    return sum;
+}
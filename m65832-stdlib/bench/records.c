@@ -0,0 +1,70 @@
+/* records.c - Dhrystone-style record, string and control-flow mix
+ *
+ * Not Dhrystone itself: the same ingredients (record assignment through
+ * pointers, short string copies and compares, enum switches, small calls)
+ * in a self-checking form that needs no timing code of its own.
+ */
+
+#include <string.h>
+#include "bench.h"
+
+#define LOOPS 500
+
+const char bench_name[] = "records";
+const uint32_t bench_expect = 0x87ca80ba;
+
+enum color { RED, GREEN, BLUE, WHITE };
+
+struct record {
+    struct record *next;
+    enum color kind;
+    int32_t value;
+    char name[31];
+};
+
+static struct record pool[2];
+static int32_t array[50];
+static char str1[31], str2[31];
+
+static enum color pick(int32_t v, enum color c) {
+    switch (c) {
+    case RED:   return v > 10 ? GREEN : BLUE;
+    case GREEN: return v & 1 ? WHITE : RED;
+    case BLUE:  return GREEN;
+    default:    return RED;
+    }
+}
+
+static int32_t step(struct record *r, int32_t v) {
+    struct record *n = r->next;
+    struct record *keep = n->next;
+    *n = *r;
+    n->next = keep;
+    n->value = v + 5;
+    n->kind = pick(n->value, r->kind);
+    return n->value * 2 - r->value;
+}
+
+uint32_t bench_run(void) {
+    pool[0].next = &pool[1];
+    pool[1].next = &pool[0];
+    pool[0].kind = RED;
+    pool[0].value = 40;
+    strcpy(pool[0].name, "DHRYSTONE PROGRAM, SOME STRING");
+    strcpy(str1, "DHRYSTONE PROGRAM, 1'ST STRING");
+
+    uint32_t sum = 0;
+    struct record *r = &pool[0];
+    for (int32_t i = 1; i <= LOOPS; i++) {
+        strcpy(str2, "DHRYSTONE PROGRAM, 2'ND STRING");
+        int less = strcmp(str1, str2) < 0;
+        int32_t v = step(r, i);
+        array[i % 50] += v + less;
+        r = r->next;
+        sum = sum * 31 + (uint32_t)v + r->kind + (uint32_t)strlen(r->name);
+    }
+    for (int i = 0; i < 50; i++)
+        sum = sum * 31 + (uint32_t)array[i];
+    memset(array, 0, sizeof(array));
+    return sum;
+}
@@ -0,0 +1,95 @@
+#!/bin/bash
+# Codegen benchmark runner
+# Builds each kernel with harness.c against this libc, runs it on the
+# emulator under a cycle limit, and writes one JSON record per kernel with
+# the cycles per run (from the cycle counter) and the kernel's code size.
+# Compare two result files with compare.sh.
+#
+# Usage: run_bench.sh [llvm build dir] [output.json] [kernel...]
+#   CFLAGS_EXTRA  extra compile flags (e.g. -Os, -mllvm ...)
+#   EMU           emulator binary
+#   CYCLE_LIMIT   per-kernel emulator cycle limit
+#   BENCH_DIR     object and ELF directory (default build/bench), so
+#                 several runs can go at once
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+STDLIB_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="${BENCH_DIR:-$STDLIB_DIR/build/bench}"
+
+LLVM_BUILD="${1:-/Users/benjamincooley/projects/llvm-m65832/build-fast}"
+OUT="${2:-$BUILD_DIR/results.json}"
+shift $(($# < 2 ? $# : 2))
+
+CC="$LLVM_BUILD/bin/clang"
+LD="$LLVM_BUILD/bin/ld.lld"
+SIZE="$LLVM_BUILD/bin/llvm-size"
+EMU="${EMU:-/Users/benjamincooley/projects/m65832/emu/m65832emu}"
+CYCLE_LIMIT="${CYCLE_LIMIT:-50000000}"
+BUILTINS="${BUILTINS:-/Users/benjamincooley/projects/m65832-sysroot/lib/libclang_rt.builtins-m65832.a}"
+
+CFLAGS="-target m65832 -O2 -ffreestanding -nostdlib -I$STDLIB_DIR/libc/include $CFLAGS_EXTRA"
+LIBS="$STDLIB_DIR/build/libc.a $STDLIB_DIR/build/libplatform.a $BUILTINS"
+STARTUP="$STDLIB_DIR/build/crt0.o $STDLIB_DIR/build/init.o"
+LDSCRIPT="$STDLIB_DIR/scripts/baremetal/m65832.ld"
+
+if [ $# -gt 0 ]; then
+	KERNELS="$*"
+else
+	KERNELS="crc32 memcpy qsort fir records interp"
+fi
+
+mkdir -p "$BUILD_DIR"
+
+"$CC" $CFLAGS -c "$SCRIPT_DIR/harness.c" -o "$BUILD_DIR/harness.o" || exit 1
+
+FAILED=0
+RECORDS=()
+for k in $KERNELS; do
+	obj="$BUILD_DIR/$k.o"
+	elf="$BUILD_DIR/$k.elf"
+	cycles=0
+	status=pass
+	if ! "$CC" $CFLAGS -c "$SCRIPT_DIR/$k.c" -o "$obj" ||
+	   ! "$LD" -T "$LDSCRIPT" -o "$elf" $STARTUP "$BUILD_DIR/harness.o" \
+		"$obj" $LIBS; then
+		status=build-error
+		text=0
+	else
+		# Kernel code size only: the harness and libc are the same for
+		# every revision being compared
+		text=$("$SIZE" "$obj" | awk 'NR == 2 { print $1 }')
+		output=$("$EMU" -c "$CYCLE_LIMIT" -s "$elf" 2>&1)
+		code=$?
+		line=$(echo "$output" | grep "^bench $k ")
+		if [ -n "$line" ]; then
+			cycles=$(echo "$line" | awk '{ print $4 }')
+		fi
+		if [ -z "$line" ]; then
+			status=timeout
+		elif [ $code -ne 0 ]; then
+			status=wrong-result
+		fi
+	fi
+	[ "$status" != pass ] && FAILED=1
+	printf "%-10s %12s cycles %8s bytes  %s\n" "$k" "$cycles" "$text" "$status"
+	RECORDS+=("    {\"name\": \"$k\", \"cycles\": $cycles, \"text\": $text, \"status\": \"$status\"}")
+done
+
+# One benchmark per line, so compare.sh (and grep) can read it without a
+# JSON parser
+{
+	echo "{"
+	echo "  \"compiler\": \"$("$CC" --version | head -1)\","
+	echo "  \"cflags\": \"$CFLAGS_EXTRA\","
+	echo "  \"benchmarks\": ["
+	for ((i = 0; i < ${#RECORDS[@]}; i++)); do
+		sep=","
+		[ $i -eq $((${#RECORDS[@]} - 1)) ] && sep=""
+		echo "${RECORDS[$i]}$sep"
+	done
+	echo "  ]"
+	echo "}"
+} > "$OUT"
+echo "Wrote $OUT"
+
+exit $FAILED
@@ -0,0 +1,144 @@
+#!/bin/bash
+# Backend tunable sweep
+# Runs the codegen benchmarks (run_bench.sh) once per -mcpu with the
+# compiler's defaults and once per value of each option in knobs.txt,
+# several runs at a time, then recommends the value of each option that
+# scores best on each -mcpu. An option's values are tried one at a time
+# with everything else at its default, so interactions between options
+# are not searched.
+#
+# A value's score is the mean over the kernels of log(cycles ratio) +
+# SIZE_WEIGHT * log(text ratio) against the default run; lower is better.
+# A value under which any kernel fails to build, times out or gives the
+# wrong result is never recommended. The default is kept unless some
+# value scores below zero.
+#
+# Usage: tune.sh [llvm build dir] [output dir] [kernel...]
+#   CPUS          -mcpu values to tune for (default "m65832 m65832-fpu")
+#   KNOBS         option file (default knobs.txt next to this script)
+#   SIZE_WEIGHT   weight of code size against cycles (default 0)
+#   JOBS          benchmark runs at once (default: number of CPUs)
+#   CFLAGS_EXTRA  extra compile flags for every run (e.g. -Oz)
+#   EMU, CYCLE_LIMIT, BUILTINS as for run_bench.sh
+#
+# Writes <output dir>/<cpu>/<option>=<value>.json (base.json for the
+# defaults) and <output dir>/recommended.json, one option per line.
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+STDLIB_DIR="$(dirname "$SCRIPT_DIR")"
+
+LLVM_BUILD="${1:-/Users/benjamincooley/projects/llvm-m65832/build-fast}"
+OUT="${2:-$STDLIB_DIR/build/tune}"
+shift $(($# < 2 ? $# : 2))
+
+CPUS="${CPUS:-m65832 m65832-fpu}"
+KNOBS="${KNOBS:-$SCRIPT_DIR/knobs.txt}"
+SIZE_WEIGHT="${SIZE_WEIGHT:-0}"
+JOBS="${JOBS:-$(getconf _NPROCESSORS_ONLN 2>/dev/null || echo 4)}"
+
+if [ ! -f "$KNOBS" ]; then
+	echo "tune.sh: no option file $KNOBS" >&2
+	exit 2
+fi
+
+# One "cpu tag flags" task per run; the tag names its result file
+TASKS="$OUT/tasks"
+mkdir -p "$OUT"
+: > "$TASKS"
+for cpu in $CPUS; do
+	mkdir -p "$OUT/$cpu"
+	echo "$cpu base" >> "$TASKS"
+	sed -e 's/#.*//' "$KNOBS" | while read -r opt values; do
+		[ -z "$opt" ] && continue
+		for v in $values; do
+			echo "$cpu $opt=$v -mllvm -$opt=$v" >> "$TASKS"
+		done
+	done
+done
+echo "Running $(wc -l < "$TASKS") benchmark sets, $JOBS at a time"
+
+# Each run gets its own object directory so runs can overlap
+run_one() {
+	set -- $1
+	cpu="$1" tag="$2"
+	shift 2
+	BENCH_DIR="$OUT/$cpu/$tag.d" \
+	CFLAGS_EXTRA="-mcpu=$cpu $CFLAGS_EXTRA $*" \
+		"$SCRIPT_DIR/run_bench.sh" "$LLVM_BUILD" "$OUT/$cpu/$tag.json" \
+		$KERNELS > "$OUT/$cpu/$tag.log" 2>&1
+	echo "$cpu $tag: $(grep -c ' pass$' "$OUT/$cpu/$tag.log") kernels passed"
+}
+export -f run_one
+export SCRIPT_DIR OUT LLVM_BUILD CFLAGS_EXTRA
+export KERNELS="$*"
+
+tr '\n' '\0' < "$TASKS" | xargs -0 -n 1 -P "$JOBS" bash -c 'run_one "$0"'
+
+# name cycles text status, one line per kernel (as in compare.sh)
+records() {
+	sed -n 's/.*"name": "\([^"]*\)", "cycles": \([0-9]*\), "text": \([0-9]*\), "status": "\([^"]*\)".*/\1 \2 \3 \4/p' "$1" | sort
+}
+
+# Score every value of every option against the defaults:
+# "cpu option value score cycles% text%", or "... fail" when it broke
+# a kernel
+SCORES="$OUT/scores"
+: > "$SCORES"
+for cpu in $CPUS; do
+	base="$OUT/$cpu/base.json"
+	if [ ! -f "$base" ] || records "$base" | grep -qv ' pass$'; then
+		echo "tune.sh: the default run failed for -mcpu=$cpu," \
+			"see $OUT/$cpu/base.log" >&2
+		exit 1
+	fi
+	grep "^$cpu [^ ]*=" "$TASKS" | while read -r _ tag _; do
+		res="$OUT/$cpu/$tag.json"
+		[ -f "$res" ] || { echo "$cpu ${tag%%=*} ${tag#*=} fail"; continue; }
+		join <(records "$base") <(records "$res") | awk \
+			-v cpu="$cpu" -v opt="${tag%%=*}" -v val="${tag#*=}" \
+			-v w="$SIZE_WEIGHT" '
+		{
+			if ($7 != "pass" || $5 == 0 || $6 == 0) { bad = 1; next }
+			lc += log($5 / $2); lt += log($6 / $3); n++
+		}
+		END {
+			if (bad || n == 0) { print cpu, opt, val, "fail"; exit }
+			printf "%s %s %s %.6f %+.2f %+.2f\n", cpu, opt, val,
+				(lc + w * lt) / n, (exp(lc / n) - 1) * 100,
+				(exp(lt / n) - 1) * 100
+		}'
+	done >> "$SCORES"
+done
+
+# The best value of each option per cpu; ties go to the first one listed
+printf "\n%-12s %-32s %-10s %9s %9s\n" "cpu" "option" "value" "cycles" "text"
+sort -k1,1 -k2,2 -s "$SCORES" | awk -v out="$OUT/recommended.json" '
+function flush() {
+	if (key == "") return
+	printf "%-12s %-32s %-10s %+8.2f%% %+8.2f%%\n", c, o, bv, bc, bt
+	recs[++nrec] = sprintf("    {\"cpu\": \"%s\", \"option\": \"%s\", " \
+		"\"value\": \"%s\", \"cycles\": %.2f, \"text\": %.2f}", c, o, bv, bc, bt)
+}
+{
+	if ($1 " " $2 != key) {
+		flush()
+		key = $1 " " $2; c = $1; o = $2
+		bv = "default"; bs = 0; bc = 0; bt = 0
+	}
+	if ($4 != "fail" && $4 < bs) { bs = $4; bv = $3; bc = $5; bt = $6 }
+}
+END {
+	flush()
+	print "{" > out
+	print "  \"recommended\": [" > out
+	for (i = 1; i <= nrec; i++)
+		print recs[i] (i < nrec ? "," : "") > out
+	print "  ]" > out
+	print "}" > out
+}'
+
+echo ""
+grep ' fail$' "$SCORES" | while read -r cpu opt val _; do
+	echo "-mcpu=$cpu -$opt=$val broke a kernel, see $OUT/$cpu/$opt=$val.log"
+done
+echo "Wrote $OUT/recommended.json"
@@ -0,0 +1,54 @@
+/* context.h - Task context switching */
+
+#ifndef _CONTEXT_H
+#define _CONTEXT_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Each task has its own register bank: 64 words that D points at, so its
+ * R0-R63 stay in place while other tasks run. A switch changes D, SP and
+ * B and saves F14/F15 (FPU builds); no GPR is copied. That includes R56,
+ * so each task can have its own thread pointer. Code built with register
+ * windows moves D down 48 registers per call, so its bank needs that much
+ * room below it for each level of windowed calls.
+ */
+typedef struct ctx {
+    uint32_t ret;    /* resume address as pushed by JSR; 0 until started */
+    uint32_t sp;
+    uint32_t b;
+    uint32_t d;      /* the task's register bank */
+    uint32_t f14[2];
+    uint32_t f15[2];
+} ctx_t;
+
+#define CTX_BANK_WORDS 64
+
+/*
+ * Save the running task in *from and resume the one in *to. Returns when
+ * another task switches back to from.
+ */
+void ctx_switch(ctx_t *from, const ctx_t *to);
+
+/*
+ * Set up ctx to call entry(arg) on its first switch, with SP at stack_top
+ * and D at bank. The bank gets a copy of the running task's reserved
+ * registers (R24-R31 and R56-R63), which include the global pointer.
+ * When entry returns the task calls ctx_exit.
+ */
+void ctx_init(ctx_t *ctx, void *stack_top, uint32_t *bank,
+              void (*entry)(void *), void *arg);
+
+/* Called when a task's entry function returns; the default waits for
+ * interrupts forever. An RTOS overrides it to retire the task. */
+void ctx_exit(void) __attribute__((noreturn));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _CONTEXT_H */
@@ -22,6 +22,54 @@ int iscntrl(int c);
 int tolower(int c);
 int toupper(int c);
 
+/*
+ * Class bits for each character of the C locale, in .rodata. Only ASCII
+ * has any, so indexing by (unsigned char)c gives EOF (-1) the empty class
+ * of 255, and a plain char argument works whether it is signed or not.
+ * Each macro below is one indexed load and an AND; the functions above
+ * are still there for taking their address.
+ */
+#define _CTYPE_U 0x01   /* upper case */
+#define _CTYPE_L 0x02   /* lower case */
+#define _CTYPE_D 0x04   /* decimal digit */
+#define _CTYPE_S 0x08   /* white space */
+#define _CTYPE_P 0x10   /* punctuation */
+#define _CTYPE_C 0x20   /* control */
+#define _CTYPE_X 0x40   /* hex letter (a-f, A-F) */
+#define _CTYPE_B 0x80   /* space character */
+
+extern const unsigned char __ctype_table[256];
+
+#define __ctype_class(c) (__ctype_table[(unsigned char)(c)])
+
+#ifndef __cplusplus
+#define isalnum(c)  (__ctype_class(c) & (_CTYPE_U | _CTYPE_L | _CTYPE_D))
+#define isalpha(c)  (__ctype_class(c) & (_CTYPE_U | _CTYPE_L))
+#define isdigit(c)  (__ctype_class(c) & _CTYPE_D)
+#define isxdigit(c) (__ctype_class(c) & (_CTYPE_D | _CTYPE_X))
+#define islower(c)  (__ctype_class(c) & _CTYPE_L)
+#define isupper(c)  (__ctype_class(c) & _CTYPE_U)
+#define isspace(c)  (__ctype_class(c) & _CTYPE_S)
+#define isprint(c)  (__ctype_class(c) & (_CTYPE_U | _CTYPE_L | _CTYPE_D | \
+                                         _CTYPE_P | _CTYPE_B))
+#define isgraph(c)  (__ctype_class(c) & (_CTYPE_U | _CTYPE_L | _CTYPE_D | \
+                                         _CTYPE_P))
+#define ispunct(c)  (__ctype_class(c) & _CTYPE_P)
+#define iscntrl(c)  (__ctype_class(c) & _CTYPE_C)
+
+/* Without a branch: the case bit, shifted to 0x20, is the difference */
+static inline int __tolower(int c) {
+    return c + ((__ctype_class(c) & _CTYPE_U) << 5);
+}
+
+static inline int __toupper(int c) {
+    return c - ((__ctype_class(c) & _CTYPE_L) << 4);
+}
+
+#define tolower(c) __tolower(c)
+#define toupper(c) __toupper(c)
+#endif
+
 #ifdef __cplusplus
 }
 #endif
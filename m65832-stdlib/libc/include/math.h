@@ -0,0 +1,57 @@
+/* math.h - Single-precision math for the M65832 FPU
+ *
+ * libm.a is built for m65832-fpu: the kernels are float polynomials with
+ * 32-bit integer range reduction (no 64-bit integer math), and sqrtf/sqrt
+ * are FSQRT.S/FSQRT.D.
+ */
+
+#ifndef _MATH_H
+#define _MATH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HUGE_VALF   __builtin_huge_valf()
+#define HUGE_VAL    __builtin_huge_val()
+#define INFINITY    __builtin_inff()
+#define NAN         __builtin_nanf("")
+
+#define isnan(x)    __builtin_isnan(x)
+#define isinf(x)    __builtin_isinf(x)
+#define isfinite(x) __builtin_isfinite(x)
+#define signbit(x)  __builtin_signbit(x)
+
+/* Arguments are reduced by pi/4 in single precision: results are within
+ * 3 ulp for |x| < 100 and within 1e-7 absolute for |x| < 8192, and lose
+ * accuracy beyond. |x| >= 2^24 gives 0. */
+float sinf(float x);
+float cosf(float x);
+
+/* Within 1 ulp; overflow gives +Inf, underflow 0 */
+float expf(float x);
+
+/* Within 1 ulp; 0 gives -Inf, negative arguments NaN */
+float logf(float x);
+
+/* Correctly rounded */
+float sqrtf(float x);
+#ifdef __m65832_fpu__
+double sqrt(double x);
+#endif
+
+static inline float fabsf(float x) { return __builtin_fabsf(x); }
+
+/* Batched forms for control loops: x[i] = f(x[i]) for each of the n
+ * elements, with the kernel inlined into one loop. */
+void sinf_v(float *x, unsigned n);
+void cosf_v(float *x, unsigned n);
+void expf_v(float *x, unsigned n);
+void logf_v(float *x, unsigned n);
+void sqrtf_v(float *x, unsigned n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _MATH_H */
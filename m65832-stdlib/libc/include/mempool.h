@@ -0,0 +1,35 @@
+/* mempool.h - Fixed-size object pools */
+
+#ifndef _MEMPOOL_H
+#define _MEMPOOL_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A pool hands out objects of one size from a caller-supplied buffer.
+ * Allocation and free are one pointer swap each, with no per-object header
+ * and no fragmentation. Objects are rounded up to a multiple of 4 bytes,
+ * at least one pointer; the buffer must be 4-byte aligned.
+ */
+typedef struct mempool {
+    void *free_list;
+    size_t obj_size;
+} mempool_t;
+
+/* Bytes of buffer needed for count objects of size bytes */
+#define MEMPOOL_SIZE(size, count) \
+    ((((size) < sizeof(void *) ? sizeof(void *) : (size)) + 3) / 4 * 4 * (count))
+
+void mempool_init(mempool_t *pool, void *mem, size_t obj_size, size_t count);
+void *mempool_alloc(mempool_t *pool);
+void mempool_free(mempool_t *pool, void *obj);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _MEMPOOL_H */
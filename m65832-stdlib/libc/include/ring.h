@@ -0,0 +1,132 @@
+/* ring.h - Lock-free queues for handing data between ISRs and main code */
+
+#ifndef _RING_H
+#define _RING_H
+
+#include <stdint.h>
+
+/*
+ * Both queues hold N elements of type T, N a power of two, and are
+ * defined as a static buffer plus static inline functions, so each call
+ * site inlines to a few loads and stores with no interrupt masking. The
+ * 16-bit indices run freely and are masked on use. Publishing an element
+ * is a release store and checking for one an acquire load, which the
+ * backend emits as FENCEW and FENCER; neither side needs a full FENCE.
+ *
+ * The _DP forms put the indices in .dpdata (__attribute__((dp))), where
+ * they take 8-bit direct-page operands. DP operands are relative to D,
+ * so only use them when every user of the queue runs with crt0's D: no
+ * register windows, and no ctx_switch task banks.
+ */
+
+/*
+ * RING_DEFINE(name, T, N): single producer, single consumer, e.g. a UART
+ * ISR filling it and the main loop draining it. Both sides are wait-free.
+ *
+ *   int name##_push(T v);     0 if full
+ *   int name##_pop(T *v);     0 if empty
+ *   unsigned name##_count(void);
+ */
+#define RING_DEFINE(name, T, N) __RING_DEFINE(name, T, N, )
+#define RING_DEFINE_DP(name, T, N) \
+    __RING_DEFINE(name, T, N, __attribute__((dp)))
+
+#define __RING_DEFINE(name, T, N, ATTR)                                     \
+_Static_assert(((N) & ((N) - 1)) == 0 && (N) <= 32768,                      \
+               "ring size must be a power of two up to 32768");             \
+static T name##_buf[N];                                                     \
+static struct { uint16_t head, tail; } name##_idx ATTR;                     \
+                                                                            \
+static inline __attribute__((unused)) int name##_push(T v) {                \
+    uint16_t t = __atomic_load_n(&name##_idx.tail, __ATOMIC_RELAXED);       \
+    uint16_t h = __atomic_load_n(&name##_idx.head, __ATOMIC_ACQUIRE);       \
+    if ((uint16_t)(t - h) == (N)) {                                         \
+        return 0;                                                           \
+    }                                                                       \
+    name##_buf[t & ((N) - 1)] = v;                                          \
+    __atomic_store_n(&name##_idx.tail, (uint16_t)(t + 1), __ATOMIC_RELEASE);\
+    return 1;                                                               \
+}                                                                           \
+                                                                            \
+static inline __attribute__((unused)) int name##_pop(T *v) {                \
+    uint16_t h = __atomic_load_n(&name##_idx.head, __ATOMIC_RELAXED);       \
+    if (h == __atomic_load_n(&name##_idx.tail, __ATOMIC_ACQUIRE)) {         \
+        return 0;                                                           \
+    }                                                                       \
+    *v = name##_buf[h & ((N) - 1)];                                         \
+    __atomic_store_n(&name##_idx.head, (uint16_t)(h + 1), __ATOMIC_RELEASE);\
+    return 1;                                                               \
+}                                                                           \
+                                                                            \
+static inline __attribute__((unused)) unsigned name##_count(void) {         \
+    uint16_t t = __atomic_load_n(&name##_idx.tail, __ATOMIC_ACQUIRE);       \
+    return (uint16_t)(t - __atomic_load_n(&name##_idx.head,                 \
+                                          __ATOMIC_ACQUIRE));               \
+}
+
+/*
+ * QUEUE_DEFINE(name, T, N): any number of producers, one consumer, e.g.
+ * several ISRs posting events to the main loop. Each slot carries a
+ * sequence number relative to its lap around the buffer (0 free, 1 full,
+ * N consumed), so a zeroed queue is empty and needs no init. A producer
+ * claims a slot with one 16-bit CAS, which only retries when another
+ * producer (an interrupt) claimed it first; the consumer is wait-free. An
+ * element claimed but not yet written, by code an interrupt preempted,
+ * holds back the ones after it until that code resumes.
+ *
+ *   int name##_push(T v);     0 if full
+ *   int name##_pop(T *v);     0 if empty
+ */
+#define QUEUE_DEFINE(name, T, N) __QUEUE_DEFINE(name, T, N, )
+#define QUEUE_DEFINE_DP(name, T, N) \
+    __QUEUE_DEFINE(name, T, N, __attribute__((dp)))
+
+#define __QUEUE_DEFINE(name, T, N, ATTR)                                    \
+_Static_assert(((N) & ((N) - 1)) == 0 && (N) <= 16384,                      \
+               "queue size must be a power of two up to 16384");            \
+static struct { uint16_t seq; T val; } name##_slot[N];                      \
+static struct { uint16_t head, tail; } name##_idx ATTR;                     \
+                                                                            \
+static inline __attribute__((unused)) int name##_push(T v) {                \
+    uint16_t pos = __atomic_load_n(&name##_idx.tail, __ATOMIC_RELAXED);     \
+    uint16_t lap;                                                           \
+    for (;;) {                                                              \
+        lap = pos & ~((N) - 1);                                             \
+        uint16_t seq = __atomic_load_n(&name##_slot[pos & ((N) - 1)].seq,   \
+                                       __ATOMIC_ACQUIRE);                   \
+        int16_t dif = (int16_t)(seq - lap);                                 \
+        if (dif == 0) {                                                     \
+            if (__atomic_compare_exchange_n(&name##_idx.tail, &pos,         \
+                                            (uint16_t)(pos + 1), 0,         \
+                                            __ATOMIC_RELAXED,               \
+                                            __ATOMIC_RELAXED)) {            \
+                break;                                                      \
+            }                                                               \
+        } else if (dif < 0) {                                               \
+            return 0;                                                       \
+        } else {                                                            \
+            pos = __atomic_load_n(&name##_idx.tail, __ATOMIC_RELAXED);      \
+        }                                                                   \
+    }                                                                       \
+    name##_slot[pos & ((N) - 1)].val = v;                                   \
+    __atomic_store_n(&name##_slot[pos & ((N) - 1)].seq,                     \
+                     (uint16_t)(lap + 1), __ATOMIC_RELEASE);                \
+    return 1;                                                               \
+}                                                                           \
+                                                                            \
+static inline __attribute__((unused)) int name##_pop(T *v) {                \
+    uint16_t pos = __atomic_load_n(&name##_idx.head, __ATOMIC_RELAXED);     \
+    uint16_t lap = pos & ~((N) - 1);                                        \
+    if (__atomic_load_n(&name##_slot[pos & ((N) - 1)].seq,                  \
+                        __ATOMIC_ACQUIRE) != (uint16_t)(lap + 1)) {         \
+        return 0;                                                           \
+    }                                                                       \
+    *v = name##_slot[pos & ((N) - 1)].val;                                  \
+    __atomic_store_n(&name##_slot[pos & ((N) - 1)].seq,                     \
+                     (uint16_t)(lap + (N)), __ATOMIC_RELEASE);              \
+    __atomic_store_n(&name##_idx.head, (uint16_t)(pos + 1),                 \
+                     __ATOMIC_RELAXED);                                     \
+    return 1;                                                               \
+}
+
+#endif /* _RING_H */
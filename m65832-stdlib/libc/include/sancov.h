@@ -0,0 +1,46 @@
+/* sancov.h - SanitizerCoverage hooks for coverage-guided fuzzing */
+
+#ifndef _SANCOV_H
+#define _SANCOV_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Code built with -fsanitize-coverage=trace-pc-guard calls
+ * __sanitizer_cov_trace_pc_guard on every edge. The hooks in libc number
+ * the guards from 1 and count hits per edge in sancov_map, AFL style:
+ * edge N uses byte N % SANCOV_MAP_SIZE and the count saturates at 255.
+ * -fsanitize-coverage=inline-8bit-counters needs no calls at all; its
+ * counters are reset and counted along with the map.
+ */
+#ifndef SANCOV_MAP_SIZE
+#define SANCOV_MAP_SIZE  1024   /* power of two */
+#endif
+
+extern uint8_t sancov_map[SANCOV_MAP_SIZE];
+
+/* Instrumented edges (guards) in the program */
+uint32_t sancov_edges(void);
+
+/* Clear the map and the inline counters before running the next input */
+void sancov_reset(void);
+
+/* Map bytes and inline counters that are nonzero */
+uint32_t sancov_covered(void);
+
+/*
+ * Write the map as hex, 32 bytes per line, between "--- sancov begin
+ * <edges> ---" and "--- sancov end ---" lines, for a fuzzer driving the
+ * emulator to read back from the console
+ */
+void sancov_dump(void (*put_char)(int));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SANCOV_H */
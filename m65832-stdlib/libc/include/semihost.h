@@ -0,0 +1,106 @@
+/* semihost.h - Emulator semihosting calls */
+
+#ifndef _SEMIHOST_H
+#define _SEMIHOST_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A semihosting call is TRAP #SEMIHOST_TRAP with the operation number in
+ * A and the address of its argument block (32-bit words) in X. The
+ * emulator does the operation on the host, puts the result in A and
+ * resumes after the TRAP; nothing else changes. A negative result is
+ * -errno, in the Unix numbering newlib and picolibc share. On hardware,
+ * or an emulator without semihosting, the TRAP goes to the system call
+ * vector instead, so only build the syscalls with -DM65832_SEMIHOST for
+ * programs that run under one.
+ *
+ * Descriptors 0-2 are the host's stdin, stdout and stderr. Files opened
+ * with SEMIHOST_OPEN get descriptors from 3 up. Reads and writes move the
+ * whole buffer in one call, so a program loads its input and dumps its
+ * results at memory speed rather than one UART byte at a time.
+ */
+#define SEMIHOST_TRAP    0xAB
+
+                                /* Arguments          Result */
+#define SEMIHOST_OPEN    1      /* path, len, flags   fd */
+#define SEMIHOST_CLOSE   2      /* fd                 0 */
+#define SEMIHOST_READ    3      /* fd, buf, len       bytes read, 0 at EOF */
+#define SEMIHOST_WRITE   4      /* fd, buf, len       bytes written */
+#define SEMIHOST_LSEEK   5      /* fd, offset, whence new offset */
+#define SEMIHOST_CLOCK   6      /* sec, nsec (out)    0; host real time */
+#define SEMIHOST_EXIT    7      /* status             does not return */
+
+/* SEMIHOST_OPEN flags, independent of the libc's O_* values. path need
+ * not be NUL-terminated; len is its length in bytes. */
+#define SEMIHOST_O_RDONLY 0x0
+#define SEMIHOST_O_WRONLY 0x1
+#define SEMIHOST_O_RDWR   0x2
+#define SEMIHOST_O_ACCMODE 0x3
+#define SEMIHOST_O_CREAT  0x4
+#define SEMIHOST_O_TRUNC  0x8
+#define SEMIHOST_O_APPEND 0x10
+#define SEMIHOST_O_EXCL   0x20
+
+#define SEMIHOST_STR_(x) #x
+#define SEMIHOST_STR(x)  SEMIHOST_STR_(x)
+
+static inline int32_t semihost_call(uint32_t op, void *args) {
+    int32_t ret;
+    asm volatile("trap #" SEMIHOST_STR(SEMIHOST_TRAP)
+                 : "=a"(ret)
+                 : "0"(op), "x"(args)
+                 : "memory");
+    return ret;
+}
+
+static inline int32_t semihost_open(const char *path, uint32_t len,
+                                    uint32_t flags) {
+    uint32_t args[3] = {(uint32_t)path, len, flags};
+    return semihost_call(SEMIHOST_OPEN, args);
+}
+
+static inline int32_t semihost_close(int fd) {
+    uint32_t args[1] = {(uint32_t)fd};
+    return semihost_call(SEMIHOST_CLOSE, args);
+}
+
+static inline int32_t semihost_read(int fd, void *buf, uint32_t len) {
+    uint32_t args[3] = {(uint32_t)fd, (uint32_t)buf, len};
+    return semihost_call(SEMIHOST_READ, args);
+}
+
+static inline int32_t semihost_write(int fd, const void *buf, uint32_t len) {
+    uint32_t args[3] = {(uint32_t)fd, (uint32_t)buf, len};
+    return semihost_call(SEMIHOST_WRITE, args);
+}
+
+static inline int32_t semihost_lseek(int fd, int32_t offset, int whence) {
+    uint32_t args[3] = {(uint32_t)fd, (uint32_t)offset, (uint32_t)whence};
+    return semihost_call(SEMIHOST_LSEEK, args);
+}
+
+/* Host wall-clock time; the cycle counter only counts from reset */
+static inline int32_t semihost_clock(uint32_t *sec, uint32_t *nsec) {
+    uint32_t args[2];
+    int32_t ret = semihost_call(SEMIHOST_CLOCK, args);
+    *sec = args[0];
+    *nsec = args[1];
+    return ret;
+}
+
+static inline void __attribute__((noreturn)) semihost_exit(int status) {
+    uint32_t args[1] = {(uint32_t)status};
+    semihost_call(SEMIHOST_EXIT, args);
+    __builtin_unreachable();
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SEMIHOST_H */
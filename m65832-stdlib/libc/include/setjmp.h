@@ -0,0 +1,28 @@
+/* setjmp.h - Non-local jumps */
+
+#ifndef _SETJMP_H
+#define _SETJMP_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A jmp_buf holds only what a call has to preserve: the return address,
+ * SP, B, D (which windowed functions move), R29, R16-R23, R48-R55 and
+ * F14/F15. The F registers are saved when libc is built for the FPU.
+ */
+#define _JBLEN 25
+
+typedef uint32_t jmp_buf[_JBLEN];
+
+int setjmp(jmp_buf env) __attribute__((returns_twice));
+void longjmp(jmp_buf env, int val) __attribute__((noreturn));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SETJMP_H */
@@ -0,0 +1,123 @@
+/* sort.h - Typed sorting with an inlined comparison */
+
+#ifndef _SORT_H
+#define _SORT_H
+
+#include <stddef.h>
+
+/*
+ * SORT_DEFINE(name, T, LESS) defines, as static functions,
+ *
+ *   void name(T *a, size_t n);                       sort a[0..n)
+ *   T *name##_find(T *a, size_t n, const T *key);     binary search
+ *
+ * with the same introsort as qsort. LESS(x, y) is a function-like macro
+ * or an inline function taking two T values and returning nonzero when x
+ * sorts before y. Unlike qsort, each comparison is inlined and elements
+ * move as whole T values, so sorting ints or small structs makes no calls
+ * at all. For example:
+ *
+ *   #define BY_KEY(x, y) ((x).key < (y).key)
+ *   SORT_DEFINE(sort_items, struct item, BY_KEY)
+ */
+#define SORT_DEFINE(name, T, LESS)                                      \
+static void name##_insertion(T *a, size_t n) {                          \
+    for (size_t i = 1; i < n; i++) {                                    \
+        T v = a[i];                                                     \
+        size_t j = i;                                                   \
+        for (; j > 0 && LESS(v, a[j - 1]); j--) {                       \
+            a[j] = a[j - 1];                                            \
+        }                                                               \
+        a[j] = v;                                                       \
+    }                                                                   \
+}                                                                       \
+                                                                        \
+static void name##_sift(T *a, size_t root, size_t n) {                  \
+    T v = a[root];                                                      \
+    for (size_t child; (child = 2 * root + 1) < n; root = child) {      \
+        if (child + 1 < n && LESS(a[child], a[child + 1])) {            \
+            child++;                                                    \
+        }                                                               \
+        if (!LESS(v, a[child])) {                                       \
+            break;                                                      \
+        }                                                               \
+        a[root] = a[child];                                             \
+    }                                                                   \
+    a[root] = v;                                                        \
+}                                                                       \
+                                                                        \
+static void name##_intro(T *a, size_t n, int depth) {                   \
+    while (n > 8) {                                                     \
+        if (depth-- == 0) {                                             \
+            for (size_t i = n / 2; i > 0; i--) {                        \
+                name##_sift(a, i - 1, n);                               \
+            }                                                           \
+            for (size_t i = n - 1; i > 0; i--) {                        \
+                T t = a[0];                                             \
+                a[0] = a[i];                                            \
+                a[i] = t;                                               \
+                name##_sift(a, 0, i);                                   \
+            }                                                           \
+            return;                                                     \
+        }                                                               \
+        size_t m = n / 2, h = n - 1;                                    \
+        T t;                                                            \
+        if (LESS(a[m], a[0])) {                                         \
+            t = a[m]; a[m] = a[0]; a[0] = t;                            \
+        }                                                               \
+        if (LESS(a[h], a[m])) {                                         \
+            t = a[h]; a[h] = a[m]; a[m] = t;                            \
+            if (LESS(a[m], a[0])) {                                     \
+                t = a[m]; a[m] = a[0]; a[0] = t;                        \
+            }                                                           \
+        }                                                               \
+        T pivot = a[m];                                                 \
+        a[m] = a[0];                                                    \
+        a[0] = pivot;                                                   \
+        size_t i = 0, j = n;                                            \
+        for (;;) {                                                      \
+            while (LESS(a[++i], pivot)) {                               \
+            }                                                           \
+            while (LESS(pivot, a[--j])) {                               \
+            }                                                           \
+            if (i >= j) {                                               \
+                break;                                                  \
+            }                                                           \
+            t = a[i]; a[i] = a[j]; a[j] = t;                            \
+        }                                                               \
+        a[0] = a[j];                                                    \
+        a[j] = pivot;                                                   \
+        if (j < n - j - 1) {                                            \
+            name##_intro(a, j, depth);                                  \
+            a += j + 1;                                                 \
+            n -= j + 1;                                                 \
+        } else {                                                        \
+            name##_intro(a + j + 1, n - j - 1, depth);                  \
+            n = j;                                                      \
+        }                                                               \
+    }                                                                   \
+    name##_insertion(a, n);                                             \
+}                                                                       \
+                                                                        \
+static inline __attribute__((unused)) void name(T *a, size_t n) {       \
+    if (n > 1) {                                                        \
+        name##_intro(a, n, 2 * (31 - __builtin_clz(n)));                \
+    }                                                                   \
+}                                                                       \
+                                                                        \
+static inline __attribute__((unused)) T *name##_find(T *a, size_t n,    \
+                                                     const T *key) {    \
+    T *lo = a, *end = a + n;                                            \
+    while (n) {                                                         \
+        size_t half = n / 2;                                            \
+        if (LESS(lo[half], *key)) {                                     \
+            lo += half + 1;                                             \
+            n -= half + 1;                                              \
+        } else {                                                        \
+            n = half;                                                   \
+        }                                                               \
+    }                                                                   \
+    return lo < end && !LESS(*key, *lo) ? lo : NULL;                    \
+}
+
+#endif /* _SORT_H */
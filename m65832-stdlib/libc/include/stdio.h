@@ -12,7 +12,13 @@ extern "C" {
 
 #define EOF (-1)
 
-/* Simple output functions - no FILE* for minimal implementation */
+/* stdout is the only stream; it is buffered, fflush waits for it to
+ * reach the UART */
+typedef struct __FILE FILE;
+extern FILE *const stdout;
+int fflush(FILE *stream);
+
+/* Simple output functions */
 int putchar(int c);
 int puts(const char *s);
 int printf(const char *format, ...) __attribute__((format(printf, 1, 2)));
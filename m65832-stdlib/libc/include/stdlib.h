@@ -26,6 +26,12 @@ long atol(const char *nptr);
 long strtol(const char *nptr, char **endptr, int base);
 unsigned long strtoul(const char *nptr, char **endptr, int base);
 
+/* Floating-point conversion, in libm (FPU builds only) */
+#ifdef __m65832_fpu__
+double strtod(const char *nptr, char **endptr);
+double atof(const char *nptr);
+#endif
+
 /* Misc */
 int abs(int j);
 long labs(long j);
@@ -0,0 +1,39 @@
+/* time.h - Time functions */
+
+#ifndef _TIME_H
+#define _TIME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Times come from the cycle counter (see timer.h); there is no real-time
+ * clock, so CLOCK_REALTIME and time() count from reset as well. */
+typedef unsigned long clock_t;
+typedef long long time_t;
+typedef int clockid_t;
+
+#define CLOCKS_PER_SEC 1000000ul
+
+#define CLOCK_REALTIME           0
+#define CLOCK_MONOTONIC          1
+#define CLOCK_PROCESS_CPUTIME_ID 2
+
+struct timespec {
+    time_t tv_sec;
+    long tv_nsec;
+};
+
+clock_t clock(void);
+time_t time(time_t *tloc);
+int clock_gettime(clockid_t clk, struct timespec *tp);
+int clock_getres(clockid_t clk, struct timespec *res);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _TIME_H */
@@ -0,0 +1,58 @@
+/* timer.h - System timer and cycle counter */
+
+#ifndef _TIMER_H
+#define _TIMER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The system timer block sits after the UART. Its 64-bit counter counts
+ * CPU cycles from reset; reading the low word latches the high word, so
+ * read low then high. clang's __m65832_cycles() does exactly that in two
+ * loads (-mllvm -m65832-cycle-counter-addr moves it along with
+ * TIMER_BASE).
+ */
+#ifndef TIMER_BASE
+#define TIMER_BASE       0x00FFF110
+#endif
+#define TIMER_CYCLES_LO  (*(volatile uint32_t *)(TIMER_BASE + 0))
+#define TIMER_CYCLES_HI  (*(volatile uint32_t *)(TIMER_BASE + 4))
+
+/* Core clock; override with -DTIMER_HZ=... for other boards. A whole
+ * number of MHz keeps the conversions below exact. */
+#ifndef TIMER_HZ
+#define TIMER_HZ         50000000u
+#endif
+#define TIMER_CYCLES_PER_US (TIMER_HZ / 1000000u)
+
+/* Cycles since reset */
+static inline uint64_t timer_cycles(void) {
+#if defined(__has_builtin) && __has_builtin(__m65832_cycles)
+    return __m65832_cycles();
+#else
+    uint32_t lo = TIMER_CYCLES_LO;
+    uint32_t hi = TIMER_CYCLES_HI;
+    return (uint64_t)hi << 32 | lo;
+#endif
+}
+
+/* Low word only: one load, for timing intervals under 2^32 cycles */
+static inline uint32_t timer_cycles32(void) {
+    return TIMER_CYCLES_LO;
+}
+
+uint64_t timer_cycles_to_ns(uint64_t cycles);
+uint64_t timer_cycles_to_us(uint64_t cycles);
+
+/* Busy-wait for at least us microseconds */
+void timer_delay_us(uint32_t us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _TIMER_H */
@@ -0,0 +1,63 @@
+/* ctype.c - Character classification for the C locale
+ *
+ * The <ctype.h> macros index __ctype_table directly. The functions here
+ * are the same lookups, for programs that take their address or
+ * #undef the macros.
+ */
+
+#include <ctype.h>
+
+#define U _CTYPE_U
+#define L _CTYPE_L
+#define D _CTYPE_D
+#define S _CTYPE_S
+#define P _CTYPE_P
+#define C _CTYPE_C
+#define X _CTYPE_X
+#define B _CTYPE_B
+
+const unsigned char __ctype_table[256] = {
+    [0x00 ... 0x08] = C,
+    ['\t' ... '\r'] = C | S,
+    [0x0E ... 0x1F] = C,
+    [' '] = S | B,
+    ['!' ... '/'] = P,
+    ['0' ... '9'] = D,
+    [':' ... '@'] = P,
+    ['A' ... 'F'] = U | X,
+    ['G' ... 'Z'] = U,
+    ['[' ... '`'] = P,
+    ['a' ... 'f'] = L | X,
+    ['g' ... 'z'] = L,
+    ['{' ... '~'] = P,
+    [0x7F] = C,
+};
+
+#undef isalnum
+#undef isalpha
+#undef isdigit
+#undef isxdigit
+#undef islower
+#undef isupper
+#undef isspace
+#undef isprint
+#undef isgraph
+#undef ispunct
+#undef iscntrl
+#undef tolower
+#undef toupper
+
+int isalnum(int c)  { return __ctype_class(c) & (U | L | D); }
+int isalpha(int c)  { return __ctype_class(c) & (U | L); }
+int isdigit(int c)  { return __ctype_class(c) & D; }
+int isxdigit(int c) { return __ctype_class(c) & (D | X); }
+int islower(int c)  { return __ctype_class(c) & L; }
+int isupper(int c)  { return __ctype_class(c) & U; }
+int isspace(int c)  { return __ctype_class(c) & S; }
+int isprint(int c)  { return __ctype_class(c) & (U | L | D | P | B); }
+int isgraph(int c)  { return __ctype_class(c) & (U | L | D | P); }
+int ispunct(int c)  { return __ctype_class(c) & P; }
+int iscntrl(int c)  { return __ctype_class(c) & C; }
+
+int tolower(int c) { return __tolower(c); }
+int toupper(int c) { return __toupper(c); }
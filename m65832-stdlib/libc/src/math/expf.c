@@ -0,0 +1,41 @@
+/* expf.c - Single-precision exponential
+ *
+ * exp(x) = 2^n * exp(r) with n = round(x / ln 2) and r = x - n ln 2 in
+ * [-ln2/2, ln2/2], in two Cody-Waite steps; exp(r) is the Cephes
+ * degree-7 polynomial. 2^n goes straight into the exponent field.
+ */
+#include <math.h>
+#include "mathf.h"
+
+#define LOG2E   1.44269504088896341f
+#define C1      0.693359375f       /* ln 2, high part, exact */
+#define C2      -2.12194440e-4f    /* ln 2 - C1 */
+#define MAXLOGF 88.72283905206835f  /* ln(FLT_MAX) */
+#define MINLOGF -103.972077083991f  /* ln(2^-150), below every denormal */
+
+static inline float exp_kernel(float x) {
+    if (!(x <= MAXLOGF))
+        return x + HUGE_VALF; /* +Inf, or NaN for NaN */
+    if (x < MINLOGF)
+        return 0.0f;
+
+    int32_t n = mf_round(LOG2E * x);
+    float fn = (float)n;
+    float r = x - fn * C1;
+    r -= fn * C2;
+
+    float z = r * r;
+    float p = (((((1.9875691500e-4f * r + 1.3981999507e-3f) * r +
+                  8.3334519073e-3f) * r + 4.1665795894e-2f) * r +
+                1.6666665459e-1f) * r + 5.0000001201e-1f) * z + r + 1.0f;
+    return mf_scale(p, n);
+}
+
+float expf(float x) {
+    return exp_kernel(x);
+}
+
+void expf_v(float *x, unsigned n) {
+    for (unsigned i = 0; i < n; i++)
+        x[i] = exp_kernel(x[i]);
+}
@@ -0,0 +1,225 @@
+/* fpconv.c - Decimal conversion of doubles on the FPU
+ *
+ * Both directions scale by powers of ten in double precision (FMUL.D and
+ * FDIV.D) and move between the FPU and the integer side nine digits at a
+ * time with F2I.D/I2F.D, so the only integer math is 32-bit. Building
+ * the power rounds a few times, which leaves some error in the last
+ * place: the digits are good to about 16 significant places (%.15g can
+ * be off by one when the 16th is on a rounding boundary) and strtod is
+ * within about 4 ulps, not correctly rounded.
+ *
+ * printf reaches __fp_digits when libc is built with PRINTF_FLOAT; it
+ * passes the double by address, since libc itself may be soft-float and
+ * the FPU ABI takes doubles in F registers.
+ */
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef __m65832_fpu__
+
+/* 10^(2^i) */
+static const double pow10_bits[9] = {
+    1e1, 1e2, 1e4, 1e8, 1e16, 1e32, 1e64, 1e128, 1e256,
+};
+
+/*
+ * x * 10^n. The power is built first and applied once, which rounds x
+ * fewer times than stepping it; past 10^256 that step goes first so the
+ * power stays finite.
+ */
+static double scale10(double x, int n) {
+    int neg = n < 0;
+    if (neg)
+        n = -n;
+    if (n >= 256) {
+        x = neg ? x / pow10_bits[8] : x * pow10_bits[8];
+        n -= 256;
+    }
+    double p = 1.0;
+    for (int i = 0; i < 8; i++) {
+        if (n & (1 << i))
+            p *= pow10_bits[i];
+    }
+    return neg ? x / p : x * p;
+}
+
+static uint32_t high_word(double x) {
+    union { double d; uint32_t u[2]; } b;
+    b.d = x;
+    return b.u[1];
+}
+
+/* Nine digits of v < 10^9, most significant first */
+static void put9(char *p, uint32_t v) {
+    for (int i = 8; i >= 0; i--) {
+        uint32_t q = v / 10;
+        p[i] = '0' + (v - q * 10);
+        v = q;
+    }
+}
+
+/*
+ * The first 18 significant digits of |*v|, truncated, and the decimal
+ * exponent of the first: |v| = d0.d1d2... * 10^exp. Zero gives all zeros
+ * and exponent 0. *v must be finite.
+ */
+int __fp_digits(const double *v, char digits[18]) {
+    double x = __builtin_fabs(*v);
+    int bias = 0;
+
+    if (x == 0.0) {
+        for (int i = 0; i < 18; i++)
+            digits[i] = '0';
+        return 0;
+    }
+
+    /* Subnormals: bring them up where the exponent field is meaningful */
+    if (x < 2.2250738585072014e-308) {
+        x *= 1e16;
+        bias = -16;
+    }
+
+    /* floor(e2 * log10(2)) is the decimal exponent or one below it */
+    int32_t e2 = (int32_t)(high_word(x) >> 20) - 1023;
+    int32_t e = (e2 * 78913) >> 18;
+
+    double w = scale10(x, 8 - e);
+    if (w >= 1e9) {
+        e++;
+        w = scale10(x, 8 - e);
+    }
+    if (w < 1e8) {
+        e--;
+        w *= 10.0;
+    }
+
+    uint32_t hi = (uint32_t)(int32_t)w;
+    if (hi >= 1000000000u)
+        hi = 999999999u;
+    double frac = (w - (double)(int32_t)hi) * 1e9;
+    uint32_t lo = frac <= 0.0 ? 0 : (uint32_t)(int32_t)frac;
+    if (lo >= 1000000000u)
+        lo = 999999999u;
+
+    put9(digits, hi);
+    put9(digits + 9, lo);
+    return e + bias;
+}
+
+static int is_digit(char c) {
+    return (unsigned)(c - '0') < 10;
+}
+
+static int match_word(const char *s, const char *word) {
+    int n = 0;
+    while (*word) {
+        if ((*s | 0x20) != *word)
+            return 0;
+        s++, word++, n++;
+    }
+    return n;
+}
+
+double strtod(const char *nptr, char **endptr) {
+    const char *s = nptr;
+    int neg = 0;
+
+    while (*s == ' ' || (unsigned)(*s - '\t') < 5)
+        s++;
+    if (*s == '-' || *s == '+')
+        neg = *s++ == '-';
+
+    /* inf, infinity and nan */
+    int n;
+    if ((n = match_word(s, "inf"))) {
+        s += n;
+        if ((n = match_word(s, "inity")))
+            s += n;
+        if (endptr)
+            *endptr = (char *)s;
+        return neg ? -__builtin_inf() : __builtin_inf();
+    }
+    if ((n = match_word(s, "nan"))) {
+        if (endptr)
+            *endptr = (char *)(s + n);
+        return __builtin_nan("");
+    }
+
+    /* Up to 18 significant digits, in two groups of nine; the rest only
+     * move the exponent */
+    uint32_t hi = 0, lo = 0;
+    int nsig = 0, nlo = 0, exp10 = 0, any = 0;
+    for (int dot = 0;; s++) {
+        if (*s == '.' && !dot) {
+            dot = 1;
+            continue;
+        }
+        if (!is_digit(*s))
+            break;
+        any = 1;
+        uint32_t d = *s - '0';
+        if (nsig == 0 && d == 0) {
+            if (dot)
+                exp10--;
+            continue;
+        }
+        if (nsig < 9) {
+            hi = hi * 10 + d;
+        } else if (nsig < 18) {
+            lo = lo * 10 + d;
+            nlo++;
+        } else if (!dot) {
+            exp10++;
+        }
+        if (nsig < 18) {
+            nsig++;
+            if (dot)
+                exp10--;
+        }
+    }
+    if (!any) {
+        if (endptr)
+            *endptr = (char *)nptr;
+        return 0.0;
+    }
+
+    if ((*s | 0x20) == 'e') {
+        const char *e = s + 1;
+        int eneg = 0;
+        if (*e == '-' || *e == '+')
+            eneg = *e++ == '-';
+        if (is_digit(*e)) {
+            int ev = 0;
+            while (is_digit(*e)) {
+                if (ev < 10000)
+                    ev = ev * 10 + (*e - '0');
+                e++;
+            }
+            exp10 += eneg ? -ev : ev;
+            s = e;
+        }
+    }
+    if (endptr)
+        *endptr = (char *)s;
+
+    double x = (double)(int32_t)hi;
+    if (nlo)
+        x = scale10(x, nlo) + (double)(int32_t)lo;
+
+    /* Keep the scaling in range: the digits are at most 10^18 */
+    if (exp10 > 330)
+        x = x == 0.0 ? 0.0 : __builtin_inf();
+    else if (exp10 < -360)
+        x = 0.0;
+    else if (exp10 < -300)
+        x = scale10(scale10(x, -300), exp10 + 300);
+    else
+        x = scale10(x, exp10);
+    return neg ? -x : x;
+}
+
+double atof(const char *nptr) {
+    return strtod(nptr, NULL);
+}
+
+#endif
@@ -0,0 +1,61 @@
+/* logf.c - Single-precision natural logarithm
+ *
+ * log(x) = e ln 2 + log(m) with m in [sqrt(2)/2, sqrt(2)) taken from the
+ * bits of x; log(1 + f) is the Cephes degree-9 polynomial, and e ln 2 is
+ * added in two parts so the larger one is exact.
+ */
+#include <math.h>
+#include "mathf.h"
+
+#define SQRTHF 0.707106781186547524f
+#define C1     0.693359375f
+#define C2     -2.12194440e-4f
+
+static inline float log_kernel(float x) {
+    uint32_t u = mf_bits(x);
+    int32_t e = -126;
+
+    if (u - 0x00800000u >= 0x7F000000u) {
+        /* Zero, denormal, negative, Inf or NaN */
+        if ((u & 0x7FFFFFFFu) == 0)
+            return -HUGE_VALF;
+        if (u >> 31)
+            return NAN;
+        if (u >= 0x7F800000u)
+            return x + x; /* Inf stays, NaN quietens */
+        /* Denormal: scale by 2^25 into the normal range */
+        u = mf_bits(x * 0x1p25f);
+        e -= 25;
+    }
+
+    /* x = 2^e * m, m in [0.5, 1) */
+    e += (int32_t)(u >> 23);
+    float m = mf_float((u & 0x007FFFFFu) | 0x3F000000u);
+    float f;
+    if (m < SQRTHF) {
+        e -= 1;
+        f = m + m - 1.0f;
+    } else {
+        f = m - 1.0f;
+    }
+
+    float z = f * f;
+    float y = ((((((((7.0376836292e-2f * f - 1.1514610310e-1f) * f +
+                     1.1676998740e-1f) * f - 1.2420140846e-1f) * f +
+                   1.4249322787e-1f) * f - 1.6668057665e-1f) * f +
+                 2.0000714765e-1f) * f - 2.4999993993e-1f) * f +
+               3.3333331174e-1f) * f * z;
+    float fe = (float)e;
+    y += C2 * fe;
+    y -= 0.5f * z;
+    return f + y + C1 * fe;
+}
+
+float logf(float x) {
+    return log_kernel(x);
+}
+
+void logf_v(float *x, unsigned n) {
+    for (unsigned i = 0; i < n; i++)
+        x[i] = log_kernel(x[i]);
+}
@@ -0,0 +1,42 @@
+/* mathf.h - Shared helpers for the single-precision math routines
+ *
+ * The kernels stay in float so they run on the FPU, and any integer work
+ * (exponents, quadrants) is 32-bit: 64-bit integer math is a chain of
+ * carries here and has no place in them.
+ */
+#ifndef M65832_MATHF_H
+#define M65832_MATHF_H
+
+#include <stdint.h>
+
+static inline uint32_t mf_bits(float f) {
+    union { float f; uint32_t u; } b;
+    b.f = f;
+    return b.u;
+}
+
+static inline float mf_float(uint32_t u) {
+    union { float f; uint32_t u; } b;
+    b.u = u;
+    return b.f;
+}
+
+/* Round to the nearest integer, halfway away from zero. F2I.S truncates,
+ * so push x half a unit away from zero first. |x| must fit an int32. */
+static inline int32_t mf_round(float x) {
+    return (int32_t)(x < 0.0f ? x - 0.5f : x + 0.5f);
+}
+
+/* x * 2^n for n in [-252, 254], by at most two exact power-of-two scales */
+static inline float mf_scale(float x, int32_t n) {
+    if (n > 127) {
+        x *= mf_float(0x7F000000u); /* 2^127 */
+        n -= 127;
+    } else if (n < -126) {
+        x *= mf_float(0x00800000u); /* 2^-126 */
+        n += 126;
+    }
+    return x * mf_float((uint32_t)(n + 127) << 23);
+}
+
+#endif
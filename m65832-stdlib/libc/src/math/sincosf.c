@@ -0,0 +1,91 @@
+/* sincosf.c - Single-precision sine and cosine
+ *
+ * Cody-Waite reduction by pi/4 in float, then a degree-7 sine or degree-8
+ * cosine polynomial on [-pi/4, pi/4] (the Cephes coefficients).
+ */
+#include <math.h>
+#include "mathf.h"
+
+#define FOPI 1.27323954473516f  /* 4/pi */
+/* pi/4 in three parts; the first two have few enough significant bits
+ * that j * DP1 and j * DP2 are exact for |x| < 8192 */
+#define DP1 0.78515625f
+#define DP2 2.4187564849853515625e-4f
+#define DP3 3.77489497744594108e-8f
+
+/* Past this, F2I.S of x * 4/pi and the reduction both break down */
+#define REDUCE_MAX 0x1p24f
+
+static inline float sin_poly(float x, float z) {
+    return ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z -
+            1.6666654611e-1f) * z * x + x;
+}
+
+static inline float cos_poly(float z) {
+    return ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z +
+            4.166664568298827e-2f) * z * z - 0.5f * z + 1.0f;
+}
+
+/* Reduce |x| to r in [-pi/4, pi/4]; returns the octant, 0..7, of the
+ * nearest even multiple of pi/4 */
+static inline uint32_t reduce(float ax, float *r) {
+    int32_t j = (int32_t)(FOPI * ax);
+    j += j & 1;
+    float y = (float)j;
+    *r = ((ax - y * DP1) - y * DP2) - y * DP3;
+    return (uint32_t)j & 7;
+}
+
+static inline float sin_kernel(float x) {
+    float ax = __builtin_fabsf(x);
+    if (!(ax < REDUCE_MAX))
+        return x - x; /* NaN for NaN and Inf, otherwise 0 */
+
+    float r;
+    uint32_t j = reduce(ax, &r);
+    uint32_t neg = mf_bits(x) >> 31;
+    if (j > 3) {
+        neg ^= 1;
+        j -= 4;
+    }
+    float z = r * r;
+    float y = (j == 1 || j == 2) ? cos_poly(z) : sin_poly(r, z);
+    return neg ? -y : y;
+}
+
+static inline float cos_kernel(float x) {
+    float ax = __builtin_fabsf(x);
+    if (!(ax < REDUCE_MAX))
+        return x - x;
+
+    float r;
+    uint32_t j = reduce(ax, &r);
+    uint32_t neg = 0;
+    if (j > 3) {
+        neg = 1;
+        j -= 4;
+    }
+    if (j > 1)
+        neg ^= 1;
+    float z = r * r;
+    float y = (j == 1 || j == 2) ? sin_poly(r, z) : cos_poly(z);
+    return neg ? -y : y;
+}
+
+float sinf(float x) {
+    return sin_kernel(x);
+}
+
+float cosf(float x) {
+    return cos_kernel(x);
+}
+
+void sinf_v(float *x, unsigned n) {
+    for (unsigned i = 0; i < n; i++)
+        x[i] = sin_kernel(x[i]);
+}
+
+void cosf_v(float *x, unsigned n) {
+    for (unsigned i = 0; i < n; i++)
+        x[i] = cos_kernel(x[i]);
+}
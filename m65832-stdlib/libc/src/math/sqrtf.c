@@ -0,0 +1,80 @@
+/* sqrtf.c - Square roots
+ *
+ * FSQRT.S and FSQRT.D are correctly rounded, so with the FPU these are the
+ * instructions themselves. Built without it, sqrtf falls back to a
+ * digit-by-digit integer square root of the significand (also correctly
+ * rounded) and there is no double sqrt.
+ */
+#include <math.h>
+#include "mathf.h"
+
+#ifdef __m65832_fpu__
+
+static inline float sqrt_kernel(float x) {
+    return __builtin_sqrtf(x);
+}
+
+double sqrt(double x) {
+    return __builtin_sqrt(x);
+}
+
+#else
+
+static inline float sqrt_kernel(float x) {
+    uint32_t u = mf_bits(x);
+
+    if (u - 1u >= 0x7F7FFFFFu) {
+        /* Zero, negative, Inf or NaN */
+        if ((u & 0x7FFFFFFFu) == 0 || u == 0x7F800000u)
+            return x;
+        if ((u & 0x7FFFFFFFu) > 0x7F800000u)
+            return x + x;
+        return NAN;
+    }
+
+    int32_t e = (int32_t)(u >> 23);
+    uint32_t m = u & 0x007FFFFFu;
+    if (e == 0) {
+        /* Denormal: normalize */
+        int shift = __builtin_clz(m) - 8;
+        m <<= shift;
+        e = 1 - shift;
+    }
+    m |= 0x00800000u;
+    e -= 127;
+    /* Make the exponent even; m is then in [2^23, 2^25) */
+    if (e & 1)
+        m <<= 1;
+    e >>= 1;
+
+    /* 25-bit root of m * 2^25, one result bit per step, then the
+     * remainder decides rounding (no ties: the root of a float is never
+     * halfway between two floats) */
+    uint32_t rem = m << 1;
+    uint32_t q = 0;
+    uint32_t bit = 0x01000000u;
+    uint32_t s = 0;
+    while (bit) {
+        uint32_t t = s + bit;
+        if (t <= rem) {
+            s = t + bit;
+            rem -= t;
+            q += bit;
+        }
+        rem <<= 1;
+        bit >>= 1;
+    }
+    q = (q + (rem != 0 && (q & 1))) >> 1;
+    return mf_float(q + ((uint32_t)(e + 126) << 23));
+}
+
+#endif
+
+float sqrtf(float x) {
+    return sqrt_kernel(x);
+}
+
+void sqrtf_v(float *x, unsigned n) {
+    for (unsigned i = 0; i < n; i++)
+        x[i] = sqrt_kernel(x[i]);
+}
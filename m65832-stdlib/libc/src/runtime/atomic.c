@@ -0,0 +1,137 @@
+/* atomic.c - __atomic_* libcalls for operations CAS/LLI/SCI cannot do
+ *
+ * Clang inlines 8-, 16- and 32-bit atomics. Anything wider (std::atomic of
+ * a 64-bit integer or a struct), and every size when built without the
+ * atomics feature, becomes a call to these. There is a single core, so
+ * masking interrupts around a plain access is enough to make it atomic.
+ * PHP/SEI ... PLP keeps the caller's interrupt mask, so the helpers are safe
+ * in handlers and with interrupts already off.
+ *
+ * The generic entry points have the same names as clang's builtins, so
+ * they are defined under other names and renamed, as in compiler-rt.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define LOCK()   __asm__ volatile("php\n\tsei" ::: "memory")
+#define UNLOCK() __asm__ volatile("plp" ::: "memory")
+
+#pragma redefine_extname __atomic_load_c __atomic_load
+#pragma redefine_extname __atomic_store_c __atomic_store
+#pragma redefine_extname __atomic_exchange_c __atomic_exchange
+#pragma redefine_extname __atomic_compare_exchange_c __atomic_compare_exchange
+#pragma redefine_extname __atomic_is_lock_free_c __atomic_is_lock_free
+
+bool __atomic_is_lock_free_c(size_t size, void *ptr) {
+    /* CAS and LLI/SCI work on one aligned 32-bit word */
+    return size <= 4 && ((uintptr_t)ptr & (size - 1)) == 0;
+}
+
+void __atomic_load_c(size_t size, void *src, void *dest, int order) {
+    (void)order;
+    LOCK();
+    memcpy(dest, src, size);
+    UNLOCK();
+}
+
+void __atomic_store_c(size_t size, void *dest, void *src, int order) {
+    (void)order;
+    LOCK();
+    memcpy(dest, src, size);
+    UNLOCK();
+}
+
+void __atomic_exchange_c(size_t size, void *ptr, void *val, void *old,
+                         int order) {
+    (void)order;
+    LOCK();
+    memcpy(old, ptr, size);
+    memcpy(ptr, val, size);
+    UNLOCK();
+}
+
+bool __atomic_compare_exchange_c(size_t size, void *ptr, void *expected,
+                                 void *desired, int success, int failure) {
+    (void)success;
+    (void)failure;
+    bool equal;
+    LOCK();
+    equal = memcmp(ptr, expected, size) == 0;
+    if (equal)
+        memcpy(ptr, desired, size);
+    else
+        memcpy(expected, ptr, size);
+    UNLOCK();
+    return equal;
+}
+
+/* Sized variants: __atomic_load_N, __atomic_fetch_add_N, ... */
+
+#define FETCH_OP(n, T, name, op)                                             \
+    T __atomic_fetch_##name##_##n(volatile void *ptr, T val, int order) {    \
+        volatile T *p = ptr;                                                 \
+        (void)order;                                                         \
+        LOCK();                                                              \
+        T old = *p;                                                          \
+        *p = op;                                                             \
+        UNLOCK();                                                            \
+        return old;                                                          \
+    }
+
+#define SIZED(n, T)                                                          \
+    T __atomic_load_##n(const volatile void *ptr, int order) {               \
+        const volatile T *p = ptr;                                           \
+        (void)order;                                                         \
+        LOCK();                                                              \
+        T val = *p;                                                          \
+        UNLOCK();                                                            \
+        return val;                                                          \
+    }                                                                        \
+    void __atomic_store_##n(volatile void *ptr, T val, int order) {          \
+        volatile T *p = ptr;                                                 \
+        (void)order;                                                         \
+        LOCK();                                                              \
+        *p = val;                                                            \
+        UNLOCK();                                                            \
+    }                                                                        \
+    T __atomic_exchange_##n(volatile void *ptr, T val, int order) {          \
+        volatile T *p = ptr;                                                 \
+        (void)order;                                                         \
+        LOCK();                                                              \
+        T old = *p;                                                          \
+        *p = val;                                                            \
+        UNLOCK();                                                            \
+        return old;                                                          \
+    }                                                                        \
+    bool __atomic_compare_exchange_##n(volatile void *ptr, void *expected,   \
+                                       T desired, bool weak, int success,    \
+                                       int failure) {                        \
+        volatile T *p = ptr;                                                 \
+        T *e = expected;                                                     \
+        (void)weak;                                                          \
+        (void)success;                                                       \
+        (void)failure;                                                       \
+        LOCK();                                                              \
+        T cur = *p;                                                          \
+        bool equal = cur == *e;                                              \
+        if (equal)                                                           \
+            *p = desired;                                                    \
+        UNLOCK();                                                            \
+        if (!equal)                                                          \
+            *e = cur;                                                        \
+        return equal;                                                        \
+    }                                                                        \
+    FETCH_OP(n, T, add, old + val)                                           \
+    FETCH_OP(n, T, sub, old - val)                                           \
+    FETCH_OP(n, T, and, old & val)                                           \
+    FETCH_OP(n, T, or, old | val)                                            \
+    FETCH_OP(n, T, xor, old ^ val)                                           \
+    FETCH_OP(n, T, nand, ~(old & val))
+
+SIZED(1, uint8_t)
+SIZED(2, uint16_t)
+SIZED(4, uint32_t)
+SIZED(8, uint64_t)
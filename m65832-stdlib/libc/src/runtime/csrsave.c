@@ -0,0 +1,65 @@
+/* csrsave.c - Callee-saved register save/restore helpers
+ *
+ * At -Os the compiler saves a run of three or more callee-saved GPRs
+ * (R16.. or R48..) with one JSR to __m65832_save_rN_rM and restores it with
+ * __m65832_restore_rN_rM. The helpers push and pop in the same order as
+ * the inline LDA/PHA and PLA/STA sequences, so the frame layout does not
+ * change. The return address is parked in X while the registers are
+ * moved; only A, X and the flags are clobbered.
+ */
+
+#define PUSH(n) "\tLDA\tR" #n "\n\tPHA\n"
+#define POP(n)  "\tPLA\n\tSTA\tR" #n "\n"
+
+#define HELPER(name, body)                                                   \
+    __asm__("\t.section\t.text." #name ",\"ax\",@progbits\n"                 \
+            "\t.globl\t" #name "\n"                                          \
+            "\t.type\t" #name ",@function\n"                                 \
+            #name ":\n"                                                      \
+            "\tPLX\n" body "\tPHX\n"                                         \
+            "\tRTS\n"                                                        \
+            "\t.size\t" #name ",.-" #name "\n");
+
+#define SAVE3(a, b, c)    PUSH(a) PUSH(b) PUSH(c)
+#define SAVE4(a, b, c, d) SAVE3(a, b, c) PUSH(d)
+#define SAVE5(a, b, c, d, e) SAVE4(a, b, c, d) PUSH(e)
+#define SAVE6(a, b, c, d, e, f) SAVE5(a, b, c, d, e) PUSH(f)
+#define SAVE7(a, b, c, d, e, f, g) SAVE6(a, b, c, d, e, f) PUSH(g)
+#define SAVE8(a, b, c, d, e, f, g, h) SAVE7(a, b, c, d, e, f, g) PUSH(h)
+
+#define RESTORE3(a, b, c)    POP(c) POP(b) POP(a)
+#define RESTORE4(a, b, c, d) POP(d) RESTORE3(a, b, c)
+#define RESTORE5(a, b, c, d, e) POP(e) RESTORE4(a, b, c, d)
+#define RESTORE6(a, b, c, d, e, f) POP(f) RESTORE5(a, b, c, d, e)
+#define RESTORE7(a, b, c, d, e, f, g) POP(g) RESTORE6(a, b, c, d, e, f)
+#define RESTORE8(a, b, c, d, e, f, g, h) POP(h) RESTORE7(a, b, c, d, e, f, g)
+
+/* Primary callee-saved bank R16-R23 */
+HELPER(__m65832_save_r16_r18, SAVE3(16, 17, 18))
+HELPER(__m65832_save_r16_r19, SAVE4(16, 17, 18, 19))
+HELPER(__m65832_save_r16_r20, SAVE5(16, 17, 18, 19, 20))
+HELPER(__m65832_save_r16_r21, SAVE6(16, 17, 18, 19, 20, 21))
+HELPER(__m65832_save_r16_r22, SAVE7(16, 17, 18, 19, 20, 21, 22))
+HELPER(__m65832_save_r16_r23, SAVE8(16, 17, 18, 19, 20, 21, 22, 23))
+
+HELPER(__m65832_restore_r16_r18, RESTORE3(16, 17, 18))
+HELPER(__m65832_restore_r16_r19, RESTORE4(16, 17, 18, 19))
+HELPER(__m65832_restore_r16_r20, RESTORE5(16, 17, 18, 19, 20))
+HELPER(__m65832_restore_r16_r21, RESTORE6(16, 17, 18, 19, 20, 21))
+HELPER(__m65832_restore_r16_r22, RESTORE7(16, 17, 18, 19, 20, 21, 22))
+HELPER(__m65832_restore_r16_r23, RESTORE8(16, 17, 18, 19, 20, 21, 22, 23))
+
+/* Extended callee-saved bank R48-R55 */
+HELPER(__m65832_save_r48_r50, SAVE3(48, 49, 50))
+HELPER(__m65832_save_r48_r51, SAVE4(48, 49, 50, 51))
+HELPER(__m65832_save_r48_r52, SAVE5(48, 49, 50, 51, 52))
+HELPER(__m65832_save_r48_r53, SAVE6(48, 49, 50, 51, 52, 53))
+HELPER(__m65832_save_r48_r54, SAVE7(48, 49, 50, 51, 52, 53, 54))
+HELPER(__m65832_save_r48_r55, SAVE8(48, 49, 50, 51, 52, 53, 54, 55))
+
+HELPER(__m65832_restore_r48_r50, RESTORE3(48, 49, 50))
+HELPER(__m65832_restore_r48_r51, RESTORE4(48, 49, 50, 51))
+HELPER(__m65832_restore_r48_r52, RESTORE5(48, 49, 50, 51, 52))
+HELPER(__m65832_restore_r48_r53, RESTORE6(48, 49, 50, 51, 52, 53))
+HELPER(__m65832_restore_r48_r54, RESTORE7(48, 49, 50, 51, 52, 53, 54))
+HELPER(__m65832_restore_r48_r55, RESTORE8(48, 49, 50, 51, 52, 53, 54, 55))
@@ -0,0 +1,88 @@
+/* sancov.c - SanitizerCoverage runtime hooks
+ *
+ * -fsanitize-coverage=trace-pc-guard gives every edge a 32-bit guard in
+ * __sancov_guards and a module constructor that passes the section bounds
+ * to __sanitizer_cov_trace_pc_guard_init. Guards get their edge number
+ * there, so the per-edge hook is one load, an AND and a counter bump. A
+ * guard of 0 turns its edge off. This file itself must not be built with
+ * -fsanitize-coverage.
+ */
+
+#include <sancov.h>
+
+uint8_t sancov_map[SANCOV_MAP_SIZE];
+
+static uint32_t guard_count;
+static uint8_t *counters_start;
+static uint8_t *counters_end;
+
+void __sanitizer_cov_trace_pc_guard_init(uint32_t *start, uint32_t *stop) {
+    /* Each module's constructor calls this with the same bounds */
+    if (start == stop || *start)
+        return;
+    for (uint32_t *guard = start; guard < stop; guard++)
+        *guard = ++guard_count;
+}
+
+void __sanitizer_cov_trace_pc_guard(uint32_t *guard) {
+    uint32_t edge = *guard;
+    if (!edge)
+        return;
+    uint8_t *count = &sancov_map[edge & (SANCOV_MAP_SIZE - 1)];
+    if (*count != 0xFF)
+        (*count)++;
+}
+
+void __sanitizer_cov_8bit_counters_init(uint8_t *start, uint8_t *end) {
+    counters_start = start;
+    counters_end = end;
+}
+
+uint32_t sancov_edges(void) {
+    return guard_count;
+}
+
+void sancov_reset(void) {
+    __builtin_memset(sancov_map, 0, sizeof(sancov_map));
+    if (counters_start)
+        __builtin_memset(counters_start, 0, counters_end - counters_start);
+}
+
+uint32_t sancov_covered(void) {
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < SANCOV_MAP_SIZE; i++)
+        n += sancov_map[i] != 0;
+    for (uint8_t *p = counters_start; p && p < counters_end; p++)
+        n += *p != 0;
+    return n;
+}
+
+static void put_string(void (*put_char)(int), const char *s) {
+    while (*s)
+        put_char(*s++);
+}
+
+static void put_decimal(void (*put_char)(int), uint32_t v) {
+    char buf[10];
+    int n = 0;
+    do {
+        buf[n++] = '0' + v % 10;
+        v /= 10;
+    } while (v);
+    while (n)
+        put_char(buf[--n]);
+}
+
+void sancov_dump(void (*put_char)(int)) {
+    static const char digits[] = "0123456789abcdef";
+    put_string(put_char, "\n--- sancov begin ");
+    put_decimal(put_char, guard_count);
+    put_string(put_char, " ---\n");
+    for (uint32_t i = 0; i < SANCOV_MAP_SIZE; i++) {
+        put_char(digits[sancov_map[i] >> 4]);
+        put_char(digits[sancov_map[i] & 0xF]);
+        if (i % 32 == 31)
+            put_char('\n');
+    }
+    put_string(put_char, "--- sancov end ---\n");
+}
@@ -0,0 +1,92 @@
+/* context.c - Task context switching
+ *
+ * ctx_switch moves only what a call must preserve and what no bank holds:
+ * the return address (popped, as in setjmp), SP, B, D and F14/F15. Both
+ * contexts are reached B-relative: from through R0, then to through R1,
+ * read before D changes. A context that has not started has ret 0 and
+ * the entry point in its bank's R31, so the first switch to it calls that
+ * instead of returning.
+ */
+
+#include <context.h>
+
+#ifdef __m65832_fpu__
+#define FPR_SAVE    "\tSTF\tF14, B+$0010\n\tSTF\tF15, B+$0018\n"
+#define FPR_RESTORE "\tLDF\tF14, B+$0010\n\tLDF\tF15, B+$0018\n"
+#else
+#define FPR_SAVE    ""
+#define FPR_RESTORE ""
+#endif
+
+/* void ctx_switch(ctx_t *from, const ctx_t *to): from in R0, to in R1 */
+__asm__("\t.section\t.text.ctx_switch,\"ax\",@progbits\n"
+        "\t.globl\tctx_switch\n"
+        "\t.type\tctx_switch,@function\n"
+        "ctx_switch:\n"
+        "\tPHB32\n"
+        "\tLDA\tR0\n"
+        "\tTAB\n"
+        "\tPLA\n"
+        "\tSTA\tB+$0008\n"
+        "\tPLA\n"
+        "\tSTA\tB+$0000\n"
+        "\tTSX\n"
+        "\tTXA\n"
+        "\tSTA\tB+$0004\n"
+        "\tPHD32\n"
+        "\tPLA\n"
+        "\tSTA\tB+$000C\n"
+        FPR_SAVE
+        "\tLDA\tR1\n"
+        "\tTAB\n"
+        "\tLDA\tB+$000C\n"
+        "\tPHA\n"
+        "\tPLD32\n"
+        FPR_RESTORE
+        "\tLDA\tB+$0004\n"
+        "\tTAX\n"
+        "\tTXS\n"
+        "\tLDA\tB+$0000\n"
+        "\tBEQ\t.Lctx_start\n"
+        "\tPHA\n"
+        "\tLDA\tB+$0008\n"
+        "\tTAB\n"
+        "\tRTS\n"
+        ".Lctx_start:\n"
+        "\tLDA\tB+$0008\n"
+        "\tTAB\n"
+        "\tJSR\t(R31)\n"
+        "\tJSR\tctx_exit\n"
+        "\t.size\tctx_switch,.-ctx_switch\n");
+
+static inline uint32_t *current_bank(void) {
+    uint32_t d;
+    __asm__ volatile("PHD32\n\tPLA" : "=a"(d));
+    return (uint32_t *)d;
+}
+
+void ctx_init(ctx_t *ctx, void *stack_top, uint32_t *bank,
+              void (*entry)(void *), void *arg) {
+    const uint32_t *cur = current_bank();
+    for (unsigned r = 24; r < 32; r++) {
+        bank[r] = cur[r];
+    }
+    for (unsigned r = 56; r < CTX_BANK_WORDS; r++) {
+        bank[r] = cur[r];
+    }
+    bank[0] = (uint32_t)arg;
+    bank[31] = (uint32_t)entry;
+
+    ctx->ret = 0;
+    ctx->sp = (uint32_t)stack_top;
+    ctx->b = 0;
+    ctx->d = (uint32_t)bank;
+    ctx->f14[0] = ctx->f14[1] = 0;
+    ctx->f15[0] = ctx->f15[1] = 0;
+}
+
+__attribute__((weak, noreturn)) void ctx_exit(void) {
+    for (;;) {
+        __builtin_m65832_wai();
+    }
+}
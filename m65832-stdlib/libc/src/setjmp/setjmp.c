@@ -0,0 +1,88 @@
+/* setjmp.c - setjmp and longjmp
+ *
+ * Both point B at the jmp_buf and move each word with one LDA/STA at
+ * B+offset. The return address is popped into the buffer, so the saved SP
+ * is the caller's, and longjmp pushes it back before its RTS. longjmp
+ * restores D before the GPRs, since their addresses depend on it, and
+ * keeps val in T meanwhile. B is restored last.
+ *
+ * Layout (byte offsets):
+ *   $00 return address  $04 SP   $08 B    $0C D    $10 R29
+ *   $14 R16-R23         $34 R48-R55       $54 F14  $5C F15
+ */
+
+#define SAVE(n, off)    "\tLDA\tR" #n "\n\tSTA\tB+$" off "\n"
+#define RESTORE(n, off) "\tLDA\tB+$" off "\n\tSTA\tR" #n "\n"
+
+#define GPRS(op)                                                             \
+    op(29, "0010")                                                           \
+    op(16, "0014") op(17, "0018") op(18, "001C") op(19, "0020")              \
+    op(20, "0024") op(21, "0028") op(22, "002C") op(23, "0030")              \
+    op(48, "0034") op(49, "0038") op(50, "003C") op(51, "0040")              \
+    op(52, "0044") op(53, "0048") op(54, "004C") op(55, "0050")
+
+#ifdef __m65832_fpu__
+#define FPR_SAVE    "\tSTF\tF14, B+$0054\n\tSTF\tF15, B+$005C\n"
+#define FPR_RESTORE "\tLDF\tF14, B+$0054\n\tLDF\tF15, B+$005C\n"
+#else
+#define FPR_SAVE    ""
+#define FPR_RESTORE ""
+#endif
+
+#define FUNCTION(name, body)                                                 \
+    __asm__("\t.section\t.text." #name ",\"ax\",@progbits\n"                 \
+            "\t.globl\t" #name "\n"                                          \
+            "\t.type\t" #name ",@function\n"                                 \
+            #name ":\n"                                                      \
+            body                                                             \
+            "\t.size\t" #name ",.-" #name "\n");
+
+/* int setjmp(jmp_buf env): env in R0 */
+FUNCTION(setjmp,
+    "\tPHB32\n"
+    "\tLDA\tR0\n"
+    "\tTAB\n"
+    "\tPLA\n"
+    "\tSTA\tB+$0008\n"
+    "\tPLA\n"
+    "\tSTA\tB+$0000\n"
+    "\tTSX\n"
+    "\tTXA\n"
+    "\tSTA\tB+$0004\n"
+    "\tLDA\tB+$0000\n"
+    "\tPHA\n"
+    "\tPHD32\n"
+    "\tPLA\n"
+    "\tSTA\tB+$000C\n"
+    GPRS(SAVE)
+    FPR_SAVE
+    "\tLDA\tB+$0008\n"
+    "\tTAB\n"
+    "\tLDA\t#0\n"
+    "\tSTA\tR0\n"
+    "\tRTS\n")
+
+/* void longjmp(jmp_buf env, int val): env in R0, val in R1 */
+FUNCTION(longjmp,
+    "\tLDA\tR0\n"
+    "\tTAB\n"
+    "\tLDA\tR1\n"
+    "\tBNE\t.Llongjmp_val\n"
+    "\tLDA\t#1\n"
+    ".Llongjmp_val:\n"
+    "\ttat\n"
+    "\tLDA\tB+$000C\n"
+    "\tPHA\n"
+    "\tPLD32\n"
+    GPRS(RESTORE)
+    FPR_RESTORE
+    "\tLDA\tB+$0004\n"
+    "\tTAX\n"
+    "\tTXS\n"
+    "\tLDA\tB+$0000\n"
+    "\tPHA\n"
+    "\ttta\n"
+    "\tSTA\tR0\n"
+    "\tLDA\tB+$0008\n"
+    "\tTAB\n"
+    "\tRTS\n")
@@ -0,0 +1,71 @@
+/* addsf3.c - Single-precision add/subtract */
+#include "softfp.h"
+
+float __addsf3(float a, float b) {
+    uint32_t a_rep = sf_bits(a);
+    uint32_t b_rep = sf_bits(b);
+    uint32_t a_abs = a_rep & ~SF_SIGN;
+    uint32_t b_abs = b_rep & ~SF_SIGN;
+
+    /* Zero, Inf or NaN on either side */
+    if (a_abs - 1u >= SF_INF - 1u || b_abs - 1u >= SF_INF - 1u) {
+        if (a_abs > SF_INF)
+            return sf_float(a_rep | SF_QUIET);
+        if (b_abs > SF_INF)
+            return sf_float(b_rep | SF_QUIET);
+        if (a_abs == SF_INF)
+            return (a_rep ^ b_rep) == SF_SIGN ? sf_float(SF_QNAN) : a;
+        if (b_abs == SF_INF)
+            return b;
+        if (a_abs == 0)
+            return b_abs == 0 ? sf_float(a_rep & b_rep) : b;
+        if (b_abs == 0)
+            return a;
+    }
+
+    /* Keep the larger magnitude in a */
+    if (b_abs > a_abs) {
+        uint32_t t = a_rep;
+        a_rep = b_rep;
+        b_rep = t;
+    }
+
+    int a_exp = (a_rep >> 23) & 0xFF;
+    int b_exp = (b_rep >> 23) & 0xFF;
+    uint32_t a_sig = a_rep & SF_FRAC;
+    uint32_t b_sig = b_rep & SF_FRAC;
+    if (a_exp == 0)
+        a_exp = sf_normalize(&a_sig);
+    if (b_exp == 0)
+        b_exp = sf_normalize(&b_sig);
+
+    uint32_t sign = a_rep & SF_SIGN;
+    int subtract = ((a_rep ^ b_rep) & SF_SIGN) != 0;
+
+    /* Three extra low bits for guard/round/sticky */
+    a_sig = (a_sig | SF_IMPLICIT) << 3;
+    b_sig = sf_shift_sticky((b_sig | SF_IMPLICIT) << 3, a_exp - b_exp);
+
+    if (subtract) {
+        a_sig -= b_sig;
+        if (a_sig == 0)
+            return sf_float(0);
+        if (a_sig < SF_IMPLICIT << 3) {
+            int shift = __builtin_clz(a_sig) - __builtin_clz(SF_IMPLICIT << 3);
+            a_sig <<= shift;
+            a_exp -= shift;
+        }
+    } else {
+        a_sig += b_sig;
+        if (a_sig & (SF_IMPLICIT << 4)) {
+            a_sig = sf_shift_sticky(a_sig, 1);
+            a_exp++;
+        }
+    }
+
+    return sf_round_pack(sign, a_exp, a_sig);
+}
+
+float __subsf3(float a, float b) {
+    return __addsf3(a, sf_float(sf_bits(b) ^ SF_SIGN));
+}
@@ -0,0 +1,32 @@
+/* cmpsf2.c - Single-precision comparisons (libgcc return conventions) */
+#include "softfp.h"
+
+/* -1 less, 0 equal, 1 greater, `unordered` when either side is NaN */
+static int sf_compare(float a, float b, int unordered) {
+    int32_t a_int = (int32_t)sf_bits(a);
+    int32_t b_int = (int32_t)sf_bits(b);
+    uint32_t a_abs = (uint32_t)a_int & ~SF_SIGN;
+    uint32_t b_abs = (uint32_t)b_int & ~SF_SIGN;
+
+    if (a_abs > SF_INF || b_abs > SF_INF)
+        return unordered;
+    if ((a_abs | b_abs) == 0)
+        return 0;  /* +0 == -0 */
+
+    /* Sign-magnitude order flips when both are negative */
+    if ((a_int & b_int) >= 0)
+        return a_int < b_int ? -1 : a_int != b_int;
+    return a_int > b_int ? -1 : a_int != b_int;
+}
+
+int __eqsf2(float a, float b) { return sf_compare(a, b, 1); }
+int __nesf2(float a, float b) { return sf_compare(a, b, 1); }
+int __ltsf2(float a, float b) { return sf_compare(a, b, 1); }
+int __lesf2(float a, float b) { return sf_compare(a, b, 1); }
+int __gtsf2(float a, float b) { return sf_compare(a, b, -1); }
+int __gesf2(float a, float b) { return sf_compare(a, b, -1); }
+
+int __unordsf2(float a, float b) {
+    return (sf_bits(a) & ~SF_SIGN) > SF_INF ||
+           (sf_bits(b) & ~SF_SIGN) > SF_INF;
+}
@@ -0,0 +1,52 @@
+/* convsf.c - Single-precision <-> 32-bit integer conversions */
+#include "softfp.h"
+
+float __floatunsisf(uint32_t u) {
+    if (u == 0)
+        return sf_float(0);
+
+    /* Line the leading one up with bit 26 for sf_round_pack */
+    int lz = __builtin_clz(u);
+    int exp = SF_BIAS + 31 - lz;
+    uint32_t sig = lz >= 5 ? u << (lz - 5) : sf_shift_sticky(u, 5 - lz);
+    return sf_round_pack(0, exp, sig);
+}
+
+float __floatsisf(int32_t i) {
+    if (i >= 0)
+        return __floatunsisf((uint32_t)i);
+    return sf_float(sf_bits(__floatunsisf(-(uint32_t)i)) | SF_SIGN);
+}
+
+/* Truncating conversions; out-of-range inputs saturate, NaN gives 0 */
+uint32_t __fixunssfsi(float a) {
+    uint32_t rep = sf_bits(a);
+    int exp = (int)((rep >> 23) & 0xFF) - SF_BIAS;
+
+    if ((rep & ~SF_SIGN) > SF_INF)
+        return 0;
+    if ((rep & SF_SIGN) || exp < 0)
+        return 0;
+    if (exp >= 32)
+        return 0xFFFFFFFFu;
+
+    uint32_t sig = (rep & SF_FRAC) | SF_IMPLICIT;
+    return exp < 23 ? sig >> (23 - exp) : sig << (exp - 23);
+}
+
+int32_t __fixsfsi(float a) {
+    uint32_t rep = sf_bits(a);
+    int exp = (int)((rep >> 23) & 0xFF) - SF_BIAS;
+    int negative = (rep & SF_SIGN) != 0;
+
+    if ((rep & ~SF_SIGN) > SF_INF)
+        return 0;
+    if (exp < 0)
+        return 0;
+    if (exp >= 31)
+        return negative ? INT32_MIN : INT32_MAX;
+
+    uint32_t sig = (rep & SF_FRAC) | SF_IMPLICIT;
+    uint32_t mag = exp < 23 ? sig >> (23 - exp) : sig << (exp - 23);
+    return negative ? -(int32_t)mag : (int32_t)mag;
+}
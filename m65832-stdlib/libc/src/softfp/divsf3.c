@@ -0,0 +1,61 @@
+/* divsf3.c - Single-precision divide */
+#include "softfp.h"
+
+float __divsf3(float a, float b) {
+    uint32_t a_rep = sf_bits(a);
+    uint32_t b_rep = sf_bits(b);
+    unsigned a_exp = (a_rep >> 23) & 0xFF;
+    unsigned b_exp = (b_rep >> 23) & 0xFF;
+    uint32_t sign = (a_rep ^ b_rep) & SF_SIGN;
+    uint32_t a_sig = a_rep & SF_FRAC;
+    uint32_t b_sig = b_rep & SF_FRAC;
+    int scale = 0;
+
+    /* Zero, denormal, Inf or NaN on either side */
+    if (a_exp - 1u >= 0xFEu || b_exp - 1u >= 0xFEu) {
+        uint32_t a_abs = a_rep & ~SF_SIGN;
+        uint32_t b_abs = b_rep & ~SF_SIGN;
+        if (a_abs > SF_INF)
+            return sf_float(a_rep | SF_QUIET);
+        if (b_abs > SF_INF)
+            return sf_float(b_rep | SF_QUIET);
+        if (a_abs == SF_INF)
+            return b_abs == SF_INF ? sf_float(SF_QNAN) : sf_float(sign | SF_INF);
+        if (b_abs == SF_INF)
+            return sf_float(sign);
+        if (a_abs == 0)
+            return b_abs == 0 ? sf_float(SF_QNAN) : sf_float(sign);
+        if (b_abs == 0)
+            return sf_float(sign | SF_INF);
+        if (a_exp == 0)
+            scale += sf_normalize(&a_sig);
+        if (b_exp == 0)
+            scale -= sf_normalize(&b_sig);
+    }
+
+    a_sig |= SF_IMPLICIT;
+    b_sig |= SF_IMPLICIT;
+    int exp = (int)a_exp - (int)b_exp + SF_BIAS + scale;
+
+    /* Bring the significand ratio into [1, 2) */
+    if (a_sig < b_sig) {
+        a_sig <<= 1;
+        exp--;
+    }
+
+    /* Restoring division: 27 quotient bits (implicit bit at 26), then the
+     * remainder becomes the sticky bit */
+    uint32_t q = 0;
+    uint32_t r = a_sig;
+    for (int i = 0; i < 27; i++) {
+        q <<= 1;
+        if (r >= b_sig) {
+            r -= b_sig;
+            q |= 1;
+        }
+        r <<= 1;
+    }
+    q |= r != 0;
+
+    return sf_round_pack(sign, exp, q);
+}
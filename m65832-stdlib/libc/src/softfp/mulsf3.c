@@ -0,0 +1,49 @@
+/* mulsf3.c - Single-precision multiply */
+#include "softfp.h"
+
+float __mulsf3(float a, float b) {
+    uint32_t a_rep = sf_bits(a);
+    uint32_t b_rep = sf_bits(b);
+    unsigned a_exp = (a_rep >> 23) & 0xFF;
+    unsigned b_exp = (b_rep >> 23) & 0xFF;
+    uint32_t sign = (a_rep ^ b_rep) & SF_SIGN;
+    uint32_t a_sig = a_rep & SF_FRAC;
+    uint32_t b_sig = b_rep & SF_FRAC;
+    int scale = 0;
+
+    /* Zero, denormal, Inf or NaN on either side */
+    if (a_exp - 1u >= 0xFEu || b_exp - 1u >= 0xFEu) {
+        uint32_t a_abs = a_rep & ~SF_SIGN;
+        uint32_t b_abs = b_rep & ~SF_SIGN;
+        if (a_abs > SF_INF)
+            return sf_float(a_rep | SF_QUIET);
+        if (b_abs > SF_INF)
+            return sf_float(b_rep | SF_QUIET);
+        if (a_abs == SF_INF)
+            return b_abs ? sf_float(sign | SF_INF) : sf_float(SF_QNAN);
+        if (b_abs == SF_INF)
+            return a_abs ? sf_float(sign | SF_INF) : sf_float(SF_QNAN);
+        if (a_abs == 0 || b_abs == 0)
+            return sf_float(sign);
+        if (a_exp == 0)
+            scale += sf_normalize(&a_sig);
+        if (b_exp == 0)
+            scale += sf_normalize(&b_sig);
+    }
+
+    a_sig |= SF_IMPLICIT;
+    b_sig |= SF_IMPLICIT;
+
+    /* 24x24 -> 48-bit product in [2^46, 2^48); keep 27 bits + sticky */
+    uint64_t p = (uint64_t)a_sig * b_sig;
+    int exp = (int)a_exp + (int)b_exp - SF_BIAS + scale;
+    unsigned drop = 20;
+    if (p >> 47) {
+        drop = 21;
+        exp++;
+    }
+    uint32_t sig = (uint32_t)(p >> drop) |
+                   (((uint32_t)p & ((1u << drop) - 1)) != 0);
+
+    return sf_round_pack(sign, exp, sig);
+}
@@ -0,0 +1,67 @@
+/* softfp.h - Shared helpers for the single-precision soft-float routines
+ *
+ * Used on FPU-less M65832 parts, where the backend lowers every f32
+ * operation to a libcall with operands in R0/R1 and the result in R0.
+ * Everything here is 32-bit integer work: the extended ALU handles the
+ * shifts and masks, and normalization uses CLZ via __builtin_clz.
+ */
+#ifndef M65832_SOFTFP_H
+#define M65832_SOFTFP_H
+
+#include <stdint.h>
+
+#define SF_SIGN     0x80000000u
+#define SF_INF      0x7F800000u
+#define SF_FRAC     0x007FFFFFu
+#define SF_IMPLICIT 0x00800000u
+#define SF_QUIET    0x00400000u
+#define SF_QNAN     0x7FC00000u
+#define SF_BIAS     127
+
+static inline uint32_t sf_bits(float f) {
+    union { float f; uint32_t u; } b;
+    b.f = f;
+    return b.u;
+}
+
+static inline float sf_float(uint32_t u) {
+    union { float f; uint32_t u; } b;
+    b.u = u;
+    return b.f;
+}
+
+/* Shift a denormal significand up to the implicit bit; returns the
+ * matching exponent. */
+static inline int sf_normalize(uint32_t *sig) {
+    int shift = __builtin_clz(*sig) - __builtin_clz(SF_IMPLICIT);
+    *sig <<= shift;
+    return 1 - shift;
+}
+
+/* Right shift that ORs every bit shifted out into bit 0 */
+static inline uint32_t sf_shift_sticky(uint32_t v, unsigned shift) {
+    if (shift == 0)
+        return v;
+    if (shift >= 32)
+        return v != 0;
+    return (v >> shift) | ((v << (32 - shift)) != 0);
+}
+
+/* Round to nearest even and pack. sig carries the implicit bit at bit 26
+ * and guard/round/sticky in bits 2..0; exp is biased. */
+static inline float sf_round_pack(uint32_t sign, int exp, uint32_t sig) {
+    if (exp >= 0xFF)
+        return sf_float(sign | SF_INF);
+    if (exp <= 0) {
+        sig = sf_shift_sticky(sig, 1 - exp);
+        exp = 0;
+    }
+
+    uint32_t grs = sig & 7;
+    uint32_t r = sign | ((uint32_t)exp << 23) | ((sig >> 3) & SF_FRAC);
+    if (grs > 4 || (grs == 4 && (r & 1)))
+        r++;  /* a carry out of the fraction bumps the exponent */
+    return sf_float(r);
+}
+
+#endif /* M65832_SOFTFP_H */
@@ -3,25 +3,145 @@
 #include <stdarg.h>
 #include <string.h>
 #include <ctype.h>
+#include <stdint.h>
 
 /* Platform hooks - provided by emulator platform layer */
 extern void uart_putc(int c);
 extern int uart_getc(void);
+extern size_t uart_write(const char *buf, size_t len);
+
+/* Optional platform hook that enables or disables the UART's TX-ready
+ * interrupt. A platform that provides it calls __stdout_tx_irq from that
+ * interrupt, and stdout then drains in the background. Without it, stdout
+ * is line buffered and written with uart_write. */
+extern void uart_tx_irq(int enable) __attribute__((weak));
+
+/* stdout ring buffer; must be a power of two */
+#ifndef STDOUT_BUF_SIZE
+#define STDOUT_BUF_SIZE 256
+#endif
+
+struct __FILE {
+    char unused;
+};
+
+static FILE stdout_file;
+FILE *const stdout = &stdout_file;
+
+/* Free-running indices: putchar only advances out_head, the consumer
+ * (uart_write or the TX interrupt) only advances out_tail */
+static char out_buf[STDOUT_BUF_SIZE];
+static volatile unsigned out_head;
+static volatile unsigned out_tail;
+
+#define OUT_MASK (STDOUT_BUF_SIZE - 1)
+
+/* Write everything buffered, in at most two contiguous runs */
+static void out_drain(void) {
+    unsigned tail = out_tail;
+    while (tail != out_head) {
+        unsigned idx = tail & OUT_MASK;
+        unsigned len = out_head - tail;
+        if (len > STDOUT_BUF_SIZE - idx) {
+            len = STDOUT_BUF_SIZE - idx;
+        }
+        tail += uart_write(out_buf + idx, len);
+        out_tail = tail;
+    }
+}
+
+/* Wait for the TX interrupt to make room (or empty the buffer) */
+static void out_wait(unsigned used) {
+    uart_tx_irq(1);
+    while (out_head - out_tail > used)
+        ;
+}
+
+void __stdout_tx_irq(void) {
+    unsigned tail = out_tail;
+    if (tail == out_head) {
+        uart_tx_irq(0);
+        return;
+    }
+    uart_putc(out_buf[tail & OUT_MASK]);
+    out_tail = tail + 1;
+}
+
+/* Queue len bytes for stdout, a contiguous run at a time */
+static void out_write(const char *s, size_t len) {
+    while (len) {
+        unsigned used = out_head - out_tail;
+        if (used == STDOUT_BUF_SIZE) {
+            if (uart_tx_irq) {
+                out_wait(STDOUT_BUF_SIZE - 1);
+            } else {
+                out_drain();
+            }
+            continue;
+        }
+
+        unsigned idx = out_head & OUT_MASK;
+        size_t n = STDOUT_BUF_SIZE - used;
+        if (n > STDOUT_BUF_SIZE - idx) {
+            n = STDOUT_BUF_SIZE - idx;
+        }
+        if (n > len) {
+            n = len;
+        }
+        memcpy(out_buf + idx, s, n);
+        /* The bytes must be in the ring before the interrupt can see them */
+        __asm__ volatile("" ::: "memory");
+        out_head += n;
+
+        if (uart_tx_irq) {
+            /* Nothing older left means the interrupt found the buffer
+             * empty and turned itself off, or was never on */
+            if (out_head - out_tail <= n) {
+                uart_tx_irq(1);
+            }
+        } else if (memchr(s, '\n', n)) {
+            out_drain();
+        }
+        s += n;
+        len -= n;
+    }
+}
 
 int putchar(int c) {
-    uart_putc(c);
-    return c;
+    char ch = c;
+    out_write(&ch, 1);
+    return (unsigned char)c;
 }
 
-int puts(const char *s) {
-    while (*s) {
-        putchar(*s++);
+/* In interrupt mode this waits for the interrupt, so it must not be
+ * called with interrupts masked */
+int fflush(FILE *stream) {
+    (void)stream;   /* stdout is the only buffered stream */
+    if (uart_tx_irq) {
+        if (out_head != out_tail) {
+            out_wait(0);
+        }
+    } else {
+        out_drain();
     }
-    putchar('\n');
+    return 0;
+}
+
+/* Flush what main left behind when crt0 runs the destructors */
+__attribute__((destructor))
+static void stdout_exit(void) {
+    fflush(stdout);
+}
+
+int puts(const char *s) {
+    out_write(s, strlen(s));
+    out_write("\n", 1);
     return 0;
 }
 
 int getchar(void) {
+    /* Show any prompt before blocking for input */
+    fflush(stdout);
     return uart_getc();
 }
 
@@ -37,93 +157,357 @@ char *gets(char *s) {
 
 /*
  * Minimal printf implementation
- * Supports: %d, %i, %u, %x, %X, %c, %s, %p, %%
- * Supports: width, left-justify (-), zero-pad (0)
- * Does NOT support: precision, floating point, long long
+ * Supports: %d, %i, %u, %x, %X, %o, %c, %s, %p, %%
+ * Supports: width, left-justify (-), zero-pad (0), l and ll lengths,
+ * precision for %s
+ * With PRINTF_FLOAT: %f, %F, %e, %E, %g, %G and their precision
+ *
+ * Numbers are formatted right to left into a small buffer and then written
+ * out in one piece. Decimal emits two digits per divide by 100 (which the
+ * compiler turns into a multiply by the reciprocal), hex and octal are
+ * shift and mask, and 64-bit decimal peels off four digits at a time using
+ * only 32-bit divides, so %ll never reaches __udivdi3.
  */
 
-static void print_char(char **buf, size_t *remaining, int c) {
-    if (buf) {
-        if (*remaining > 1) {
-            **buf = c;
-            (*buf)++;
-            (*remaining)--;
+/* Where formatted output goes */
+typedef struct {
+    char *buf;          /* NULL to only count (or for stdout) */
+    size_t remaining;   /* room left in buf, including the terminator */
+    int count;          /* characters produced, stored or not */
+    int to_stdout;
+} sink_t;
+
+static const char digit_pairs[201] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static const char lower_digits[] = "0123456789abcdef";
+static const char upper_digits[] = "0123456789ABCDEF";
+
+static void print_chars(sink_t *out, const char *s, size_t len) {
+    out->count += len;
+    if (out->to_stdout) {
+        out_write(s, len);
+    } else if (out->buf) {
+        if (out->remaining > 1) {
+            size_t n = len < out->remaining - 1 ? len : out->remaining - 1;
+            memcpy(out->buf, s, n);
+            out->buf += n;
+            out->remaining -= n;
         }
-    } else {
-        putchar(c);
     }
 }
 
-static void print_string(char **buf, size_t *remaining, const char *s, int width, int left) {
-    int len = strlen(s);
-    int pad = (width > len) ? (width - len) : 0;
-    
+static void print_pad(sink_t *out, char c, int len) {
+    static const char spaces[] = "                ";
+    static const char zeros[] = "0000000000000000";
+    const char *run = c == '0' ? zeros : spaces;
+    while (len > 0) {
+        int n = len < 16 ? len : 16;
+        print_chars(out, run, n);
+        len -= n;
+    }
+}
+
+static void print_string(sink_t *out, const char *s, int prec, int width,
+                         int left) {
+    int len;
+    if (prec < 0) {
+        len = strlen(s);
+    } else {
+        const char *end = memchr(s, '\0', prec);
+        len = end ? end - s : prec;
+    }
+    int pad = width - len;
+
     if (!left) {
-        while (pad-- > 0) print_char(buf, remaining, ' ');
+        print_pad(out, ' ', pad);
+    }
+    print_chars(out, s, len);
+    if (left) {
+        print_pad(out, ' ', pad);
+    }
+}
+
+/* The fmt_* helpers write digits backwards ending at p and return the
+ * first digit */
+static char *fmt_dec32(char *p, uint32_t val) {
+    while (val >= 100) {
+        uint32_t q = val / 100;
+        const char *d = &digit_pairs[(val - q * 100) * 2];
+        *--p = d[1];
+        *--p = d[0];
+        val = q;
+    }
+    if (val >= 10) {
+        const char *d = &digit_pairs[val * 2];
+        *--p = d[1];
+        *--p = d[0];
+    } else {
+        *--p = '0' + val;
+    }
+    return p;
+}
+
+static char *fmt_dec64(char *p, uint64_t val) {
+    /* Long division by 10000 over 16-bit limbs: each step divides
+     * (rem << 16 | limb) < 10000 << 16, which fits in 32 bits */
+    while (val >> 32) {
+        uint32_t hi = (uint32_t)(val >> 32);
+        uint32_t lo = (uint32_t)val;
+        uint32_t t, q3, q2, q1, q0;
+
+        t = hi >> 16;
+        q3 = t / 10000;
+        t = ((t - q3 * 10000) << 16) | (hi & 0xFFFF);
+        q2 = t / 10000;
+        t = ((t - q2 * 10000) << 16) | (lo >> 16);
+        q1 = t / 10000;
+        t = ((t - q1 * 10000) << 16) | (lo & 0xFFFF);
+        q0 = t / 10000;
+        t -= q0 * 10000;
+
+        uint32_t t_hi = t / 100;
+        const char *d = &digit_pairs[(t - t_hi * 100) * 2];
+        *--p = d[1];
+        *--p = d[0];
+        d = &digit_pairs[t_hi * 2];
+        *--p = d[1];
+        *--p = d[0];
+
+        val = ((uint64_t)((q3 << 16) | q2) << 32) | ((q1 << 16) | q0);
+    }
+    return fmt_dec32(p, (uint32_t)val);
+}
+
+static char *fmt_pow2(char *p, uint64_t val, int shift, const char *digits) {
+    unsigned mask = (1u << shift) - 1;
+    uint32_t lo = (uint32_t)val;
+
+    if (val >> 32) {
+        do {
+            *--p = digits[(uint32_t)val & mask];
+            val >>= shift;
+        } while (val >> 32);
+        lo = (uint32_t)val;
+        if (!lo) {
+            return p;
+        }
+    }
+    do {
+        *--p = digits[lo & mask];
+        lo >>= shift;
+    } while (lo);
+    return p;
+}
+
+static void print_num(sink_t *out, uint64_t val, int base, int neg,
+                      int width, int zero_pad, int left, int upper) {
+    char tmp[24];  /* Enough for 64-bit octal */
+    char *end = tmp + sizeof(tmp);
+    char *p;
+
+    if (base == 10) {
+        p = (val >> 32) ? fmt_dec64(end, val) : fmt_dec32(end, (uint32_t)val);
+    } else {
+        p = fmt_pow2(end, val, base == 16 ? 4 : 3,
+                     upper ? upper_digits : lower_digits);
     }
-    while (*s) {
-        print_char(buf, remaining, *s++);
+
+    int len = end - p;
+    int pad = width - len - neg;
+
+    if (!left && !zero_pad) {
+        print_pad(out, ' ', pad);
+    }
+    /* With zero-padding the sign goes in front of the zeros */
+    if (neg) {
+        print_chars(out, "-", 1);
     }
+    if (!left && zero_pad) {
+        print_pad(out, '0', pad);
+    }
+    print_chars(out, p, len);
     if (left) {
-        while (pad-- > 0) print_char(buf, remaining, ' ');
+        print_pad(out, ' ', pad);
     }
 }
 
-static void print_num(char **buf, size_t *remaining, unsigned long val, int base, 
-                      int is_signed, int width, int zero_pad, int left, int upper) {
-    char tmp[12];  /* Enough for 32-bit in any base */
-    char *p = tmp + sizeof(tmp) - 1;
-    int neg = 0;
-    const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
-    
-    *p = '\0';
-    
-    if (is_signed && (long)val < 0) {
-        neg = 1;
-        val = -(long)val;
-    }
-    
-    if (val == 0) {
-        *--p = '0';
+#ifdef PRINTF_FLOAT
+/*
+ * Floating point goes through libm's __fp_digits (fpconv.c), which uses
+ * the FPU; programs that print floats link -lm. These helpers only round
+ * and lay out its 18 digits, so printf itself stays integer code.
+ */
+extern int __fp_digits(const double *v, char digits[18]);
+
+/* Round the digits to n significant ones, an exact half to even; a carry
+ * out of the first raises the exponent. n <= 0 rounds at or above the
+ * first digit. */
+static void round_digits(char *d, int *exp, int n) {
+    if (n >= 18) {
+        return;
+    }
+    int up = n >= 0 && d[n] >= '5';
+    if (up && d[n] == '5') {
+        int tie = 1;
+        for (int j = n + 1; j < 18; j++) {
+            tie &= d[j] == '0';
+        }
+        if (tie && (n == 0 || !((d[n - 1] - '0') & 1))) {
+            up = 0;
+        }
+    }
+    int i = n < 0 ? 0 : n;
+    for (int j = i; j < 18; j++) {
+        d[j] = '0';
+    }
+    while (up && i > 0) {
+        if (d[--i] < '9') {
+            d[i]++;
+            up = 0;
+        } else {
+            d[i] = '0';
+        }
+    }
+    if (up) {
+        d[0] = '1';
+        (*exp)++;
+    }
+}
+
+/* prec places after the point: lead zeros, the digits from d[start] on,
+ * then zeros past the 18th */
+static void print_frac(sink_t *out, const char *d, int start, int lead,
+                       int prec) {
+    if (!prec) {
+        return;
+    }
+    print_chars(out, ".", 1);
+    if (lead > prec) {
+        lead = prec;
+    }
+    print_pad(out, '0', lead);
+    prec -= lead;
+    int n = start < 18 ? 18 - start : 0;
+    if (n > prec) {
+        n = prec;
+    }
+    print_chars(out, d + start, n);
+    print_pad(out, '0', prec - n);
+}
+
+static void print_float(sink_t *out, double v, char conv, int prec,
+                        int width, int zero_pad, int left) {
+    union { double d; uint32_t u[2]; } bits = { v };
+    int neg = bits.u[1] >> 31;
+    int upper = conv < 'a';
+    uint32_t hi = bits.u[1] & 0x7FFFFFFF;
+
+    if (hi >= 0x7FF00000) {
+        const char *s = (hi > 0x7FF00000 || bits.u[0])
+                            ? (upper ? "NAN" : "nan")
+                            : (upper ? "INF" : "inf");
+        int pad = width - 3 - neg;
+        if (!left) {
+            print_pad(out, ' ', pad);
+        }
+        if (neg) {
+            print_chars(out, "-", 1);
+        }
+        print_chars(out, s, 3);
+        if (left) {
+            print_pad(out, ' ', pad);
+        }
+        return;
+    }
+
+    if (prec < 0) {
+        prec = 6;
+    }
+    char d[18];
+    int x = __fp_digits(&v, d);
+    char style = conv | 0x20;
+
+    if (style == 'g') {
+        /* P significant digits, in %e form only for exponents below -4
+         * or at least P, then without the trailing zeros */
+        int p = prec ? prec : 1;
+        round_digits(d, &x, p);
+        int sig = p < 18 ? p : 18;
+        while (sig > 1 && d[sig - 1] == '0') {
+            sig--;
+        }
+        if (x < -4 || x >= p) {
+            style = 'e';
+            prec = sig - 1;
+        } else {
+            style = 'f';
+            prec = sig - 1 - x > 0 ? sig - 1 - x : 0;
+        }
     } else {
-        while (val) {
-            *--p = digits[val % base];
-            val /= base;
-        }
-    }
-    
-    if (neg) *--p = '-';
-    
-    int len = (tmp + sizeof(tmp) - 1) - p;
-    int pad = (width > len) ? (width - len) : 0;
-    char pad_char = zero_pad ? '0' : ' ';
-    
-    if (!left) {
-        /* If zero-padding with negative, put sign first */
-        if (zero_pad && neg) {
-            print_char(buf, remaining, '-');
-            p++;  /* Skip the sign in the buffer */
-            len--;
+        round_digits(d, &x, style == 'e' ? prec + 1 : x + 1 + prec);
+    }
+
+    char ebuf[8];
+    char *eend = ebuf + sizeof(ebuf);
+    char *ep = eend;
+    int len = prec ? prec + 1 : 0;
+    if (style == 'e') {
+        unsigned ax = x < 0 ? -x : x;
+        ep = fmt_dec32(ep, ax);
+        if (ax < 10) {
+            *--ep = '0';
         }
-        while (pad-- > 0) print_char(buf, remaining, pad_char);
+        *--ep = x < 0 ? '-' : '+';
+        *--ep = upper ? 'E' : 'e';
+        len += 1 + (eend - ep);
+    } else {
+        len += x >= 0 ? x + 1 : 1;
+    }
+
+    int pad = width - len - neg;
+    if (!left && !zero_pad) {
+        print_pad(out, ' ', pad);
     }
-    while (*p) {
-        print_char(buf, remaining, *p++);
+    if (neg) {
+        print_chars(out, "-", 1);
+    }
+    if (!left && zero_pad) {
+        print_pad(out, '0', pad);
+    }
+    if (style == 'e') {
+        print_chars(out, d, 1);
+        print_frac(out, d, 1, 0, prec);
+        print_chars(out, ep, eend - ep);
+    } else {
+        if (x < 0) {
+            print_chars(out, "0", 1);
+        } else {
+            int n = x < 18 ? x + 1 : 18;
+            print_chars(out, d, n);
+            print_pad(out, '0', x + 1 - n);
+        }
+        print_frac(out, d, x >= 0 ? x + 1 : 0, x < -1 ? -x - 1 : 0, prec);
     }
     if (left) {
-        while (pad-- > 0) print_char(buf, remaining, ' ');
+        print_pad(out, ' ', pad);
     }
 }
+#endif
 
-static int do_printf(char *str, size_t size, const char *format, va_list ap) {
-    char **buf = str ? &str : NULL;
-    size_t remaining = str ? size : (size_t)-1;
-    int count = 0;
-    
+static void do_printf(sink_t *out, const char *format, va_list ap) {
     while (*format) {
         if (*format != '%') {
-            print_char(buf, &remaining, *format++);
-            count++;
+            /* Copy the literal run up to the next conversion at once */
+            const char *run = format;
+            while (*format && *format != '%') {
+                format++;
+            }
+            print_chars(out, run, format - run);
             continue;
         }
         
@@ -143,88 +527,128 @@ static int do_printf(char *str, size_t size, const char *format, va_list ap) {
         while (isdigit(*format)) {
             width = width * 10 + (*format++ - '0');
         }
+
+        /* Parse precision; -1 when absent */
+        int prec = -1;
+        if (*format == '.') {
+            format++;
+            prec = 0;
+            while (isdigit(*format)) {
+                prec = prec * 10 + (*format++ - '0');
+            }
+        }
         
-        /* Parse length modifier (ignored for now) */
-        if (*format == 'l') format++;
+        /* Parse length modifier: 1 for l, 2 for ll */
+        int length = 0;
+        while (*format == 'l' && length < 2) {
+            format++;
+            length++;
+        }
         
         /* Parse conversion specifier */
-        switch (*format++) {
+        char conv = *format++;
+        switch (conv) {
         case 'd':
-        case 'i':
-            print_num(buf, &remaining, va_arg(ap, int), 10, 1, width, zero_pad, left, 0);
+        case 'i': {
+            int64_t v = length == 2 ? va_arg(ap, long long)
+                      : length == 1 ? va_arg(ap, long)
+                                    : va_arg(ap, int);
+            uint64_t mag = v < 0 ? -(uint64_t)v : (uint64_t)v;
+            print_num(out, mag, 10, v < 0, width, zero_pad, left, 0);
             break;
+        }
         case 'u':
-            print_num(buf, &remaining, va_arg(ap, unsigned int), 10, 0, width, zero_pad, left, 0);
-            break;
         case 'x':
-            print_num(buf, &remaining, va_arg(ap, unsigned int), 16, 0, width, zero_pad, left, 0);
-            break;
         case 'X':
-            print_num(buf, &remaining, va_arg(ap, unsigned int), 16, 0, width, zero_pad, left, 1);
+        case 'o': {
+            uint64_t v = length == 2 ? va_arg(ap, unsigned long long)
+                       : length == 1 ? va_arg(ap, unsigned long)
+                                     : va_arg(ap, unsigned int);
+            int base = conv == 'u' ? 10 : conv == 'o' ? 8 : 16;
+            print_num(out, v, base, 0, width, zero_pad, left, conv == 'X');
             break;
+        }
         case 'p':
-            print_string(buf, &remaining, "0x", 0, 0);
-            print_num(buf, &remaining, (unsigned long)va_arg(ap, void *), 16, 0, 8, 1, 0, 0);
+            print_chars(out, "0x", 2);
+            print_num(out, (uintptr_t)va_arg(ap, void *), 16, 0, 8, 1, 0, 0);
             break;
-        case 'c':
-            print_char(buf, &remaining, va_arg(ap, int));
+        case 'c': {
+            char c = va_arg(ap, int);
+            print_chars(out, &c, 1);
             break;
+        }
         case 's': {
             const char *s = va_arg(ap, const char *);
-            print_string(buf, &remaining, s ? s : "(null)", width, left);
+            print_string(out, s ? s : "(null)", prec, width, left);
             break;
         }
+#ifdef PRINTF_FLOAT
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+            print_float(out, va_arg(ap, double), conv, prec, width,
+                        zero_pad, left);
+            break;
+#endif
         case '%':
-            print_char(buf, &remaining, '%');
+            print_chars(out, "%", 1);
+            break;
+        case '\0':
+            /* Trailing lone '%' */
+            format--;
+            print_chars(out, "%", 1);
             break;
         default:
             /* Unknown specifier - print literally */
-            print_char(buf, &remaining, '%');
-            print_char(buf, &remaining, format[-1]);
+            print_chars(out, "%", 1);
+            print_chars(out, &conv, 1);
             break;
         }
     }
-    
-    /* Null terminate if writing to buffer */
+}
+
+int vprintf(const char *format, va_list ap) {
+    sink_t out = { NULL, 0, 0, 1 };
+    do_printf(&out, format, ap);
+    return out.count;
+}
+
+int vsnprintf(char *str, size_t size, const char *format, va_list ap) {
+    sink_t out = { str, size, 0, 0 };
+    do_printf(&out, format, ap);
     if (str && size > 0) {
-        *str = '\0';
+        *out.buf = '\0';
     }
-    
-    return count;
+    return out.count;
 }
 
 int printf(const char *format, ...) {
     va_list ap;
     va_start(ap, format);
-    int ret = do_printf(NULL, 0, format, ap);
+    int ret = vprintf(format, ap);
     va_end(ap);
     return ret;
 }
 
-int vprintf(const char *format, va_list ap) {
-    return do_printf(NULL, 0, format, ap);
-}
-
 int sprintf(char *str, const char *format, ...) {
     va_list ap;
     va_start(ap, format);
-    int ret = do_printf(str, (size_t)-1, format, ap);
+    int ret = vsnprintf(str, (size_t)-1, format, ap);
     va_end(ap);
     return ret;
 }
 
 int vsprintf(char *str, const char *format, va_list ap) {
-    return do_printf(str, (size_t)-1, format, ap);
+    return vsnprintf(str, (size_t)-1, format, ap);
 }
 
 int snprintf(char *str, size_t size, const char *format, ...) {
     va_list ap;
     va_start(ap, format);
-    int ret = do_printf(str, size, format, ap);
+    int ret = vsnprintf(str, size, format, ap);
     va_end(ap);
     return ret;
 }
-
-int vsnprintf(char *str, size_t size, const char *format, va_list ap) {
-    return do_printf(str, size, format, ap);
-}
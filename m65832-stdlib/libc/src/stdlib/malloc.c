@@ -0,0 +1,372 @@
+/* malloc.c - TLSF (two-level segregated fit) allocator
+ *
+ * malloc, free and realloc take constant time. Free blocks sit in lists by
+ * size class: a first-level class per power of two, split into SL_COUNT
+ * second-level classes. A bitmap bit per non-empty list makes finding a
+ * large enough block two CTZs. free merges a block with free neighbours
+ * at once, so no two free blocks are ever adjacent. The heap grows through
+ * sys_sbrk when no block fits.
+ *
+ * Block layout (sizes are payload bytes, multiples of 4):
+ *
+ *   prev_phys  last word of the previous block; valid only if PREV_FREE
+ *   size       payload size | BLOCK_FREE | BLOCK_PREV_FREE
+ *   payload    starts with next_free/prev_free while the block is free
+ *
+ * A used block costs one word. Each sbrk region ends in a zero-size used
+ * block (the epilogue) so that merging stops there.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+
+extern void *sys_sbrk(int incr);
+
+/* Define to 1 if sys_sbrk hands out zeroed memory (RAM cleared at reset):
+ * calloc then clears only the allocator's own words in never-used memory */
+#ifndef MALLOC_SBRK_ZEROED
+#define MALLOC_SBRK_ZEROED 0
+#endif
+
+#define SL_LOG2         3
+#define SL_COUNT        (1u << SL_LOG2)
+#define FL_SHIFT        (SL_LOG2 + 2)
+#define SMALL_SIZE      (1u << FL_SHIFT)    /* one class per 4 bytes below */
+#define FL_MAX          32                  /* sizes below 1 << FL_MAX */
+#define FL_COUNT        (FL_MAX - FL_SHIFT + 1)
+
+#define BLOCK_FREE      1u
+#define BLOCK_PREV_FREE 2u
+#define BLOCK_FLAGS     (BLOCK_FREE | BLOCK_PREV_FREE)
+
+/* Heap growth is rounded up to this, so small allocations do not each
+ * cost an sbrk call */
+#define GROW_MIN        1024u
+
+typedef struct block {
+    struct block *prev_phys;
+    size_t size;
+    struct block *next_free;
+    struct block *prev_free;
+} block_t;
+
+#define OVERHEAD        sizeof(size_t)
+#define HEADER          offsetof(block_t, next_free)
+#define BLOCK_MIN       (sizeof(block_t) - sizeof(block_t *))
+#define ALLOC_MAX       ((size_t)1 << (FL_MAX - 2))
+
+static uint32_t fl_bitmap;
+static uint32_t sl_bitmap[FL_COUNT];
+static block_t *free_lists[FL_COUNT][SL_COUNT];
+
+static char *heap_top;      /* end of the last sbrk region */
+static char *heap_clean;    /* no payload has reached this address yet */
+
+static inline size_t block_size(const block_t *b) {
+    return b->size & ~(size_t)BLOCK_FLAGS;
+}
+
+static inline int block_is_free(const block_t *b) {
+    return b->size & BLOCK_FREE;
+}
+
+static inline void *block_to_ptr(block_t *b) {
+    return (char *)b + HEADER;
+}
+
+static inline block_t *ptr_to_block(void *ptr) {
+    return (block_t *)((char *)ptr - HEADER);
+}
+
+/* The next block's prev_phys is the last word of this payload */
+static inline block_t *block_next(block_t *b) {
+    return (block_t *)((char *)b + HEADER + block_size(b) - OVERHEAD);
+}
+
+static inline int fls32(uint32_t x) {
+    return 31 - __builtin_clz(x);
+}
+
+static void mapping_insert(size_t size, int *fl, int *sl) {
+    if (size < SMALL_SIZE) {
+        *fl = 0;
+        *sl = size / (SMALL_SIZE / SL_COUNT);
+    } else {
+        int f = fls32(size);
+        *sl = (size >> (f - SL_LOG2)) ^ SL_COUNT;
+        *fl = f - FL_SHIFT + 1;
+    }
+}
+
+/* Round up to the next class boundary, so every block in the class that
+ * mapping_insert gives for the result is large enough */
+static size_t round_class(size_t size) {
+    if (size >= SMALL_SIZE) {
+        size += ((size_t)1 << (fls32(size) - SL_LOG2)) - 1;
+    }
+    return size;
+}
+
+static block_t *search_suitable(size_t size) {
+    int fl, sl;
+    mapping_insert(round_class(size), &fl, &sl);
+
+    uint32_t sl_map = sl_bitmap[fl] & (~0u << sl);
+    if (!sl_map) {
+        uint32_t fl_map = fl_bitmap & (~0u << (fl + 1));
+        if (!fl_map) {
+            return NULL;
+        }
+        fl = __builtin_ctz(fl_map);
+        sl_map = sl_bitmap[fl];
+    }
+    sl = __builtin_ctz(sl_map);
+    return free_lists[fl][sl];
+}
+
+static void insert_free(block_t *b) {
+    int fl, sl;
+    mapping_insert(block_size(b), &fl, &sl);
+    block_t *head = free_lists[fl][sl];
+    b->next_free = head;
+    b->prev_free = NULL;
+    if (head) {
+        head->prev_free = b;
+    }
+    free_lists[fl][sl] = b;
+    fl_bitmap |= 1u << fl;
+    sl_bitmap[fl] |= 1u << sl;
+}
+
+static void remove_free(block_t *b) {
+    if (b->next_free) {
+        b->next_free->prev_free = b->prev_free;
+    }
+    if (b->prev_free) {
+        b->prev_free->next_free = b->next_free;
+        return;
+    }
+
+    int fl, sl;
+    mapping_insert(block_size(b), &fl, &sl);
+    free_lists[fl][sl] = b->next_free;
+    if (!b->next_free) {
+        sl_bitmap[fl] &= ~(1u << sl);
+        if (!sl_bitmap[fl]) {
+            fl_bitmap &= ~(1u << fl);
+        }
+    }
+}
+
+static void mark_free(block_t *b) {
+    b->size |= BLOCK_FREE;
+    block_t *next = block_next(b);
+    next->prev_phys = b;
+    next->size |= BLOCK_PREV_FREE;
+}
+
+static void mark_used(block_t *b) {
+    b->size &= ~BLOCK_FREE;
+    block_next(b)->size &= ~BLOCK_PREV_FREE;
+}
+
+/* Merge b with the free block before it, if any */
+static block_t *merge_prev(block_t *b) {
+    if (b->size & BLOCK_PREV_FREE) {
+        block_t *prev = b->prev_phys;
+        remove_free(prev);
+        prev->size += block_size(b) + OVERHEAD;
+        b = prev;
+    }
+    return b;
+}
+
+/* Merge b with the free block after it, if any */
+static void merge_next(block_t *b) {
+    block_t *next = block_next(b);
+    if (block_is_free(next)) {
+        remove_free(next);
+        b->size += block_size(next) + OVERHEAD;
+    }
+}
+
+/* Shrink the used block b to size bytes if what is left over is big
+ * enough to be a block, and free the rest */
+static void trim_used(block_t *b, size_t size) {
+    size_t rest = block_size(b) - size;
+    if (rest < sizeof(block_t)) {
+        return;
+    }
+    b->size = size | (b->size & BLOCK_PREV_FREE);
+    block_t *r = block_next(b);
+    r->size = rest - OVERHEAD;
+    merge_next(r);
+    mark_free(r);
+    insert_free(r);
+}
+
+/* Add at least size bytes of free block from sys_sbrk */
+static int grow(size_t size) {
+    size_t incr = size + 2 * OVERHEAD;
+    incr = (incr + GROW_MIN - 1) & ~(size_t)(GROW_MIN - 1);
+    char *mem = sys_sbrk((int)incr);
+    if (mem == (char *)-1) {
+        /* A small heap may still have room for the exact amount */
+        incr = (size + 2 * OVERHEAD + 3) & ~(size_t)3;
+        mem = sys_sbrk((int)incr);
+        if (mem == (char *)-1) {
+            return 0;
+        }
+    }
+
+    block_t *b;
+    if (mem == heap_top) {
+        /* The old epilogue becomes the header of the new block */
+        b = (block_t *)(heap_top - HEADER);
+        b->size = (incr - OVERHEAD) | (b->size & BLOCK_PREV_FREE);
+        if (heap_clean < heap_top) {
+            heap_clean = heap_top;
+        }
+    } else {
+        /* A new region; its first block's prev_phys is never read */
+        b = (block_t *)(mem - OVERHEAD);
+        b->size = incr - 2 * OVERHEAD;
+        if (heap_clean < mem) {
+            heap_clean = mem;
+        }
+    }
+    heap_top = mem + incr;
+    block_next(b)->size = 0;
+
+    b = merge_prev(b);
+    mark_free(b);
+    insert_free(b);
+    return 1;
+}
+
+/* Payload size for a request, or 0 if it cannot be met */
+static size_t adjust_size(size_t size) {
+    if (size == 0 || size > ALLOC_MAX) {
+        return 0;
+    }
+    size = (size + 3) & ~(size_t)3;
+    return size < BLOCK_MIN ? BLOCK_MIN : size;
+}
+
+static block_t *alloc_block(size_t size) {
+    block_t *b = search_suitable(size);
+    if (!b) {
+        if (!grow(round_class(size))) {
+            return NULL;
+        }
+        b = search_suitable(size);
+        if (!b) {
+            return NULL;
+        }
+    }
+    remove_free(b);
+    trim_used(b, size);
+    mark_used(b);
+    return b;
+}
+
+/* Move the never-used watermark past b's payload */
+static void note_used(block_t *b) {
+    char *end = (char *)block_to_ptr(b) + block_size(b);
+    if (end > heap_clean) {
+        heap_clean = end;
+    }
+}
+
+void *malloc(size_t size) {
+    size = adjust_size(size);
+    if (!size) {
+        return NULL;
+    }
+    block_t *b = alloc_block(size);
+    if (!b) {
+        return NULL;
+    }
+    note_used(b);
+    return block_to_ptr(b);
+}
+
+void free(void *ptr) {
+    if (!ptr) {
+        return;
+    }
+    block_t *b = merge_prev(ptr_to_block(ptr));
+    merge_next(b);
+    mark_free(b);
+    insert_free(b);
+}
+
+void *calloc(size_t nmemb, size_t size) {
+    if (size && nmemb > SIZE_MAX / size) {
+        return NULL;
+    }
+    size_t total = nmemb * size;
+    size_t adj = adjust_size(total);
+    if (!adj) {
+        return NULL;
+    }
+    block_t *b = alloc_block(adj);
+    if (!b) {
+        return NULL;
+    }
+
+    void *p = block_to_ptr(b);
+    if (MALLOC_SBRK_ZEROED && (char *)p >= heap_clean) {
+        /* Untouched memory, apart from the free-list links at the start
+         * and the next block's prev_phys in the last word */
+        b->next_free = NULL;
+        b->prev_free = NULL;
+        block_next(b)->prev_phys = NULL;
+    } else {
+        __bzero(p, total);
+    }
+    note_used(b);
+    return p;
+}
+
+void *realloc(void *ptr, size_t size) {
+    if (ptr == NULL) {
+        return malloc(size);
+    }
+    if (size == 0) {
+        free(ptr);
+        return NULL;
+    }
+    size_t adj = adjust_size(size);
+    if (!adj) {
+        return NULL;
+    }
+
+    block_t *b = ptr_to_block(ptr);
+    size_t cur = block_size(b);
+    if (adj > cur) {
+        /* Grow in place into a free neighbour, first extending the heap
+         * if the block is the last one */
+        block_t *next = block_next(b);
+        if (next->size == 0 && (char *)next + HEADER == heap_top) {
+            grow(adj - cur);
+            next = block_next(b);
+        }
+        if (!block_is_free(next) ||
+            cur + OVERHEAD + block_size(next) < adj) {
+            void *p = malloc(size);
+            if (p) {
+                memcpy(p, ptr, cur);
+                free(ptr);
+            }
+            return p;
+        }
+        remove_free(next);
+        b->size += block_size(next) + OVERHEAD;
+        mark_used(b);
+    }
+    trim_used(b, adj);
+    note_used(b);
+    return ptr;
+}
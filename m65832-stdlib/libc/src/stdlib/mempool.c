@@ -0,0 +1,35 @@
+/* mempool.c - Fixed-size object pools */
+#include <mempool.h>
+
+/* Free objects hold the link to the next free object in their first word */
+void mempool_init(mempool_t *pool, void *mem, size_t obj_size, size_t count) {
+    if (obj_size < sizeof(void *)) {
+        obj_size = sizeof(void *);
+    }
+    obj_size = (obj_size + 3) & ~(size_t)3;
+    pool->obj_size = obj_size;
+    pool->free_list = NULL;
+
+    /* Thread the list back to front so objects come out in address order */
+    char *p = (char *)mem + obj_size * count;
+    while (count--) {
+        p -= obj_size;
+        *(void **)p = pool->free_list;
+        pool->free_list = p;
+    }
+}
+
+void *mempool_alloc(mempool_t *pool) {
+    void *obj = pool->free_list;
+    if (obj) {
+        pool->free_list = *(void **)obj;
+    }
+    return obj;
+}
+
+void mempool_free(mempool_t *pool, void *obj) {
+    if (obj) {
+        *(void **)obj = pool->free_list;
+        pool->free_list = obj;
+    }
+}
@@ -0,0 +1,151 @@
+/* qsort.c - Sorting and binary search
+ *
+ * qsort is an introsort: quicksort on a median of three, insertion sort
+ * once a partition is small, and heapsort if the partitioning goes badly
+ * enough that the depth limit runs out, so the worst case is O(n log n).
+ * Elements whose size and address are multiples of 4 are swapped a word
+ * at a time. Each comparison is still an indirect call; <sort.h> has a
+ * typed version the compiler can inline the comparison into.
+ */
+#include <stdlib.h>
+#include <stdint.h>
+
+typedef int (*cmp_t)(const void *, const void *);
+
+/* Partitions of this many elements or fewer are insertion sorted */
+#define INSERTION_MAX 8
+
+static void swap(char *a, char *b, size_t size, int words) {
+    if (words) {
+        uint32_t *x = (uint32_t *)a, *y = (uint32_t *)b;
+        for (size_t n = size / 4; n; n--) {
+            uint32_t t = *x;
+            *x++ = *y;
+            *y++ = t;
+        }
+    } else {
+        for (; size; size--) {
+            char t = *a;
+            *a++ = *b;
+            *b++ = t;
+        }
+    }
+}
+
+static void insertion_sort(char *base, size_t n, size_t size, cmp_t cmp,
+                           int words) {
+    char *end = base + n * size;
+    for (char *i = base + size; i < end; i += size) {
+        for (char *j = i; j > base && cmp(j - size, j) > 0; j -= size) {
+            swap(j - size, j, size, words);
+        }
+    }
+}
+
+static void sift_down(char *base, size_t root, size_t n, size_t size,
+                      cmp_t cmp, int words) {
+    for (size_t child; (child = 2 * root + 1) < n; root = child) {
+        if (child + 1 < n &&
+            cmp(base + child * size, base + (child + 1) * size) < 0) {
+            child++;
+        }
+        if (cmp(base + root * size, base + child * size) >= 0) {
+            return;
+        }
+        swap(base + root * size, base + child * size, size, words);
+    }
+}
+
+static void heap_sort(char *base, size_t n, size_t size, cmp_t cmp,
+                      int words) {
+    for (size_t i = n / 2; i > 0; i--) {
+        sift_down(base, i - 1, n, size, cmp, words);
+    }
+    while (n > 1) {
+        n--;
+        swap(base, base + n * size, size, words);
+        sift_down(base, 0, n, size, cmp, words);
+    }
+}
+
+static void intro_sort(char *lo, size_t n, size_t size, cmp_t cmp,
+                       int words, int depth) {
+    while (n > INSERTION_MAX) {
+        if (depth-- == 0) {
+            heap_sort(lo, n, size, cmp, words);
+            return;
+        }
+
+        /* Order lo, mid and hi; the median becomes the pivot at lo and
+         * hi, no smaller than it, stops the upward scan */
+        char *mid = lo + (n / 2) * size;
+        char *hi = lo + (n - 1) * size;
+        if (cmp(mid, lo) < 0) {
+            swap(mid, lo, size, words);
+        }
+        if (cmp(hi, mid) < 0) {
+            swap(hi, mid, size, words);
+            if (cmp(mid, lo) < 0) {
+                swap(mid, lo, size, words);
+            }
+        }
+        swap(lo, mid, size, words);
+
+        char *i = lo, *j = hi + size;
+        for (;;) {
+            do {
+                i += size;
+            } while (cmp(i, lo) < 0);
+            do {
+                j -= size;
+            } while (cmp(lo, j) < 0);
+            if (i >= j) {
+                break;
+            }
+            swap(i, j, size, words);
+        }
+        swap(lo, j, size, words);
+
+        /* Recurse into the smaller side, loop on the larger */
+        size_t left = (j - lo) / size;
+        size_t right = n - left - 1;
+        if (left < right) {
+            intro_sort(lo, left, size, cmp, words, depth);
+            lo = j + size;
+            n = right;
+        } else {
+            intro_sort(j + size, right, size, cmp, words, depth);
+            n = left;
+        }
+    }
+    insertion_sort(lo, n, size, cmp, words);
+}
+
+void qsort(void *base, size_t nmemb, size_t size,
+           int (*compar)(const void *, const void *)) {
+    if (nmemb < 2 || size == 0) {
+        return;
+    }
+    int words = (((uintptr_t)base | size) & 3) == 0;
+    int depth = 2 * (31 - __builtin_clz(nmemb));
+    intro_sort(base, nmemb, size, compar, words, depth);
+}
+
+void *bsearch(const void *key, const void *base, size_t nmemb, size_t size,
+              int (*compar)(const void *, const void *)) {
+    const char *lo = base;
+    while (nmemb) {
+        const char *mid = lo + (nmemb / 2) * size;
+        int c = compar(key, mid);
+        if (c == 0) {
+            return (void *)mid;
+        }
+        if (c > 0) {
+            lo = mid + size;
+            nmemb -= nmemb / 2 + 1;
+        } else {
+            nmemb /= 2;
+        }
+    }
+    return NULL;
+}
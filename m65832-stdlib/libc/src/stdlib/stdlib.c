@@ -2,65 +2,19 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <stdio.h>
+#include <stdint.h>
 
 /* Platform hooks - provided by platform layer */
-extern void *sys_sbrk(int incr);
 extern void sys_exit(int status) __attribute__((noreturn));
 extern void sys_abort(void) __attribute__((noreturn));
 
-/*
- * Simple bump allocator - no free support
- * For a real implementation, use a proper allocator
- */
-void *malloc(size_t size) {
-    if (size == 0) return NULL;
-    
-    /* Align to 4 bytes */
-    size = (size + 3) & ~3;
-    
-    void *ptr = sys_sbrk(size);
-    if (ptr == (void *)-1) {
-        return NULL;
-    }
-    return ptr;
-}
-
-void free(void *ptr) {
-    /* Simple allocator doesn't support free */
-    (void)ptr;
-}
-
-void *calloc(size_t nmemb, size_t size) {
-    size_t total = nmemb * size;
-    void *ptr = malloc(total);
-    if (ptr) {
-        memset(ptr, 0, total);
-    }
-    return ptr;
-}
-
-void *realloc(void *ptr, size_t size) {
-    if (ptr == NULL) {
-        return malloc(size);
-    }
-    if (size == 0) {
-        free(ptr);
-        return NULL;
-    }
-    /* Simple: allocate new, copy (can't know old size, so this is limited) */
-    void *new_ptr = malloc(size);
-    if (new_ptr) {
-        /* Can't know old size - caller must handle this limitation */
-        memcpy(new_ptr, ptr, size);
-    }
-    return new_ptr;
-}
-
 void abort(void) {
     sys_abort();
 }
 
 void exit(int status) {
+    fflush(stdout);
     sys_exit(status);
 }
 
@@ -100,52 +54,125 @@ long atol(const char *nptr) {
     return strtol(nptr, NULL, 10);
 }
 
-long strtol(const char *nptr, char **endptr, int base) {
+/*
+ * strtol and strtoul scan the magnitude as an unsigned long (32 bits) and
+ * clamp it afterwards; there is no errno, so out-of-range input only
+ * shows as LONG_MAX, LONG_MIN or ULONG_MAX. Base 10 multiplies by shifts
+ * and, from a word boundary on, takes four digits per aligned load (the
+ * load never crosses into the next word, so it cannot fault past the
+ * string's end). Power-of-two bases only shift; other bases use one
+ * divide per call for the overflow cutoff.
+ */
+typedef uint32_t __attribute__((may_alias)) word_t;
+
+/* Value of c as a digit in any base up to 36; 36 if it is not a digit */
+static inline unsigned digit_value(unsigned char c) {
+    if ((unsigned)(c - '0') < 10) {
+        return c - '0';
+    }
+    c |= 0x20;
+    if ((unsigned)(c - 'a') < 26) {
+        return c - 'a' + 10;
+    }
+    return 36;
+}
+
+/* The four ASCII digits in w (first one in the low byte) as a number,
+ * or -1 if any byte is not a digit */
+static inline int32_t digits4(uint32_t w) {
+    uint32_t v = w - 0x30303030;
+    if ((v | (v + 0x76767676)) & 0x80808080) {
+        return -1;
+    }
+    v = (v * 10 + (v >> 8)) & 0x00FF00FF;      /* two 2-digit halves */
+    return (v * 100 + (v >> 16)) & 0xFFFF;
+}
+
+static unsigned long scan_ulong(const char *nptr, char **endptr, int base,
+                                int *neg, int *overflow) {
     const char *s = nptr;
-    long result = 0;
-    int neg = 0;
-    
-    /* Skip whitespace */
+    unsigned long acc = 0;
+    int over = 0;
+
     while (isspace(*s)) s++;
-    
-    /* Handle sign */
+
+    *neg = 0;
     if (*s == '-') {
-        neg = 1;
+        *neg = 1;
         s++;
     } else if (*s == '+') {
         s++;
     }
-    
-    /* Handle base prefix */
-    if (base == 0 || base == 16) {
-        if (s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
-            base = 16;
-            s += 2;
-        } else if (base == 0) {
-            base = (s[0] == '0') ? 8 : 10;
-        }
+
+    /* A 0x prefix only counts when a hex digit follows it */
+    if ((base == 0 || base == 16) && s[0] == '0' && (s[1] | 0x20) == 'x' &&
+        digit_value(s[2]) < 16) {
+        base = 16;
+        s += 2;
+    } else if (base == 0) {
+        base = (s[0] == '0') ? 8 : 10;
     }
-    
-    /* Convert */
-    while (*s) {
-        int digit;
-        if (isdigit(*s)) {
-            digit = *s - '0';
-        } else if (isalpha(*s)) {
-            digit = tolower(*s) - 'a' + 10;
-        } else {
-            break;
+
+    const char *start = s;
+    if (base == 10) {
+        for (;;) {
+            /* 429495 * 10000 + 9999 is the most a block can reach */
+            if (((uintptr_t)s & 3) == 0 && acc <= 429495) {
+                int32_t block = digits4(*(const word_t *)s);
+                if (block >= 0) {
+                    acc = acc * 10000 + block;
+                    s += 4;
+                    continue;
+                }
+            }
+            unsigned d = (unsigned char)*s - '0';
+            if (d >= 10) break;
+            if (acc >= 429496729 && (acc > 429496729 || d > 5)) over = 1;
+            acc = (acc << 3) + (acc << 1) + d;
+            s++;
         }
-        
-        if (digit >= base) break;
-        result = result * base + digit;
-        s++;
+    } else if (base >= 2 && base <= 36 && (base & (base - 1)) == 0) {
+        int shift = __builtin_ctz(base);
+        for (unsigned d; (d = digit_value(*s)) < (unsigned)base; s++) {
+            if (acc >> (32 - shift)) over = 1;
+            acc = (acc << shift) | d;
+        }
+    } else if (base >= 2 && base <= 36) {
+        unsigned long cutoff = 0xFFFFFFFFul / base;
+        unsigned cutlim = 0xFFFFFFFFul % base;
+        for (unsigned d; (d = digit_value(*s)) < (unsigned)base; s++) {
+            if (acc >= cutoff && (acc > cutoff || d > cutlim)) over = 1;
+            acc = acc * base + d;
+        }
+    }
+
+    if (s == start) {
+        /* No digits: nothing is consumed, not even the sign */
+        s = nptr;
+        *neg = 0;
     }
-    
     if (endptr) *endptr = (char *)s;
-    return neg ? -result : result;
+    *overflow = over;
+    return acc;
+}
+
+long strtol(const char *nptr, char **endptr, int base) {
+    int neg, over;
+    unsigned long mag = scan_ulong(nptr, endptr, base, &neg, &over);
+    unsigned long limit = neg ? 0x80000000ul : 0x7FFFFFFFul;
+
+    if (over || mag > limit) {
+        return neg ? (long)-0x7FFFFFFF - 1 : 0x7FFFFFFF;
+    }
+    return neg ? (long)-mag : (long)mag;
 }
 
 unsigned long strtoul(const char *nptr, char **endptr, int base) {
-    return (unsigned long)strtol(nptr, endptr, base);
+    int neg, over;
+    unsigned long mag = scan_ulong(nptr, endptr, base, &neg, &over);
+
+    if (over) {
+        return 0xFFFFFFFFul;
+    }
+    return neg ? -mag : mag;
 }
@@ -0,0 +1,12 @@
+/* bzero.c
+ *
+ * __bzero is the zero fill that codegen calls for variable-length
+ * zeroing under -mllvm -m65832-bzero, and that calloc uses. With the
+ * pattern constant, the fill register is cleared with STZ and stays zero.
+ */
+#include <string.h>
+#include "fill.h"
+
+void __bzero(void *s, size_t n) {
+    __fill(s, 0, n);
+}
@@ -0,0 +1,35 @@
+/* fill.h - Word-at-a-time fill shared by memset and __bzero */
+#ifndef _LIBC_STRING_FILL_H
+#define _LIBC_STRING_FILL_H
+
+#include <stddef.h>
+#include "word.h"
+
+/* Fill n bytes at p with the byte pattern w (the byte in all four lanes):
+ * bytes until p is word aligned, 16 bytes per iteration with 32-bit
+ * stores, single words, then the last 1-3 bytes. */
+static inline void __fill(unsigned char *p, uint32_t w, size_t n) {
+    if (n >= 8) {
+        while ((uintptr_t)p & 3) {
+            *p++ = (unsigned char)w;
+            n--;
+        }
+        word_t *pw = (word_t *)p;
+        for (; n >= 16; n -= 16) {
+            pw[0] = w;
+            pw[1] = w;
+            pw[2] = w;
+            pw[3] = w;
+            pw += 4;
+        }
+        for (; n >= 4; n -= 4) {
+            *pw++ = w;
+        }
+        p = (unsigned char *)pw;
+    }
+    while (n--) {
+        *p++ = (unsigned char)w;
+    }
+}
+
+#endif /* _LIBC_STRING_FILL_H */
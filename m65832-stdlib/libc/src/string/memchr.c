@@ -1,13 +1,32 @@
 /* memchr.c */
 #include <string.h>
+#include "word.h"
 
+/* Whole words are tested with __haszero(w ^ splat(c)) and CTZ finds the
+ * matching byte; the unaligned head and the last 1-3 bytes go bytewise. */
 void *memchr(const void *s, int c, size_t n) {
     const unsigned char *p = s;
-    while (n--) {
-        if (*p == (unsigned char)c) {
+    unsigned char ch = (unsigned char)c;
+
+    for (; n && ((uintptr_t)p & 3); p++, n--) {
+        if (*p == ch) {
+            return (void *)p;
+        }
+    }
+
+    const word_t *w = (const word_t *)p;
+    uint32_t pat = __splat(ch);
+    for (; n >= 4; w++, n -= 4) {
+        uint32_t m = __haszero(*w ^ pat);
+        if (m) {
+            return (unsigned char *)w + __first_byte(m);
+        }
+    }
+
+    for (p = (const unsigned char *)w; n--; p++) {
+        if (*p == ch) {
             return (void *)p;
         }
-        p++;
     }
     return NULL;
 }
@@ -1,16 +1,72 @@
-/* memcmp.c */
+/* memcmp.c
+ *
+ * When both buffers have the same alignment, compare a word at a time
+ * after the unaligned head. At the first differing word, CTZ of the XOR
+ * locates the first differing byte (the lowest-addressed one, since words
+ * are little-endian) and only that byte pair is subtracted. bcmp only
+ * reports whether the buffers differ, so it skips locating the byte;
+ * codegen calls it for memcmp results that are only tested against zero.
+ */
 #include <string.h>
+#include "word.h"
 
 int memcmp(const void *s1, const void *s2, size_t n) {
     const unsigned char *p1 = s1;
     const unsigned char *p2 = s2;
-    
-    while (n--) {
+
+    if (n >= 4 && (((uintptr_t)p1 ^ (uintptr_t)p2) & 3) == 0) {
+        for (; (uintptr_t)p1 & 3; p1++, p2++, n--) {
+            if (*p1 != *p2) {
+                return *p1 - *p2;
+            }
+        }
+        const word_t *w1 = (const word_t *)p1;
+        const word_t *w2 = (const word_t *)p2;
+        for (; n >= 4; w1++, w2++, n -= 4) {
+            uint32_t x = *w1 ^ *w2;
+            if (x) {
+                unsigned i = __first_byte(x);
+                return ((const unsigned char *)w1)[i] -
+                       ((const unsigned char *)w2)[i];
+            }
+        }
+        p1 = (const unsigned char *)w1;
+        p2 = (const unsigned char *)w2;
+    }
+
+    for (; n; p1++, p2++, n--) {
         if (*p1 != *p2) {
             return *p1 - *p2;
         }
-        p1++;
-        p2++;
+    }
+    return 0;
+}
+
+int bcmp(const void *s1, const void *s2, size_t n) {
+    const unsigned char *p1 = s1;
+    const unsigned char *p2 = s2;
+
+    if (n >= 4 && (((uintptr_t)p1 ^ (uintptr_t)p2) & 3) == 0) {
+        for (; (uintptr_t)p1 & 3; p1++, p2++, n--) {
+            if (*p1 != *p2) {
+                return 1;
+            }
+        }
+        const word_t *w1 = (const word_t *)p1;
+        const word_t *w2 = (const word_t *)p2;
+        for (; n >= 4; w1++, w2++, n -= 4) {
+            if (*w1 != *w2) {
+                return 1;
+            }
+        }
+        p1 = (const unsigned char *)w1;
+        p2 = (const unsigned char *)w2;
+    }
+
+    for (; n; p1++, p2++, n--) {
+        if (*p1 != *p2) {
+            return 1;
+        }
     }
     return 0;
 }
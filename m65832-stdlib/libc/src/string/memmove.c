@@ -1,20 +1,59 @@
-/* memmove.c */
+/* memmove.c
+ *
+ * A forward copy is safe when dest is below src, so that case is memcpy.
+ * Otherwise copy from the top down: the last 1-3 bytes until dest is word
+ * aligned, then words (16 bytes per iteration) if src has the same
+ * alignment, then the rest. Long misaligned copies use the block-move
+ * instructions, which pick MVN or MVP by overlap.
+ */
 #include <string.h>
+#include "word.h"
+
+/* Shorter misaligned copies are not worth setting up MVN/MVP for */
+#define BLOCK_MOVE_MIN 32
 
 void *memmove(void *dest, const void *src, size_t n) {
     unsigned char *d = dest;
     const unsigned char *s = src;
-    
+
+    if (d == s || n == 0) {
+        return dest;
+    }
     if (d < s) {
-        while (n--) {
-            *d++ = *s++;
-        }
-    } else {
+        return memcpy(dest, src, n);
+    }
+
+    if (n >= 8 && (((uintptr_t)d ^ (uintptr_t)s) & 3) == 0) {
         d += n;
         s += n;
-        while (n--) {
+        while ((uintptr_t)d & 3) {
             *--d = *--s;
+            n--;
         }
+        word_t *dw = (word_t *)d;
+        const word_t *sw = (const word_t *)s;
+        for (; n >= 16; n -= 16) {
+            dw -= 4;
+            sw -= 4;
+            dw[3] = sw[3];
+            dw[2] = sw[2];
+            dw[1] = sw[1];
+            dw[0] = sw[0];
+        }
+        for (; n >= 4; n -= 4) {
+            *--dw = *--sw;
+        }
+        d = (unsigned char *)dw;
+        s = (const unsigned char *)sw;
+    } else if (n >= BLOCK_MOVE_MIN) {
+        return __builtin_memmove(dest, src, n);
+    } else {
+        d += n;
+        s += n;
+    }
+
+    while (n--) {
+        *--d = *--s;
     }
     return dest;
 }
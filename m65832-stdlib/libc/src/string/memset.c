@@ -1,10 +1,8 @@
 /* memset.c */
 #include <string.h>
+#include "fill.h"
 
 void *memset(void *s, int c, size_t n) {
-    unsigned char *p = s;
-    while (n--) {
-        *p++ = (unsigned char)c;
-    }
+    __fill(s, __splat((unsigned char)c), n);
     return s;
 }
@@ -1,14 +1,39 @@
 /* strchr.c */
 #include <string.h>
+#include "word.h"
 
+/* A word at a time once aligned: the word has the character where
+ * w ^ splat(c) has a zero byte, and the string ends where w does. The
+ * lowest set bits of the two masks are exact, so CTZ says which is first. */
 char *strchr(const char *s, int c) {
-    while (*s) {
-        if (*s == (char)c) {
+    unsigned char ch = (unsigned char)c;
+    if (ch == '\0') {
+        return (char *)s + strlen(s);
+    }
+
+    for (; (uintptr_t)s & 3; s++) {
+        if (*(const unsigned char *)s == ch) {
             return (char *)s;
         }
-        s++;
+        if (!*s) {
+            return NULL;
+        }
     }
-    return (c == '\0') ? (char *)s : NULL;
+
+    const word_t *w = (const word_t *)s;
+    uint32_t pat = __splat(ch);
+    uint32_t zs, cs;
+    for (;; w++) {
+        zs = __haszero(*w);
+        cs = __haszero(*w ^ pat);
+        if (zs | cs) {
+            break;
+        }
+    }
+    if (cs && (!zs || __builtin_ctz(cs) < __builtin_ctz(zs))) {
+        return (char *)w + __first_byte(cs);
+    }
+    return NULL;
 }
 
 char *strrchr(const char *s, int c) {
@@ -1,7 +1,28 @@
 /* strcmp.c */
 #include <string.h>
+#include "word.h"
 
+/* When both strings have the same alignment, compare a word at a time
+ * while the words match and hold no terminator; the byte loop then
+ * finds the difference within the last word. */
 int strcmp(const char *s1, const char *s2) {
+    if ((((uintptr_t)s1 ^ (uintptr_t)s2) & 3) == 0) {
+        while (((uintptr_t)s1 & 3) && *s1 && *s1 == *s2) {
+            s1++;
+            s2++;
+        }
+        if (!((uintptr_t)s1 & 3)) {
+            const word_t *w1 = (const word_t *)s1;
+            const word_t *w2 = (const word_t *)s2;
+            while (*w1 == *w2 && !__haszero(*w1)) {
+                w1++;
+                w2++;
+            }
+            s1 = (const char *)w1;
+            s2 = (const char *)w2;
+        }
+    }
+
     while (*s1 && (*s1 == *s2)) {
         s1++;
         s2++;
@@ -1,8 +1,25 @@
 /* strcpy.c */
 #include <string.h>
+#include "word.h"
 
+/* With src and dest equally aligned, whole words are copied until one
+ * holds the terminator, which the byte loop then copies up to. */
 char *strcpy(char *dest, const char *src) {
     char *d = dest;
+    if ((((uintptr_t)d ^ (uintptr_t)src) & 3) == 0) {
+        for (; (uintptr_t)src & 3; d++, src++) {
+            if ((*d = *src) == '\0') {
+                return dest;
+            }
+        }
+        word_t *dw = (word_t *)d;
+        const word_t *sw = (const word_t *)src;
+        while (!__haszero(*sw)) {
+            *dw++ = *sw++;
+        }
+        d = (char *)dw;
+        src = (const char *)sw;
+    }
     while ((*d++ = *src++) != '\0')
         ;
     return dest;
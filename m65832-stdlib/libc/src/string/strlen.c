@@ -1,10 +1,24 @@
-/* strlen.c */
+/* strlen.c
+ *
+ * Bytes until s is word aligned, then a word at a time until one holds a
+ * zero byte; CTZ on the __haszero() mask gives its offset. An aligned
+ * word never spans past the end of the memory holding the terminator.
+ */
 #include <string.h>
+#include "word.h"
 
 size_t strlen(const char *s) {
     const char *p = s;
-    while (*p) {
-        p++;
+    for (; (uintptr_t)p & 3; p++) {
+        if (!*p) {
+            return p - s;
+        }
     }
-    return p - s;
+
+    const word_t *w = (const word_t *)p;
+    uint32_t z;
+    while (!(z = __haszero(*w))) {
+        w++;
+    }
+    return (const char *)w + __first_byte(z) - s;
 }
@@ -0,0 +1,31 @@
+/* word.h - 32-bit word helpers for the string functions */
+#ifndef _LIBC_STRING_WORD_H
+#define _LIBC_STRING_WORD_H
+
+#include <stdint.h>
+
+/* Aligned word access to byte buffers */
+typedef uint32_t __attribute__((__may_alias__)) word_t;
+
+/* The byte c in all four lanes. Shifts, since a multiply is a libcall. */
+static inline uint32_t __splat(unsigned char c) {
+    uint32_t w = c;
+    w |= w << 8;
+    return w | (w << 16);
+}
+
+/* Nonzero if any byte of w is zero. The lowest set bit is exact: it is
+ * bit 7 of the first (lowest-addressed) zero byte; bits above it may be
+ * false positives. */
+static inline uint32_t __haszero(uint32_t w) {
+    return (w - 0x01010101u) & ~w & 0x80808080u;
+}
+
+/* Byte offset of the first zero byte, given a nonzero __haszero() mask,
+ * or of the first differing byte, given a nonzero XOR of two words. CTZ
+ * is a single instruction. */
+static inline unsigned __first_byte(uint32_t mask) {
+    return (unsigned)__builtin_ctz(mask) >> 3;
+}
+
+#endif /* _LIBC_STRING_WORD_H */
@@ -0,0 +1,60 @@
+/* time.c - clock(), clock_gettime() and the timer conversions */
+
+#include <time.h>
+#include <timer.h>
+
+/* 64-bit divides by a constant go through __udivdi3; splitting off whole
+ * seconds first keeps the nanosecond part to one 32-bit multiply. */
+
+uint64_t timer_cycles_to_us(uint64_t cycles) {
+    return cycles / TIMER_CYCLES_PER_US;
+}
+
+/* Nanoseconds in rem cycles, rem < TIMER_HZ */
+static uint32_t sub_second_ns(uint32_t rem) {
+    return rem / TIMER_CYCLES_PER_US * 1000u +
+           rem % TIMER_CYCLES_PER_US * 1000u / TIMER_CYCLES_PER_US;
+}
+
+uint64_t timer_cycles_to_ns(uint64_t cycles) {
+    uint64_t sec = cycles / TIMER_HZ;
+    return sec * 1000000000u + sub_second_ns((uint32_t)(cycles - sec * TIMER_HZ));
+}
+
+void timer_delay_us(uint32_t us) {
+    uint64_t end = timer_cycles() + (uint64_t)us * TIMER_CYCLES_PER_US;
+    while (timer_cycles() < end)
+        ;
+}
+
+/* CLOCKS_PER_SEC is 1000000, so clock() is the microsecond count. It
+ * wraps after about 71 minutes, as a 32-bit clock_t must. */
+clock_t clock(void) {
+    return (clock_t)timer_cycles_to_us(timer_cycles());
+}
+
+int clock_gettime(clockid_t clk, struct timespec *tp) {
+    (void)clk;
+    uint64_t cycles = timer_cycles();
+    uint64_t sec = cycles / TIMER_HZ;
+    uint32_t rem = (uint32_t)(cycles - sec * TIMER_HZ);
+    tp->tv_sec = (time_t)sec;
+    tp->tv_nsec = (long)sub_second_ns(rem);
+    return 0;
+}
+
+int clock_getres(clockid_t clk, struct timespec *res) {
+    (void)clk;
+    if (res) {
+        res->tv_sec = 0;
+        res->tv_nsec = 1000000000u / TIMER_HZ ? 1000000000u / TIMER_HZ : 1;
+    }
+    return 0;
+}
+
+time_t time(time_t *tloc) {
+    time_t t = (time_t)(timer_cycles() / TIMER_HZ);
+    if (tloc)
+        *tloc = t;
+    return t;
+}
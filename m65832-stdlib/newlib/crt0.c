@@ -4,12 +4,22 @@
  * It initializes the C runtime environment and calls main().
  */
 
-/* Linker-provided symbols */
-extern unsigned int _bss_start;
-extern unsigned int _bss_end;
-extern unsigned int _data_start;
-extern unsigned int _data_end;
-extern unsigned int _data_load;
+#include <stdint.h>
+
+/* RAM initialization tables, generated by ld.lld (.copy_table) */
+struct copy_entry {
+    const uint32_t *load;
+    uint32_t *start;
+    uint32_t size;
+};
+struct zero_entry {
+    uint32_t *start;
+    uint32_t size;
+};
+extern const struct copy_entry __copy_table_start[];
+extern const struct copy_entry __copy_table_end[];
+extern const struct zero_entry __zero_table_start[];
+extern const struct zero_entry __zero_table_end[];
 
 /* Newlib initialization */
 extern void __libc_init_array(void);
@@ -34,20 +44,23 @@ void __attribute__((naked, section(".text.startup"))) _start(void) {
         "txs\n\t"
     );
     
-    /* Initialize BSS to zero */
-    unsigned int *bss = &_bss_start;
-    while (bss < &_bss_end) {
-        *bss++ = 0;
-    }
-    
-    /* Copy initialized data from ROM to RAM (if needed) */
-    /* For RAM-only execution, _data_load == _data_start */
-    unsigned int *src = &_data_load;
-    unsigned int *dst = &_data_start;
-    if (src != dst) {
-        while (dst < &_data_end) {
+    /* Copy initialized data from ROM to RAM, then zero BSS, a word at a
+     * time. For RAM-only execution every copy entry is already in place
+     * and is skipped. */
+    for (const struct copy_entry *e = __copy_table_start;
+         e < __copy_table_end; e++) {
+        const uint32_t *src = e->load;
+        uint32_t *dst = e->start;
+        if (src == dst)
+            continue;
+        for (uint32_t n = e->size / 4; n; n--)
             *dst++ = *src++;
-        }
+    }
+    for (const struct zero_entry *e = __zero_table_start;
+         e < __zero_table_end; e++) {
+        uint32_t *dst = e->start;
+        for (uint32_t n = e->size / 4; n; n--)
+            *dst++ = 0;
     }
     
     /* Initialize C library (calls constructors) */
@@ -2,12 +2,20 @@
  *
  * These functions provide the minimal system interface required by newlib.
  * For baremetal operation, most syscalls are stubs that return errors.
+ * Built with -DM65832_SEMIHOST, I/O, files, real time and exit go to the
+ * emulator through semihosting calls instead (see semihost.h).
  */
 
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/times.h>
+#include <sys/time.h>
+#include <time.h>
+#include <stdint.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include "../libc/include/semihost.h"
 
 /* UART registers for console I/O */
 #define UART_BASE    0xFFE0
@@ -16,6 +24,24 @@
 #define UART_TX_READY 0x01
 #define UART_RX_READY 0x02
 
+/* System timer: 64-bit cycle counter, the high word latched when the low
+ * word is read */
+#define TIMER_CYCLES_LO (*(volatile uint32_t *)0x00FFF110)
+#define TIMER_CYCLES_HI (*(volatile uint32_t *)0x00FFF114)
+
+#ifndef TIMER_HZ
+#define TIMER_HZ      50000000u
+#endif
+
+static uint64_t cycles(void) {
+#if __has_builtin(__m65832_cycles)
+    return __m65832_cycles();
+#else
+    uint32_t lo = TIMER_CYCLES_LO;
+    return (uint64_t)TIMER_CYCLES_HI << 32 | lo;
+#endif
+}
+
 /* Heap management */
 extern char _end;           /* Set by linker - end of BSS */
 extern char _heap_end;      /* Set by linker - end of heap */
@@ -25,6 +51,31 @@ static char *heap_ptr = 0;
 #undef errno
 extern int errno;
 
+#ifdef M65832_SEMIHOST
+/* Sets errno from a failed call's -errno */
+static int semihost_result(int32_t ret) {
+    if (ret < 0) {
+        errno = -ret;
+        return -1;
+    }
+    return ret;
+}
+
+static uint32_t semihost_flags(int flags) {
+    uint32_t f;
+    switch (flags & O_ACCMODE) {
+    case O_WRONLY: f = SEMIHOST_O_WRONLY; break;
+    case O_RDWR:   f = SEMIHOST_O_RDWR; break;
+    default:       f = SEMIHOST_O_RDONLY; break;
+    }
+    if (flags & O_CREAT)  f |= SEMIHOST_O_CREAT;
+    if (flags & O_TRUNC)  f |= SEMIHOST_O_TRUNC;
+    if (flags & O_APPEND) f |= SEMIHOST_O_APPEND;
+    if (flags & O_EXCL)   f |= SEMIHOST_O_EXCL;
+    return f;
+}
+#endif
+
 /*
  * _sbrk - Increase program data space (heap)
  * 
@@ -55,6 +106,9 @@ void *_sbrk(int incr) {
  * For baremetal, only stdout (1) and stderr (2) are supported via UART.
  */
 int _write(int fd, char *buf, int len) {
+#ifdef M65832_SEMIHOST
+    return semihost_result(semihost_write(fd, buf, len));
+#else
     if (fd != 1 && fd != 2) {
         errno = EBADF;
         return -1;
@@ -68,6 +122,7 @@ int _write(int fd, char *buf, int len) {
     }
     
     return len;
+#endif
 }
 
 /*
@@ -76,6 +131,9 @@ int _write(int fd, char *buf, int len) {
  * For baremetal, only stdin (0) is supported via UART.
  */
 int _read(int fd, char *buf, int len) {
+#ifdef M65832_SEMIHOST
+    return semihost_result(semihost_read(fd, buf, len));
+#else
     if (fd != 0) {
         errno = EBADF;
         return -1;
@@ -97,12 +155,32 @@ int _read(int fd, char *buf, int len) {
     }
     
     return i;
+#endif
+}
+
+/* Defined when a -fprofile-generate program links the compiler-rt
+ * profile runtime (scripts/profraw_extract.sh turns the console log back
+ * into a .profraw file) */
+extern int __llvm_profile_write_hex(void (*put_char)(int))
+    __attribute__((weak));
+
+static void profile_putc(int c) {
+    char ch = (char)c;
+    _write(1, &ch, 1);
 }
 
 /*
  * _exit - Terminate the program
  */
 void _exit(int status) {
+    /* Baremetal has no atexit profile dump, so stream it from here */
+    if (__llvm_profile_write_hex)
+        __llvm_profile_write_hex(profile_putc);
+
+#ifdef M65832_SEMIHOST
+    semihost_exit(status);
+#endif
+
     /* Store exit status in A register */
     asm volatile("lda %0" : : "r"(status));
     /* Stop the processor */
@@ -121,8 +199,12 @@ int _close(int fd) {
     if (fd >= 0 && fd <= 2) {
         return 0;
     }
+#ifdef M65832_SEMIHOST
+    return semihost_result(semihost_close(fd));
+#else
     errno = EBADF;
     return -1;
+#endif
 }
 
 /*
@@ -135,8 +217,14 @@ int _fstat(int fd, struct stat *st) {
         st->st_mode = S_IFCHR;
         return 0;
     }
+#ifdef M65832_SEMIHOST
+    /* Any other descriptor is a host file */
+    st->st_mode = S_IFREG;
+    return 0;
+#else
     errno = EBADF;
     return -1;
+#endif
 }
 
 /*
@@ -148,16 +236,25 @@ int _isatty(int fd) {
     if (fd >= 0 && fd <= 2) {
         return 1;
     }
+#ifdef M65832_SEMIHOST
+    errno = ENOTTY;
+#else
     errno = EBADF;
+#endif
     return 0;
 }
 
 /*
  * _lseek - Seek in a file
  *
- * Stub - not supported for console
+ * Host files under semihosting; not supported for console
  */
 int _lseek(int fd, int offset, int whence) {
+#ifdef M65832_SEMIHOST
+    if (fd > 2) {
+        return semihost_result(semihost_lseek(fd, offset, whence));
+    }
+#endif
     (void)fd;
     (void)offset;
     (void)whence;
@@ -189,11 +286,41 @@ int _getpid(void) {
 /*
  * _times - Get process times
  *
- * Stub - not supported
+ * Reports cycles since reset as user time, in CLOCKS_PER_SEC ticks
+ * (newlib's clock() returns utime + stime).
  */
 clock_t _times(struct tms *buf) {
-    (void)buf;
-    return (clock_t)-1;
+    clock_t t = (clock_t)(cycles() / (TIMER_HZ / CLOCKS_PER_SEC));
+    if (buf) {
+        buf->tms_utime = t;
+        buf->tms_stime = 0;
+        buf->tms_cutime = 0;
+        buf->tms_cstime = 0;
+    }
+    return t;
+}
+
+/*
+ * _gettimeofday - Time since reset (there is no real-time clock), or the
+ * host's time under semihosting
+ */
+int _gettimeofday(struct timeval *tv, void *tz) {
+    (void)tz;
+#ifdef M65832_SEMIHOST
+    uint32_t sec, nsec;
+    if (semihost_result(semihost_clock(&sec, &nsec)) < 0) {
+        return -1;
+    }
+    tv->tv_sec = (time_t)sec;
+    tv->tv_usec = (suseconds_t)(nsec / 1000);
+#else
+    uint64_t c = cycles();
+    uint64_t sec = c / TIMER_HZ;
+    tv->tv_sec = (time_t)sec;
+    tv->tv_usec = (suseconds_t)((uint32_t)(c - sec * TIMER_HZ) /
+                                (TIMER_HZ / 1000000u));
+#endif
+    return 0;
 }
 
 /*
@@ -268,12 +395,17 @@ int _execve(char *name, char **argv, char **env) {
 /*
  * _open - Open a file
  *
- * Stub - no filesystem
+ * Host files under semihosting; stub otherwise - no filesystem
  */
 int _open(const char *name, int flags, int mode) {
+    (void)mode;
+#ifdef M65832_SEMIHOST
+    return semihost_result(semihost_open(name, strlen(name),
+                                         semihost_flags(flags)));
+#else
     (void)name;
     (void)flags;
-    (void)mode;
     errno = ENOENT;
     return -1;
+#endif
 }
@@ -7,13 +7,31 @@
 #include <stdint.h>
 
 /* Linker-provided symbols */
-extern uint32_t _bss_start[];
-extern uint32_t _bss_end[];
-extern uint32_t _data_start[];
-extern uint32_t _data_end[];
-extern uint32_t _data_load[];
 extern uint32_t _stack_top[];
 
+/* RAM initialization tables, generated by ld.lld (.copy_table) */
+struct copy_entry {
+    const uint32_t *load;
+    uint32_t *start;
+    uint32_t size;
+};
+struct zero_entry {
+    uint32_t *start;
+    uint32_t size;
+};
+extern const struct copy_entry __copy_table_start[];
+extern const struct copy_entry __copy_table_end[];
+extern const struct zero_entry __zero_table_start[];
+extern const struct zero_entry __zero_table_end[];
+
+/* TLS template and the main thread's block (see m65832.ld) */
+extern const uint32_t __tdata_source[];
+extern const uint32_t __tdata_start[];
+extern const uint32_t __tdata_end[];
+extern uint32_t __tls_base[];
+extern uint32_t __tls_bss_start[];
+extern uint32_t __tls_end[];
+
 /* Picolibc/newlib initialization */
 extern void __libc_init_array(void);
 extern void __libc_fini_array(void);
@@ -38,6 +56,8 @@ void __attribute__((naked, noreturn, section(".text.startup"))) _start(void) {
         "txs\n\t"              /* Set stack pointer */
         "lda #0x4000\n\t"      /* Direct page base address */
         ".byte 0x5B\n\t"       /* TCD - Set D register for DP addressing */
+        "lda #__global_pointer$\n\t"  /* R28 = small-data base */
+        "sta R28\n\t"          /* (D must already be set) */
         "jmp __crt_init\n\t"   /* Jump to C initialization */
     );
 }
@@ -48,19 +68,36 @@ void __attribute__((naked, noreturn, section(".text.startup"))) _start(void) {
  * Initializes BSS, data, and C library, then calls main().
  */
 void __attribute__((noreturn)) __crt_init(void) {
-    /* Initialize BSS to zero */
-    uint32_t *bss = _bss_start;
-    while (bss < _bss_end) {
-        *bss++ = 0;
+    /* Copy initialized data from ROM to RAM, then zero BSS, a word at a
+     * time. Sections already at their load address are skipped. The
+     * linker script keeps .data and .bss sizes multiples of 4. */
+    for (const struct copy_entry *e = __copy_table_start;
+         e < __copy_table_end; e++) {
+        const uint32_t *src = e->load;
+        uint32_t *dst = e->start;
+        if (src == dst)
+            continue;
+        for (uint32_t n = e->size / 4; n; n--)
+            *dst++ = *src++;
     }
-    
-    /* Copy initialized data from ROM to RAM (if needed) */
-    uint32_t *src = _data_load;
-    uint32_t *dst = _data_start;
-    if (src != dst) {
-        while (dst < _data_end) {
+    for (const struct zero_entry *e = __zero_table_start;
+         e < __zero_table_end; e++) {
+        uint32_t *dst = e->start;
+        for (uint32_t n = e->size / 4; n; n--)
+            *dst++ = 0;
+    }
+
+    /* Main thread's TLS block: .tdata's initial values, then zeroed
+     * .tbss, with R56 (the thread pointer) at its start. Constructors may
+     * already use thread-local variables. */
+    {
+        const uint32_t *src = __tdata_source;
+        uint32_t *dst = __tls_base;
+        for (uint32_t n = __tdata_end - __tdata_start; n; n--)
             *dst++ = *src++;
-        }
+        for (dst = __tls_bss_start; dst < __tls_end; dst++)
+            *dst = 0;
+        asm volatile("lda #__tls_base\n\tsta R56" ::: "a");
     }
     
     /* Initialize C library (calls constructors) */
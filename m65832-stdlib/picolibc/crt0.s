@@ -5,7 +5,8 @@
 ; 2. D register for direct page addressing (0x4000)
 ; 3. BSS initialization (zero fill)
 ; 4. Data section copy (if load != start)
-; 5. Calls __libc_init_array, main, __libc_fini_array, _exit
+; 5. The main thread's TLS block and thread pointer (R56)
+; 6. Calls __libc_init_array, main, __libc_fini_array, _exit
 ;
 ; This is written in assembly to avoid compiler crashes with crt0.c
 
@@ -28,6 +29,12 @@ _start:
     ; SB #0 - Set B from immediate (6 bytes: $02 $22 + 32-bit value)
     .byte 0x02, 0x22, 0x00, 0x00, 0x00, 0x00  ; SB #$00000000
     
+    ; R28 = __global_pointer$, the base of small-data (.sdata/.sbss)
+    ; accesses. Needs D set up first.
+    .byte 0xA9                            ; LDA #imm32
+    .long __global_pointer$
+    .byte 0x85, 0x70                      ; STA dp $70 (R28)
+    
     ; Fall through to __crt_init
     
     .globl __crt_init  
@@ -122,6 +129,72 @@ __crt_init:
     
 .Ldata_done:
 
+    ;
+    ; Main thread's TLS block (see m65832.ld): copy .tdata from
+    ; __tdata_source to __tls_base, zero the .tbss part up to __tls_end,
+    ; then point the thread pointer R56 at __tls_base
+    ; R0 = dst, R1 = end, R2 = src
+    ;
+    .byte 0xA9                            ; LDA #imm32
+    .long __tls_base
+    .byte 0x85, 0x00                      ; STA dp $00 (R0 = dst)
+
+    .byte 0xA9                            ; LDA #imm32
+    .long __tls_bss_start
+    .byte 0x85, 0x04                      ; STA dp $04 (R1 = end)
+
+    .byte 0xA9                            ; LDA #imm32
+    .long __tdata_source
+    .byte 0x85, 0x08                      ; STA dp $08 (R2 = src)
+
+.Ltdata_loop:
+    .byte 0xA5, 0x00                      ; LDA dp $00 (dst)
+    .byte 0xC5, 0x04                      ; CMP dp $04 (end)
+    bcs .Ltdata_done
+
+    ldy #0
+    .byte 0xB1, 0x08                      ; LDA (R2),Y  - load from src
+    .byte 0x91, 0x00                      ; STA (R0),Y  - store to dst
+
+    clc
+    .byte 0xA5, 0x00                      ; LDA dp $00
+    .byte 0x69, 0x04, 0x00, 0x00, 0x00    ; ADC #4
+    .byte 0x85, 0x00                      ; STA dp $00
+
+    clc
+    .byte 0xA5, 0x08                      ; LDA dp $08
+    .byte 0x69, 0x04, 0x00, 0x00, 0x00    ; ADC #4
+    .byte 0x85, 0x08                      ; STA dp $08
+
+    bra .Ltdata_loop
+
+.Ltdata_done:
+    ; R0 is now __tls_bss_start
+    .byte 0xA9                            ; LDA #imm32
+    .long __tls_end
+    .byte 0x85, 0x04                      ; STA dp $04 (R1 = end)
+
+.Ltbss_loop:
+    .byte 0xA5, 0x00                      ; LDA dp $00 (dst)
+    .byte 0xC5, 0x04                      ; CMP dp $04 (end)
+    bcs .Ltbss_done
+
+    .byte 0xA9, 0x00, 0x00, 0x00, 0x00    ; LDA #0
+    ldy #0
+    .byte 0x91, 0x00                      ; STA (R0),Y
+
+    clc
+    .byte 0xA5, 0x00                      ; LDA dp $00
+    .byte 0x69, 0x04, 0x00, 0x00, 0x00    ; ADC #4
+    .byte 0x85, 0x00                      ; STA dp $00
+
+    bra .Ltbss_loop
+
+.Ltbss_done:
+    .byte 0xA9                            ; LDA #imm32
+    .long __tls_base
+    .byte 0x85, 0xE0                      ; STA dp $E0 (R56)
+
     ;
     ; Call C library initialization (constructors)
     ; In 32-bit mode, JSR is 5 bytes: opcode 0x20 + 32-bit address
@@ -1,16 +1,25 @@
 #!/bin/bash
 # run-m65832.sh - Execute M65832 ELF binary on emulator
-# Used by Meson as exe_wrapper for running picolibc tests
+# Used by Meson as exe_wrapper for running picolibc tests, and by
+# run-pool.sh. Each call runs its own emulator instance, so `meson test
+# --num-processes N` (or run-pool.sh -j N) runs N tests at once.
 #
 # Usage: run-m65832.sh <program.elf> [args...]
 #
+# Configuration (environment):
+#   M65832_EMU         emulator binary (default: m65832emu on PATH)
+#   M65832_MAX_CYCLES  cycle limit per run (default 1000000)
+#   M65832_CYCLE_LOG   append "<program> <cycles> <instructions>" per run
+#   M65832_BUDGETS     file of "<program name> <max cycles>" lines; a run
+#                      over its budget fails even if the program passed
+#
 # Returns: Exit code from program (stored at memory location 0xFFFFFFFC)
 
-EMU="/Users/benjamincooley/projects/M65832/emu/m65832emu"
-MAX_CYCLES=1000000
+EMU="${M65832_EMU:-$(command -v m65832emu)}"
+MAX_CYCLES="${M65832_MAX_CYCLES:-1000000}"
 
-if [ ! -x "$EMU" ]; then
-    echo "Error: Emulator not found at $EMU" >&2
+if [ -z "$EMU" ] || [ ! -x "$EMU" ]; then
+    echo "Error: emulator not found (set M65832_EMU or put m65832emu on PATH)" >&2
     exit 127
 fi
 
@@ -21,10 +30,11 @@ if [ ! -f "$PROG" ]; then
     echo "Error: Program not found: $PROG" >&2
     exit 127
 fi
+NAME="$(basename "$PROG" .elf)"
 
-# Run on emulator with cycle limit
-# The emulator loads ELF, runs until STP instruction, and reports exit code
-OUTPUT=$("$EMU" -c "$MAX_CYCLES" "$PROG" 2>&1)
+# Run on emulator with cycle limit. -s keeps the per-instruction trace
+# out of the output; scraping it dominated the run time.
+OUTPUT=$("$EMU" -c "$MAX_CYCLES" -s "$PROG" 2>&1)
 EMU_EXIT=$?
 
 # Check for emulator errors
@@ -34,22 +44,37 @@ if [ $EMU_EXIT -ne 0 ]; then
     exit $EMU_EXIT
 fi
 
-# Extract exit code from emulator output
-# The emulator reports: "Exit code: N" or we check A register at STP
-EXIT_CODE=$(echo "$OUTPUT" | grep -i "exit code:" | sed 's/.*exit code: *\([0-9]*\).*/\1/i')
+# The emulator reports "Exit code: N", "Cycles: N" and "Instructions: N"
+# after STP
+stat() {
+    echo "$OUTPUT" | sed -n "s/^$1: *\([0-9]*\).*/\1/ip" | tail -1
+}
+EXIT_CODE=$(stat "exit code")
+CYCLES=$(stat "cycles")
+INSNS=$(stat "instructions")
 
 if [ -z "$EXIT_CODE" ]; then
-    # Try to get A register value as exit code
-    EXIT_CODE=$(echo "$OUTPUT" | grep "A:" | tail -1 | sed 's/.*A: *\([0-9A-Fa-f]*\).*/\1/')
-    if [ -n "$EXIT_CODE" ]; then
-        # Convert hex to decimal
-        EXIT_CODE=$((16#$EXIT_CODE))
-    else
-        EXIT_CODE=0
-    fi
+    # No STP before the cycle limit
+    echo "$OUTPUT" | grep -v -i "^\(cycles\|instructions\):"
+    echo "Error: $NAME did not finish within $MAX_CYCLES cycles" >&2
+    exit 124
 fi
 
 # Output program output (if any)
-echo "$OUTPUT" | grep -v "^PC:" | grep -v "^Exit code:" | grep -v "^Cycles:"
+echo "$OUTPUT" | grep -v -i "^\(exit code\|cycles\|instructions\):"
+
+echo "m65832: $NAME cycles ${CYCLES:-?} instructions ${INSNS:-?}" >&2
+if [ -n "$M65832_CYCLE_LOG" ]; then
+    # One short line per O_APPEND write, so parallel runs do not interleave
+    echo "$NAME ${CYCLES:-0} ${INSNS:-0}" >> "$M65832_CYCLE_LOG"
+fi
+
+if [ -n "$M65832_BUDGETS" ] && [ -n "$CYCLES" ]; then
+    BUDGET=$(awk -v n="$NAME" '$1 == n { print $2 }' "$M65832_BUDGETS")
+    if [ -n "$BUDGET" ] && [ "$CYCLES" -gt "$BUDGET" ]; then
+        echo "CYCLE BUDGET EXCEEDED: $NAME took $CYCLES cycles, budget $BUDGET" >&2
+        [ "$EXIT_CODE" -eq 0 ] && EXIT_CODE=1
+    fi
+fi
 
 exit $EXIT_CODE
@@ -0,0 +1,80 @@
+#!/bin/bash
+# run-pool.sh - Run M65832 ELF tests on a pool of emulator instances
+# Runs every program through run-m65832.sh, -j at a time, then prints a
+# pass/fail summary and the cycle and instruction count of each test.
+#
+# Usage: run-pool.sh [-j jobs] [-b budgets] [-u margin%] <program.elf>...
+#   -j  emulator instances at once (default: number of CPUs)
+#   -b  cycle budget file (see run-m65832.sh); a test over budget fails
+#   -u  rewrite the budget file from this run, each test's cycles plus
+#       margin percent, instead of checking it
+#
+# The emulator is configured as for run-m65832.sh (M65832_EMU etc.).
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+JOBS=$(getconf _NPROCESSORS_ONLN 2>/dev/null || echo 4)
+BUDGETS=""
+UPDATE=""
+
+while getopts "j:b:u:" opt; do
+    case $opt in
+    j) JOBS="$OPTARG" ;;
+    b) BUDGETS="$OPTARG" ;;
+    u) UPDATE="$OPTARG" ;;
+    *) exit 2 ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+if [ $# -eq 0 ]; then
+    echo "usage: run-pool.sh [-j jobs] [-b budgets] [-u margin%] <program.elf>..." >&2
+    exit 2
+fi
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+export M65832_CYCLE_LOG="$WORK/cycles"
+if [ -n "$BUDGETS" ] && [ -z "$UPDATE" ]; then
+    export M65832_BUDGETS="$BUDGETS"
+fi
+
+# Each job leaves <name>.status and <name>.log behind
+run_one() {
+    name="$(basename "$1" .elf)"
+    "$SCRIPT_DIR/run-m65832.sh" "$1" > "$WORK/$name.log" 2>&1
+    echo $? > "$WORK/$name.status"
+}
+export -f run_one
+export SCRIPT_DIR WORK
+
+printf '%s\0' "$@" | xargs -0 -n 1 -P "$JOBS" bash -c 'run_one "$0"'
+
+PASSED=0
+FAILED=0
+for prog in "$@"; do
+    name="$(basename "$prog" .elf)"
+    status=$(cat "$WORK/$name.status" 2>/dev/null || echo 127)
+    if [ "$status" -eq 0 ]; then
+        PASSED=$((PASSED + 1))
+    else
+        FAILED=$((FAILED + 1))
+        echo "FAIL: $name (exit $status)"
+        sed 's/^/    /' "$WORK/$name.log"
+    fi
+done
+
+echo ""
+printf "%-32s %12s %12s\n" "test" "cycles" "instructions"
+sort "$M65832_CYCLE_LOG" 2>/dev/null | while read -r name cycles insns; do
+    printf "%-32s %12s %12s\n" "$name" "$cycles" "$insns"
+done
+echo ""
+echo "Results: $PASSED passed, $FAILED failed"
+
+if [ -n "$UPDATE" ] && [ -n "$BUDGETS" ]; then
+    sort "$M65832_CYCLE_LOG" |
+        awk -v m="$UPDATE" '{ printf "%s %d\n", $1, $2 + $2 * m / 100 }' > "$BUDGETS"
+    echo "Wrote budgets for $(wc -l < "$BUDGETS") tests to $BUDGETS"
+fi
+
+[ $FAILED -eq 0 ]
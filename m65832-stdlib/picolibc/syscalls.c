@@ -2,14 +2,22 @@
  *
  * These functions provide the minimal system interface required by picolibc.
  * For baremetal operation, most syscalls are stubs that return errors.
+ * Built with -DM65832_SEMIHOST, I/O, files, real time and exit go to the
+ * emulator through semihosting calls instead (see semihost.h).
  */
 
 #include <stdio.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <string.h>
 #include <unistd.h>
 #include <stdint.h>
+#include <sys/time.h>
+#include <sys/times.h>
+#include <time.h>
+#include "../libc/include/semihost.h"
 
 /* UART registers for console I/O (memory-mapped at 0x00FFF100) */
 #define UART_STATUS    (*(volatile uint32_t *)0x00FFF100)
@@ -20,29 +28,141 @@
 #define UART_TX_READY  0x01
 #define UART_RX_AVAIL  0x02
 
+/* System timer: 64-bit cycle counter, the high word latched when the low
+ * word is read (memory-mapped at 0x00FFF110) */
+#define TIMER_CYCLES_LO (*(volatile uint32_t *)0x00FFF110)
+#define TIMER_CYCLES_HI (*(volatile uint32_t *)0x00FFF114)
+
+#ifndef TIMER_HZ
+#define TIMER_HZ       50000000u
+#endif
+
 /* ============================================================================
  * STDIO Support - stdin/stdout/stderr via UART
  * ========================================================================= */
 
+/*
+ * Console output goes through a ring buffer. Each write hands the UART as
+ * many bytes as it will take without waiting and returns, so the CPU only
+ * waits at the baud rate when the ring is full or on fflush. uart_tx_isr
+ * keeps the ring draining between writes when it is installed as the
+ * UART's TX-ready interrupt handler.
+ */
+#define TX_BUF_SIZE    256      /* power of two */
+#define TX_MASK        (TX_BUF_SIZE - 1)
+
+static char tx_buf[TX_BUF_SIZE];
+
+#ifdef M65832_SEMIHOST
+/*
+ * Under semihosting the buffer is line-buffered stdout instead: each full
+ * line (or buffer) is one SEMIHOST_WRITE.
+ */
+static unsigned tx_len;
+
+static void tx_flush(void) {
+    if (tx_len) {
+        semihost_write(1, tx_buf, tx_len);
+        tx_len = 0;
+    }
+}
+
+/* Nothing to drain; kept for vector tables that name it */
+void __attribute__((interrupt)) uart_tx_isr(void) {
+}
+
+static void tx_put(char c) {
+    tx_buf[tx_len++] = c;
+    if (tx_len == TX_BUF_SIZE) {
+        tx_flush();
+    }
+}
+
 static int uart_putc(char c, FILE *file) {
     (void)file;
-    /* Wait for TX ready */
-    while (!(UART_STATUS & UART_TX_READY))
-        ;
-    UART_TX_DATA = (uint32_t)(unsigned char)c;
+    tx_put(c);
+    if (c == '\n') {
+        tx_flush();
+    }
     return (unsigned char)c;
 }
 
+static int uart_flush(FILE *file) {
+    (void)file;
+    tx_flush();
+    return 0;
+}
+
 static int uart_getc(FILE *file) {
+    unsigned char c;
+    /* Show any prompt before blocking for input */
+    uart_flush(file);
+    if (semihost_read(0, &c, 1) != 1) {
+        return EOF;
+    }
+    return c;
+}
+#else
+static volatile unsigned tx_head;   /* advanced by writers */
+static volatile unsigned tx_tail;   /* advanced by tx_pump */
+
+/* Move bytes from the ring to the UART while it is ready. The caller
+ * keeps uart_tx_isr out (by masking interrupts, or by being it). */
+static void tx_pump(void) {
+    unsigned tail = tx_tail;
+    while (tail != tx_head && (UART_STATUS & UART_TX_READY)) {
+        UART_TX_DATA = (uint32_t)(unsigned char)tx_buf[tail & TX_MASK];
+        tail++;
+    }
+    tx_tail = tail;
+}
+
+static void tx_pump_masked(void) {
+    asm volatile("php\n\tsei" ::: "memory");
+    tx_pump();
+    asm volatile("plp" ::: "memory");
+}
+
+void __attribute__((interrupt)) uart_tx_isr(void) {
+    tx_pump();
+}
+
+static void tx_put(char c) {
+    while (tx_head - tx_tail == TX_BUF_SIZE) {
+        tx_pump_masked();
+    }
+    tx_buf[tx_head & TX_MASK] = c;
+    tx_head++;
+}
+
+static int uart_putc(char c, FILE *file) {
+    (void)file;
+    tx_put(c);
+    tx_pump_masked();
+    return (unsigned char)c;
+}
+
+static int uart_flush(FILE *file) {
     (void)file;
+    while (tx_head != tx_tail) {
+        tx_pump_masked();
+    }
+    return 0;
+}
+
+static int uart_getc(FILE *file) {
+    /* Show any prompt before blocking for input */
+    uart_flush(file);
     /* Wait for RX available */
     while (!(UART_STATUS & UART_RX_AVAIL))
         ;
     return (int)(UART_RX_DATA & 0xFF);
 }
+#endif
 
 /* Create the stdio FILE structure */
-static FILE __stdio = FDEV_SETUP_STREAM(uart_putc, uart_getc, NULL, _FDEV_SETUP_RW);
+static FILE __stdio = FDEV_SETUP_STREAM(uart_putc, uart_getc, uart_flush,
+                                        _FDEV_SETUP_RW);
 
 /* Define stdin, stdout, stderr */
 #ifdef __strong_reference
@@ -56,68 +176,33 @@ STDIO_ALIAS(stdout);
 STDIO_ALIAS(stderr);
 
 /* ============================================================================
- * Compiler Runtime Support (64-bit arithmetic)
- * These are normally provided by compiler-rt/libgcc
+ * System Calls
  * ========================================================================= */
 
-/* 64-bit multiplication */
-uint64_t __muldi3(uint64_t a, uint64_t b) {
-    uint32_t al = (uint32_t)a;
-    uint32_t ah = (uint32_t)(a >> 32);
-    uint32_t bl = (uint32_t)b;
-    uint32_t bh = (uint32_t)(b >> 32);
-    
-    uint64_t result = (uint64_t)al * bl;
-    result += ((uint64_t)al * bh) << 32;
-    result += ((uint64_t)ah * bl) << 32;
-    return result;
-}
-
-/* 64-bit unsigned division */
-uint64_t __udivdi3(uint64_t num, uint64_t den) {
-    if (den == 0) return 0;  /* Avoid div by zero */
-    
-    uint64_t quot = 0;
-    int bits = 64;
-    
-    /* Simple bit-by-bit division */
-    while (bits-- > 0) {
-        quot <<= 1;
-        if (num >= den) {
-            num -= den;
-            quot |= 1;
-        }
-        den >>= 1;
+#ifdef M65832_SEMIHOST
+/* Sets errno from a failed call's -errno */
+static int semihost_result(int32_t ret) {
+    if (ret < 0) {
+        errno = -ret;
+        return -1;
     }
-    return quot;
-}
-
-/* 64-bit signed division */
-int64_t __divdi3(int64_t a, int64_t b) {
-    int neg = 0;
-    if (a < 0) { a = -a; neg = !neg; }
-    if (b < 0) { b = -b; neg = !neg; }
-    uint64_t result = __udivdi3((uint64_t)a, (uint64_t)b);
-    return neg ? -(int64_t)result : (int64_t)result;
+    return ret;
 }
 
-/* 64-bit unsigned modulo */
-uint64_t __umoddi3(uint64_t num, uint64_t den) {
-    return num - __udivdi3(num, den) * den;
-}
-
-/* 64-bit signed modulo */
-int64_t __moddi3(int64_t a, int64_t b) {
-    int neg = 0;
-    if (a < 0) { a = -a; neg = 1; }
-    if (b < 0) { b = -b; }
-    uint64_t result = __umoddi3((uint64_t)a, (uint64_t)b);
-    return neg ? -(int64_t)result : (int64_t)result;
+static uint32_t semihost_flags(int flags) {
+    uint32_t f;
+    switch (flags & O_ACCMODE) {
+    case O_WRONLY: f = SEMIHOST_O_WRONLY; break;
+    case O_RDWR:   f = SEMIHOST_O_RDWR; break;
+    default:       f = SEMIHOST_O_RDONLY; break;
+    }
+    if (flags & O_CREAT)  f |= SEMIHOST_O_CREAT;
+    if (flags & O_TRUNC)  f |= SEMIHOST_O_TRUNC;
+    if (flags & O_APPEND) f |= SEMIHOST_O_APPEND;
+    if (flags & O_EXCL)   f |= SEMIHOST_O_EXCL;
+    return f;
 }
-
-/* ============================================================================
- * System Calls
- * ========================================================================= */
+#endif
 
 /* Heap management */
 extern char _end[];           /* Set by linker - end of BSS */
@@ -154,6 +239,11 @@ void *_sbrk(ptrdiff_t incr) {
  * For baremetal, only stdout (1) and stderr (2) are supported via UART.
  */
 ssize_t _write(int fd, const void *buf, size_t len) {
+#ifdef M65832_SEMIHOST
+    /* Keep the order of what stdio has buffered */
+    tx_flush();
+    return semihost_result(semihost_write(fd, buf, len));
+#else
     if (fd != 1 && fd != 2) {
         errno = EBADF;
         return -1;
@@ -161,13 +251,12 @@ ssize_t _write(int fd, const void *buf, size_t len) {
     
     const char *p = buf;
     for (size_t i = 0; i < len; i++) {
-        /* Wait for transmit ready */
-        while (!(UART_STATUS & UART_TX_READY))
-            ;
-        UART_TX_DATA = (uint32_t)(unsigned char)p[i];
+        tx_put(p[i]);
     }
+    tx_pump_masked();
     
     return (ssize_t)len;
+#endif
 }
 
 /*
@@ -176,6 +265,12 @@ ssize_t _write(int fd, const void *buf, size_t len) {
  * For baremetal, only stdin (0) is supported via UART.
  */
 ssize_t _read(int fd, void *buf, size_t len) {
+#ifdef M65832_SEMIHOST
+    if (fd == 0) {
+        tx_flush();
+    }
+    return semihost_result(semihost_read(fd, buf, len));
+#else
     if (fd != 0) {
         errno = EBADF;
         return -1;
@@ -198,12 +293,34 @@ ssize_t _read(int fd, void *buf, size_t len) {
     }
     
     return (ssize_t)i;
+#endif
+}
+
+/* Defined when a -fprofile-generate program links the compiler-rt
+ * profile runtime (scripts/profraw_extract.sh turns the console log back
+ * into a .profraw file) */
+extern int __llvm_profile_write_hex(void (*put_char)(int))
+    __attribute__((weak));
+
+static void profile_putc(int c) {
+    tx_put((char)c);
 }
 
 /*
  * _exit - Terminate the program
  */
 void __attribute__((noreturn)) _exit(int status) {
+    /* Baremetal has no atexit profile dump, so stream it from here */
+    if (__llvm_profile_write_hex)
+        __llvm_profile_write_hex(profile_putc);
+
+    /* Let buffered console output reach the UART */
+    uart_flush(NULL);
+
+#ifdef M65832_SEMIHOST
+    semihost_exit(status);
+#endif
+
     /* For baremetal, we just store the exit status and halt.
      * Use a volatile write to prevent optimization. */
     volatile int *exit_code = (volatile int *)0xFFFFFFFC;
@@ -217,6 +334,24 @@ void __attribute__((noreturn)) _exit(int status) {
     __builtin_unreachable();
 }
 
+/*
+ * _open - Open a file
+ *
+ * Host files under semihosting; there is no filesystem otherwise.
+ */
+int _open(const char *name, int flags, int mode) {
+    (void)mode;
+#ifdef M65832_SEMIHOST
+    return semihost_result(semihost_open(name, strlen(name),
+                                         semihost_flags(flags)));
+#else
+    (void)name;
+    (void)flags;
+    errno = ENOENT;
+    return -1;
+#endif
+}
+
 /*
  * _close - Close a file descriptor
  */
@@ -224,8 +359,12 @@ int _close(int fd) {
     if (fd >= 0 && fd <= 2) {
         return 0;
     }
+#ifdef M65832_SEMIHOST
+    return semihost_result(semihost_close(fd));
+#else
     errno = EBADF;
     return -1;
+#endif
 }
 
 /*
@@ -236,8 +375,14 @@ int _fstat(int fd, struct stat *st) {
         st->st_mode = S_IFCHR;
         return 0;
     }
+#ifdef M65832_SEMIHOST
+    /* Any other descriptor is a host file */
+    st->st_mode = S_IFREG;
+    return 0;
+#else
     errno = EBADF;
     return -1;
+#endif
 }
 
 /*
@@ -247,7 +392,11 @@ int _isatty(int fd) {
     if (fd >= 0 && fd <= 2) {
         return 1;
     }
+#ifdef M65832_SEMIHOST
+    errno = ENOTTY;
+#else
     errno = EBADF;
+#endif
     return 0;
 }
 
@@ -255,6 +404,11 @@ int _isatty(int fd) {
  * _lseek - Seek in a file
  */
 off_t _lseek(int fd, off_t offset, int whence) {
+#ifdef M65832_SEMIHOST
+    if (fd > 2) {
+        return semihost_result(semihost_lseek(fd, (int32_t)offset, whence));
+    }
+#endif
     (void)fd;
     (void)offset;
     (void)whence;
@@ -278,3 +432,73 @@ int _kill(pid_t pid, int sig) {
 pid_t _getpid(void) {
     return 1;
 }
+
+/* ============================================================================
+ * Time - all clocks count CPU cycles from reset
+ * ========================================================================= */
+
+static uint64_t cycles(void) {
+#if __has_builtin(__m65832_cycles)
+    return __m65832_cycles();
+#else
+    uint32_t lo = TIMER_CYCLES_LO;
+    return (uint64_t)TIMER_CYCLES_HI << 32 | lo;
+#endif
+}
+
+/*
+ * _times - Get process times, in CLOCKS_PER_SEC ticks (what clock() uses)
+ */
+clock_t _times(struct tms *buf) {
+    clock_t t = (clock_t)(cycles() / (TIMER_HZ / CLOCKS_PER_SEC));
+    if (buf) {
+        buf->tms_utime = t;
+        buf->tms_stime = 0;
+        buf->tms_cutime = 0;
+        buf->tms_cstime = 0;
+    }
+    return t;
+}
+
+clock_t times(struct tms *buf) {
+    return _times(buf);
+}
+
+/*
+ * clock_gettime - Every clock id reads the cycle counter, except that
+ * CLOCK_REALTIME is the host's time under semihosting
+ */
+int clock_gettime(clockid_t clk, struct timespec *tp) {
+#ifdef M65832_SEMIHOST
+    if (clk == CLOCK_REALTIME) {
+        uint32_t sec, nsec;
+        if (semihost_result(semihost_clock(&sec, &nsec)) < 0) {
+            return -1;
+        }
+        tp->tv_sec = (time_t)sec;
+        tp->tv_nsec = (long)nsec;
+        return 0;
+    }
+#else
+    (void)clk;
+#endif
+    uint64_t c = cycles();
+    uint64_t sec = c / TIMER_HZ;
+    uint32_t rem = (uint32_t)(c - sec * TIMER_HZ);
+    tp->tv_sec = (time_t)sec;
+    tp->tv_nsec = (long)((uint64_t)rem * 1000000000u / TIMER_HZ);
+    return 0;
+}
+
+int gettimeofday(struct timeval *tv, void *tz) {
+    (void)tz;
+    struct timespec ts;
+#ifdef M65832_SEMIHOST
+    clock_gettime(CLOCK_REALTIME, &ts);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    tv->tv_sec = ts.tv_sec;
+    tv->tv_usec = ts.tv_nsec / 1000;
+    return 0;
+}
@@ -0,0 +1,44 @@
+#!/bin/bash
+# Pull a -fprofile-generate profile out of an emulator or UART log
+# A program linked with the compiler-rt profile runtime (built with
+# COMPILER_RT_PROFILE_BAREMETAL) streams its raw profile as hex from _exit,
+# between "--- llvm-profraw begin ---" and "--- llvm-profraw end ---"
+# lines (see __llvm_profile_write_hex). This writes the bytes back out as
+# a .profraw file for llvm-profdata merge.
+#
+# Usage: profraw_extract.sh <console.log> <out.profraw>
+#   Several dumps in one log (one per run) are written as out.1.profraw,
+#   out.2.profraw, ...
+
+if [ $# -ne 2 ]; then
+	echo "usage: profraw_extract.sh <console.log> <out.profraw>" >&2
+	exit 2
+fi
+LOG="$1"
+OUT="$2"
+
+# One line of hex per dump
+DUMPS=$(awk '
+	{ sub(/\r$/, "") }
+	/^--- llvm-profraw begin ---$/ { inside = 1; hex = ""; next }
+	/^--- llvm-profraw end ---$/ { if (inside) print hex; inside = 0; next }
+	inside { gsub(/[^0-9a-f]/, ""); hex = hex $0 }
+' "$LOG")
+
+if [ -z "$DUMPS" ]; then
+	echo "error: no profile dump in $LOG" >&2
+	exit 1
+fi
+
+COUNT=$(echo "$DUMPS" | wc -l)
+N=0
+echo "$DUMPS" | while read -r HEX; do
+	N=$((N + 1))
+	if [ "$COUNT" -eq 1 ]; then
+		FILE="$OUT"
+	else
+		FILE="${OUT%.profraw}.$N.profraw"
+	fi
+	echo "$HEX" | perl -ne 'chomp; print pack("H*", $_)' > "$FILE"
+	echo "$FILE: $(( ${#HEX} / 2 )) bytes"
+done
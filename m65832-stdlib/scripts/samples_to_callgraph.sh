@@ -0,0 +1,115 @@
+#!/bin/bash
+# Turn emulator branch samples into an lld call-graph ordering file
+# This reorders functions of a final image at link time, including those
+# in prebuilt libraries that cannot be rebuilt with a profile:
+#   ld.lld --call-graph-ordering-file=<out> ...
+# lld places each caller next to its hottest callees (the same sort
+# -fprofile-use gets from .llvm.call-graph-profile). Functions move one
+# input section at a time, so code built with -ffunction-sections reorders
+# function by function; an object without it moves as a whole.
+#
+# Usage: samples_to_callgraph.sh <program.elf> <samples> <out>
+#   NM  llvm-nm to use
+#
+# Samples are the B and T records of samples_to_profgen.sh (addresses in
+# hex, anything else ignored):
+#   B <from> <to>   taken branch, jump, call, return or interrupt
+#   T <pc>          executed instruction, in execution order
+# An edge is a transfer from one function to the first instruction of
+# another: a call or a tail call. Returns land inside their caller and are
+# not counted.
+
+LLVM_BUILD="${LLVM_BUILD:-/Users/benjamincooley/projects/llvm-m65832/build-fast}"
+NM="${NM:-$LLVM_BUILD/bin/llvm-nm}"
+
+if [ $# -ne 3 ]; then
+	echo "usage: samples_to_callgraph.sh <program.elf> <samples> <out>" >&2
+	exit 2
+fi
+ELF="$1"
+SAMPLES="$2"
+OUT="$3"
+
+# Defined functions as "F <addr> <size> <name>", by address
+"$NM" -n -S --defined-only "$ELF" | awk '
+	NF == 4 && ($3 == "t" || $3 == "T" || $3 == "w" || $3 == "W") {
+		print "F " $1 " " $2 " " $4
+	}
+' | awk -v out="$OUT" '
+	BEGIN { nf = ne = 0 }
+	function norm(a) {
+		a = tolower(a)
+		sub(/^0x/, "", a)
+		sub(/^0+/, "", a)
+		return a == "" ? "0" : a
+	}
+	function hex(a,    i, n, c) {
+		n = 0
+		a = tolower(a)
+		sub(/^0x/, "", a)
+		for (i = 1; i <= length(a); i++) {
+			c = index("0123456789abcdef", substr(a, i, 1))
+			if (!c)
+				return -1
+			n = n * 16 + c - 1
+		}
+		return n
+	}
+	# Index of the function containing addr, or -1
+	function lookup(addr,    lo, hi, mid) {
+		lo = 0
+		hi = nf - 1
+		while (lo <= hi) {
+			mid = int((lo + hi) / 2)
+			if (addr < start[mid])
+				hi = mid - 1
+			else if (addr >= start[mid] + size[mid])
+				lo = mid + 1
+			else
+				return mid
+		}
+		return -1
+	}
+	function transfer(from, to,    f, t, key) {
+		f = lookup(hex(from))
+		t = lookup(hex(to))
+		if (f < 0 || t < 0 || f == t || hex(to) != start[t])
+			return
+		key = name[f] " " name[t]
+		if (!(key in count))
+			order[ne++] = key
+		count[key]++
+	}
+	# Symbols from stdin, then the samples
+	FILENAME == "-" {
+		if (hex($3) <= 0)
+			next
+		start[nf] = hex($2)
+		size[nf] = hex($3)
+		name[nf] = $4
+		nf++
+		next
+	}
+	{ sub(/\r$/, "") }
+	$1 == "B" && NF >= 3 { transfer(norm($2), norm($3)); next }
+	$1 == "T" && NF >= 2 {
+		pc = norm($2)
+		if (last != "")
+			transfer(last, pc)
+		last = pc
+		next
+	}
+	END {
+		if (!nf) {
+			print "error: no sized function symbols in the image" > "/dev/stderr"
+			exit 1
+		}
+		if (!ne) {
+			print "error: no calls in " FILENAME > "/dev/stderr"
+			exit 1
+		}
+		for (k = 0; k < ne; k++)
+			printf "%s %d\n", order[k], count[order[k]] > out
+		print out ": " ne " call edges between " nf " functions" > "/dev/stderr"
+	}
+' - "$SAMPLES"
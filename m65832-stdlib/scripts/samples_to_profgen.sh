@@ -0,0 +1,129 @@
+#!/bin/bash
+# Turn emulator PC or branch samples into llvm-profgen input (AutoFDO)
+# The output is read by llvm-profgen --binary <program.elf>, which
+# disassembles the image and maps the samples to source lines, and the
+# .prof it writes goes to clang -fprofile-sample-use. Build with -g (line
+# tables) for this. The image runs where it was linked, so profgen's
+# "No relevant mmap event" warning is expected.
+#
+# Usage: samples_to_profgen.sh [-d depth] <program.elf> <samples> <out>
+#   -d       branches per sample in the perf script (default 16)
+#   OBJDUMP  llvm-objdump to use (only for T records)
+#
+# Sample format, one record per line, addresses in hex (0x optional),
+# anything else (emulator or program output) is ignored:
+#   B <from> <to>   taken branch, jump, call, return or interrupt
+#   T <pc>          executed instruction, in execution order; taken
+#                   branches are found against the disassembly
+#   P <pc>          PC sample (statistical, no branch information)
+#
+# B and T records give a perf script of LBR-style samples:
+#   llvm-profgen --binary prog.elf --perfscript <out> --output prog.prof
+# Consecutive samples share one branch so that no fall-through range is
+# lost. P records alone give an unsymbolized profile, counting each
+# sampled PC as a one-instruction range:
+#   llvm-profgen --binary prog.elf --unsymbolized-profile <out> \
+#                --use-offset=0 --output prog.prof
+
+LLVM_BUILD="${LLVM_BUILD:-/Users/benjamincooley/projects/llvm-m65832/build-fast}"
+OBJDUMP="${OBJDUMP:-$LLVM_BUILD/bin/llvm-objdump}"
+DEPTH=16
+
+while getopts "d:" opt; do
+	case $opt in
+	d) DEPTH="$OPTARG" ;;
+	*) exit 2 ;;
+	esac
+done
+shift $((OPTIND - 1))
+
+if [ $# -ne 3 ] || [ "$DEPTH" -lt 2 ] 2>/dev/null; then
+	echo "usage: samples_to_profgen.sh [-d depth] <program.elf> <samples> <out>" >&2
+	exit 2
+fi
+ELF="$1"
+SAMPLES="$2"
+OUT="$3"
+
+# Instruction addresses in order, for finding the taken branches in a T
+# trace ("A <addr>" per instruction, "S" between sections)
+disasm() {
+	if grep -q '^T ' "$SAMPLES"; then
+		"$OBJDUMP" -d --no-show-raw-insn "$ELF" | awk '
+			/^Disassembly of section/ { print "S" }
+			/^ *[0-9a-f]+:/ { sub(/:.*/, ""); print "A " $1 }
+		'
+	fi
+}
+
+disasm | awk -v depth="$DEPTH" -v out="$OUT" '
+	BEGIN { nb = np = nw = 0 }
+	function norm(a) {
+		a = tolower(a)
+		sub(/^0x/, "", a)
+		sub(/^0+/, "", a)
+		return a == "" ? "0" : a
+	}
+	function branch(from, to) {
+		src[nb] = from
+		dst[nb] = to
+		nb++
+	}
+	# Disassembly from stdin, then the samples
+	FILENAME == "-" {
+		if ($1 == "S")
+			prev = ""
+		else {
+			if (prev != "")
+				next_insn[prev] = norm($2)
+			prev = norm($2)
+		}
+		next
+	}
+	{ sub(/\r$/, "") }
+	$1 == "B" && NF >= 3 { branch(norm($2), norm($3)); next }
+	$1 == "T" && NF >= 2 {
+		pc = norm($2)
+		if (last != "" && next_insn[last] != pc)
+			branch(last, pc)
+		last = pc
+		next
+	}
+	$1 == "P" && NF >= 2 { pcs[norm($2)]++; np++; next }
+	END {
+		if (nb) {
+			if (np)
+				print "note: " np " P samples ignored, B/T records used" > "/dev/stderr"
+			# Windows of depth branches, newest first, each starting at the
+			# last branch of the previous one
+			for (i = 0; i < nb; i += depth - 1) {
+				end = i + depth - 1
+				if (end >= nb)
+					end = nb - 1
+				line = " " dst[end]
+				for (j = end; j >= i; j--)
+					line = line " 0x" src[j] "/0x" dst[j] "/P/-/-/0"
+				if (!(line in count))
+					order[nw++] = line
+				count[line]++
+				if (end == nb - 1)
+					break
+			}
+			for (k = 0; k < nw; k++)
+				printf "%d\n%s\n", count[order[k]], order[k] > out
+			print out ": perf script, " nb " branches in " nw " distinct samples" > "/dev/stderr"
+		} else if (np) {
+			n = 0
+			for (pc in pcs)
+				n++
+			print n > out
+			for (pc in pcs)
+				print pc "-" pc ":" pcs[pc] > out
+			print 0 > out
+			print out ": unsymbolized profile, " np " PC samples at " n " addresses" > "/dev/stderr"
+		} else {
+			print "error: no branches or PC samples in " FILENAME > "/dev/stderr"
+			exit 1
+		}
+	}
+' - "$SAMPLES"
@@ -0,0 +1,130 @@
+#!/bin/bash
+# Worst-case stack depth from -fstack-usage output and the call graph
+# Each function's own usage comes from the .su files written by
+# clang -fstack-usage (frame, pushed registers and return address, see
+# M65832FrameLowering::getStackUsage); calls come from disassembling the
+# linked image. Prints the deepest call chain from each entry point.
+#
+# Usage: stack_depth.sh [-e entry]... <program.elf> <file.su>...
+#   -e  entry point to report (default _start); repeat for interrupt
+#       handlers, which run on top of whatever they interrupt
+#   OBJDUMP  llvm-objdump to use
+#
+# Functions with no .su entry (assembly) count as 0 and are listed. A
+# chain through an indirect call or recursion is a lower bound and is
+# marked as such.
+
+LLVM_BUILD="${LLVM_BUILD:-/Users/benjamincooley/projects/llvm-m65832/build-fast}"
+OBJDUMP="${OBJDUMP:-$LLVM_BUILD/bin/llvm-objdump}"
+ENTRIES=()
+
+while getopts "e:" opt; do
+	case $opt in
+	e) ENTRIES+=("$OPTARG") ;;
+	*) exit 2 ;;
+	esac
+done
+shift $((OPTIND - 1))
+
+if [ $# -lt 2 ]; then
+	echo "usage: stack_depth.sh [-e entry]... <program.elf> <file.su>..." >&2
+	exit 2
+fi
+ELF="$1"
+shift
+[ ${#ENTRIES[@]} -eq 0 ] && ENTRIES=(_start)
+
+# "S <func> <bytes> <static|dynamic>" per .su line, then "F <func>" per
+# function, "C <caller> <callee>" per direct call or tail jump and
+# "I <caller>" per indirect call
+{
+	cat "$@" | awk -F'\t' 'NF >= 2 {
+		n = split($1, part, ":")
+		print "S", part[n], $2, $3
+	}'
+	"$OBJDUMP" -d --no-show-raw-insn "$ELF" | awk '
+	/^[0-9a-fA-F]+ <[^>]+>:$/ {
+		fn = $2; gsub(/[<>:]/, "", fn)
+		print "F", fn
+		next
+	}
+	fn != "" && /[ \t](JSR|JMP|BRL)[ \t]/ {
+		if (match($0, /<[^>+]+>/)) {
+			callee = substr($0, RSTART + 1, RLENGTH - 2)
+			# A jump to the function'"'"'s own start is a loop, a JSR to
+			# it is recursion
+			if (callee != fn || $0 ~ /JSR/)
+				print "C", fn, callee
+		} else if ($0 ~ /(JSR|JMP)[ \t]+\(/)
+			print "I", fn
+	}'
+} | awk -v entries="${ENTRIES[*]}" '
+$1 == "S" { own[$2] = $3; if ($4 == "dynamic") dyn[$2] = 1; known[$2] = 1 }
+$1 == "F" { func[$2] = 1 }
+$1 == "C" {
+	if (!(($2, $3) in seen)) {
+		seen[$2, $3] = 1
+		calls[$2] = calls[$2] " " $3
+	}
+}
+$1 == "I" { indirect[$2] = 1 }
+
+# Deepest usage below f, memoized; a function reached again while it is
+# still on the chain is recursion
+function depth(f,    n, c, i, d, best) {
+	if (f in memo)
+		return memo[f]
+	if (active[f]) {
+		recursive[f] = 1
+		return 0
+	}
+	active[f] = 1
+	best = 0
+	next_of[f] = ""
+	n = split(calls[f], c, " ")
+	for (i = 1; i <= n; i++) {
+		d = depth(c[i])
+		if (d > best || next_of[f] == "") {
+			best = d
+			next_of[f] = c[i]
+		}
+	}
+	active[f] = 0
+	if (!(f in known) && (f in func))
+		unknown[f] = 1
+	memo[f] = own[f] + best
+	return memo[f]
+}
+
+END {
+	n = split(entries, e, " ")
+	for (i = 1; i <= n; i++) {
+		if (!(e[i] in func)) {
+			printf "%s: not in the image\n", e[i]
+			continue
+		}
+		total = depth(e[i])
+		flags = ""
+		chain = ""
+		delete shown
+		for (f = e[i]; f != "" && !(f in shown); f = next_of[f]) {
+			shown[f] = 1
+			chain = chain sprintf("  %-32s %6d%s\n", f, own[f], \
+			    (f in unknown) ? "  (no .su entry)" : \
+			    dyn[f] ? "  (dynamic)" : "")
+			if (indirect[f]) flags = flags " indirect-call"
+			if (recursive[f]) flags = flags " recursion"
+			if (dyn[f]) flags = flags " dynamic"
+		}
+		printf "%s: %d bytes%s\n", e[i], total, \
+		    flags != "" ? " (lower bound:" flags ")" : ""
+		printf "%s", chain
+	}
+	first = 1
+	for (f in unknown) {
+		if (first) printf "\nNo .su entry (counted as 0):"
+		printf " %s", f
+		first = 0
+	}
+	if (!first) printf "\n"
+}'
@@ -10,33 +10,25 @@
 /* Main function - provided by user program */
 int main(void);
 
-/* Linker-provided symbols (weak so we can compile without linker script) */
-extern char __bss_start[] __attribute__((weak));
-extern char __bss_end[] __attribute__((weak));
+/* libc */
+void exit(int status) __attribute__((noreturn));
 
-/* Initialize BSS to zero */
-static void init_bss(void) {
-    char *p = __bss_start;
-    while (p < __bss_end) {
-        *p++ = 0;
-    }
-}
+/* Copies .data and zeroes .bss from the linker's tables (init.c) */
+void __init_ram(void);
 
 /* Entry point */
 __attribute__((section(".text.startup"), noreturn))
 void _start(void) {
     /* Set up stack - done by reset vector or bootloader */
     
-    /* Initialize BSS */
-    init_bss();
+    /* Global pointer for small data (.sdata/.sbss) accesses */
+    asm volatile("lda #__global_pointer$\n\tsta R28" ::: "a");
     
-    /* Call main */
-    int ret = main();
-    (void)ret;
+    /* Initialize .data and .bss */
+    __init_ram();
     
-    /* Halt processor */
-    asm volatile("stp");
-    __builtin_unreachable();
+    /* Call main; exit flushes stdout and halts */
+    exit(main());
 }
 
 /* Platform hooks for stdlib */
@@ -2,7 +2,7 @@
 ;
 ; Entry point for bare metal C programs. This file:
 ; 1. Sets up the stack pointer
-; 2. Initializes BSS to zero
+; 2. Copies .data from ROM and zeroes .bss (linker's copy/zero tables)
 ; 3. Calls global constructors
 ; 4. Calls main()
 ; 5. Calls global destructors
@@ -20,8 +20,11 @@ _start:
 	; Set up software stack pointer (frame pointer R29)
 	LD.L	R29,#__stack_top
 	
-	; Initialize BSS section to zero
-	JSR	B+__init_bss
+	; Set up global pointer R28 (base of .sdata/.sbss accesses)
+	LD.L	R28,#__global_pointer$
+	
+	; Copy .data and zero .bss from the tables ld.lld generates
+	JSR	B+__init_ram
 	
 	; Call global constructors (__init_array)
 	JSR	B+__libc_init_array
@@ -47,28 +50,6 @@ _start:
 	.size	_start, .Lfunc_end_start-_start
 
 
-; Initialize BSS section to zero
-	.globl	__init_bss
-	.type	__init_bss,@function
-__init_bss:
-	LD.L	R0,#__bss_start
-	LD.L	R1,#__bss_end
-	CMPR	R0,R1
-	BCS	.bss_done
-	LD.L	R2,#$00
-.bss_loop:
-	LDY	#$00
-	LDA	R2
-	STA	(R0),Y
-	INC	R0
-	CMPR	R0,R1
-	BCC	.bss_loop
-.bss_done:
-	RTS
-.Lfunc_end_init_bss:
-	.size	__init_bss, .Lfunc_end_init_bss-__init_bss
-
-
 ; sys_exit - halt processor with exit code in A
 	.globl	sys_exit
 	.type	sys_exit,@function
@@ -123,8 +104,6 @@ __heap_ptr:
 
 
 ; Weak default symbols (overridden by linker)
-	.weak	__bss_start
-	.weak	__bss_end
 	.weak	__stack_top
 	.weak	__heap_start
 	.weak	__heap_end
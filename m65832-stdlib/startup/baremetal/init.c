@@ -1,6 +1,22 @@
 /* init.c - Baremetal initialization/finalization for M65832 */
 
 #include <stddef.h>
+#include <stdint.h>
+
+/* RAM initialization tables (generated by ld.lld, see .copy_table) */
+struct copy_entry {
+    const uint32_t *load;   /* LMA, in ROM */
+    uint32_t *start;        /* VMA */
+    uint32_t size;          /* bytes */
+};
+struct zero_entry {
+    uint32_t *start;
+    uint32_t size;
+};
+extern const struct copy_entry __copy_table_start[];
+extern const struct copy_entry __copy_table_end[];
+extern const struct zero_entry __zero_table_start[];
+extern const struct zero_entry __zero_table_end[];
 
 /* Constructor/destructor array boundaries (provided by linker) */
 extern void (*__init_array_start[])(void);
@@ -8,6 +24,66 @@ extern void (*__init_array_end[])(void);
 extern void (*__fini_array_start[])(void);
 extern void (*__fini_array_end[])(void);
 
+/* Copy n bytes for __init_ram. Bytes until dst is word aligned, then
+ * 16 bytes per iteration, then single words and a byte tail. When src
+ * and dst can never both be aligned the whole run goes through MVN. */
+static void init_copy(uint8_t *dst, const uint8_t *src, uint32_t n) {
+    if (((uintptr_t)dst ^ (uintptr_t)src) & 3) {
+        if (n)
+            __builtin_memcpy(dst, src, n);
+        return;
+    }
+    for (; n && ((uintptr_t)dst & 3); n--)
+        *dst++ = *src++;
+    uint32_t *d = (uint32_t *)dst;
+    const uint32_t *s = (const uint32_t *)src;
+    for (; n >= 16; n -= 16, d += 4, s += 4) {
+        d[0] = s[0];
+        d[1] = s[1];
+        d[2] = s[2];
+        d[3] = s[3];
+    }
+    for (; n >= 4; n -= 4)
+        *d++ = *s++;
+    dst = (uint8_t *)d;
+    src = (const uint8_t *)s;
+    while (n--)
+        *dst++ = *src++;
+}
+
+/* Clear n bytes for __init_ram, with the same head/body/tail split */
+static void init_zero(uint8_t *dst, uint32_t n) {
+    for (; n && ((uintptr_t)dst & 3); n--)
+        *dst++ = 0;
+    uint32_t *d = (uint32_t *)dst;
+    for (; n >= 16; n -= 16, d += 4) {
+        d[0] = 0;
+        d[1] = 0;
+        d[2] = 0;
+        d[3] = 0;
+    }
+    for (; n >= 4; n -= 4)
+        *d++ = 0;
+    dst = (uint8_t *)d;
+    while (n--)
+        *dst++ = 0;
+}
+
+/* Copy .data from ROM and clear .bss. Sections already at their load
+ * address (RAM-only images) are skipped. */
+void __init_ram(void) {
+    for (const struct copy_entry *e = __copy_table_start;
+         e < __copy_table_end; e++) {
+        if (e->load == e->start)
+            continue;
+        init_copy((uint8_t *)e->start, (const uint8_t *)e->load, e->size);
+    }
+
+    for (const struct zero_entry *e = __zero_table_start;
+         e < __zero_table_end; e++)
+        init_zero((uint8_t *)e->start, e->size);
+}
+
 /* Call all global constructors */
 void __libc_init_array(void) {
     size_t count = __init_array_end - __init_array_start;
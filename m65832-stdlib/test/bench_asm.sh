@@ -0,0 +1,55 @@
+#!/bin/bash
+# Integrated assembler throughput benchmark
+# Writes a large synthetic .s in the style of crt0.s and the hand-written
+# routines, then times llvm-mc assembling it to an object file.
+#
+# Usage: bench_asm.sh [llvm-mc] [copies]
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+STDLIB_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$STDLIB_DIR/build"
+
+MC="${1:-/Users/benjamincooley/projects/llvm-m65832/build-fast/bin/llvm-mc}"
+COPIES="${2:-20000}"
+SRC="$BUILD_DIR/bench_asm.s"
+
+mkdir -p "$BUILD_DIR"
+
+# One block per copy: constants in every operand syntax the parser takes,
+# symbolic operands, local branches and data.
+{
+	echo "	.text"
+	for ((i = 0; i < COPIES; i++)); do
+		cat <<BLOCK
+	.globl	f$i
+	.type	f$i,@function
+f$i:
+	LD.L	R0,#\$00001234
+	LD.L	R1,#(16*4+3)
+	LD.L	R2,#__bench_data
+	LDY	#\$00
+.Lloop$i:
+	LDA	(R2),Y
+	CLC
+	ADC	#\$000000FF
+	STA	R3
+	ADC.L	R0,R1
+	CMPR	R0,R1
+	LDA	B+\$0100
+	STA	B+__bench_data
+	INC	R1
+	DEC	R0
+	BNE	.Lloop$i
+	JSR	B+f0
+	RTS
+.Lend$i:
+	.size	f$i, .Lend$i-f$i
+BLOCK
+	done
+	echo "	.data"
+	echo "__bench_data:"
+	echo "	.long	0"
+} > "$SRC"
+
+echo "Assembling $COPIES blocks ($(wc -l < "$SRC") lines)"
+time "$MC" -triple=m65832 -filetype=obj "$SRC" -o "$BUILD_DIR/bench_asm.o"
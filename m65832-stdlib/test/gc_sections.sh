@@ -0,0 +1,88 @@
+#!/bin/bash
+# --gc-sections size check
+# Builds a program where main uses one of two otherwise identical functions,
+# each with a constant pool, a switch jump table and its own data, and checks
+# that ld.lld drops the unused one along with its .rodata.<name> and
+# .data.<name> sections.
+#
+# Usage: gc_sections.sh [llvm build dir]
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+STDLIB_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$STDLIB_DIR/build/gc"
+
+LLVM_BUILD="${1:-/Users/benjamincooley/projects/llvm-m65832/build-fast}"
+CC="$LLVM_BUILD/bin/clang"
+LD="$LLVM_BUILD/bin/ld.lld"
+NM="$LLVM_BUILD/bin/llvm-nm"
+SIZE="$LLVM_BUILD/bin/llvm-size"
+CFLAGS="-target m65832 -O2 -ffreestanding -nostdlib -ffunction-sections -fdata-sections"
+
+mkdir -p "$BUILD_DIR"
+
+# One function per name, with a float constant (pool entry), a dense switch
+# (jump table) and a table in .data
+{
+	for name in used unused; do
+		cat <<FUNC
+int ${name}_table[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+float ${name}_scale(float x) { return x * 3.25f + 0.5f; }
+int ${name}_pick(int i) {
+	switch (i) {
+	case 0: return ${name}_table[1] * 11;
+	case 1: return ${name}_table[2] + 7;
+	case 2: return ${name}_table[3] - 5;
+	case 3: return ${name}_table[4] ^ 3;
+	case 4: return ${name}_table[5] << 2;
+	case 5: return ${name}_table[6] | 9;
+	default: return 0;
+	}
+}
+FUNC
+	done
+	cat <<MAIN
+volatile int sink;
+void _start(void) {
+	sink = used_pick(sink) + (int)used_scale((float)sink);
+	for (;;)
+		;
+}
+MAIN
+} > "$BUILD_DIR/gc.c"
+
+"$CC" $CFLAGS -c "$BUILD_DIR/gc.c" -o "$BUILD_DIR/gc.o" || exit 1
+"$LD" -o "$BUILD_DIR/nogc.elf" "$BUILD_DIR/gc.o" || exit 1
+"$LD" --gc-sections --print-gc-sections -o "$BUILD_DIR/gc.elf" \
+	"$BUILD_DIR/gc.o" > "$BUILD_DIR/gc.log" 2>&1 || exit 1
+
+FAILED=0
+for sym in unused_table unused_scale unused_pick; do
+	if "$NM" "$BUILD_DIR/gc.elf" | grep -qw "$sym"; then
+		echo "FAIL: $sym survived --gc-sections"
+		FAILED=1
+	fi
+done
+for sym in used_table used_scale used_pick; do
+	if ! "$NM" "$BUILD_DIR/gc.elf" | grep -qw "$sym"; then
+		echo "FAIL: $sym was collected"
+		FAILED=1
+	fi
+done
+# The pools are what used to stay behind in the shared .rodata
+for sec in .rodata.unused_scale .rodata.unused_pick .data.unused_table; do
+	if ! grep -qF "($sec)" "$BUILD_DIR/gc.log"; then
+		echo "FAIL: $sec not removed"
+		FAILED=1
+	fi
+done
+
+before=$("$SIZE" -A "$BUILD_DIR/nogc.elf" | awk '/^Total/ { print $2 }')
+after=$("$SIZE" -A "$BUILD_DIR/gc.elf" | awk '/^Total/ { print $2 }')
+echo "Size without --gc-sections: $before, with: $after"
+if [ "$after" -ge "$before" ]; then
+	echo "FAIL: --gc-sections did not shrink the image"
+	FAILED=1
+fi
+
+[ $FAILED -eq 0 ] && echo "PASS"
+exit $FAILED
@@ -15,6 +15,9 @@ EMU="/Users/benjamincooley/projects/m65832/emu/m65832emu"
 # Use picolibc sysroot for 32-bit mode support
 SYSROOT="/Users/benjamincooley/projects/m65832-sysroot"
 
+# compiler-rt builtins (64-bit divide, soft-float libcalls)
+BUILTINS="$SYSROOT/lib/libclang_rt.builtins-m65832.a"
+
 # Colors
 RED='\033[0;31m'
 GREEN='\033[0;32m'
@@ -55,7 +58,7 @@ compile_test() {
         -o "$test_elf" \
         "$SYSROOT/lib/crt0.o" \
         "$test_obj" \
-        -L"$SYSROOT/lib" -lc -lsys 2>&1
+        -L"$SYSROOT/lib" -lc -lsys "$BUILTINS" 2>&1
     
     if [ $? -ne 0 ]; then
         return 1
@@ -1,6 +1,9 @@
 /* test_stdlib.c - Comprehensive stdlib.h tests */
 #include <stdlib.h>
 #include <string.h>
+#include <mempool.h>
+#include <sort.h>
+#include <ring.h>
 
 /* Test result tracking */
 static int tests_passed = 0;
@@ -67,6 +70,24 @@ void test_strtol(void) {
     
     strtol("   -42xyz", &end, 10);
     TEST("strtol space end", *end == 'x');
+
+    /* Out of range clamps; long digit runs take the four-digit blocks */
+    TEST("strtol max", strtol("2147483647", &end, 10) == 2147483647L);
+    TEST("strtol min", strtol("-2147483648", &end, 10) == -2147483647L - 1);
+    TEST("strtol overflow", strtol("2147483648", &end, 10) == 2147483647L);
+    TEST("strtol underflow",
+         strtol("-99999999999", &end, 10) == -2147483647L - 1);
+    TEST("strtol overflow end", *end == '\0');
+    TEST("strtol hex overflow", strtol("0x100000000", &end, 0) == 2147483647L);
+    TEST("strtol leading zeros",
+         strtol("00000000000000000042", &end, 10) == 42);
+
+    /* No digits consumes nothing */
+    const char *bad = "  -x";
+    strtol(bad, &end, 10);
+    TEST("strtol no digits", end == bad);
+    strtol("0xg", &end, 16);
+    TEST("strtol bare 0x", *end == 'x');
 }
 
 /* Test strtoul */
@@ -76,6 +97,10 @@ void test_strtoul(void) {
     TEST("strtoul positive", strtoul("123", &end, 10) == 123UL);
     TEST("strtoul hex", strtoul("DEADBEEF", &end, 16) == 0xDEADBEEFUL);
     TEST("strtoul large", strtoul("4000000000", &end, 10) == 4000000000UL);
+    TEST("strtoul max", strtoul("4294967295", &end, 10) == 4294967295UL);
+    TEST("strtoul overflow", strtoul("4294967296", &end, 10) == 4294967295UL);
+    TEST("strtoul negative", strtoul("-1", &end, 10) == 4294967295UL);
+    TEST("strtoul base 36", strtoul("zz", &end, 36) == 1295UL);
 }
 
 /* Test malloc and free */
@@ -147,6 +172,138 @@ void test_realloc(void) {
     if (p3) free(p3);
 }
 
+/* Test that free makes memory reusable and merges neighbours */
+void test_malloc_reuse(void) {
+    char *a = malloc(64);
+    char *b = malloc(64);
+    char *c = malloc(64);
+    TEST("reuse alloc", a && b && c);
+
+    free(b);
+    char *d = malloc(64);
+    TEST("reuse freed block", d == b);
+
+    /* a, d and the space after them merge back into one block */
+    free(d);
+    free(a);
+    char *e = malloc(128);
+    TEST("reuse merged block", e == a);
+
+    /* Growing into the free space behind a block stays in place */
+    free(c);
+    char *f = realloc(e, 200);
+    TEST("realloc in place", f == e);
+
+    /* Shrinking keeps the block and data */
+    strcpy(f, "tlsf");
+    char *g = realloc(f, 16);
+    TEST("realloc shrink", g == f && strcmp(g, "tlsf") == 0);
+    free(g);
+
+    TEST("malloc zero", malloc(0) == 0);
+    TEST("calloc overflow", calloc((size_t)-1 / 2, 4) == 0);
+}
+
+/* Test fixed-size pools */
+void test_mempool(void) {
+    static unsigned buf[MEMPOOL_SIZE(6, 3) / 4];
+    mempool_t pool;
+    mempool_init(&pool, buf, 6, 3);
+
+    char *a = mempool_alloc(&pool);
+    char *b = mempool_alloc(&pool);
+    char *c = mempool_alloc(&pool);
+    TEST("mempool order", a == (char *)buf && b == a + 8 && c == b + 8);
+    TEST("mempool empty", mempool_alloc(&pool) == 0);
+
+    mempool_free(&pool, b);
+    TEST("mempool reuse", mempool_alloc(&pool) == b);
+}
+
+static int cmp_int(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+static int cmp_char(const void *a, const void *b) {
+    return *(const char *)a - *(const char *)b;
+}
+
+#define INT_LESS(x, y) ((x) < (y))
+SORT_DEFINE(sort_ints, int, INT_LESS)
+
+static int is_sorted(const int *a, int n) {
+    for (int i = 1; i < n; i++) {
+        if (a[i - 1] > a[i]) return 0;
+    }
+    return 1;
+}
+
+/* Test qsort, bsearch and the typed SORT_DEFINE sort */
+void test_sort(void) {
+    int a[100], b[100];
+    unsigned seed = 12345;
+    for (int i = 0; i < 100; i++) {
+        seed = seed * 1103515245 + 12345;
+        a[i] = b[i] = (int)(seed >> 16) % 1000 - 500;
+    }
+    qsort(a, 100, sizeof(int), cmp_int);
+    TEST("qsort random", is_sorted(a, 100));
+    sort_ints(b, 100);
+    TEST("sort_ints random", memcmp(a, b, sizeof(a)) == 0);
+
+    for (int i = 0; i < 100; i++) a[i] = 100 - i;
+    qsort(a, 100, sizeof(int), cmp_int);
+    TEST("qsort reversed", is_sorted(a, 100) && a[0] == 1);
+
+    for (int i = 0; i < 100; i++) a[i] = i % 3;
+    qsort(a, 100, sizeof(int), cmp_int);
+    TEST("qsort duplicates", is_sorted(a, 100));
+
+    /* Unaligned bytes take the bytewise swaps */
+    char s[] = "xqsortexample";
+    qsort(s + 1, sizeof(s) - 2, 1, cmp_char);
+    TEST("qsort bytes", strcmp(s, "xaeelmopqrstx") == 0);
+
+    int key = 50;
+    for (int i = 0; i < 100; i++) a[i] = i;
+    int *p = bsearch(&key, a, 100, sizeof(int), cmp_int);
+    TEST("bsearch found", p == &a[50]);
+    key = 100;
+    TEST("bsearch missing", bsearch(&key, a, 100, sizeof(int), cmp_int) == 0);
+    TEST("sort_ints_find", sort_ints_find(a, 100, &a[7]) == &a[7]);
+    TEST("sort_ints_find missing", sort_ints_find(a, 100, &key) == 0);
+}
+
+RING_DEFINE(test_ring, int, 8)
+QUEUE_DEFINE(test_queue, int, 4)
+
+/* Test the SPSC ring and MPSC queue, over several laps of each buffer */
+void test_ring(void) {
+    int v, ok = 1;
+    for (int i = 0; i < 8; i++) ok &= test_ring_push(i);
+    TEST("ring full", !test_ring_push(8) && test_ring_count() == 8);
+    for (int i = 0; i < 8; i++) ok &= test_ring_pop(&v) && v == i;
+    TEST("ring empty", !test_ring_pop(&v) && test_ring_count() == 0);
+
+    for (int i = 0; i < 20; i++) {
+        ok &= test_ring_push(i) && test_ring_pop(&v) && v == i;
+    }
+    TEST("ring order", ok);
+
+    ok = 1;
+    for (int i = 0; i < 4; i++) ok &= test_queue_push(i);
+    TEST("queue full", ok && !test_queue_push(4));
+    for (int i = 0; i < 4; i++) ok &= test_queue_pop(&v) && v == i;
+    TEST("queue empty", ok && !test_queue_pop(&v));
+
+    for (int i = 0; i < 20; i++) {
+        ok &= test_queue_push(i) && test_queue_push(-i);
+        ok &= test_queue_pop(&v) && v == i && test_queue_pop(&v) && v == -i;
+    }
+    TEST("queue order", ok);
+}
+
 int main(void) {
     test_abs();
     test_labs();
@@ -157,6 +314,10 @@ int main(void) {
     test_malloc();
     test_calloc();
     test_realloc();
+    test_malloc_reuse();
+    test_mempool();
+    test_sort();
+    test_ring();
     
     /* Return 0 if all tests passed, otherwise number of failures */
     return tests_failed;
@@ -137,6 +137,66 @@ void test_memmove(void) {
     TEST("memmove overlap bwd", buf[0] == '2' && buf[4] == '6');
 }
 
+/* memcpy/memmove at every relative alignment and at lengths that reach
+ * the byte, word, unrolled and block-move paths and their 1-3 byte tails */
+static int check_copy(const unsigned char *buf, const unsigned char *ref,
+                      int size) {
+    for (int i = 0; i < size; i++) {
+        if (buf[i] != ref[i]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+void test_memcpy_align(void) {
+    unsigned char src[80], dst[80], ref[80];
+    int ok = 1;
+
+    for (int i = 0; i < 80; i++) {
+        src[i] = (unsigned char)(i * 7 + 1);
+    }
+    for (int so = 0; so < 4; so++) {
+        for (int doff = 0; doff < 4; doff++) {
+            for (int n = 0; n <= 72; n++) {
+                for (int i = 0; i < 80; i++) {
+                    dst[i] = ref[i] = 0xEE;
+                }
+                for (int i = 0; i < n; i++) {
+                    ref[doff + i] = src[so + i];
+                }
+                memcpy(dst + doff, src + so, n);
+                ok &= check_copy(dst, ref, 80);
+            }
+        }
+    }
+    TEST("memcpy alignments", ok);
+}
+
+void test_memmove_align(void) {
+    unsigned char buf[96], ref[96];
+    int ok = 1;
+
+    for (int shift = -6; shift <= 6; shift++) {
+        for (int n = 0; n <= 72; n += 5) {
+            for (int i = 0; i < 96; i++) {
+                buf[i] = ref[i] = (unsigned char)(i * 3 + 5);
+            }
+            /* Reference: copy through a temporary */
+            unsigned char tmp[96];
+            for (int i = 0; i < n; i++) {
+                tmp[i] = ref[10 + i];
+            }
+            for (int i = 0; i < n; i++) {
+                ref[10 + shift + i] = tmp[i];
+            }
+            memmove(buf + 10 + shift, buf + 10, n);
+            ok &= check_copy(buf, ref, 96);
+        }
+    }
+    TEST("memmove overlap alignments", ok);
+}
+
 /* Test memset */
 void test_memset(void) {
     char buf[32];
@@ -149,6 +209,73 @@ void test_memset(void) {
     TEST("memset zero", buf[0] == 0 && buf[4] == 0 && buf[5] == 'A');
 }
 
+/* memset and __bzero at every alignment, across the word and tail paths */
+void test_memset_align(void) {
+    unsigned char buf[80], ref[80];
+    int ok = 1;
+
+    for (int off = 0; off < 4; off++) {
+        for (int n = 0; n <= 72; n++) {
+            for (int i = 0; i < 80; i++) {
+                buf[i] = ref[i] = 0xEE;
+            }
+            for (int i = 0; i < n; i++) {
+                ref[off + i] = 0xA5;
+            }
+            memset(buf + off, 0xA5, n);
+            ok &= check_copy(buf, ref, 80);
+
+            for (int i = 0; i < n; i++) {
+                ref[off + i] = 0;
+            }
+            __bzero(buf + off, n);
+            ok &= check_copy(buf, ref, 80);
+        }
+    }
+    TEST("memset/__bzero alignments", ok);
+}
+
+/* The word-at-a-time string functions at every start alignment and
+ * length, with the match or terminator in each byte lane */
+void test_string_words(void) {
+    char buf[48], copy[48];
+    int ok = 1;
+
+    for (int off = 0; off < 4; off++) {
+        for (int len = 0; len < 24; len++) {
+            char *s = buf + off;
+            for (int i = 0; i < 48; i++) {
+                buf[i] = 'x';
+            }
+            for (int i = 0; i < len; i++) {
+                s[i] = (char)('a' + i);
+            }
+            s[len] = '\0';
+
+            ok &= strlen(s) == (size_t)len;
+            ok &= strchr(s, '\0') == s + len;
+            ok &= strchr(s, 'x') == NULL;
+            ok &= memchr(s, 'x', len) == NULL;
+            for (int i = 0; i < len; i++) {
+                ok &= strchr(s, 'a' + i) == s + i;
+                ok &= memchr(s, 'a' + i, len) == s + i;
+            }
+
+            char *d = copy + off;
+            ok &= strcpy(d, s) == d && strcmp(d, s) == 0;
+            if (len > 0) {
+                d[len - 1] = 'A';
+                ok &= strcmp(d, s) < 0 && strcmp(s, d) > 0;
+                d[len - 1] = s[len - 1];
+            }
+            d[len] = 'z';
+            d[len + 1] = '\0';
+            ok &= strcmp(s, d) < 0;
+        }
+    }
+    TEST("string functions word paths", ok);
+}
+
 /* Test memcmp */
 void test_memcmp(void) {
     TEST("memcmp equal", memcmp("abc", "abc", 3) == 0);
@@ -156,6 +283,30 @@ void test_memcmp(void) {
     TEST("memcmp greater", memcmp("abd", "abc", 3) > 0);
     TEST("memcmp partial", memcmp("abcdef", "abcxyz", 3) == 0);
     TEST("memcmp zero", memcmp("abc", "xyz", 0) == 0);
+    TEST("memcmp unsigned", memcmp("\x80", "\x01", 1) > 0);
+    TEST("bcmp equal", bcmp("abcdef", "abcdef", 6) == 0);
+    TEST("bcmp differ", bcmp("abcdef", "abcdeg", 6) != 0);
+
+    /* Word paths: each difference position, at every alignment */
+    unsigned char a[40], b[40];
+    int ok = 1;
+    for (int off = 0; off < 4; off++) {
+        for (int len = 1; len < 32; len++) {
+            for (int i = 0; i < 40; i++) {
+                a[i] = b[i] = (unsigned char)(i * 7);
+            }
+            ok &= memcmp(a + off, b + off, len) == 0;
+            ok &= bcmp(a + off, b + off, len) == 0;
+            for (int i = 0; i < len; i++) {
+                b[off + i] = 0xFF;
+                ok &= memcmp(a + off, b + off, len) < 0;
+                ok &= memcmp(b + off, a + off, len) > 0;
+                ok &= bcmp(a + off, b + off, len) != 0;
+                b[off + i] = a[off + i];
+            }
+        }
+    }
+    TEST("memcmp/bcmp word paths", ok);
 }
 
 /* Test memchr */
@@ -190,9 +341,13 @@ int main(void) {
     test_strrchr();
     test_memcpy();
     test_memmove();
+    test_memcpy_align();
+    test_memmove_align();
     test_memset();
+    test_memset_align();
     test_memcmp();
     test_memchr();
+    test_string_words();
     test_strstr();
     
     /* Return 0 if all tests passed, otherwise number of failures */